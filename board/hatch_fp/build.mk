@@ -14,6 +14,7 @@ board-y=board.o fpsensor_detect.o
 test-list-y=\
        aes \
        compile_time_macros \
+       core_bench \
        crc32 \
        flash_physical \
        flash_write_protect \
@@ -56,6 +56,7 @@
 	(ICACHE_BASE -                                                         \
 	 (CONFIG_IPC_SHARED_OBJ_BUF_SIZE + 2 * 4 /* int32_t */) * 2)
 #define CONFIG_IPI
+#define CONFIG_IPI_SEND_QUEUE_SIZE 4
 #define CONFIG_RPMSG_NAME_SERVICE
 
 #define CONFIG_LTO
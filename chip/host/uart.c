@@ -61,10 +61,18 @@ const char *test_get_captured_console(void)
 	return (const char *)capture_buf;
 }
 
+/* Set while the UART interrupt writes a burst of output */
+static int tx_burst;
+
 static void uart_interrupt(void)
 {
 	uart_process_input();
+
+	/* Flush stdout once per burst rather than once per character. */
+	tx_burst = 1;
 	uart_process_output();
+	tx_burst = 0;
+	fflush(stdout);
 }
 
 int uart_init_done(void)
@@ -107,8 +115,9 @@ void uart_write_char(char c)
 {
 	if (capture_enabled)
 		test_capture_char(c);
-	printf("%c", c);
-	fflush(stdout);
+	putchar(c);
+	if (!tx_burst)
+		fflush(stdout);
 }
 
 int uart_read_char(void)
@@ -165,7 +165,7 @@ static void gpio_interrupt(void)
 		if (gisr & g->mask) {
 			/* write 1 to clear interrupt status bit */
 			ISH_GPIO_GISR = g->mask;
-			gpio_irq_handlers[i](i);
+			gpio_irq_dispatch(i);
 		}
 	}
 }
@@ -15,7 +15,8 @@
 
 #define HECI_MAX_MSG_SIZE			4960
 #define HECI_IPC_PAYLOAD_SIZE   (IPC_MAX_PAYLOAD_SIZE - 4)
-#define HECI_MAX_MSGS				3
+/* Enough items for a header, a list header and 7 batched HID reports */
+#define HECI_MAX_MSGS				16
 
 enum HECI_ERR {
 	HECI_ERR_TOO_MANY_MSG_ITEMS		= EC_ERROR_INTERNAL_FIRST + 0,
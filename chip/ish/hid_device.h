@@ -13,6 +13,9 @@
 
 #define HID_SUBSYS_MAX_PAYLOAD_SIZE			4954
 
+/* Most input reports sent in one HID_PUBLISH_INPUT_REPORT_LIST message */
+#define HID_SUBSYS_MAX_BATCH_REPORTS			7
+
 enum HID_SUBSYS_ERR {
 	HID_SUBSYS_ERR_NOT_READY		= EC_ERROR_INTERNAL_FIRST + 0,
 	HID_SUBSYS_ERR_TOO_MANY_HID_DEVICES	= EC_ERROR_INTERNAL_FIRST + 1,
@@ -52,6 +55,12 @@ struct hid_callbacks {
 	int (*suspend)(const hid_handle_t handle);
 };
 
+/* One input report of a batch, see hid_subsys_send_input_reports() */
+struct hid_input_report {
+	uint8_t *buf;
+	size_t size;
+};
+
 struct hid_device {
 	uint8_t dev_class;
 	uint16_t pid;
@@ -68,6 +77,14 @@ hid_handle_t hid_subsys_register_device(const struct hid_device *dev_info);
 /* send HID input report */
 int hid_subsys_send_input_report(const hid_handle_t handle, uint8_t *buf,
 				 const size_t buf_size);
+/*
+ * send several HID input reports in one HECI message. The reports are sent
+ * from their buffers without being copied first, and take one flow control
+ * credit and one IPC transfer, instead of one per report.
+ */
+int hid_subsys_send_input_reports(const hid_handle_t handle,
+				  const struct hid_input_report *reports,
+				  const int num_of_reports);
 /* store HID device specific data */
 int hid_subsys_set_device_data(const hid_handle_t handle, void *data);
 /* retrieve HID device specific data */
@@ -37,7 +37,7 @@ enum {
 	HID_SET_FEATURE_REPORT,
 	HID_GET_INPUT_REPORT,
 	HID_PUBLISH_INPUT_REPORT,
-	HID_PUBLISH_INPUT_REPORT_LIST, /* TODO: need to support batch report */
+	HID_PUBLISH_INPUT_REPORT_LIST,
 
 	HID_HID_CLIENT_READY_CMD = 30,
 	HID_HID_COMMAND_MAX = 31,
@@ -70,6 +70,13 @@ struct hid_msg_hdr {
 	uint16_t size;
 } __packed;
 
+/* payload of HID_PUBLISH_INPUT_REPORT_LIST, followed by the reports */
+struct hid_report_list_hdr {
+	uint16_t total_size;
+	uint8_t num_of_reports;
+	uint8_t flags;
+} __packed;
+
 struct hid_msg {
 	struct hid_msg_hdr hdr;
 	uint8_t payload[HID_SUBSYS_MAX_PAYLOAD_SIZE];
@@ -192,6 +199,76 @@ int hid_subsys_send_input_report(const hid_handle_t handle, uint8_t *buf,
 	return 0;
 }
 
+int hid_subsys_send_input_reports(const hid_handle_t handle,
+				  const struct hid_input_report *reports,
+				  const int num_of_reports)
+{
+	struct hid_subsys_hid_device *hid_device;
+	struct hid_msg_hdr hid_msg_hdr = {0};
+	struct hid_report_list_hdr list_hdr = {0};
+	/* Each report is preceded by its size */
+	uint16_t report_size[HID_SUBSYS_MAX_BATCH_REPORTS];
+	struct heci_msg_item msg_item[2 + 2 * HID_SUBSYS_MAX_BATCH_REPORTS];
+	struct heci_msg_list msg_list;
+	size_t payload_size;
+	int i;
+
+	BUILD_ASSERT(ARRAY_SIZE(msg_item) <= HECI_MAX_MSGS);
+
+	hid_device = handle_to_hid_device(handle);
+	if (!hid_device)
+		return -EC_ERROR_INVAL;
+
+	if (num_of_reports <= 0 ||
+	    num_of_reports > HID_SUBSYS_MAX_BATCH_REPORTS)
+		return -EC_ERROR_INVAL;
+
+	if (hid_subsys_ctx.heci_handle == HECI_INVALID_HANDLE)
+		return -HID_SUBSYS_ERR_NOT_READY;
+
+	if (!hid_device->can_send_hid_input)
+		return -HID_SUBSYS_ERR_NOT_READY;
+
+	payload_size = sizeof(list_hdr);
+	for (i = 0; i < num_of_reports; i++) {
+		if (!reports[i].size)
+			return -EC_ERROR_INVAL;
+
+		report_size[i] = reports[i].size;
+		payload_size += sizeof(report_size[i]) + reports[i].size;
+	}
+
+	if (payload_size > HID_SUBSYS_MAX_PAYLOAD_SIZE)
+		return -EC_ERROR_OVERFLOW;
+
+	hid_msg_hdr.command = HID_PUBLISH_INPUT_REPORT_LIST;
+	hid_msg_hdr.device_id = hid_device->info.dev_id;
+	hid_msg_hdr.size = payload_size;
+
+	list_hdr.total_size = payload_size - sizeof(list_hdr);
+	list_hdr.num_of_reports = num_of_reports;
+
+	msg_item[0].size = sizeof(hid_msg_hdr);
+	msg_item[0].buf = (uint8_t *)&hid_msg_hdr;
+	msg_item[1].size = sizeof(list_hdr);
+	msg_item[1].buf = (uint8_t *)&list_hdr;
+
+	for (i = 0; i < num_of_reports; i++) {
+		msg_item[2 + 2 * i].size = sizeof(report_size[i]);
+		msg_item[2 + 2 * i].buf = (uint8_t *)&report_size[i];
+		msg_item[3 + 2 * i].size = reports[i].size;
+		msg_item[3 + 2 * i].buf = reports[i].buf;
+	}
+
+	msg_list.num_of_items = 2 + 2 * num_of_reports;
+	for (i = 0; i < msg_list.num_of_items; i++)
+		msg_list.items[i] = &msg_item[i];
+
+	heci_send_msgs(hid_subsys_ctx.heci_handle, &msg_list);
+
+	return 0;
+}
+
 int hid_subsys_set_device_data(const hid_handle_t handle, void *data)
 {
 	struct hid_subsys_hid_device *hid_device;
@@ -770,7 +770,7 @@ static void gpio_interrupt(int port, uint8_t mask)
 
 	for (i = 0; i < GPIO_IH_COUNT; i++, g++) {
 		if (port == g->port && (mask & g->mask)) {
-			gpio_irq_handlers[i](i);
+			gpio_irq_dispatch(i);
 			return;
 		}
 	}
@@ -579,8 +579,8 @@ void lpc_interrupt(void)
 		keyboard_host_write(LPC_POOL_KEYBOARD[0], st & LM4_LPC_ST_CMD);
 
 	if (mis & LM4_LPC_INT_MASK(LPC_CH_KEYBOARD, 1)) {
-		/* Host read data; wake up task to send remaining bytes */
-		task_wake(TASK_ID_KEYPROTO);
+		/* Host read data; send remaining bytes */
+		keyboard_host_read();
 	}
 #endif
 
@@ -217,7 +217,7 @@ static void gpio_interrupt(int port, uint32_t mis)
 
 	for (i = 0; i < GPIO_IH_COUNT && mis; i++, g++) {
 		if (port == g->port && (mis & g->mask)) {
-			gpio_irq_handlers[i](i);
+			gpio_irq_dispatch(i);
 			mis &= ~g->mask;
 		}
 	}
@@ -1087,9 +1087,16 @@ const FPVW girq25_vw_handlers[MCHP_GIRQ25_NUM_M2S] = {
 	espi_vw_evt2_dflt,
 };
 
+/* Signals of MSVW00 - MSVW01, by GIRQ24 bit position, for latency tracking */
+static const enum espi_vw_signal girq24_vw_signals[] = {
+	VW_SLP_S3_L, VW_SLP_S4_L, VW_SLP_S5_L, VW_SIGNAL_END,
+	VW_SUS_STAT_L, VW_PLTRST_L, VW_OOB_RST_WARN, VW_SIGNAL_END,
+};
+
 /* Interrupt handler for eSPI virtual wires in MSVW00 - MSVW01 */
 void espi_mswv1_interrupt(void)
 {
+	uint32_t start = espi_vw_latency_start();
 	uint32_t d, girq24_result, bpos;
 
 	d = MCHP_INT_ENABLE(24);
@@ -1101,6 +1108,8 @@ void espi_mswv1_interrupt(void)
 		d = *(uint8_t *)(MCHP_ESPI_MSVW_BASE + 8 +
 				(12 * (bpos >> 2)) + (bpos & 0x03)) & 0x01;
 		(girq24_vw_handlers[bpos])(d, bpos);
+		if (bpos < ARRAY_SIZE(girq24_vw_signals))
+			espi_vw_latency_record(girq24_vw_signals[bpos], start);
 		girq24_result &= ~(1ul << bpos);
 		bpos = __builtin_ctz(girq24_result);
 	}
@@ -412,7 +412,7 @@ static void gpio_interrupt(int girq, int port)
 				trace12(0, GPIO, 0,
 					"Bit[%d]: handler @ 0x%08x", bit,
 					(uint32_t)gpio_irq_handlers[i]);
-				gpio_irq_handlers[i](i);
+				gpio_irq_dispatch(i);
 			}
 			sts &= ~BIT(bit);
 		}
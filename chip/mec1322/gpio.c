@@ -261,7 +261,7 @@ static void gpio_interrupt(int girq, int port_offset)
 	for (i = 0; i < GPIO_IH_COUNT && sts; ++i, ++g) {
 		bit = (g->port - port_offset) * 8 + __builtin_ffs(g->mask) - 1;
 		if (sts & BIT(bit))
-			gpio_irq_handlers[i](i);
+			gpio_irq_dispatch(i);
 		sts &= ~BIT(bit);
 	}
 }
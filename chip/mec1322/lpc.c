@@ -430,7 +430,7 @@ DECLARE_IRQ(MEC1322_IRQ_8042EM_IBF, kb_ibf_interrupt, 1);
 
 void kb_obf_interrupt(void)
 {
-	task_wake(TASK_ID_KEYPROTO);
+	keyboard_host_read();
 }
 DECLARE_IRQ(MEC1322_IRQ_8042EM_OBF, kb_obf_interrupt, 1);
 #endif
@@ -70,18 +70,29 @@ int32_t audio_codec_wov_read(void *buf, uint32_t count)
 {
 	int16_t *out = buf;
 	uint8_t gain = 1;
+	size_t level;
 
 	if (IS_ENABLED(CONFIG_AUDIO_CODEC_DMIC_SOFTWARE_GAIN))
 		audio_codec_dmic_get_gain_idx(0, &gain);
 
 	count >>= 1;
 
-	while (count-- && wov_fifo_level()) {
-		if (IS_ENABLED(CONFIG_AUDIO_CODEC_DMIC_SOFTWARE_GAIN))
-			*out++ = audio_codec_s16_scale_and_clip(
-					SCP_VIF_FIFO_DATA, gain);
-		else
-			*out++ = SCP_VIF_FIFO_DATA;
+	/*
+	 * Drain the FIFO a level's worth at a time, rather than checking the
+	 * status register before every sample.
+	 */
+	while (count && (level = wov_fifo_level())) {
+		level = MIN(level, count);
+		count -= level;
+
+		if (IS_ENABLED(CONFIG_AUDIO_CODEC_DMIC_SOFTWARE_GAIN)) {
+			while (level--)
+				*out++ = audio_codec_s16_scale_and_clip(
+						SCP_VIF_FIFO_DATA, gain);
+		} else {
+			while (level--)
+				*out++ = SCP_VIF_FIFO_DATA;
+		}
 	}
 
 	return (void *)out - buf;
@@ -173,7 +173,7 @@ void __keep gpio_interrupt(void)
 			/* Call handler */
 			signal = port * 32 + bit;
 			if (signal < GPIO_IH_COUNT)
-				gpio_irq_handlers[signal](signal);
+				gpio_irq_dispatch(signal);
 		}
 	}
 }
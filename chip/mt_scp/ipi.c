@@ -52,6 +52,20 @@ static struct ipc_shared_obj *const scp_recv_obj =
 				  sizeof(struct ipc_shared_obj));
 static char ipi_ready;
 
+#ifdef CONFIG_IPI_SEND_QUEUE_SIZE
+/* How often to check whether the AP has consumed the send object. */
+#define IPI_SEND_QUEUE_POLL_US 200
+/* Messages waiting for the send object, protected by ipi_lock. */
+static struct ipc_shared_obj send_queue[CONFIG_IPI_SEND_QUEUE_SIZE];
+static int send_queue_head;
+static int send_queue_count;
+/* Queued messages are sent in order, so senders need not wait. */
+#define IPI_SEND_WAIT 0
+#else
+#define send_queue_count 0
+#define IPI_SEND_WAIT 1
+#endif
+
 #ifdef HAS_TASK_HOSTCMD
 /*
  * hostcmd and hostevent share the same IPI ID, and use first byte type to
@@ -158,6 +172,71 @@ power_chipset_handle_host_sleep_event(enum host_sleep_event state,
 	}
 }
 
+/* Hand a message to AP: interrupt AP to receive IPI messages. */
+static void ipi_send_obj(int32_t id, const void *buf, uint32_t len)
+{
+	scp_send_obj->id = id;
+	scp_send_obj->len = len;
+	memcpy(scp_send_obj->buffer, buf, len);
+
+	try_to_wakeup_ap(id);
+	SCP_HOST_INT = IPC_SCP2HOST_BIT;
+}
+
+#ifdef CONFIG_IPI_SEND_QUEUE_SIZE
+/* Send queued messages while AP is free to take them. Call with ipi_lock. */
+static void ipi_drain_send_queue_locked(void)
+{
+	while (send_queue_count && !is_ipi_busy()) {
+		const struct ipc_shared_obj *obj = &send_queue[send_queue_head];
+
+		ipi_send_obj(obj->id, obj->buffer, obj->len);
+		send_queue_head =
+			(send_queue_head + 1) % CONFIG_IPI_SEND_QUEUE_SIZE;
+		send_queue_count--;
+	}
+}
+
+static void ipi_drain_send_queue(void);
+DECLARE_DEFERRED(ipi_drain_send_queue);
+
+static void ipi_drain_send_queue(void)
+{
+	ipi_disable_irq(SCP_IRQ_IPC0);
+	mutex_lock(&ipi_lock);
+
+	ipi_drain_send_queue_locked();
+	if (send_queue_count)
+		hook_call_deferred(&ipi_drain_send_queue_data,
+				   IPI_SEND_QUEUE_POLL_US);
+
+	mutex_unlock(&ipi_lock);
+	ipi_enable_irq(SCP_IRQ_IPC0);
+}
+
+/* Queue a message behind the ones AP has not taken yet. Call with ipi_lock. */
+static int ipi_queue_obj_locked(int32_t id, const void *buf, uint32_t len)
+{
+	struct ipc_shared_obj *obj;
+
+	if (send_queue_count == CONFIG_IPI_SEND_QUEUE_SIZE)
+		return EC_ERROR_BUSY;
+
+	obj = &send_queue[(send_queue_head + send_queue_count) %
+			  CONFIG_IPI_SEND_QUEUE_SIZE];
+	obj->id = id;
+	obj->len = len;
+	memcpy(obj->buffer, buf, len);
+	send_queue_count++;
+
+	/* AP may be asleep with the send object still pending. */
+	try_to_wakeup_ap(id);
+	hook_call_deferred(&ipi_drain_send_queue_data, IPI_SEND_QUEUE_POLL_US);
+
+	return EC_SUCCESS;
+}
+#endif
+
 /* Send data from SCP to AP. */
 int ipi_send(int32_t id, const void *buf, uint32_t len, int wait)
 {
@@ -176,8 +255,23 @@ int ipi_send(int32_t id, const void *buf, uint32_t len, int wait)
 	ipi_disable_irq(SCP_IRQ_IPC0);
 	mutex_lock(&ipi_lock);
 
+#ifdef CONFIG_IPI_SEND_QUEUE_SIZE
+	/* Keep the order of messages already waiting for AP. */
+	if ((send_queue_count || is_ipi_busy()) &&
+	    ipi_queue_obj_locked(id, buf, len) == EC_SUCCESS) {
+		/* Waiting means until AP has taken this message too. */
+		while (wait && (send_queue_count || is_ipi_busy()))
+			ipi_drain_send_queue_locked();
+
+		mutex_unlock(&ipi_lock);
+		ipi_enable_irq(SCP_IRQ_IPC0);
+
+		return EC_SUCCESS;
+	}
+#endif
+
 	/* Check if there is already an IPI pending in AP. */
-	if (is_ipi_busy()) {
+	if (send_queue_count || is_ipi_busy()) {
 		/*
 		 * If the following conditions meet,
 		 *   1) There is an IPI pending in AP.
@@ -196,14 +290,7 @@ int ipi_send(int32_t id, const void *buf, uint32_t len, int wait)
 		return EC_ERROR_BUSY;
 	}
 
-
-	scp_send_obj->id = id;
-	scp_send_obj->len = len;
-	memcpy(scp_send_obj->buffer, buf, len);
-
-	/* Send IPI to AP: interrutp AP to receive IPI messages. */
-	try_to_wakeup_ap(id);
-	SCP_HOST_INT = IPC_SCP2HOST_BIT;
+	ipi_send_obj(id, buf, len);
 
 	while (wait && is_ipi_busy())
 		;
@@ -276,7 +363,7 @@ int mkbp_set_host_active_via_custom(int active, uint32_t *timestamp)
 
 	if (active)
 		return ipi_send(IPI_HOST_COMMAND, &hc_evt_obj,
-				sizeof(hc_evt_obj), 1);
+				sizeof(hc_evt_obj), IPI_SEND_WAIT);
 	return EC_SUCCESS;
 }
 #endif
@@ -288,7 +375,7 @@ static void ipi_send_response_packet(struct host_packet *pkt)
 	ret = ipi_send(IPI_HOST_COMMAND, &hc_cmd_obj,
 		       pkt->response_size +
 			       offsetof(struct hostcmd_data, response),
-		       1);
+		       IPI_SEND_WAIT);
 	if (ret)
 		CPRINTS("#ERR IPI HOSTCMD %d", ret);
 }
@@ -49,11 +49,70 @@
 #define CEC_MAX_RESENDS 5
 
 /*
- * Free time timing (us). Our free-time is calculated from the end of
- * the last bit (not from the start). We compensate by having one
- * free-time period less than in the spec.
+ * Bus timings in us. The interrupt handlers need them in timer ticks on
+ * every edge, so cec_init() converts them once into cec_ticks[] instead of
+ * scaling by the APB1 frequency each time.
  */
-#define NOMINAL_BIT_TICKS APB1_TICKS(2400)
+#define CEC_TIMINGS(X)							\
+	/*								\
+	 * Free time timing. Our free-time is calculated from the end	\
+	 * of the last bit (not from the start). We compensate by	\
+	 * having one free-time period less than in the spec.		\
+	 */								\
+	X(NOMINAL_BIT, 2400)						\
+	/* Start bit timing */						\
+	X(START_BIT_LOW, 3700)						\
+	X(START_BIT_MIN_LOW, 3500)					\
+	X(START_BIT_MAX_LOW, 3900)					\
+	X(START_BIT_HIGH, 800)						\
+	X(START_BIT_MIN_DURATION, 4300)					\
+	X(START_BIT_MAX_DURATION, 5700)					\
+	/* Data bit timing */						\
+	X(DATA_ZERO_LOW, 1500)						\
+	X(DATA_ZERO_MIN_LOW, 1300)					\
+	X(DATA_ZERO_MAX_LOW, 1700)					\
+	X(DATA_ZERO_HIGH, 900)						\
+	X(DATA_ZERO_MIN_DURATION, 2050)					\
+	X(DATA_ZERO_MAX_DURATION, 2750)					\
+	X(DATA_ONE_LOW, 600)						\
+	X(DATA_ONE_MIN_LOW, 400)					\
+	X(DATA_ONE_MAX_LOW, 800)					\
+	X(DATA_ONE_HIGH, 1800)						\
+	X(DATA_ONE_MIN_DURATION, 2050)					\
+	X(DATA_ONE_MAX_DURATION, 2750)					\
+	/* Time from low that it should be safe to sample an ACK */	\
+	X(NOMINAL_SAMPLE_TIME, 1050)					\
+	/* The limit how short a start-bit can be to trigger debounce */ \
+	X(DEBOUNCE_LIMIT, 200)						\
+	/* The time we ignore the bus for the first debounce cases */	\
+	X(DEBOUNCE_WAIT_SHORT, 100)					\
+	/* The time we ignore the bus after the initial debounce cases */ \
+	X(DEBOUNCE_WAIT_LONG, 500)					\
+	/*								\
+	 * The variance in timing we allow outside of the CEC		\
+	 * specification for incoming signals. Our measurements aren't	\
+	 * 100% accurate either, so this gives some robustness.		\
+	 */								\
+	X(VALID_TOLERANCE, 100)
+
+#define CEC_TIMING_ENUM(name, us) CEC_TIMING_ ## name,
+#define CEC_TIMING_US(name, us) [CEC_TIMING_ ## name] = (us),
+
+enum cec_timing {
+	CEC_TIMINGS(CEC_TIMING_ENUM)
+	CEC_TIMING_COUNT
+};
+
+static const uint16_t cec_timing_us[CEC_TIMING_COUNT] = {
+	CEC_TIMINGS(CEC_TIMING_US)
+};
+
+/* cec_timing_us[] in APB1 ticks, filled in by cec_init() */
+static int cec_ticks[CEC_TIMING_COUNT];
+
+#define TICKS(name) (cec_ticks[CEC_TIMING_ ## name])
+
+#define NOMINAL_BIT_TICKS TICKS(NOMINAL_BIT)
  /* Resend */
 #define FREE_TIME_RS_TICKS (2 * (NOMINAL_BIT_TICKS))
 /* New initiator */
@@ -61,31 +120,28 @@
 /* Present initiator */
 #define FREE_TIME_PI_TICKS (6 * (NOMINAL_BIT_TICKS))
 
-/* Start bit timing */
-#define START_BIT_LOW_TICKS		APB1_TICKS(3700)
-#define START_BIT_MIN_LOW_TICKS		APB1_TICKS(3500)
-#define START_BIT_MAX_LOW_TICKS		APB1_TICKS(3900)
-#define START_BIT_HIGH_TICKS		APB1_TICKS(800)
-#define START_BIT_MIN_DURATION_TICKS	APB1_TICKS(4300)
-#define START_BIT_MAX_DURATION_TICKS	APB1_TICKS(5700)
-
-/* Data bit timing */
-#define DATA_ZERO_LOW_TICKS		APB1_TICKS(1500)
-#define DATA_ZERO_MIN_LOW_TICKS		APB1_TICKS(1300)
-#define DATA_ZERO_MAX_LOW_TICKS		APB1_TICKS(1700)
-#define DATA_ZERO_HIGH_TICKS		APB1_TICKS(900)
-#define DATA_ZERO_MIN_DURATION_TICKS	APB1_TICKS(2050)
-#define DATA_ZERO_MAX_DURATION_TICKS	APB1_TICKS(2750)
-
-#define DATA_ONE_LOW_TICKS		APB1_TICKS(600)
-#define DATA_ONE_MIN_LOW_TICKS		APB1_TICKS(400)
-#define DATA_ONE_MAX_LOW_TICKS		APB1_TICKS(800)
-#define DATA_ONE_HIGH_TICKS		APB1_TICKS(1800)
-#define DATA_ONE_MIN_DURATION_TICKS	APB1_TICKS(2050)
-#define DATA_ONE_MAX_DURATION_TICKS	APB1_TICKS(2750)
-
-/* Time from low that it should be safe to sample an ACK */
-#define NOMINAL_SAMPLE_TIME_TICKS APB1_TICKS(1050)
+#define START_BIT_LOW_TICKS		TICKS(START_BIT_LOW)
+#define START_BIT_MIN_LOW_TICKS		TICKS(START_BIT_MIN_LOW)
+#define START_BIT_MAX_LOW_TICKS		TICKS(START_BIT_MAX_LOW)
+#define START_BIT_HIGH_TICKS		TICKS(START_BIT_HIGH)
+#define START_BIT_MIN_DURATION_TICKS	TICKS(START_BIT_MIN_DURATION)
+#define START_BIT_MAX_DURATION_TICKS	TICKS(START_BIT_MAX_DURATION)
+
+#define DATA_ZERO_LOW_TICKS		TICKS(DATA_ZERO_LOW)
+#define DATA_ZERO_MIN_LOW_TICKS		TICKS(DATA_ZERO_MIN_LOW)
+#define DATA_ZERO_MAX_LOW_TICKS		TICKS(DATA_ZERO_MAX_LOW)
+#define DATA_ZERO_HIGH_TICKS		TICKS(DATA_ZERO_HIGH)
+#define DATA_ZERO_MIN_DURATION_TICKS	TICKS(DATA_ZERO_MIN_DURATION)
+#define DATA_ZERO_MAX_DURATION_TICKS	TICKS(DATA_ZERO_MAX_DURATION)
+
+#define DATA_ONE_LOW_TICKS		TICKS(DATA_ONE_LOW)
+#define DATA_ONE_MIN_LOW_TICKS		TICKS(DATA_ONE_MIN_LOW)
+#define DATA_ONE_MAX_LOW_TICKS		TICKS(DATA_ONE_MAX_LOW)
+#define DATA_ONE_HIGH_TICKS		TICKS(DATA_ONE_HIGH)
+#define DATA_ONE_MIN_DURATION_TICKS	TICKS(DATA_ONE_MIN_DURATION)
+#define DATA_ONE_MAX_DURATION_TICKS	TICKS(DATA_ONE_MAX_DURATION)
+
+#define NOMINAL_SAMPLE_TIME_TICKS TICKS(NOMINAL_SAMPLE_TIME)
 
 #define DATA_TIME(type, data) ((data) ? (DATA_ONE_ ## type ## _TICKS) : \
 					(DATA_ZERO_ ## type ## _TICKS))
@@ -98,19 +154,11 @@
  */
 #define DEBOUNCE_CUTOFF 3
 
-/* The limit how short a start-bit can be to trigger debounce logic */
-#define DEBOUNCE_LIMIT_TICKS APB1_TICKS(200)
-/* The time we ignore the bus for the first three debounce cases */
-#define DEBOUNCE_WAIT_SHORT_TICKS APB1_TICKS(100)
-/* The time we ignore the bus after the three initial debounce cases */
-#define DEBOUNCE_WAIT_LONG_TICKS APB1_TICKS(500)
+#define DEBOUNCE_LIMIT_TICKS TICKS(DEBOUNCE_LIMIT)
+#define DEBOUNCE_WAIT_SHORT_TICKS TICKS(DEBOUNCE_WAIT_SHORT)
+#define DEBOUNCE_WAIT_LONG_TICKS TICKS(DEBOUNCE_WAIT_LONG)
 
-/*
- * The variance in timing we allow outside of the CEC specification for
- * incoming signals. Our measurements aren't 100% accurate either, so this
- * gives some robustness.
- */
-#define VALID_TOLERANCE_TICKS APB1_TICKS(100)
+#define VALID_TOLERANCE_TICKS TICKS(VALID_TOLERANCE)
 
 /*
  * Defines used for setting capture timers to a point where we are
@@ -990,9 +1038,12 @@ DECLARE_EVENT_SOURCE(EC_MKBP_EVENT_CEC_MESSAGE, cec_get_next_msg);
 static void cec_init(void)
 {
 	int mdl = NPCX_MFT_MODULE_1;
+	int i;
 
 	/* APB1 is the clock we base the timers on */
 	apb1_freq_div_10k = clock_get_apb1_freq()/10000;
+	for (i = 0; i < CEC_TIMING_COUNT; i++)
+		cec_ticks[i] = APB1_TICKS(cec_timing_us[i]);
 
 	/* Ensure Multi-Function timer is powered up. */
 	CLEAR_BIT(NPCX_PWDWN_CTL(mdl), NPCX_PWDWN_CTL1_MFT1_PD);
@@ -15,6 +15,7 @@
 #include "hooks.h"
 #include "hwtimer.h"
 #include "hwtimer_chip.h"
+#include "idle_governor.h"
 #include "registers.h"
 #include "system.h"
 #include "task.h"
@@ -334,7 +335,9 @@ void __idle(void)
 		    /* Ensure we have sufficient time before expiration */
 		    next_evt - t0.le.lo > WAKE_INTERVAL &&
 		    /* Make sure it's over console expired time */
-		    t0.val > console_expire_time.val) {
+		    t0.val > console_expire_time.val &&
+		    /* Make sure the recent wake-ups don't predict otherwise */
+		    idle_governor_allow_deep(next_evt - t0.le.lo)) {
 #if DEBUG_CLK
 			/* Use GPIO to indicate SLEEP mode */
 			CLEAR_BIT(NPCX_PDOUT(0), 0);
@@ -394,6 +397,10 @@ void __idle(void)
 
 			/* Record time spent in deep sleep. */
 			idle_dsleep_time_us += next_evt_us;
+			idle_governor_record(EC_IDLE_STATE_DEEP_SLEEP,
+					     next_evt_us,
+					     cpu_get_pending_irq(
+						     CONFIG_IRQ_COUNT));
 
 			/* Fast forward timer according to wake-up timer. */
 			t1.val = t0.val + next_evt_us;
@@ -428,6 +435,12 @@ void __idle(void)
 			     "pop {r0-r5}\n"
 			     "isb\n" :: "r" (0x100A8000)
 			);
+
+			if (IS_ENABLED(CONFIG_IDLE_GOVERNOR))
+				idle_governor_record(EC_IDLE_STATE_SLEEP,
+						     get_time().val - t0.val,
+						     cpu_get_pending_irq(
+							     CONFIG_IRQ_COUNT));
 		}
 
 		/*
@@ -490,20 +490,29 @@ void espi_espirst_handler(void)
 /* Handle eSPI virtual wire interrupt 1 */
 void __espi_wk2a_interrupt(void)
 {
+	uint32_t start = espi_vw_latency_start();
 	uint8_t pending_bits = NPCX_WKPND(MIWU_TABLE_2, MIWU_GROUP_1);
 
 	/* Clear pending bits of MIWU */
 	NPCX_WKPCL(MIWU_TABLE_2, MIWU_GROUP_1) = pending_bits;
 
 	/* Handle events of virtual-wire */
-	if (IS_BIT_SET(pending_bits, 0))
+	if (IS_BIT_SET(pending_bits, 0)) {
 		espi_vw_evt_slp_s3();
-	if (IS_BIT_SET(pending_bits, 1))
+		espi_vw_latency_record(VW_SLP_S3_L, start);
+	}
+	if (IS_BIT_SET(pending_bits, 1)) {
 		espi_vw_evt_slp_s4();
-	if (IS_BIT_SET(pending_bits, 2))
+		espi_vw_latency_record(VW_SLP_S4_L, start);
+	}
+	if (IS_BIT_SET(pending_bits, 2)) {
 		espi_vw_evt_slp_s5();
-	if (IS_BIT_SET(pending_bits, 5))
+		espi_vw_latency_record(VW_SLP_S5_L, start);
+	}
+	if (IS_BIT_SET(pending_bits, 5)) {
 		espi_vw_evt_pltrst();
+		espi_vw_latency_record(VW_PLTRST_L, start);
+	}
 	if (IS_BIT_SET(pending_bits, 6))
 		espi_vw_evt_oobrst();
 }
@@ -43,6 +43,13 @@ static const struct npcx_wui gpio_wui_table[] = {
 	#include "gpio.wrap"
 };
 
+/*
+ * Reverse of gpio_wui_table for the GPIO_INTs: signal + 1 of each MIWU input,
+ * 0 for none.  Filled by gpio_pre_init() so the interrupt handler indexes it
+ * instead of scanning gpio_wui_table.
+ */
+static uint8_t gpio_wui_signal[MIWU_TABLE_COUNT][MIWU_GROUP_COUNT][8];
+
 struct npcx_gpio {
 	uint8_t port  : 4;
 	uint8_t bit   : 3;
@@ -566,6 +573,18 @@ void gpio_pre_init(void)
 	SET_BIT(NPCX_DEVALT(ALT_GROUP_1), NPCX_DEVALT1_NO_LPC_ESPI);
 #endif
 
+	/* Map each MIWU input to its GPIO_INT, the first one declared wins */
+	ASSERT(GPIO_IH_COUNT < UINT8_MAX);
+	for (i = 0; i < GPIO_IH_COUNT; i++) {
+		const struct npcx_wui *wui = gpio_wui_table + i;
+
+		if (wui->table == MIWU_TABLE_COUNT)
+			continue;
+		if (!gpio_wui_signal[wui->table][wui->group][wui->bit])
+			gpio_wui_signal[wui->table][wui->group][wui->bit] =
+				i + 1;
+	}
+
 	/* Clear all interrupt pending and enable bits of GPIOS */
 	for (i = 0; i < 2; i++) {
 		for (j = 0; j < 8; j++) {
@@ -627,33 +646,27 @@ void gpio_pre_init(void)
 
 void gpio_interrupt(struct npcx_wui wui_int)
 {
-	int i;
 	uint8_t wui_mask;
 	uint8_t table = wui_int.table;
 	uint8_t group = wui_int.group;
+	const uint8_t *signals = gpio_wui_signal[table][group];
 
 	/* Get pending mask */
 	wui_mask = NPCX_WKPND(table, group) & NPCX_WKEN(table, group);
 
 	/* Find GPIOs and execute interrupt service routine */
-	for (i = 0; i < GPIO_IH_COUNT && wui_mask; i++) {
-		uint8_t pin_mask = 1 << gpio_wui_table[i].bit;
-
-		if ((gpio_wui_table[i].table == table) &&
-			(gpio_wui_table[i].group == group) &&
-			(wui_mask & pin_mask)) {
-			/* Clear pending bit of GPIO */
-			NPCX_WKPCL(table, group) = pin_mask;
-			/* Execute GPIO's ISR */
-			gpio_irq_handlers[i](i);
-			/* In case declare the same GPIO in gpio_wui_table */
-			wui_mask &= ~pin_mask;
-		}
-	}
+	while (wui_mask) {
+		int bit = __builtin_ctz(wui_mask);
+		uint8_t pin_mask = BIT(bit);
+
+		/* Clear pending bit of GPIO, even if it has no ISR */
+		NPCX_WKPCL(table, group) = pin_mask;
+		wui_mask &= ~pin_mask;
 
-	if (wui_mask)
-		/* No ISR for this interrupt, just clear it */
-		NPCX_WKPCL(table, group) = wui_mask;
+		/* Execute GPIO's ISR */
+		if (signals[bit])
+			gpio_irq_dispatch(signals[bit] - 1);
+	}
 }
 
 #undef GPIO_IRQ_FUNC
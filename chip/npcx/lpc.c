@@ -164,6 +164,29 @@ static void lpc_generate_smi(void)
 		HOST_EVENT_CPRINTS("smi", smi);
 }
 
+/* Minimum time SCI has to stay at each level for the host to see an edge */
+#define LPC_SCI_LEVEL_US 65
+
+/* Whether SCI has been left high since sci_high_time */
+static int sci_high;
+static uint32_t sci_high_time;
+
+/*
+ * Wait until SCI has been high for long enough to debounce high. SCI is left
+ * high after each pulse, so only the part of the debounce time not already
+ * elapsed since the last pulse needs to be spent here. This keeps the ACPI
+ * port, which pulses SCI for each byte, from busy-waiting twice per byte.
+ */
+static void lpc_sci_wait_high(void)
+{
+	uint32_t elapsed = get_time().le.lo - sci_high_time;
+
+	if (!sci_high)
+		udelay(LPC_SCI_LEVEL_US);
+	else if (elapsed < LPC_SCI_LEVEL_US)
+		udelay(LPC_SCI_LEVEL_US - elapsed);
+}
+
 /**
  * Generate SCI pulse to the host chipset via LPC0SCI.
  */
@@ -174,10 +197,10 @@ static void lpc_generate_sci(void)
 #ifdef CONFIG_SCI_GPIO
 	/* Enforce signal-high for long enough to debounce high */
 	gpio_set_level(CONFIG_SCI_GPIO, 1);
-	udelay(65);
+	lpc_sci_wait_high();
 	/* Generate a falling edge */
 	gpio_set_level(CONFIG_SCI_GPIO, 0);
-	udelay(65);
+	udelay(LPC_SCI_LEVEL_US);
 	/* Set signal high, now that we've generated the edge */
 	gpio_set_level(CONFIG_SCI_GPIO, 1);
 #elif defined(CONFIG_HOSTCMD_ESPI)
@@ -189,22 +212,24 @@ static void lpc_generate_sci(void)
 	 * status should be read from bit 1/0 in eSPI VMEVSM(2) register.
 	 */
 	NPCX_HIPMIC(PMC_ACPI) = NPCX_VW_SCI(1);
-	udelay(65);
+	lpc_sci_wait_high();
 	/* Generate a falling edge */
 	NPCX_HIPMIC(PMC_ACPI) = NPCX_VW_SCI(0);
-	udelay(65);
+	udelay(LPC_SCI_LEVEL_US);
 	/* Set signal high */
 	NPCX_HIPMIC(PMC_ACPI) = NPCX_VW_SCI(1);
 #else
 	/* Set SCIB bit to pull SCI_L to high.*/
 	SET_BIT(NPCX_HIPMIC(PMC_ACPI), NPCX_HIPMIC_SCIB);
-	udelay(65);
+	lpc_sci_wait_high();
 	/* Generate a falling edge */
 	CLEAR_BIT(NPCX_HIPMIC(PMC_ACPI), NPCX_HIPMIC_SCIB);
-	udelay(65);
+	udelay(LPC_SCI_LEVEL_US);
 	/* Set signal high */
 	SET_BIT(NPCX_HIPMIC(PMC_ACPI), NPCX_HIPMIC_SCIB);
 #endif
+	sci_high_time = get_time().le.lo;
+	sci_high = 1;
 
 	sci = lpc_get_host_events_by_type(LPC_HOST_EVENT_SCI);
 	if (sci)
@@ -550,7 +575,7 @@ void lpc_kbc_obe_interrupt(void)
 
 	NPCX_HIKMST &= ~I8042_AUX_DATA;
 
-	task_wake(TASK_ID_KEYPROTO);
+	keyboard_host_read();
 }
 DECLARE_IRQ(NPCX_IRQ_KBC_OBE, lpc_kbc_obe_interrupt, 4);
 #endif
@@ -191,6 +191,62 @@ struct shi_bus_parameters {
 #endif
 } shi_params;
 
+#ifdef CONFIG_HOSTCMD_SPS_STATS
+/* Phases of a SHI transaction */
+enum shi_phase {
+	/* From CS assertion to the whole request being received */
+	SHI_PHASE_RECEIVE = 0,
+	/* Host command execution, the AP reads EC_SPI_PROCESSING meanwhile */
+	SHI_PHASE_PROCESS,
+	/* From the response being ready to CS deassertion */
+	SHI_PHASE_SEND,
+	SHI_PHASE_COUNT
+};
+
+static const char * const shi_phase_names[] = {
+	"receive", "process", "send",
+};
+BUILD_ASSERT(ARRAY_SIZE(shi_phase_names) == SHI_PHASE_COUNT);
+
+/* SHI transaction statistics */
+static struct {
+	uint32_t phase_start;              /* Start time of current phase */
+	uint32_t count[SHI_PHASE_COUNT];   /* Completed phases */
+	uint32_t last_us[SHI_PHASE_COUNT]; /* Duration of the last phase */
+	uint32_t max_us[SHI_PHASE_COUNT];  /* Longest phase */
+	uint64_t total_us[SHI_PHASE_COUNT];
+	uint32_t completed;   /* Responses fully clocked out */
+	uint32_t canceled;    /* CS deasserted while processing */
+	uint32_t bad_data;    /* Invalid or timed out requests */
+	uint32_t unexpected;  /* Events received in an unexpected state */
+	uint32_t refills;     /* Half output buffer refills while sending */
+} shi_stats;
+
+static void shi_stats_phase_start(void)
+{
+	shi_stats.phase_start = get_time().le.lo;
+}
+
+/* Account the phase which just ended and start the next one */
+static void shi_stats_phase_end(enum shi_phase phase)
+{
+	uint32_t now = get_time().le.lo;
+	uint32_t us = now - shi_stats.phase_start;
+
+	shi_stats.count[phase]++;
+	shi_stats.last_us[phase] = us;
+	shi_stats.total_us[phase] += us;
+	if (us > shi_stats.max_us[phase])
+		shi_stats.max_us[phase] = us;
+	shi_stats.phase_start = now;
+}
+#define SHI_STATS_INC(field) (shi_stats.field++)
+#else
+static inline void shi_stats_phase_start(void) {}
+#define shi_stats_phase_end(phase)
+#define SHI_STATS_INC(field)
+#endif
+
 /* Forward declaration */
 static void shi_reset_prepare(void);
 static void shi_bad_received_data(void);
@@ -225,6 +281,8 @@ static void shi_send_response_packet(struct host_packet *pkt)
 		((uint8_t *) pkt->response)[pkt->response_size + 0] =
 			EC_SPI_PAST_END;
 
+		shi_stats_phase_end(SHI_PHASE_PROCESS);
+
 		/* Computing sending bytes of response */
 		shi_params.sz_response =
 			pkt->response_size + SHI_PROTO3_OVERHEAD;
@@ -274,6 +332,7 @@ void shi_handle_host_package(void)
 			return shi_bad_received_data();
 		/* Move to processing state immediately */
 		state = SHI_STATE_PROCESSING;
+		shi_stats_phase_end(SHI_PHASE_RECEIVE);
 		DEBUG_CPRINTF("PRC-");
 	}
 	/* Fill output buffer to indicate we`re processing request */
@@ -444,6 +503,7 @@ static void shi_write_half_outbuf(void)
 	shi_params.sz_sending += size;
 	shi_params.tx_buf = obuf_ptr;
 	shi_params.tx_msg = msg_ptr;
+	SHI_STATS_INC(refills);
 }
 
 /*
@@ -561,6 +621,7 @@ static void shi_bad_received_data(void)
 	/* State machine mismatch, timeout, or protocol we can't handle. */
 	shi_fill_out_status(EC_SPI_RX_BAD_DATA);
 	state = SHI_STATE_BAD_RECEIVED_DATA;
+	SHI_STATS_INC(bad_data);
 
 	CPRINTF("BAD-");
 	CPRINTF("in_msg=[");
@@ -582,6 +643,7 @@ static int last_error_state = -1;
 
 static void log_unexpected_state(char *isr_name)
 {
+	SHI_STATS_INC(unexpected);
 #if !(DEBUG_SHI)
 	if (state != last_error_state)
 		CPRINTS("Unexpected state %d in %s ISR", state, isr_name);
@@ -622,6 +684,7 @@ static void shi_handle_cs_assert(void)
 	}
 
 	DEBUG_CPRINTF("CSL-");
+	shi_stats_phase_start();
 
 	/*
 	 * Clear possible EOR event from previous transaction since it's
@@ -709,6 +772,7 @@ void shi_int_handler(void)
 			shi_fill_out_status(EC_SPI_NOT_READY);
 
 			state = SHI_STATE_CNL_RESP_NOT_RDY;
+			SHI_STATS_INC(canceled);
 
 			/*
 			 * Disable SHI interrupt, it will remain disabled
@@ -730,6 +794,10 @@ void shi_int_handler(void)
 #else
 			log_unexpected_state("IBEOR");
 #endif
+		else {
+			shi_stats_phase_end(SHI_PHASE_SEND);
+			SHI_STATS_INC(completed);
+		}
 
 		/* reset SHI and prepare to next transaction again */
 		shi_reset_prepare();
@@ -1055,6 +1123,40 @@ static void shi_init(void)
 /* Call hook before chipset sets initial power state and calls resume hooks */
 DECLARE_HOOK(HOOK_INIT, shi_init, HOOK_PRIO_INIT_CHIPSET - 1);
 
+#ifdef CONFIG_HOSTCMD_SPS_STATS
+static int command_spsstats(int argc, char **argv)
+{
+	int i;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		interrupt_disable();
+		memset(&shi_stats, 0, sizeof(shi_stats));
+		interrupt_enable();
+		return EC_SUCCESS;
+	}
+
+	ccprintf("phase      count  last us   max us   avg us\n");
+	for (i = 0; i < SHI_PHASE_COUNT; i++) {
+		uint32_t count = shi_stats.count[i];
+
+		ccprintf("%-8s %7d %8d %8d %8d\n", shi_phase_names[i], count,
+			 shi_stats.last_us[i], shi_stats.max_us[i],
+			 count ? (int)(shi_stats.total_us[i] / count) : 0);
+	}
+	ccprintf("completed:  %d\n", shi_stats.completed);
+	ccprintf("canceled:   %d\n", shi_stats.canceled);
+	ccprintf("bad data:   %d\n", shi_stats.bad_data);
+	ccprintf("unexpected: %d\n", shi_stats.unexpected);
+	ccprintf("refills:    %d\n", shi_stats.refills);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(spsstats, command_spsstats, "[clear]",
+			"Print SHI transaction timing statistics");
+#endif
+
 /**
  * Get protocol information
  */
@@ -23,6 +23,7 @@
 #include "task.h"
 #include "timer.h"
 #include "util.h"
+#include "version.h"
 #include "watchdog.h"
 
 /* Delay after writing TTC for value to latch */
@@ -1234,6 +1235,7 @@ void system_jump_to_booter(void)
 	static uint32_t flash_offset;
 	static uint32_t flash_used;
 	static uint32_t addr_entry;
+	const struct image_data *data;
 
 	/*
 	 * Get memory offset and size for RO/RW regions.
@@ -1260,6 +1262,19 @@ void system_jump_to_booter(void)
 		break;
 	}
 
+	/*
+	 * Only download the part of the region the image uses, as reading
+	 * SPI flash is most of the time the jump takes.  The image data sits
+	 * at the same offset in every image, see system_get_image_data().
+	 */
+	data = (const struct image_data *)(flash_offset +
+		CONFIG_MAPPED_STORAGE_BASE +
+		((uintptr_t)&current_image_data - CONFIG_PROGRAM_MEMORY_BASE));
+	if (data->cookie1 == CROS_EC_IMAGE_DATA_COOKIE1 &&
+	    data->cookie2 == CROS_EC_IMAGE_DATA_COOKIE2 &&
+	    data->size > 0 && data->size < flash_used)
+		flash_used = DIV_ROUND_UP(data->size, 16) * 16;
+
 	/* Make sure the reset vector is inside the destination image */
 	addr_entry = *(uintptr_t *)(flash_offset +
 				    CONFIG_MAPPED_STORAGE_BASE + 4);
@@ -296,7 +296,7 @@ void gpio_interrupt(void)
 			g = gpio_ints[i];
 			signal = g - gpio_list;
 			if (g && signal < GPIO_IH_COUNT)
-				gpio_irq_handlers[signal](signal);
+				gpio_irq_dispatch(signal);
 		}
 	}
 
@@ -305,7 +305,7 @@ void gpio_interrupt(void)
 		g = gpio_int_port;
 		signal = g - gpio_list;
 		if (g && signal < GPIO_IH_COUNT)
-			gpio_irq_handlers[signal](signal);
+			gpio_irq_dispatch(signal);
 	}
 }
 DECLARE_IRQ(NRF51_PERID_GPIOTE, gpio_interrupt, 1);
@@ -33,6 +33,19 @@ static inline void crc32_hash16(uint16_t val)
 	STM32_CRC_DR16 = val;
 }
 
+static inline void crc32_hash(const void *buf, int size)
+{
+	const uint8_t *p = buf;
+
+	/* The unit takes whole words at a time, once p is aligned */
+	for (; size && ((uintptr_t)p & 3); size--)
+		STM32_CRC_DR8 = *p++;
+	for (; size >= 4; size -= 4, p += 4)
+		STM32_CRC_DR32 = *(const uint32_t *)p;
+	for (; size; size--)
+		STM32_CRC_DR8 = *p++;
+}
+
 static inline uint32_t crc32_result(void)
 {
 	return STM32_CRC_DR ^ 0xFFFFFFFF;
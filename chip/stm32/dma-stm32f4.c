@@ -5,6 +5,7 @@
 
 #include "common.h"
 #include "console.h"
+#include "cpu.h"
 #include "dma.h"
 #include "hooks.h"
 #include "registers.h"
@@ -120,9 +121,24 @@ void dma_go(stm32_dma_stream_t *stream)
 	stream->scr |= STM32_DMA_CCR_EN;
 }
 
+/*
+ * Number of bytes of memory a transfer of count items covers; the stream
+ * counts items of the peripheral size.
+ */
+static unsigned int dma_memory_size(const struct dma_option *option,
+				    unsigned count)
+{
+	return count << ((option->flags >> 11) & 3);
+}
+
 void dma_prepare_tx(const struct dma_option *option, unsigned count,
 		    const void *memory)
 {
+	/* The DMA reads memory, not the D-cache */
+	if (IS_ENABLED(CONFIG_ARMV7M_CACHE))
+		cpu_clean_dcache_range((uintptr_t)memory,
+				       dma_memory_size(option, count));
+
 	/*
 	 * Cast away const for memory pointer; this is ok because we know
 	 * we're preparing the stream for transmit.
@@ -137,6 +153,14 @@ void dma_start_rx(const struct dma_option *option, unsigned count,
 {
 	stm32_dma_stream_t *stream = dma_get_channel(option->channel);
 
+	/*
+	 * Don't let dirty lines be written back over what the DMA receives.
+	 * The caller still has to invalidate the buffer once it's done.
+	 */
+	if (IS_ENABLED(CONFIG_ARMV7M_CACHE))
+		cpu_clean_invalidate_dcache_range(
+			(uintptr_t)memory, dma_memory_size(option, count));
+
 	prepare_stream(option->channel, count, option->periph, memory,
 			STM32_DMA_CCR_MINC | STM32_DMA_CCR_DIR_P2M |
 			option->flags);
@@ -363,6 +363,14 @@ int flash_physical_write(int offset, int size, const char *data)
 		goto exit_wr;
 	}
 
+	/*
+	 * The loop below waits for each write to complete, so only the first
+	 * one can find the controller busy.
+	 */
+	res = wait_busy();
+	if (res)
+		goto exit_wr;
+
 	/* Clear previous error status */
 	STM32_FLASH_SR = FLASH_SR_ALL_ERR | FLASH_SR_EOP;
 
@@ -381,13 +389,6 @@ int flash_physical_write(int offset, int size, const char *data)
 		 */
 		watchdog_reload();
 
-		/* wait to be ready  */
-		for (i = 0;
-		     (STM32_FLASH_SR & FLASH_SR_BUSY) &&
-		     (i < timeout);
-		     i++)
-			;
-
 		/* write the data */
 		*address++ = quantum;
 
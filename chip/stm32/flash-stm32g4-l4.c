@@ -267,6 +267,15 @@ int flash_physical_write(int offset, int size, const char *data)
 	if (unlock(FLASH_CR_LOCK) != EC_SUCCESS)
 		return EC_ERROR_UNKNOWN;
 
+	/*
+	 * Each double word below is only written once the previous one has
+	 * completed, so the controller just needs to be idle before the first.
+	 */
+	if (wait_while_busy() != EC_SUCCESS) {
+		lock();
+		return EC_ERROR_TIMEOUT;
+	}
+
 	/* Clear previous error status */
 	STM32_FLASH_SR = FLASH_SR_ERR_MASK;
 
@@ -280,15 +289,6 @@ int flash_physical_write(int offset, int size, const char *data)
 		 */
 		watchdog_reload();
 
-		/* wait to be ready  */
-		for (i = 0; (STM32_FLASH_SR & FLASH_SR_BUSY) && (i < timeout);
-		     i++)
-			;
-		if (STM32_FLASH_SR & FLASH_SR_BUSY) {
-			res = EC_ERROR_TIMEOUT;
-			goto exit_wr;
-		}
-
 		/* write the 2 words */
 		if (unaligned) {
 			*address++ = (uint32_t)data[0] | (data[1] << 8)
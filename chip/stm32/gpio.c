@@ -167,7 +167,7 @@ void __keep gpio_interrupt(void)
 		bit = get_next_bit(&pending);
 		signal = exti_events[bit];
 		if (signal < GPIO_IH_COUNT)
-			gpio_irq_handlers[signal](signal);
+			gpio_irq_dispatch(signal);
 	}
 }
 #ifdef CHIP_FAMILY_STM32F0
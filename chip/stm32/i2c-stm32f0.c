@@ -7,6 +7,7 @@
 #include "clock.h"
 #include "common.h"
 #include "console.h"
+#include "dma.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
@@ -56,6 +57,41 @@ static const uint32_t busyloop_us[I2C_FREQ_COUNT] = {
 	[I2C_FREQ_100KHZ] = 0,   /* No busy looping at 100kHz (bus is slow) */
 };
 
+#ifdef CONFIG_I2C_DMA_RX_THRESHOLD
+/*
+ * Only I2C2 has a RX DMA channel of its own without remapping, and the
+ * STM32F09x needs its channels selected first, which this does not do.
+ */
+#ifdef CHIP_VARIANT_STM32F09X
+#error "CONFIG_I2C_DMA_RX_THRESHOLD is not supported on STM32F09x"
+#endif
+#ifndef CONFIG_DMA_DEFAULT_HANDLERS
+#error "CONFIG_I2C_DMA_RX_THRESHOLD needs CONFIG_DMA_DEFAULT_HANDLERS"
+#endif
+
+static const struct dma_option dma_rx_option = {
+	STM32_DMAC_I2C2_RX, (void *)&STM32_I2C_RXDR(STM32_I2C2_PORT),
+	STM32_DMA_CCR_MSIZE_8_BIT | STM32_DMA_CCR_PSIZE_8_BIT,
+};
+
+/* Callback for ISR to wake task on DMA complete. */
+static void i2c_dma_wake_callback(void *cb_data)
+{
+	task_id_t id = (task_id_t)(int)cb_data;
+
+	if (id != TASK_ID_INVALID)
+		task_set_event(id, TASK_EVENT_I2C_COMPLETION(STM32_I2C2_PORT),
+			       0);
+}
+
+static int use_dma_rx(int port, int in_bytes)
+{
+	return port == STM32_I2C2_PORT &&
+	       in_bytes >= CONFIG_I2C_DMA_RX_THRESHOLD &&
+	       task_start_called() && !in_interrupt_context();
+}
+#endif /* CONFIG_I2C_DMA_RX_THRESHOLD */
+
 /**
  * Wait for ISR register to contain the specified mask.
  *
@@ -230,8 +266,14 @@ static void i2c_send_response_packet(struct host_packet *pkt)
 	int size = pkt->response_size;
 	uint8_t *out = host_buffer;
 
-	/* Ignore host command in-progress */
-	if (pkt->driver_result == EC_RES_IN_PROGRESS)
+	/*
+	 * A slow command answers EC_RES_IN_PROGRESS first. If the host can
+	 * poll EC_CMD_GET_COMMS_STATUS, send that right away rather than
+	 * stretching the clock until the command is done; the final result
+	 * is then kept for EC_CMD_RESEND_RESPONSE. Otherwise wait for it.
+	 */
+	if (!IS_ENABLED(CONFIG_HOST_COMMAND_STATUS) &&
+	    pkt->driver_result == EC_RES_IN_PROGRESS)
 		return;
 
 	/* Write result and size to first two bytes. */
@@ -455,6 +497,7 @@ int chip_i2c_xfer(const int port, const uint16_t slave_addr_flags,
 	int i;
 	int xfer_start = flags & I2C_XFER_START;
 	int xfer_stop = flags & I2C_XFER_STOP;
+	int rx_dma = 0;
 
 #if defined(CONFIG_I2C_SCL_GATE_ADDR) && defined(CONFIG_I2C_SCL_GATE_PORT)
 	if (port == CONFIG_I2C_SCL_GATE_PORT &&
@@ -517,6 +560,20 @@ int chip_i2c_xfer(const int port, const uint16_t slave_addr_flags,
 			if (rv)
 				goto xfer_exit;
 		}
+#ifdef CONFIG_I2C_DMA_RX_THRESHOLD
+		rx_dma = use_dma_rx(port, in_bytes);
+		if (rx_dma) {
+			/*
+			 * Let the DMA drain the receive buffer and sleep until
+			 * it is done, instead of polling for each byte.
+			 */
+			dma_start_rx(&dma_rx_option, in_bytes, in);
+			dma_enable_tc_interrupt_callback(dma_rx_option.channel,
+				i2c_dma_wake_callback,
+				(void *)(int)task_get_current());
+			STM32_I2C_CR1(port) |= STM32_I2C_CR1_RXDMAEN;
+		}
+#endif
 		/*
 		 * Configure the read transfer: if we are stopping then set
 		 * AUTOEND bit to automatically set STOP bit after NBYTES.
@@ -530,7 +587,25 @@ int chip_i2c_xfer(const int port, const uint16_t slave_addr_flags,
 			| (!xfer_stop ? STM32_I2C_CR2_RELOAD : 0)
 			| (out_bytes || xfer_start ? STM32_I2C_CR2_START : 0);
 
-		for (i = 0; i < in_bytes; i++) {
+#ifdef CONFIG_I2C_DMA_RX_THRESHOLD
+		if (rx_dma) {
+			uint32_t evt = task_wait_event_mask(
+				TASK_EVENT_I2C_COMPLETION(port),
+				in_bytes * pdata[port].timeout_us);
+
+			dma_disable(dma_rx_option.channel);
+			dma_disable_tc_interrupt(dma_rx_option.channel);
+			STM32_I2C_CR1(port) &= ~STM32_I2C_CR1_RXDMAEN;
+
+			if (!(evt & TASK_EVENT_I2C_COMPLETION(port))) {
+				/* A NACK stops the DMA short of its end */
+				rv = (STM32_I2C_ISR(port) & STM32_I2C_ISR_NACK)
+					? EC_ERROR_UNKNOWN : EC_ERROR_TIMEOUT;
+				goto xfer_exit;
+			}
+		}
+#endif
+		for (i = 0; !rx_dma && i < in_bytes; i++) {
 			/* Wait for receive buffer not empty */
 			rv = wait_isr(port, STM32_I2C_ISR_RXNE);
 			if (rv)
@@ -776,8 +776,13 @@ static void i2c_send_response_packet(struct host_packet *pkt)
 	int size = pkt->response_size;
 	uint8_t *out = host_buffer;
 
-	/* Ignore host command in-progress */
-	if (pkt->driver_result == EC_RES_IN_PROGRESS)
+	/*
+	 * Without comms status the host can't poll for a slow command, so
+	 * hold SCL until its final response. With it, answer IN_PROGRESS
+	 * now; host_send_response() drops the final one.
+	 */
+	if (!IS_ENABLED(CONFIG_HOST_COMMAND_STATUS) &&
+	    pkt->driver_result == EC_RES_IN_PROGRESS)
 		return;
 
 	/* Write result and size to first two bytes. */
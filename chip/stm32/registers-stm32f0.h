@@ -232,6 +232,7 @@
 #define STM32_I2C_CR1_NACKIE        BIT(4)
 #define STM32_I2C_CR1_STOPIE        BIT(5)
 #define STM32_I2C_CR1_ERRIE         BIT(7)
+#define STM32_I2C_CR1_RXDMAEN       BIT(15)
 #define STM32_I2C_CR1_WUPEN         BIT(18)
 #define STM32_I2C_CR2(n)            REG32(stm32_i2c_reg(n, 0x04))
 #define STM32_I2C_CR2_RD_WRN        BIT(10)
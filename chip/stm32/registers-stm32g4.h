@@ -1101,6 +1101,8 @@ enum dma_channel {
 	STM32_DMAC_SPI3_TX = STM32_DMAC_CH10,
 	STM32_DMAC_LPUART_RX = STM32_DMAC_CH9,
 	STM32_DMAC_LPUART_TX = STM32_DMAC_CH10,
+	STM32_DMAC_UCPD1_RX = STM32_DMAC_CH14,
+	STM32_DMAC_UCPD1_TX = STM32_DMAC_CH9,
 	STM32_DMAC_COUNT = 14,
 };
 
@@ -1330,6 +1332,8 @@ enum dmamux1_request {
 	DMAMUX_REQ_SPI4_TX = 107,
 	DMAMUX_REQ_SAI1_A = 108,
 	DMAMUX_REQ_SAI1_B = 109,
+	DMAMUX_REQ_UCPD1_RX = 114,
+	DMAMUX_REQ_UCPD1_TX = 115,
 };
 /* LPUART gets accessed as UART9 in STM32 uart module */
 #define DMAMUX_REQ_UART9_RX DMAMUX_REQ_LPUART1_RX
@@ -80,7 +80,14 @@ static const struct dma_option dma_rx_option = {
  * of flash data.
  */
 #define SPI_MAX_REQUEST_SIZE 0x220
+#ifdef CONFIG_SPI_MAX_RESPONSE_SIZE
+#define SPI_MAX_RESPONSE_SIZE CONFIG_SPI_MAX_RESPONSE_SIZE
+#else
 #define SPI_MAX_RESPONSE_SIZE 0x220
+#endif
+/* The whole response goes out in one DMA transfer. */
+BUILD_ASSERT(SPI_MAX_RESPONSE_SIZE >= 0x220 &&
+	     SPI_MAX_RESPONSE_SIZE < 0x10000);
 
 /*
  * The AP blindly clocks back bytes over the SPI interface looking for a
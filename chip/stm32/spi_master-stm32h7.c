@@ -7,6 +7,7 @@
  */
 
 #include "common.h"
+#include "cpu.h"
 #include "dma.h"
 #include "gpio.h"
 #include "shared_mem.h"
@@ -46,6 +47,12 @@ static uint8_t dma_req_rx[ARRAY_SIZE(SPI_REGS)] = {
 
 static struct mutex spi_mutex[ARRAY_SIZE(SPI_REGS)];
 
+/* Buffer the RX DMA is filling, to invalidate in the D-cache when done */
+static struct {
+	uint8_t *data;
+	int len;
+} spi_rx[ARRAY_SIZE(SPI_REGS)];
+
 #define SPI_TRANSACTION_TIMEOUT_USEC (800 * MSEC)
 
 static const struct dma_option dma_tx_option[] = {
@@ -194,8 +201,11 @@ static int spi_dma_start(int port, const uint8_t *txdata,
 	spi->cr2 = len;
 	spi->cfg1 |= STM32_SPI_CFG1_RXDMAEN;
 	/* Set up RX DMA */
-	if (rxdata)
+	if (rxdata) {
+		spi_rx[port].data = rxdata;
+		spi_rx[port].len = len;
 		dma_start_rx(&dma_rx_option[port], len, rxdata);
+	}
 
 	/* Set up TX DMA */
 	if (txdata) {
@@ -252,6 +262,11 @@ static int spi_dma_wait(int port)
 
 		/* Disable RX DMA */
 		dma_disable(dma_rx_option[port].channel);
+
+		if (IS_ENABLED(CONFIG_ARMV7M_CACHE))
+			cpu_invalidate_dcache_range(
+				(uintptr_t)spi_rx[port].data,
+				spi_rx[port].len);
 	}
 
 	spi->cr1 &= ~STM32_SPI_CR1_SPE;
@@ -7,15 +7,28 @@
 
 #include "clock.h"
 #include "common.h"
+#include "console.h"
+#include "dma.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "registers.h"
+#include "stm32-dma.h"
 #include "task.h"
+#include "tcpm.h"
+#include "timer.h"
 #include "ucpd-stm32gx.h"
 #include "usb_pd.h"
 #include "usb_pd_tcpm.h"
 #include "util.h"
 
+#define CPRINTS(format, args...) cprints(CC_USBPD, format, ## args)
+
+#ifndef CONFIG_USB_PD_TCPM_STM32GX_RX_DMA_CH
+#define CONFIG_USB_PD_TCPM_STM32GX_RX_DMA_CH STM32_DMAC_UCPD1_RX
+#endif
+#ifndef CONFIG_USB_PD_TCPM_STM32GX_TX_DMA_CH
+#define CONFIG_USB_PD_TCPM_STM32GX_TX_DMA_CH STM32_DMAC_UCPD1_TX
+#endif
 
 /*
  * UCPD is fed directly from HSI which is @ 16MHz. The ucpd_clk goes to
@@ -47,6 +60,84 @@
 #define UCPD_ANASUB_TO_RP(r) ((r - 1) & 0x3)
 #define UCPD_RP_TO_ANASUB(r) ((r + 1) & 0x3)
 
+/* Ordered sets detected by the receiver, see CFGR1.RXORDSETEN */
+#define UCPD_RXORDSETEN_SOP		BIT(0)
+#define UCPD_RXORDSETEN_SOP1		BIT(1)
+#define UCPD_RXORDSETEN_SOP2		BIT(2)
+#define UCPD_RXORDSETEN_HARD_RESET	BIT(3)
+#define UCPD_RXORDSETEN_CABLE_RESET	BIT(4)
+#define UCPD_RXORDSETEN_SOP1_DEBUG	BIT(5)
+#define UCPD_RXORDSETEN_SOP2_DEBUG	BIT(6)
+
+/* CR.TXMODE values */
+#define UCPD_TXMODE_NORMAL	0
+#define UCPD_TXMODE_CABLE_RESET	1
+
+/* Message header and up to 7 data objects, the CRC is checked by the UCPD */
+#define UCPD_BUF_LEN 30
+
+/* Time to wait for GoodCRC after a message was sent (tReceive max) */
+#define UCPD_T_RECEIVE_US 1100
+
+/*
+ * Ordered sets to transmit, indexed by enum tcpm_transmit_type. Messages are
+ * only sent with the first five, resets with the next two.
+ */
+static const uint32_t ucpd_tx_ordsets[] = {
+	[TCPC_TX_SOP] = TX_ORDERSET_SOP,
+	[TCPC_TX_SOP_PRIME] = TX_ORDERSET_SOP1,
+	[TCPC_TX_SOP_PRIME_PRIME] = TX_ORDERSET_SOP2,
+	[TCPC_TX_SOP_DEBUG_PRIME] = TX_ORDERSET_SOP1_DEBUG,
+	[TCPC_TX_SOP_DEBUG_PRIME_PRIME] = TX_ORDERSET_SOP2_DEBUG,
+	[TCPC_TX_HARD_RESET] = TX_ORDERSET_HARD_RESET,
+	[TCPC_TX_CABLE_RESET] = TX_ORDERSET_CABLE_RESET,
+};
+
+enum ucpd_tx_state {
+	UCPD_TX_IDLE,
+	/* GoodCRC for a received message is being sent */
+	UCPD_TX_GOOD_CRC,
+	/* Message from the protocol layer is being sent */
+	UCPD_TX_MSG,
+	/* Message was sent, waiting for the partner's GoodCRC */
+	UCPD_TX_WAIT_GOOD_CRC,
+	UCPD_TX_HARD_RESET,
+};
+
+/*
+ * State of the PD PHY. The STM32G4 has a single UCPD, so there is a single
+ * instance of it, used from the UCPD interrupt and the PD task. The PD task
+ * only touches it with interrupts disabled.
+ */
+static struct {
+	enum ucpd_tx_state tx_state;
+	/* Message from the protocol layer queued behind a GoodCRC */
+	uint8_t tx_pending;
+	enum tcpm_transmit_type tx_type;
+	uint8_t tx_retries;
+	uint16_t tx_len;
+	uint8_t tx_buf[UCPD_BUF_LEN];
+	uint16_t good_crc;
+	uint8_t power_role;
+	uint8_t data_role;
+	uint8_t sop_prime_enabled;
+	uint16_t rx_len;
+	enum tcpm_transmit_type rx_type;
+	uint8_t rx_buf[UCPD_BUF_LEN];
+} ucpd;
+
+static const struct dma_option ucpd_rx_dma = {
+	.channel = CONFIG_USB_PD_TCPM_STM32GX_RX_DMA_CH,
+	.periph = (void *)&STM32_UCPD_RXDR(0),
+	.flags = STM32_DMA_CCR_MSIZE_8_BIT | STM32_DMA_CCR_PSIZE_8_BIT,
+};
+
+static const struct dma_option ucpd_tx_dma = {
+	.channel = CONFIG_USB_PD_TCPM_STM32GX_TX_DMA_CH,
+	.periph = (void *)&STM32_UCPD_TXDR(0),
+	.flags = STM32_DMA_CCR_MSIZE_8_BIT | STM32_DMA_CCR_PSIZE_8_BIT,
+};
+
 static void ucpd_port_enable(int port, int enable)
 {
 	if (enable)
@@ -63,17 +154,193 @@ static int ucpd_is_cc_pull_active(int port, enum usbpd_cc_pin cc_line)
 	return ((cc_enable >> cc_line) & 0x1);
 }
 
+static void ucpd_rx_dma_start(void)
+{
+	dma_start_rx(&ucpd_rx_dma, sizeof(ucpd.rx_buf), ucpd.rx_buf);
+}
+
+static void ucpd_tx_start(int port, enum tcpm_transmit_type type,
+			  const void *buf, int len)
+{
+	uint32_t cr = STM32_UCPD_CR(port) & ~STM32_UCPD_CR_TXMODE_MASK;
+
+	STM32_UCPD_TX_ORDSETR(port) = ucpd_tx_ordsets[type];
+	STM32_UCPD_TX_PAYSZR(port) = len;
+	if (len) {
+		dma_prepare_tx(&ucpd_tx_dma, len, buf);
+		dma_go(dma_get_channel(ucpd_tx_dma.channel));
+	}
+
+	if (type == TCPC_TX_CABLE_RESET)
+		cr |= STM32_UCPD_CR_TXMODE_VAL(UCPD_TXMODE_CABLE_RESET);
+	else
+		cr |= STM32_UCPD_CR_TXMODE_VAL(UCPD_TXMODE_NORMAL);
+	STM32_UCPD_CR(port) = cr | STM32_UCPD_CR_TXSEND;
+}
+
+static void ucpd_tx_msg_start(int port)
+{
+	ucpd.tx_state = UCPD_TX_MSG;
+	ucpd_tx_start(port, ucpd.tx_type, ucpd.tx_buf, ucpd.tx_len);
+}
+
+static void ucpd_tx_timeout(void);
+DECLARE_DEFERRED(ucpd_tx_timeout);
+
+/* Report the outcome of the protocol layer's transmission. */
+static void ucpd_tx_done(int port, int status, uint32_t *evt)
+{
+	hook_call_deferred(&ucpd_tx_timeout_data, -1);
+	ucpd.tx_state = UCPD_TX_IDLE;
+	pd_transmit_complete(port, status);
+	*evt |= PD_EVENT_TX;
+}
+
+static void ucpd_tx_timeout(void)
+{
+	/* STM32G4 has a single UCPD */
+	int port = 0;
+	uint32_t evt = 0;
+
+	interrupt_disable();
+	if (ucpd.tx_state == UCPD_TX_WAIT_GOOD_CRC) {
+		if (ucpd.tx_retries) {
+			ucpd.tx_retries--;
+			ucpd_tx_msg_start(port);
+		} else {
+			ucpd_tx_done(port, TCPC_TX_COMPLETE_FAILED, &evt);
+		}
+	}
+	interrupt_enable();
+
+	if (evt)
+		task_set_event(PD_PORT_TO_TASK_ID(port), evt, 0);
+}
+
+static void ucpd_handle_tx(int port, uint32_t sr, uint32_t *evt)
+{
+	if (sr & STM32_UCPD_SR_HRSTSENT)
+		ucpd_tx_done(port, TCPC_TX_COMPLETE_SUCCESS, evt);
+	else if (sr & STM32_UCPD_SR_HRSTDISC)
+		ucpd_tx_done(port, TCPC_TX_COMPLETE_FAILED, evt);
+
+	if (!(sr & (STM32_UCPD_SR_TXMSGSENT | STM32_UCPD_SR_TXMSGDISC |
+		    STM32_UCPD_SR_TXMSGABT)))
+		return;
+
+	switch (ucpd.tx_state) {
+	case UCPD_TX_GOOD_CRC:
+		/* A lost GoodCRC is recovered by the partner's retry */
+		ucpd.tx_state = UCPD_TX_IDLE;
+		if (ucpd.tx_pending) {
+			ucpd.tx_pending = 0;
+			ucpd_tx_msg_start(port);
+		}
+		break;
+	case UCPD_TX_MSG:
+		if (!(sr & STM32_UCPD_SR_TXMSGSENT)) {
+			/* Discarded by an incoming message, or aborted */
+			ucpd_tx_done(port, TCPC_TX_COMPLETE_FAILED, evt);
+		} else if (ucpd.tx_type == TCPC_TX_CABLE_RESET) {
+			ucpd_tx_done(port, TCPC_TX_COMPLETE_SUCCESS, evt);
+		} else {
+			ucpd.tx_state = UCPD_TX_WAIT_GOOD_CRC;
+			hook_call_deferred(&ucpd_tx_timeout_data,
+					   UCPD_T_RECEIVE_US);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static void ucpd_send_good_crc(int port, enum tcpm_transmit_type type,
+			       uint16_t header)
+{
+	int sop = type == TCPC_TX_SOP;
+
+	/* The roles are only reported in SOP messages */
+	ucpd.good_crc = PD_HEADER(PD_CTRL_GOOD_CRC,
+				  sop ? ucpd.power_role : PD_PLUG_FROM_DFP_UFP,
+				  sop ? ucpd.data_role : 0,
+				  PD_HEADER_ID(header), 0,
+				  PD_HEADER_REV(header), 0);
+	ucpd.tx_state = UCPD_TX_GOOD_CRC;
+	ucpd_tx_start(port, type, &ucpd.good_crc, sizeof(ucpd.good_crc));
+}
+
+static void ucpd_handle_rx(int port, uint32_t *evt)
+{
+	uint16_t header = ucpd.rx_buf[0] | (ucpd.rx_buf[1] << 8);
+	int good_crc = PD_HEADER_CNT(header) == 0 &&
+		       PD_HEADER_TYPE(header) == PD_CTRL_GOOD_CRC;
+
+	ucpd.rx_type = STM32_UCPD_RX_ORDSETR(port) & STM32_UCPD_RXORDSETR_MASK;
+	ucpd.rx_len = STM32_UCPD_RX_PAYSZR(port) & STM32_UCPD_RX_PAYSZR_MASK;
+
+	/* Cable messages are only picked up when SOP' is enabled */
+	if (ucpd.rx_type > TCPC_TX_SOP_DEBUG_PRIME_PRIME ||
+	    (ucpd.rx_type != TCPC_TX_SOP && !ucpd.sop_prime_enabled) ||
+	    ucpd.rx_len < 2)
+		return;
+
+	if (good_crc) {
+		if ((ucpd.tx_state == UCPD_TX_WAIT_GOOD_CRC ||
+		     ucpd.tx_state == UCPD_TX_MSG) &&
+		    ucpd.rx_type == ucpd.tx_type &&
+		    PD_HEADER_ID(header) ==
+		    PD_HEADER_ID(ucpd.tx_buf[0] | (ucpd.tx_buf[1] << 8)))
+			ucpd_tx_done(port, TCPC_TX_COMPLETE_SUCCESS, evt);
+		return;
+	}
+
+	/* A message from the partner means our message got no GoodCRC */
+	if (ucpd.tx_state == UCPD_TX_WAIT_GOOD_CRC)
+		ucpd_tx_done(port, TCPC_TX_COMPLETE_FAILED, evt);
+
+	/*
+	 * GoodCRC has to go out within tTransmit, so send it right from the
+	 * interrupt instead of waiting for the PD task.
+	 */
+	if (ucpd.tx_state == UCPD_TX_IDLE)
+		ucpd_send_good_crc(port, ucpd.rx_type, header);
+
+	tcpm_enqueue_message(port);
+}
+
 void stm32gx_ucpd1_irq(void)
 {
 	/* STM32_IRQ_UCPD indicates this is from UCPD1, so port = 0 */
 	int port = 0;
 	uint32_t sr = STM32_UCPD_SR(port);
+	uint32_t evt = 0;
 
-	if (sr & (STM32_UCPD_SR_TYPECEVT1 | STM32_UCPD_SR_TYPECEVT2)) {
-		task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_CC, 0);
-	}
-	/* Clear interrupts now that PD events have been set */
+	/* Clear the interrupts handled below */
 	STM32_UCPD_ICR(port) = sr;
+
+	if (sr & (STM32_UCPD_SR_TYPECEVT1 | STM32_UCPD_SR_TYPECEVT2))
+		evt |= PD_EVENT_CC;
+
+	/* TX completions first: a GoodCRC may be received in the same batch */
+	ucpd_handle_tx(port, sr, &evt);
+
+	if (sr & STM32_UCPD_SR_RXHRSTDET) {
+		ucpd.tx_state = UCPD_TX_IDLE;
+		ucpd.tx_pending = 0;
+		hook_call_deferred(&ucpd_tx_timeout_data, -1);
+		evt |= PD_EVENT_RX_HARD_RESET;
+	}
+
+	if (sr & STM32_UCPD_SR_RXMSGEND) {
+		if (!(sr & (STM32_UCPD_SR_RXERR | STM32_UCPD_SR_RXOVR)))
+			ucpd_handle_rx(port, &evt);
+		/* Re-arm reception for the next message */
+		ucpd_rx_dma_start();
+	}
+
+	/* All the PD task events of this batch are posted at once */
+	if (evt)
+		task_set_event(PD_PORT_TO_TASK_ID(port), evt, 0);
 }
 DECLARE_IRQ(STM32_IRQ_UCPD1, stm32gx_ucpd1_irq, 1);
 
@@ -98,18 +365,39 @@ int stm32gx_ucpd_init(int port)
 	 */
 	ucpd_port_enable(port, 0);
 
+	/*
+	 * All the SOP* ordered sets are detected, SOP' and SOP'' messages are
+	 * dropped in software while they are not enabled. Message bytes are
+	 * moved by DMA in both directions.
+	 */
 	cfgr1_reg = STM32_UCPD_CFGR1_PSC_CLK_VAL(UCPD_PSC_DIV - 1) |
-		STM32_UCPD_CFGR1_TRANSWIN_VAL(UCPD_TRANSWIN_CNT - 1) |
-		STM32_UCPD_CFGR1_IFRGAP_VAL(UCPD_IFRGAP_CNT - 1) |
-		STM32_UCPD_CFGR1_HBITCLKD_VAL(UCPD_HBIT_DIV - 1);
+		STM32_UCPD_CFGR1_TRANSWIN_VAL(UCPD_TRANSWIN_HBIT_CNT - 1) |
+		STM32_UCPD_CFGR1_IFRGAP_VAL(UCPD_IFRGAP_HBIT_CNT - 1) |
+		STM32_UCPD_CFGR1_HBITCLKD_VAL(UCPD_HBIT_DIV - 1) |
+		STM32_UCPD_CFGR1_RXORDSETEN_VAL(UCPD_RXORDSETEN_SOP |
+						UCPD_RXORDSETEN_SOP1 |
+						UCPD_RXORDSETEN_SOP2 |
+						UCPD_RXORDSETEN_HARD_RESET |
+						UCPD_RXORDSETEN_SOP1_DEBUG |
+						UCPD_RXORDSETEN_SOP2_DEBUG) |
+		STM32_UCPD_CFGR1_RXDMAEN | STM32_UCPD_CFGR1_TXDMAEN;
 	STM32_UCPD_CFGR1(port) = cfgr1_reg;
 
+	dma_select_channel(ucpd_rx_dma.channel, DMAMUX_REQ_UCPD1_RX);
+	dma_select_channel(ucpd_tx_dma.channel, DMAMUX_REQ_UCPD1_TX);
+	ucpd.tx_state = UCPD_TX_IDLE;
+	ucpd.tx_pending = 0;
+
 	/* Enable ucpd  */
 	ucpd_port_enable(port, 1);
 
-	/* Configure CC change interrupts */
+	/* Configure CC change and PD message interrupts */
 	STM32_UCPD_IMR(port) = STM32_UCPD_IMR_TYPECEVT1IE |
-		STM32_UCPD_IMR_TYPECEVT2IE;
+		STM32_UCPD_IMR_TYPECEVT2IE |
+		STM32_UCPD_IMR_TXMSGDISCIE | STM32_UCPD_IMR_TXMSGSENTIE |
+		STM32_UCPD_IMR_TXMSGABTIE | STM32_UCPD_IMR_HRSTDISCIE |
+		STM32_UCPD_IMR_HRSTSENTIE | STM32_UCPD_IMR_RXHRSTDETIE |
+		STM32_UCPD_IMR_RXMSGENDIE;
 	STM32_UCPD_ICR(port) = STM32_UCPD_ICR_TYPECEVT1CF |
 		STM32_UCPD_ICR_TYPECEVT2CF;
 
@@ -121,6 +409,9 @@ int stm32gx_ucpd_init(int port)
 
 int stm32gx_ucpd_release(int port)
 {
+	hook_call_deferred(&ucpd_tx_timeout_data, -1);
+	dma_disable(ucpd_rx_dma.channel);
+	dma_disable(ucpd_tx_dma.channel);
 	ucpd_port_enable(port, 0);
 
 	return EC_SUCCESS;
@@ -275,3 +566,83 @@ int stm32gx_ucpd_set_polarity(int port, enum tcpc_cc_polarity polarity)
 	return EC_SUCCESS;
 }
 
+int stm32gx_ucpd_set_msg_header(int port, int power_role, int data_role)
+{
+	ucpd.power_role = power_role;
+	ucpd.data_role = data_role;
+
+	return EC_SUCCESS;
+}
+
+int stm32gx_ucpd_set_rx_enable(int port, int enable)
+{
+	if (enable) {
+		ucpd_rx_dma_start();
+		STM32_UCPD_CR(port) |= STM32_UCPD_CR_PHYRXEN;
+	} else {
+		STM32_UCPD_CR(port) &= ~STM32_UCPD_CR_PHYRXEN;
+		dma_disable(ucpd_rx_dma.channel);
+	}
+
+	return EC_SUCCESS;
+}
+
+int stm32gx_ucpd_sop_prime_enable(int port, bool enable)
+{
+	ucpd.sop_prime_enabled = enable;
+
+	return EC_SUCCESS;
+}
+
+int stm32gx_ucpd_transmit(int port, enum tcpm_transmit_type type,
+			  uint16_t header, const uint32_t *data)
+{
+	int len = 2 + PD_HEADER_CNT(header) * 4;
+
+	if (type > TCPC_TX_CABLE_RESET || len > UCPD_BUF_LEN)
+		return EC_ERROR_UNIMPLEMENTED;
+
+	interrupt_disable();
+
+	if (type == TCPC_TX_HARD_RESET) {
+		/* Hard Reset takes over whatever was going on */
+		hook_call_deferred(&ucpd_tx_timeout_data, -1);
+		ucpd.tx_pending = 0;
+		ucpd.tx_state = UCPD_TX_HARD_RESET;
+		STM32_UCPD_TX_ORDSETR(port) = ucpd_tx_ordsets[type];
+		STM32_UCPD_CR(port) |= STM32_UCPD_CR_TXHRST;
+		interrupt_enable();
+		return EC_SUCCESS;
+	}
+
+	ucpd.tx_type = type;
+	ucpd.tx_retries = type == TCPC_TX_CABLE_RESET ? 0 :
+			  CONFIG_PD_RETRY_COUNT;
+	if (type == TCPC_TX_CABLE_RESET) {
+		ucpd.tx_len = 0;
+	} else {
+		ucpd.tx_len = len;
+		ucpd.tx_buf[0] = header & 0xff;
+		ucpd.tx_buf[1] = header >> 8;
+		memcpy(ucpd.tx_buf + 2, data, len - 2);
+	}
+
+	/* Our GoodCRC goes out first, the message follows when it is sent */
+	if (ucpd.tx_state == UCPD_TX_GOOD_CRC)
+		ucpd.tx_pending = 1;
+	else
+		ucpd_tx_msg_start(port);
+
+	interrupt_enable();
+
+	return EC_SUCCESS;
+}
+
+int stm32gx_ucpd_get_message_raw(int port, uint32_t *payload, int *head)
+{
+	*head = (ucpd.rx_buf[0] | (ucpd.rx_buf[1] << 8)) |
+		PD_HEADER_SOP(ucpd.rx_type);
+	memcpy(payload, ucpd.rx_buf + 2, MIN(ucpd.rx_len - 2, 28));
+
+	return EC_SUCCESS;
+}
@@ -108,4 +108,61 @@ int stm32gx_ucpd_set_cc(int usbc_port, int cc_pull, int rp);
  */
 int stm32gx_ucpd_set_polarity(int usbc_port, enum tcpc_cc_polarity polarity);
 
+/**
+ * STM32Gx UCPD implementation of tcpci .set_msg_header method
+ *
+ * The roles are used in the GoodCRC headers the UCPD interrupt sends.
+ *
+ * @param usbc_port -> USB-C Port number
+ * @param power_role -> port's power role
+ * @param data_role -> port's data role
+ * @return EC_SUCCESS
+ */
+int stm32gx_ucpd_set_msg_header(int usbc_port, int power_role, int data_role);
+
+/**
+ * STM32Gx UCPD implementation of tcpci .set_rx_enable method
+ *
+ * @param usbc_port -> USB-C Port number
+ * @param enable -> on/off
+ * @return EC_SUCCESS
+ */
+int stm32gx_ucpd_set_rx_enable(int usbc_port, int enable);
+
+/**
+ * STM32Gx UCPD implementation of tcpci .sop_prime_disable method
+ *
+ * @param usbc_port -> USB-C Port number
+ * @param enable -> whether SOP' and SOP'' messages are received
+ * @return EC_SUCCESS
+ */
+int stm32gx_ucpd_sop_prime_enable(int usbc_port, bool enable);
+
+/**
+ * STM32Gx UCPD implementation of tcpci .transmit method
+ *
+ * Messages go out by DMA. GoodCRC is awaited for up to tReceive and the
+ * message retried CONFIG_PD_RETRY_COUNT times before it is reported failed.
+ *
+ * @param usbc_port -> USB-C Port number
+ * @param type -> SOP* type or reset to send
+ * @param header -> PD message header
+ * @param data -> pointer to the data objects
+ * @return EC_SUCCESS or EC_ERROR_UNIMPLEMENTED for BIST carrier mode
+ */
+int stm32gx_ucpd_transmit(int usbc_port, enum tcpm_transmit_type type,
+			  uint16_t header, const uint32_t *data);
+
+/**
+ * STM32Gx UCPD implementation of tcpci .get_message_raw method
+ *
+ * Reads the message the UCPD interrupt just received.
+ *
+ * @param usbc_port -> USB-C Port number
+ * @param payload -> data objects of the message
+ * @param head -> message header, with the SOP* type in bits 31:28
+ * @return EC_SUCCESS
+ */
+int stm32gx_ucpd_get_message_raw(int usbc_port, uint32_t *payload, int *head);
+
 #endif /* __CROS_EC_UCPD_STM32GX_H */
@@ -267,13 +267,68 @@ static struct usart_rx_dma const usart_host_command_rx_dma = {
 	.channel     = STM32_DMAS_USART1_RX,
 };
 
+#ifdef CONFIG_USART_HOST_COMMAND_TX_DMA
+/*
+ * Response transmission by DMA
+ *
+ * The response is already complete in usart_out_buffer when it is sent,
+ * so it goes out in a single DMA transfer. The USART interrupt only runs
+ * on transmission complete, to reset the layer for the next request.
+ */
+static const struct dma_option usart_host_command_tx_dma_option = {
+	.channel = STM32_DMAS_USART1_TX,
+	.periph  = (void *)&STM32_USART_TDR(STM32_USART1_BASE),
+	.flags   = (STM32_DMA_CCR_MSIZE_8_BIT |
+		    STM32_DMA_CCR_PSIZE_8_BIT |
+		    STM32_DMA_CCR_CHANNEL(STM32_REQ_USART1_TX)),
+};
+
+static void usart_host_command_tx_dma_init(struct usart_config const *config)
+{
+	intptr_t base = config->hw->base;
+
+	STM32_USART_CR1(base) |= STM32_USART_CR1_TE;
+	STM32_USART_CR3(base) |= STM32_USART_CR3_DMAT;
+}
+
+static void usart_host_command_tx_dma_interrupt(
+		struct usart_config const *config)
+{
+	intptr_t base = config->hw->base;
+
+	if (!(STM32_USART_CR1(base) & STM32_USART_CR1_TCIE) ||
+	    !(STM32_USART_SR(base) & STM32_USART_SR_TC))
+		return;
+
+	STM32_USART_CR1(base) &= ~STM32_USART_CR1_TCIE;
+	dma_disable(usart_host_command_tx_dma_option.channel);
+	enable_sleep(SLEEP_MASK_UART);
+
+	usart_host_command_reset();
+}
+
+static struct usart_tx const usart_host_command_tx_dma = {
+	.consumer_ops = {
+		.written = NULL,
+	},
+
+	.init      = usart_host_command_tx_dma_init,
+	.interrupt = usart_host_command_tx_dma_interrupt,
+	.info      = NULL,
+};
+#endif /* CONFIG_USART_HOST_COMMAND_TX_DMA */
+
 /*
  * Configure USART structure with hardware, interrupt handlers, baudrate.
  */
 static struct usart_config const tl_usart = {
 	.hw	= &CONFIG_UART_HOST_COMMAND_HW,
 	.rx	= &usart_host_command_rx_dma.usart_rx,
+#ifdef CONFIG_USART_HOST_COMMAND_TX_DMA
+	.tx	= &usart_host_command_tx_dma,
+#else
 	.tx	= &usart_host_command_tx_interrupt,
+#endif
 	.state	= &((struct usart_state){}),
 	.baud	= CONFIG_UART_HOST_COMMAND_BAUD_RATE,
 	.flags	= 0,
@@ -415,10 +470,24 @@ static void usart_host_command_process_response(struct host_packet *pkt)
 	usart_out_datalen = pkt->response_size;
 	usart_out_head = 0;
 
+#ifdef CONFIG_USART_HOST_COMMAND_TX_DMA
+	if (usart_out_datalen == 0) {
+		usart_host_command_reset();
+		return;
+	}
+
+	disable_sleep(SLEEP_MASK_UART);
+	dma_prepare_tx(&usart_host_command_tx_dma_option, usart_out_datalen,
+		       usart_out_buffer);
+	usart_clear_tc(&tl_usart);
+	STM32_USART_CR1(tl_usart.hw->base) |= STM32_USART_CR1_TCIE;
+	dma_go(dma_get_channel(usart_host_command_tx_dma_option.channel));
+#else
 	/* Start sending response to host via usart tx by
 	 * triggering tx interrupt.
 	 */
 	usart_tx_start(&tl_usart);
+#endif
 }
 
 /*
@@ -86,7 +86,7 @@ struct consumer_ops const usb_stream_consumer_ops = {
 	.written = usb_written,
 };
 
-void usb_stream_deferred(struct usb_stream_config const *config)
+static void usb_stream_refill(struct usb_stream_config const *config)
 {
 	if (!tx_valid(config) && tx_write(config))
 		STM32_TOGGLE_EP(config->endpoint, EP_TX_MASK, EP_TX_VALID, 0);
@@ -95,18 +95,40 @@ void usb_stream_deferred(struct usb_stream_config const *config)
 		STM32_TOGGLE_EP(config->endpoint, EP_RX_MASK, EP_RX_VALID, 0);
 }
 
+void usb_stream_deferred(struct usb_stream_config const *config)
+{
+	/*
+	 * The endpoint interrupts refill the endpoint buffers as well: keep
+	 * them from doing so between our checks and copies.  This only holds
+	 * the interrupts for a packet copy.
+	 */
+	if (IS_ENABLED(CONFIG_STREAM_USB_ISR_REFILL))
+		interrupt_disable();
+
+	usb_stream_refill(config);
+
+	if (IS_ENABLED(CONFIG_STREAM_USB_ISR_REFILL))
+		interrupt_enable();
+}
+
 void usb_stream_tx(struct usb_stream_config const *config)
 {
 	STM32_TOGGLE_EP(config->endpoint, 0, 0, 0);
 
-	hook_call_deferred(config->deferred, 0);
+	if (IS_ENABLED(CONFIG_STREAM_USB_ISR_REFILL))
+		usb_stream_refill(config);
+	else
+		hook_call_deferred(config->deferred, 0);
 }
 
 void usb_stream_rx(struct usb_stream_config const *config)
 {
 	STM32_TOGGLE_EP(config->endpoint, 0, 0, 0);
 
-	hook_call_deferred(config->deferred, 0);
+	if (IS_ENABLED(CONFIG_STREAM_USB_ISR_REFILL))
+		usb_stream_refill(config);
+	else
+		hook_call_deferred(config->deferred, 0);
 }
 
 static usb_uint usb_ep_rx_size(size_t bytes)
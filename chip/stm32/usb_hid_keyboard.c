@@ -38,8 +38,13 @@ struct key_event {
 	uint8_t pressed;
 };
 
+/*
+ * Key events are added in task context and merged into the report from
+ * either task context or the endpoint interrupt, as soon as the host has
+ * taken the previous report. The queue and the report are therefore only
+ * touched with interrupts disabled.
+ */
 static struct queue const key_queue = QUEUE_NULL(16, struct key_event);
-static struct mutex key_queue_mutex;
 
 enum hid_protocol {
 	HID_BOOT_PROTOCOL = 0,
@@ -324,7 +329,6 @@ static usb_uint hid_ep_rx_buf[EP_RX_BUF_SIZE] __usb_ram;
 static struct usb_hid_keyboard_report report;
 
 static void keyboard_process_queue(void);
-DECLARE_DEFERRED(keyboard_process_queue);
 
 static void write_keyboard_report(void)
 {
@@ -384,8 +388,9 @@ static void hid_keyboard_tx(void)
 		hid_ep_data_ready = 0;
 	}
 
+	/* Merge the next key events right away, ready for the next poll. */
 	if (queue_count(&key_queue) > 0)
-		hook_call_deferred(&keyboard_process_queue_data, 0);
+		keyboard_process_queue();
 }
 
 static void hid_keyboard_event(enum usb_ep_event evt)
@@ -414,7 +419,7 @@ static void hid_keyboard_event(enum usb_ep_event evt)
 	}
 
 	if (evt == USB_EVENT_DEVICE_RESUME && queue_count(&key_queue) > 0)
-		hook_call_deferred(&keyboard_process_queue_data, 0);
+		keyboard_process_queue();
 }
 
 USB_DECLARE_EP(USB_EP_HID_KEYBOARD, hid_keyboard_tx,
@@ -476,9 +481,8 @@ USB_DECLARE_IFACE(USB_IFACE_HID_KEYBOARD, hid_keyboard_iface_request)
 
 void keyboard_clear_buffer(void)
 {
-	mutex_lock(&key_queue_mutex);
+	interrupt_disable();
 	queue_init(&key_queue);
-	mutex_unlock(&key_queue_mutex);
 
 	memset(&report, 0, sizeof(report));
 #ifdef CONFIG_KEYBOARD_TABLET_MODE_SWITCH
@@ -487,6 +491,7 @@ void keyboard_clear_buffer(void)
 					 HID_KEYBOARD_EXTRA_LOW);
 #endif
 	write_keyboard_report();
+	interrupt_enable();
 }
 
 static void keyboard_process_queue(void)
@@ -504,10 +509,10 @@ static void keyboard_process_queue(void)
 			usb_is_suspended(), hid_ep_data_ready,
 			(STM32_USB_EP(USB_EP_HID_KEYBOARD) & EP_TX_MASK)
 			== EP_TX_VALID);
-	mutex_lock(&key_queue_mutex);
+	interrupt_disable();
 
 	if (queue_count(&key_queue) == 0) {
-		mutex_unlock(&key_queue_mutex);
+		interrupt_enable();
 		return;
 	}
 
@@ -516,7 +521,7 @@ static void keyboard_process_queue(void)
 
 		if (!queue_is_full(&key_queue)) {
 			/* Queue still has space, let's keep gathering keys. */
-			mutex_unlock(&key_queue_mutex);
+			interrupt_enable();
 			return;
 		}
 
@@ -600,10 +605,10 @@ static void keyboard_process_queue(void)
 		}
 	}
 
-	mutex_unlock(&key_queue_mutex);
-
 	if (valid && !trimming)
 		write_keyboard_report();
+
+	interrupt_enable();
 }
 
 static void queue_keycode_event(uint8_t keycode, int is_pressed)
@@ -614,9 +619,9 @@ static void queue_keycode_event(uint8_t keycode, int is_pressed)
 		.pressed = is_pressed,
 	};
 
-	mutex_lock(&key_queue_mutex);
+	interrupt_disable();
 	queue_add_unit(&key_queue, &ev);
-	mutex_unlock(&key_queue_mutex);
+	interrupt_enable();
 
 	keyboard_process_queue();
 }
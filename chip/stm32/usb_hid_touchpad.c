@@ -29,9 +29,13 @@
 
 static const int touchpad_debug;
 
+/*
+ * Reports are queued in task context and sent from either task context or
+ * the endpoint interrupt, as soon as the host has taken the previous report.
+ * The queue is therefore only touched with interrupts disabled.
+ */
 static struct queue const report_queue = QUEUE_NULL(8,
 						struct usb_hid_touchpad_report);
-static struct mutex report_queue_mutex;
 
 #define HID_TOUCHPAD_REPORT_SIZE  sizeof(struct usb_hid_touchpad_report)
 
@@ -253,7 +257,7 @@ const struct usb_hid_descriptor USB_CUSTOM_DESC_VAR(USB_IFACE_HID_TOUCHPAD,
 static usb_uint hid_ep_buf[DIV_ROUND_UP(HID_TOUCHPAD_REPORT_SIZE, 2)] __usb_ram;
 
 /*
- * Write a report to EP, must be called with queue mutex held, and caller
+ * Write a report to EP, must be called with interrupts disabled, and caller
  * must first check that EP is not busy.
  */
 static void write_touchpad_report(struct usb_hid_touchpad_report *report)
@@ -280,7 +284,7 @@ static void hid_touchpad_process_queue(void)
 	uint16_t now;
 	int trimming = 0;
 
-	mutex_lock(&report_queue_mutex);
+	interrupt_disable();
 
 	/* EP is busy, or nothing in queue: do nothing. */
 	if (queue_count(&report_queue) == 0)
@@ -334,21 +338,21 @@ static void hid_touchpad_process_queue(void)
 	}
 
 unlock:
-	mutex_unlock(&report_queue_mutex);
+	interrupt_enable();
 }
 
 void set_touchpad_report(struct usb_hid_touchpad_report *report)
 {
 	static int print_full = 1;
 
-	mutex_lock(&report_queue_mutex);
+	interrupt_disable();
 
 	/* USB/EP ready and nothing in queue, just write the report. */
 	if (!usb_is_suspended() &&
 	    (STM32_USB_EP(USB_EP_HID_TOUCHPAD) & EP_TX_MASK) != EP_TX_VALID
 	    && queue_count(&report_queue) == 0) {
 		write_touchpad_report(report);
-		mutex_unlock(&report_queue_mutex);
+		interrupt_enable();
 		return;
 	}
 
@@ -366,7 +370,7 @@ void set_touchpad_report(struct usb_hid_touchpad_report *report)
 	}
 	queue_add_unit(&report_queue, report);
 
-	mutex_unlock(&report_queue_mutex);
+	interrupt_enable();
 
 	hid_touchpad_process_queue();
 }
@@ -375,8 +379,9 @@ static void hid_touchpad_tx(void)
 {
 	hid_tx(USB_EP_HID_TOUCHPAD);
 
+	/* Send the next report right away, ready for the next poll. */
 	if (queue_count(&report_queue) > 0)
-		hook_call_deferred(&hid_touchpad_process_queue_data, 0);
+		hid_touchpad_process_queue();
 }
 
 static void hid_touchpad_event(enum usb_ep_event evt)
@@ -386,7 +391,7 @@ static void hid_touchpad_event(enum usb_ep_event evt)
 			  HID_TOUCHPAD_REPORT_SIZE, NULL, 0);
 	else if (evt == USB_EVENT_DEVICE_RESUME &&
 			queue_count(&report_queue) > 0)
-		hook_call_deferred(&hid_touchpad_process_queue_data, 0);
+		hid_touchpad_process_queue();
 }
 
 USB_DECLARE_EP(USB_EP_HID_TOUCHPAD, hid_touchpad_tx, hid_touchpad_tx,
@@ -6,7 +6,9 @@
 #include "stddef.h"
 #include "common.h"
 #include "config.h"
+#include "console.h"
 #include "link_defs.h"
+#include "queue.h"
 #include "registers.h"
 #include "util.h"
 #include "usb_api.h"
@@ -39,8 +41,27 @@
  *
  * `get_app_addr()`, `set_app_count()` help you to to select the correct
  * variable to use by given DTOG value, which is available by `get_tx_dtog()`.
+ *
+ * With a `tx_queue`, the application buffer is refilled from the queue in
+ * the TX complete interrupt, right after the hardware has switched buffers.
+ * The next packet is then always ready a whole frame before it is due, and
+ * the producer only has to keep the queue topped up.
  */
 
+/* Per-endpoint counters, see `usbiso` console command. */
+struct usb_isochronous_stats {
+	uint32_t frames;
+	/* Queue ran dry in the middle of a stream. */
+	uint32_t underruns;
+	/* Hardware took the buffer before the application committed it. */
+	uint32_t overruns;
+	/* Previous packet filled from the queue carried data. */
+	uint8_t streaming;
+	uint8_t enabled;
+};
+
+static struct usb_isochronous_stats iso_stats[USB_EP_COUNT];
+
 /*
  * Gets current DTOG value of given `config`.
  */
@@ -86,10 +107,12 @@ int usb_isochronous_write_buffer(
 	usb_uint *buffer = get_app_addr(config, dtog_value);
 	uintptr_t ptr = usb_sram_addr(buffer);
 
-	if (*buffer_id == -1)
+	if (*buffer_id == -1) {
 		*buffer_id = dtog_value;
-	else if (dtog_value != *buffer_id)
+	} else if (dtog_value != *buffer_id) {
+		iso_stats[config->endpoint].overruns++;
 		return -EC_ERROR_TIMEOUT;
+	}
 
 	if (dst_offset > config->tx_size)
 		return -EC_ERROR_INVAL;
@@ -103,10 +126,31 @@ int usb_isochronous_write_buffer(
 	return n;
 }
 
+/*
+ * Fills the application buffer from `tx_queue`.  Called in interrupt context.
+ */
+static void fill_from_queue(struct usb_isochronous_config const *config,
+			    int dtog_value)
+{
+	struct usb_isochronous_stats *stats = &iso_stats[config->endpoint];
+	uintptr_t ptr = usb_sram_addr(get_app_addr(config, dtog_value));
+	size_t count = queue_remove_memcpy(config->tx_queue, (void *)ptr,
+					   config->tx_size, memcpy_to_usbram);
+
+	if (!count && stats->streaming)
+		stats->underruns++;
+	stats->streaming = !!count;
+
+	set_app_count(config, dtog_value, count);
+}
+
 void usb_isochronous_init(struct usb_isochronous_config const *config)
 {
 	int ep = config->endpoint;
 
+	iso_stats[ep].enabled = 1;
+	iso_stats[ep].streaming = 0;
+
 	btable_ep[ep].tx_addr = usb_sram_addr(get_app_addr(config, 1));
 	btable_ep[ep].rx_addr = usb_sram_addr(get_app_addr(config, 0));
 	set_app_count(config, 0, 0);
@@ -127,18 +171,27 @@ void usb_isochronous_event(struct usb_isochronous_config const *config,
 
 void usb_isochronous_tx(struct usb_isochronous_config const *config)
 {
+	int dtog_value;
+
 	/*
 	 * Clear CTR_TX, note that EP_TX_VALID will *NOT* be cleared by
 	 * hardware, so we don't need to toggle it.
 	 */
 	STM32_TOGGLE_EP(config->endpoint, 0, 0, 0);
+	iso_stats[config->endpoint].frames++;
+
 	/*
 	 * Clear buffer count for buffer we just transmitted, so we do not
 	 * transmit the data twice.
 	 */
-	set_app_count(config, get_tx_dtog(config), 0);
+	dtog_value = get_tx_dtog(config);
+	set_app_count(config, dtog_value, 0);
+
+	if (config->tx_queue)
+		fill_from_queue(config, dtog_value);
 
-	config->tx_callback(config);
+	if (config->tx_callback)
+		config->tx_callback(config);
 }
 
 int usb_isochronous_iface_handler(struct usb_isochronous_config const *config,
@@ -161,3 +214,33 @@ int usb_isochronous_iface_handler(struct usb_isochronous_config const *config,
 	}
 	return ret;
 }
+
+static int command_usbiso(int argc, char **argv)
+{
+	int ep;
+
+	if (argc > 1 && strcasecmp(argv[1], "clear"))
+		return EC_ERROR_PARAM1;
+
+	for (ep = 0; ep < USB_EP_COUNT; ep++) {
+		struct usb_isochronous_stats *stats = &iso_stats[ep];
+
+		if (!stats->enabled)
+			continue;
+
+		if (argc > 1) {
+			stats->frames = 0;
+			stats->underruns = 0;
+			stats->overruns = 0;
+			continue;
+		}
+
+		ccprintf("EP%d: frames %u underruns %u overruns %u\n", ep,
+			 stats->frames, stats->underruns, stats->overruns);
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(usbiso, command_usbiso,
+			"[clear]",
+			"Show or clear USB isochronous endpoint counters");
@@ -9,6 +9,7 @@
 #include "common.h"
 #include "compile_time_macros.h"
 #include "hooks.h"
+#include "queue.h"
 #include "usb_descriptor.h"
 #include "usb_hw.h"
 
@@ -88,12 +89,20 @@ struct usb_isochronous_config {
 
 	/*
 	 * On TX complete, this function will be called in **interrupt
-	 * context**.
+	 * context**.  May be NULL if `tx_queue` is used.
 	 *
 	 * @param config	the usb_isochronous_config of the USB interface.
 	 */
 	void (*tx_callback)(struct usb_isochronous_config const *config);
 
+	/*
+	 * Optional queue of bytes to send.  If set, each packet is filled with
+	 * up to `tx_size` bytes from the queue as soon as the previous one has
+	 * been handed to the hardware, before `tx_callback` is called.  Do not
+	 * mix with usb_isochronous_write_buffer().
+	 */
+	struct queue const *tx_queue;
+
 	/*
 	 * Received SET_INTERFACE request.
 	 *
@@ -119,6 +128,7 @@ struct usb_isochronous_config {
 				    ENDPOINT,				\
 				    TX_SIZE,				\
 				    TX_CALLBACK,			\
+				    TX_QUEUE,				\
 				    SET_INTERFACE,			\
 				    NUM_EXTRA_ENDPOINTS)		\
 	BUILD_ASSERT(TX_SIZE > 0);					\
@@ -130,6 +140,7 @@ struct usb_isochronous_config {
 	struct usb_isochronous_config const NAME = {			\
 		.endpoint  = ENDPOINT,					\
 		.tx_callback = TX_CALLBACK,				\
+		.tx_queue  = TX_QUEUE,					\
 		.set_interface = SET_INTERFACE,				\
 		.tx_size   = TX_SIZE,					\
 		.tx_ram    = {						\
@@ -112,6 +112,7 @@ static int usb_power_state_reset(struct usb_power_config const *config)
 	state->reports_head = 0;
 	state->reports_tail = 0;
 	state->reports_xmit_active = 0;
+	state->decimate = 1;
 
 	CPRINTS("[RESET] STATE -> OFF");
 	return USB_POWER_SUCCESS;
@@ -167,6 +168,8 @@ static int usb_power_state_start(struct usb_power_config const *config,
 	state->max_cached = USB_POWER_MAX_CACHED(state->ina_count);
 
 	state->integration_us = integration_us;
+	state->decimate_count = 0;
+	memset(state->sums, 0, sizeof(state->sums));
 	ret = usb_power_init_inas(config);
 
 	if (ret)
@@ -202,6 +205,35 @@ static int usb_power_state_settime(struct usb_power_config const *config,
 }
 
 
+static int usb_power_state_decimate(struct usb_power_config const *config,
+				 union usb_power_command_data *cmd, int count)
+{
+	struct usb_power_state *state = config->state;
+
+	/* Only valid from OFF or SETUP */
+	if (state->state == USB_POWER_STATE_CAPTURING) {
+		CPRINTS("[DECIMATE] Error incorrect state.");
+		return USB_POWER_ERROR_NOT_SETUP;
+	}
+
+	if (count != sizeof(struct usb_power_command_decimate)) {
+		CPRINTS("[DECIMATE] Error count %d is not %d",
+			(int)count, sizeof(struct usb_power_command_decimate));
+		return USB_POWER_ERROR_READ_SIZE;
+	}
+
+	if (cmd->decimate.factor == 0 ||
+	    cmd->decimate.factor > USB_POWER_MAX_DECIMATE) {
+		CPRINTS("[DECIMATE] Error factor %d invalid",
+			(int)cmd->decimate.factor);
+		return USB_POWER_ERROR_INVAL;
+	}
+
+	state->decimate = cmd->decimate.factor;
+	return USB_POWER_SUCCESS;
+}
+
+
 static int usb_power_state_addina(struct usb_power_config const *config,
 				 union usb_power_command_data *cmd, int count)
 {
@@ -334,6 +366,10 @@ static int usb_power_read(struct usb_power_config const *config)
 		result = usb_power_state_settime(config, cmd, count);
 		break;
 
+	case USB_POWER_CMD_DECIMATE:
+		result = usb_power_state_decimate(config, cmd, count);
+		break;
+
 	case USB_POWER_CMD_NEXT:
 		if (state->state == USB_POWER_STATE_CAPTURING) {
 			int ret;
@@ -601,12 +637,22 @@ static int usb_power_init_inas(struct usb_power_config const *config)
 }
 
 
+/* Shunt voltage and current are two's complement, bus voltage and power not. */
+static int32_t usb_power_sample_value(struct usb_power_ina_cfg *ina,
+				      uint16_t regval)
+{
+	if (ina->type == USBP_INA231_SHUNTV || ina->type == USBP_INA231_CURRENT)
+		return (int16_t)regval;
+	return regval;
+}
+
 /*
  * Read each INA's power integration measurement.
  *
  * INAs recall the most recent address, so no register access write is
  * necessary, simply read 16 bits from each INA and fill the result into
- * the power record.
+ * the power record.  When decimating, the samples are summed instead and
+ * every [decimate]th call fills the record with their averages.
  *
  * If the power record ringbuffer is full, fail with USB_POWER_ERROR_OVERFLOW.
  */
@@ -631,14 +677,6 @@ static int usb_power_get_samples(struct usb_power_config const *config)
 		return USB_POWER_ERROR_OVERFLOW;
 	}
 
-	r->status = USB_POWER_SUCCESS;
-	r->size = state->ina_count;
-	if (config->state->wall_offset)
-		time = time + config->state->wall_offset;
-	else
-		time -= config->state->base_time;
-	r->timestamp = time;
-
 	for (i = 0; i < state->ina_count; i++) {
 		int regval;
 		struct usb_power_ina_cfg *ina = inas + i;
@@ -654,7 +692,10 @@ static int usb_power_get_samples(struct usb_power_config const *config)
 		else
 			regval = ina2xx_readagain(ina->port,
 						  ina->addr_flags);
-		r->power[i] = regval;
+		if (state->decimate > 1)
+			state->sums[i] += usb_power_sample_value(ina, regval);
+		else
+			r->power[i] = regval;
 #ifdef USB_POWER_VERBOSE
 		{
 		int current;
@@ -688,6 +729,25 @@ static int usb_power_get_samples(struct usb_power_config const *config)
 #endif
 	}
 
+	if (state->decimate > 1) {
+		if (++state->decimate_count < state->decimate)
+			return EC_SUCCESS;
+
+		for (i = 0; i < state->ina_count; i++) {
+			r->power[i] = state->sums[i] / state->decimate;
+			state->sums[i] = 0;
+		}
+		state->decimate_count = 0;
+	}
+
+	r->status = USB_POWER_SUCCESS;
+	r->size = state->ina_count;
+	if (config->state->wall_offset)
+		time = time + config->state->wall_offset;
+	else
+		time -= config->state->base_time;
+	r->timestamp = time;
+
 	/* Mark this slot as used. */
 	state->reports_head = (state->reports_head + 1) %
 		USB_POWER_MAX_CACHED(state->ina_count);
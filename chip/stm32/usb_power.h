@@ -66,6 +66,15 @@
  *     | 0x0005 | 8B: Wall clock time |
  *     +--------+---------------------+
  *
+ *     decimate:	0x0006
+ *     +--------+---------------+
+ *     | 0x0006 | 2B: factor    |
+ *     +--------+---------------+
+ *
+ *     Average [factor] consecutive samples of each INA on the device and
+ *     report one record per [factor] integration periods, timestamped with
+ *     the last sample.  Only valid before start, 1 (default) disables it.
+ *
  *
  *     Status: 1 byte status
  *
@@ -111,6 +120,7 @@ enum usb_power_command {
 	USB_POWER_CMD_START	= 0x0003,
 	USB_POWER_CMD_NEXT	= 0x0004,
 	USB_POWER_CMD_SETTIME	= 0x0005,
+	USB_POWER_CMD_DECIMATE	= 0x0006,
 };
 
 /* Addina "INA Type" field. */
@@ -130,6 +140,8 @@ enum usb_power_states {
 
 #define USB_POWER_MAX_READ_COUNT 64
 #define USB_POWER_MIN_CACHED 10
+/* Keeps the per INA sums of 16 bit samples within 32 bits. */
+#define USB_POWER_MAX_DECIMATE 1024
 
 struct usb_power_ina_cfg {
 	/*
@@ -190,6 +202,11 @@ struct usb_power_state {
 	/* Offset between microcontroller timestamp and host wall clock. */
 	uint64_t wall_offset;
 
+	/* Samples averaged into each record, and samples summed so far. */
+	int decimate;
+	int decimate_count;
+	int32_t sums[USB_POWER_MAX_READ_COUNT];
+
 	/* Cached power reports for sending on USB. */
 	/* Actual backing data for variable sized record queue. */
 	uint8_t reports_data_area[USB_POWER_DATA_SIZE];
@@ -253,11 +270,17 @@ struct __attribute__ ((__packed__)) usb_power_command_settime {
 	uint64_t time;
 };
 
+struct __attribute__ ((__packed__)) usb_power_command_decimate {
+	uint16_t command;
+	uint16_t factor;
+};
+
 union usb_power_command_data {
 	uint16_t command;
 	struct usb_power_command_start start;
 	struct usb_power_command_addina addina;
 	struct usb_power_command_settime settime;
+	struct usb_power_command_decimate decimate;
 };
 
 
@@ -289,6 +312,7 @@ union usb_power_command_data {
 		.reports_head = 0,					\
 		.reports_tail = 0,					\
 		.wall_offset = 0,					\
+		.decimate = 1,						\
 	};								\
 	static struct dwc_usb_ep CONCAT2(NAME, _ep_ctl) = {		\
 		.max_packet = USB_MAX_PACKET_SIZE,			\
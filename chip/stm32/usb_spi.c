@@ -17,6 +17,7 @@ static bool usb_spi_received_packet(struct usb_spi_config const *config);
 static bool usb_spi_transmitted_packet(struct usb_spi_config const *config);
 static void usb_spi_read_packet(struct usb_spi_config const *config,
 			struct usb_spi_packet_ctx *packet);
+static void usb_spi_rx_ready(struct usb_spi_config const *config);
 static void usb_spi_write_packet(struct usb_spi_config const *config,
 			struct usb_spi_packet_ctx *packet);
 
@@ -374,11 +375,20 @@ void usb_spi_deferred(struct usb_spi_config const *config)
 		config->state->enabled = enabled;
 	}
 
-	/* Read any packets from the endpoint. */
-
-	usb_spi_read_packet(config, receive_packet);
-	if (receive_packet->packet_size) {
-		usb_spi_process_rx_packet(config, receive_packet);
+	if (IS_ENABLED(CONFIG_USB_SPI_ISR_PACKETS)) {
+		/*
+		 * The endpoint interrupts process the packets, and leave only
+		 * the SPI transfers to here.
+		 */
+		if (config->state->mode != USB_SPI_MODE_START_SPI)
+			return;
+	} else {
+		/* Read any packets from the endpoint. */
+		usb_spi_read_packet(config, receive_packet);
+		if (receive_packet->packet_size) {
+			usb_spi_rx_ready(config);
+			usb_spi_process_rx_packet(config, receive_packet);
+		}
 	}
 
 	/* Need to send the USB SPI configuration */
@@ -420,6 +430,65 @@ void usb_spi_deferred(struct usb_spi_config const *config)
 		usb_spi_create_spi_transfer_response(config, transmit_packet);
 		usb_spi_write_packet(config, transmit_packet);
 	}
+
+	/* The interrupt left the next command waiting for this transfer. */
+	if (IS_ENABLED(CONFIG_USB_SPI_ISR_PACKETS))
+		usb_spi_rx_ready(config);
+}
+
+/*
+ * Process the packet received, from the endpoint interrupt. Only SPI transfers
+ * are left to the deferred function, which then starts the response and makes
+ * the endpoint ready to receive the next command.
+ *
+ * @param config        USB SPI config
+ */
+static void usb_spi_isr_rx(struct usb_spi_config const *config)
+{
+	struct usb_spi_packet_ctx *receive_packet =
+		&config->state->receive_packet;
+	struct usb_spi_packet_ctx *transmit_packet =
+		&config->state->transmit_packet;
+
+	usb_spi_read_packet(config, receive_packet);
+	if (receive_packet->packet_size)
+		usb_spi_process_rx_packet(config, receive_packet);
+
+	switch (config->state->mode) {
+	case USB_SPI_MODE_START_SPI:
+		hook_call_deferred(config->deferred, 0);
+		return;
+	case USB_SPI_MODE_SEND_CONFIGURATION:
+		create_spi_config_response(config, transmit_packet);
+		usb_spi_write_packet(config, transmit_packet);
+		config->state->mode = USB_SPI_MODE_IDLE;
+		break;
+	case USB_SPI_MODE_START_RESPONSE:
+		usb_spi_create_spi_transfer_response(config, transmit_packet);
+		usb_spi_write_packet(config, transmit_packet);
+		break;
+	default:
+		break;
+	}
+
+	usb_spi_rx_ready(config);
+}
+
+/*
+ * Send the next packet of the response, from the endpoint interrupt.
+ *
+ * @param config        USB SPI config
+ */
+static void usb_spi_isr_tx(struct usb_spi_config const *config)
+{
+	struct usb_spi_packet_ctx *transmit_packet =
+		&config->state->transmit_packet;
+
+	if (config->state->mode != USB_SPI_MODE_CONTINUE_RESPONSE)
+		return;
+
+	usb_spi_create_spi_transfer_response(config, transmit_packet);
+	usb_spi_write_packet(config, transmit_packet);
 }
 
 /*
@@ -436,8 +505,7 @@ void usb_spi_enable(struct usb_spi_config const *config, int enabled)
 }
 
 /*
- * STM32 Platform: Receive the data from the endpoint into the packet and
- *  mark the endpoint as ready to accept more data.
+ * STM32 Platform: Receive the data from the endpoint into the packet.
  *
  * @param config        USB SPI config
  * @param packet        Destination packet used to store the endpoint data.
@@ -458,7 +526,15 @@ static void usb_spi_read_packet(struct usb_spi_config const *config,
 	memcpy_from_usbram(packet->bytes,
 		(void *)usb_sram_addr(config->ep_rx_ram), packet_size);
 	packet->packet_size = packet_size;
-	/* Set endpoint as valid for accepting new packet. */
+}
+
+/*
+ * STM32 Platform: Mark the endpoint as ready to accept a new packet.
+ *
+ * @param config        USB SPI config
+ */
+static void usb_spi_rx_ready(struct usb_spi_config const *config)
+{
 	STM32_TOGGLE_EP(config->endpoint, EP_RX_MASK, EP_RX_VALID, 0);
 }
 
@@ -530,7 +606,10 @@ void usb_spi_rx(struct usb_spi_config const *config)
 	 */
 	STM32_TOGGLE_EP(config->endpoint, EP_TX_RX_MASK, EP_TX_RX_NAK, 0);
 
-	hook_call_deferred(config->deferred, 0);
+	if (IS_ENABLED(CONFIG_USB_SPI_ISR_PACKETS))
+		usb_spi_isr_rx(config);
+	else
+		hook_call_deferred(config->deferred, 0);
 }
 
 /*
@@ -542,7 +621,10 @@ void usb_spi_tx(struct usb_spi_config const *config)
 {
 	STM32_TOGGLE_EP(config->endpoint, EP_TX_MASK, EP_TX_NAK, 0);
 
-	hook_call_deferred(config->deferred, 0);
+	if (IS_ENABLED(CONFIG_USB_SPI_ISR_PACKETS))
+		usb_spi_isr_tx(config);
+	else
+		hook_call_deferred(config->deferred, 0);
 }
 
 /*
@@ -10,9 +10,63 @@
 #include "common.h"
 #include "console.h"
 #include "ec_commands.h"
+#include "hooks.h"
 #include "host_command.h"
+#include "task.h"
+#include "timer.h"
 #include "util.h"
 
+#ifdef CONFIG_ADC_CACHE
+static struct {
+	int value;
+	/* Low word of the conversion time */
+	uint32_t time;
+	int valid;
+} adc_cache[ADC_CH_COUNT];
+static struct mutex adc_cache_lock;
+
+static int adc_cache_update(enum adc_channel ch)
+{
+	int value = adc_read_channel(ch);
+
+	if (value != ADC_READ_ERROR) {
+		mutex_lock(&adc_cache_lock);
+		adc_cache[ch].value = value;
+		adc_cache[ch].time = get_time().le.lo;
+		adc_cache[ch].valid = 1;
+		mutex_unlock(&adc_cache_lock);
+	}
+
+	return value;
+}
+
+int adc_read_channel_cached(enum adc_channel ch, uint32_t max_age_us)
+{
+	uint32_t age;
+	int value, valid;
+
+	mutex_lock(&adc_cache_lock);
+	value = adc_cache[ch].value;
+	valid = adc_cache[ch].valid;
+	age = get_time().le.lo - adc_cache[ch].time;
+	mutex_unlock(&adc_cache_lock);
+
+	if (valid && age <= max_age_us)
+		return value;
+
+	return adc_cache_update(ch);
+}
+
+static void adc_cache_refresh(void)
+{
+	int i;
+
+	for (i = 0; i < ADC_CH_COUNT; i++)
+		adc_cache_update(i);
+}
+DECLARE_HOOK(HOOK_TICK, adc_cache_refresh, HOOK_PRIO_DEFAULT);
+#endif /* CONFIG_ADC_CACHE */
+
 /* 'adc' console command is not supported in continuous mode */
 #ifndef CONFIG_ADC_PROFILE_FAST_CONTINUOUS
 static enum adc_channel find_adc_channel_by_name(const char *name)
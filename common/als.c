@@ -33,22 +33,63 @@ int als_read(enum als_id id, int *lux)
 	return als[id].read(lux, af);
 }
 
+#ifdef CONFIG_ALS_INTERRUPT
+/**
+ * Arm the interrupt of an ALS for a light level leaving the hysteresis band
+ * around lux.
+ *
+ * @return EC_SUCCESS if the interrupt is armed.
+ */
+static int als_set_threshold(enum als_id id, int lux)
+{
+	int band = MAX(lux * CONFIG_ALS_HYSTERESIS / 100, 1);
+
+	if (!als[id].set_threshold)
+		return EC_ERROR_UNIMPLEMENTED;
+
+	return als[id].set_threshold(MAX(lux - band, 0), lux + band,
+				     als[id].attenuation_factor);
+}
+
+void als_interrupt(enum gpio_signal signal)
+{
+	task_wake(TASK_ID_ALS);
+}
+#endif
+
 void als_task(void *u)
 {
-	int i, val;
+	int i, val, rv, timeout;
 	uint16_t *mapped = (uint16_t *)host_get_memmap(EC_MEMMAP_ALS);
 	uint16_t als_data;
 
+	timeout = task_timeout;
 	while (1) {
-		task_wait_event(task_timeout);
+		task_wait_event(timeout);
 
 		/* If task was disabled while waiting do not read from ALS */
+		timeout = task_timeout;
 		if (task_timeout < 0)
 			continue;
 
+#ifdef CONFIG_ALS_INTERRUPT
+		/*
+		 * Once every sensor waits for its light level to change, there
+		 * is nothing to poll.
+		 */
+		timeout = -1;
+#endif
 		for (i = 0; i < EC_ALS_ENTRIES && i < ALS_COUNT; i++) {
-			als_data = als_read(i, &val) == EC_SUCCESS ? val : 0;
+			rv = als_read(i, &val);
+			als_data = rv == EC_SUCCESS ? val : 0;
 			mapped[i] = als_data;
+
+#ifdef CONFIG_ALS_INTERRUPT
+			if (rv == EC_SUCCESS)
+				rv = als_set_threshold(i, val);
+			if (rv != EC_SUCCESS)
+				timeout = task_timeout;
+#endif
 		}
 	}
 }
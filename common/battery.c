@@ -455,9 +455,9 @@ host_command_battery_vendor_param(struct host_cmd_handler_args *args)
 	rv = battery_get_vendor_param(p->param, &r->value);
 	return rv;
 }
-DECLARE_HOST_COMMAND(EC_CMD_BATTERY_VENDOR_PARAM,
-		     host_command_battery_vendor_param,
-		     EC_VER_MASK(0));
+DECLARE_HOST_COMMAND_ASYNC(EC_CMD_BATTERY_VENDOR_PARAM,
+			   host_command_battery_vendor_param,
+			   EC_VER_MASK(0));
 #endif /* CONFIG_BATTERY_VENDOR_PARAM */
 
 #ifdef CONFIG_BATTERY_V2
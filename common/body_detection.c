@@ -6,10 +6,12 @@
 #include "accelgyro.h"
 #include "body_detection.h"
 #include "console.h"
+#include "hooks.h"
 #include "hwtimer.h"
 #include "lid_switch.h"
 #include "math_util.h"
 #include "motion_sense_fifo.h"
+#include "queue.h"
 #include "timer.h"
 
 /* Console output macros */
@@ -30,6 +32,69 @@ static enum body_detect_states motion_state = BODY_DETECTION_OFF_BODY;
 static bool history_initialized;
 static bool body_detect_enable;
 
+#ifdef CONFIG_BODY_DETECTION_DEFERRED
+/* Samples of the motion task waiting for the hook task */
+struct body_detect_sample {
+	int x;
+	int y;
+};
+
+#define BODY_DETECT_QUEUE_SIZE 16
+
+static struct queue const body_detect_queue =
+	QUEUE_NULL(BODY_DETECT_QUEUE_SIZE, struct body_detect_sample);
+#endif
+
+#ifdef CONFIG_BODY_DETECTION_EW_VARIANCE
+/* Smoothing factor of the moving averages is 2^-ew_shift. */
+static int ew_shift;
+/*
+ * Saturation of the variance of each axis: above it the confidence is 100%
+ * anyway, and the variance of a large motion would otherwise take many time
+ * constants to decay.
+ */
+static uint64_t ew_variance_max;
+
+static struct body_detect_motion_data
+{
+	int32_t mean;      /* mean(x) * 2^ew_shift */
+	uint64_t variance; /* var(x) * 2^(2 * ew_shift) */
+} data[2]; /* motion data for X-axis and Y-axis */
+
+/*
+ * Exponentially weighted mean and variance of the acceleration, with
+ * alpha = 2^-ew_shift:
+ *
+ * diff = x_n - mean
+ * mean' = mean + alpha * diff
+ * var' = (1 - alpha) * (var + alpha * diff^2)
+ *
+ * Only shifts are needed: the mean is kept with ew_shift fractional bits and
+ * the variance with twice as many.
+ */
+static void update_motion_data(struct body_detect_motion_data *x, int x_n)
+{
+	const int32_t diff = ((int32_t)x_n << ew_shift) - x->mean;
+	uint64_t variance;
+
+	if (!history_initialized && history_idx == 0) {
+		/* Start from the first sample, not from 0. */
+		x->mean = (int32_t)x_n << ew_shift;
+		x->variance = 0;
+		return;
+	}
+
+	x->mean += diff >> ew_shift;
+	variance = x->variance + (((int64_t)diff * diff) >> ew_shift);
+	x->variance = MIN(variance - (variance >> ew_shift), ew_variance_max);
+}
+
+/* return Var(X) + Var(Y) */
+static uint64_t get_motion_variance(void)
+{
+	return (data[X].variance + data[Y].variance) >> (2 * ew_shift);
+}
+#else
 static struct body_detect_motion_data
 {
 	int history[CONFIG_BODY_DETECTION_MAX_WINDOW_SIZE]; /* acceleration */
@@ -64,20 +129,21 @@ static void update_motion_data(struct body_detect_motion_data *x, int x_n)
 	x->history[history_idx] = x_n;
 }
 
-/* Update motion data of X, Y with new sensor data. */
-static void update_motion_variance(void)
-{
-	update_motion_data(&data[X], body_sensor->xyz[X]);
-	update_motion_data(&data[Y], body_sensor->xyz[Y]);
-	history_idx = (history_idx + 1 >= window_size) ? 0 : history_idx + 1;
-}
-
 /* return Var(X) + Var(Y) */
 static uint64_t get_motion_variance(void)
 {
 	return (data[X].n2_variance + data[Y].n2_variance)
 		/ window_size / window_size;
 }
+#endif /* CONFIG_BODY_DETECTION_EW_VARIANCE */
+
+/* Update motion data of X, Y with new sensor data. */
+static void update_motion_variance(int x, int y)
+{
+	update_motion_data(&data[X], x);
+	update_motion_data(&data[Y], y);
+	history_idx = (history_idx + 1 >= window_size) ? 0 : history_idx + 1;
+}
 
 static int calculate_motion_confidence(uint64_t var)
 {
@@ -129,6 +195,14 @@ static void determine_window_size(int odr)
 		CPRINTS("ODR exceeds CONFIG_BODY_DETECTION_MAX_WINDOW_SIZE");
 		window_size = CONFIG_BODY_DETECTION_MAX_WINDOW_SIZE;
 	}
+#ifdef CONFIG_BODY_DETECTION_EW_VARIANCE
+	/*
+	 * Average over about the same time as the window: a window of n
+	 * samples has the same center of mass as alpha = 2 / (n + 1), round
+	 * it up to a power of 2.
+	 */
+	ew_shift = window_size > 1 ? __fls(window_size) - 1 : 0;
+#endif
 }
 
 /* Determine variance threshold scale by range and resolution. */
@@ -182,21 +256,25 @@ void body_detect_reset(void)
 		return;
 	determine_window_size(odr);
 	determine_threshold_scale(range, resolution, rms_noise);
+#ifdef CONFIG_BODY_DETECTION_EW_VARIANCE
+	ew_variance_max = (var_threshold_scaled + confidence_delta_scaled)
+			  << (2 * ew_shift);
+#endif
 	/* initialize motion data and state */
 	memset(data, 0, sizeof(data));
 	history_idx = 0;
 	history_initialized = 0;
+#ifdef CONFIG_BODY_DETECTION_DEFERRED
+	queue_init(&body_detect_queue);
+#endif
 }
 
-void body_detect(void)
+static void body_detect_process(int x, int y)
 {
 	uint64_t motion_var;
 	int motion_confidence;
 
-	if (!body_detect_enable)
-		return;
-
-	update_motion_variance();
+	update_motion_variance(x, y);
 	if (!history_initialized) {
 		if (history_idx == window_size - 1)
 			history_initialized = 1;
@@ -223,6 +301,38 @@ void body_detect(void)
 	}
 }
 
+#ifdef CONFIG_BODY_DETECTION_DEFERRED
+static void body_detect_deferred(void)
+{
+	struct body_detect_sample sample;
+
+	while (queue_remove_unit(&body_detect_queue, &sample))
+		body_detect_process(sample.x, sample.y);
+}
+DECLARE_DEFERRED(body_detect_deferred);
+#endif
+
+void body_detect(void)
+{
+	if (!body_detect_enable)
+		return;
+
+#ifdef CONFIG_BODY_DETECTION_DEFERRED
+	{
+		struct body_detect_sample sample = {
+			.x = body_sensor->xyz[X],
+			.y = body_sensor->xyz[Y],
+		};
+
+		/* If the hook task fell behind, drop the sample. */
+		queue_add_unit(&body_detect_queue, &sample);
+		hook_call_deferred(&body_detect_deferred_data, 0);
+	}
+#else
+	body_detect_process(body_sensor->xyz[X], body_sensor->xyz[Y]);
+#endif
+}
+
 void body_detect_set_enable(int enable)
 {
 	body_detect_enable = enable;
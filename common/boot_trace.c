@@ -0,0 +1,89 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Boot time trace for Chrome EC */
+
+#include "boot_trace.h"
+#include "common.h"
+#include "console.h"
+#include "host_command.h"
+#include "timer.h"
+#include "util.h"
+
+#define CPRINTS(format, args...) cprints(CC_SYSTEM, format, ## args)
+
+static struct ec_boot_trace_entry trace[CONFIG_BOOT_TRACE_ENTRIES];
+static int trace_count;
+/* Set once the AP is on, nothing is recorded after that. */
+static int trace_done;
+
+static void boot_trace_add(enum ec_boot_trace_event event, uint32_t time,
+			   uint32_t duration, uint32_t data, uint8_t flags)
+{
+	struct ec_boot_trace_entry *e;
+
+	if (trace_done || trace_count >= ARRAY_SIZE(trace))
+		return;
+
+	e = trace + trace_count;
+	e->time_us = time;
+	e->duration_us = duration;
+	e->data = data;
+	e->event = event;
+	e->flags = flags;
+	e->reserved = 0;
+	/* Publish the entry for the host command once it is complete. */
+	trace_count++;
+
+	if (event == EC_BOOT_TRACE_AP_ON)
+		trace_done = 1;
+}
+
+void boot_trace(enum ec_boot_trace_event event, uint32_t data)
+{
+	boot_trace_add(event, get_time().le.lo, 0, data, 0);
+}
+
+void boot_trace_call_hook(void (*routine)(void))
+{
+	uint32_t start = get_time().le.lo;
+	uint32_t duration;
+	uint8_t flags = 0;
+
+	routine();
+
+	duration = get_time().le.lo - start;
+	if (duration > CONFIG_BOOT_TRACE_HOOK_BUDGET_US) {
+		flags |= EC_BOOT_TRACE_FLAG_OVER_BUDGET;
+		CPRINTS("Init hook %pP took %d us", routine, duration);
+	}
+	boot_trace_add(EC_BOOT_TRACE_HOOK_INIT, start, duration,
+		       (uint32_t)(uintptr_t)routine, flags);
+}
+
+static enum ec_status host_command_boot_trace(struct host_cmd_handler_args
+					      *args)
+{
+	const struct ec_params_boot_trace *p = args->params;
+	struct ec_response_boot_trace *r = args->response;
+	int count = trace_count;
+	int num;
+
+	if (p->offset > count)
+		return EC_RES_INVALID_PARAM;
+
+	num = (args->response_max - sizeof(*r)) / sizeof(r->entries[0]);
+	num = MIN(num, count - p->offset);
+
+	r->count = count;
+	r->num = num;
+	r->hook_budget_us = CONFIG_BOOT_TRACE_HOOK_BUDGET_US;
+	memcpy(r->entries, trace + p->offset, num * sizeof(r->entries[0]));
+
+	args->response_size = sizeof(*r) + num * sizeof(r->entries[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_BOOT_TRACE, host_command_boot_trace,
+		     EC_VER_MASK(0));
@@ -92,6 +92,36 @@ static int cached_read_result = EC_ERROR_CBI_CACHE_INVALID;
 static uint8_t cbi[CBI_EEPROM_SIZE];
 static struct cbi_header * const head = (struct cbi_header *)cbi;
 
+/*
+ * Pages of cbi[] which may differ from the EEPROM. Only these are rewritten,
+ * so a batch of EC_CMD_SET_CROS_BOARD_INFO calls with CBI_SET_NO_SYNC costs
+ * one write of the pages it touched.
+ */
+#define EEPROM_PAGES	(CBI_EEPROM_SIZE / EEPROM_PAGE_WRITE_SIZE)
+BUILD_ASSERT(EEPROM_PAGES <= 32);
+static uint32_t dirty_pages = GENMASK(EEPROM_PAGES - 1, 0);
+
+/*
+ * Bytes of the image read so far by lazy tag lookups, while the cache is
+ * invalid. Zero until the header has been read.
+ */
+static int lazy_size;
+
+static void mark_dirty(int start, int end)
+{
+	int page;
+
+	for (page = start / EEPROM_PAGE_WRITE_SIZE;
+	     page * EEPROM_PAGE_WRITE_SIZE < end && page < EEPROM_PAGES; page++)
+		dirty_pages |= BIT(page);
+}
+
+static void invalidate_cache(void)
+{
+	cached_read_result = EC_ERROR_CBI_CACHE_INVALID;
+	lazy_size = 0;
+}
+
 int cbi_create(void)
 {
 	struct cbi_header * const h = (struct cbi_header *)cbi;
@@ -103,13 +133,14 @@ int cbi_create(void)
 	h->minor_version = CBI_VERSION_MINOR;
 	h->crc = cbi_crc8(h);
 	cached_read_result = EC_SUCCESS;
+	mark_dirty(0, CBI_EEPROM_SIZE);
 
 	return EC_SUCCESS;
 }
 
 void cbi_invalidate_cache(void)
 {
-	cached_read_result = EC_ERROR_CBI_CACHE_INVALID;
+	invalidate_cache();
 }
 
 static int read_eeprom(uint8_t offset, uint8_t *in, int in_size)
@@ -119,12 +150,10 @@ static int read_eeprom(uint8_t offset, uint8_t *in, int in_size)
 }
 
 /*
- * Get board information from EEPROM
+ * Read and check the CBI header
  */
-static int do_read_board_info(void)
+static int read_header(void)
 {
-	CPRINTS("Reading board info");
-
 	/* Read header */
 	if (read_eeprom(0, cbi, sizeof(*head))) {
 		CPRINTS("Failed to read header");
@@ -151,6 +180,25 @@ static int do_read_board_info(void)
 		return EC_ERROR_OVERFLOW;
 	}
 
+	return EC_SUCCESS;
+}
+
+/*
+ * Get board information from EEPROM
+ */
+static int do_read_board_info(void)
+{
+	int rv;
+
+	CPRINTS("Reading board info");
+
+	/* Whatever was in cbi[] is gone, whether or not this succeeds */
+	mark_dirty(0, CBI_EEPROM_SIZE);
+
+	rv = read_header();
+	if (rv)
+		return rv;
+
 	/* Read the data */
 	if (read_eeprom(sizeof(*head), head->data,
 			head->total_size - sizeof(*head))) {
@@ -164,6 +212,9 @@ static int do_read_board_info(void)
 		return EC_ERROR_INVAL;
 	}
 
+	/* EEPROM and cache agree now */
+	dirty_pages = 0;
+
 	return EC_SUCCESS;
 }
 
@@ -180,6 +231,79 @@ static int read_board_info(void)
 	return cached_read_result;
 }
 
+/*
+ * Find a tag in the part of the image read by lazy lookups, reading more
+ * tags from the EEPROM until it is found. Once the whole image has been read
+ * its CRC is checked and the cache becomes valid, as with a full read.
+ *
+ * Returns EC_SUCCESS with *d pointing to the tag, or to NULL if there is no
+ * such tag. Any other return means a full read is needed to tell.
+ */
+static int find_tag_lazily(enum cbi_data_tag tag, const struct cbi_data **d)
+{
+	struct cbi_data *t;
+	const uint8_t *p;
+
+	if (!lazy_size) {
+		mark_dirty(0, CBI_EEPROM_SIZE);
+		if (read_header())
+			return EC_ERROR_INVAL;
+		lazy_size = sizeof(*head);
+	}
+
+	/* Tags read by earlier lookups */
+	for (p = head->data; p < &cbi[lazy_size]; p += sizeof(*t) + t->size) {
+		t = (struct cbi_data *)p;
+		if (t->tag == tag) {
+			*d = t;
+			return EC_SUCCESS;
+		}
+	}
+
+	/* Then the rest of the image, one tag at a time */
+	*d = NULL;
+	while (lazy_size + sizeof(*t) < head->total_size) {
+		t = (struct cbi_data *)&cbi[lazy_size];
+		if (read_eeprom(lazy_size, (uint8_t *)t, sizeof(*t)))
+			return EC_ERROR_INVAL;
+		if (lazy_size + sizeof(*t) + t->size > head->total_size)
+			return EC_ERROR_INVAL;
+		if (t->size &&
+		    read_eeprom(lazy_size + sizeof(*t), t->value, t->size))
+			return EC_ERROR_INVAL;
+		lazy_size += sizeof(*t) + t->size;
+		if (t->tag == tag) {
+			*d = t;
+			break;
+		}
+	}
+
+	/* The last tag completes the image: check it before using it */
+	if (lazy_size + sizeof(*t) >= head->total_size) {
+		if (cbi_crc8(head) != head->crc)
+			return EC_ERROR_INVAL;
+		cached_read_result = EC_SUCCESS;
+		dirty_pages = 0;
+	}
+
+	return EC_SUCCESS;
+}
+
+static int find_tag(enum cbi_data_tag tag, const struct cbi_data **d)
+{
+	if (IS_ENABLED(CONFIG_CBI_LAZY_READ) &&
+	    cached_read_result == EC_ERROR_CBI_CACHE_INVALID &&
+	    find_tag_lazily(tag, d) == EC_SUCCESS)
+		return EC_SUCCESS;
+
+	/* A full read also settles any error seen by a lazy lookup. */
+	if (read_board_info())
+		return EC_ERROR_UNKNOWN;
+
+	*d = cbi_find_tag(cbi, tag);
+	return EC_SUCCESS;
+}
+
 __attribute__((weak))
 int cbi_board_override(enum cbi_data_tag tag, uint8_t *buf, uint8_t *size)
 {
@@ -190,10 +314,9 @@ int cbi_get_board_info(enum cbi_data_tag tag, uint8_t *buf, uint8_t *size)
 {
 	const struct cbi_data *d;
 
-	if (read_board_info())
+	if (find_tag(tag, &d))
 		return EC_ERROR_UNKNOWN;
 
-	d = cbi_find_tag(cbi, tag);
 	if (!d)
 		/* Not found */
 		return EC_ERROR_UNKNOWN;
@@ -218,6 +341,7 @@ static void cbi_remove_tag(void *const cbi, struct cbi_data *const d)
 	const size_t bytes_after = ((uint8_t *)cbi + h->total_size) - next;
 
 	memmove(d, next, bytes_after);
+	mark_dirty((uint8_t *)d - (uint8_t *)cbi, h->total_size);
 	h->total_size -= size;
 }
 
@@ -240,10 +364,12 @@ int cbi_set_board_info(enum cbi_data_tag tag, const uint8_t *buf, uint8_t size)
 			return EC_ERROR_OVERFLOW;
 		/* Append new item */
 		p = cbi_set_data(&cbi[head->total_size], tag, buf, size);
+		mark_dirty(head->total_size, p - cbi);
 		head->total_size = p - cbi;
 	} else {
 		/* Overwrite existing item */
 		memcpy(d->value, buf, d->size);
+		mark_dirty(d->value - cbi, d->value + d->size - cbi);
 	}
 
 	return EC_SUCCESS;
@@ -270,19 +396,28 @@ static int write_board_info(void)
 
 	while (rest > 0) {
 		int size = MIN(EEPROM_PAGE_WRITE_SIZE, rest);
+		int page = (p - cbi) / EEPROM_PAGE_WRITE_SIZE;
 		int rv;
-		rv = i2c_write_block(I2C_PORT_EEPROM, I2C_ADDR_EEPROM_FLAGS,
-				     p - cbi, p, size);
-		if (rv) {
-			CPRINTS("Failed to write for %d", rv);
-			return rv;
+
+		if (dirty_pages & BIT(page)) {
+			rv = i2c_write_block(I2C_PORT_EEPROM,
+					     I2C_ADDR_EEPROM_FLAGS,
+					     p - cbi, p, size);
+			if (rv) {
+				CPRINTS("Failed to write for %d", rv);
+				return rv;
+			}
+			dirty_pages &= ~BIT(page);
+			/* Wait for internal write cycle completion */
+			msleep(EEPROM_PAGE_WRITE_MS);
 		}
-		/* Wait for internal write cycle completion */
-		msleep(EEPROM_PAGE_WRITE_MS);
 		p += size;
 		rest -= size;
 	}
 
+	/* Pages past the end of the image are not part of it any more */
+	dirty_pages = 0;
+
 	return EC_SUCCESS;
 }
 
@@ -349,7 +484,7 @@ static enum ec_status hc_cbi_get(struct host_cmd_handler_args *args)
 	uint8_t size = MIN(args->response_max, UINT8_MAX);
 
 	if (p->flag & CBI_GET_RELOAD)
-		cached_read_result = EC_ERROR_CBI_CACHE_INVALID;
+		invalidate_cache();
 
 	if (cbi_get_board_info(p->tag, args->response, &size))
 		return EC_RES_INVALID_PARAM;
@@ -386,6 +521,7 @@ static enum ec_status hc_cbi_set(struct host_cmd_handler_args *args)
 		memcpy(head->magic, cbi_magic, sizeof(cbi_magic));
 		head->total_size = sizeof(*head);
 		cached_read_result = EC_SUCCESS;
+		mark_dirty(0, CBI_EEPROM_SIZE);
 	} else {
 		if (read_board_info())
 			return EC_RES_ERROR;
@@ -403,6 +539,7 @@ static enum ec_status hc_cbi_set(struct host_cmd_handler_args *args)
 	head->major_version = CBI_VERSION_MAJOR;
 	head->minor_version = CBI_VERSION_MINOR;
 	head->crc = cbi_crc8(head);
+	mark_dirty(0, sizeof(*head));
 
 	/* Skip write if client asks so. */
 	if (p->flag & CBI_SET_NO_SYNC)
@@ -446,7 +583,7 @@ static void dump_cbi(void)
 	uint32_t val;
 
 	/* Ensure we read the latest data from flash. */
-	cached_read_result = EC_ERROR_CBI_CACHE_INVALID;
+	invalidate_cache();
 	read_board_info();
 
 	if (cached_read_result != EC_SUCCESS) {
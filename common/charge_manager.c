@@ -15,6 +15,7 @@
 #include "hooks.h"
 #include "host_command.h"
 #include "system.h"
+#include "task.h"
 #include "tcpm.h"
 #include "timer.h"
 #include "usb_pd.h"
@@ -77,6 +78,13 @@ static struct charge_port_info available_charge[CHARGE_SUPPLIER_COUNT]
 /* Keep track of when the supplier on each port is registered. */
 static timestamp_t registration_time[CHARGE_PORT_COUNT];
 
+/*
+ * Best supplier of each port, by priority then power, so that selecting the
+ * charge port only looks at one supplier per port. Updated whenever the
+ * available charge of the port changes.
+ */
+static int port_best_supplier[CHARGE_PORT_COUNT];
+
 /*
  * Charge current ceiling (mA) for ports. This can be set to temporarily limit
  * the charge pulled from a port, without influencing the port selection logic.
@@ -88,6 +96,11 @@ static int charge_ceil[CHARGE_PORT_COUNT][CEIL_REQUESTOR_COUNT];
 /* Dual-role capability of attached partner port */
 static enum dualrole_capabilities dualrole_capability[CHARGE_PORT_COUNT];
 
+#ifdef CONFIG_CHARGE_MANAGER_DEBOUNCE_MS
+/* A refresh is armed for the current burst of charge changes. */
+static int refresh_debouncing;
+#endif
+
 #ifdef CONFIG_USB_PD_LOGGING
 /* Mark port as dirty when making changes, for later logging */
 static int save_log[CHARGE_PORT_COUNT];
@@ -201,6 +214,32 @@ static int charge_manager_spoof_dualrole_capability(void)
 }
 #endif /* !CONFIG_CHARGE_MANAGER_DRP_CHARGING */
 
+/**
+ * Re-evaluate the best supplier of a port after its available charge changed.
+ *
+ * @param port	Charge port.
+ */
+static void update_port_best_supplier(int port)
+{
+	int best = CHARGE_SUPPLIER_NONE;
+	int i;
+
+	for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i) {
+		if (available_charge[i][port].current == 0 ||
+		    available_charge[i][port].voltage == 0)
+			continue;
+
+		if (best == CHARGE_SUPPLIER_NONE ||
+		    supplier_priority[i] < supplier_priority[best] ||
+		    (supplier_priority[i] == supplier_priority[best] &&
+		     POWER(available_charge[i][port]) >
+		     POWER(available_charge[best][port])))
+			best = i;
+	}
+
+	port_best_supplier[port] = best;
+}
+
 /**
  * Initialize available charge. Run before board init, so board init can
  * initialize data, if needed.
@@ -210,6 +249,7 @@ static void charge_manager_init(void)
 	int i, j;
 
 	for (i = 0; i < CHARGE_PORT_COUNT; ++i) {
+		port_best_supplier[i] = CHARGE_SUPPLIER_NONE;
 		if (!is_valid_port(i))
 			continue;
 		for (j = 0; j < CHARGE_SUPPLIER_COUNT; ++j) {
@@ -218,6 +258,7 @@ static void charge_manager_init(void)
 			available_charge[j][i].voltage =
 				CHARGE_VOLTAGE_UNINITIALIZED;
 		}
+		update_port_best_supplier(i);
 		for (j = 0; j < CEIL_REQUESTOR_COUNT; ++j)
 			charge_ceil[i][j] = CHARGE_CEIL_NONE;
 		if (!is_pd_port(i))
@@ -585,69 +626,78 @@ static void charge_manager_get_best_charge_port(int *new_port,
 		 *    and (2) are tied.
 		 * available_charge can be changed at any time by other tasks,
 		 * so make no assumptions about its consistency.
+		 *
+		 * Only the best supplier of each port can win (1) and (2), so
+		 * only compare those.
 		 */
-		for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i)
-			for (j = 0; j < CHARGE_PORT_COUNT; ++j) {
-				/* Skip this port if it is not valid. */
-				if (!is_valid_port(j))
-					continue;
-
-				/*
-				 * Skip this supplier if there is no
-				 * available charge.
-				 */
-				if (available_charge[i][j].current == 0 ||
-				    available_charge[i][j].voltage == 0)
-					continue;
-
-				/*
-				 * Don't select this port if we have a
-				 * charge on another override port.
-				 */
-				if (override_port != OVERRIDE_OFF &&
-				    override_port == port &&
-				    override_port != j)
-					continue;
+		for (j = 0; j < CHARGE_PORT_COUNT; ++j) {
+			/* Skip this port if it is not valid. */
+			if (!is_valid_port(j))
+				continue;
+
+			/* Skip this port if there is no available charge. */
+			i = port_best_supplier[j];
+			if (i == CHARGE_SUPPLIER_NONE)
+				continue;
+
+			/*
+			 * Keep the active supplier of the active port if it
+			 * is tied with the best one.
+			 */
+			if (j == charge_port && i != charge_supplier &&
+			    charge_supplier != CHARGE_SUPPLIER_NONE &&
+			    supplier_priority[charge_supplier] ==
+			    supplier_priority[i] &&
+			    POWER(available_charge[charge_supplier][j]) ==
+			    POWER(available_charge[i][j]))
+				i = charge_supplier;
+
+			/*
+			 * Don't select this port if we have a
+			 * charge on another override port.
+			 */
+			if (override_port != OVERRIDE_OFF &&
+			    override_port == port &&
+			    override_port != j)
+				continue;
 
 #ifndef CONFIG_CHARGE_MANAGER_DRP_CHARGING
-				/*
-				 * Don't charge from a dual-role port unless
-				 * it is our override port.
-				 */
-				if (dualrole_capability[j] != CAP_DEDICATED &&
-				    override_port != j &&
-				    !charge_manager_spoof_dualrole_capability())
-					continue;
+			/*
+			 * Don't charge from a dual-role port unless
+			 * it is our override port.
+			 */
+			if (dualrole_capability[j] != CAP_DEDICATED &&
+			    override_port != j &&
+			    !charge_manager_spoof_dualrole_capability())
+				continue;
 #endif
 
-				candidate_port_power =
-					POWER(available_charge[i][j]);
-
-				/* Select if no supplier chosen yet. */
-				if (supplier == CHARGE_SUPPLIER_NONE ||
-				/* ..or if supplier priority is higher. */
-				    supplier_priority[i] <
-				    supplier_priority[supplier] ||
-				/* ..or if this is our override port. */
-				   (j == override_port &&
-				    port != override_port) ||
-				/* ..or if priority is tied and.. */
-				   (supplier_priority[i] ==
-				    supplier_priority[supplier] &&
-				/* candidate port can supply more power or.. */
-				   (candidate_port_power > best_port_power ||
-				/*
-				 * candidate port is the active port and can
-				 * supply the same amount of power.
-				 */
-				   (candidate_port_power == best_port_power &&
-				    charge_port == j)))) {
-					supplier = i;
-					port = j;
-					best_port_power = candidate_port_power;
-				}
+			candidate_port_power = POWER(available_charge[i][j]);
+
+			/* Select if no supplier chosen yet. */
+			if (supplier == CHARGE_SUPPLIER_NONE ||
+			/* ..or if supplier priority is higher. */
+			    supplier_priority[i] <
+			    supplier_priority[supplier] ||
+			/* ..or if this is our override port. */
+			   (j == override_port &&
+			    port != override_port) ||
+			/* ..or if priority is tied and.. */
+			   (supplier_priority[i] ==
+			    supplier_priority[supplier] &&
+			/* candidate port can supply more power or.. */
+			   (candidate_port_power > best_port_power ||
+			/*
+			 * candidate port is the active port and can
+			 * supply the same amount of power.
+			 */
+			   (candidate_port_power == best_port_power &&
+			    charge_port == j)))) {
+				supplier = i;
+				port = j;
+				best_port_power = candidate_port_power;
 			}
-
+		}
 	}
 
 #ifdef CONFIG_BATTERY
@@ -685,6 +735,10 @@ static void charge_manager_refresh(void)
 	int ceil;
 	int power_changed = 0;
 
+#ifdef CONFIG_CHARGE_MANAGER_DEBOUNCE_MS
+	refresh_debouncing = 0;
+#endif
+
 	/* Hunt for an acceptable charge port */
 	while (1) {
 		charge_manager_get_best_charge_port(&new_port, &new_supplier);
@@ -716,6 +770,7 @@ static void charge_manager_refresh(void)
 			available_charge[i][new_port].current = 0;
 			available_charge[i][new_port].voltage = 0;
 		}
+		port_best_supplier[new_port] = CHARGE_SUPPLIER_NONE;
 	}
 
 	active_charge_port_initialized = 1;
@@ -845,6 +900,26 @@ static void charge_manager_refresh(void)
 }
 DECLARE_DEFERRED(charge_manager_refresh);
 
+/**
+ * Schedule a refresh after a charge or dual-role change.
+ *
+ * With CONFIG_CHARGE_MANAGER_DEBOUNCE_MS, the first change of a burst arms the
+ * refresh and the following ones ride along, so that the updates of a BC1.2
+ * or PD negotiation end up in a single refresh.
+ */
+static void charge_manager_refresh_after_change(void)
+{
+#ifdef CONFIG_CHARGE_MANAGER_DEBOUNCE_MS
+	if (refresh_debouncing)
+		return;
+	refresh_debouncing = 1;
+	hook_call_deferred(&charge_manager_refresh_data,
+			   CONFIG_CHARGE_MANAGER_DEBOUNCE_MS * MSEC);
+#else
+	hook_call_deferred(&charge_manager_refresh_data, 0);
+#endif
+}
+
 /**
  * Called when charge override times out waiting for power swap.
  */
@@ -944,6 +1019,7 @@ static void charge_manager_make_change(enum charge_manager_change_type change,
 		available_charge[supplier][port].current = charge->current;
 		available_charge[supplier][port].voltage = charge->voltage;
 		registration_time[port] = get_time();
+		update_port_best_supplier(port);
 
 		/*
 		 * After CHARGE_DETECT_DELAY, inform the host that charger
@@ -977,7 +1053,7 @@ static void charge_manager_make_change(enum charge_manager_change_type change,
 	 * attached.
 	 */
 	if (charge_manager_is_seeded())
-		hook_call_deferred(&charge_manager_refresh_data, 0);
+		charge_manager_refresh_after_change();
 }
 
 void pd_set_input_current_limit(int port, uint32_t max_ma,
@@ -1214,38 +1290,76 @@ static inline int is_active_source(int port)
 	return source_port_bitmap & BIT(port);
 }
 
-static int can_supply_max_current(int port)
+/*
+ * Serializes reallocation, so that ports enabled or disabled at the same time
+ * by different PD tasks never see each other's half-applied allocation.
+ */
+static struct mutex source_port_lock;
+
+/**
+ * Compute the Rp of every port for the current set of active sources, in one
+ * pass over the previous allocation.
+ *
+ * @param rp	Filled with the new Rp value of each port.
+ */
+static void source_port_allocate(enum tcpc_rp_value *rp)
 {
+	const int count = board_get_usb_pd_port_count();
+	int max_port = -1;
+	int p;
+
+	for (p = 0; p < count; p++)
+		rp[p] = CONFIG_USB_PD_PULLUP;
+
 #ifdef CONFIG_USB_PD_MAX_TOTAL_SOURCE_CURRENT
 	/*
-	 * This guarantees active 3A source continues to supply 3A.
-	 *
-	 * Since redistribution occurs sequentially, younger ports get
-	 * priority. Priority surfaces only when 3A source is released.
-	 * That is, when 3A source is released, the youngest active
-	 * port gets 3A.
+	 * An active 3A source continues to supply 3A. Otherwise, the lowest
+	 * numbered active source gets it, which is who got it when ports were
+	 * redistributed one at a time.
 	 */
-	int p;
-	if (!is_active_source(port))
-		/* Non-active ports don't get 3A */
-		return 0;
-	for (p = 0; p < board_get_usb_pd_port_count(); p++) {
-		if (p == port)
-			continue;
-		if (source_port_rp[p] ==
-				CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT)
-			return 0;
+	for (p = 0; p < count; p++) {
+		if (is_active_source(p) && source_port_rp[p] ==
+				CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT) {
+			max_port = p;
+			break;
+		}
 	}
-	return 1;
+	for (p = 0; max_port < 0 && p < count; p++)
+		if (is_active_source(p))
+			max_port = p;
 #else
-	return is_active_source(port) && !has_other_active_source(port);
+	/* Only a lone source gets 3A. */
+	for (p = 0; p < count; p++)
+		if (is_active_source(p) && !has_other_active_source(p))
+			max_port = p;
 #endif /* CONFIG_USB_PD_MAX_TOTAL_SOURCE_CURRENT */
+
+	if (max_port >= 0)
+		rp[max_port] = CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT;
+}
+
+static void source_port_apply(int port, enum tcpc_rp_value rp)
+{
+	source_port_rp[port] = rp;
+
+#ifdef CONFIG_USB_PD_LOGGING
+	if (is_connected(port) && !is_sink(port))
+		charge_manager_save_log(port);
+#endif
+
+	typec_set_source_current_limit(port, rp);
+	if (IS_ENABLED(CONFIG_USB_PD_TCPMV2))
+		typec_select_src_current_limit_rp(port, rp);
+	else
+		tcpm_select_rp_value(port, rp);
 }
 
 void charge_manager_source_port(int port, int enable)
 {
+	enum tcpc_rp_value rp[CONFIG_USB_PD_PORT_MAX_COUNT];
 	uint32_t prev_bitmap = source_port_bitmap;
-	int p, rp;
+	uint32_t changed = 0;
+	int p;
 
 	if (enable)
 		deprecated_atomic_or(&source_port_bitmap, 1 << port);
@@ -1256,30 +1370,41 @@ void charge_manager_source_port(int port, int enable)
 	if (prev_bitmap == source_port_bitmap)
 		return;
 
-	/* Set port limit according to policy */
-	for (p = 0; p < board_get_usb_pd_port_count(); p++) {
-		rp = can_supply_max_current(p) ?
-				CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT :
-				CONFIG_USB_PD_PULLUP;
-		source_port_rp[p] = rp;
+	mutex_lock(&source_port_lock);
 
-#ifdef CONFIG_USB_PD_LOGGING
-		if (is_connected(p) && !is_sink(p))
-			charge_manager_save_log(p);
-#endif
+	source_port_allocate(rp);
 
-		typec_set_source_current_limit(p, rp);
-		if (IS_ENABLED(CONFIG_USB_PD_TCPMV2))
-			typec_select_src_current_limit_rp(p, rp);
-		else
-			tcpm_select_rp_value(p, rp);
-		pd_update_contract(p);
+	/*
+	 * Only ports whose Rp changes are touched. Lower the ports losing 3A
+	 * first, so the total never goes over budget while the new 3A port
+	 * is raised.
+	 */
+	for (p = 0; p < board_get_usb_pd_port_count(); p++) {
+		if (rp[p] == source_port_rp[p])
+			continue;
+		changed |= BIT(p);
+		if (rp[p] != CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT)
+			source_port_apply(p, rp[p]);
 	}
+	for (p = 0; p < board_get_usb_pd_port_count(); p++)
+		if ((changed & BIT(p)) &&
+		    rp[p] == CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT)
+			source_port_apply(p, rp[p]);
+
+	mutex_unlock(&source_port_lock);
+
+	/*
+	 * Each port's PD task sends its new Source_Capabilities on its own,
+	 * so all the changed ports renegotiate in parallel.
+	 */
+	for (p = 0; p < board_get_usb_pd_port_count(); p++)
+		if (changed & BIT(p))
+			pd_update_contract(p);
 }
 
 int charge_manager_get_source_pdo(const uint32_t **src_pdo, const int port)
 {
-	if (can_supply_max_current(port)) {
+	if (source_port_rp[port] == CONFIG_USB_PD_MAX_SINGLE_SOURCE_CURRENT) {
 		*src_pdo = pd_src_pdo_max;
 		return pd_src_pdo_max_cnt;
 	}
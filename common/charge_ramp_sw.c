@@ -73,6 +73,13 @@ static timestamp_t reg_time;
 static int stablize_port;
 static int stablize_sup;
 
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+/* Highest limit VBUS held at, lowest one it dipped at (0 if none) */
+static int ramp_good_icl;
+static int ramp_bad_icl;
+static int ramp_step;
+#endif
+
 /* Maximum/minimum input current limit for active charger */
 static int max_icl;
 static int min_icl;
@@ -117,6 +124,43 @@ void chg_ramp_charge_supplier_change(int port, int supplier, int current,
 	}
 }
 
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+/* Start ramping from the minimum input current limit */
+static void ramp_start(void)
+{
+	ramp_good_icl = min_icl;
+	ramp_bad_icl = 0;
+	ramp_step = RAMP_CURR_INCR_MA;
+}
+
+/*
+ * Return the next limit to try after VBUS held (vbus_ok) or dipped at the
+ * active one, or -1 once the limit is found.
+ */
+static int ramp_next_icl(int vbus_ok)
+{
+	if (vbus_ok)
+		ramp_good_icl = active_icl;
+	else
+		ramp_bad_icl = active_icl;
+
+	if (!ramp_bad_icl) {
+		int icl = MIN(active_icl + ramp_step, max_icl);
+
+		if (active_icl == max_icl)
+			return -1;
+		ramp_step = MIN(ramp_step * 2,
+				CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA);
+		return icl;
+	}
+
+	if (ramp_bad_icl - ramp_good_icl <= RAMP_CURR_INCR_MA)
+		return -1;
+
+	return ramp_good_icl + (ramp_bad_icl - ramp_good_icl) / 2;
+}
+#endif
+
 int chg_ramp_get_current_limit(void)
 {
 	/*
@@ -256,6 +300,9 @@ void chg_ramp_task(void *u)
 				 */
 				active_icl_new = min_icl;
 				ramp_st_new = CHG_RAMP_RAMP;
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+				ramp_start();
+#endif
 			}
 			break;
 		case CHG_RAMP_RAMP:
@@ -268,6 +315,26 @@ void chg_ramp_task(void *u)
 				break;
 			}
 
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+			lim = ramp_next_icl(!board_is_vbus_too_low(
+				active_port, CHG_RAMP_VBUS_RAMPING));
+			if (lim >= 0) {
+				active_icl_new = lim;
+			} else if (!ramp_bad_icl) {
+				ramp_st_new = CHG_RAMP_STABLE;
+			} else {
+				CPRINTS("VBUS low at %dmA", ramp_bad_icl);
+				active_icl_new = MAX(min_icl,
+						     MIN(ramp_good_icl,
+							 ramp_bad_icl -
+							 RAMP_ICL_BACKOFF));
+				ramp_st_new = CHG_RAMP_STABILIZE;
+				task_wait_time = STABLIZE_DELAY;
+				stablize_port = active_port;
+				stablize_sup = active_sup;
+			}
+			break;
+#endif
 			/* If VBUS is sagging a lot, then stop ramping */
 			if (board_is_vbus_too_low(active_port,
 						  CHG_RAMP_VBUS_RAMPING)) {
@@ -323,6 +390,9 @@ void chg_ramp_task(void *u)
 						max_icl - RAMP_ICL_BACKOFF);
 				active_icl_new = min_icl;
 				ramp_st_new = CHG_RAMP_RAMP;
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+				ramp_start();
+#endif
 			}
 			task_wait_time = STABLE_VBUS_MONITOR_INTERVAL;
 			break;
@@ -810,6 +810,15 @@ static void update_dynamic_battery_info(void)
 	int send_batt_info_event = 0;
 	static int __bss_slow batt_present;
 	static int batt_os_percentage;
+#ifdef CONFIG_HOST_MEMMAP_NOTIFY
+	/* Battery fields from present voltage to last full charge capacity */
+	const int memmap_size = EC_MEMMAP_BATT_LFCC + sizeof(int) -
+		EC_MEMMAP_BATT_VOLT;
+	uint8_t memmap_old[EC_MEMMAP_BATT_LFCC + sizeof(int) -
+			   EC_MEMMAP_BATT_VOLT];
+
+	memcpy(memmap_old, memmap_volt, memmap_size);
+#endif
 
 	tmp = 0;
 #ifdef CONFIG_EXTPOWER_GPIO
@@ -913,6 +922,11 @@ static void update_dynamic_battery_info(void)
 
 	battery_charger_notify(tmp);
 
+#ifdef CONFIG_HOST_MEMMAP_NOTIFY
+	if (memcmp(memmap_old, memmap_volt, memmap_size))
+		host_memmap_changed(EC_MEMMAP_BATT_VOLT, memmap_size);
+#endif
+
 	if (send_batt_info_event)
 		host_set_single_event(EC_HOST_EVENT_BATTERY);
 	if (send_batt_status_event)
@@ -1351,11 +1365,17 @@ void chgstate_set_manual_current(int curr_ma)
 		manual_current = -1;
 	else
 		manual_current = charger_closest_current(curr_ma);
+#ifdef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+	task_wake(TASK_ID_CHARGER);
+#endif
 }
 
 void chgstate_set_manual_voltage(int volt_mv)
 {
 	manual_voltage = charger_closest_voltage(volt_mv);
+#ifdef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+	task_wake(TASK_ID_CHARGER);
+#endif
 }
 
 /* Force charging off before the battery is full. */
@@ -1378,6 +1398,11 @@ int set_chg_ctrl_mode(enum ec_charge_control_mode mode)
 		manual_voltage = 0;
 	}
 
+#ifdef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+	/* Apply the mode now rather than at the next, possibly slow, poll */
+	task_wake(TASK_ID_CHARGER);
+#endif
+
 	return EC_SUCCESS;
 }
 
@@ -1690,6 +1715,49 @@ static int get_desired_input_current(enum battery_present batt_present,
 	}
 }
 
+#ifdef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+/* What the charger loop acts on; a change polls at the base period again */
+struct charge_loop_inputs {
+	int base_usec;
+	int ac;
+	enum charge_state_v2 state;
+	int requested_voltage;
+	int requested_current;
+	int desired_input_current;
+	int batt_flags;
+	int batt_status;
+};
+
+static struct charge_loop_inputs prev_loop_inputs;
+static int stable_poll_usec;
+
+/* Returns how long to sleep after a pass using the default period base_usec */
+static int charge_adapt_poll_period(int base_usec)
+{
+	struct charge_loop_inputs now;
+
+	memset(&now, 0, sizeof(now));
+	now.base_usec = base_usec;
+	now.ac = curr.ac;
+	now.state = curr.state;
+	now.requested_voltage = curr.requested_voltage;
+	now.requested_current = curr.requested_current;
+	now.desired_input_current = curr.desired_input_current;
+	now.batt_flags = curr.batt.flags;
+	now.batt_status = curr.batt.status;
+
+	if (memcmp(&now, &prev_loop_inputs, sizeof(now)))
+		stable_poll_usec = base_usec;
+	else
+		stable_poll_usec = MIN(stable_poll_usec * 2,
+				       MAX(base_usec,
+					   CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX));
+
+	prev_loop_inputs = now;
+	return stable_poll_usec;
+}
+#endif
+
 /* Main loop */
 void charger_task(void *u)
 {
@@ -2162,6 +2230,12 @@ wait_for_it:
 				/* AC present, so pay closer attention */
 				sleep_usec = CHARGE_POLL_PERIOD_CHARGE;
 			}
+#ifdef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+			/* Shut down on time on a critical battery */
+			if (!battery_critical)
+				sleep_usec = charge_adapt_poll_period(
+					sleep_usec);
+#endif
 		}
 
 		if (IS_ENABLED(CONFIG_USB_PD_PREFER_MV)) {
@@ -2524,6 +2598,11 @@ int charge_set_input_current_limit(int ma, int mv)
 #ifdef CONFIG_CHARGER_MAX_INPUT_CURRENT
 	/* Limit input current limit to max limit for this board */
 	ma = MIN(ma, CONFIG_CHARGER_MAX_INPUT_CURRENT);
+#endif
+#ifdef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+	/* The charger task may be sleeping a long time, look at it now */
+	if (ma != curr.desired_input_current)
+		charge_wakeup();
 #endif
 	curr.desired_input_current = ma;
 #ifdef CONFIG_EC_EC_COMM_BATTERY_MASTER
@@ -6,6 +6,7 @@
 #include "common.h"
 #include "config.h"
 #include "console.h"
+#include "printf.h"
 #include "timer.h"
 #include "uart.h"
 #include "usb_console.h"
@@ -20,6 +21,90 @@
 #define BUFFER_DRAIN_TIME_US (1000000UL * 10 * CONFIG_UART_TX_BUF_SIZE         \
 				/ CONFIG_UART_BAUD_RATE)
 
+/* Characters of the pattern, in order */
+static const char pattern[] =
+	"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+/*
+ * Frames of the measured mode, newline included: "#<seq> <time> " with both
+ * numbers as 8 hex digits, then the pattern starting at character seq.
+ */
+#define FRAME_LEN 64
+#define FRAME_HEADER_LEN 19
+
+/*
+ * Wait until the transmit buffer has room, reloading the watchdog while
+ * other tasks drain it.  Returns the time spent waiting, in us.
+ */
+static uint32_t wait_tx(int (*tx_is_blocked_)(void),
+			timestamp_t *prev_watchdog_time)
+{
+	timestamp_t start = get_time();
+
+	while (tx_is_blocked_()) {
+		timestamp_t current_time;
+
+		/*
+		 * Let's let other tasks run for a bit while buffer is
+		 * being drained a little.
+		 */
+		usleep(BUFFER_DRAIN_TIME_US/10);
+
+		current_time = get_time();
+
+		if ((current_time.val - prev_watchdog_time->val) <
+		    (CONFIG_WATCHDOG_PERIOD_MS * 1000 / 2))
+			continue;
+
+		watchdog_reload();
+		prev_watchdog_time->val = current_time.val;
+	}
+
+	return get_time().val - start.val;
+}
+
+/*
+ * Send numbered, timestamped frames for a host to measure the throughput,
+ * loss, reordering and latency jitter of the console, then a summary line.
+ */
+static void chargen_frames(uint32_t count, int (*putc_)(int c),
+			   int (*tx_is_blocked_)(void))
+{
+	char frame[FRAME_LEN + 1];
+	timestamp_t prev_watchdog_time = get_time();
+	timestamp_t start = prev_watchdog_time;
+	uint32_t blocked_us = 0;
+	uint32_t dropped = 0;
+	uint32_t seq;
+	int i;
+
+	for (seq = 0; seq < count; seq++) {
+		if (uart_getc() == 'x' || usb_getc() == 'x')
+			break;
+
+		snprintf(frame, sizeof(frame), "#%08x %08x ", seq,
+			 get_time().le.lo);
+		for (i = FRAME_HEADER_LEN; i < FRAME_LEN - 1; i++)
+			frame[i] = pattern[(seq + i) % (sizeof(pattern) - 1)];
+		frame[FRAME_LEN - 1] = '\n';
+
+		for (i = 0; i < FRAME_LEN; i++) {
+			blocked_us += wait_tx(tx_is_blocked_,
+					      &prev_watchdog_time);
+			if (putc_(frame[i]))
+				dropped++;
+		}
+	}
+
+	/* Sent through putc_ too, so that it doesn't overtake the frames */
+	snprintf(frame, sizeof(frame), "#end %u %u %u %u\n", seq,
+		 (uint32_t)(get_time().val - start.val), blocked_us, dropped);
+	for (i = 0; frame[i]; i++) {
+		wait_tx(tx_is_blocked_, &prev_watchdog_time);
+		putc_(frame[i]);
+	}
+}
+
 /*
  * Generate a stream of characters on the UART (and USB) console.
  *
@@ -35,12 +120,18 @@
  * argv[2] - limit number of printed characters to this amount. If not
  *           specified - keep printing indefinitely.
  *
+ * With argv[1] set to "frames", argv[2] is the number of FRAME_LEN byte
+ * frames to send instead.  They end with a "#end <frames> <us> <blocked us>
+ * <dropped chars>" line; util/uart_stress_tester.py --frames measures
+ * the stream.
+ *
  * Hitting 'x' on the keyboard stops the generator.
  */
 static int command_chargen(int argc, char **argv)
 {
 	int wrap_value = 0;
 	int wrap_counter = 0;
+	int frames = 0;
 	uint8_t c;
 	uint32_t seq_counter = 0;
 	uint32_t seq_number = 0;
@@ -52,8 +143,12 @@ static int command_chargen(int argc, char **argv)
 	while (uart_getc() != -1 || usb_getc() != -1)
 		; /* Drain received characters, if any. */
 
-	if (argc > 1)
-		wrap_value = atoi(argv[1]);
+	if (argc > 1) {
+		if (!strcasecmp(argv[1], "frames"))
+			frames = 1;
+		else
+			wrap_value = atoi(argv[1]);
+	}
 
 	if (argc > 2)
 		seq_number = atoi(argv[2]);
@@ -68,27 +163,17 @@ static int command_chargen(int argc, char **argv)
 	}
 #endif
 
+	if (frames) {
+		if (!seq_number)
+			return EC_ERROR_PARAM2;
+		chargen_frames(seq_number, putc_, tx_is_blocked_);
+		return EC_SUCCESS;
+	}
+
 	c = '0';
 	prev_watchdog_time = get_time();
 	while (uart_getc() != 'x' && usb_getc() != 'x') {
-		timestamp_t current_time;
-
-		while (tx_is_blocked_()) {
-			/*
-			 * Let's let other tasks run for a bit while buffer is
-			 * being drained a little.
-			 */
-			usleep(BUFFER_DRAIN_TIME_US/10);
-
-			current_time = get_time();
-
-			if ((current_time.val - prev_watchdog_time.val) <
-			    (CONFIG_WATCHDOG_PERIOD_MS * 1000 / 2))
-				continue;
-
-			watchdog_reload();
-			prev_watchdog_time.val = current_time.val;
-		}
+		wait_tx(tx_is_blocked_, &prev_watchdog_time);
 
 		putc_(c++);
 
@@ -114,12 +199,13 @@ static int command_chargen(int argc, char **argv)
 }
 DECLARE_SAFE_CONSOLE_COMMAND(chargen, command_chargen,
 #if defined(CONFIG_USB_CONSOLE) || defined(CONFIG_USB_CONSOLE_STREAM)
-			     "[seq_length [num_chars [usb]]]",
+			     "[seq_length|frames [num_chars [usb]]]",
 #else
-			     "[seq_length [num_chars]]",
+			     "[seq_length|frames [num_chars]]",
 #endif
 			     "Generate a constant stream of characters on the "
 			     "UART console,\nrepeating every 'seq_length' "
-			     "characters, up to 'num_chars' total."
+			     "characters, up to 'num_chars' total,\nor "
+			     "'num_chars' numbered and timestamped frames."
 	);
 #endif  /* !SECTION_IS_RO */
@@ -13,6 +13,7 @@
 #include "dptf.h"
 #include "host_command.h"
 #include "printf.h"
+#include "task.h"
 #include "util.h"
 #include "hooks.h"
 
@@ -253,6 +254,145 @@ static void charger_chips_init(void)
 DECLARE_HOOK(HOOK_INIT, charger_chips_init, HOOK_PRIO_INIT_I2C + 1);
 #endif
 
+#ifdef CONFIG_CHARGER_REG_CACHE
+struct charger_reg_cache_entry {
+	uint8_t chgnum;
+	uint8_t offset;
+	uint8_t valid;
+	uint16_t value;
+};
+
+/*
+ * Entries are claimed on first use and keep their register; only the value
+ * goes invalid.  Registers past the last entry just aren't cached.
+ *
+ * The RAM is cleared by a sysjump, so the new image starts with an empty
+ * cache and reads the registers again.
+ */
+static struct charger_reg_cache_entry
+	charger_reg_cache[CONFIG_CHARGER_REG_CACHE_SIZE];
+static int charger_reg_cache_used;
+
+/* Held across the I2C transfer, so the cache and the chip agree */
+static struct mutex charger_reg_cache_lock;
+
+/* Find the entry of a register, claiming a free one.  NULL if full. */
+static struct charger_reg_cache_entry *charger_reg_cache_entry(int chgnum,
+							      int offset)
+{
+	struct charger_reg_cache_entry *e;
+
+	for (e = charger_reg_cache;
+	     e < charger_reg_cache + charger_reg_cache_used; e++)
+		if (e->chgnum == chgnum && e->offset == offset)
+			return e;
+
+	if (charger_reg_cache_used == ARRAY_SIZE(charger_reg_cache))
+		return NULL;
+
+	e = charger_reg_cache + charger_reg_cache_used++;
+	e->chgnum = chgnum;
+	e->offset = offset;
+	e->valid = 0;
+	return e;
+}
+
+static int charger_cache_fill(int chgnum, struct charger_reg_cache_entry *e,
+			      int offset, int *value)
+{
+	int rv;
+
+	if (e && e->valid) {
+		*value = e->value;
+		return EC_SUCCESS;
+	}
+
+	rv = i2c_read16(chg_chips[chgnum].i2c_port,
+			chg_chips[chgnum].i2c_addr_flags, offset, value);
+	if (e && !rv) {
+		e->value = *value;
+		e->valid = 1;
+	}
+
+	return rv;
+}
+
+static int charger_cache_store(int chgnum, struct charger_reg_cache_entry *e,
+			       int offset, int value)
+{
+	int rv;
+
+	if (e && e->valid && e->value == value)
+		return EC_SUCCESS;
+
+	rv = i2c_write16(chg_chips[chgnum].i2c_port,
+			 chg_chips[chgnum].i2c_addr_flags, offset, value);
+	if (e) {
+		/* After a failed write, the register could hold anything */
+		e->value = value;
+		e->valid = !rv;
+	}
+
+	return rv;
+}
+
+enum ec_error_list charger_cached_read16(int chgnum, int offset, int *value)
+{
+	int rv;
+
+	mutex_lock(&charger_reg_cache_lock);
+	rv = charger_cache_fill(chgnum, charger_reg_cache_entry(chgnum, offset),
+				offset, value);
+	mutex_unlock(&charger_reg_cache_lock);
+
+	return rv;
+}
+
+enum ec_error_list charger_cached_write16(int chgnum, int offset, int value)
+{
+	int rv;
+
+	mutex_lock(&charger_reg_cache_lock);
+	rv = charger_cache_store(chgnum,
+				 charger_reg_cache_entry(chgnum, offset),
+				 offset, value);
+	mutex_unlock(&charger_reg_cache_lock);
+
+	return rv;
+}
+
+enum ec_error_list charger_cached_update16(int chgnum, int offset,
+					   uint16_t mask,
+					   enum mask_update_action action)
+{
+	struct charger_reg_cache_entry *e;
+	int value;
+	int rv;
+
+	mutex_lock(&charger_reg_cache_lock);
+	e = charger_reg_cache_entry(chgnum, offset);
+	rv = charger_cache_fill(chgnum, e, offset, &value);
+	if (!rv)
+		rv = charger_cache_store(chgnum, e, offset,
+					 action == MASK_SET ? value | mask :
+							      value & ~mask);
+	mutex_unlock(&charger_reg_cache_lock);
+
+	return rv;
+}
+
+void charger_cache_invalidate(int chgnum)
+{
+	int i;
+
+	mutex_lock(&charger_reg_cache_lock);
+	for (i = 0; i < charger_reg_cache_used; i++)
+		if (charger_reg_cache[i].chgnum == chgnum)
+			charger_reg_cache[i].valid = 0;
+	mutex_unlock(&charger_reg_cache_lock);
+}
+#endif /* CONFIG_CHARGER_REG_CACHE */
+
 enum ec_error_list charger_post_init(void)
 {
 	int chgnum = 0;
@@ -122,30 +122,43 @@ static int split_words(char *input, int *argc, char **argv)
  * command.  So "foo" will match "foobar" as long as there isn't also a
  * command "food".
  *
+ * The linker sorts .rodata.cmds by section name, which is the command name,
+ * so the commands matching a prefix are next to each other and a binary
+ * search finds the first one.  Command names are lower case, so that order
+ * is the same as the case-insensitive one used here.
+ *
  * @param name		Command name to find.
  *
  * @return A pointer to the command structure, or NULL if no match found.
  */
 static const struct console_command *find_command(char *name)
 {
-	const struct console_command *cmd, *match = NULL;
+	const struct console_command *l = __cmds, *r = __cmds_end, *m;
 	int match_length = strlen(name);
 
-	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
-		if (!strncasecmp(name, cmd->name, match_length)) {
-			if (match)
-				return NULL;
-			/*
-			 * Check if 'cmd->name' is of the same length as
-			 * 'name'. If yes, then we have a full match.
-			 */
-			if (cmd->name[match_length] == '\0')
-				return cmd;
-			match = cmd;
-		}
+	/* Find the first command not sorting before name */
+	while (l < r) {
+		m = l + (r - l) / 2;
+		if (strncasecmp(m->name, name, match_length) < 0)
+			l = m + 1;
+		else
+			r = m;
 	}
 
-	return match;
+	if (l == __cmds_end || strncasecmp(l->name, name, match_length))
+		return NULL;
+
+	/*
+	 * A full match sorts before the longer names it is a prefix of.
+	 * Otherwise the match must be unique.
+	 */
+	if (l->name[match_length] == '\0')
+		return l;
+	if (l + 1 < __cmds_end &&
+	    !strncasecmp(l[1].name, name, match_length))
+		return NULL;
+
+	return l;
 }
 
 
@@ -6,6 +6,7 @@
 /* Console output module for Chrome EC */
 
 #include "console.h"
+#include "printf.h"
 #include "uart.h"
 #include "usb_console.h"
 #include "util.h"
@@ -72,7 +73,10 @@ int cprintf(enum console_channel channel, const char *format, ...)
 	usb_va_end(args);
 
 	va_start(args, format);
-	rv2 = uart_vprintf(format, args);
+	if (IS_ENABLED(CONFIG_CONSOLE_TOKENIZED) && channel != CC_COMMAND)
+		rv2 = uart_vtokenize(0, format, args);
+	else
+		rv2 = uart_vprintf(format, args);
 	va_end(args);
 
 	return rv1 == EC_SUCCESS ? rv2 : rv1;
@@ -89,6 +93,34 @@ int cprints(enum console_channel channel, const char *format, ...)
 		return EC_SUCCESS;
 #endif
 
+#ifdef CONFIG_CONSOLE_TOKENIZED
+	/* The host adds the timestamp and brackets when decoding the record */
+	if (channel != CC_COMMAND) {
+		va_start(args, format);
+		rv = uart_vtokenize(PRINTF_TOKEN_TIMESTAMP, format, args);
+		va_end(args);
+
+#if defined(CONFIG_USB_CONSOLE) || defined(CONFIG_USB_CONSOLE_STREAM)
+		{
+			/* The USB console has no decoder; keep it as text */
+			char ts[24];
+
+			snprintf(ts, sizeof(ts), "[%pT ", PRINTF_TIMESTAMP_NOW);
+			r = usb_puts(ts);
+			va_start(args, format);
+			if (!r)
+				r = usb_vprintf(format, args);
+			va_end(args);
+			if (!r)
+				r = usb_puts("]\n");
+			if (!rv)
+				rv = r;
+		}
+#endif
+		return rv;
+	}
+#endif
+
 	rv = cprintf(channel, "[%pT ", PRINTF_TIMESTAMP_NOW);
 
 	va_start(args, format);
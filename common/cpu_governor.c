@@ -0,0 +1,108 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Fast CPU clock governor */
+
+#include "clock.h"
+#include "common.h"
+#include "console.h"
+#include "hooks.h"
+#include "task.h"
+#include "timer.h"
+#include "util.h"
+
+BUILD_ASSERT(MODULE_COUNT <= 64);
+BUILD_ASSERT(CONFIG_CPU_GOVERNOR_DOWN_PCT < CONFIG_CPU_GOVERNOR_UP_PCT);
+
+static struct mutex governor_lock;
+/* Modules asking for the fast clock */
+static uint64_t requests;
+/* Set while the last tick was busy enough to need the fast clock */
+static int busy;
+static int fast;
+static int utilization_pct;
+static uint32_t switch_count;
+
+/* Must be called with governor_lock held. */
+static void governor_apply(void)
+{
+	int want = requests || busy;
+
+	if (want == fast)
+		return;
+
+	fast = want;
+	switch_count++;
+	clock_enable_module(MODULE_FAST_CPU, fast);
+}
+
+void clock_request_fast_cpu(enum module_id module, int enable)
+{
+	mutex_lock(&governor_lock);
+	if (enable) {
+		requests |= BIT_ULL(module);
+		governor_apply();
+	} else {
+		/* The governor tick switches down, see governor_tick(). */
+		requests &= ~BIT_ULL(module);
+	}
+	mutex_unlock(&governor_lock);
+}
+
+#ifdef CONFIG_TASK_PROFILING
+/* Share of the last tick spent outside of the idle task, in percent */
+static int governor_utilization(void)
+{
+	static uint64_t last_time, last_idle;
+	uint64_t now = get_time().val;
+	uint64_t idle = task_get_runtime(TASK_ID_IDLE);
+	uint64_t elapsed = now - last_time;
+	int pct;
+
+	if (!last_time || !elapsed || idle - last_idle > elapsed)
+		pct = 0;
+	else
+		pct = 100 - (idle - last_idle) * 100 / elapsed;
+
+	last_time = now;
+	last_idle = idle;
+	return pct;
+}
+#else
+static int governor_utilization(void)
+{
+	return 0;
+}
+#endif
+
+static void governor_tick(void)
+{
+	int pct = governor_utilization();
+
+	mutex_lock(&governor_lock);
+	utilization_pct = pct;
+	if (pct > CONFIG_CPU_GOVERNOR_UP_PCT)
+		busy = 1;
+	else if (pct < CONFIG_CPU_GOVERNOR_DOWN_PCT)
+		busy = 0;
+	governor_apply();
+	mutex_unlock(&governor_lock);
+}
+DECLARE_HOOK(HOOK_TICK, governor_tick, HOOK_PRIO_DEFAULT);
+
+static int command_cpu_governor(int argc, char **argv)
+{
+	ccprintf("fast: %d (%d switches)\n", fast, switch_count);
+	ccprintf("utilization: %d%% (up > %d%%, down < %d%%)\n",
+		 utilization_pct, CONFIG_CPU_GOVERNOR_UP_PCT,
+		 CONFIG_CPU_GOVERNOR_DOWN_PCT);
+	ccprintf("requests: 0x%08x%08x\n", (uint32_t)(requests >> 32),
+		 (uint32_t)requests);
+	ccprintf("freq: %d Hz\n", clock_get_freq());
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(cpugov, command_cpu_governor,
+			     NULL,
+			     "Print the fast CPU clock governor state");
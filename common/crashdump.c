@@ -0,0 +1,149 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Extended crash dump saved on panics */
+
+#include "common.h"
+#include "crashdump.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "link_defs.h"
+#include "task.h"
+#include "timer.h"
+#include "uart.h"
+#include "util.h"
+
+#define STACK_WORDS CONFIG_PANIC_CRASHDUMP_STACK_WORDS
+#define HOST_CMDS CONFIG_PANIC_CRASHDUMP_HOST_CMDS
+#define CONSOLE_SIZE CONFIG_PANIC_CRASHDUMP_CONSOLE_SIZE
+
+BUILD_ASSERT(STACK_WORDS <= UINT8_MAX);
+BUILD_ASSERT(HOST_CMDS <= UINT8_MAX);
+
+#define TASK_RECORD_SIZE (sizeof(struct ec_crashdump_task) + \
+			  STACK_WORDS * sizeof(uint32_t))
+
+/* Largest dump, with all of the console buffer filled */
+#define DUMP_MAX_SIZE (sizeof(struct ec_crashdump_header) + \
+		       TASK_ID_COUNT * TASK_RECORD_SIZE + \
+		       HOST_CMDS * sizeof(struct ec_crashdump_host_cmd) + \
+		       CONSOLE_SIZE)
+
+static uint32_t dump[DIV_ROUND_UP(DUMP_MAX_SIZE, sizeof(uint32_t))]
+	__preserved_logs(crashdump);
+
+/* Recent host commands, kept as they will be saved */
+static struct ec_crashdump_host_cmd host_cmds[HOST_CMDS];
+static uint32_t host_cmd_next;
+
+int crashdump_host_command_begin(uint16_t command, uint8_t version)
+{
+	int slot = host_cmd_next++ % HOST_CMDS;
+	struct ec_crashdump_host_cmd *c = &host_cmds[slot];
+
+	c->time_us = get_time().le.lo;
+	c->command = command;
+	c->version = version;
+	c->result = EC_CRASHDUMP_HOST_CMD_RUNNING;
+
+	return slot;
+}
+
+void crashdump_host_command_end(int slot, int result)
+{
+	host_cmds[slot].result = result;
+}
+
+void crashdump_capture(uint32_t sp)
+{
+	struct ec_crashdump_header *h = (struct ec_crashdump_header *)dump;
+	uint8_t *out = (uint8_t *)(h + 1);
+	int current = task_get_current();
+	int count = MIN(host_cmd_next, HOST_CMDS);
+	int i;
+
+	h->magic = 0;
+	h->version = EC_CRASHDUMP_VERSION;
+	h->reserved = 0;
+	h->time_us = get_time().le.lo;
+	h->task_count = TASK_ID_COUNT;
+	h->current_task = current;
+	h->stack_words = STACK_WORDS;
+	h->host_cmd_count = count;
+	h->reserved2 = 0;
+
+	for (i = 0; i < TASK_ID_COUNT; i++) {
+		struct ec_crashdump_task *t = (struct ec_crashdump_task *)out;
+		uint32_t *stack;
+		uint32_t *top;
+		uint32_t *p;
+		int size;
+
+		size = task_get_stack(i, &stack, &t->sp);
+		top = stack + size / sizeof(uint32_t);
+		/* The saved SP of the running task is stale */
+		if (i == current)
+			t->sp = sp;
+		p = (uint32_t *)t->sp;
+
+		t->stack_size = size;
+		t->reserved = 0;
+		t->num_words = 0;
+		if (!(t->sp & 3) && p >= stack && p <= top)
+			t->num_words = MIN(top - p, STACK_WORDS);
+		memcpy(t->stack, p, t->num_words * sizeof(uint32_t));
+		memset(t->stack + t->num_words, 0,
+		       (STACK_WORDS - t->num_words) * sizeof(uint32_t));
+		out += TASK_RECORD_SIZE;
+	}
+
+	/* Oldest first */
+	for (i = 0; i < count; i++) {
+		memcpy(out, &host_cmds[(host_cmd_next - count + i) % HOST_CMDS],
+		       sizeof(host_cmds[0]));
+		out += sizeof(host_cmds[0]);
+	}
+
+	h->console_size = uart_buffer_copy_tail((char *)out, CONSOLE_SIZE);
+	out += h->console_size;
+
+	h->size = out - (uint8_t *)dump;
+	h->magic = EC_CRASHDUMP_MAGIC;
+}
+
+static int dump_valid(void)
+{
+	const struct ec_crashdump_header *h =
+		(const struct ec_crashdump_header *)dump;
+
+	return h->magic == EC_CRASHDUMP_MAGIC &&
+	       h->version == EC_CRASHDUMP_VERSION &&
+	       h->size <= sizeof(dump);
+}
+
+static enum ec_status
+host_command_crashdump_read(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_crashdump_read *p = args->params;
+	struct ec_response_crashdump_read *r = args->response;
+	struct ec_crashdump_header *h = (struct ec_crashdump_header *)dump;
+	uint32_t size = dump_valid() ? h->size : 0;
+	uint32_t len;
+
+	if (p->offset > size)
+		return EC_RES_INVALID_PARAM;
+
+	len = MIN(size - p->offset, args->response_max - sizeof(*r));
+	r->size = size;
+	memcpy(r->data, (uint8_t *)dump + p->offset, len);
+
+	if (p->flags & EC_CRASHDUMP_READ_CLEAR)
+		h->magic = 0;
+
+	args->response_size = sizeof(*r) + len;
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_CRASHDUMP_READ, host_command_crashdump_read,
+		     EC_VER_MASK(0));
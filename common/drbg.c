@@ -0,0 +1,167 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* HMAC-SHA256 DRBG (NIST SP 800-90A) and the random pool built on it */
+
+#include "common.h"
+#include "drbg.h"
+#include "hooks.h"
+#include "sha256.h"
+#include "task.h"
+#include "trng.h"
+#include "util.h"
+
+/* Clear secrets in a way the compiler can't drop */
+static void drbg_wipe(void *buf, size_t len)
+{
+	volatile uint8_t *p = buf;
+
+	while (len--)
+		*p++ = 0;
+}
+
+/*
+ * HMAC_DRBG_Update: K = HMAC(K, V || 0x00 || data), V = HMAC(K, V), then
+ * once more with 0x01 if there is data.
+ */
+static void hmac_drbg_update(struct hmac_drbg_ctx *ctx, const void *data,
+			     size_t len)
+{
+	uint8_t msg[SHA256_DIGEST_SIZE + 1 + HMAC_DRBG_MAX_SEED_SIZE];
+	uint8_t k[SHA256_DIGEST_SIZE];
+	uint8_t round;
+
+	ASSERT(len <= HMAC_DRBG_MAX_SEED_SIZE);
+
+	for (round = 0; round < 2; round++) {
+		memcpy(msg, ctx->v, sizeof(ctx->v));
+		msg[sizeof(ctx->v)] = round;
+		if (len)
+			memcpy(msg + sizeof(ctx->v) + 1, data, len);
+		/* hmac_SHA256() uses its output as scratch before the key */
+		hmac_SHA256(k, ctx->k, sizeof(ctx->k), msg,
+			    sizeof(ctx->v) + 1 + len);
+		memcpy(ctx->k, k, sizeof(k));
+		hmac_SHA256(ctx->v, ctx->k, sizeof(ctx->k), ctx->v,
+			    sizeof(ctx->v));
+		if (!len)
+			break;
+	}
+
+	drbg_wipe(msg, sizeof(msg));
+	drbg_wipe(k, sizeof(k));
+}
+
+void hmac_drbg_init(struct hmac_drbg_ctx *ctx, const void *seed,
+		    size_t seed_len)
+{
+	memset(ctx->k, 0x00, sizeof(ctx->k));
+	memset(ctx->v, 0x01, sizeof(ctx->v));
+	hmac_drbg_update(ctx, seed, seed_len);
+	ctx->reseed_counter = 1;
+}
+
+void hmac_drbg_reseed(struct hmac_drbg_ctx *ctx, const void *seed,
+		      size_t seed_len)
+{
+	hmac_drbg_update(ctx, seed, seed_len);
+	ctx->reseed_counter = 1;
+}
+
+void hmac_drbg_generate(struct hmac_drbg_ctx *ctx, void *out, size_t out_len)
+{
+	uint8_t *p = out;
+
+	while (out_len) {
+		size_t n = MIN(out_len, sizeof(ctx->v));
+
+		hmac_SHA256(ctx->v, ctx->k, sizeof(ctx->k), ctx->v,
+			    sizeof(ctx->v));
+		memcpy(p, ctx->v, n);
+		p += n;
+		out_len -= n;
+	}
+
+	hmac_drbg_update(ctx, NULL, 0);
+	ctx->reseed_counter++;
+}
+
+#ifdef CONFIG_RNG_DRBG
+/* 256 bits of entropy and a 128 bit nonce, read from the TRNG */
+#define SEED_SIZE 48
+
+static struct hmac_drbg_ctx drbg;
+static int drbg_seeded;
+static struct mutex drbg_mutex;
+
+/* Pre-generated output; the last pool_avail bytes are still unused. */
+static uint8_t pool[CONFIG_RNG_DRBG_POOL_SIZE];
+static size_t pool_avail;
+
+/* Seed or reseed the DRBG if it is due.  Must hold drbg_mutex. */
+static void drbg_seed_locked(void)
+{
+	uint8_t seed[SEED_SIZE];
+
+	if (drbg_seeded &&
+	    drbg.reseed_counter <= CONFIG_RNG_DRBG_RESEED_INTERVAL)
+		return;
+
+	init_trng();
+	rand_bytes(seed, sizeof(seed));
+	exit_trng();
+
+	if (drbg_seeded)
+		hmac_drbg_reseed(&drbg, seed, sizeof(seed));
+	else
+		hmac_drbg_init(&drbg, seed, sizeof(seed));
+	drbg_seeded = 1;
+
+	drbg_wipe(seed, sizeof(seed));
+}
+
+static void drbg_refill(void)
+{
+	mutex_lock(&drbg_mutex);
+	if (pool_avail < sizeof(pool)) {
+		drbg_seed_locked();
+		hmac_drbg_generate(&drbg, pool, sizeof(pool));
+		pool_avail = sizeof(pool);
+	}
+	mutex_unlock(&drbg_mutex);
+}
+DECLARE_DEFERRED(drbg_refill);
+
+void drbg_rand_bytes(void *buffer, size_t len)
+{
+	uint8_t *out = buffer;
+	uint8_t *src;
+	size_t n;
+
+	mutex_lock(&drbg_mutex);
+
+	n = MIN(len, pool_avail);
+	src = pool + sizeof(pool) - pool_avail;
+	memcpy(out, src, n);
+	/* Never hand out the same bytes twice */
+	drbg_wipe(src, n);
+	pool_avail -= n;
+
+	if (len > n) {
+		drbg_seed_locked();
+		hmac_drbg_generate(&drbg, out + n, len - n);
+	}
+
+	mutex_unlock(&drbg_mutex);
+
+	hook_call_deferred(&drbg_refill_data, 0);
+}
+
+static void drbg_init(void)
+{
+	hook_call_deferred(&drbg_refill_data, 0);
+}
+DECLARE_HOOK(HOOK_INIT, drbg_init, HOOK_PRIO_DEFAULT);
+#endif /* CONFIG_RNG_DRBG */
@@ -31,6 +31,12 @@
 
 #define EC_EC_HOSTCMD_VERSION 4
 
+/* Minimum idle time on the UART between two transactions */
+#define EC_EC_COMM_GAP_US (10 * MSEC)
+
+/* End of the last transaction, successful or not */
+static timestamp_t last_transaction_end;
+
 /* Print extra debugging information */
 #undef EXTRA_DEBUG
 
@@ -105,6 +111,7 @@ static int write_command(uint16_t command,
 	static uint8_t cur_seq;
 	int ret;
 	int hascrc, response_seq;
+	uint64_t gap_us;
 
 	struct ec_host_request4 *request_header = (void *)data;
 	/* Request (TX) length is header + (data + crc8), response follows. */
@@ -119,12 +126,14 @@ static int write_command(uint16_t command,
 
 	/*
 	 * Make sure there is a gap between each command, so that the slave
-	 * can recover its state machine after each command.
-	 *
-	 * TODO(b:65697962): We can be much smarter than this, and record the
-	 * last transaction time instead of just sleeping blindly.
+	 * can recover its state machine after each command. Only the part of
+	 * the gap that has not already elapsed since the last transaction is
+	 * waited for: the charger loop usually polls the base long after the
+	 * previous command completed.
 	 */
-	usleep(10*MSEC);
+	gap_us = get_time().val - last_transaction_end.val;
+	if (gap_us < EC_EC_COMM_GAP_US)
+		usleep(EC_EC_COMM_GAP_US - gap_us);
 
 #ifdef DEBUG_EC_COMM_STATS
 	if ((comm_stats.total % 128) == 0) {
@@ -156,6 +165,7 @@ static int write_command(uint16_t command,
 
 	ret = uart_alt_pad_write_read((void *)data, tx_length,
 				      (void *)data, rx_length, timeout_us);
+	last_transaction_end = get_time();
 
 	INCR_COMM_STATS(total);
 
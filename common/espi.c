@@ -6,6 +6,7 @@
 /* eSPI common functionality for Chrome EC */
 
 #include "common.h"
+#include "console.h"
 #include "gpio.h"
 #include "registers.h"
 #include "espi.h"
@@ -55,3 +56,74 @@ int espi_signal_is_vw(int signal)
 {
 	return ((signal >= VW_SIGNAL_START) && (signal < VW_SIGNAL_END));
 }
+
+#ifdef CONFIG_HOSTCMD_ESPI_VW_LATENCY
+/* Latency buckets: < 16 us, < 32 us, ... < 1024 us, >= 1024 us */
+#define VW_LATENCY_BUCKETS 8
+#define VW_LATENCY_MIN_SHIFT 4
+
+static const enum espi_vw_signal vw_latency_signals[] = {
+	VW_SLP_S3_L, VW_SLP_S4_L, VW_SLP_S5_L, VW_PLTRST_L,
+};
+
+static struct {
+	uint32_t count;
+	uint32_t max_us;
+	uint32_t hist[VW_LATENCY_BUCKETS];
+} vw_latency[ARRAY_SIZE(vw_latency_signals)];
+
+uint32_t espi_vw_latency_start(void)
+{
+	return get_time().le.lo;
+}
+
+void espi_vw_latency_record(enum espi_vw_signal signal, uint32_t start)
+{
+	uint32_t us = get_time().le.lo - start;
+	int i, bucket;
+
+	for (i = 0; i < ARRAY_SIZE(vw_latency_signals); i++)
+		if (vw_latency_signals[i] == signal)
+			break;
+	if (i == ARRAY_SIZE(vw_latency_signals))
+		return;
+
+	if (us < BIT(VW_LATENCY_MIN_SHIFT))
+		bucket = 0;
+	else
+		bucket = MIN(__fls(us) - VW_LATENCY_MIN_SHIFT + 1,
+			     VW_LATENCY_BUCKETS - 1);
+	vw_latency[i].hist[bucket]++;
+	vw_latency[i].count++;
+	if (us > vw_latency[i].max_us)
+		vw_latency[i].max_us = us;
+}
+
+static int command_vw_latency(int argc, char **argv)
+{
+	int i, j;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(vw_latency, 0, sizeof(vw_latency));
+		return EC_SUCCESS;
+	}
+
+	ccprintf("%-16s  count max us    <16    <32    <64   <128   <256"
+		 "   <512  <1024 >=1024\n", "wire");
+
+	for (i = 0; i < ARRAY_SIZE(vw_latency_signals); i++) {
+		ccprintf("%-16s %6d %6d",
+			 espi_vw_get_wire_name(vw_latency_signals[i]),
+			 vw_latency[i].count, vw_latency[i].max_us);
+		for (j = 0; j < VW_LATENCY_BUCKETS; j++)
+			ccprintf(" %6d", vw_latency[i].hist[j]);
+		ccprintf("\n");
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(vwlatency, command_vw_latency, "[clear]",
+			"Print virtual wire handling latency histogram");
+#endif
@@ -5,8 +5,12 @@
 
 #include "common.h"
 #include "console.h"
+#include "crc8.h"
 #include "event_log.h"
 #include "hooks.h"
+#include "host_command.h"
+#include "link_defs.h"
+#include "mkbp_event.h"
 #include "task.h"
 #include "timer.h"
 #include "util.h"
@@ -15,7 +19,12 @@
 #define UNIT_SIZE sizeof(struct event_log_entry)
 #define UNIT_COUNT (CONFIG_EVENT_LOG_SIZE/UNIT_SIZE)
 #define UNIT_COUNT_MASK		(UNIT_COUNT - 1)
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+static struct event_log_entry log_events[UNIT_COUNT]
+			__preserved_logs(log_events);
+#else
 static struct event_log_entry __bss_slow log_events[UNIT_COUNT];
+#endif
 BUILD_ASSERT(POWER_OF_TWO(UNIT_COUNT));
 
 /*
@@ -37,13 +46,133 @@ BUILD_ASSERT(POWER_OF_TWO(UNIT_COUNT));
  * When a writer is done adding its event, it is updating log_tail,
  * so the event can be consumed by log_dequeue_event().
  */
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+static size_t log_head __preserved_logs(log_head);
+static size_t log_tail __preserved_logs(log_tail);
+#else
 static size_t log_head;
 static size_t log_tail;
+#endif
 static size_t log_tail_next;
 
 /* Size of one FIFO entry */
 #define ENTRY_SIZE(payload_sz) (1+DIV_ROUND_UP((payload_sz), UNIT_SIZE))
 
+/*
+ * Every entry gets a sequence number, one more than the entry before it.
+ * Only the number of the entry at log_head is stored; the others are counted
+ * from it.
+ */
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+static uint32_t log_head_seq __preserved_logs(log_head_seq);
+#else
+static uint32_t log_head_seq;
+#endif
+/* Sequence number of the next entry added */
+static uint32_t log_next_seq;
+/* Sequence number of the first entry added since boot */
+static uint32_t __maybe_unused log_boot_seq;
+
+/* Copy units of the FIFO from position pos, unwrapping them into dst */
+static void __maybe_unused log_copy(void *dst, size_t pos, size_t units)
+{
+	size_t first = MIN(units, UNIT_COUNT - (pos & UNIT_COUNT_MASK));
+
+	memcpy(dst, log_events + (pos & UNIT_COUNT_MASK), first * UNIT_SIZE);
+	if (first < units)
+		memcpy((uint8_t *)dst + first * UNIT_SIZE, log_events,
+		       (units - first) * UNIT_SIZE);
+}
+
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+/*
+ * Each entry has a CRC-8 of its sequence number and contents in log_crc, at
+ * the index of its first unit, so entries left half-written or corrupted by
+ * a reset are detected by log_init().
+ */
+#define LOG_MAGIC 0x474f4c45 /* "ELOG" */
+static uint32_t log_magic __preserved_logs(log_magic);
+static uint8_t log_crc[UNIT_COUNT] __preserved_logs(log_crc);
+
+static uint8_t log_entry_crc(size_t pos, size_t units, uint32_t seq)
+{
+	uint8_t crc = crc8((uint8_t *)&seq, sizeof(seq));
+	size_t first = MIN(units, UNIT_COUNT - (pos & UNIT_COUNT_MASK));
+
+	crc = crc8_arg((uint8_t *)(log_events + (pos & UNIT_COUNT_MASK)),
+		       first * UNIT_SIZE, crc);
+	if (first < units)
+		crc = crc8_arg((uint8_t *)log_events,
+			       (units - first) * UNIT_SIZE, crc);
+	return crc;
+}
+
+void log_init(void)
+{
+	size_t pos;
+	uint32_t seq;
+
+	if (log_magic != LOG_MAGIC || log_tail - log_head > UNIT_COUNT) {
+		log_magic = LOG_MAGIC;
+		log_head = log_tail = 0;
+		log_head_seq = 0;
+	}
+
+	/* Keep the valid entries, up to the first bad one */
+	pos = log_head;
+	seq = log_head_seq;
+	while (pos != log_tail) {
+		struct event_log_entry *r = log_events + (pos & UNIT_COUNT_MASK);
+		size_t total_size = ENTRY_SIZE(EVENT_LOG_SIZE(r->size));
+
+		if (total_size > log_tail - pos ||
+		    log_crc[pos & UNIT_COUNT_MASK] !=
+		    log_entry_crc(pos, total_size, seq))
+			break;
+		pos += total_size;
+		seq++;
+	}
+
+	log_tail = log_tail_next = pos;
+	log_next_seq = log_boot_seq = seq;
+}
+#endif /* CONFIG_EVENT_LOG_PRESERVED */
+
+/* Discard the oldest entry; interrupts must be disabled. */
+static void log_drop_oldest(void)
+{
+	struct event_log_entry *oldest;
+
+	oldest = log_events + (log_head & UNIT_COUNT_MASK);
+	log_head += ENTRY_SIZE(EVENT_LOG_SIZE(oldest->size));
+	log_head_seq++;
+}
+
+#ifdef CONFIG_EVENT_LOG_NOTIFY
+#ifndef CONFIG_MKBP_EVENT
+#error "CONFIG_EVENT_LOG_NOTIFY needs CONFIG_MKBP_EVENT"
+#endif
+
+/*
+ * Tell the host about new entries from a deferred call: the MKBP code takes
+ * a mutex, and a burst of entries only needs one event.
+ */
+static void log_notify(void)
+{
+	mkbp_send_event(EC_MKBP_EVENT_EVENT_LOG);
+}
+DECLARE_DEFERRED(log_notify);
+
+static int log_get_next_event(uint8_t *out)
+{
+	uint32_t seq = log_next_seq;
+
+	memcpy(out, &seq, sizeof(seq));
+	return sizeof(seq);
+}
+DECLARE_EVENT_SOURCE(EC_MKBP_EVENT_EVENT_LOG, log_get_next_event);
+#endif /* CONFIG_EVENT_LOG_NOTIFY */
+
 void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 			  void *payload, uint32_t timestamp)
 {
@@ -51,21 +180,26 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 	size_t payload_size = EVENT_LOG_SIZE(size);
 	size_t total_size = ENTRY_SIZE(payload_size);
 	size_t current_tail, first;
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+	uint32_t seq;
+#endif
 
 	/* --- critical section : reserve queue space --- */
 	interrupt_disable();
 	current_tail = log_tail_next;
 	log_tail_next = current_tail + total_size;
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+	seq = log_next_seq;
+#endif
+	log_next_seq++;
 	interrupt_enable();
 	/* --- end of critical section --- */
 
 	/* Out of space : discard the oldest entry */
 	while ((UNIT_COUNT - (current_tail - log_head)) < total_size) {
-		struct event_log_entry *oldest;
 		/* --- critical section : atomically free-up space --- */
 		interrupt_disable();
-		oldest = log_events + (log_head & UNIT_COUNT_MASK);
-		log_head += ENTRY_SIZE(EVENT_LOG_SIZE(oldest->size));
+		log_drop_oldest();
 		interrupt_enable();
 		/* --- end of critical section --- */
 	}
@@ -84,9 +218,17 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 	if (first < total_size - 1)
 		memcpy(log_events, ((uint8_t *)payload) + first * UNIT_SIZE,
 			(total_size - first) * UNIT_SIZE);
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+	log_crc[current_tail & UNIT_COUNT_MASK] =
+		log_entry_crc(current_tail, total_size, seq);
+#endif
 	/* mark the entry available in the queue if nobody is behind us */
 	if (current_tail == log_tail)
 		log_tail = log_tail_next;
+
+#ifdef CONFIG_EVENT_LOG_NOTIFY
+	hook_call_deferred(&log_notify_data, 0);
+#endif
 }
 
 int log_dequeue_event(struct event_log_entry *r)
@@ -119,6 +261,7 @@ retry:
 		goto retry;
 	}
 	log_head += total_size;
+	log_head_seq++;
 	interrupt_enable();
 	/* --- end of critical section --- */
 
@@ -141,7 +284,10 @@ static int command_dlog(int argc, char **argv)
 	if (argc > 1) {
 		if (!strcasecmp(argv[1], "clear")) {
 			interrupt_disable();
-			log_head = log_tail = log_tail_next = 0;
+			/* Keep counting, so readers see the entries are gone */
+			while (log_head != log_tail)
+				log_drop_oldest();
+			log_tail_next = log_tail;
 			interrupt_enable();
 
 			return EC_SUCCESS;
@@ -182,3 +328,62 @@ DECLARE_CONSOLE_COMMAND(dlog,
 			"[clear]",
 			"Display/clear TPM event logs");
 #endif
+
+#ifdef HAS_TASK_HOSTCMD
+static enum ec_status event_log_read(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_event_log_read *p = args->params;
+	struct ec_response_event_log_read *r = args->response;
+	uint8_t *data_end = (uint8_t *)r + args->response_max;
+	uint8_t *out;
+	size_t pos, tail;
+	uint32_t seq;
+
+	BUILD_ASSERT(sizeof(struct ec_response_pd_log) == UNIT_SIZE);
+
+retry:
+	interrupt_disable();
+	pos = log_head;
+	tail = log_tail;
+	seq = log_head_seq;
+	interrupt_enable();
+
+	out = r->data;
+	r->seq = seq;
+	r->count = 0;
+	while (pos != tail) {
+		struct event_log_entry *e = log_events + (pos & UNIT_COUNT_MASK);
+		size_t units = ENTRY_SIZE(EVENT_LOG_SIZE(e->size));
+
+		/* Skip entries the host has already read */
+		if ((int32_t)(seq - p->seq) >= 0) {
+			if (out + units * UNIT_SIZE > data_end)
+				break;
+			if (!r->count)
+				r->seq = seq;
+			log_copy(out, pos, units);
+			out += units * UNIT_SIZE;
+			r->count++;
+		}
+
+		/* Start over if a writer discarded what we just read */
+		if ((int32_t)(log_head_seq - seq) > 0)
+			goto retry;
+		pos += units;
+		seq++;
+	}
+
+	if (!r->count)
+		r->seq = seq;
+	r->next_seq = seq;
+	r->boot_seq = log_boot_seq;
+	r->timestamp = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+	memset(r->reserved, 0, sizeof(r->reserved));
+	args->response_size = out - (uint8_t *)r;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_EVENT_LOG_READ,
+		     event_log_read,
+		     EC_VER_MASK(0));
+#endif /* HAS_TASK_HOSTCMD */
@@ -13,6 +13,7 @@
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
+#include "math_util.h"
 #include "printf.h"
 #include "system.h"
 #include "util.h"
@@ -75,6 +76,75 @@ int fan_percent_to_rpm(int fan, int pct)
 }
 #endif	/* CONFIG_FAN_RPM_CUSTOM */
 
+#ifdef CONFIG_FAN_SLEW_CONTROL
+static struct ec_fan_tuning fan_tuning[CONFIG_FANS] = {
+	[0 ... CONFIG_FANS - 1] = {
+		.rise_rpm = CONFIG_FAN_SLEW_RISE_RPM,
+		.fall_rpm = CONFIG_FAN_SLEW_FALL_RPM,
+		.deadband_rpm = CONFIG_FAN_SLEW_DEADBAND_RPM,
+		.lead_pct = CONFIG_FAN_SLEW_LEAD_PCT,
+	},
+};
+
+/* Last speed requested by the thermal task, and with the lead added */
+static int fan_request_rpm[CONFIG_FANS];
+static int fan_wanted_rpm[CONFIG_FANS];
+
+/*
+ * Record a speed requested by the thermal task.  Starting (or kicking a
+ * dragging fan back to) and stopping the fan is done at once, anything else
+ * is left to fan_slew_tick().
+ */
+static void fan_slew_request(int fan, int rpm, int stopped)
+{
+	int step = rpm - fan_request_rpm[fan];
+
+	fan_request_rpm[fan] = rpm;
+	if (rpm && step > 0)
+		rpm = MIN(rpm + step * fan_tuning[fan].lead_pct / 100,
+			  fans[fan].rpm->rpm_max);
+	fan_wanted_rpm[fan] = rpm;
+
+	if (!rpm || stopped)
+		fan_set_rpm_target(FAN_CH(fan), rpm);
+}
+
+/* Largest target change in one tick for a limit in RPM/s, 0 for none */
+static int fan_slew_step(int fan, int rpm_per_sec)
+{
+	if (!rpm_per_sec)
+		return fans[fan].rpm->rpm_max;
+
+	return MAX(rpm_per_sec * (HOOK_TICK_INTERVAL / MSEC) / 1000, 1);
+}
+
+static void fan_slew_tick(void)
+{
+	int fan, target, diff;
+
+	for (fan = 0; fan < fan_count; fan++) {
+		const struct ec_fan_tuning *t = &fan_tuning[fan];
+
+		if (!is_thermal_control_enabled(fan))
+			continue;
+
+		target = fan_get_rpm_target(FAN_CH(fan));
+		diff = fan_wanted_rpm[fan] - target;
+
+		/* The fan is stopped or stopping; leave that to requests. */
+		if (!target || !fan_wanted_rpm[fan])
+			continue;
+		if (ABS(diff) <= t->deadband_rpm)
+			continue;
+
+		diff = CLAMP(diff, -fan_slew_step(fan, t->fall_rpm),
+			     fan_slew_step(fan, t->rise_rpm));
+		fan_set_rpm_target(FAN_CH(fan), target + diff);
+	}
+}
+DECLARE_HOOK(HOOK_TICK, fan_slew_tick, HOOK_PRIO_DEFAULT);
+#endif /* CONFIG_FAN_SLEW_CONTROL */
+
 /* The thermal task will only call this function with pct in [0,100]. */
 test_mockable void fan_set_percent_needed(int fan, int pct)
 {
@@ -101,7 +171,12 @@ test_mockable void fan_set_percent_needed(int fan, int pct)
 	    new_rpm < fans[fan].rpm->rpm_start)
 		new_rpm = fans[fan].rpm->rpm_start;
 
+#ifdef CONFIG_FAN_SLEW_CONTROL
+	fan_slew_request(fan, new_rpm,
+			 actual_rpm < fans[fan].rpm->rpm_min * 9 / 10);
+#else
 	fan_set_rpm_target(FAN_CH(fan), new_rpm);
+#endif
 }
 
 static void set_enabled(int fan, int enable)
@@ -455,6 +530,35 @@ DECLARE_HOST_COMMAND(EC_CMD_THERMAL_AUTO_FAN_CTRL,
 		     hc_thermal_auto_fan_ctrl,
 		     EC_VER_MASK(0)|EC_VER_MASK(1));
 
+#ifdef CONFIG_FAN_SLEW_CONTROL
+static enum ec_status hc_fan_tuning(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_fan_tuning *p = args->params;
+	struct ec_response_fan_tuning *r = args->response;
+
+	if (p->fan_idx >= fan_count)
+		return EC_RES_INVALID_PARAM;
+
+	switch (p->action) {
+	case EC_FAN_TUNING_GET:
+		break;
+	case EC_FAN_TUNING_SET:
+		fan_tuning[p->fan_idx] = p->tuning;
+		break;
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+
+	r->tuning = fan_tuning[p->fan_idx];
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_FAN_TUNING,
+		     hc_fan_tuning,
+		     EC_VER_MASK(0));
+#endif
+
 
 /*****************************************************************************/
 /* Hooks */
@@ -533,7 +637,11 @@ static void pwm_fan_second(void)
 			rpm = fan_get_rpm_actual(FAN_CH(fan));
 		}
 
-		mapped[fan] = rpm;
+		if (mapped[fan] != rpm) {
+			mapped[fan] = rpm;
+			host_memmap_changed(EC_MEMMAP_FAN + fan * sizeof(*mapped),
+					    sizeof(*mapped));
+		}
 	}
 
 	/*
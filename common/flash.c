@@ -72,8 +72,17 @@ BUILD_ASSERT(sizeof(struct persist_state) % CONFIG_FLASH_WRITE_SIZE == 0);
 
 BUILD_ASSERT(sizeof(struct persist_state) <= CONFIG_FW_PSTATE_SIZE);
 
+#ifdef CONFIG_FLASH_PSTATE_LOG
+/* flash_is_erased() checks records a word at a time */
+BUILD_ASSERT(sizeof(struct persist_state) % sizeof(uint32_t) == 0);
+#endif
+
 #else /* !CONFIG_FLASH_PSTATE_BANK */
 
+#ifdef CONFIG_FLASH_PSTATE_LOG
+#error "CONFIG_FLASH_PSTATE_LOG needs CONFIG_FLASH_PSTATE_BANK"
+#endif
+
 /*
  * Flags for write protect state depend on the erased value of flash.  The
  * locked value must be the same as the unlocked value with one or more bits
@@ -258,14 +267,54 @@ int flash_dataptr(int offset, int size_req, int align, const char **ptrp)
 #ifdef CONFIG_FLASH_PSTATE
 #ifdef CONFIG_FLASH_PSTATE_BANK
 
+#ifdef CONFIG_FLASH_PSTATE_LOG
+/* Number of persist_state records the pstate bank holds */
+#define PSTATE_SLOTS (CONFIG_FW_PSTATE_SIZE / sizeof(struct persist_state))
+
+/**
+ * Return the index of the first erased pstate slot, or PSTATE_SLOTS if the
+ * bank is full.  Records are only ever appended, so the erased slots are
+ * all at the end.
+ */
+static int flash_pstate_free_slot(void)
+{
+	int lo = 0, hi = PSTATE_SLOTS;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (flash_is_erased(CONFIG_FW_PSTATE_OFF +
+				    mid * sizeof(struct persist_state),
+				    sizeof(struct persist_state)))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+#endif
+
+/**
+ * Return the current persistent state record, in mapped flash.
+ */
+static const struct persist_state *flash_get_pstate(void)
+{
+	int slot = 0;
+
+#ifdef CONFIG_FLASH_PSTATE_LOG
+	slot = MAX(flash_pstate_free_slot() - 1, 0);
+#endif
+	return (const struct persist_state *)flash_physical_dataptr(
+		CONFIG_FW_PSTATE_OFF + slot * sizeof(struct persist_state));
+}
+
 /**
  * Read and return persistent state flags (EC_FLASH_PROTECT_*)
  */
 static uint32_t flash_read_pstate(void)
 {
-	const struct persist_state *pstate =
-		(const struct persist_state *)
-		flash_physical_dataptr(CONFIG_FW_PSTATE_OFF);
+	const struct persist_state *pstate = flash_get_pstate();
 
 	if ((pstate->version == PERSIST_STATE_VERSION) &&
 	    (pstate->valid_fields & PSTATE_VALID_FLAGS) &&
@@ -292,6 +341,17 @@ static int flash_write_pstate_data(struct persist_state *newpstate)
 {
 	int rv;
 
+#ifdef CONFIG_FLASH_PSTATE_LOG
+	int slot = flash_pstate_free_slot();
+
+	/* Append the new record, if it fits */
+	if (slot < PSTATE_SLOTS)
+		return flash_physical_write(CONFIG_FW_PSTATE_OFF +
+					    slot * sizeof(*newpstate),
+					    sizeof(*newpstate),
+					    (const char *)newpstate);
+#endif
+
 	/* Erase pstate */
 	rv = flash_physical_erase(CONFIG_FW_PSTATE_OFF,
 				  CONFIG_FW_PSTATE_SIZE);
@@ -336,9 +396,7 @@ static int validate_pstate_struct(struct persist_state *pstate)
 static int flash_write_pstate(uint32_t flags)
 {
 	struct persist_state newpstate;
-	const struct persist_state *pstate =
-		(const struct persist_state *)
-		flash_physical_dataptr(CONFIG_FW_PSTATE_OFF);
+	const struct persist_state *pstate = flash_get_pstate();
 
 	/* Only check the flags we write to pstate */
 	flags &= EC_FLASH_PROTECT_RO_AT_BOOT;
@@ -366,9 +424,7 @@ static int flash_write_pstate(uint32_t flags)
  */
 const char *flash_read_pstate_serial(void)
 {
-	const struct persist_state *pstate =
-		(const struct persist_state *)
-		flash_physical_dataptr(CONFIG_FW_PSTATE_OFF);
+	const struct persist_state *pstate = flash_get_pstate();
 
 	if ((pstate->version == PERSIST_STATE_VERSION) &&
 	    (pstate->valid_fields & PSTATE_VALID_SERIALNO)) {
@@ -388,9 +444,7 @@ int flash_write_pstate_serial(const char *serialno)
 {
 	int length;
 	struct persist_state newpstate;
-	const struct persist_state *pstate =
-		(const struct persist_state *)
-		flash_physical_dataptr(CONFIG_FW_PSTATE_OFF);
+	const struct persist_state *pstate = flash_get_pstate();
 
 	/* Check that this is OK */
 	if (!serialno)
@@ -426,9 +480,7 @@ int flash_write_pstate_serial(const char *serialno)
  */
 const char *flash_read_pstate_mac_addr(void)
 {
-	const struct persist_state *pstate =
-		(const struct persist_state *)
-		flash_physical_dataptr(CONFIG_FW_PSTATE_OFF);
+	const struct persist_state *pstate = flash_get_pstate();
 
 	if ((pstate->version == PERSIST_STATE_VERSION) &&
 	    (pstate->valid_fields & PSTATE_VALID_MAC_ADDR)) {
@@ -448,9 +500,7 @@ int flash_write_pstate_mac_addr(const char *mac_addr)
 {
 	int length;
 	struct persist_state newpstate;
-	const struct persist_state *pstate =
-		(const struct persist_state *)
-		flash_physical_dataptr(CONFIG_FW_PSTATE_OFF);
+	const struct persist_state *pstate = flash_get_pstate();
 
 	/* Check that this is OK, data is valid and fits in the region. */
 	if (!mac_addr) {
@@ -638,8 +688,13 @@ static void flash_abort_or_invalidate_hash(int offset, int size)
 	 * hash. On the next hash check, AP will catch hash mismatch between the
 	 * flash copy and the RAM copy, then take necessary actions.
 	 */
-	if (system_is_in_rw())
+	if (system_is_in_rw()) {
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+		/* A new hash must still read what was just written. */
+		vboot_hash_trim_checkpoints(offset, size);
+#endif
 		return;
+	}
 #endif
 
 	/* If EC executes in place, we need to invalidate the cached hash. */
@@ -1362,9 +1417,9 @@ static enum ec_status flash_command_write(struct host_cmd_handler_args *args)
 
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_FLASH_WRITE,
-		     flash_command_write,
-		     EC_VER_MASK(0) | EC_VER_MASK(EC_VER_FLASH_WRITE));
+DECLARE_HOST_COMMAND_ASYNC(EC_CMD_FLASH_WRITE,
+			   flash_command_write,
+			   EC_VER_MASK(0) | EC_VER_MASK(EC_VER_FLASH_WRITE));
 
 #ifndef CONFIG_FLASH_MULTIPLE_REGION
 /*
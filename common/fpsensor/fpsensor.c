@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "cryptoc/util.h"
+#include "drbg.h"
 #include "ec_commands.h"
 #include "fpsensor.h"
 #include "fpsensor_crypto.h"
@@ -53,6 +54,12 @@ static uint32_t matching_time_us;
 static uint32_t overall_time_us;
 static timestamp_t overall_t0;
 static uint8_t timestamps_invalid;
+/*
+ * Time spent encrypting the last template download and decrypting the last
+ * upload, key derivation included.
+ */
+static uint32_t encrypt_time_us;
+static uint32_t decrypt_time_us;
 
 BUILD_ASSERT(sizeof(struct ec_fp_template_encryption_metadata) % 4 == 0);
 
@@ -128,6 +135,47 @@ static uint32_t fp_process_enroll(void)
 	     | (percent << EC_MKBP_FP_ENROLL_PROGRESS_OFFSET);
 }
 
+/* Matchers without a prefilter keep every template. */
+__overridable int fp_finger_prefilter(void *templ, uint8_t *image)
+{
+	return 1;
+}
+
+/*
+ * Match against the templates by recency, stopping at the first result
+ * other than a non-match. Consecutive indices are matched in one call.
+ */
+static int fp_match_templates(int32_t *fgr, uint32_t *updated)
+{
+	uint8_t order[FP_MAX_FINGER_COUNT];
+	int count = fp_get_template_order(order);
+	int res = EC_MKBP_FP_ERR_MATCH_NO;
+	int i, n, run;
+
+	/* Drop the templates the image cannot match. */
+	for (i = 0, n = 0; i < count; i++)
+		if (fp_finger_prefilter(fp_template[order[i]], fp_buffer))
+			order[n++] = order[i];
+
+	*fgr = FP_NO_SUCH_TEMPLATE;
+	for (i = 0; i < n; i += run) {
+		uint32_t run_updated = 0;
+
+		for (run = 1; i + run < n; run++)
+			if (order[i + run] != order[i] + run)
+				break;
+		res = fp_finger_match(fp_template[order[i]], run, fp_buffer,
+				      fgr, &run_updated);
+		*updated |= run_updated << order[i];
+		if (res != EC_MKBP_FP_ERR_MATCH_NO) {
+			if (res >= 0 && *fgr >= 0)
+				*fgr += order[i];
+			break;
+		}
+	}
+	return res;
+}
+
 static uint32_t fp_process_match(void)
 {
 	timestamp_t t0 = get_time();
@@ -139,8 +187,7 @@ static uint32_t fp_process_match(void)
 	fp_disable_positive_match_secret(&positive_match_secret_state);
 	CPRINTS("Matching/%d ...", templ_valid);
 	if (templ_valid) {
-		res = fp_finger_match(fp_template[0], templ_valid, fp_buffer,
-				      &fgr, &updated);
+		res = fp_match_templates(&fgr, &updated);
 		CPRINTS("Match =>%d (finger %d)", res, fgr);
 		if (res < 0 || fgr < 0 || fgr >= FP_MAX_FINGER_COUNT) {
 			res = EC_MKBP_FP_ERR_MATCH_NO_INTERNAL;
@@ -148,6 +195,7 @@ static uint32_t fp_process_match(void)
 		} else {
 			fp_enable_positive_match_secret(fgr,
 				&positive_match_secret_state);
+			fp_template_matched(fgr);
 		}
 		if (res == EC_MKBP_FP_ERR_MATCH_YES_UPDATED)
 			templ_dirty |= updated;
@@ -163,8 +211,18 @@ static uint32_t fp_process_match(void)
 
 static void fp_process_finger(void)
 {
-	timestamp_t t0 = get_time();
-	int res = fp_sensor_acquire_image_with_mode(fp_buffer,
+	timestamp_t t0;
+	int res;
+
+#ifdef CONFIG_FP_PIPELINED_MATCH
+	/*
+	 * The SPI is idle here, so clock up now rather than between the
+	 * capture and the match.
+	 */
+	clock_request_fast_cpu(MODULE_FINGERPRINT, 1);
+#endif
+	t0 = get_time();
+	res = fp_sensor_acquire_image_with_mode(fp_buffer,
 			FP_CAPTURE_TYPE(sensor_mode));
 	capture_time_us = time_since32(t0);
 	if (!res) {
@@ -178,7 +236,7 @@ static void fp_process_finger(void)
 		if (res)
 			CPRINTS("Failed to flush SPI: 0x%x", res);
 		/* we need CPU power to do the computations */
-		clock_enable_module(MODULE_FAST_CPU, 1);
+		clock_request_fast_cpu(MODULE_FINGERPRINT, 1);
 
 		if (sensor_mode & FP_MODE_ENROLL_IMAGE)
 			evt = fp_process_enroll();
@@ -190,9 +248,12 @@ static void fp_process_finger(void)
 		send_mkbp_event(evt);
 
 		/* go back to lower power mode */
-		clock_enable_module(MODULE_FAST_CPU, 0);
+		clock_request_fast_cpu(MODULE_FINGERPRINT, 0);
 	} else {
 		timestamps_invalid |= FPSTATS_CAPTURE_INV;
+#ifdef CONFIG_FP_PIPELINED_MATCH
+		clock_request_fast_cpu(MODULE_FINGERPRINT, 0);
+#endif
 	}
 }
 #endif /* HAVE_FP_PRIVATE_DRIVER */
@@ -439,11 +500,9 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 		 */
 		enc_info = (void *)fp_enc_buffer;
 		enc_info->struct_version = FP_TEMPLATE_FORMAT_VERSION;
-		init_trng();
-		rand_bytes(enc_info->nonce, FP_CONTEXT_NONCE_BYTES);
-		rand_bytes(enc_info->encryption_salt,
-			   FP_CONTEXT_ENCRYPTION_SALT_BYTES);
-		exit_trng();
+		drbg_rand_bytes(enc_info->nonce, FP_CONTEXT_NONCE_BYTES);
+		drbg_rand_bytes(enc_info->encryption_salt,
+				FP_CONTEXT_ENCRYPTION_SALT_BYTES);
 
 		if (fgr == template_newly_enrolled) {
 			/*
@@ -452,10 +511,8 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 			 * value.
 			 */
 			template_newly_enrolled = FP_NO_SUCH_TEMPLATE;
-			init_trng();
-			rand_bytes(fp_positive_match_salt[fgr],
-				   FP_POSITIVE_MATCH_SALT_BYTES);
-			exit_trng();
+			drbg_rand_bytes(fp_positive_match_salt[fgr],
+					FP_POSITIVE_MATCH_SALT_BYTES);
 		}
 
 		ret = derive_encryption_key(key, enc_info->encryption_salt);
@@ -480,6 +537,7 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 				      enc_info->nonce, FP_CONTEXT_NONCE_BYTES,
 				      enc_info->tag, FP_CONTEXT_TAG_BYTES);
 		always_memset(key, 0, sizeof(key));
+		encrypt_time_us = time_since32(now);
 		if (ret != EC_SUCCESS) {
 			CPRINTS("fgr%d: Failed to encrypt template", fgr);
 			return EC_RES_UNAVAILABLE;
@@ -535,6 +593,154 @@ static int validate_template_format(
 	return EC_RES_SUCCESS;
 }
 
+static size_t encrypted_blob_size(
+	const struct ec_fp_template_encryption_metadata *enc_info)
+{
+	if (enc_info->struct_version <= 3)
+		return sizeof(fp_template[0]);
+	return sizeof(fp_template[0]) + sizeof(fp_positive_match_salt[0]);
+}
+
+/*
+ * Decryption of the template being uploaded.
+ *
+ * Chunks received in order are decrypted in place as they arrive, so that
+ * the commit only has to decrypt what is left and check the tag. Chunks
+ * received out of order are decrypted at commit.
+ */
+static struct {
+	struct aes_gcm_stream gcm;
+	/* Bytes of |fp_enc_buffer| received in order from offset 0 */
+	uint32_t received;
+	/* Bytes of the encrypted blob already decrypted */
+	uint32_t decrypted;
+	uint32_t blob_size;
+	bool started;
+	/*
+	 * Streaming stopped, e.g. a chunk overwrote the metadata or decrypted
+	 * data. The commit decrypts everything, unless some data was already
+	 * decrypted.
+	 */
+	bool broken;
+} template_stream;
+
+static void template_stream_reset(void)
+{
+	always_memset(&template_stream, 0, sizeof(template_stream));
+}
+
+static int template_stream_decrypt(uint32_t end)
+{
+	uint8_t *encrypted_template = fp_enc_buffer +
+		sizeof(struct ec_fp_template_encryption_metadata);
+	uint32_t start = template_stream.decrypted;
+	int ret;
+
+	if (end <= start)
+		return EC_SUCCESS;
+	ret = aes_gcm_stream_decrypt(&template_stream.gcm,
+				     encrypted_template + start,
+				     encrypted_template + start, end - start);
+	if (ret != EC_SUCCESS) {
+		aes_gcm_stream_clear(&template_stream.gcm);
+		template_stream.broken = true;
+		return ret;
+	}
+	template_stream.decrypted = end;
+	return EC_SUCCESS;
+}
+
+static void template_stream_update(uint32_t offset, uint32_t size)
+{
+	struct ec_fp_template_encryption_metadata *enc_info =
+		(void *)fp_enc_buffer;
+	uint8_t key[SBP_ENC_KEY_LEN];
+	int ret;
+
+	if (offset == 0)
+		template_stream_reset();
+	if (template_stream.broken)
+		return;
+	if (template_stream.started &&
+	    offset < sizeof(*enc_info) + template_stream.decrypted) {
+		template_stream.broken = true;
+		return;
+	}
+	if (offset != template_stream.received)
+		return;
+	template_stream.received += size;
+
+	if (!template_stream.started) {
+		if (template_stream.received < sizeof(*enc_info))
+			return;
+		/* Leave the errors to be reported at commit. */
+		if (validate_template_format(enc_info) != EC_RES_SUCCESS) {
+			template_stream.broken = true;
+			return;
+		}
+		ret = derive_encryption_key(key, enc_info->encryption_salt);
+		if (ret == EC_SUCCESS)
+			ret = aes_gcm_stream_init(&template_stream.gcm, key,
+						  SBP_ENC_KEY_LEN,
+						  enc_info->nonce,
+						  FP_CONTEXT_NONCE_BYTES);
+		always_memset(key, 0, sizeof(key));
+		if (ret != EC_SUCCESS) {
+			aes_gcm_stream_clear(&template_stream.gcm);
+			template_stream.broken = true;
+			return;
+		}
+		template_stream.blob_size = encrypted_blob_size(enc_info);
+		template_stream.started = true;
+	}
+
+	template_stream_decrypt(MIN(template_stream.received -
+					    sizeof(*enc_info),
+				    template_stream.blob_size));
+}
+
+/* Check the tag of the uploaded blob, decrypting what is left of it. */
+static int template_stream_finish(
+	struct ec_fp_template_encryption_metadata *enc_info, uint32_t idx)
+{
+	uint8_t *encrypted_template = fp_enc_buffer + sizeof(*enc_info);
+	uint8_t key[SBP_ENC_KEY_LEN];
+	int ret;
+
+	if (template_stream.started && !template_stream.broken) {
+		ret = template_stream_decrypt(template_stream.blob_size);
+		if (ret == EC_SUCCESS)
+			ret = aes_gcm_stream_finish(&template_stream.gcm,
+						    enc_info->tag,
+						    FP_CONTEXT_TAG_BYTES);
+		template_stream_reset();
+		return ret == EC_SUCCESS ? EC_RES_SUCCESS : EC_RES_UNAVAILABLE;
+	}
+
+	if (template_stream.decrypted) {
+		/* Part of the buffer was overwritten after its decryption. */
+		CPRINTS("fgr%d: Template chunks out of order", idx);
+		template_stream_reset();
+		return EC_RES_INVALID_PARAM;
+	}
+	template_stream_reset();
+
+	ret = derive_encryption_key(key, enc_info->encryption_salt);
+	if (ret != EC_SUCCESS) {
+		CPRINTS("fgr%d: Failed to derive key", idx);
+		return EC_RES_UNAVAILABLE;
+	}
+
+	/* Decrypt the secret blob in-place. */
+	ret = aes_gcm_decrypt(key, SBP_ENC_KEY_LEN, encrypted_template,
+			      encrypted_template,
+			      encrypted_blob_size(enc_info),
+			      enc_info->nonce, FP_CONTEXT_NONCE_BYTES,
+			      enc_info->tag, FP_CONTEXT_TAG_BYTES);
+	always_memset(key, 0, sizeof(key));
+	return ret == EC_SUCCESS ? EC_RES_SUCCESS : EC_RES_UNAVAILABLE;
+}
+
 static enum ec_status fp_command_template(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_fp_template *params = args->params;
@@ -542,8 +748,8 @@ static enum ec_status fp_command_template(struct host_cmd_handler_args *args)
 	int xfer_complete = params->size & FP_TEMPLATE_COMMIT;
 	uint32_t offset = params->offset;
 	uint32_t idx = templ_valid;
-	uint8_t key[SBP_ENC_KEY_LEN];
 	struct ec_fp_template_encryption_metadata *enc_info;
+	timestamp_t t0;
 	int ret;
 
 	/* Can we store one more template ? */
@@ -558,6 +764,11 @@ static enum ec_status fp_command_template(struct host_cmd_handler_args *args)
 		return EC_RES_INVALID_PARAM;
 
 	memcpy(&fp_enc_buffer[offset], params->data, size);
+	t0 = get_time();
+	if (!offset)
+		decrypt_time_us = 0;
+	template_stream_update(offset, size);
+	decrypt_time_us += time_since32(t0);
 
 	if (xfer_complete) {
 		/* Encrypted template is after the metadata. */
@@ -565,10 +776,9 @@ static enum ec_status fp_command_template(struct host_cmd_handler_args *args)
 		/* Positive match salt is after the template. */
 		uint8_t *positive_match_salt =
 			encrypted_template + sizeof(fp_template[0]);
-		size_t encrypted_blob_size;
 
 		/*
-		 * The complete encrypted template has been received, start
+		 * The complete encrypted template has been received, finish
 		 * decryption.
 		 */
 		fp_clear_finger_context(idx);
@@ -580,44 +790,27 @@ static enum ec_status fp_command_template(struct host_cmd_handler_args *args)
 		ret = validate_template_format(enc_info);
 		if (ret != EC_RES_SUCCESS) {
 			CPRINTS("fgr%d: Template format not supported", idx);
+			template_stream_reset();
 			return EC_RES_INVALID_PARAM;
 		}
 
-		if (enc_info->struct_version <= 3) {
-			encrypted_blob_size = sizeof(fp_template[0]);
-		} else {
-			encrypted_blob_size =
-				sizeof(fp_template[0]) +
-				sizeof(fp_positive_match_salt[0]);
-		}
-
-		ret = derive_encryption_key(key, enc_info->encryption_salt);
-		if (ret != EC_SUCCESS) {
-			CPRINTS("fgr%d: Failed to derive key", idx);
-			return EC_RES_UNAVAILABLE;
-		}
-
-		/* Decrypt the secret blob in-place. */
-		ret = aes_gcm_decrypt(key, SBP_ENC_KEY_LEN, encrypted_template,
-				      encrypted_template,
-				      encrypted_blob_size,
-				      enc_info->nonce, FP_CONTEXT_NONCE_BYTES,
-				      enc_info->tag, FP_CONTEXT_TAG_BYTES);
-		always_memset(key, 0, sizeof(key));
-		if (ret != EC_SUCCESS) {
+		t0 = get_time();
+		ret = template_stream_finish(enc_info, idx);
+		decrypt_time_us += time_since32(t0);
+		if (ret != EC_RES_SUCCESS) {
 			CPRINTS("fgr%d: Failed to decipher template", idx);
 			/* Don't leave bad data in the template buffer */
 			fp_clear_finger_context(idx);
-			return EC_RES_UNAVAILABLE;
+			always_memset(encrypted_template, 0,
+				      encrypted_blob_size(enc_info));
+			return ret;
 		}
 		memcpy(fp_template[idx], encrypted_template,
 		       sizeof(fp_template[0]));
 		if (template_needs_validation_value(enc_info)) {
 			CPRINTS("fgr%d: Generating positive match salt.", idx);
-			init_trng();
-			rand_bytes(positive_match_salt,
-				   FP_POSITIVE_MATCH_SALT_BYTES);
-			exit_trng();
+			drbg_rand_bytes(positive_match_salt,
+					FP_POSITIVE_MATCH_SALT_BYTES);
 		}
 		if (bytes_are_trivial(positive_match_salt,
 				      sizeof(fp_positive_match_salt[0]))) {
@@ -634,7 +827,8 @@ static enum ec_status fp_command_template(struct host_cmd_handler_args *args)
 
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_FP_TEMPLATE, fp_command_template, EC_VER_MASK(0));
+DECLARE_HOST_COMMAND_ASYNC(EC_CMD_FP_TEMPLATE, fp_command_template,
+			   EC_VER_MASK(0));
 
 #ifdef CONFIG_CMD_FPSENSOR_DEBUG
 /* --- Debug console commands --- */
@@ -850,4 +1044,18 @@ int command_fpmaintenance(int argc, char **argv)
 DECLARE_CONSOLE_COMMAND(fpmaintenance, command_fpmaintenance, NULL,
 			"Run fingerprint sensor maintenance");
 
+int command_fpstats(int argc, char **argv)
+{
+	ccprintf("capture  %8d us%s\n", capture_time_us,
+		 timestamps_invalid & FPSTATS_CAPTURE_INV ? " (invalid)" : "");
+	ccprintf("matching %8d us%s\n", matching_time_us,
+		 timestamps_invalid & FPSTATS_MATCHING_INV ? " (invalid)" : "");
+	ccprintf("overall  %8d us\n", overall_time_us);
+	ccprintf("decrypt  %8d us\n", decrypt_time_us);
+	ccprintf("encrypt  %8d us\n", encrypt_time_us);
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(fpstats, command_fpstats, NULL,
+			"Print fingerprint timing statistics");
+
 #endif /* CONFIG_CMD_FPSENSOR_DEBUG */
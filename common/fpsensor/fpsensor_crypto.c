@@ -17,6 +17,70 @@
 #error "fpsensor requires AES, AES_GCM and ROLLBACK_SECRET_SIZE"
 #endif
 
+/*
+ * Secrets derived during the current session, so that loading a template or
+ * reading the positive match secret again does not repeat the HKDF. The
+ * entries are bound to |user_id| and cleared with the context.
+ */
+enum key_cache_kind {
+	KEY_CACHE_FREE = 0,
+	KEY_CACHE_ENCRYPTION_KEY,
+	KEY_CACHE_POSITIVE_MATCH_SECRET,
+};
+
+#define KEY_CACHE_ENTRIES (FP_MAX_FINGER_COUNT + 1)
+
+static struct {
+	uint8_t kind;
+	uint8_t salt[FP_CONTEXT_ENCRYPTION_SALT_BYTES];
+	uint8_t secret[FP_POSITIVE_MATCH_SECRET_BYTES];
+} key_cache[KEY_CACHE_ENTRIES];
+static uint32_t key_cache_user_id[FP_CONTEXT_USERID_WORDS];
+static int key_cache_next;
+
+BUILD_ASSERT(FP_POSITIVE_MATCH_SALT_BYTES == FP_CONTEXT_ENCRYPTION_SALT_BYTES);
+BUILD_ASSERT(SBP_ENC_KEY_LEN <= FP_POSITIVE_MATCH_SECRET_BYTES);
+
+void fp_clear_key_cache(void)
+{
+	always_memset(key_cache, 0, sizeof(key_cache));
+	always_memset(key_cache_user_id, 0, sizeof(key_cache_user_id));
+	key_cache_next = 0;
+}
+
+static bool key_cache_lookup(enum key_cache_kind kind, const uint8_t *salt,
+			     uint8_t *out, size_t size)
+{
+	int i;
+
+	if (safe_memcmp(key_cache_user_id, user_id, sizeof(user_id))) {
+		fp_clear_key_cache();
+		memcpy(key_cache_user_id, user_id, sizeof(user_id));
+		return false;
+	}
+
+	for (i = 0; i < KEY_CACHE_ENTRIES; i++) {
+		if (key_cache[i].kind == kind &&
+		    !safe_memcmp(key_cache[i].salt, salt,
+				 sizeof(key_cache[i].salt))) {
+			memcpy(out, key_cache[i].secret, size);
+			return true;
+		}
+	}
+	return false;
+}
+
+static void key_cache_store(enum key_cache_kind kind, const uint8_t *salt,
+			    const uint8_t *secret, size_t size)
+{
+	int i = key_cache_next;
+
+	key_cache_next = (key_cache_next + 1) % KEY_CACHE_ENTRIES;
+	key_cache[i].kind = kind;
+	memcpy(key_cache[i].salt, salt, sizeof(key_cache[i].salt));
+	memcpy(key_cache[i].secret, secret, size);
+}
+
 static int get_ikm(uint8_t *ikm)
 {
 	int ret;
@@ -155,6 +219,11 @@ int derive_positive_match_secret(uint8_t *output,
 		return EC_ERROR_INVAL;
 	}
 
+	if (key_cache_lookup(KEY_CACHE_POSITIVE_MATCH_SECRET,
+			     input_positive_match_salt, output,
+			     FP_POSITIVE_MATCH_SECRET_BYTES))
+		return EC_SUCCESS;
+
 	ret = get_ikm(ikm);
 	if (ret != EC_SUCCESS) {
 		CPRINTS("Failed to get IKM: %d", ret);
@@ -180,6 +249,10 @@ int derive_positive_match_secret(uint8_t *output,
 			"derived secret bytes are trivial.");
 		ret = EC_ERROR_HW_INTERNAL;
 	}
+	if (ret == EC_SUCCESS)
+		key_cache_store(KEY_CACHE_POSITIVE_MATCH_SECRET,
+				input_positive_match_salt, output,
+				FP_POSITIVE_MATCH_SECRET_BYTES);
 	return ret;
 }
 
@@ -193,6 +266,10 @@ int derive_encryption_key(uint8_t *out_key, const uint8_t *salt)
 	BUILD_ASSERT(SBP_ENC_KEY_LEN <= CONFIG_ROLLBACK_SECRET_SIZE);
 	BUILD_ASSERT(sizeof(user_id) == SHA256_DIGEST_SIZE);
 
+	if (key_cache_lookup(KEY_CACHE_ENCRYPTION_KEY, salt, out_key,
+			     SBP_ENC_KEY_LEN))
+		return EC_SUCCESS;
+
 	ret = get_ikm(ikm);
 	if (ret != EC_SUCCESS) {
 		CPRINTS("Failed to get IKM: %d", ret);
@@ -212,75 +289,121 @@ int derive_encryption_key(uint8_t *out_key, const uint8_t *salt)
 	ret = hkdf_expand_one_step(out_key, SBP_ENC_KEY_LEN, prk, sizeof(prk),
 				   (uint8_t *)user_id, sizeof(user_id));
 	always_memset(prk, 0, sizeof(prk));
+	if (ret == EC_SUCCESS)
+		key_cache_store(KEY_CACHE_ENCRYPTION_KEY, salt, out_key,
+				SBP_ENC_KEY_LEN);
 
 	return ret;
 }
 
-int aes_gcm_encrypt(const uint8_t *key, int key_size,
-		    const uint8_t *plaintext,
-		    uint8_t *ciphertext, int text_size,
-		    const uint8_t *nonce, int nonce_size,
-		    uint8_t *tag, int tag_size)
+int aes_gcm_stream_init(struct aes_gcm_stream *stream,
+			const uint8_t *key, int key_size,
+			const uint8_t *nonce, int nonce_size)
 {
 	int res;
-	AES_KEY aes_key;
-	GCM128_CONTEXT ctx;
 
 	if (nonce_size != FP_CONTEXT_NONCE_BYTES) {
 		CPRINTS("Invalid nonce size %d bytes", nonce_size);
 		return EC_ERROR_INVAL;
 	}
 
-	res = AES_set_encrypt_key(key, 8 * key_size, &aes_key);
+	res = AES_set_encrypt_key(key, 8 * key_size, &stream->aes_key);
 	if (res) {
 		CPRINTS("Failed to set encryption key: %d", res);
 		return EC_ERROR_UNKNOWN;
 	}
-	CRYPTO_gcm128_init(&ctx, &aes_key, (block128_f)AES_encrypt, 0);
-	CRYPTO_gcm128_setiv(&ctx, &aes_key, nonce, nonce_size);
+	CRYPTO_gcm128_init(&stream->ctx, &stream->aes_key,
+			   (block128_f)AES_encrypt, 0);
+	CRYPTO_gcm128_setiv(&stream->ctx, &stream->aes_key, nonce, nonce_size);
+	return EC_SUCCESS;
+}
+
+int aes_gcm_stream_encrypt(struct aes_gcm_stream *stream,
+			   const uint8_t *plaintext, uint8_t *ciphertext,
+			   int text_size)
+{
 	/* CRYPTO functions return 1 on success, 0 on error. */
-	res = CRYPTO_gcm128_encrypt(&ctx, &aes_key, plaintext, ciphertext,
-				    text_size);
-	if (!res) {
-		CPRINTS("Failed to encrypt: %d", res);
+	if (!CRYPTO_gcm128_encrypt(&stream->ctx, &stream->aes_key, plaintext,
+				   ciphertext, text_size)) {
+		CPRINTS("Failed to encrypt");
 		return EC_ERROR_UNKNOWN;
 	}
-	CRYPTO_gcm128_tag(&ctx, tag, tag_size);
 	return EC_SUCCESS;
 }
 
-int aes_gcm_decrypt(const uint8_t *key, int key_size, uint8_t *plaintext,
-		    const uint8_t *ciphertext, int text_size,
-		    const uint8_t *nonce, int nonce_size,
-		    const uint8_t *tag, int tag_size)
+int aes_gcm_stream_decrypt(struct aes_gcm_stream *stream,
+			   const uint8_t *ciphertext, uint8_t *plaintext,
+			   int text_size)
 {
-	int res;
-	AES_KEY aes_key;
-	GCM128_CONTEXT ctx;
-
-	if (nonce_size != FP_CONTEXT_NONCE_BYTES) {
-		CPRINTS("Invalid nonce size %d bytes", nonce_size);
-		return EC_ERROR_INVAL;
-	}
-
-	res = AES_set_encrypt_key(key, 8 * key_size, &aes_key);
-	if (res) {
-		CPRINTS("Failed to set decryption key: %d", res);
+	if (!CRYPTO_gcm128_decrypt(&stream->ctx, &stream->aes_key, ciphertext,
+				   plaintext, text_size)) {
+		CPRINTS("Failed to decrypt");
 		return EC_ERROR_UNKNOWN;
 	}
-	CRYPTO_gcm128_init(&ctx, &aes_key, (block128_f)AES_encrypt, 0);
-	CRYPTO_gcm128_setiv(&ctx, &aes_key, nonce, nonce_size);
-	/* CRYPTO functions return 1 on success, 0 on error. */
-	res = CRYPTO_gcm128_decrypt(&ctx, &aes_key, ciphertext, plaintext,
-				    text_size);
+	return EC_SUCCESS;
+}
+
+void aes_gcm_stream_tag(struct aes_gcm_stream *stream, uint8_t *tag,
+			int tag_size)
+{
+	CRYPTO_gcm128_tag(&stream->ctx, tag, tag_size);
+	aes_gcm_stream_clear(stream);
+}
+
+int aes_gcm_stream_finish(struct aes_gcm_stream *stream, const uint8_t *tag,
+			  int tag_size)
+{
+	int res = CRYPTO_gcm128_finish(&stream->ctx, tag, tag_size);
+
+	aes_gcm_stream_clear(stream);
 	if (!res) {
-		CPRINTS("Failed to decrypt: %d", res);
+		CPRINTS("Found incorrect tag");
 		return EC_ERROR_UNKNOWN;
 	}
-	res = CRYPTO_gcm128_finish(&ctx, tag, tag_size);
-	if (!res) {
-		CPRINTS("Found incorrect tag: %d", res);
-		return EC_ERROR_UNKNOWN;
+	return EC_SUCCESS;
+}
+
+void aes_gcm_stream_clear(struct aes_gcm_stream *stream)
+{
+	always_memset(stream, 0, sizeof(*stream));
+}
+
+int aes_gcm_encrypt(const uint8_t *key, int key_size,
+		    const uint8_t *plaintext,
+		    uint8_t *ciphertext, int text_size,
+		    const uint8_t *nonce, int nonce_size,
+		    uint8_t *tag, int tag_size)
+{
+	int ret;
+	struct aes_gcm_stream stream;
+
+	ret = aes_gcm_stream_init(&stream, key, key_size, nonce, nonce_size);
+	if (ret == EC_SUCCESS)
+		ret = aes_gcm_stream_encrypt(&stream, plaintext, ciphertext,
+					     text_size);
+	if (ret != EC_SUCCESS) {
+		aes_gcm_stream_clear(&stream);
+		return ret;
 	}
+	aes_gcm_stream_tag(&stream, tag, tag_size);
 	return EC_SUCCESS;
 }
+
+int aes_gcm_decrypt(const uint8_t *key, int key_size, uint8_t *plaintext,
+		    const uint8_t *ciphertext, int text_size,
+		    const uint8_t *nonce, int nonce_size,
+		    const uint8_t *tag, int tag_size)
+{
+	int ret;
+	struct aes_gcm_stream stream;
+
+	ret = aes_gcm_stream_init(&stream, key, key_size, nonce, nonce_size);
+	if (ret == EC_SUCCESS)
+		ret = aes_gcm_stream_decrypt(&stream, ciphertext, plaintext,
+					     text_size);
+	if (ret != EC_SUCCESS) {
+		aes_gcm_stream_clear(&stream);
+		return ret;
+	}
+	return aes_gcm_stream_finish(&stream, tag, tag_size);
+}
@@ -63,9 +63,33 @@ void fp_task_simulate(void)
 		task_wait_event(timeout_us);
 }
 
+/* Sequence number of the last match of each template, 0 if none */
+static uint32_t template_last_match[FP_MAX_FINGER_COUNT];
+static uint32_t template_match_count;
+
+void fp_template_matched(int idx)
+{
+	template_last_match[idx] = ++template_match_count;
+}
+
+int fp_get_template_order(uint8_t *order)
+{
+	int i, j;
+
+	/* Insertion sort by decreasing recency, keeping ties in order. */
+	for (i = 0; i < templ_valid; i++) {
+		for (j = i; j > 0 && template_last_match[order[j - 1]] <
+					     template_last_match[i]; j--)
+			order[j] = order[j - 1];
+		order[j] = i;
+	}
+	return templ_valid;
+}
+
 void fp_clear_finger_context(int idx)
 {
 	always_memset(fp_template[idx], 0, sizeof(fp_template[0]));
+	template_last_match[idx] = 0;
 	always_memset(fp_positive_match_salt[idx], 0,
 		      sizeof(fp_positive_match_salt[0]));
 }
@@ -85,6 +109,7 @@ static void _fp_clear_context(void)
 	always_memset(fp_enc_buffer, 0, sizeof(fp_enc_buffer));
 	always_memset(user_id, 0, sizeof(user_id));
 	fp_disable_positive_match_secret(&positive_match_secret_state);
+	fp_clear_key_cache();
 	for (idx = 0; idx < FP_MAX_FINGER_COUNT; idx++)
 		fp_clear_finger_context(idx);
 }
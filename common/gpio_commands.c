@@ -220,6 +220,34 @@ DECLARE_CONSOLE_COMMAND_FLAGS(gpioset, command_gpio_set,
 			      CMD_FLAG_RESTRICTED
 );
 
+#ifdef CONFIG_GPIO_IRQ_COUNTERS
+static int command_gpio_ints(int argc, char **argv)
+{
+	int i;
+
+	if (argc == 2) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		for (i = 0; i < GPIO_IH_COUNT; i++)
+			gpio_irq_counts[i] = 0;
+		return EC_SUCCESS;
+	}
+
+	/* Only the GPIOs which interrupted, storms stand out this way. */
+	for (i = 0; i < GPIO_IH_COUNT; i++) {
+		if (!gpio_irq_counts[i])
+			continue;
+		ccprintf("%10u %s\n", gpio_irq_counts[i], gpio_get_name(i));
+		cflush();
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(gpioints, command_gpio_ints,
+			     "[clear]",
+			     "Print or clear GPIO interrupt counts");
+#endif
+
 /*****************************************************************************/
 /* Host commands */
 
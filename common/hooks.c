@@ -6,10 +6,14 @@
 /* System hooks for Chrome EC */
 
 #include "atomic.h"
+#include "boot_trace.h"
 #include "console.h"
 #include "hooks.h"
+#include "host_command.h"
 #include "link_defs.h"
+#include "task.h"
 #include "timer.h"
+#include "tracepoint.h"
 #include "util.h"
 
 #ifdef CONFIG_HOOK_DEBUG
@@ -62,12 +66,24 @@ static const struct hook_ptrs hook_list[] = {
 	{__hooks_second, __hooks_second_end},
 	{__hooks_usb_pd_disconnect, __hooks_usb_pd_disconnect_end},
 	{__hooks_usb_pd_connect, __hooks_usb_pd_connect_end},
+	{__hooks_init_late, __hooks_init_late_end},
+	{__hooks_chipset_suspend_s0ix, __hooks_chipset_suspend_s0ix_end},
+	{__hooks_chipset_resume_s0ix, __hooks_chipset_resume_s0ix_end},
 };
 
 /* Times for deferrable functions */
 static int defer_new_call;
 static int hook_task_started;
 
+/*
+ * Pending deferred functions, as a list sorted by __deferred_until[] and linked
+ * through __deferred_link[].  Like the links, these are 1 + the index of the
+ * first and last functions, or 0 if nothing is pending.  Only modified with
+ * interrupts disabled, since hook_call_deferred() may be called from anywhere.
+ */
+static uint16_t deferred_head;
+static uint16_t deferred_tail;
+
 #ifdef CONFIG_HOOK_DEBUG
 /* Stats for hooks */
 static uint64_t max_hook_tick_delay;
@@ -102,6 +118,103 @@ static void record_hook_delay(uint64_t now, uint64_t last, uint64_t interval,
 }
 #endif
 
+static void deferred_unlink(int i)
+{
+	struct deferred_link *link = __deferred_link + i;
+
+	if (link->prev)
+		__deferred_link[link->prev - 1].next = link->next;
+	else
+		deferred_head = link->next;
+
+	if (link->next)
+		__deferred_link[link->next - 1].prev = link->prev;
+	else
+		deferred_tail = link->prev;
+
+	link->next = link->prev = 0;
+}
+
+/*
+ * Insert deferred function i in deadline order.  Search from the tail, since
+ * new deadlines are usually later than those already pending.
+ */
+static void deferred_insert(int i)
+{
+	struct deferred_link *link = __deferred_link + i;
+	uint16_t prev = deferred_tail;
+
+	while (prev && __deferred_until[prev - 1] > __deferred_until[i])
+		prev = __deferred_link[prev - 1].prev;
+
+	link->prev = prev;
+	if (prev) {
+		link->next = __deferred_link[prev - 1].next;
+		__deferred_link[prev - 1].next = i + 1;
+	} else {
+		link->next = deferred_head;
+		deferred_head = i + 1;
+	}
+
+	if (link->next)
+		__deferred_link[link->next - 1].prev = i + 1;
+	else
+		deferred_tail = i + 1;
+}
+
+#ifdef CONFIG_HOOK_DEBUG
+BUILD_ASSERT(DEFERRED_HIST_BUCKETS == EC_DEFERRED_HIST_BUCKETS);
+
+static void record_deferred_latency(int i, uint64_t latency)
+{
+	uint64_t limit = DEFERRED_HIST_BASE_US;
+	int bucket = 0;
+
+	while (bucket < DEFERRED_HIST_BUCKETS - 1 && latency >= limit) {
+		limit *= 4;
+		bucket++;
+	}
+
+	/* Saturate rather than wrap */
+	if (__deferred_hist[i][bucket] != UINT16_MAX)
+		__deferred_hist[i][bucket]++;
+}
+
+/* Run time of each chipset suspend/resume hook routine */
+#define HOOK_PROFILE_ROUTINES 32
+static struct {
+	const struct hook_data *hook;
+	uint32_t last_us;
+	uint32_t max_us;
+} hook_profile[HOOK_PROFILE_ROUTINES];
+
+static int hook_is_profiled(enum hook_type type)
+{
+	return type == HOOK_CHIPSET_RESUME || type == HOOK_CHIPSET_SUSPEND ||
+	       type == HOOK_CHIPSET_RESUME_S0IX ||
+	       type == HOOK_CHIPSET_SUSPEND_S0IX;
+}
+
+static void hook_profile_call(const struct hook_data *p)
+{
+	uint32_t t0 = get_time().le.lo;
+	uint32_t run_time;
+	int i;
+
+	p->routine();
+	run_time = get_time().le.lo - t0;
+
+	for (i = 0; i < ARRAY_SIZE(hook_profile); i++) {
+		if (hook_profile[i].hook && hook_profile[i].hook != p)
+			continue;
+		hook_profile[i].hook = p;
+		hook_profile[i].last_us = run_time;
+		hook_profile[i].max_us = MAX(hook_profile[i].max_us, run_time);
+		return;
+	}
+}
+#endif
+
 void hook_notify(enum hook_type type)
 {
 	const struct hook_data *start, *end, *p;
@@ -131,7 +244,14 @@ void hook_notify(enum hook_type type)
 		for (p = start; p < end; p++) {
 			if (p->priority == prio) {
 				called++;
-				p->routine();
+				if (type == HOOK_INIT)
+					boot_trace_call_hook(p->routine);
+#ifdef CONFIG_HOOK_DEBUG
+				else if (hook_is_profiled(type))
+					hook_profile_call(p);
+#endif
+				else
+					p->routine();
 			}
 		}
 	}
@@ -153,10 +273,21 @@ int hook_call_deferred(const struct deferred_data *data, int us)
 
 	if (us == -1) {
 		/* Cancel */
+		interrupt_disable();
+		if (__deferred_until[i])
+			deferred_unlink(i);
 		__deferred_until[i] = 0;
+		interrupt_enable();
 	} else {
+		uint64_t deadline = get_time().val + us;
+
 		/* Set alarm */
-		__deferred_until[i] = get_time().val + us;
+		interrupt_disable();
+		if (__deferred_until[i])
+			deferred_unlink(i);
+		__deferred_until[i] = deadline;
+		deferred_insert(i);
+		interrupt_enable();
 		/*
 		 * Flag that hook_call_deferred() has been called.  If the hook
 		 * task is already active, this will allow it to go through the
@@ -182,27 +313,43 @@ void hook_task(void *u)
 
 	/* Call HOOK_INIT hooks. */
 	hook_notify(HOOK_INIT);
+	boot_trace(EC_BOOT_TRACE_HOOK_INIT_DONE, 0);
 
 	/* Now, enable the rest of the tasks. */
 	task_enable_all_tasks();
 
+	/* Finish the initializations the other tasks don't wait for. */
+	hook_notify(HOOK_INIT_LATE);
+
 	while (1) {
 		uint64_t t = get_time().val;
 		int next = 0;
 		int i;
 
-		/* Handle deferred routines */
-		for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
-			if (__deferred_until[i] && __deferred_until[i] < t) {
-				CPRINTS("hook call deferred 0x%pP",
-					__deferred_funcs[i].routine);
-				/*
-				 * Call deferred function.  Clear timer first,
-				 * so it can request itself be called later.
-				 */
-				__deferred_until[i] = 0;
-				__deferred_funcs[i].routine();
-			}
+		/* Handle deferred routines, in deadline order */
+		while (deferred_head && __deferred_until[deferred_head - 1] < t) {
+			uint64_t deadline __maybe_unused;
+
+			/*
+			 * Call deferred function.  Clear timer first,
+			 * so it can request itself be called later.
+			 */
+			interrupt_disable();
+			i = deferred_head - 1;
+			deadline = __deferred_until[i];
+			deferred_unlink(i);
+			__deferred_until[i] = 0;
+			interrupt_enable();
+
+			CPRINTS("hook call deferred 0x%pP",
+				__deferred_funcs[i].routine);
+#ifdef CONFIG_HOOK_DEBUG
+			record_deferred_latency(i, get_time().val - deadline);
+#endif
+			TRACEPOINT(EC_TRACEPOINT_HOOK_DEFERRED,
+				   (uint32_t)(uintptr_t)
+					__deferred_funcs[i].routine, 0);
+			__deferred_funcs[i].routine();
 		}
 
 		if (t - last_tick >= HOOK_TICK_INTERVAL) {
@@ -233,15 +380,16 @@ void hook_task(void *u)
 		/* Wake earlier if needed by a deferred routine */
 		defer_new_call = 0;
 
-		for (i = 0; i < DEFERRED_FUNCS_COUNT && next > 0; i++) {
-			if (!__deferred_until[i])
-				continue;
+		interrupt_disable();
+		if (deferred_head && next > 0) {
+			uint64_t deadline = __deferred_until[deferred_head - 1];
 
-			if (__deferred_until[i] < t)
+			if (deadline < t)
 				next = 0;
-			else if (__deferred_until[i] - t < next)
-				next = __deferred_until[i] - t;
+			else if (deadline - t < next)
+				next = deadline - t;
 		}
+		interrupt_enable();
 
 		/*
 		 * If nothing is immediately pending, and hook_call_deferred()
@@ -284,9 +432,55 @@ static int command_stats(int argc, char **argv)
 			 (uint32_t)max_hook_run_time[i],
 			 (uint32_t)avg_hook_run_time[i]);
 
+	ccprintf("Chipset suspend/resume hooks, last and max run time:\n");
+	for (i = 0; i < ARRAY_SIZE(hook_profile) && hook_profile[i].hook; ++i) {
+		const struct hook_data *p = hook_profile[i].hook;
+		int type = 0;
+
+		while (p < hook_list[type].start || p >= hook_list[type].end)
+			type++;
+		ccprintf("%3d %pP:%6d us (Max: %6d us)\n", type, p->routine,
+			 hook_profile[i].last_us, hook_profile[i].max_us);
+		cflush();
+	}
+
+	ccprintf("Deferred call latency, buckets from <%d us by 4x:\n",
+		 DEFERRED_HIST_BASE_US);
+	for (i = 0; i < DEFERRED_FUNCS_COUNT; ++i) {
+		int j;
+
+		ccprintf("%pP:", __deferred_funcs[i].routine);
+		for (j = 0; j < DEFERRED_HIST_BUCKETS; j++)
+			ccprintf(" %5d", __deferred_hist[i][j]);
+		ccprintf("\n");
+		cflush();
+	}
+
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(hookstats, command_stats,
 			NULL,
 			"Print stats of hooks");
+
+static enum ec_status
+host_command_get_deferred_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_get_deferred_stats *p = args->params;
+	struct ec_response_get_deferred_stats *r = args->response;
+
+	if (p->index >= DEFERRED_FUNCS_COUNT)
+		return EC_RES_INVALID_PARAM;
+
+	r->deferred_count = DEFERRED_FUNCS_COUNT;
+	r->hist_base_us = DEFERRED_HIST_BASE_US;
+	r->routine = (uint32_t)(uintptr_t)__deferred_funcs[p->index].routine;
+	memcpy(r->hist, __deferred_hist[p->index], sizeof(r->hist));
+
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_GET_DEFERRED_STATS,
+		     host_command_get_deferred_stats,
+		     EC_VER_MASK(0));
 #endif
@@ -6,17 +6,22 @@
 /* Host command module for Chrome EC */
 
 #include "ap_hang_detect.h"
+#include "clock.h"
 #include "common.h"
 #include "console.h"
+#include "crashdump.h"
 #include "ec_commands.h"
+#include "hooks.h"
 #include "host_command.h"
 #include "link_defs.h"
 #include "lpc.h"
 #include "lpc_chip.h"
+#include "mkbp_event.h"
 #include "shared_mem.h"
 #include "system.h"
 #include "task.h"
 #include "timer.h"
+#include "tracepoint.h"
 #include "util.h"
 
 /* Console output macros */
@@ -32,7 +37,56 @@
 /* Stop printing repeated host commands "+" after this count */
 #define HCDEBUG_MAX_REPEAT_COUNT 5
 
-static struct host_cmd_handler_args *pending_args;
+#if defined(CONFIG_HOST_COMMAND_ASYNC) && !defined(CONFIG_HOST_COMMAND_STATUS)
+#error "CONFIG_HOST_COMMAND_ASYNC needs CONFIG_HOST_COMMAND_STATUS"
+#endif
+
+#ifdef CONFIG_HOST_COMMAND_CHANNELS
+#define HC_CHANNELS CONFIG_HOST_COMMAND_CHANNELS
+#else
+#define HC_CHANNELS 1
+#endif
+BUILD_ASSERT(HC_CHANNELS <= 32);
+
+/*
+ * Request slot of a host.  A channel is bound to the host_packet of a
+ * transport (or, for protocol v2, to the args it passes in) the first time
+ * that transport delivers a command.  Transports wait for the response before
+ * the next request, so each channel has at most one command in flight.
+ */
+struct hc_channel {
+	/* host_packet or host_cmd_handler_args of the transport, if bound */
+	const void *owner;
+	/* Current host command packet from host, for protocol version 3+ */
+	struct host_packet *pkt;
+	/*
+	 * Host command args passed to command handler for packets.  Static to
+	 * keep them off the stack.
+	 */
+	struct host_cmd_handler_args args;
+	/* Command waiting for, or being handled by, a host command task */
+	struct host_cmd_handler_args *pending;
+#ifdef HAS_TASK_HOSTCMD_WORKER
+	/* Command can be handled by the worker task */
+	uint8_t parallel;
+#endif
+#ifdef CONFIG_HOSTCMD_TRACE
+	/* Time pending was received */
+	uint32_t arrival_us;
+#endif
+};
+
+static struct hc_channel hc_channels[HC_CHANNELS];
+/* Channels whose command hasn't been taken by a task yet */
+static uint32_t hc_pending;
+
+#ifdef CONFIG_HOSTCMD_TRACE
+BUILD_ASSERT(POWER_OF_TWO(CONFIG_HOSTCMD_TRACE_ENTRIES));
+
+static struct ec_hostcmd_trace_entry hc_trace[CONFIG_HOSTCMD_TRACE_ENTRIES];
+/* Number of commands recorded since boot */
+static uint32_t hc_trace_seq;
+#endif
 
 #ifndef CONFIG_HOSTCMD_X86
 /*
@@ -68,14 +122,22 @@ static uint8_t command_pending;
 static uint8_t saved_result = EC_RES_UNAVAILABLE;
 #endif
 
-/*
- * Host command args passed to command handler.  Static to keep it off the
- * stack.  Note this means we can handle only one host command at a time.
- */
-static struct host_cmd_handler_args args0;
+#ifdef CONFIG_HOST_COMMAND_ASYNC
+/* Copy of the command running on the hook task, and its buffers */
+static struct host_cmd_handler_args async_args;
+static uint8_t async_params[CONFIG_HOST_COMMAND_ASYNC_SIZE] __aligned(4);
+static uint8_t async_response[CONFIG_HOST_COMMAND_ASYNC_SIZE] __aligned(4);
 
-/* Current host command packet from host, for protocol version 3+ */
-static struct host_packet *pkt0;
+/* Handler of the command running on the hook task, NULL if none */
+static enum ec_status (*volatile async_routine)(
+	struct host_cmd_handler_args *args);
+
+/* Set until the in-progress response of the async command has been sent */
+static uint8_t async_started;
+
+/* The response of the last async command is in async_response */
+static uint8_t async_done;
+#endif
 
 /*
  * Host command suppress
@@ -96,6 +158,60 @@ uint8_t *host_get_memmap(int offset)
 #endif
 }
 
+#ifdef CONFIG_HOST_MEMMAP_NOTIFY
+#ifndef CONFIG_MKBP_EVENT
+#error "CONFIG_HOST_MEMMAP_NOTIFY needs CONFIG_MKBP_EVENT"
+#endif
+
+BUILD_ASSERT(EC_MEMMAP_SIZE <= 32 * EC_MEMMAP_NOTIFY_BLOCK_SIZE);
+
+/* Memmap blocks the host subscribed to, and those changed since last read */
+static uint32_t memmap_subscribed;
+static uint32_t memmap_dirty;
+
+void host_memmap_changed(int offset, int size)
+{
+	uint32_t mask;
+
+	if (size <= 0)
+		return;
+
+	mask = GENMASK((offset + size - 1) / EC_MEMMAP_NOTIFY_BLOCK_SIZE,
+		       offset / EC_MEMMAP_NOTIFY_BLOCK_SIZE);
+	mask &= memmap_subscribed & ~memmap_dirty;
+	if (!mask)
+		return;
+
+	deprecated_atomic_or(&memmap_dirty, mask);
+	mkbp_send_event(EC_MKBP_EVENT_MEMMAP_CHANGE);
+}
+
+static int memmap_get_next_event(uint8_t *out)
+{
+	uint32_t dirty = deprecated_atomic_read_clear(&memmap_dirty);
+
+	memcpy(out, &dirty, sizeof(dirty));
+	return sizeof(dirty);
+}
+DECLARE_EVENT_SOURCE(EC_MKBP_EVENT_MEMMAP_CHANGE, memmap_get_next_event);
+
+static enum ec_status
+host_command_memmap_notify(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_memmap_notify *p = args->params;
+	struct ec_response_memmap_notify *r = args->response;
+
+	memmap_subscribed = p->subscribe_mask;
+	r->dirty_mask = deprecated_atomic_read_clear(&memmap_dirty);
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_MEMMAP_NOTIFY,
+		     host_command_memmap_notify,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOST_MEMMAP_NOTIFY */
+
 #ifdef CONFIG_EMI_REGION1
 uint8_t *host_get_customer_memmap(int offset)
 {
@@ -149,6 +265,17 @@ test_mockable void host_send_response(struct host_cmd_handler_args *args)
 			return;
 
 		} else if (args->result == EC_RES_IN_PROGRESS) {
+#ifdef CONFIG_HOST_COMMAND_ASYNC
+			/*
+			 * The command goes on in the background and stashes
+			 * its own result, this task is already free.
+			 */
+			if (async_started) {
+				async_started = 0;
+				args->send_response(args);
+				return;
+			}
+#endif
 			command_pending = 1;
 			CPRINTS("HC pending");
 		}
@@ -157,8 +284,50 @@ test_mockable void host_send_response(struct host_cmd_handler_args *args)
 	args->send_response(args);
 }
 
+/*
+ * Return the channel of a transport, binding a free one on first use, or NULL
+ * if they are all taken.  With a single channel, all transports share it.
+ */
+static struct hc_channel *hc_channel_get(const void *owner)
+{
+	struct hc_channel *ch;
+
+	if (HC_CHANNELS == 1) {
+		hc_channels[0].owner = owner;
+		return hc_channels;
+	}
+
+	for (ch = hc_channels; ch < hc_channels + HC_CHANNELS; ch++)
+		if (ch->owner == owner)
+			return ch;
+
+	interrupt_disable();
+	for (ch = hc_channels; ch < hc_channels + HC_CHANNELS; ch++)
+		if (!ch->owner) {
+			ch->owner = owner;
+			break;
+		}
+	interrupt_enable();
+
+	return ch < hc_channels + HC_CHANNELS ? ch : NULL;
+}
+
+/* Return the channel whose packet args are args, or NULL. */
+static struct hc_channel *hc_packet_channel(struct host_cmd_handler_args *args)
+{
+	int i;
+
+	for (i = 0; i < HC_CHANNELS; i++)
+		if (args == &hc_channels[i].args)
+			return hc_channels + i;
+
+	return NULL;
+}
+
 void host_command_received(struct host_cmd_handler_args *args)
 {
+	struct hc_channel *ch;
+
 	/*
 	 * TODO(crosbug.com/p/23806): should warn if we already think we're in
 	 * a command.
@@ -186,12 +355,28 @@ void host_command_received(struct host_cmd_handler_args *args)
 	} else if (args->command == EC_CMD_GET_COMMS_STATUS) {
 		args->result = host_command_process(args);
 #endif
+	} else if (!(ch = hc_packet_channel(args)) &&
+		   !(ch = hc_channel_get(args))) {
+		/* Protocol v2 transports bring their own args; none left */
+		args->result = EC_RES_BUSY;
 	} else {
 		/* Save the command */
-		pending_args = args;
+		ch->pending = args;
+#ifdef HAS_TASK_HOSTCMD_WORKER
+		ch->parallel = host_command_is_parallel(args->command);
+#endif
+#ifdef CONFIG_HOSTCMD_TRACE
+		ch->arrival_us = get_time().le.lo;
+#endif
+		deprecated_atomic_or(&hc_pending, BIT(ch - hc_channels));
 
 		/* Wake up the task to handle the command */
 		task_set_event(TASK_ID_HOSTCMD, TASK_EVENT_CMD_PENDING, 0);
+#ifdef HAS_TASK_HOSTCMD_WORKER
+		if (ch->parallel)
+			task_set_event(TASK_ID_HOSTCMD_WORKER,
+				       TASK_EVENT_CMD_PENDING, 0);
+#endif
 		return;
 	}
 
@@ -204,18 +389,48 @@ void host_command_received(struct host_cmd_handler_args *args)
 	host_send_response(args);
 }
 
-void host_packet_respond(struct host_cmd_handler_args *args)
+/*
+ * Return csum plus the sum of the n bytes at p.  Packets can carry several KB
+ * (flash reads, fingerprint frames), so add aligned words two bytes per 16-bit
+ * lane at a time.
+ */
+static int host_packet_sum(const uint8_t *p, size_t n, int csum)
 {
-	struct ec_host_response *r = (struct ec_host_response *)pkt0->response;
-	uint8_t *out = (uint8_t *)pkt0->response;
-	int csum = 0;
-	int i;
+	for (; n && ((uintptr_t)p & 3); n--)
+		csum += *p++;
+
+	while (n >= 4) {
+		/* 128 words can't overflow a lane */
+		size_t words = MIN(n / 4, 128);
+		uint32_t acc = 0;
+
+		n -= words * 4;
+		for (; words; words--, p += 4) {
+			uint32_t w = *(const uint32_t *)p;
+
+			acc += (w & 0x00ff00ff) + ((w >> 8) & 0x00ff00ff);
+		}
+		csum += (acc & 0xffff) + (acc >> 16);
+	}
+
+	for (; n; n--)
+		csum += *p++;
+
+	return csum;
+}
+
+/* Send the response to args, or an error if args->result is set. */
+static void host_packet_send(struct host_packet *pkt,
+			     struct host_cmd_handler_args *args)
+{
+	struct ec_host_response *r = (struct ec_host_response *)pkt->response;
+	int csum;
 
 	/* Clip result size to what we can accept */
 	if (args->result) {
 		/* Error results don't have data */
 		args->response_size = 0;
-	} else if (args->response_size > pkt0->response_max - sizeof(*r)) {
+	} else if (args->response_size > pkt->response_max - sizeof(*r)) {
 		/* Too much data */
 		args->result = EC_RES_RESPONSE_TOO_BIG;
 		args->response_size = 0;
@@ -228,20 +443,23 @@ void host_packet_respond(struct host_cmd_handler_args *args)
 	r->data_len = args->response_size;
 	r->reserved = 0;
 
-	/* Start checksum; this also advances *out to end of response */
-	for (i = sizeof(*r); i > 0; i--)
-		csum += *out++;
-
-	/* Checksum response data, if any */
-	for (i = args->response_size; i > 0; i--)
-		csum += *out++;
+	/* Checksum header and response data, if any */
+	csum = host_packet_sum(pkt->response, sizeof(*r) + r->data_len, 0);
 
 	/* Write checksum field so the entire packet sums to 0 */
 	r->checksum = (uint8_t)(-csum);
 
-	pkt0->response_size = sizeof(*r) + r->data_len;
-	pkt0->driver_result = args->result;
-	pkt0->send_response(pkt0);
+	pkt->response_size = sizeof(*r) + r->data_len;
+	pkt->driver_result = args->result;
+	pkt->send_response(pkt);
+}
+
+void host_packet_respond(struct host_cmd_handler_args *args)
+{
+	struct hc_channel *ch = hc_packet_channel(args);
+
+	ASSERT(ch);
+	host_packet_send(ch->pkt, args);
 }
 
 int host_request_expected_size(const struct ec_host_request *r)
@@ -263,27 +481,37 @@ void host_packet_receive(struct host_packet *pkt)
 		(const struct ec_host_request *)pkt->request;
 	const uint8_t *in = (const uint8_t *)pkt->request;
 	uint8_t *itmp = (uint8_t *)pkt->request_temp;
-	int csum = 0;
-	int i;
+	struct hc_channel *ch = hc_channel_get(pkt);
+	struct host_cmd_handler_args *args;
+	int csum;
+
+	if (!ch) {
+		/* Every channel is bound to another transport */
+		struct host_cmd_handler_args busy = { .result = EC_RES_BUSY };
+
+		host_packet_send(pkt, &busy);
+		return;
+	}
 
 	/* Track the packet we're handling */
-	pkt0 = pkt;
+	ch->pkt = pkt;
+	args = &ch->args;
 
 	/* If driver indicates error, don't even look at the data */
 	if (pkt->driver_result) {
-		args0.result = pkt->driver_result;
+		args->result = pkt->driver_result;
 		goto host_packet_bad;
 	}
 
 	if (pkt->request_size < sizeof(*r)) {
 		/* Packet too small for even a header */
-		args0.result = EC_RES_REQUEST_TRUNCATED;
+		args->result = EC_RES_REQUEST_TRUNCATED;
 		goto host_packet_bad;
 	}
 
 	if (pkt->request_size > pkt->request_max) {
 		/* Got a bigger request than the interface can handle */
-		args0.result = EC_RES_REQUEST_TRUNCATED;
+		args->result = EC_RES_REQUEST_TRUNCATED;
 		goto host_packet_bad;
 	}
 
@@ -296,20 +524,20 @@ void host_packet_receive(struct host_packet *pkt)
 	/* Start checksum and copy request header if necessary */
 	if (pkt->request_temp) {
 		/* Copy to temp buffer and checksum */
-		for (i = sizeof(*r); i > 0; i--) {
-			*itmp = *in++;
-			csum += *itmp++;
-		}
+		memcpy(itmp, in, sizeof(*r));
+		csum = host_packet_sum(itmp, sizeof(*r), 0);
+		in += sizeof(*r);
+		itmp += sizeof(*r);
 		r = (const struct ec_host_request *)pkt->request_temp;
 	} else {
 		/* Just checksum */
-		for (i = sizeof(*r); i > 0; i--)
-			csum += *in++;
+		csum = host_packet_sum(in, sizeof(*r), 0);
+		in += sizeof(*r);
 	}
 
 	if (r->struct_version != EC_HOST_REQUEST_VERSION) {
 		/* Request header we don't know how to handle */
-		args0.result = EC_RES_INVALID_HEADER;
+		args->result = EC_RES_INVALID_HEADER;
 		goto host_packet_bad;
 	}
 
@@ -320,48 +548,45 @@ void host_packet_receive(struct host_packet *pkt)
 		 * the data at the end (SPI) or may not know how big the
 		 * received data is (LPC).
 		 */
-		args0.result = EC_RES_REQUEST_TRUNCATED;
+		args->result = EC_RES_REQUEST_TRUNCATED;
 		goto host_packet_bad;
 	}
 
 	/* Copy request data and validate checksum */
 	if (pkt->request_temp) {
 		/* Params go in temporary buffer */
-		args0.params = itmp;
+		args->params = itmp;
 
 		/* Copy request data and checksum */
-		for (i = r->data_len; i > 0; i--) {
-			*itmp = *in++;
-			csum += *itmp++;
-		}
+		memcpy(itmp, in, r->data_len);
+		csum = host_packet_sum(itmp, r->data_len, csum);
 	} else {
 		/* Params read directly from request */
-		args0.params = in;
+		args->params = in;
 
 		/* Just checksum */
-		for (i = r->data_len; i > 0; i--)
-			csum += *in++;
+		csum = host_packet_sum(in, r->data_len, csum);
 	}
 
 	/* Validate checksum */
 	if ((uint8_t)csum) {
-		args0.result = EC_RES_INVALID_CHECKSUM;
+		args->result = EC_RES_INVALID_CHECKSUM;
 		goto host_packet_bad;
 	}
 
 	/* Set up host command handler args */
-	args0.send_response = host_packet_respond;
-	args0.command = r->command;
-	args0.version = r->command_version;
-	args0.params_size = r->data_len;
-	args0.response = (struct ec_host_response *)(pkt->response) + 1;
-	args0.response_max = pkt->response_max -
+	args->send_response = host_packet_respond;
+	args->command = r->command;
+	args->version = r->command_version;
+	args->params_size = r->data_len;
+	args->response = (struct ec_host_response *)(pkt->response) + 1;
+	args->response_max = pkt->response_max -
 		sizeof(struct ec_host_response);
-	args0.response_size = 0;
-	args0.result = EC_RES_SUCCESS;
+	args->response_size = 0;
+	args->result = EC_RES_SUCCESS;
 
 	/* Chain to host command received */
-	host_command_received(&args0);
+	host_command_received(args);
 	return;
 
 host_packet_bad:
@@ -371,16 +596,36 @@ host_packet_bad:
 	 * let the host command task send the response.
 	 */
 	/* Improperly formed packet from host, so send an error response */
-	host_packet_respond(&args0);
+	host_packet_respond(args);
 }
 
-/**
- * Find a command by command number.
- *
- * @param command	Command number to find
- * @return The command structure, or NULL if no match found.
+#ifdef CONFIG_HOSTCMD_LOOKUP_TABLE
+/*
+ * 1 + index into __hcmds of the handler for each command number, 0 if there
+ * is none.
  */
-static const struct host_command *find_host_command(int command)
+static uint8_t hcmd_table[CONFIG_HOSTCMD_LOOKUP_TABLE_SIZE];
+static int hcmd_table_ready;
+
+static void hcmd_table_init(void)
+{
+	const struct host_command *cmd;
+
+	/* Each handler needs a distinct non-zero index. */
+	if (__hcmds_end - __hcmds >= UINT8_MAX)
+		return;
+
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		if (cmd->command < ARRAY_SIZE(hcmd_table))
+			hcmd_table[cmd->command] = cmd - __hcmds + 1;
+	}
+
+	hcmd_table_ready = 1;
+}
+#endif
+
+/* Search .rodata.hcmds for a command. */
+static const struct host_command *search_host_command(int command)
 {
 #ifdef CONFIG_HOSTCMD_SECTION_SORTED
 	const struct host_command *l, *r, *m;
@@ -416,6 +661,27 @@ static const struct host_command *find_host_command(int command)
 #endif
 }
 
+/**
+ * Find a command by command number.
+ *
+ * @param command	Command number to find
+ * @return The command structure, or NULL if no match found.
+ */
+static const struct host_command *find_host_command(int command)
+{
+#ifdef CONFIG_HOSTCMD_LOOKUP_TABLE
+	if (!hcmd_table_ready)
+		hcmd_table_init();
+
+	if (hcmd_table_ready && command >= 0 &&
+	    command < ARRAY_SIZE(hcmd_table))
+		return hcmd_table[command] ?
+			__hcmds + hcmd_table[command] - 1 : NULL;
+#endif
+
+	return search_host_command(command);
+}
+
 static void host_command_init(void)
 {
 	/* Initialize memory map ID area */
@@ -437,9 +703,83 @@ static void host_command_init(void)
 #endif
 }
 
+#ifdef CONFIG_HOSTCMD_TRACE
+/* The response has been sent, publish an entry for the command. */
+static void host_command_trace(const struct hc_channel *ch,
+			       uint32_t start_us)
+{
+	const struct host_cmd_handler_args *args = ch->pending;
+	struct ec_hostcmd_trace_entry *e;
+	uint32_t end_us = get_time().le.lo;
+
+	/* The worker task may be recording too */
+	interrupt_disable();
+	e = hc_trace + (hc_trace_seq & (ARRAY_SIZE(hc_trace) - 1));
+	e->command = args->command;
+	e->version = args->version;
+	e->result = args->result;
+	e->response_size = args->response_size;
+	e->arrival_us = ch->arrival_us;
+	e->start_us = start_us;
+	e->end_us = end_us;
+	hc_trace_seq++;
+	interrupt_enable();
+}
+#endif
+
+/*
+ * Take the next channel with a pending command, round robin so that a busy
+ * host can't hold the others off.  If parallel_only, skip commands which
+ * have to run on the host command task.
+ */
+static struct hc_channel *hc_take_pending(int parallel_only)
+{
+	static int last;
+	struct hc_channel *ch = NULL;
+	int n;
+
+	interrupt_disable();
+	for (n = 1; n <= HC_CHANNELS; n++) {
+		int i = (last + n) % HC_CHANNELS;
+
+		if (!(hc_pending & BIT(i)))
+			continue;
+#ifdef HAS_TASK_HOSTCMD_WORKER
+		if (parallel_only && !hc_channels[i].parallel)
+			continue;
+#endif
+		hc_pending &= ~BIT(i);
+		last = i;
+		ch = hc_channels + i;
+		break;
+	}
+	interrupt_enable();
+
+	return ch;
+}
+
+static void host_command_run(struct hc_channel *ch)
+{
+	struct host_cmd_handler_args *args = ch->pending;
+	uint32_t start_us __maybe_unused = get_time().le.lo;
+
+	/* The governor only switches down on its next tick. */
+	if (IS_ENABLED(CONFIG_CPU_GOVERNOR))
+		clock_request_fast_cpu(MODULE_HOST_COMMAND, 1);
+	args->result = host_command_process(args);
+	TRACEPOINT(EC_TRACEPOINT_HOSTCMD_DONE, args->command, args->result);
+	host_send_response(args);
+#ifdef CONFIG_HOSTCMD_TRACE
+	host_command_trace(ch, start_us);
+#endif
+	if (IS_ENABLED(CONFIG_CPU_GOVERNOR))
+		clock_request_fast_cpu(MODULE_HOST_COMMAND, 0);
+}
+
 void host_command_task(void *u)
 {
 	timestamp_t t0, t1, t_recess;
+	struct hc_channel *ch;
 	t_recess.val = 0;
 	t1.val = 0;
 
@@ -450,11 +790,10 @@ void host_command_task(void *u)
 		int evt = task_wait_event(-1);
 		t0 = get_time();
 
-		/* Process it */
-		if ((evt & TASK_EVENT_CMD_PENDING) && pending_args) {
-			pending_args->result =
-					host_command_process(pending_args);
-			host_send_response(pending_args);
+		/* Process them */
+		if (evt & TASK_EVENT_CMD_PENDING) {
+			while ((ch = hc_take_pending(0)) != NULL)
+				host_command_run(ch);
 		}
 
 		/* reset rate limiting if we have slept enough */
@@ -472,6 +811,27 @@ void host_command_task(void *u)
 	}
 }
 
+#ifdef HAS_TASK_HOSTCMD_WORKER
+int host_command_is_parallel(int command)
+{
+	const struct host_command *cmd = find_host_command(command);
+
+	return cmd && (cmd->flags & HOST_COMMAND_FLAG_PARALLEL);
+}
+
+void host_command_worker_task(void *u)
+{
+	struct hc_channel *ch;
+
+	while (1) {
+		task_wait_event_mask(TASK_EVENT_CMD_PENDING, -1);
+
+		while ((ch = hc_take_pending(1)) != NULL)
+			host_command_run(ch);
+	}
+}
+#endif
+
 /*****************************************************************************/
 /* Host commands */
 
@@ -486,9 +846,9 @@ host_command_proto_version(struct host_cmd_handler_args *args)
 
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_PROTO_VERSION,
-		     host_command_proto_version,
-		     EC_VER_MASK(0));
+DECLARE_HOST_COMMAND_PARALLEL(EC_CMD_PROTO_VERSION,
+			      host_command_proto_version,
+			      EC_VER_MASK(0));
 
 static enum ec_status host_command_hello(struct host_cmd_handler_args *args)
 {
@@ -501,9 +861,9 @@ static enum ec_status host_command_hello(struct host_cmd_handler_args *args)
 
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_HELLO,
-		     host_command_hello,
-		     EC_VER_MASK(0));
+DECLARE_HOST_COMMAND_PARALLEL(EC_CMD_HELLO,
+			      host_command_hello,
+			      EC_VER_MASK(0));
 
 static enum ec_status host_command_read_test(struct host_cmd_handler_args *args)
 {
@@ -581,9 +941,43 @@ host_command_get_cmd_versions(struct host_cmd_handler_args *args)
 
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_GET_CMD_VERSIONS,
-		     host_command_get_cmd_versions,
-		     EC_VER_MASK(0) | EC_VER_MASK(1));
+DECLARE_HOST_COMMAND_PARALLEL(EC_CMD_GET_CMD_VERSIONS,
+			      host_command_get_cmd_versions,
+			      EC_VER_MASK(0) | EC_VER_MASK(1));
+
+#ifdef CONFIG_HOSTCMD_TRACE
+static enum ec_status
+host_command_get_hostcmd_trace(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_get_hostcmd_trace *p = args->params;
+	struct ec_response_get_hostcmd_trace *r = args->response;
+	uint32_t oldest = hc_trace_seq > ARRAY_SIZE(hc_trace) ?
+		hc_trace_seq - ARRAY_SIZE(hc_trace) : 0;
+	uint32_t seq = MAX(p->seq, oldest);
+	size_t max = (args->response_max - sizeof(*r)) / sizeof(r->entry[0]);
+	int i;
+
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	/* Entries are published with interrupts off, all at once. */
+	r->seq = seq;
+	r->next_seq = hc_trace_seq;
+	r->count = 0;
+
+	for (i = 0; i < max && seq + i < hc_trace_seq; i++) {
+		r->entry[i] = hc_trace[(seq + i) & (ARRAY_SIZE(hc_trace) - 1)];
+		r->count++;
+	}
+
+	args->response_size = sizeof(*r) + r->count * sizeof(r->entry[0]);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_GET_HOSTCMD_TRACE,
+		     host_command_get_hostcmd_trace,
+		     EC_VER_MASK(0));
+#endif
 
 static int host_command_is_suppressed(uint16_t cmd)
 {
@@ -721,12 +1115,17 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 #endif
 	{
 		cmd = find_host_command(args->command);
-		if (!cmd)
+		if (!cmd) {
 			rv = EC_RES_INVALID_COMMAND;
-		else if (!(EC_VER_MASK(args->version) & cmd->version_mask))
+		} else if (!(EC_VER_MASK(args->version) & cmd->version_mask)) {
 			rv = EC_RES_INVALID_VERSION;
-		else
+		} else {
+			int slot = crashdump_host_command_begin(args->command,
+								args->version);
+
 			rv = cmd->handler(args);
+			crashdump_host_command_end(slot, rv);
+		}
 	}
 
 	if (rv != EC_RES_SUCCESS)
@@ -739,6 +1138,97 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 	return rv;
 }
 
+#ifdef CONFIG_HOSTCMD_BATCH
+/* Sub-requests and sub-responses start on 4-byte boundaries */
+#define BATCH_ALIGN(size) (((size) + 3) & ~3)
+
+/*
+ * Handlers may assume they get at least a protocol v2 sized response buffer,
+ * so the last commands of a batch run in this one when there is less space
+ * left than that.
+ */
+static uint8_t batch_response[EC_PROTO2_MAX_PARAM_SIZE] __aligned(4);
+
+static enum ec_status host_command_batch(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_batch *p = args->params;
+	struct ec_response_batch *r = args->response;
+	const uint8_t *in = (const uint8_t *)(p + 1);
+	const uint8_t *in_end = (const uint8_t *)args->params +
+		args->params_size;
+	uint8_t *out = (uint8_t *)(r + 1);
+	uint8_t *out_end = (uint8_t *)args->response + args->response_max;
+	int i;
+
+	if (args->params_size < sizeof(*p) || args->response_max < sizeof(*r))
+		return EC_RES_INVALID_PARAM;
+
+	/* Check all the sub-requests before running any of them. */
+	for (i = 0; i < p->count; i++) {
+		const struct ec_params_batch_cmd *c = (const void *)in;
+
+		if (in + sizeof(*c) > in_end ||
+		    in + sizeof(*c) + c->data_len > in_end ||
+		    c->command == EC_CMD_BATCH)
+			return EC_RES_INVALID_PARAM;
+		in += BATCH_ALIGN(sizeof(*c) + c->data_len);
+	}
+
+	in = (const uint8_t *)(p + 1);
+	r->count = 0;
+
+	for (i = 0; i < p->count; i++) {
+		const struct ec_params_batch_cmd *c = (const void *)in;
+		struct ec_response_batch_cmd *rc = (void *)out;
+		struct host_cmd_handler_args sub = {
+			.send_response = args->send_response,
+			.command = c->command,
+			.version = c->version,
+			.params = c + 1,
+			.params_size = c->data_len,
+			.response = rc + 1,
+			.response_size = 0,
+		};
+		size_t space;
+
+		if (out + sizeof(*rc) > out_end)
+			break;
+		space = out_end - (uint8_t *)(rc + 1);
+
+		if (space >= sizeof(batch_response)) {
+			sub.response_max = space;
+		} else {
+			sub.response = batch_response;
+			sub.response_max = sizeof(batch_response);
+		}
+
+		rc->result = host_command_process(&sub);
+		if (rc->result != EC_RES_SUCCESS)
+			sub.response_size = 0;
+		else if (sub.response_size > space)
+			break;
+		else if (sub.response == batch_response)
+			memcpy(rc + 1, batch_response, sub.response_size);
+		rc->data_len = sub.response_size;
+
+		in += BATCH_ALIGN(sizeof(*c) + c->data_len);
+		out += BATCH_ALIGN(sizeof(*rc) + rc->data_len);
+		r->count++;
+
+		/* Padding of the last response may not fit */
+		if (out > out_end)
+			out = out_end;
+	}
+
+	args->response_size = out - (uint8_t *)args->response;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_BATCH,
+		     host_command_batch,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_BATCH */
+
 #ifdef CONFIG_HOST_COMMAND_STATUS
 /* Returns current command status (busy or not) */
 static enum ec_status
@@ -747,6 +1237,10 @@ host_command_get_comms_status(struct host_cmd_handler_args *args)
 	struct ec_response_get_comms_status *r = args->response;
 
 	r->flags = command_pending ? EC_COMMS_STATUS_PROCESSING : 0;
+#ifdef CONFIG_HOST_COMMAND_ASYNC
+	if (async_routine)
+		r->flags |= EC_COMMS_STATUS_PROCESSING;
+#endif
 	args->response_size = sizeof(*r);
 
 	return EC_RES_SUCCESS;
@@ -760,6 +1254,24 @@ DECLARE_HOST_COMMAND(EC_CMD_GET_COMMS_STATUS,
 static enum ec_status
 host_command_resend_response(struct host_cmd_handler_args *args)
 {
+#ifdef CONFIG_HOST_COMMAND_ASYNC
+	if (async_done) {
+		enum ec_status rv = saved_result;
+
+		async_done = 0;
+		saved_result = EC_RES_UNAVAILABLE;
+
+		if (async_args.response_size > args->response_max)
+			return EC_RES_RESPONSE_TOO_BIG;
+
+		memcpy(args->response, async_response,
+		       async_args.response_size);
+		args->response_size = async_args.response_size;
+
+		return rv;
+	}
+#endif
+
 	/* Handle resending response */
 	args->result = saved_result;
 	args->response_size = 0;
@@ -772,6 +1284,50 @@ host_command_resend_response(struct host_cmd_handler_args *args)
 DECLARE_HOST_COMMAND(EC_CMD_RESEND_RESPONSE,
 		     host_command_resend_response,
 		     EC_VER_MASK(0));
+
+#ifdef CONFIG_HOST_COMMAND_ASYNC
+static void host_command_async_run(void)
+{
+	enum ec_status rv = async_routine(&async_args);
+
+	CPRINTS("HC 0x%02x async done, size=%d, result=%d",
+		async_args.command, async_args.response_size, rv);
+
+	saved_result = rv;
+	async_done = 1;
+	async_routine = NULL;
+}
+DECLARE_DEFERRED(host_command_async_run);
+
+enum ec_status host_command_async(struct host_cmd_handler_args *args,
+				  enum ec_status (*routine)(
+					  struct host_cmd_handler_args *args))
+{
+	if (args->params_size > sizeof(async_params))
+		return routine(args);
+
+	if (async_routine || command_pending)
+		return EC_RES_BUSY;
+
+	async_args = *args;
+	memcpy(async_params, args->params, args->params_size);
+	async_args.params = async_params;
+	async_args.response = async_response;
+	async_args.response_max = MIN(args->response_max,
+				      sizeof(async_response));
+	async_args.response_size = 0;
+
+	/* Results of earlier commands can't be fetched anymore. */
+	async_done = 0;
+	saved_result = EC_RES_UNAVAILABLE;
+
+	async_started = 1;
+	async_routine = routine;
+	hook_call_deferred(&host_command_async_run_data, 0);
+
+	return EC_RES_IN_PROGRESS;
+}
+#endif /* CONFIG_HOST_COMMAND_ASYNC */
 #endif /* CONFIG_HOST_COMMAND_STATUS */
 
 /* Returns what we tell it to. */
@@ -303,7 +303,67 @@ host_event_t host_get_events(void)
 	return events;
 }
 
+static void host_set_events_now(host_event_t mask);
+
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+#ifndef CONFIG_HOST_EVENT_COALESCE_MASK
+#define CONFIG_HOST_EVENT_COALESCE_MASK					\
+	(EC_HOST_EVENT_MASK(EC_HOST_EVENT_AC_CONNECTED) |		\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_AC_DISCONNECTED) |		\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_BATTERY) |			\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_BATTERY_STATUS) |		\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_USB_CHARGER) |		\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_PD_MCU))
+#endif
+
+/* Events held back until the end of the coalescing window */
+static host_event_t events_pending;
+
+static host_event_t host_events_take_pending(void)
+{
+	host_event_t pending;
+
+	interrupt_disable();
+	pending = events_pending;
+	events_pending = 0;
+	interrupt_enable();
+
+	return pending;
+}
+
+static void host_events_flush_pending(void)
+{
+	host_set_events_now(host_events_take_pending());
+}
+DECLARE_DEFERRED(host_events_flush_pending);
+#endif /* CONFIG_HOST_EVENT_COALESCE_MS */
+
 void host_set_events(host_event_t mask)
+{
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+	if (mask && !(mask & ~CONFIG_HOST_EVENT_COALESCE_MASK)) {
+		int first;
+
+		interrupt_disable();
+		first = !events_pending;
+		events_pending |= mask;
+		interrupt_enable();
+
+		/* The window starts with the first event held back */
+		if (first)
+			hook_call_deferred(&host_events_flush_pending_data,
+					   CONFIG_HOST_EVENT_COALESCE_MS * MSEC);
+		return;
+	}
+
+	/* Anything else goes out now, and takes the held back events along */
+	mask |= host_events_take_pending();
+#endif
+
+	host_set_events_now(mask);
+}
+
+static void host_set_events_now(host_event_t mask)
 {
 	/* ignore host events the rest of board doesn't care about */
 #ifdef CONFIG_HOST_EVENT64
@@ -371,6 +431,13 @@ void host_clear_events(host_event_t mask)
 	mask &= CONFIG_HOST_EVENT_REPORT_MASK;
 #endif
 
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+	/* Events cleared before their window ended are never raised */
+	interrupt_disable();
+	events_pending &= ~mask;
+	interrupt_enable();
+#endif
+
 	/* return early if nothing changed */
 	if (!(events & mask))
 		return;
@@ -14,10 +14,38 @@
 
 static int started;
 
-/* TODO: respect i2c_port->kbps setting */
+/* Half an SCL period of the port being driven, in us */
+static int half_period_us = 5;
+
+/* Longest clock stretch tolerated, see clock_stretching() */
+#define CLOCK_STRETCH_TIMEOUT_US (35 * MSEC)
+
 static void i2c_delay(void)
 {
-	udelay(5);
+	udelay(half_period_us);
+}
+
+/*
+ * Wait for SCL to go high after releasing it.  Returns nonzero if a slave
+ * held it low for CLOCK_STRETCH_TIMEOUT_US.
+ */
+static int wait_scl_high(const struct i2c_port_t *i2c_port)
+{
+	timestamp_t deadline;
+
+	/* Most of the time nobody stretches the clock */
+	if (gpio_get_level(i2c_port->scl))
+		return 0;
+
+	deadline = get_time();
+	deadline.val += CLOCK_STRETCH_TIMEOUT_US;
+	do {
+		i2c_delay();
+		if (gpio_get_level(i2c_port->scl))
+			return 0;
+	} while (!timestamp_expired(deadline, NULL));
+
+	return EC_ERROR_TIMEOUT;
 }
 
 /* Number of attempts to unwedge each pin. */
@@ -96,8 +124,6 @@ static void i2c_bitbang_unwedge(const struct i2c_port_t *i2c_port)
 
 static void i2c_stop_cond(const struct i2c_port_t *i2c_port)
 {
-	int i;
-
 	if (!started)
 		return;
 
@@ -114,11 +140,7 @@ static void i2c_stop_cond(const struct i2c_port_t *i2c_port)
 	 *  hold SMBCLK low for at least tTIMEOUT,MAX in an attempt to reset the
 	 *  SMBus interface of all of the devices on the bus.
 	 */
-	for (i = 0; i < 7000; i++) {
-		if (gpio_get_level(i2c_port->scl))
-			break;
-		i2c_delay();
-	}
+	wait_scl_high(i2c_port);
 	i2c_delay();
 
 	/* SCL is high, set SDA from 0 to 1 */
@@ -130,15 +152,8 @@ static void i2c_stop_cond(const struct i2c_port_t *i2c_port)
 
 static int clock_stretching(const struct i2c_port_t *i2c_port)
 {
-	int i;
-
-	i2c_delay();
-	/* 5us * 7000 iterations ~= 35ms */
-	for (i = 0; i < 7000; i++) {
-		if (gpio_get_level(i2c_port->scl))
-			return 0;
-		i2c_delay();
-	}
+	if (!wait_scl_high(i2c_port))
+		return 0;
 
 	/*
 	 * SMBus 3.0, Note 3
@@ -287,8 +302,8 @@ static int i2c_bitbang_xfer(const struct i2c_port_t *i2c_port,
 	uint16_t addr_8bit = slave_addr_flags << 1, err = EC_SUCCESS;
 	int i = 0;
 
-	if (i2c_port->kbps != 100)
-		CPRINTS("warning: bitbang driver only supports 100kbps");
+	/* udelay() can't do better than 1us, so that caps the bus at 500kHz */
+	half_period_us = i2c_port->kbps ? DIV_ROUND_UP(500, i2c_port->kbps) : 5;
 
 	if (out_size) {
 		if (flags & I2C_XFER_START) {
@@ -7,6 +7,7 @@
 
 #include "console.h"
 #include "hwtimer.h"
+#include "task.h"
 #include "util.h"
 
 /* 2 bytes for length + 1 byte for report ID */
@@ -430,14 +431,26 @@ static struct i2c_hid_descriptor hid_desc = {
 static bool pending_probe;
 static bool pending_reset;
 
-/* Reports (double buffered) */
-#define MAX_REPORT_CNT	2
+/*
+ * Compiled reports, in a ring the host reads in order. A burst of touch
+ * events, e.g. the frame where a finger leaves, is then not lost to a slow
+ * host. If the host falls further behind, the oldest report is dropped. Must
+ * be a power of two.
+ */
+#define REPORT_QUEUE_LEN	4
+BUILD_ASSERT(POWER_OF_TWO(REPORT_QUEUE_LEN));
+
+static struct touch_report touch_reports[REPORT_QUEUE_LEN];
+static struct mouse_report mouse_reports[REPORT_QUEUE_LEN];
 
-static struct touch_report touch_reports[MAX_REPORT_CNT];
-static struct mouse_report mouse_reports[MAX_REPORT_CNT];
+/*
+ * Count of reports compiled and read. The latest compiled report, at
+ * report_head - 1, answers reads once all of them have been read.
+ */
+static uint32_t report_head;
+static uint32_t report_tail;
 
-/* Current active report buffer index */
-static int report_active_index;
+#define REPORT_INDEX(n)	((n) & (REPORT_QUEUE_LEN - 1))
 
 /* Current input mode */
 static uint8_t input_mode;
@@ -509,7 +522,8 @@ void i2c_hid_touchpad_init(void)
 	input_mode = INPUT_MODE_MOUSE;
 	reporting.surface_switch = 1;
 	reporting.button_switch = 1;
-	report_active_index = 0;
+	report_head = 0;
+	report_tail = 0;
 
 	// Respond probing requests for now.
 	pending_probe = true;
@@ -521,6 +535,7 @@ int i2c_hid_touchpad_process(unsigned int len, uint8_t *buffer,
 			     int *reg, int *cmd)
 {
 	size_t response_len;
+	int index;
 
 	if (len == 0)
 		*reg = I2C_HID_INPUT_REPORT_REGISTER;
@@ -552,16 +567,23 @@ int i2c_hid_touchpad_process(unsigned int len, uint8_t *buffer,
 			send_response(2);
 			break;
 		}
-		// Common input report requests.
+		// Common input report requests, oldest unread report first.
+		interrupt_disable();
+		if (report_tail != report_head)
+			index = REPORT_INDEX(report_tail++);
+		else
+			index = REPORT_INDEX(report_head - 1);
+		interrupt_enable();
+
 		if (input_mode == INPUT_MODE_TOUCH) {
 			response_len =
 				fill_report(buffer, REPORT_ID_TOUCH,
-					    &touch_reports[report_active_index],
+					    &touch_reports[index],
 					    sizeof(struct touch_report));
 		} else {
 			response_len =
 				fill_report(buffer, REPORT_ID_MOUSE,
-					    &mouse_reports[report_active_index],
+					    &mouse_reports[index],
 					    sizeof(struct mouse_report));
 		}
 		send_response(response_len);
@@ -587,6 +609,7 @@ static int i2c_hid_touchpad_command_process(size_t len, uint8_t *buffer,
 	uint8_t command = buffer[3] & 0x0F;
 	uint8_t power_state = buffer[2] & 0x03;
 	uint8_t report_id = buffer[2] & 0x0F;
+	int latest = REPORT_INDEX(report_head - 1);
 	size_t response_len;
 
 	switch (command) {
@@ -601,13 +624,13 @@ static int i2c_hid_touchpad_command_process(size_t len, uint8_t *buffer,
 		case REPORT_ID_TOUCH:
 			response_len =
 				fill_report(buffer, report_id,
-					    &touch_reports[report_active_index],
+					    &touch_reports[latest],
 					    sizeof(struct touch_report));
 			break;
 		case REPORT_ID_MOUSE:
 			response_len =
 				fill_report(buffer, report_id,
-					    &mouse_reports[report_active_index],
+					    &mouse_reports[latest],
 					    sizeof(struct mouse_report));
 			break;
 		case REPORT_ID_DEVICE_CAPS:
@@ -665,14 +688,28 @@ static int i2c_hid_touchpad_command_process(size_t len, uint8_t *buffer,
 	return command;
 }
 
+bool i2c_hid_touchpad_report_pending(void)
+{
+	return report_tail != report_head;
+}
+
 void i2c_hid_compile_report(struct touchpad_event *event)
 {
-	/* Save report into back buffer */
-	struct touch_report *touch = &touch_reports[report_active_index ^ 1];
-	struct touch_report *touch_old = &touch_reports[report_active_index];
-	struct mouse_report *mouse = &mouse_reports[report_active_index ^ 1];
+	struct touch_report *touch;
+	struct touch_report *touch_old;
+	struct mouse_report *mouse;
 	int contact_num = 0;
 
+	/* Make room for the new report, dropping the oldest unread one. */
+	interrupt_disable();
+	if (report_head - report_tail == REPORT_QUEUE_LEN)
+		report_tail++;
+	interrupt_enable();
+
+	touch = &touch_reports[REPORT_INDEX(report_head)];
+	touch_old = &touch_reports[REPORT_INDEX(report_head - 1)];
+	mouse = &mouse_reports[REPORT_INDEX(report_head)];
+
 	/* Touch report. */
 	memset(touch, 0, sizeof(struct touch_report));
 	for (int i = 0; i < I2C_HID_TOUCHPAD_MAX_FINGERS; i++) {
@@ -792,6 +829,6 @@ void i2c_hid_compile_report(struct touchpad_event *event)
 		mouse->y = 0;
 	}
 
-	/* Swap buffer */
-	report_active_index ^= 1;
+	/* Hand the report over to the host */
+	report_head++;
 }
@@ -17,6 +17,8 @@
 #include "i2c_private.h"
 #include "system.h"
 #include "task.h"
+#include "timer.h"
+#include "tracepoint.h"
 #include "usb_pd.h"
 #include "usb_pd_tcpm.h"
 #include "util.h"
@@ -43,12 +45,144 @@
 #define I2C_BITBANG_PORT_COUNT 0
 #endif
 
-static struct mutex port_mutex[I2C_CONTROLLER_COUNT + I2C_BITBANG_PORT_COUNT];
+#define I2C_PORT_MUTEX_COUNT (I2C_CONTROLLER_COUNT + I2C_BITBANG_PORT_COUNT)
+
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+/*
+ * Ports are shared by drivers running in tasks of very different priority
+ * (e.g. PD and HOOKS), so let the holder of a port inherit its waiters'
+ * priority.
+ */
+static struct mutex port_mutex[I2C_PORT_MUTEX_COUNT] = {
+	[0 ... (I2C_PORT_MUTEX_COUNT - 1)] = {
+		.flags = MUTEX_FLAG_PRIORITY_INHERIT,
+	},
+};
+#else
+static struct mutex port_mutex[I2C_PORT_MUTEX_COUNT];
+#endif
 /* A bitmap of the controllers which are currently servicing a request. */
 static uint32_t i2c_port_active_list;
 BUILD_ASSERT(ARRAY_SIZE(port_mutex) < 32);
 static uint8_t port_protected[I2C_PORT_COUNT + I2C_BITBANG_PORT_COUNT];
 
+#ifdef CONFIG_I2C_LOCK_STATS
+/* Port lock use of each task */
+struct i2c_lock_stats {
+	uint32_t count;		/* Number of times a port was locked */
+	uint32_t wait_us;	/* Total time waiting for a port */
+	uint32_t max_wait_us;	/* Longest wait */
+	uint32_t max_hold_us;	/* Longest time holding a port */
+};
+static struct i2c_lock_stats lock_stats[TASK_ID_COUNT];
+
+/* The longest hold of each port and its holder */
+static uint32_t port_max_hold_us[I2C_PORT_MUTEX_COUNT];
+static task_id_t port_max_hold_task[I2C_PORT_MUTEX_COUNT];
+#endif
+
+#ifdef CONFIG_I2C_STATS
+/* Lock use of each port, and transfers to each device seen */
+static struct ec_i2c_stats_port port_stats[I2C_PORT_MUTEX_COUNT];
+static struct ec_i2c_stats_dev dev_stats[CONFIG_I2C_STATS_DEVICES];
+static int dev_stats_count;
+#endif
+
+#if defined(CONFIG_I2C_LOCK_STATS) || defined(CONFIG_I2C_STATS)
+/* When each port was last locked */
+static uint32_t port_lock_time[I2C_PORT_MUTEX_COUNT];
+
+static void lock_stats_locked(int port, uint32_t wait_start)
+{
+	uint32_t now = get_time().le.lo;
+	uint32_t wait_us = now - wait_start;
+
+	port_lock_time[port] = now;
+
+#ifdef CONFIG_I2C_STATS
+	port_stats[port].lock_count++;
+	port_stats[port].wait_us += wait_us;
+	port_stats[port].max_wait_us = MAX(port_stats[port].max_wait_us,
+					   wait_us);
+#endif
+#ifdef CONFIG_I2C_LOCK_STATS
+	if (task_get_current() < TASK_ID_COUNT) {
+		struct i2c_lock_stats *s = &lock_stats[task_get_current()];
+
+		s->count++;
+		s->wait_us += wait_us;
+		s->max_wait_us = MAX(s->max_wait_us, wait_us);
+	}
+#endif
+}
+
+static void lock_stats_unlocking(int port)
+{
+	uint32_t hold_us = get_time().le.lo - port_lock_time[port];
+
+#ifdef CONFIG_I2C_STATS
+	port_stats[port].hold_us += hold_us;
+	port_stats[port].max_hold_us = MAX(port_stats[port].max_hold_us,
+					   hold_us);
+#endif
+#ifdef CONFIG_I2C_LOCK_STATS
+	if (task_get_current() < TASK_ID_COUNT) {
+		task_id_t id = task_get_current();
+
+		lock_stats[id].max_hold_us = MAX(lock_stats[id].max_hold_us,
+						 hold_us);
+		if (hold_us > port_max_hold_us[port]) {
+			port_max_hold_us[port] = hold_us;
+			port_max_hold_task[port] = id;
+		}
+	}
+#endif
+}
+#endif /* CONFIG_I2C_LOCK_STATS || CONFIG_I2C_STATS */
+
+#ifdef CONFIG_I2C_STATS
+/* Find the stats of a device, adding them if there is room */
+static struct ec_i2c_stats_dev *i2c_dev_stats(int port, uint16_t addr_flags)
+{
+	struct ec_i2c_stats_dev *d = NULL;
+	int i;
+
+	for (i = 0; i < dev_stats_count; i++)
+		if (dev_stats[i].port == port &&
+		    dev_stats[i].addr_flags == addr_flags)
+			return &dev_stats[i];
+
+	/* Another port may be adding a device at the same time. */
+	interrupt_disable();
+	if (dev_stats_count < ARRAY_SIZE(dev_stats)) {
+		d = &dev_stats[dev_stats_count++];
+		memset(d, 0, sizeof(*d));
+		d->port = port;
+		d->addr_flags = addr_flags;
+	}
+	interrupt_enable();
+
+	return d;
+}
+
+static void i2c_stats_xfer(int port, uint16_t addr_flags, int bytes,
+			   int retries, int ret, uint32_t xfer_us)
+{
+	struct ec_i2c_stats_dev *d = i2c_dev_stats(port, addr_flags);
+
+	if (!d)
+		return;
+
+	d->count++;
+	d->bytes += bytes;
+	d->retries += retries;
+	if (ret)
+		d->errors++;
+	d->xfer_us += xfer_us;
+	d->max_xfer_us = MAX(d->max_xfer_us, xfer_us);
+}
+#endif /* CONFIG_I2C_STATS */
+
 /**
  * Non-deterministically test the lock status of the port.  If another task
  * has locked the port and the caller is accessing it illegally, then this test
@@ -167,6 +301,10 @@ int i2c_xfer_unlocked(const int port,
 
 	uint16_t addr_flags = slave_addr_flags & ~I2C_FLAG_PEC;
 
+#ifdef CONFIG_I2C_STATS
+	uint32_t start = get_time().le.lo;
+#endif
+
 	if (!i2c_port_is_locked(port)) {
 		CPUTS("Access I2C without lock!");
 		return EC_ERROR_INVAL;
@@ -185,6 +323,12 @@ int i2c_xfer_unlocked(const int port,
 		if (ret != EC_ERROR_BUSY)
 			break;
 	}
+#ifdef CONFIG_I2C_STATS
+	i2c_stats_xfer(port, addr_flags, out_size + in_size,
+		       MIN(i, CONFIG_I2C_NACK_RETRY_COUNT), ret,
+		       get_time().le.lo - start);
+#endif
+	TRACEPOINT(EC_TRACEPOINT_I2C_XFER, port << 16 | addr_flags, ret);
 	return ret;
 }
 
@@ -214,7 +358,14 @@ void i2c_lock(int port, int lock)
 		return;
 
 	if (lock) {
+#if defined(CONFIG_I2C_LOCK_STATS) || defined(CONFIG_I2C_STATS)
+		uint32_t wait_start = get_time().le.lo;
+#endif
+
 		mutex_lock(port_mutex + port);
+#if defined(CONFIG_I2C_LOCK_STATS) || defined(CONFIG_I2C_STATS)
+		lock_stats_locked(port, wait_start);
+#endif
 
 		/* Disable interrupt during changing counter for preemption. */
 		interrupt_disable();
@@ -225,6 +376,9 @@ void i2c_lock(int port, int lock)
 
 		interrupt_enable();
 	} else {
+#if defined(CONFIG_I2C_LOCK_STATS) || defined(CONFIG_I2C_STATS)
+		lock_stats_unlocking(port);
+#endif
 		interrupt_disable();
 
 		i2c_port_active_list &= ~BIT(port);
@@ -247,6 +401,63 @@ void i2c_prepare_sysjump(void)
 		mutex_lock(port_mutex + i);
 }
 
+#if defined(CONFIG_MUTEX_STATS) || defined(CONFIG_I2C_LOCK_STATS)
+static int command_i2c_lock_stats(int argc, char **argv)
+{
+	int i;
+
+#ifdef CONFIG_I2C_LOCK_STATS
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(lock_stats, 0, sizeof(lock_stats));
+		memset(port_max_hold_us, 0, sizeof(port_max_hold_us));
+		return EC_SUCCESS;
+	}
+#endif
+
+	for (i = 0; i < ARRAY_SIZE(port_mutex); ++i) {
+		ccprintf("Port %d:", i);
+#ifdef CONFIG_MUTEX_STATS
+		ccprintf(" waited %d times, longest %d us",
+			 port_mutex[i].contended, port_mutex[i].max_block_us);
+#endif
+#ifdef CONFIG_I2C_LOCK_STATS
+		if (port_max_hold_us[i])
+			ccprintf(" longest hold %d us by %s",
+				 port_max_hold_us[i],
+				 task_get_name(port_max_hold_task[i]));
+#endif
+		ccprintf("\n");
+	}
+
+#ifdef CONFIG_I2C_LOCK_STATS
+	ccprintf("Task             count  avg wait  max wait  max hold\n");
+	for (i = 0; i < TASK_ID_COUNT; i++) {
+		const struct i2c_lock_stats *s = &lock_stats[i];
+
+		if (!s->count)
+			continue;
+		ccprintf("%-14s %7d %7d us %7d us %7d us\n",
+			 task_get_name(i), s->count, s->wait_us / s->count,
+			 s->max_wait_us, s->max_hold_us);
+		cflush();
+	}
+#endif
+
+	return EC_SUCCESS;
+}
+#ifdef CONFIG_I2C_LOCK_STATS
+DECLARE_SAFE_CONSOLE_COMMAND(i2clockstats, command_i2c_lock_stats,
+			     "[clear]",
+			     "Print or clear the i2c port lock waits and holds");
+#else
+DECLARE_SAFE_CONSOLE_COMMAND(i2clockstats, command_i2c_lock_stats,
+			     NULL,
+			     "Print the longest wait for each i2c port lock");
+#endif
+#endif
+
 /* i2c_readN with optional error checking */
 static int i2c_read(const int port, const uint16_t slave_addr_flags,
 			uint8_t reg, uint8_t *in, int in_size)
@@ -1216,7 +1427,105 @@ static enum ec_status i2c_command_passthru(struct host_cmd_handler_args *args)
 	 */
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_I2C_PASSTHRU, i2c_command_passthru, EC_VER_MASK(0));
+DECLARE_HOST_COMMAND_ASYNC(EC_CMD_I2C_PASSTHRU, i2c_command_passthru,
+			   EC_VER_MASK(0));
+
+#ifdef CONFIG_I2C_PASSTHRU_SESSION
+static struct {
+	int open;
+	int port;
+	uint16_t addr_flags;
+	timestamp_t expires;
+} i2c_session;
+
+static enum ec_status i2c_session_open(const struct ec_params_i2c_session *p)
+{
+	const struct i2c_port_t *i2c_port;
+	uint16_t addr_flags = p->addr_flags & EC_I2C_ADDR_MASK;
+
+	i2c_session.open = 0;
+
+#ifdef CONFIG_BATTERY_CUT_OFF
+	if (battery_is_cut_off())
+		return EC_RES_ACCESS_DENIED;
+#endif
+
+	i2c_port = get_i2c_port(p->port);
+	if (!i2c_port)
+		return EC_RES_INVALID_PARAM;
+
+#if defined(VIRTUAL_BATTERY_ADDR_FLAGS) && defined(I2C_PORT_VIRTUAL_BATTERY)
+	/* The virtual battery is only reachable through the message list */
+	if (p->port == I2C_PORT_VIRTUAL_BATTERY &&
+	    addr_flags == VIRTUAL_BATTERY_ADDR_FLAGS)
+		return EC_RES_INVALID_PARAM;
+#endif
+
+	if (port_protected[p->port] && i2c_port->passthru_allowed &&
+	    !i2c_port->passthru_allowed(i2c_port, addr_flags))
+		return EC_RES_ACCESS_DENIED;
+
+#ifdef CONFIG_I2C_PASSTHRU_RESTRICTED
+	if (system_is_locked() && !board_allow_i2c_passthru(p->port))
+		return EC_RES_ACCESS_DENIED;
+#endif
+
+	PTHRUPRINTS("session open port=%d addr=0x%x", p->port, addr_flags);
+	i2c_session.port = p->port;
+	i2c_session.addr_flags = addr_flags;
+	i2c_session.open = 1;
+	return EC_RES_SUCCESS;
+}
+
+static enum ec_status i2c_command_passthru_session(
+	struct host_cmd_handler_args *args)
+{
+	const struct ec_params_i2c_session *p = args->params;
+	int write_len;
+	int rv;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+
+	switch (p->subcmd) {
+	case EC_I2C_SESSION_OPEN:
+		rv = i2c_session_open(p);
+		break;
+	case EC_I2C_SESSION_CLOSE:
+		i2c_session.open = 0;
+		return EC_RES_SUCCESS;
+	case EC_I2C_SESSION_XFER:
+		if (!i2c_session.open ||
+		    timestamp_expired(i2c_session.expires, NULL)) {
+			i2c_session.open = 0;
+			return EC_RES_ACCESS_DENIED;
+		}
+
+		write_len = args->params_size - sizeof(*p);
+		if (p->read_len > args->response_max ||
+		    (!write_len && !p->read_len))
+			return EC_RES_INVALID_PARAM;
+
+		rv = i2c_xfer(i2c_session.port, i2c_session.addr_flags,
+			      p->data, write_len, args->response, p->read_len);
+		if (rv == EC_ERROR_TIMEOUT)
+			return EC_RES_TIMEOUT;
+		if (rv)
+			return EC_RES_ERROR;
+		args->response_size = p->read_len;
+		break;
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+
+	if (rv == EC_RES_SUCCESS)
+		i2c_session.expires.val = get_time().val +
+					  EC_I2C_SESSION_TIMEOUT_MS * MSEC;
+	return rv;
+}
+DECLARE_HOST_COMMAND_ASYNC(EC_CMD_I2C_PASSTHRU_SESSION,
+			   i2c_command_passthru_session, EC_VER_MASK(0));
+#endif /* CONFIG_I2C_PASSTHRU_SESSION */
 
 static void i2c_passthru_protect_port(uint32_t port)
 {
@@ -1299,6 +1608,52 @@ i2c_command_passthru_protect(struct host_cmd_handler_args *args)
 DECLARE_HOST_COMMAND(EC_CMD_I2C_PASSTHRU_PROTECT, i2c_command_passthru_protect,
 		     EC_VER_MASK(0));
 
+#ifdef CONFIG_I2C_STATS
+static enum ec_status i2c_command_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_i2c_stats *p = args->params;
+	struct ec_response_i2c_stats *r = args->response;
+	const void *entries;
+	int size, total, count;
+
+	switch (p->type) {
+	case EC_I2C_STATS_PORTS:
+		entries = port_stats;
+		size = sizeof(port_stats[0]);
+		total = ARRAY_SIZE(port_stats);
+		break;
+	case EC_I2C_STATS_DEVICES:
+		entries = dev_stats;
+		size = sizeof(dev_stats[0]);
+		total = dev_stats_count;
+		break;
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	count = MIN(total - MIN(p->index, total),
+		    (args->response_max - sizeof(*r)) / size);
+	r->count = count;
+	r->total = total;
+	memcpy(r->entries, (const uint8_t *)entries + p->index * size,
+	       count * size);
+	args->response_size = sizeof(*r) + count * size;
+
+	if (p->flags & EC_I2C_STATS_FLAG_CLEAR) {
+		interrupt_disable();
+		memset(port_stats, 0, sizeof(port_stats));
+		dev_stats_count = 0;
+		interrupt_enable();
+	}
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_I2C_STATS, i2c_command_stats, EC_VER_MASK(0));
+#endif
+
 /*****************************************************************************/
 /* Console commands */
 
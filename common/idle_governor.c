@@ -0,0 +1,96 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Low power idle governor and statistics */
+
+#include "common.h"
+#include "host_command.h"
+#include "idle_governor.h"
+#include "timer.h"
+#include "util.h"
+
+/* Number of recent idle periods the prediction is based on */
+#define IDLE_HISTORY 8
+/* Longer idle periods count as this, to keep the history sum in range */
+#define IDLE_HISTORY_MAX_US SECOND
+
+static uint32_t history[IDLE_HISTORY];
+static uint32_t history_sum;
+static int history_idx;
+
+static struct ec_response_idle_stats stats;
+static uint16_t wake_irq[CONFIG_IRQ_COUNT];
+static uint64_t stats_start;
+
+int idle_governor_allow_deep(uint32_t timer_us)
+{
+	if (timer_us < CONFIG_IDLE_GOVERNOR_DEEP_MIN_US)
+		return 0;
+
+	if (history_sum / IDLE_HISTORY < CONFIG_IDLE_GOVERNOR_DEEP_MIN_US) {
+		stats.predicted_short++;
+		return 0;
+	}
+
+	return 1;
+}
+
+void idle_governor_record(enum ec_idle_state state, uint32_t slept_us,
+			  int wake_irq_num)
+{
+	uint32_t h = MIN(slept_us, IDLE_HISTORY_MAX_US);
+
+	stats.count[state]++;
+	stats.residency_us[state] += slept_us;
+	if (state == EC_IDLE_STATE_DEEP_SLEEP &&
+	    slept_us < CONFIG_IDLE_GOVERNOR_DEEP_MIN_US)
+		stats.deep_too_short++;
+
+	if (wake_irq_num >= 0 && wake_irq_num < ARRAY_SIZE(wake_irq) &&
+	    wake_irq[wake_irq_num] != UINT16_MAX)
+		wake_irq[wake_irq_num]++;
+
+	history_sum += h - history[history_idx];
+	history[history_idx] = h;
+	history_idx = (history_idx + 1) % IDLE_HISTORY;
+}
+
+/*
+ * The statistics are only written by the idle task with interrupts disabled,
+ * which no task can preempt, so they are read here without locking.
+ */
+static enum ec_status
+host_command_idle_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_idle_stats *p = args->params;
+	struct ec_response_idle_stats *r = args->response;
+	int num;
+
+	if (p->irq_offset > ARRAY_SIZE(wake_irq))
+		return EC_RES_INVALID_PARAM;
+
+	num = (args->response_max - sizeof(*r)) / sizeof(r->wake_irq[0]);
+	num = MIN(num, ARRAY_SIZE(wake_irq) - p->irq_offset);
+
+	*r = stats;
+	r->time_us = get_time().val - stats_start;
+	r->deep_min_us = CONFIG_IDLE_GOVERNOR_DEEP_MIN_US;
+	r->irq_count = ARRAY_SIZE(wake_irq);
+	r->irq_offset = p->irq_offset;
+	r->num = num;
+	memcpy(r->wake_irq, wake_irq + p->irq_offset,
+	       num * sizeof(r->wake_irq[0]));
+
+	if (p->flags & EC_IDLE_STATS_CLEAR) {
+		memset(&stats, 0, sizeof(stats));
+		memset(wake_irq, 0, sizeof(wake_irq));
+		stats_start = get_time().val;
+	}
+
+	args->response_size = sizeof(*r) + num * sizeof(r->wake_irq[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_IDLE_STATS, host_command_idle_stats,
+		     EC_VER_MASK(0));
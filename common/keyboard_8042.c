@@ -16,6 +16,7 @@
 #include "keyboard_8042_sharedlib.h"
 #include "keyboard_config.h"
 #include "keyboard_protocol.h"
+#include "keyboard_scan.h"
 #include "lightbar.h"
 #include "lpc.h"
 #include "power_button.h"
@@ -24,6 +25,7 @@
 #include "system.h"
 #include "task.h"
 #include "timer.h"
+#include "tracepoint.h"
 #include "util.h"
 
 /* Console output macros */
@@ -83,7 +85,15 @@ struct data_byte {
 	uint8_t byte;
 };
 
-static struct queue const to_host = QUEUE_NULL(16, struct data_byte);
+static struct queue const to_host =
+	QUEUE_NULL(CONFIG_8042_TO_HOST_SIZE, struct data_byte);
+
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+/* to_host positions of the first and last bytes of the traced keystroke */
+static size_t latency_first, latency_last;
+/* The last byte is in the output buffer, waiting for the host to read it */
+static int latency_wait_read;
+#endif
 
 /* Queue command/data from the host */
 enum {
@@ -272,11 +282,22 @@ static void i8042_send_to_host(int len, const uint8_t *bytes,
 	/* Enqueue output data if there's space */
 	mutex_lock(&to_host_mutex);
 
-	for (i = 0; i < len; i++)
+	for (i = 0; i < len; i++) {
 		kblog_put(chan == CHAN_AUX ? 'a' : 's', bytes[i]);
+		TRACEPOINT(EC_TRACEPOINT_8042_TO_HOST, bytes[i],
+			   chan == CHAN_AUX);
+	}
 
 	if (queue_space(&to_host) >= len) {
 		kblog_put('t', to_host.state->tail);
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+		if (chan == CHAN_KBD &&
+		    keyboard_latency_mark(KB_LATENCY_QUEUED)) {
+			latency_first = to_host.state->tail;
+			latency_last = latency_first + len - 1;
+			latency_wait_read = 0;
+		}
+#endif
 		for (i = 0; i < len; i++) {
 			data.chan = chan;
 			data.byte = bytes[i];
@@ -406,7 +427,11 @@ void keyboard_clear_buffer(void)
 	CPRINTS("KB Clear Buffer");
 	mutex_lock(&to_host_mutex);
 	kblog_put('x', queue_count(&to_host));
+	if (IS_ENABLED(CONFIG_8042_REFILL_FROM_ISR))
+		interrupt_disable();
 	queue_init(&to_host);
+	if (IS_ENABLED(CONFIG_8042_REFILL_FROM_ISR))
+		interrupt_enable();
 	mutex_unlock(&to_host_mutex);
 	lpc_keyboard_clear_buffer();
 }
@@ -892,6 +917,80 @@ static void i8042_handle_from_host(void)
 	}
 }
 
+/**
+ * Move the next byte of to_host to the output buffer, if it is empty.
+ *
+ * With CONFIG_8042_REFILL_FROM_ISR, the output buffer empty interrupt calls
+ * this too, so it must not be preempted between checking the output buffer
+ * and filling it.
+ *
+ * @param from_isr	Called by the output buffer empty interrupt.
+ * @return EC_SUCCESS if a byte was sent, EC_ERROR_BUSY if the output buffer
+ * is full, EC_ERROR_NOT_HANDLED if there is nothing to send or the byte must
+ * be sent by the task.
+ */
+static int send_next_to_host(int from_isr)
+{
+	struct data_byte entry;
+	size_t sent;
+	int rv = EC_SUCCESS;
+
+	if (IS_ENABLED(CONFIG_8042_REFILL_FROM_ISR) && !from_isr)
+		interrupt_disable();
+
+	sent = to_host.state->head;
+	if (queue_is_empty(&to_host)) {
+		rv = EC_ERROR_NOT_HANDLED;
+	} else if (lpc_keyboard_has_char()) {
+		rv = EC_ERROR_BUSY;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	} else if (from_isr && (latency_wait_read ||
+				sent - latency_first <=
+				latency_last - latency_first)) {
+		/* The task timestamps the traced keystroke. */
+		rv = EC_ERROR_NOT_HANDLED;
+#endif
+	} else {
+		/* Get a char from buffer. */
+		kblog_put('n', sent);
+		queue_remove_unit(&to_host, &entry);
+
+		/* Write to host. */
+		if (entry.chan == CHAN_AUX &&
+		    IS_ENABLED(CONFIG_8042_AUX)) {
+			kblog_put('A', entry.byte);
+			lpc_aux_put_char(entry.byte, i8042_aux_irq_enabled);
+		} else {
+			kblog_put('K', entry.byte);
+			lpc_keyboard_put_char(entry.byte,
+					      i8042_keyboard_irq_enabled);
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_8042_REFILL_FROM_ISR) && !from_isr)
+		interrupt_enable();
+
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	if (rv == EC_SUCCESS && !from_isr) {
+		if (sent == latency_first)
+			keyboard_latency_mark(KB_LATENCY_NOTIFIED);
+		if (sent == latency_last)
+			latency_wait_read = 1;
+	}
+#endif
+	return rv;
+}
+
+void keyboard_host_read(void)
+{
+	if (IS_ENABLED(CONFIG_8042_REFILL_FROM_ISR) &&
+	    send_next_to_host(1) == EC_SUCCESS)
+		return;
+
+	/* Let the task send the rest, or the traced keystroke */
+	task_wake(TASK_ID_KEYPROTO);
+}
+
 void keyboard_protocol_task(void *u)
 {
 	int wait = -1;
@@ -905,7 +1004,13 @@ void keyboard_protocol_task(void *u)
 
 		while (1) {
 			timestamp_t t = get_time();
-			struct data_byte entry;
+			int rv;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+			if (latency_wait_read && !lpc_keyboard_has_char()) {
+				keyboard_latency_mark(KB_LATENCY_READ);
+				latency_wait_read = 0;
+			}
+#endif
 #ifdef CONFIG_KEYBOARD_DEBUG
 			cflush();
 #endif
@@ -930,12 +1035,15 @@ void keyboard_protocol_task(void *u)
 			/* Handle command/data write from host */
 			i8042_handle_from_host();
 
+			/* Send data to host, if it is ready for it */
+			rv = send_next_to_host(0);
+
 			/* Check if we have data to send to host */
-			if (queue_is_empty(&to_host))
+			if (rv == EC_ERROR_NOT_HANDLED)
 				break;
 
 			/* Handle data waiting for host */
-			if (lpc_keyboard_has_char()) {
+			if (rv == EC_ERROR_BUSY) {
 				/* If interrupts disabled, nothing we can do */
 				if (!i8042_keyboard_irq_enabled &&
 				    !i8042_aux_irq_enabled)
@@ -958,21 +1066,6 @@ void keyboard_protocol_task(void *u)
 				break;
 			}
 
-			/* Get a char from buffer. */
-			kblog_put('n', to_host.state->head);
-			queue_remove_unit(&to_host, &entry);
-
-			/* Write to host. */
-			if (entry.chan == CHAN_AUX &&
-			    IS_ENABLED(CONFIG_8042_AUX)) {
-				kblog_put('A', entry.byte);
-				lpc_aux_put_char(entry.byte,
-						 i8042_aux_irq_enabled);
-			} else {
-				kblog_put('K', entry.byte);
-				lpc_keyboard_put_char(
-					entry.byte, i8042_keyboard_irq_enabled);
-			}
 			retries = 0;
 		}
 	}
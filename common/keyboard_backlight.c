@@ -81,7 +81,7 @@ static void keyboard_backlight_init(void)
 	if (kblight_init())
 		CPRINTS("kblight init failed");
 }
-DECLARE_HOOK(HOOK_INIT, keyboard_backlight_init, HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_INIT_LATE, keyboard_backlight_init, HOOK_PRIO_DEFAULT);
 
 static void kblight_suspend(void)
 {
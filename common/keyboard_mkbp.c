@@ -56,6 +56,10 @@ static uint32_t fifo_start;	/* first entry */
 static uint32_t fifo_end;	/* last entry */
 static uint32_t fifo_entries;	/* number of existing entries */
 static struct ec_response_get_next_event fifo[FIFO_DEPTH];
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+/* FIFO entry of the keystroke traced by keyboard_latency_mark() */
+static uint32_t latency_entry = FIFO_DEPTH;
+#endif
 /*
  * Mutex for critical sections of mkbp_fifo_add(), which is called
  * from various tasks.
@@ -191,6 +195,9 @@ void keyboard_clear_buffer(void)
 		++new_fifo_entries;
 	}
 	fifo_entries = new_fifo_entries;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	latency_entry = FIFO_DEPTH;
+#endif
 
 	mutex_unlock(&fifo_remove_mutex);
 	mutex_unlock(&fifo_add_mutex);
@@ -213,6 +220,9 @@ void mkbp_clear_fifo(void)
 	fifo_end = 0;
 	/* This assignment is safe since both mutexes are held. */
 	fifo_entries = 0;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	latency_entry = FIFO_DEPTH;
+#endif
 	for (i = 0; i < FIFO_DEPTH; i++)
 		memset(&fifo[i], 0, sizeof(struct ec_response_get_next_event));
 
@@ -249,6 +259,11 @@ test_mockable int mkbp_fifo_add(uint8_t event_type, const uint8_t *buffp)
 	size = get_data_size(event_type);
 	fifo[fifo_end].event_type = event_type;
 	memcpy(&fifo[fifo_end].data, buffp, size);
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	if (event_type == EC_MKBP_EVENT_KEY_MATRIX &&
+	    keyboard_latency_mark(KB_LATENCY_QUEUED))
+		latency_entry = fifo_end;
+#endif
 	fifo_end = (fifo_end + 1) % FIFO_DEPTH;
 	deprecated_atomic_add(&fifo_entries, 1);
 
@@ -259,6 +274,8 @@ test_mockable int mkbp_fifo_add(uint8_t event_type, const uint8_t *buffp)
 	 */
 	if (!mkbp_send_event(event_type) && fifo_entries == 1)
 		fifo_remove(NULL);
+	else if (event_type == EC_MKBP_EVENT_KEY_MATRIX)
+		keyboard_latency_mark(KB_LATENCY_NOTIFIED);
 
 	mutex_unlock(&fifo_add_mutex);
 	return EC_SUCCESS;
@@ -384,6 +401,12 @@ static int get_next_event(uint8_t *out, enum ec_mkbp_event evt)
 		return -EC_ERROR_BUSY;
 	}
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	if (fifo_start == latency_entry) {
+		keyboard_latency_mark(KB_LATENCY_READ);
+		latency_entry = FIFO_DEPTH;
+	}
+#endif
 	fifo_remove(out);
 
 	/* Keep sending events if FIFO is not empty */
@@ -133,6 +133,90 @@ static volatile int kbd_polls;
 /* If true, we'll force a keyboard poll */
 static volatile int force_poll;
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+/* Bucket n counts latencies below LATENCY_HIST_BASE_US << n */
+#define LATENCY_HIST_BASE_US 100
+
+struct latency_stats {
+	uint32_t count;
+	uint32_t max_us;
+	uint32_t hist[EC_KB_LATENCY_HIST_BUCKETS];
+};
+static struct latency_stats __bss_slow
+	latency_stats[EC_KB_LATENCY_STAGE_COUNT];
+
+/* Last keystroke reported: last point it reached, when, and when it changed */
+static struct {
+	enum keyboard_latency_point point;
+	uint32_t point_us;
+	uint32_t change_us;
+} latency_trace = { .point = KB_LATENCY_READ };
+
+static struct mutex latency_mutex;
+
+/* Time the task woke up to poll, for the first scan of the poll */
+static uint32_t __bss_slow latency_wake_us;
+
+/* Each point but the first ends the stage of the same number. */
+BUILD_ASSERT((int)KB_LATENCY_QUEUED == (int)EC_KB_LATENCY_QUEUE);
+BUILD_ASSERT((int)KB_LATENCY_NOTIFIED == (int)EC_KB_LATENCY_NOTIFY);
+BUILD_ASSERT((int)KB_LATENCY_READ == (int)EC_KB_LATENCY_READ);
+
+static void record_latency(enum ec_keyboard_latency_stage stage,
+			   uint32_t latency)
+{
+	struct latency_stats *stats = &latency_stats[stage];
+	int bucket = 0;
+
+	while (bucket < EC_KB_LATENCY_HIST_BUCKETS - 1 &&
+	       latency >= (LATENCY_HIST_BASE_US << bucket))
+		bucket++;
+
+	stats->count++;
+	stats->hist[bucket]++;
+	if (latency > stats->max_us)
+		stats->max_us = latency;
+}
+
+/**
+ * Start tracing a keystroke reported by the scan.
+ *
+ * @param change_us	When the scan saw the key change.
+ */
+static void keyboard_latency_start(uint32_t change_us)
+{
+	uint32_t now = get_time().le.lo;
+
+	mutex_lock(&latency_mutex);
+	latency_trace.point = KB_LATENCY_REPORTED;
+	latency_trace.point_us = now;
+	latency_trace.change_us = change_us;
+	record_latency(EC_KB_LATENCY_SCAN, now - change_us);
+	mutex_unlock(&latency_mutex);
+}
+
+int keyboard_latency_mark(enum keyboard_latency_point point)
+{
+	uint32_t now = get_time().le.lo;
+	int marked = 0;
+
+	mutex_lock(&latency_mutex);
+	if (latency_trace.point + 1 == point) {
+		record_latency((enum ec_keyboard_latency_stage)point,
+			       now - latency_trace.point_us);
+		if (point == KB_LATENCY_READ)
+			record_latency(EC_KB_LATENCY_TOTAL,
+				       now - latency_trace.change_us);
+		latency_trace.point = point;
+		latency_trace.point_us = now;
+		marked = 1;
+	}
+	mutex_unlock(&latency_mutex);
+
+	return marked;
+}
+#endif /* CONFIG_KEYBOARD_LATENCY_STATS */
+
 static int keyboard_scan_is_enabled(void)
 {
 	/* NOTE: this is just an instantaneous glimpse of the variable. */
@@ -250,6 +334,28 @@ static int read_matrix(uint8_t *state)
 {
 	int c;
 	int pressed = 0;
+	uint8_t row_union[KEYBOARD_ROWS];
+	uint8_t rows;
+
+	/*
+	 * 0. Skip the column by column scan if no key is down at all. The
+	 * simulated keyscan sequence needs every column to be read.
+	 */
+	if (!IS_ENABLED(CONFIG_KEYBOARD_TEST) && keyboard_scan_is_enabled()) {
+		keyboard_raw_drive_column(KEYBOARD_COLUMN_ALL);
+		udelay(keyscan_config.output_settle_us);
+		rows = keyboard_raw_read_rows();
+		keyboard_raw_drive_column(KEYBOARD_COLUMN_NONE);
+
+		if (!rows) {
+			for (c = 0; c < keyboard_cols; c++) {
+				state[c] = simulated_key[c];
+				pressed |= state[c];
+				state[c] &= keyscan_config.actual_key_mask[c];
+			}
+			return pressed ? 1 : 0;
+		}
+	}
 
 	/* 1. Read input pins */
 	for (c = 0; c < keyboard_cols; c++) {
@@ -277,29 +383,30 @@ static int read_matrix(uint8_t *state)
 			state[c] = keyscan_seq_get_scan(c, state[c]);
 	}
 
-	/* 2. Detect transitional ghost */
-	for (c = 0; c < keyboard_cols; c++) {
-		int c2;
-
-		for (c2 = 0; c2 < c; c2++) {
-			/*
-			 * If two columns shares at least one key but their
-			 * states are different, maybe the state changed between
-			 * two "keyboard_raw_read_rows"s. If this happened,
-			 * update both columns to the union of them.
-			 *
-			 * Note that in theory we need to rescan from col 0 if
-			 * anything is updated, to make sure the newly added
-			 * bits does not introduce more inconsistency.
-			 * Let's ignore this rare case for now.
-			 */
-			if ((state[c] & state[c2]) && (state[c] != state[c2])) {
-				uint8_t merged = state[c] | state[c2];
+	/*
+	 * 2. Detect transitional ghost
+	 *
+	 * If two columns shares at least one key but their states are
+	 * different, maybe the state changed between two
+	 * "keyboard_raw_read_rows"s. If this happened, update both columns to
+	 * the union of them.
+	 *
+	 * Rather than comparing every pair of columns, gather for each row the
+	 * union of the columns having a key down on it, then merge into each
+	 * column the unions of its rows.
+	 *
+	 * Note that in theory we need to merge again if anything is updated,
+	 * to make sure the newly added bits does not introduce more
+	 * inconsistency. Let's ignore this rare case for now.
+	 */
+	memset(row_union, 0, sizeof(row_union));
+	for (c = 0; c < keyboard_cols; c++)
+		for (rows = state[c]; rows; rows &= rows - 1)
+			row_union[__builtin_ctz(rows)] |= state[c];
 
-				state[c] = state[c2] = merged;
-			}
-		}
-	}
+	for (c = 0; c < keyboard_cols; c++)
+		for (rows = state[c]; rows; rows &= rows - 1)
+			state[c] |= row_union[__builtin_ctz(rows)];
 
 	/* 3. Fix result */
 	for (c = 0; c < keyboard_cols; c++) {
@@ -476,24 +583,23 @@ static int check_runtime_keys(const uint8_t *state)
  */
 static int has_ghosting(const uint8_t *state)
 {
-	int c, c2;
+	/* Rows of the keys down in the columns sharing a key on each row */
+	uint8_t row_union[KEYBOARD_ROWS] = { 0 };
+	uint8_t rows;
+	int c;
 
 	for (c = 0; c < keyboard_cols; c++) {
-		if (!state[c])
-			continue;
-
-		for (c2 = c + 1; c2 < keyboard_cols; c2++) {
-			/*
-			 * A little bit of cleverness here.  Ghosting happens
-			 * if 2 columns share at least 2 keys.  So we OR the
-			 * columns together and then see if more than one bit
-			 * is set.  x&(x-1) is non-zero only if x has more than
-			 * one bit set.
-			 */
-			uint8_t common = state[c] & state[c2];
+		/*
+		 * Ghosting happens if 2 columns share at least 2 keys, so a
+		 * column ghosts with a previous one when, on one of its rows,
+		 * the previous columns have another of its keys down.
+		 */
+		for (rows = state[c]; rows; rows &= rows - 1) {
+			int r = __builtin_ctz(rows);
 
-			if (common & (common - 1))
+			if (row_union[r] & state[c] & ~BIT(r))
 				return 1;
+			row_union[r] |= state[c];
 		}
 	}
 
@@ -514,6 +620,9 @@ static int check_keys_changed(uint8_t *state)
 	int any_change = 0;
 	static uint8_t __bss_slow new_state[KEYBOARD_COLS_MAX];
 	uint32_t tnow = get_time().le.lo;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	uint32_t change_us;
+#endif
 
 	/* Save the current scan time */
 	if (++scan_time_index >= SCAN_TIME_COUNT)
@@ -527,6 +636,12 @@ static int check_keys_changed(uint8_t *state)
 	if (has_ghosting(new_state))
 		return any_pressed;
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	/* The first scan of a poll sees keys changed when the task woke up. */
+	change_us = latency_wake_us ? latency_wake_us : tnow;
+	latency_wake_us = 0;
+#endif
+
 	/* Check for changes between previous scan and this one */
 	for (c = 0; c < keyboard_cols; c++) {
 		int diff;
@@ -542,6 +657,21 @@ static int check_keys_changed(uint8_t *state)
 			debouncing[c] &= ~BIT(i);
 		}
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+		/* Changes of keys still debouncing are bounces. */
+		diff = (new_state[c] ^ state[c]) & debouncing[c];
+		if (diff) {
+			mutex_lock(&latency_mutex);
+			for (i = 0; i < KEYBOARD_ROWS; i++) {
+				if (!(diff & BIT(i)))
+					continue;
+				record_latency(EC_KB_LATENCY_BOUNCE, tnow -
+					scan_time[scan_edge_index[c][i]]);
+			}
+			mutex_unlock(&latency_mutex);
+		}
+#endif
+
 		/* Recognize change in state, unless debounce in effect. */
 		diff = (new_state[c] ^ state[c]) & ~debouncing[c];
 		if (!diff)
@@ -551,6 +681,9 @@ static int check_keys_changed(uint8_t *state)
 				continue;
 			scan_edge_index[c][i] = scan_time_index;
 			any_change = 1;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+			keyboard_latency_start(change_us);
+#endif
 
 			/* Inform keyboard module if scanning is enabled */
 			if (keyboard_scan_is_enabled()) {
@@ -829,6 +962,9 @@ void keyboard_scan_task(void *u)
 
 		/* We're about to poll, so any existing forces are fulfilled */
 		force_poll = 0;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+		latency_wake_us = get_time().le.lo;
+#endif
 
 		/* Enter polling mode */
 		CPRINTS5("KB poll");
@@ -1003,6 +1139,39 @@ DECLARE_HOST_COMMAND(EC_CMD_KEYBOARD_FACTORY_TEST,
 		     EC_VER_MASK(0));
 #endif
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+static enum ec_status
+keyboard_latency_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_keyboard_latency_stats *p = args->params;
+	struct ec_response_keyboard_latency_stats *r = args->response;
+	const struct latency_stats *stats;
+
+	if (p->stage >= EC_KB_LATENCY_STAGE_COUNT)
+		return EC_RES_INVALID_PARAM;
+
+	stats = &latency_stats[p->stage];
+	r->stage_count = EC_KB_LATENCY_STAGE_COUNT;
+	r->reserved = 0;
+	r->hist_base_us = LATENCY_HIST_BASE_US;
+
+	mutex_lock(&latency_mutex);
+	r->count = stats->count;
+	r->max_us = stats->max_us;
+	memcpy(r->hist, stats->hist, sizeof(r->hist));
+	if (p->flags & EC_KB_LATENCY_RESET)
+		memset(latency_stats, 0, sizeof(latency_stats));
+	mutex_unlock(&latency_mutex);
+
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_KEYBOARD_LATENCY_STATS,
+		     keyboard_latency_stats,
+		     EC_VER_MASK(0));
+#endif
+
 #ifdef CONFIG_KEYBOARD_LANGUAGE_ID
 int keyboard_get_keyboard_id(void)
 {
@@ -97,6 +97,7 @@
 #include "ec_commands.h"
 #include "i2c.h"
 #include "lb_common.h"
+#include "task.h"
 #include "util.h"
 
 /* Console output macros */
@@ -226,6 +227,49 @@ static inline uint8_t scale(int val, int max)
 	return scale_abs((val * brightness)/255, max);
 }
 
+/*
+ * The ISC registers are double-buffered: LED changes go to isc_regs[] and are
+ * sent by lb_flush(), one burst write per controller for all the registers
+ * which changed, rather than one write per color.
+ */
+#define ISC_FIRST 0x15
+#define ISC_COUNT 6
+static uint8_t isc_regs[ARRAY_SIZE(i2c_addr_flags)][ISC_COUNT];
+static uint8_t isc_dirty[ARRAY_SIZE(i2c_addr_flags)];
+
+/* Buffer one ISC register value. Must be called with the I2C port locked. */
+static void set_isc(int ctrl, uint8_t reg, uint8_t val)
+{
+	int i = reg - ISC_FIRST;
+
+	if (isc_regs[ctrl][i] != val) {
+		isc_regs[ctrl][i] = val;
+		isc_dirty[ctrl] |= BIT(i);
+	}
+}
+
+/* Send the changed ISC registers. Must be called with the I2C port locked. */
+static void flush_isc(void)
+{
+	uint8_t buf[ISC_COUNT + 1];
+	int ctrl, first, last;
+
+	for (ctrl = 0; ctrl < ARRAY_SIZE(i2c_addr_flags); ctrl++) {
+		if (!isc_dirty[ctrl])
+			continue;
+
+		/* The register address auto-increments over the burst. */
+		first = __builtin_ctz(isc_dirty[ctrl]);
+		last = 31 - __builtin_clz(isc_dirty[ctrl]);
+		buf[0] = ISC_FIRST + first;
+		memcpy(buf + 1, &isc_regs[ctrl][first], last - first + 1);
+		i2c_xfer_unlocked(I2C_PORT_LIGHTBAR, i2c_addr_flags[ctrl],
+				  buf, last - first + 2, 0, 0,
+				  I2C_XFER_SINGLE);
+		isc_dirty[ctrl] = 0;
+	}
+}
+
 /* Helper function to set one LED color and remember it for later */
 static void setrgb(int led, int red, int green, int blue)
 {
@@ -235,10 +279,15 @@ static void setrgb(int led, int red, int green, int blue)
 	current[led][2] = blue;
 	ctrl = led_to_ctrl[led];
 	bank = led_to_isc[led];
+	set_isc(ctrl, bank, scale(blue, MAX_BLUE));
+	set_isc(ctrl, bank+1, scale(red, MAX_RED));
+	set_isc(ctrl, bank+2, scale(green, MAX_GREEN));
+}
+
+void lb_flush(void)
+{
 	i2c_lock(I2C_PORT_LIGHTBAR, 1);
-	controller_write(ctrl, bank, scale(blue, MAX_BLUE));
-	controller_write(ctrl, bank+1, scale(red, MAX_RED));
-	controller_write(ctrl, bank+2, scale(green, MAX_GREEN));
+	flush_isc();
 	i2c_lock(I2C_PORT_LIGHTBAR, 0);
 }
 
@@ -247,11 +296,18 @@ static void setrgb(int led, int red, int green, int blue)
 void lb_set_rgb(unsigned int led, int red, int green, int blue)
 {
 	int i;
+
+	i2c_lock(I2C_PORT_LIGHTBAR, 1);
 	if (led >= NUM_LEDS)
 		for (i = 0; i < NUM_LEDS; i++)
 			setrgb(i, red, green, blue);
 	else
 		setrgb(led, red, green, blue);
+
+	/* The lightbar task flushes a whole frame at once. */
+	if (task_get_current() != TASK_ID_LIGHTBAR)
+		flush_isc();
+	i2c_lock(I2C_PORT_LIGHTBAR, 0);
 }
 
 /* Get current LED values, if the LED number is in range. */
@@ -272,9 +328,12 @@ void lb_set_brightness(unsigned int newval)
 {
 	int i;
 	CPRINTS("LB_bright 0x%02x", newval);
+	i2c_lock(I2C_PORT_LIGHTBAR, 1);
 	brightness = newval;
 	for (i = 0; i < NUM_LEDS; i++)
 		setrgb(i, current[i][0], current[i][1], current[i][2]);
+	flush_isc();
+	i2c_lock(I2C_PORT_LIGHTBAR, 0);
 }
 
 /* Get current display brightness (0-255) */
@@ -300,6 +359,9 @@ void lb_init(int use_lock)
 	}
 	CPRINTF("]\n");
 	memset(current, 0, sizeof(current));
+	/* init_vals cleared the ISC registers. */
+	memset(isc_regs, 0, sizeof(isc_regs));
+	memset(isc_dirty, 0, sizeof(isc_dirty));
 }
 
 /* Just go into standby mode. No register values should change. */
@@ -317,6 +379,7 @@ void lb_on(void)
 {
 	CPRINTS("LB_on");
 	i2c_lock(I2C_PORT_LIGHTBAR, 1);
+	flush_isc();
 	controller_write(0, 0x01, 0x20);
 	controller_write(1, 0x01, 0x20);
 	i2c_lock(I2C_PORT_LIGHTBAR, 0);
@@ -351,7 +414,15 @@ void lb_hc_cmd_dump(struct ec_response_lightbar *out)
 /* Helper for host command to write controller registers directly */
 void lb_hc_cmd_reg(const struct ec_params_lightbar *in)
 {
+	int ctrl = in->reg.ctrl % ARRAY_SIZE(i2c_addr_flags);
+	int i = in->reg.reg - ISC_FIRST;
+
 	i2c_lock(I2C_PORT_LIGHTBAR, 1);
-	controller_write(in->reg.ctrl, in->reg.reg, in->reg.value);
+	controller_write(ctrl, in->reg.reg, in->reg.value);
+	/* Keep the buffered ISC registers in sync with the controller. */
+	if (i >= 0 && i < ISC_COUNT) {
+		isc_regs[ctrl][i] = in->reg.value;
+		isc_dirty[ctrl] &= ~BIT(i);
+	}
 	i2c_lock(I2C_PORT_LIGHTBAR, 0);
 }
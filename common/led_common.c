@@ -31,12 +31,18 @@ static int led_is_supported(enum ec_led_id led_id)
 	return ((1 << (int)led_id) & supported_leds);
 }
 
+__overridable void led_auto_control_changed(enum ec_led_id led_id)
+{
+}
+
 void led_auto_control(enum ec_led_id led_id, int enable)
 {
 	if (enable)
 		led_auto_control_flags |= LED_AUTO_CONTROL_FLAG(led_id);
 	else
 		led_auto_control_flags &= ~LED_AUTO_CONTROL_FLAG(led_id);
+
+	led_auto_control_changed(led_id);
 }
 
 int led_auto_control_is_enabled(enum ec_led_id led_id)
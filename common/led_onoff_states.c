@@ -14,9 +14,25 @@
 #include "hooks.h"
 #include "led_common.h"
 #include "led_onoff_states.h"
+#include "timer.h"
 
 #define CPRINTS(format, args...) cprints(CC_GPIO, format, ## args)
 
+/*
+ * The LEDs aren't polled: they are recomputed when something that decides
+ * their state changes, and otherwise led_update() only runs again when a
+ * blinking LED is due to change phase.
+ */
+static void led_update(void);
+DECLARE_DEFERRED(led_update);
+
+/* Where an LED is in its state table */
+struct led_engine {
+	int state;		/* State shown, or the table size before any */
+	int phase;		/* Phase of that state being shown */
+	timestamp_t phase_end;	/* When that phase ends, if the state blinks */
+};
+
 static enum led_states led_get_state(void)
 {
 	int  charge_lvl;
@@ -83,56 +99,85 @@ static enum led_states led_get_state(void)
 	return new_state;
 }
 
-static void led_update_battery(void)
+/*
+ * Move an LED to desired_state, or keep its current state if desired_state
+ * isn't valid, and catch up with any phase change that is due.
+ *
+ * @param led		LED to update.
+ * @param desired_state	State the LED should be in.
+ * @param num_states	Number of states in table.
+ * @param table		State table of the LED.
+ * @param now		Current time.
+ * @param next		If the state blinks and its phase ends before *next,
+ *			set to the end of the phase.
+ * @return		Color the LED should show, or LED_OFF if its state
+ *			isn't defined.
+ */
+static enum ec_led_colors led_engine_step(
+		struct led_engine *led, int desired_state, int num_states,
+		const struct led_descriptor (*table)[LED_NUM_PHASES],
+		timestamp_t now, timestamp_t *next)
 {
-	static uint8_t ticks, period;
-	static int led_state = LED_NUM_STATES;
-	int phase;
-	enum led_states desired_state = led_get_state();
-
-	/*
-	 * We always need to check the current state since the value could
-	 * have been manually overwritten. If we're in a new valid state,
-	 * update our ticks and period info. If our new state isn't defined,
-	 * continue using the previous one.
-	 */
-	if (desired_state != led_state && desired_state < LED_NUM_STATES) {
-		/*
-		 * Allow optional CHARGING_FULL_S5 state to fall back to
-		 * FULL_CHARGE if not defined.
-		 */
-		if (desired_state == STATE_CHARGING_FULL_S5 &&
-		    led_bat_state_table[desired_state][LED_PHASE_0].time == 0)
-			desired_state = STATE_CHARGING_FULL_CHARGE;
-
-		/* State is changing */
-		led_state = desired_state;
-		/* Reset ticks and period when state changes */
-		ticks = 0;
-
-		period = led_bat_state_table[led_state][LED_PHASE_0].time +
-			led_bat_state_table[led_state][LED_PHASE_1].time;
+	const struct led_descriptor *phases;
 
+	if (desired_state != led->state && desired_state < num_states) {
+		/* State is changing, start it from its first phase */
+		led->state = desired_state;
+		phases = table[led->state];
+		if (phases[LED_PHASE_0].time == 0 &&
+		    phases[LED_PHASE_1].time == 0)
+			CPRINTS("Undefined LED behavior for state %d,"
+				"turning off LED", led->state);
+		led->phase = phases[LED_PHASE_0].time ? LED_PHASE_0 :
+							LED_PHASE_1;
+		led->phase_end.val = now.val +
+			phases[led->phase].time * HOOK_TICK_INTERVAL;
 	}
 
 	/* If this state is undefined, turn the LED off */
-	if (period == 0) {
-		CPRINTS("Undefined LED behavior for battery state %d,"
-			"turning off LED", led_state);
-		led_set_color_battery(LED_OFF);
-		return;
+	if (led->state >= num_states)
+		return LED_OFF;
+	phases = table[led->state];
+	if (phases[LED_PHASE_0].time == 0 && phases[LED_PHASE_1].time == 0)
+		return LED_OFF;
+
+	/* A state with only one phase doesn't blink */
+	if (phases[LED_PHASE_0].time == 0 || phases[LED_PHASE_1].time == 0)
+		return phases[led->phase].color;
+
+	while (timestamp_expired(led->phase_end, &now)) {
+		led->phase = (led->phase == LED_PHASE_0) ? LED_PHASE_1 :
+							   LED_PHASE_0;
+		led->phase_end.val +=
+			phases[led->phase].time * HOOK_TICK_INTERVAL;
 	}
 
+	if (led->phase_end.val < next->val)
+		*next = led->phase_end;
+
+	return phases[led->phase].color;
+}
+
+static void led_update_battery(timestamp_t now, timestamp_t *next)
+{
+	static struct led_engine led = { .state = LED_NUM_STATES };
+	enum led_states desired_state = led_get_state();
+
 	/*
-	 * Determine which phase of the state table to use. The phase is
-	 * determined if it falls within first phase time duration.
+	 * Allow optional CHARGING_FULL_S5 state to fall back to
+	 * FULL_CHARGE if not defined.
 	 */
-	phase = ticks < led_bat_state_table[led_state][LED_PHASE_0].time ?
-									0 : 1;
-	ticks = (ticks + 1) % period;
+	if (desired_state == STATE_CHARGING_FULL_S5 &&
+	    led_bat_state_table[desired_state][LED_PHASE_0].time == 0)
+		desired_state = STATE_CHARGING_FULL_CHARGE;
 
-	/* Set the color for the given state and phase */
-	led_set_color_battery(led_bat_state_table[led_state][phase].color);
+	/*
+	 * We always need to set the color since the LED could have been
+	 * manually overwritten.
+	 */
+	led_set_color_battery(led_engine_step(&led, desired_state,
+					      LED_NUM_STATES,
+					      led_bat_state_table, now, next));
 }
 
 #ifdef CONFIG_LED_POWER_LED
@@ -152,47 +197,13 @@ static enum pwr_led_states pwr_led_get_state(void)
 	return PWR_LED_NUM_STATES;
 }
 
-static void led_update_power(void)
+static void led_update_power(timestamp_t now, timestamp_t *next)
 {
-	static uint8_t ticks, period;
-	static enum pwr_led_states led_state = PWR_LED_NUM_STATES;
-	int phase;
-	enum pwr_led_states desired_state = pwr_led_get_state();
-
-	/*
-	 * If we're in a new valid state, update our ticks and period info.
-	 * Otherwise, continue to use old state
-	 */
-	if (desired_state != led_state && desired_state < PWR_LED_NUM_STATES) {
-		/* State is changing */
-		led_state = desired_state;
-		/* Reset ticks and period when state changes */
-		ticks = 0;
-
-		period = led_pwr_state_table[led_state][LED_PHASE_0].time +
-			led_pwr_state_table[led_state][LED_PHASE_1].time;
-
-	}
-
-	/* If this state is undefined, turn the LED off */
-	if (period == 0) {
-		CPRINTS("Undefined LED behavior for power state %d,"
-			"turning off LED", led_state);
-		led_set_color_power(LED_OFF);
-		return;
-	}
-
-	/*
-	 * Determine which phase of the state table to use. The phase is
-	 * determined if it falls within first phase time duration.
-	 */
-	phase = ticks < led_pwr_state_table[led_state][LED_PHASE_0].time ?
-									0 : 1;
-	ticks = (ticks + 1) % period;
-
-	/* Set the color for the given state and phase */
-	led_set_color_power(led_pwr_state_table[led_state][phase].color);
+	static struct led_engine led = { .state = PWR_LED_NUM_STATES };
 
+	led_set_color_power(led_engine_step(&led, pwr_led_get_state(),
+					    PWR_LED_NUM_STATES,
+					    led_pwr_state_table, now, next));
 }
 #endif
 
@@ -208,21 +219,54 @@ static void led_init(void)
 		led_set_color_power(LED_OFF);
 #endif /* CONFIG_LED_POWER_LED */
 
+	hook_call_deferred(&led_update_data, 0);
 }
 DECLARE_HOOK(HOOK_INIT, led_init, HOOK_PRIO_DEFAULT);
 
-/* Called by hook task every hook tick (200 msec) */
+/* Called by hook task when an LED may need to change */
 static void led_update(void)
 {
+	timestamp_t now = get_time();
+	timestamp_t next = { .val = UINT64_MAX };
+
 	/*
 	 * If battery LED is enabled, set its state based on our power and
 	 * charge
 	 */
 	if (led_auto_control_is_enabled(EC_LED_ID_BATTERY_LED))
-		led_update_battery();
+		led_update_battery(now, &next);
 #ifdef CONFIG_LED_POWER_LED
 	if (led_auto_control_is_enabled(EC_LED_ID_POWER_LED))
-		led_update_power();
+		led_update_power(now, &next);
 #endif
+
+	/* Sleep until the next blink, if any LED is blinking */
+	if (next.val != UINT64_MAX)
+		hook_call_deferred(&led_update_data, next.val - now.val);
+}
+
+static void led_charge_changed(void)
+{
+	hook_call_deferred(&led_update_data, 0);
+}
+DECLARE_HOOK(HOOK_AC_CHANGE, led_charge_changed, HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_BATTERY_SOC_CHANGE, led_charge_changed, HOOK_PRIO_DEFAULT);
+
+/*
+ * Chipset hooks run before the power state machine settles in the new
+ * state, and chipset_in_state() doesn't match transitional states, so give
+ * it a tick before looking.
+ */
+static void led_chipset_changed(void)
+{
+	hook_call_deferred(&led_update_data, HOOK_TICK_INTERVAL);
+}
+DECLARE_HOOK(HOOK_CHIPSET_STARTUP, led_chipset_changed, HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_CHIPSET_RESUME, led_chipset_changed, HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_CHIPSET_SUSPEND, led_chipset_changed, HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_CHIPSET_SHUTDOWN, led_chipset_changed, HOOK_PRIO_DEFAULT);
+
+__override void led_auto_control_changed(enum ec_led_id led_id)
+{
+	hook_call_deferred(&led_update_data, 0);
 }
-DECLARE_HOOK(HOOK_TICK, led_update, HOOK_PRIO_DEFAULT);
@@ -135,15 +135,18 @@ DECLARE_HOOK(HOOK_INIT, init_leds_off, HOOK_PRIO_INIT_PWM + 1);
 static uint8_t pulse_period;
 static uint8_t pulse_ontime;
 static enum ec_led_colors pulse_color;
+static uint8_t pulse_tick;
+/* The pulse deferred is armed for the next edge of the pattern. */
+static uint8_t pulse_armed;
 static void update_leds(void);
 static void pulse_leds_deferred(void);
 DECLARE_DEFERRED(pulse_leds_deferred);
 static void pulse_leds_deferred(void)
 {
-	static uint8_t tick_count;
+	int ticks;
 
 	if (!led_is_pulsing) {
-		tick_count = 0;
+		pulse_armed = 0;
 		/*
 		 * Since we're not pulsing anymore, turn the colors off in case
 		 * we were in the "on" time.
@@ -154,20 +157,41 @@ static void pulse_leds_deferred(void)
 		return;
 	}
 
-	if (tick_count < pulse_ontime)
+	/*
+	 * Only wake up at the edges of the pattern: the LED holds its duty
+	 * between them, so there is nothing to do on the ticks in between.
+	 */
+	if (pulse_tick < pulse_ontime) {
 		set_led_color(pulse_color);
-	else
+		ticks = pulse_ontime - pulse_tick;
+		pulse_tick = pulse_ontime;
+	} else {
 		set_led_color(-1);
+		ticks = pulse_period - pulse_tick;
+		pulse_tick = 0;
+	}
 
-	tick_count = (tick_count + 1) % pulse_period;
-	hook_call_deferred(&pulse_leds_deferred_data, PULSE_TICK);
+	pulse_armed = 1;
+	hook_call_deferred(&pulse_leds_deferred_data,
+			   MAX(ticks, 1) * PULSE_TICK);
 }
 
 static void pulse_leds(enum ec_led_colors color, int ontime, int period)
 {
+	/*
+	 * update_leds() asks for the same pattern on every tick; keep the
+	 * running one in phase instead of restarting it.
+	 */
+	if (pulse_armed && pulse_color == color && pulse_ontime == ontime &&
+	    pulse_period == period) {
+		led_is_pulsing = 1;
+		return;
+	}
+
 	pulse_color = color;
 	pulse_ontime = ontime;
 	pulse_period = period;
+	pulse_tick = 0;
 	led_is_pulsing = 1;
 	pulse_leds_deferred();
 }
@@ -423,8 +423,10 @@ static uint32_t pending_msg;
 /* Interruptible delay. */
 #define WAIT_OR_RET(A)                                                         \
 	do {                                                                   \
-		uint32_t msg = task_wait_event(A);                             \
-		uint32_t p_msg = pending_msg;                                  \
+		uint32_t msg, p_msg;                                           \
+		lb_flush();                                                    \
+		msg = task_wait_event(A);                                      \
+		p_msg = pending_msg;                                           \
 		if (msg & PENDING_MSG && p_msg != st.cur_seq)                  \
 			return p_msg;                                          \
 	} while (0)
@@ -1612,6 +1614,7 @@ void lightbar_task(void)
 			st.cur_seq, lightbar_cmds[st.cur_seq].string,
 			st.prev_seq, lightbar_cmds[st.prev_seq].string);
 		next_seq = lightbar_cmds[st.cur_seq].sequence();
+		lb_flush();
 		if (next_seq) {
 			CPRINTS("LB cur_seq %d %s returned pending msg %d %s",
 				st.cur_seq, lightbar_cmds[st.cur_seq].string,
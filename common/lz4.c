@@ -0,0 +1,190 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* LZ4 block compression */
+
+#include "common.h"
+#include "lz4.h"
+#include "util.h"
+
+/*
+ * Block format: a sequence is a token byte holding the literal length in
+ * its high nibble and the match length minus LZ4_MIN_MATCH in its low
+ * nibble, the literals, a 16-bit little-endian match offset and the match.
+ * Nibbles of 15 are extended by bytes added to them, until one is not 255.
+ * The last sequence only has literals.
+ */
+#define LZ4_MIN_MATCH 4
+/* The last 5 bytes are always literals ... */
+#define LZ4_LAST_LITERALS 5
+/* ... and the last match starts at least 12 bytes before the end. */
+#define LZ4_MF_LIMIT 12
+#define LZ4_MAX_OFFSET 0xffff
+
+/* Hash table of recent positions; 64 entries keep it small on the stack. */
+#define LZ4_HASH_BITS 6
+
+static inline int lz4_hash(const uint8_t *p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return (v * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+/* Size of the extension bytes needed for a length field of len */
+static inline int lz4_length_size(int len)
+{
+	return len >= 15 ? (len - 15) / 255 + 1 : 0;
+}
+
+static uint8_t *lz4_put_length(uint8_t *op, int len)
+{
+	for (len -= 15; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = len;
+	return op;
+}
+
+/* Add a sequence of literals followed by a match of match_len, if any */
+static uint8_t *lz4_put_sequence(uint8_t *op, const uint8_t *oend,
+				 const uint8_t *lit, int lit_len,
+				 int offset, int match_len)
+{
+	int size = 1 + lz4_length_size(lit_len) + lit_len;
+	uint8_t *token = op;
+
+	if (match_len)
+		size += 2 + lz4_length_size(match_len - LZ4_MIN_MATCH);
+	if (size > oend - op)
+		return NULL;
+
+	*op++ = MIN(lit_len, 15) << 4;
+	if (lit_len >= 15)
+		op = lz4_put_length(op, lit_len);
+	memcpy(op, lit, lit_len);
+	op += lit_len;
+
+	if (!match_len)
+		return op;
+
+	*op++ = offset & 0xff;
+	*op++ = offset >> 8;
+	match_len -= LZ4_MIN_MATCH;
+	*token |= MIN(match_len, 15);
+	if (match_len >= 15)
+		op = lz4_put_length(op, match_len);
+
+	return op;
+}
+
+int lz4_compress(const uint8_t *src, int src_size, uint8_t *dst, int dst_size)
+{
+	uint16_t table[1 << LZ4_HASH_BITS];
+	const uint8_t *oend = dst + dst_size;
+	uint8_t *op = dst;
+	int anchor = 0;
+	int ip = 0;
+
+	if (src_size > LZ4_MAX_INPUT_SIZE)
+		return -EC_ERROR_INVAL;
+
+	memset(table, 0, sizeof(table));
+
+	while (ip + LZ4_MF_LIMIT < src_size) {
+		int h = lz4_hash(src + ip);
+		int ref = table[h];
+		int len;
+
+		table[h] = ip;
+		if (ref >= ip || ip - ref > LZ4_MAX_OFFSET ||
+		    memcmp(src + ref, src + ip, LZ4_MIN_MATCH)) {
+			ip++;
+			continue;
+		}
+
+		len = LZ4_MIN_MATCH;
+		while (ip + len < src_size - LZ4_LAST_LITERALS &&
+		       src[ip + len] == src[ref + len])
+			len++;
+
+		op = lz4_put_sequence(op, oend, src + anchor, ip - anchor,
+				      ip - ref, len);
+		if (!op)
+			return -EC_ERROR_OVERFLOW;
+
+		ip += len;
+		anchor = ip;
+	}
+
+	op = lz4_put_sequence(op, oend, src + anchor, src_size - anchor, 0, 0);
+	if (!op)
+		return -EC_ERROR_OVERFLOW;
+
+	return op - dst;
+}
+
+/* Read the extension bytes of a length field, or -1 if src ends first */
+static int lz4_get_length(const uint8_t *src, int src_size, int *ip, int len)
+{
+	int b;
+
+	if (len != 15)
+		return len;
+
+	do {
+		if (*ip >= src_size)
+			return -1;
+		b = src[(*ip)++];
+		len += b;
+	} while (b == 255);
+
+	return len;
+}
+
+int lz4_decompress(const uint8_t *src, int src_size, uint8_t *dst,
+		   int dst_size)
+{
+	int ip = 0;
+	int op = 0;
+
+	while (ip < src_size) {
+		int token = src[ip++];
+		int len, offset;
+
+		len = lz4_get_length(src, src_size, &ip, token >> 4);
+		if (len < 0 || len > src_size - ip)
+			return -EC_ERROR_INVAL;
+		if (len > dst_size - op)
+			return -EC_ERROR_OVERFLOW;
+		memcpy(dst + op, src + ip, len);
+		ip += len;
+		op += len;
+
+		/* The last sequence has no match */
+		if (ip == src_size)
+			break;
+
+		if (src_size - ip < 2)
+			return -EC_ERROR_INVAL;
+		offset = src[ip] | src[ip + 1] << 8;
+		ip += 2;
+		if (!offset || offset > op)
+			return -EC_ERROR_INVAL;
+
+		len = lz4_get_length(src, src_size, &ip, token & 0xf);
+		if (len < 0)
+			return -EC_ERROR_INVAL;
+		len += LZ4_MIN_MATCH;
+		if (len > dst_size - op)
+			return -EC_ERROR_OVERFLOW;
+
+		/* Byte by byte, since the match may overlap its output */
+		for (; len; len--, op++)
+			dst[op] = dst[op - offset];
+	}
+
+	return op;
+}
@@ -6,6 +6,7 @@
  */
 
 #include "board_config.h"
+#include "boot_trace.h"
 #include "button.h"
 #include "chipset.h"
 #include "clock.h"
@@ -14,6 +15,7 @@
 #include "cpu.h"
 #include "dma.h"
 #include "eeprom.h"
+#include "event_log.h"
 #include "flash.h"
 #include "gpio.h"
 #include "hooks.h"
@@ -59,6 +61,13 @@ test_mockable __keep int main(void)
 			init_reset_log();
 	}
 
+	/*
+	 * Like the tx buffer, the event log needs to be checked before
+	 * anything is logged.
+	 */
+	if (IS_ENABLED(CONFIG_EVENT_LOG_PRESERVED))
+		log_init();
+
 	/*
 	 * Pre-initialization (pre-verified boot) stage.  Initialization at
 	 * this level should do as little as possible, because verified boot
@@ -123,6 +132,7 @@ test_mockable __keep int main(void)
 	 * timer init() must be before uart_init().
 	 */
 	timer_init();
+	boot_trace(EC_BOOT_TRACE_TIMER_INIT, 0);
 
 	/* Main initialization stage.  Modules may enable interrupts here. */
 	cpu_init();
@@ -134,6 +144,7 @@ test_mockable __keep int main(void)
 
 	/* Initialize UART.  Console output functions may now be used. */
 	uart_init();
+	boot_trace(EC_BOOT_TRACE_UART_INIT, 0);
 
 	/* We wait to report the failure until here where we have console. */
 	if (mpu_pre_init_rv != EC_SUCCESS)
@@ -216,6 +227,8 @@ test_mockable __keep int main(void)
 	 */
 	if (IS_ENABLED(CONFIG_CHIPSET_HAS_PLATFORM_PMIC_RESET))
 		chipset_handle_reboot();
+
+	boot_trace(EC_BOOT_TRACE_VERIFY_START, 0);
 	/*
 	 * For RO, it behaves as follows:
 	 *   In recovery, it enables PD communication and returns.
@@ -223,6 +236,7 @@ test_mockable __keep int main(void)
 	 * For RW, it returns immediately.
 	 */
 	vboot_main();
+	boot_trace(EC_BOOT_TRACE_VERIFY_DONE, 0);
 #elif defined(CONFIG_RWSIG) && !defined(HAS_TASK_RWSIG)
 	/*
 	 * Check the RW firmware signature and jump to it if it is good.
@@ -240,8 +254,10 @@ test_mockable __keep int main(void)
 		else
 #endif
 		{
+			boot_trace(EC_BOOT_TRACE_VERIFY_START, 0);
 			if (rwsig_check_signature())
 				rwsig_jump_now();
+			boot_trace(EC_BOOT_TRACE_VERIFY_DONE, 0);
 		}
 	}
 #endif  /* !CONFIG_VBOOT_EFS && CONFIG_RWSIG && !HAS_TASK_RWSIG */
@@ -252,6 +268,7 @@ test_mockable __keep int main(void)
 	 * the majority of the time.
 	 */
 	CPRINTS("Inits done");
+	boot_trace(EC_BOOT_TRACE_TASK_START, 0);
 
 	/* Launch task scheduling (never returns) */
 	return task_start();
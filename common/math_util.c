@@ -68,6 +68,66 @@ fp_t arc_cos(fp_t x)
 	return 0;
 }
 
+/* Number of CORDIC iterations: the last one rotates by less than 0.002 deg. */
+#define CORDIC_ITERATIONS 16
+
+/* atan(2^-i) in degrees. */
+static const fp_t cordic_atan_lut[CORDIC_ITERATIONS] = {
+	FLOAT_TO_FP(45.000000), FLOAT_TO_FP(26.565051), FLOAT_TO_FP(14.036243),
+	FLOAT_TO_FP( 7.125016), FLOAT_TO_FP( 3.576334), FLOAT_TO_FP( 1.789911),
+	FLOAT_TO_FP( 0.895174), FLOAT_TO_FP( 0.447614), FLOAT_TO_FP( 0.223811),
+	FLOAT_TO_FP( 0.111906), FLOAT_TO_FP( 0.055953), FLOAT_TO_FP( 0.027976),
+	FLOAT_TO_FP( 0.013988), FLOAT_TO_FP( 0.006994), FLOAT_TO_FP( 0.003497),
+	FLOAT_TO_FP( 0.001749),
+};
+
+fp_t arc_tan2(int y, int x)
+{
+	fp_t angle = FLOAT_TO_FP(0);
+	int m, shift, i;
+
+	/* Rotate by 180 degrees to the right half plane. */
+	if (x < 0) {
+		angle = y >= 0 ? FLOAT_TO_FP(180) : FLOAT_TO_FP(-180);
+		x = -x;
+		y = -y;
+	}
+
+	/*
+	 * Scale the vector up for precision, but keep it below 2^29: the
+	 * rotations grow its magnitude by up to sqrt(2) * 1.647.
+	 */
+	if (y == 0)
+		return angle;
+	m = MAX(x, ABS(y));
+	shift = 28 - __fls(m);
+	if (shift > 0) {
+		x <<= shift;
+		y <<= shift;
+	} else {
+		x >>= -shift;
+		y >>= -shift;
+	}
+
+	/* Rotate the vector onto the x axis, summing the rotations. */
+	for (i = 0; i < CORDIC_ITERATIONS; i++) {
+		const int dx = y >> i;
+		const int dy = x >> i;
+
+		if (y > 0) {
+			x += dx;
+			y -= dy;
+			angle += cordic_atan_lut[i];
+		} else {
+			x -= dx;
+			y += dy;
+			angle -= cordic_atan_lut[i];
+		}
+	}
+
+	return angle;
+}
+
 /**
  * Integer square root.
  */
@@ -83,12 +143,6 @@ static inline int int_sqrtf(fp_inter_t x)
 {
 	return sqrtf(x);
 }
-
-/* If the platform support FPU, just return sqrtf. */
-fp_t fp_sqrtf(fp_t x)
-{
-	return sqrtf(x);
-}
 #else
 static int int_sqrtf(fp_inter_t x)
 {
@@ -63,6 +63,10 @@ struct mkbp_state {
 	 * get_next_events in order to limit the retry logic.
 	 */
 	uint8_t failed_attempts;
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+	/* State of the batching window, see enum batch_state */
+	uint8_t batch;
+#endif
 };
 
 static struct mkbp_state state;
@@ -76,6 +80,26 @@ static uint32_t mkbp_event_wake_mask = CONFIG_MKBP_EVENT_WAKEUP_MASK;
 static uint32_t mkbp_host_event_wake_mask = CONFIG_MKBP_HOST_EVENT_WAKEUP_MASK;
 #endif /* CONFIG_MKBP_HOST_EVENT_WAKEUP_MASK */
 
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+/*
+ * Events which are not urgent enough to interrupt the AP on their own: they
+ * are held for up to mkbp_event_batch_us, so that the events coming in the
+ * meantime are delivered with the same interrupt. Any other event ends the
+ * window early.
+ */
+static uint32_t mkbp_event_batch_mask = CONFIG_MKBP_EVENT_BATCH_MASK;
+static int mkbp_event_batch_us = CONFIG_MKBP_EVENT_BATCH_MS * MSEC;
+BUILD_ASSERT(!(CONFIG_MKBP_EVENT_BATCH_MASK & BIT(EC_MKBP_EVENT_KEY_MATRIX)));
+
+enum batch_state {
+	BATCH_IDLE,
+	/* Batchable events are held until the window closes */
+	BATCH_OPEN,
+	/* The window closed, the held events must be sent */
+	BATCH_CLOSED,
+};
+#endif /* CONFIG_MKBP_EVENT_BATCH_MASK */
+
 #if defined(CONFIG_MKBP_USE_GPIO) || \
 	defined(CONFIG_MKBP_USE_GPIO_AND_HOST_EVENT)
 static int mkbp_set_host_active_via_gpio(int active, uint32_t *timestamp)
@@ -189,11 +213,39 @@ static inline int host_is_sleeping(void)
 static void force_mkbp_if_events(void);
 DECLARE_DEFERRED(force_mkbp_if_events);
 
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+static void close_mkbp_batch(void);
+DECLARE_DEFERRED(close_mkbp_batch);
+
+/*
+ * Check if the pending events can wait for the batching window to close,
+ * opening the window if needed.
+ *
+ * This can only be called when the state.lock mutex is held.
+ *
+ * @param open_window	Set to 1 if the window must be opened.
+ * @return 1 if the interrupt must be held back.
+ */
+static int hold_mkbp_batch(int *open_window)
+{
+	if (state.events & ~mkbp_event_batch_mask ||
+	    state.batch == BATCH_CLOSED || !mkbp_event_batch_us)
+		return 0;
+
+	if (state.batch == BATCH_IDLE) {
+		state.batch = BATCH_OPEN;
+		*open_window = 1;
+	}
+	return 1;
+}
+#endif /* CONFIG_MKBP_EVENT_BATCH_MASK */
+
 static void activate_mkbp_with_events(uint32_t events_to_add)
 {
 	int interrupt_id = -1;
 	int skip_interrupt = 0;
 	int rv, schedule_deferred = 0;
+	int __maybe_unused open_window = 0;
 
 #ifdef CONFIG_MKBP_HOST_EVENT_WAKEUP_MASK
 	/*
@@ -222,13 +274,28 @@ static void activate_mkbp_with_events(uint32_t events_to_add)
 	skip_interrupt = skip_interrupt &&
 			 !(state.events & BIT(EC_MKBP_EVENT_KEY_MATRIX));
 
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+	if (state.events && state.interrupt == INTERRUPT_INACTIVE &&
+	    !skip_interrupt)
+		skip_interrupt = hold_mkbp_batch(&open_window);
+#endif
+
 	if (state.events && state.interrupt == INTERRUPT_INACTIVE &&
 	    !skip_interrupt) {
 		state.interrupt = INTERRUPT_INACTIVE_TO_ACTIVE;
 		interrupt_id = ++state.interrupt_id;
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+		/* Held events, if any, go out with this interrupt. */
+		state.batch = BATCH_IDLE;
+#endif
 	}
 	mutex_unlock(&state.lock);
 
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+	if (open_window)
+		hook_call_deferred(&close_mkbp_batch_data, mkbp_event_batch_us);
+#endif
+
 	/* If we don't need to send an interrupt we are done */
 	if (interrupt_id < 0)
 		return;
@@ -280,6 +347,24 @@ static void force_mkbp_if_events(void)
 	activate_mkbp_with_events(0);
 }
 
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+/* Send the events held since the batching window opened. */
+static void close_mkbp_batch(void)
+{
+	int closed = 0;
+
+	mutex_lock(&state.lock);
+	if (state.batch == BATCH_OPEN) {
+		state.batch = state.events ? BATCH_CLOSED : BATCH_IDLE;
+		closed = 1;
+	}
+	mutex_unlock(&state.lock);
+
+	if (closed)
+		activate_mkbp_with_events(0);
+}
+#endif /* CONFIG_MKBP_EVENT_BATCH_MASK */
+
 test_mockable int mkbp_send_event(uint8_t event_type)
 {
 	activate_mkbp_with_events(BIT(event_type));
@@ -296,6 +381,9 @@ static int set_inactive_if_no_events(void)
 	if (interrupt_cleared) {
 		state.interrupt = INTERRUPT_INACTIVE;
 		state.failed_attempts = 0;
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+		state.batch = BATCH_IDLE;
+#endif
 		/* Only simple tasks (i.e. gpio set or no-op) allowed here */
 		mkbp_set_host_active(0, NULL);
 	}
@@ -510,3 +598,36 @@ DECLARE_CONSOLE_COMMAND(mkbpwakemask, command_mkbp_wake_mask,
 			"[event | hostevent] [new_mask]",
 			"Show or set MKBP event/hostevent wake mask");
 #endif /* CONFIG_MKBP_(HOST)?EVENT_WAKEUP_MASK */
+
+#ifdef CONFIG_MKBP_EVENT_BATCH_MASK
+static int command_mkbp_batch(int argc, char **argv)
+{
+	char *e;
+
+	if (argc > 3)
+		return EC_ERROR_PARAM_COUNT;
+
+	if (argc > 1) {
+		uint32_t mask = strtoul(argv[1], &e, 0);
+
+		if (*e || mask & BIT(EC_MKBP_EVENT_KEY_MATRIX))
+			return EC_ERROR_PARAM1;
+		mkbp_event_batch_mask = mask;
+	}
+
+	if (argc > 2) {
+		int ms = strtoi(argv[2], &e, 0);
+
+		if (*e || ms < 0 || ms > 1000)
+			return EC_ERROR_PARAM2;
+		mkbp_event_batch_us = ms * MSEC;
+	}
+
+	ccprintf("MKBP batch mask: 0x%08x, window: %d ms\n",
+		 mkbp_event_batch_mask, mkbp_event_batch_us / MSEC);
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(mkbpbatch, command_mkbp_batch,
+			"[mask [window_ms]]",
+			"Show or set the MKBP events batched and their window");
+#endif /* CONFIG_MKBP_EVENT_BATCH_MASK */
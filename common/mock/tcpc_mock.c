@@ -140,6 +140,9 @@ static int mock_get_message_raw(int port, uint32_t *payload, int *head)
 static int mock_transmit(int port, enum tcpm_transmit_type type,
 			 uint16_t header, const uint32_t *data)
 {
+	if (mock_tcpc.callbacks.transmit)
+		return mock_tcpc.callbacks.transmit(port, type, header, data);
+
 	return EC_SUCCESS;
 }
 
@@ -47,3 +47,17 @@ void dpm_set_mode_exit_request(int port)
 void dpm_run(int port)
 {
 }
+
+bool dpm_is_idle(int port)
+{
+	return true;
+}
+
+bool dpm_discovery_cache_restore(int port, enum tcpm_transmit_type type)
+{
+	return false;
+}
+
+void dpm_discovery_cache_save(int port, enum tcpm_transmit_type type)
+{
+}
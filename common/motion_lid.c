@@ -88,13 +88,18 @@ static intv3_t smoothed_base, smoothed_lid;
  * frame before calculating lid angle).
  */
 #ifdef CONFIG_ACCEL_STD_REF_FRAME_OLD
-static const intv3_t hinge_axis = { 0, 1, 0};
 #define HINGE_AXIS Y
 #else
-static const intv3_t hinge_axis = { 1, 0, 0};
 #define HINGE_AXIS X
 #endif
 
+/*
+ * Axes of the plane perpendicular to the hinge, oriented so that angles in
+ * this plane are counterclockwise around the hinge axis.
+ */
+#define HINGE_PLANE_U ((HINGE_AXIS + 1) % 3)
+#define HINGE_PLANE_V ((HINGE_AXIS + 2) % 3)
+
 static const struct motion_sensor_t * const accel_base =
 	&motion_sensors[CONFIG_LID_ANGLE_SENSOR_BASE];
 static const struct motion_sensor_t * const accel_lid =
@@ -266,6 +271,25 @@ static void motion_lid_set_dptf_profile(int reliable)
 
 #endif /* CONFIG_DPTF_MULTI_PROFILE && CONFIG_DPTF_MOTION_LID_NO_GMR_SENSOR */
 
+/**
+ * Project a vector on the hinge hyperplan.
+ *
+ * The projection is scaled down below 2^15 if needed, so that products of
+ * two projections and their sums fit in 32 bits.
+ *
+ * @param v    Vector to project
+ * @param proj Components of the projection along HINGE_PLANE_U and
+ *             HINGE_PLANE_V
+ */
+static void hinge_plane_projection(const intv3_t v, int proj[2])
+{
+	int m = MAX(ABS(v[HINGE_PLANE_U]), ABS(v[HINGE_PLANE_V]));
+	int shift = m >= BIT(15) ? __fls(m) - 14 : 0;
+
+	proj[0] = v[HINGE_PLANE_U] >> shift;
+	proj[1] = v[HINGE_PLANE_V] >> shift;
+}
+
 /**
  * Calculate the lid angle using two acceleration vectors, one recorded in
  * the base and one in the lid.
@@ -279,7 +303,8 @@ static void motion_lid_set_dptf_profile(int reliable)
 static int calculate_lid_angle(const intv3_t base, const intv3_t lid,
 			       int *lid_angle)
 {
-	intv3_t cross, proj_lid, proj_base, scaled_base, scaled_lid;
+	intv3_t scaled_base, scaled_lid;
+	int proj_base[2], proj_lid[2];
 	fp_t lid_to_base_fp, smoothed_ratio;
 	int base_magnitude2, lid_magnitude2, largest_hinge_accel;
 	int reliable = 1, i;
@@ -371,23 +396,21 @@ static int calculate_lid_angle(const intv3_t base, const intv3_t lid,
 	}
 
 	/* Project vectors on the hinge hyperplan, putting smooth ones aside. */
-	memcpy(proj_base, smoothed_base, sizeof(intv3_t));
-	memcpy(proj_lid, smoothed_lid, sizeof(intv3_t));
-	proj_base[HINGE_AXIS] = 0;
-	proj_lid[HINGE_AXIS] = 0;
-
-	/* Calculate the clockwise angle */
-	lid_to_base_fp = arc_cos(cosine_of_angle_diff(proj_base, proj_lid));
-	cross_product(proj_base, proj_lid, cross);
+	hinge_plane_projection(smoothed_base, proj_base);
+	hinge_plane_projection(smoothed_lid, proj_lid);
 
 	/*
-	 * If the dot product of this cross product is normal, it means that
-	 * the shortest angle between |base| and |lid| was counterclockwise
-	 * with respect to the surface represented by |hinge_axis| and this
-	 * angle must be reversed.
+	 * Calculate the clockwise angle: the angle from |base| to |lid| is the
+	 * angle of (cos, sin) scaled by |base| * |lid|, which are their dot
+	 * product and the dot product of their cross product with the hinge
+	 * axis.
 	 */
-	if (dot_product(cross, hinge_axis) > 0)
-		lid_to_base_fp = FLOAT_TO_FP(360) - lid_to_base_fp;
+	lid_to_base_fp = -arc_tan2(proj_base[0] * proj_lid[1] -
+				   proj_base[1] * proj_lid[0],
+				   proj_base[0] * proj_lid[0] +
+				   proj_base[1] * proj_lid[1]);
+	if (lid_to_base_fp < 0)
+		lid_to_base_fp += FLOAT_TO_FP(360);
 
 #ifndef CONFIG_ACCEL_STD_REF_FRAME_OLD
 	/*
@@ -478,6 +501,74 @@ int motion_lid_get_angle(void)
 		return LID_ANGLE_UNRELIABLE;
 }
 
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+/*
+ * Number of consecutive reliable lid angles, all within LID_STEADY_DELTA
+ * degrees of the first one, before the lid angle sensors are left to watch
+ * for a tilt on their own. The tablet mode debounce is over by then.
+ */
+#define LID_STEADY_COUNT 8
+#define LID_STEADY_DELTA 5
+BUILD_ASSERT(LID_STEADY_COUNT > TABLET_MODE_DEBOUNCE_COUNT);
+
+static int lid_offloaded;
+static int lid_steady_cnt;
+
+int motion_lid_offloaded(const struct motion_sensor_t *s)
+{
+	return lid_offloaded && (s == accel_base || s == accel_lid);
+}
+
+static int motion_lid_can_offload(const struct motion_sensor_t *s)
+{
+	/* No point in offloading a sensor the AP pulls data from. */
+	return s->drv->set_tilt_detection != NULL &&
+	       BASE_ODR(s->config[SENSOR_CONFIG_AP].odr) == 0;
+}
+
+static void motion_lid_set_offload(int enable)
+{
+	lid_offloaded = enable;
+	lid_steady_cnt = 0;
+	accel_base->drv->set_tilt_detection(accel_base, enable);
+	accel_lid->drv->set_tilt_detection(accel_lid, enable);
+	motion_sense_request_data_rate(BIT(CONFIG_LID_ANGLE_SENSOR_BASE) |
+				       BIT(CONFIG_LID_ANGLE_SENSOR_LID));
+}
+
+void motion_lid_wake(void)
+{
+	if (lid_offloaded)
+		motion_lid_set_offload(0);
+}
+
+/*
+ * Offload the lid angle sensors once the lid angle is steady, wake them up
+ * as soon as it is not, if the AP is pulling data from them.
+ */
+static void motion_lid_check_steady(int reliable, int angle)
+{
+	static int steady_angle;
+
+	if (reliable && ABS(angle - steady_angle) <= LID_STEADY_DELTA) {
+		if (lid_steady_cnt < LID_STEADY_COUNT)
+			lid_steady_cnt++;
+	} else {
+		lid_steady_cnt = 0;
+		steady_angle = angle;
+	}
+
+	if (lid_offloaded) {
+		if (lid_steady_cnt == 0)
+			motion_lid_wake();
+	} else if (lid_steady_cnt == LID_STEADY_COUNT &&
+		   motion_lid_can_offload(accel_base) &&
+		   motion_lid_can_offload(accel_lid)) {
+		motion_lid_set_offload(1);
+	}
+}
+#endif /* CONFIG_LID_ANGLE_OFFLOAD */
+
 /*
  * Calculate lid angle and massage the results
  */
@@ -488,6 +579,10 @@ void motion_lid_calc(void)
 			accel_base->xyz, accel_lid->xyz,
 			&lid_angle_deg);
 
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	motion_lid_check_steady(lid_angle_is_reliable, lid_angle_deg);
+#endif
+
 #ifdef CONFIG_LID_ANGLE_UPDATE
 	lid_angle_update(motion_lid_get_angle());
 #endif
@@ -127,6 +127,43 @@ static enum sensor_config motion_sense_get_ec_config(void)
 		return SENSOR_CONFIG_MAX;
 	}
 }
+#ifdef CONFIG_MOTION_SENSE_ALIGN_COLLECTION
+/*
+ * Return the first collection time of a forced mode sensor after now. If
+ * another forced mode sensor has a rate multiple or divisor of its own, align
+ * it on that sensor schedule.
+ */
+static uint32_t motion_sense_next_collection(
+		const struct motion_sensor_t *sensor, uint32_t now)
+{
+	const uint32_t rate = sensor->collection_rate;
+	int i;
+
+	if (!motion_sensor_in_forced_mode(sensor) || rate == 0)
+		return now + rate;
+
+	for (i = 0; i < motion_sensor_count; i++) {
+		const struct motion_sensor_t *s = &motion_sensors[i];
+		int32_t diff;
+
+		if (s == sensor || !motion_sensor_in_forced_mode(s) ||
+		    s->state != SENSOR_INITIALIZED || s->collection_rate == 0)
+			continue;
+		if (MAX(rate, s->collection_rate) %
+		    MIN(rate, s->collection_rate))
+			continue;
+
+		diff = time_until(now, s->next_collection);
+		if (diff < 0)
+			continue;
+		/* The schedules of both sensors meet at s->next_collection. */
+		diff %= rate;
+		return now + (diff ? diff : rate);
+	}
+	return now + rate;
+}
+#endif
+
 /* motion_sense_set_data_rate
  *
  * Set the sensor data rate. It is altered when the AP change the data
@@ -147,6 +184,11 @@ int motion_sense_set_data_rate(struct motion_sensor_t *sensor)
 	/* check if the EC set the sensor ODR at a higher frequency */
 	config_id = motion_sense_get_ec_config();
 	ec_odr_mhz = BASE_ODR(sensor->config[config_id].odr);
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	/* The sensor tilt engine watches the lid on behalf of the EC. */
+	if (motion_lid_offloaded(sensor))
+		ec_odr_mhz = 0;
+#endif
 	if (ec_odr_mhz > ap_odr_mhz) {
 		odr = ec_odr_mhz;
 	} else {
@@ -185,7 +227,12 @@ int motion_sense_set_data_rate(struct motion_sensor_t *sensor)
 	 */
 	odr = sensor->drv->get_data_rate(sensor);
 	sensor->collection_rate = odr > 0 ? SECOND * 1000 / odr : 0;
+#ifdef CONFIG_MOTION_SENSE_ALIGN_COLLECTION
+	sensor->next_collection = motion_sense_next_collection(sensor,
+							       ts.le.lo);
+#else
 	sensor->next_collection = ts.le.lo + sensor->collection_rate;
+#endif
 	sensor->oversampling = 0;
 	mutex_unlock(&g_sensor_mutex);
 #ifdef CONFIG_BODY_DETECTION
@@ -324,6 +371,12 @@ static void motion_sense_set_motion_intervals(void)
 	task_wake(TASK_ID_MOTIONSENSE);
 }
 
+void motion_sense_request_data_rate(uint32_t sensors)
+{
+	deprecated_atomic_or(&odr_event_required, sensors);
+	task_set_event(TASK_ID_MOTIONSENSE, TASK_EVENT_MOTION_ODR_CHANGE, 0);
+}
+
 static inline int motion_sense_init(struct motion_sensor_t *sensor)
 {
 	int ret, cnt = 3;
@@ -339,6 +392,11 @@ static inline int motion_sense_init(struct motion_sensor_t *sensor)
 		sensor->state = SENSOR_INIT_ERROR;
 	} else {
 		sensor->state = SENSOR_INITIALIZED;
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+		/* The tilt engine was lost with the sensor state. */
+		if (motion_lid_offloaded(sensor))
+			motion_lid_wake();
+#endif
 		motion_sense_set_data_rate(sensor);
 	}
 
@@ -575,6 +633,7 @@ static inline void update_sense_data(uint8_t *lpc_status, int *psample_id)
 	for (i = 0; i < EC_ALS_ENTRIES && i < ALS_COUNT; i++)
 		lpc_als[i] = ec_motion_sensor_clamp_u16(
 				motion_als_sensors[i]->xyz[X]);
+	host_memmap_changed(EC_MEMMAP_ALS, EC_ALS_ENTRIES * sizeof(*lpc_als));
 #endif
 
 	/*
@@ -584,6 +643,10 @@ static inline void update_sense_data(uint8_t *lpc_status, int *psample_id)
 	*psample_id = (*psample_id + 1) &
 			EC_MEMMAP_ACC_STATUS_SAMPLE_ID_MASK;
 	*lpc_status = EC_MEMMAP_ACC_STATUS_PRESENCE_BIT | *psample_id;
+	/* Status, lid angle and 3 sensors of X, Y, Z data */
+	host_memmap_changed(EC_MEMMAP_ACC_STATUS,
+			    EC_MEMMAP_ACC_DATA + (1 + 3 * 3) * sizeof(*lpc_data) -
+			    EC_MEMMAP_ACC_STATUS);
 }
 #endif
 
@@ -860,6 +923,34 @@ static void check_and_queue_gestures(uint32_t *event)
  *    1 in the A/B(lid, display) and 1 in the C/D(base, keyboard)
  * Gyro Sensor (optional)
  */
+#ifdef CONFIG_MOTION_SENSE_INTERRUPT_BATCH_US
+/**
+ * Keep waiting while only sensor interrupts are pending, until deadline.
+ *
+ * @param event The events the task has been woken up with.
+ * @param deadline When the task must run: a forced mode sensor collection is
+ *                 due or data must be sent to the AP.
+ * @return The events accumulated while waiting.
+ */
+static uint32_t motion_sense_batch_interrupts(uint32_t event,
+					      uint32_t deadline)
+{
+	uint32_t now = get_time().le.lo;
+	int32_t wait_us = CONFIG_MOTION_SENSE_INTERRUPT_BATCH_US;
+
+	if (time_until(now, deadline) < wait_us)
+		wait_us = time_until(now, deadline);
+	deadline = now + wait_us;
+
+	while ((event & TASK_EVENT_MOTION_INTERRUPT_MASK) &&
+	       !(event & ~TASK_EVENT_MOTION_INTERRUPT_MASK) && wait_us > 0) {
+		event |= task_wait_event(wait_us);
+		wait_us = time_until(get_time().le.lo, deadline);
+	}
+	return event;
+}
+#endif
+
 void motion_sense_task(void *u)
 {
 	int i, ret, wait_us;
@@ -1007,6 +1098,20 @@ void motion_sense_task(void *u)
 		}
 
 		event = task_wait_event(wait_us);
+#ifdef CONFIG_MOTION_SENSE_INTERRUPT_BATCH_US
+		{
+			uint32_t deadline = ts_end_task.le.lo +
+				(wait_us >= 0 ? wait_us :
+				 CONFIG_MOTION_SENSE_INTERRUPT_BATCH_US);
+
+			if (IS_ENABLED(CONFIG_ACCEL_FIFO) &&
+			    ap_event_interval > 0 &&
+			    time_after(deadline,
+				       ts_last_int.le.lo + ap_event_interval))
+				deadline = ts_last_int.le.lo + ap_event_interval;
+			event = motion_sense_batch_interrupts(event, deadline);
+		}
+#endif
 	}
 }
 
@@ -1150,7 +1255,7 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 					TASK_EVENT_MOTION_ODR_CHANGE, 0);
 		}
 
-		out->ec_rate.ret = motion_sense_ec_rate(sensor) / MSEC;
+		out->ec_rate.ret = udiv1000(motion_sense_ec_rate(sensor));
 
 		args->response_size = sizeof(out->ec_rate);
 		break;
@@ -1172,10 +1277,8 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 			 * The new ODR may suspend sensor, leaving samples
 			 * in the FIFO. Flush it explicitly.
 			 */
-			deprecated_atomic_or(&odr_event_required,
-					     1 << (sensor - motion_sensors));
-			task_set_event(TASK_ID_MOTIONSENSE,
-					TASK_EVENT_MOTION_ODR_CHANGE, 0);
+			motion_sense_request_data_rate(
+				1 << (sensor - motion_sensors));
 		}
 
 		out->sensor_odr.ret = sensor->drv->get_data_rate(sensor);
@@ -1321,6 +1424,17 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 	case MOTIONSENSE_CMD_FIFO_READ:
 		if (!IS_ENABLED(CONFIG_ACCEL_FIFO))
 			return EC_RES_INVALID_PARAM;
+		if (args->version >= 5) {
+			out->fifo_read_compact.number_data =
+				motion_sense_fifo_read_compact(
+					args->response_max -
+					sizeof(out->fifo_read_compact),
+					in->fifo_read.max_data_vector,
+					out->fifo_read_compact.data,
+					&(args->response_size));
+			args->response_size += sizeof(out->fifo_read_compact);
+			break;
+		}
 		out->fifo_read.number_data = motion_sense_fifo_read(
 			args->response_max - sizeof(out->fifo_read),
 			in->fifo_read.max_data_vector,
@@ -1506,7 +1620,7 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 
 DECLARE_HOST_COMMAND(EC_CMD_MOTION_SENSE_CMD, host_cmd_motion_sense,
 		     EC_VER_MASK(1) | EC_VER_MASK(2) | EC_VER_MASK(3) |
-		     EC_VER_MASK(4));
+		     EC_VER_MASK(4) | EC_VER_MASK(5));
 
 /*****************************************************************************/
 /* Console commands */
@@ -1647,10 +1761,7 @@ static int command_accel_data_rate(int argc, char **argv)
 		sensor->config[config_id].odr =
 			data | (round ? ROUND_UP_FLAG : 0);
 
-		deprecated_atomic_or(&odr_event_required,
-				     1 << (sensor - motion_sensors));
-		task_set_event(TASK_ID_MOTIONSENSE,
-				TASK_EVENT_MOTION_ODR_CHANGE, 0);
+		motion_sense_request_data_rate(1 << (sensor - motion_sensors));
 	} else {
 		ccprintf("Data rate for sensor %d: %d\n", id,
 			 sensor->drv->get_data_rate(sensor));
@@ -33,6 +33,8 @@ struct fifo_staged {
 	uint16_t count;
 	uint8_t sample_count[MAX_MOTION_SENSORS];
 	uint8_t requires_spreading;
+	/* Sensors whose staged samples carry the sensor's own timestamps */
+	uint32_t timed;
 };
 
 /**
@@ -67,6 +69,12 @@ static uint32_t next_timestamp_initialized;
 /** Need to wake up the AP. */
 static int wake_up_needed;
 
+/**
+ * Bitmap of the sensors whose pending ODR event is staged by their driver,
+ * where the new rate starts in the hardware FIFO.
+ */
+static uint32_t odr_event_deferred;
+
 /**
  * Check whether or not a give sensor data entry is a timestamp or not.
  *
@@ -179,17 +187,19 @@ static void fifo_pop(void)
 }
 
 /**
- * Make sure that the fifo has at least 1 empty spot to stage data into.
+ * Make sure that the fifo has at least count empty spots to stage data into.
+ *
+ * @param count The number of entries about to be staged, at most the fifo size.
  */
-static void fifo_ensure_space(void)
+static void fifo_ensure_space(size_t count)
 {
 	/* If we already have space just bail. */
-	if (queue_space(&fifo) > fifo_staged.count)
+	if (queue_space(&fifo) >= fifo_staged.count + count)
 		return;
 
 	/*
-	 * Pop at least 1 spot, but if all the following conditions are met we
-	 * will continue to pop:
+	 * Pop until we have count spots, but if all the following conditions
+	 * are met we will continue to pop:
 	 * 1. We're operating with tight timestamps.
 	 * 2. The new head isn't a timestamp.
 	 * 3. We have data that we can possibly pop.
@@ -200,11 +210,33 @@ static void fifo_ensure_space(void)
 	 */
 	do {
 		fifo_pop();
-	} while (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
-		 !is_timestamp(get_fifo_head()) &&
+	} while ((queue_space(&fifo) < fifo_staged.count + count ||
+		  (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
+		   !is_timestamp(get_fifo_head()))) &&
 		 queue_count(&fifo) + fifo_staged.count);
 }
 
+/**
+ * Whether or not the AP wants the next sample of a sensor, as decided by its
+ * oversampling ratio.
+ *
+ * @param sensor The sensor that generated the sample.
+ * @param oversampling The oversampling counter of the sensor, updated.
+ * @return True if the sample must be sent to the AP.
+ */
+static inline bool is_sample_wanted(const struct motion_sensor_t *sensor,
+				    uint16_t *oversampling)
+{
+	bool wanted;
+
+	if (sensor->oversampling_ratio == 0)
+		return false;
+
+	wanted = *oversampling == 0;
+	*oversampling = (*oversampling + 1) % sensor->oversampling_ratio;
+	return wanted;
+}
+
 /**
  * Test if a given timestamp is the first timestamp seen by a given sensor
  * number.
@@ -222,6 +254,9 @@ static inline bool is_new_timestamp(uint8_t sensor_num)
  * Stage a single data unit to the motion sense fifo. Note that for the AP to
  * see this data, it must be committed.
  *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
+ *
  * @param data The data to stage.
  * @param sensor The sensor that generated the data
  * @param valid_data The number of readable data entries in the data.
@@ -234,8 +269,6 @@ static void fifo_stage_unit(
 	struct queue_chunk chunk;
 	int i;
 
-	mutex_lock(&g_sensor_mutex);
-
 	for (i = 0; i < valid_data; i++)
 		sensor->xyz[i] = data->data[i];
 
@@ -251,28 +284,16 @@ static void fifo_stage_unit(
 	}
 
 	/* For valid sensors, check if AP really needs this data */
-	if (valid_data) {
-		int removed = 0;
-
-		if (sensor->oversampling_ratio == 0) {
-			removed = 1;
-		} else {
-			removed = sensor->oversampling++;
-			sensor->oversampling %= sensor->oversampling_ratio;
-		}
-		if (removed) {
-			mutex_unlock(&g_sensor_mutex);
-			if (IS_ENABLED(CONFIG_ONLINE_CALIB) &&
-			    next_timestamp_initialized & BIT(data->sensor_num))
-				online_calibration_process_data(
-					data, sensor,
-					next_timestamp[data->sensor_num].next);
-			return;
-		}
+	if (valid_data && !is_sample_wanted(sensor, &sensor->oversampling)) {
+		if (IS_ENABLED(CONFIG_ONLINE_CALIB) &&
+		    next_timestamp_initialized & BIT(data->sensor_num))
+			online_calibration_process_data(
+				data, sensor, next_timestamp[data->sensor_num].next);
+		return;
 	}
 
 	/* Make sure we have room for the data */
-	fifo_ensure_space();
+	fifo_ensure_space(1);
 
 	if (IS_ENABLED(CONFIG_TABLET_MODE))
 		data->flags |= (tablet_get_mode() ?
@@ -292,7 +313,6 @@ static void fifo_stage_unit(
 		 * address 0. Just don't add any data to the queue instead.
 		 */
 		CPRINTS("Failed to get write chunk for new fifo data!");
-		mutex_unlock(&g_sensor_mutex);
 		return;
 	}
 
@@ -315,10 +335,9 @@ static void fifo_stage_unit(
 	 */
 	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
 	    !is_timestamp(data) &&
+	    !(fifo_staged.timed & BIT(data->sensor_num)) &&
 	    ++fifo_staged.sample_count[data->sensor_num] > 1)
 		fifo_staged.requires_spreading = 1;
-
-	mutex_unlock(&g_sensor_mutex);
 }
 
 /**
@@ -327,6 +346,9 @@ static void fifo_stage_unit(
  * @param timestamp The timestamp to add to the fifo.
  * @param sensor_num The sensor number that this timestamp came from (use 0xff
  *	  for unknown).
+ *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
  */
 static void fifo_stage_timestamp(uint32_t timestamp, uint8_t sensor_num)
 {
@@ -385,13 +407,50 @@ void motion_sense_fifo_insert_async_event(
 	vector.timestamp = __hw_clock_source_read();
 	vector.sensor_num = sensor - motion_sensors;
 
+	mutex_lock(&g_sensor_mutex);
+	if (event == ASYNC_EVENT_ODR &&
+	    (odr_event_deferred & BIT(vector.sensor_num))) {
+		mutex_unlock(&g_sensor_mutex);
+		return;
+	}
 	fifo_stage_unit(&vector, sensor, 0);
+	mutex_unlock(&g_sensor_mutex);
 	motion_sense_fifo_commit_data();
 }
 
+void motion_sense_fifo_defer_odr_event(const struct motion_sensor_t *sensor,
+				       bool defer)
+{
+	mutex_lock(&g_sensor_mutex);
+	if (defer)
+		odr_event_deferred |= BIT(sensor - motion_sensors);
+	else
+		odr_event_deferred &= ~BIT(sensor - motion_sensors);
+	mutex_unlock(&g_sensor_mutex);
+}
+
+void motion_sense_fifo_stage_odr_event(struct motion_sensor_t *sensor,
+				       uint32_t time)
+{
+	struct ec_response_motion_sensor_data vector;
+	uint8_t sensor_num = sensor - motion_sensors;
+
+	mutex_lock(&g_sensor_mutex);
+	if (odr_event_deferred & BIT(sensor_num)) {
+		odr_event_deferred &= ~BIT(sensor_num);
+		vector.flags = ASYNC_EVENT_ODR;
+		vector.timestamp = time;
+		vector.sensor_num = sensor_num;
+		fifo_stage_unit(&vector, sensor, 0);
+	}
+	mutex_unlock(&g_sensor_mutex);
+}
+
 inline void motion_sense_fifo_add_timestamp(uint32_t timestamp)
 {
+	mutex_lock(&g_sensor_mutex);
 	fifo_stage_timestamp(timestamp, 0xff);
+	mutex_unlock(&g_sensor_mutex);
 	motion_sense_fifo_commit_data();
 }
 
@@ -401,6 +460,7 @@ void motion_sense_fifo_stage_data(
 	int valid_data,
 	uint32_t time)
 {
+	mutex_lock(&g_sensor_mutex);
 	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS)) {
 		/* First entry, save the time for spreading later. */
 		if (!fifo_staged.count)
@@ -408,7 +468,71 @@ void motion_sense_fifo_stage_data(
 		fifo_stage_timestamp(time, data->sensor_num);
 	}
 	fifo_stage_unit(data, sensor, valid_data);
+	mutex_unlock(&g_sensor_mutex);
+}
+
+void motion_sense_fifo_stage_batch(
+	struct ec_response_motion_sensor_data *data,
+	int count,
+	uint32_t time)
+{
+	/* Copy of the oversampling counters, static to store off stack. */
+	static uint16_t oversampling[MAX_MOTION_SENSORS];
+	size_t needed = 0;
+	int i;
+
+	if (count <= 0)
+		return;
+
+	mutex_lock(&g_sensor_mutex);
+
+	/*
+	 * Count the entries the batch will add, a timestamp for each sample
+	 * with tight timestamps plus the samples the AP wants, and make room
+	 * for all of them at once.
+	 */
+	for (i = 0; i < motion_sensor_count; i++)
+		oversampling[i] = motion_sensors[i].oversampling;
+	for (i = 0; i < count; i++) {
+		uint8_t sensor_num = data[i].sensor_num;
+
+		if (is_sample_wanted(&motion_sensors[sensor_num],
+				     &oversampling[sensor_num]))
+			needed++;
+	}
+	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS))
+		needed += count;
+	fifo_ensure_space(MIN(needed, fifo.buffer_units));
+
+	/* First entry, save the time for spreading later. */
+	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) && !fifo_staged.count)
+		fifo_staged.read_ts = __hw_clock_source_read();
+
+	for (i = 0; i < count; i++) {
+		if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS))
+			fifo_stage_timestamp(time, data[i].sensor_num);
+		fifo_stage_unit(&data[i], &motion_sensors[data[i].sensor_num],
+				3);
+	}
+
+	mutex_unlock(&g_sensor_mutex);
+}
+
+#ifdef CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
+void motion_sense_fifo_stage_timed_data(
+	struct ec_response_motion_sensor_data *data,
+	struct motion_sensor_t *sensor,
+	uint32_t time)
+{
+	mutex_lock(&g_sensor_mutex);
+	if (!fifo_staged.count)
+		fifo_staged.read_ts = __hw_clock_source_read();
+	fifo_staged.timed |= BIT(data->sensor_num);
+	fifo_stage_timestamp(time, data->sensor_num);
+	fifo_stage_unit(data, sensor, 3);
+	mutex_unlock(&g_sensor_mutex);
 }
+#endif
 
 void motion_sense_fifo_commit_data(void)
 {
@@ -515,7 +639,8 @@ commit_data_end:
 		next_timestamp[sensor_num].prev =
 			next_timestamp[sensor_num].next;
 		next_timestamp[sensor_num].next +=
-			fifo_staged.requires_spreading
+			fifo_staged.requires_spreading &&
+			!(fifo_staged.timed & BIT(sensor_num))
 			? data_periods[sensor_num]
 			: motion_sensors[sensor_num].collection_rate;
 
@@ -590,9 +715,82 @@ int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 	return count;
 }
 
+/*
+ * Worst case size of an entry in the compact format: 2 header bytes and 3
+ * axis of 17 bits zigzag values, 3 bytes each.
+ */
+#define COMPACT_ENTRY_MAX_SIZE (2 + 3 * 3)
+
+static inline uint32_t zigzag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static uint8_t *put_varint(uint8_t *out, uint32_t value)
+{
+	while (value >= 0x80) {
+		*out++ = value | 0x80;
+		value >>= 7;
+	}
+	*out++ = value;
+	return out;
+}
+
+int motion_sense_fifo_read_compact(int capacity_bytes, int max_count,
+				   void *out, uint16_t *out_size)
+{
+	/* Previous data per sensor, static to store off stack. */
+	static int16_t prev_data[MAX_MOTION_SENSORS + 1][3];
+	struct ec_response_motion_sensor_data entry;
+	uint8_t *p = out;
+	uint8_t * const end = p + capacity_bytes;
+	uint32_t prev_timestamp = 0;
+	int count = 0;
+	int i;
+
+	mutex_lock(&g_sensor_mutex);
+	memset(prev_data, 0, sizeof(prev_data));
+	while (count < max_count && end - p >= COMPACT_ENTRY_MAX_SIZE &&
+	       queue_peek_units(&fifo, &entry, count, 1)) {
+		const uint8_t sensor_num = entry.sensor_num;
+
+		*p++ = (entry.flags & MOTIONSENSE_FIFO_COMPACT_FLAGS_MASK) |
+		       (MIN(sensor_num, MOTIONSENSE_FIFO_COMPACT_SENSOR_ESC)
+			<< MOTIONSENSE_FIFO_COMPACT_SENSOR_SHIFT);
+		if (sensor_num >= MOTIONSENSE_FIFO_COMPACT_SENSOR_ESC)
+			*p++ = sensor_num;
+
+		if (is_timestamp(&entry)) {
+			p = put_varint(p, zigzag(entry.timestamp -
+						 prev_timestamp));
+			prev_timestamp = entry.timestamp;
+		} else {
+			/*
+			 * Sensor data comes from valid sensors, the extra row
+			 * only keeps a bogus entry within bounds.
+			 */
+			int16_t *prev = prev_data[MIN(sensor_num,
+						      MAX_MOTION_SENSORS)];
+
+			for (i = 0; i < 3; i++) {
+				p = put_varint(p, zigzag(entry.data[i] -
+							 prev[i]));
+				prev[i] = entry.data[i];
+			}
+		}
+		count++;
+	}
+	queue_advance_head(&fifo, count);
+	mutex_unlock(&g_sensor_mutex);
+	*out_size = p - (uint8_t *)out;
+
+	return count;
+}
+
 void motion_sense_fifo_reset(void)
 {
 	next_timestamp_initialized = 0;
+	odr_event_deferred = 0;
 	memset(&fifo_staged, 0, sizeof(fifo_staged));
 	motion_sense_fifo_init();
 	queue_init(&fifo);
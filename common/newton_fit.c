@@ -4,14 +4,11 @@
  */
 
 #include "common.h"
-#include "console.h"
 #include "newton_fit.h"
 #include "math.h"
 #include "math_util.h"
 #include <string.h>
 
-#define CPRINTS(fmt, args...) cprints(CC_MOTION_SENSE, fmt, ##args)
-
 static fp_t distance_squared(fpv3_t a, fpv3_t b)
 {
 	fpv3_t delta;
@@ -54,8 +51,6 @@ static bool is_ready_to_compute(struct newton_fit *fit, bool prune)
 	     queue_next(fit->orientations, &it)) {
 		_it = (struct newton_fit_orientation *)it.ptr;
 		/* If an orientation has too few samples, flag that. */
-		CPRINTS("    orientation %u/%u", _it->nsamples,
-			fit->min_orientation_samples);
 		if (_it->nsamples < fit->min_orientation_samples) {
 			has_min_samples = false;
 			break;
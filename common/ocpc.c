@@ -7,6 +7,7 @@
 
 #include "battery.h"
 #include "battery_fuel_gauge.h"
+#include "charge_state.h"
 #include "charge_state_v2.h"
 #include "charger.h"
 #include "common.h"
@@ -116,7 +117,6 @@ int ocpc_config_secondary_charger(int *desired_input_current,
 	int rv = EC_SUCCESS;
 	struct batt_params batt;
 	const struct battery_info *batt_info;
-	struct charger_params charger;
 	int vsys_target = 0;
 	int drive = 0;
 	int i_ma = 0;
@@ -202,13 +202,10 @@ int ocpc_config_secondary_charger(int *desired_input_current,
 
 	/*
 	 * We need to induce a current flow that matches the requested current
-	 * by raising VSYS.  Let's start by getting the latest data that we
-	 * know of.
+	 * by raising VSYS.  The charger loop has just read the battery and the
+	 * ADCs, so work from that data rather than reading it all again.
 	 */
-	batt_info = battery_get_info();
-	battery_get_params(&batt);
-	ocpc_get_adcs(ocpc);
-	charger_get_params(&charger);
+	batt = *charger_current_battery_params();
 
 
 	/*
@@ -256,6 +253,15 @@ int ocpc_config_secondary_charger(int *desired_input_current,
 	i_step = (int)charger_get_info()->current_step;
 	i_ma = (i_ma / i_step) * i_step;
 
+#ifdef CONFIG_OCPC_DEADBAND_MA
+	/* Close enough to the target, keep VSYS and the PID state as is. */
+	if (ocpc->last_vsys != OCPC_UNINIT && ph == PHASE_CC &&
+	    ABS(i_ma - batt.current) < CONFIG_OCPC_DEADBAND_MA) {
+		CPRINTS_DBG("OCPC: %dmA within deadband", i_ma - batt.current);
+		return rv;
+	}
+#endif
+
 	/*
 	 * We'll use our current target and our combined Rsys+Rbatt to seed our
 	 * VSYS target.  However, we'll use a PID loop to correct the error and
@@ -352,7 +358,10 @@ set_vsys:
 	/* To reduce spam, only print when we change VSYS significantly. */
 	if ((ABS(vsys_target - ocpc->last_vsys) > 10) || debug_output)
 		CPRINTS("OCPC: Target VSYS: %dmV", vsys_target);
-	charger_set_voltage(CHARGER_SECONDARY, vsys_target);
+#ifdef CONFIG_OCPC_DEADBAND_MA
+	if (vsys_target != ocpc->last_vsys)
+#endif
+		charger_set_voltage(CHARGER_SECONDARY, vsys_target);
 	ocpc->last_vsys = vsys_target;
 
 	/*
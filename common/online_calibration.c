@@ -16,6 +16,8 @@
 #include "accel_cal.h"
 #include "mkbp_event.h"
 #include "gyro_cal.h"
+#include "hooks.h"
+#include "queue.h"
 
 #define CPRINTS(format, args...) cprints(CC_MOTION_SENSE, format, ##args)
 
@@ -30,6 +32,19 @@ static uint32_t sensor_calib_cache_dirty_map;
 
 struct mutex g_calib_cache_mutex;
 
+#ifdef CONFIG_ONLINE_CALIB_DEFERRED
+/* A sample waiting for the calibration worker */
+struct calib_sample {
+	uint32_t timestamp;
+	int16_t data[3];
+	uint8_t sensor_num;
+};
+
+/* Filled by the motion sense task, drained by the hook task */
+static struct queue const calib_queue =
+	QUEUE_NULL(CONFIG_ONLINE_CALIB_QUEUE_SIZE, struct calib_sample);
+#endif
+
 static int get_temperature(struct motion_sensor_t *sensor, int *temp)
 {
 	struct online_calib_data *entry = sensor->online_calib_data;
@@ -62,12 +77,18 @@ static void data_int16_to_fp(const struct motion_sensor_t *s,
 {
 	int i;
 	fp_t range = INT_TO_FP(s->drv->get_range(s));
+	/*
+	 * Scale by multiplying with the reciprocals instead of dividing each
+	 * axis: online calibration always runs with an FPU (see config.h), so
+	 * fp_t has the precision for it.
+	 */
+	fp_t pos_scale = fp_div(range, INT_TO_FP(0x7fff));
+	fp_t neg_scale = fp_div(range, INT_TO_FP(0x8000));
 
 	for (i = 0; i < 3; ++i) {
 		fp_t v = INT_TO_FP((int32_t)data[i]);
 
-		out[i] = fp_div(v, INT_TO_FP((data[i] >= 0) ? 0x7fff : 0x8000));
-		out[i] = fp_mul(out[i], range);
+		out[i] = fp_mul(v, (data[i] >= 0) ? pos_scale : neg_scale);
 		/* Check for overflow */
 		out[i] = CLAMP(out[i], -range, range);
 	}
@@ -78,13 +99,14 @@ static void data_fp_to_int16(const struct motion_sensor_t *s, const fpv3_t data,
 {
 	int i;
 	fp_t range = INT_TO_FP(s->drv->get_range(s));
+	fp_t pos_scale = fp_div(INT_TO_FP(0x7fff), range);
+	fp_t neg_scale = fp_div(INT_TO_FP(0x8000), range);
 
 	for (i = 0; i < 3; ++i) {
 		int32_t iv;
-		fp_t v = fp_div(data[i], range);
+		fp_t v = fp_mul(data[i], (data[i] >= INT_TO_FP(0)) ?
+						 pos_scale : neg_scale);
 
-		v = fp_mul(v, INT_TO_FP((data[i] >= INT_TO_FP(0)) ? 0x7fff :
-								    0x8000));
 		iv = FP_TO_INT(v);
 		/* Check for overflow */
 		out[i] = CLAMP(iv, (int32_t)0xffff8000, (int32_t)0x00007fff);
@@ -183,6 +205,10 @@ void online_calibration_init(void)
 {
 	size_t i;
 
+#ifdef CONFIG_ONLINE_CALIB_DEFERRED
+	queue_init(&calib_queue);
+#endif
+
 	for (i = 0; i < SENSOR_COUNT; i++) {
 		struct motion_sensor_t *s = motion_sensors + i;
 		void *type_specific_data = NULL;
@@ -246,9 +272,17 @@ bool online_calibration_read(int sensor_num, int16_t out[3])
 	return has_valid;
 }
 
-int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
-				    struct motion_sensor_t *sensor,
-				    uint32_t timestamp)
+/**
+ * Feed a sample to the calibration of its sensor, and of any gyroscope that
+ * tracks the sensor.
+ *
+ * @param sensor Pointer to the sensor that generated the data.
+ * @param data The sample, in the sensor's raw scale.
+ * @param timestamp The time associated with the sample.
+ * @return EC_SUCCESS when successful.
+ */
+static int process_sample(struct motion_sensor_t *sensor, const int16_t *data,
+			  uint32_t timestamp)
 {
 	size_t sensor_num = motion_sensors - sensor;
 	int rc;
@@ -263,7 +297,7 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 		fpv3_t fdata;
 
 		/* Convert data to fp. */
-		data_int16_to_fp(sensor, data->data, fdata);
+		data_int16_to_fp(sensor, data, fdata);
 
 		/* Possibly update the gyroscope calibration. */
 		update_gyro_cal(sensor, fdata, timestamp);
@@ -291,14 +325,14 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 		struct mag_cal_t *cal =
 			(struct mag_cal_t *)(calib_data->type_specific_data);
 		int idata[] = {
-			(int)data->data[X],
-			(int)data->data[Y],
-			(int)data->data[Z],
+			(int)data[X],
+			(int)data[Y],
+			(int)data[Z],
 		};
 		fpv3_t fdata;
 
 		/* Convert data to fp. */
-		data_int16_to_fp(sensor, data->data, fdata);
+		data_int16_to_fp(sensor, data, fdata);
 
 		/* Possibly update the gyroscope calibration. */
 		update_gyro_cal(sensor, fdata, timestamp);
@@ -327,7 +361,7 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 			return rc;
 
 		/* Convert data to fp. */
-		data_int16_to_fp(sensor, data->data, fdata);
+		data_int16_to_fp(sensor, data, fdata);
 
 		/* Update gyroscope calibration. */
 		gyro_cal_update_gyro(
@@ -342,3 +376,36 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 
 	return EC_SUCCESS;
 }
+
+#ifdef CONFIG_ONLINE_CALIB_DEFERRED
+static void calib_worker(void)
+{
+	struct calib_sample sample;
+
+	while (queue_remove_unit(&calib_queue, &sample))
+		process_sample(&motion_sensors[sample.sensor_num], sample.data,
+			       sample.timestamp);
+}
+DECLARE_DEFERRED(calib_worker);
+#endif
+
+int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
+				    struct motion_sensor_t *sensor,
+				    uint32_t timestamp)
+{
+#ifdef CONFIG_ONLINE_CALIB_DEFERRED
+	struct calib_sample sample = {
+		.timestamp = timestamp,
+		.sensor_num = sensor - motion_sensors,
+	};
+
+	memcpy(sample.data, data->data, sizeof(sample.data));
+	if (!queue_add_unit(&calib_queue, &sample))
+		return EC_ERROR_OVERFLOW;
+	hook_call_deferred(&calib_worker_data, 0);
+
+	return EC_SUCCESS;
+#else
+	return process_sample(sensor, data->data, timestamp);
+#endif
+}
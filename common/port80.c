@@ -22,6 +22,20 @@ static int __bss_slow writes;    /* Number of port 80 writes so far */
 static int last_boot; /* Last code from previous boot */
 static int __bss_slow scroll;
 
+#ifdef CONFIG_PORT80_TIMESTAMPS
+/* Time since the previous write, as EC_PORT80_DELTA_US() decodes it */
+static uint16_t __bss_slow history_delta[CONFIG_PORT80_HISTORY_LEN];
+static uint64_t __bss_slow last_write_time;
+
+static uint16_t port80_encode_delta(uint64_t delta)
+{
+	if (delta < EC_PORT80_DELTA_LONG)
+		return delta;
+
+	return EC_PORT80_DELTA_LONG | MIN(delta >> 10, 0x7fff);
+}
+#endif
+
 #ifdef CONFIG_BRINGUP
 #undef CONFIG_PORT80_PRINT_IN_INT
 #define CONFIG_PORT80_PRINT_IN_INT 1
@@ -72,6 +86,16 @@ void port_80_write(int data)
 			last_boot = prev;
 	}
 
+#ifdef CONFIG_PORT80_TIMESTAMPS
+	{
+		uint64_t now = get_time().val;
+
+		history_delta[writes % ARRAY_SIZE(history)] =
+			port80_encode_delta(now - last_write_time);
+		last_write_time = now;
+	}
+#endif
+
 	history[writes % ARRAY_SIZE(history)] = data;
 	writes++;
 }
@@ -174,6 +198,48 @@ enum ec_status port80_last_boot(struct host_cmd_handler_args *args)
 	return EC_RES_SUCCESS;
 }
 
+#ifdef CONFIG_PORT80_TIMESTAMPS
+static enum ec_status port80_read_timed(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_port80_read *p = args->params;
+	struct ec_response_port80_read_timed *r = args->response;
+	uint32_t max = (args->response_max - sizeof(*r)) /
+		       sizeof(r->entries[0]);
+	uint32_t start, head, i;
+	uint64_t age;
+
+retry:
+	head = writes;
+	age = get_time().val - last_write_time;
+	start = p->read_timed.start;
+	/* Skip what has been overwritten; a flush restarts the count */
+	if (start > head)
+		start = 0;
+	if (head - start > ARRAY_SIZE(history))
+		start = head - ARRAY_SIZE(history);
+
+	r->count = MIN(head - start, max);
+	for (i = 0; i < r->count; i++) {
+		int idx = (start + i) % ARRAY_SIZE(history);
+
+		r->entries[i].code = history[idx];
+		r->entries[i].delta = history_delta[idx];
+	}
+
+	/* Start over if port80 writes overwrote what we just copied */
+	if (writes - start > ARRAY_SIZE(history) || writes < head)
+		goto retry;
+
+	r->start = start;
+	r->next = start + r->count;
+	r->last_age_us = MIN(age, UINT32_MAX);
+	r->reserved = 0;
+	args->response_size = sizeof(*r) + r->count * sizeof(r->entries[0]);
+
+	return EC_RES_SUCCESS;
+}
+#endif
+
 enum ec_status port80_command_read(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_port80_read *p = args->params;
@@ -204,6 +270,10 @@ enum ec_status port80_command_read(struct host_cmd_handler_args *args)
 
 		args->response_size = entries*sizeof(uint16_t);
 		return EC_RES_SUCCESS;
+#ifdef CONFIG_PORT80_TIMESTAMPS
+	} else if (p->subcmd == EC_PORT80_READ_TIMED) {
+		return port80_read_timed(args);
+#endif
 	}
 
 	return EC_RES_INVALID_PARAM;
@@ -14,10 +14,63 @@ static const char error_str[] = "ERROR";
 
 #define MAX_FORMAT 1024  /* Maximum chars in a single format field */
 
+/*
+ * Divide a 32-bit value by 10 with a multiply by the reciprocal, which is
+ * exact for all 32-bit values.
+ */
+static inline int divmod10_32(uint32_t *n)
+{
+	uint32_t q = ((uint64_t)*n * 0xcccccccdULL) >> 35;
+	int r = *n - q * 10;
+
+	*n = q;
+	return r;
+}
+
 #ifndef CONFIG_DEBUG_PRINTF
+/*
+ * Divide a 64-bit value by 10 with shifts and adds (Hacker's Delight,
+ * divu10), avoiding a software 64-bit division.
+ */
+static inline int divmod10_64(uint64_t *n)
+{
+	uint64_t q = (*n >> 1) + (*n >> 2);
+	int r;
+
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q += q >> 32;
+	q >>= 3;
+	r = *n - ((q << 3) + (q << 1));
+	if (r > 9) {
+		q++;
+		r -= 10;
+	}
+
+	*n = q;
+	return r;
+}
+
+/* Remove the lowest digit of n in base 2, 10 or 16 and return it. */
 static inline int divmod(uint64_t *n, int d)
 {
-	return uint64divmod(n, d);
+	uint32_t n32;
+	int r;
+
+	if (d != 10) {
+		r = *n & (d - 1);
+		*n >>= __fls(d);
+		return r;
+	}
+
+	if (*n > UINT32_MAX)
+		return divmod10_64(n);
+
+	n32 = *n;
+	r = divmod10_32(&n32);
+	*n = n32;
+	return r;
 }
 
 #else /* CONFIG_DEBUG_PRINTF */
@@ -25,9 +78,15 @@ static inline int divmod(uint64_t *n, int d)
 #define NO_UINT64_SUPPORT
 static inline int divmod(uint32_t *n, int d)
 {
-	int r = *n % d;
-	*n /= d;
-	return r;
+	int r;
+
+	if (d != 10) {
+		r = *n & (d - 1);
+		*n >>= __fls(d);
+		return r;
+	}
+
+	return divmod10_32(n);
 }
 #endif
 
@@ -287,7 +346,7 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 						precision = 6;
 					} else {
 						precision = 3;
-						v /= 1000;
+						uint64divmod(&v, 1000);
 					}
 
 				} else if (ptrspec == 'h') {
@@ -461,6 +520,149 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_CONSOLE_TOKENIZED
+/* Add an unsigned LEB128 value: 7 bits per byte, low bits first */
+static int add_varint(int (*addchar)(void *context, int c), void *context,
+		      uint64_t v)
+{
+	do {
+		int c = v & 0x7f;
+
+		v >>= 7;
+		if (v)
+			c |= 0x80;
+		if (addchar(context, c))
+			return EC_ERROR_OVERFLOW;
+	} while (v);
+
+	return EC_SUCCESS;
+}
+
+int vfntokenize(int (*addchar)(void *context, int c), void *context,
+		int flags, const char *format, va_list args)
+{
+	uint64_t token = (uintptr_t)format << 1;
+	int c;
+
+	if (flags & PRINTF_TOKEN_TIMESTAMP)
+		token |= 1;
+	if (add_varint(addchar, context, token))
+		return EC_ERROR_OVERFLOW;
+	if ((flags & PRINTF_TOKEN_TIMESTAMP) &&
+	    add_varint(addchar, context, get_time().val))
+		return EC_ERROR_OVERFLOW;
+
+	while (*format) {
+		int is_64bit = 0;
+		int precision = -1;
+		uint64_t v;
+
+		if (*format++ != '%')
+			continue;
+
+		/*
+		 * Skip flags and width, adding '*' arguments.  Keep the
+		 * precision, which limits how much of a string may be read.
+		 */
+		c = *format++;
+		while (c == '-' || c == '+' || c == '.' || c == '*' ||
+		       (c >= '0' && c <= '9')) {
+			if (c == '.') {
+				precision = 0;
+			} else if (c == '*') {
+				int arg = va_arg(args, int);
+
+				if (precision >= 0)
+					precision = arg;
+				if (add_varint(addchar, context, (uint32_t)arg))
+					return EC_ERROR_OVERFLOW;
+			} else if (c >= '0' && c <= '9' && precision >= 0) {
+				precision = 10 * precision + c - '0';
+			}
+			c = *format++;
+		}
+
+		if (c == '\0')
+			break;
+		if (c == '%')
+			continue;
+
+		/* Same length rules as vfnprintf() */
+		if (c == 'l') {
+			is_64bit = sizeof(long) == sizeof(uint64_t);
+			c = *format++;
+			if (c == 'l') {
+				is_64bit = 1;
+				c = *format++;
+			}
+			/* vfnprintf() prints an error and stops here */
+			if (!is_64bit)
+				break;
+		} else if (c == 'z') {
+			is_64bit = sizeof(size_t) == sizeof(uint64_t);
+			c = *format++;
+		}
+
+		if (c == 's') {
+			const char *vstr = va_arg(args, const char *);
+
+			if (vstr == NULL)
+				vstr = "(NULL)";
+			while (precision-- != 0 && *vstr)
+				if (addchar(context, *vstr++))
+					return EC_ERROR_OVERFLOW;
+			if (addchar(context, '\0'))
+				return EC_ERROR_OVERFLOW;
+			continue;
+		}
+
+		if (c == 'p') {
+			void *ptrval = va_arg(args, void *);
+			int ptrspec = *format++;
+
+			if (ptrspec == 'T') {
+				v = ptrval == PRINTF_TIMESTAMP_NOW ?
+					get_time().val : *(uint64_t *)ptrval;
+			} else if (ptrspec == 'h') {
+				const struct hex_buffer_params *hexbuf =
+					ptrval;
+				const uint8_t *buf = hexbuf ? hexbuf->buffer :
+					NULL;
+				int size = hexbuf ? hexbuf->size : 0;
+
+				if (add_varint(addchar, context, size))
+					return EC_ERROR_OVERFLOW;
+				while (size--)
+					if (addchar(context, *buf++))
+						return EC_ERROR_OVERFLOW;
+				continue;
+			} else if (ptrspec == 'P') {
+				v = (uintptr_t)ptrval;
+			} else if (ptrspec == 'b') {
+				const struct binary_print_params *binary =
+					ptrval;
+
+				if (add_varint(addchar, context,
+					       binary ? binary->count : 0))
+					return EC_ERROR_OVERFLOW;
+				v = binary ? binary->value : 0;
+			} else {
+				return EC_ERROR_INVAL;
+			}
+		} else if (is_64bit) {
+			v = va_arg(args, uint64_t);
+		} else {
+			v = va_arg(args, uint32_t);
+		}
+
+		if (add_varint(addchar, context, v))
+			return EC_ERROR_OVERFLOW;
+	}
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_CONSOLE_TOKENIZED */
+
 /* Context for snprintf() */
 struct snprintf_context {
 	char *str;
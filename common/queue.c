@@ -104,6 +104,36 @@ struct queue_chunk queue_get_read_chunk(struct queue const *q)
 	});
 }
 
+size_t queue_get_write_chunks(struct queue const *q,
+			      struct queue_chunk chunks[2])
+{
+	size_t space = queue_space(q);
+	size_t tail  = q->state->tail & q->buffer_units_mask;
+	size_t first = MIN(space, q->buffer_units - tail);
+
+	chunks[0].count  = first;
+	chunks[0].buffer = q->buffer + tail * q->unit_bytes;
+	chunks[1].count  = space - first;
+	chunks[1].buffer = q->buffer;
+
+	return space;
+}
+
+size_t queue_get_read_chunks(struct queue const *q,
+			     struct queue_chunk chunks[2])
+{
+	size_t count = queue_count(q);
+	size_t head  = q->state->head & q->buffer_units_mask;
+	size_t first = MIN(count, q->buffer_units - head);
+
+	chunks[0].count  = first;
+	chunks[0].buffer = q->buffer + head * q->unit_bytes;
+	chunks[1].count  = count - first;
+	chunks[1].buffer = q->buffer;
+
+	return count;
+}
+
 size_t queue_advance_head(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_count(q));
@@ -146,23 +176,21 @@ size_t queue_add_units(struct queue const *q, const void *src, size_t count)
 	return queue_add_memcpy(q, src, count, memcpy);
 }
 
-size_t queue_add_memcpy(struct queue const *q,
-			const void *src,
-			size_t count,
-			void *(*memcpy)(void *dest,
-					const void *src,
-					size_t n))
+size_t __hot_code queue_add_memcpy(struct queue const *q,
+				   const void *src,
+				   size_t count,
+				   void *(*memcpy)(void *dest,
+						   const void *src,
+						   size_t n))
 {
-	size_t transfer = MIN(count, queue_space(q));
-	size_t tail     = q->state->tail & q->buffer_units_mask;
-	size_t first    = MIN(transfer, q->buffer_units - tail);
+	struct queue_chunk chunks[2];
+	size_t transfer = MIN(count, queue_get_write_chunks(q, chunks));
+	size_t first    = MIN(transfer, chunks[0].count);
 
-	memcpy(q->buffer + tail * q->unit_bytes,
-	       src,
-	       first * q->unit_bytes);
+	memcpy(chunks[0].buffer, src, first * q->unit_bytes);
 
 	if (first < transfer)
-		memcpy(q->buffer,
+		memcpy(chunks[1].buffer,
 		       ((uint8_t const *) src) + first * q->unit_bytes,
 		       (transfer - first) * q->unit_bytes);
 
@@ -209,12 +237,12 @@ size_t queue_remove_units(struct queue const *q, void *dest, size_t count)
 	return queue_remove_memcpy(q, dest, count, memcpy);
 }
 
-size_t queue_remove_memcpy(struct queue const *q,
-			   void *dest,
-			   size_t count,
-			   void *(*memcpy)(void *dest,
-					   const void *src,
-					   size_t n))
+size_t __hot_code queue_remove_memcpy(struct queue const *q,
+				      void *dest,
+				      size_t count,
+				      void *(*memcpy)(void *dest,
+						      const void *src,
+						      size_t n))
 {
 	size_t transfer = MIN(count, queue_count(q));
 	size_t head     = q->state->head & q->buffer_units_mask;
@@ -7,6 +7,7 @@
 
 #include "common.h"
 #include "console.h"
+#include "drbg.h"
 #ifdef CONFIG_LIBCRYPTOC
 #include "cryptoc/util.h"
 #endif
@@ -400,18 +401,15 @@ static void add_entropy_deferred(void)
 	if (add_entropy_action == ADD_ENTROPY_RESET_ASYNC)
 		repeat = ROLLBACK_REGIONS;
 
-	init_trng();
 	do {
-		rand_bytes(rand, sizeof(rand));
+		drbg_rand_bytes(rand, sizeof(rand));
 		if (rollback_add_entropy(rand, sizeof(rand)) != EC_SUCCESS) {
 			add_entropy_rv = EC_RES_ERROR;
-			goto out;
+			return;
 		}
 	} while (--repeat);
 
 	add_entropy_rv = EC_RES_SUCCESS;
-out:
-	exit_trng();
 }
 DECLARE_DEFERRED(add_entropy_deferred);
 
@@ -121,6 +121,68 @@ static void mont_mul(const struct rsa_public_key *key,
 		mont_mul_add(key, c, a[i], b);
 }
 
+#ifndef CONFIG_RSA_EXPONENT_3
+/**
+ * Montgomery a[] = a[] * a[] / R % mod
+ *
+ * Squares first, computing each cross product once, then reduces: 1.5 n^2
+ * multiplications instead of the 2 n^2 of mont_mul().
+ *
+ * @param t	Work buffer of 2 x RSANUMWORDS elements
+ */
+static void mont_sqr(const struct rsa_public_key *key, uint32_t *a,
+		     uint32_t *t)
+{
+	uint64_t A;
+	uint32_t carry, top;
+	uint32_t i, j;
+
+	/* t[] = sum of a[i] * a[j] for i < j */
+	memset(t, 0, 2 * RSANUMBYTES);
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		A = 0;
+		for (j = i + 1; j < RSANUMWORDS; ++j) {
+			A = mulaa32(a[i], a[j], t[i + j], A >> 32);
+			t[i + j] = (uint32_t)A;
+		}
+		t[i + RSANUMWORDS] = A >> 32;
+	}
+
+	/* t[] = 2 * t[] + sum of a[i]^2 */
+	carry = 0;
+	top = 0;
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		uint32_t lo = t[2 * i], hi = t[2 * i + 1];
+
+		A = mulaa32(a[i], a[i], lo << 1 | top, carry);
+		t[2 * i] = (uint32_t)A;
+		A = (A >> 32) + (hi << 1 | lo >> 31);
+		t[2 * i + 1] = (uint32_t)A;
+		carry = A >> 32;
+		top = hi >> 31;
+	}
+
+	/* Reduce: add multiples of mod to clear the low half, one word a time */
+	carry = 0;
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		uint32_t d0 = t[i] * key->n0inv;
+
+		A = mula32(d0, key->n[0], t[i]);
+		for (j = 1; j < RSANUMWORDS; ++j) {
+			A = mulaa32(d0, key->n[j], t[i + j], A >> 32);
+			t[i + j] = (uint32_t)A;
+		}
+		A = (uint64_t)t[i + RSANUMWORDS] + (A >> 32) + carry;
+		t[i + RSANUMWORDS] = (uint32_t)A;
+		carry = A >> 32;
+	}
+
+	memcpy(a, t + RSANUMWORDS, RSANUMBYTES);
+	if (carry)
+		sub_mod(key, a);
+}
+#endif
+
 /**
  * In-place public exponentiation.
  * Exponent depends on the configuration (65537 (default), or 3).
@@ -130,26 +192,40 @@ static void mont_mul(const struct rsa_public_key *key,
  * @param workbuf32	Work buffer; caller must verify this is
  *			3 x RSANUMWORDS elements long.
  */
+/* Convert from big endian byte array to little endian word array. */
+static void load_words(uint32_t *a, const uint8_t *in)
+{
+	int i;
+
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		uint32_t tmp =
+			(in[((RSANUMWORDS - 1 - i) * 4) + 0] << 24) |
+			(in[((RSANUMWORDS - 1 - i) * 4) + 1] << 16) |
+			(in[((RSANUMWORDS - 1 - i) * 4) + 2] << 8) |
+			(in[((RSANUMWORDS - 1 - i) * 4) + 3] << 0);
+		a[i] = tmp;
+	}
+}
+
 static void mod_pow(const struct rsa_public_key *key, uint8_t *inout,
 		    uint32_t *workbuf32)
 {
+#ifdef CONFIG_RSA_EXPONENT_3
 	uint32_t *a = workbuf32;
 	uint32_t *a_r = a + RSANUMWORDS;
 	uint32_t *aa_r = a_r + RSANUMWORDS;
 	uint32_t *aaa = aa_r;  /* Re-use location. */
+#else
+	/* a and aaa share the work area of mont_sqr() */
+	uint32_t *t = workbuf32;
+	uint32_t *a = t;
+	uint32_t *aaa = t + RSANUMWORDS;
+	uint32_t *a_r = t + 2 * RSANUMWORDS;
+#endif
 	int i;
 
-	/* Convert from big endian byte array to little endian word array. */
-	for (i = 0; i < RSANUMWORDS; ++i) {
-		uint32_t tmp =
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 0] << 24) |
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 1] << 16) |
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 2] << 8) |
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 3] << 0);
-		a[i] = tmp;
-	}
+	load_words(a, inout);
 
-	/* TODO(drinkcat): This operation could be precomputed to save time. */
 	mont_mul(key, a_r, a, key->rr);  /* a_r = a * RR / R mod M */
 #ifdef CONFIG_RSA_EXPONENT_3
 	mont_mul(key, aa_r, a_r, a_r);
@@ -157,10 +233,11 @@ static void mod_pow(const struct rsa_public_key *key, uint8_t *inout,
 	mont_mul_1(key, aaa, a);
 #else
 	/* Exponent 65537 */
-	for (i = 0; i < 16; i += 2) {
-		mont_mul(key, aa_r, a_r, a_r); /* aa_r = a_r * a_r / R mod M */
-		mont_mul(key, a_r, aa_r, aa_r);/* a_r = aa_r * aa_r / R mod M */
-	}
+	for (i = 0; i < 16; ++i)
+		mont_sqr(key, a_r, t); /* a_r = a_r * a_r / R mod M */
+
+	/* a was overwritten by the squares; it's still in inout. */
+	load_words(a, inout);
 	mont_mul(key, aaa, a_r, a);  /* aaa = a_r * a / R mod M */
 #endif
 
@@ -0,0 +1,92 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Mapping of a sensor's own timestamps to the EC clock */
+
+#include "math_util.h"
+#include "sensor_clock.h"
+#include "util.h"
+
+void sensor_clock_init(struct sensor_clock *clk, uint32_t nominal_rate,
+		       int bits)
+{
+	clk->nominal_rate = nominal_rate;
+	clk->rate = nominal_rate;
+	clk->bits = bits;
+	clk->synced = 0;
+}
+
+static void sensor_clock_restart(struct sensor_clock *clk, uint32_t raw,
+				 uint32_t ec_time)
+{
+	clk->anchor_raw = raw;
+	clk->anchor_ec = ec_time;
+	clk->rate = clk->nominal_rate;
+	clk->synced = 1;
+}
+
+void sensor_clock_sync(struct sensor_clock *clk, uint32_t raw,
+		       uint32_t ec_time)
+{
+	const uint32_t mask = BIT(clk->bits) - 1;
+	int32_t elapsed = ec_time - clk->anchor_ec;
+	int64_t expected, ticks;
+	uint32_t predicted, measured;
+	int32_t error;
+
+	raw &= mask;
+	if (!clk->synced || elapsed < 0) {
+		sensor_clock_restart(clk, raw, ec_time);
+		return;
+	}
+	if (elapsed == 0)
+		return;
+
+	/*
+	 * Ticks since the anchor: the counter only gives them modulo a wrap,
+	 * pick the count closest to what the EC time elapsed predicts.
+	 */
+	expected = ((uint64_t)elapsed << 16) / clk->rate;
+	ticks = (raw - clk->anchor_raw) & mask;
+	ticks += (expected - ticks + BIT(clk->bits - 1)) & ~(int64_t)mask;
+	if (ticks <= 0) {
+		sensor_clock_restart(clk, raw, ec_time);
+		return;
+	}
+
+	predicted = clk->anchor_ec + (uint32_t)((ticks * clk->rate) >> 16);
+	error = ec_time - predicted;
+	if (ABS(error) > SENSOR_CLOCK_MAX_ERROR_US) {
+		sensor_clock_restart(clk, raw, ec_time);
+		return;
+	}
+
+	/* Track the tick length measured since the anchor, slowly. */
+	measured = ((uint64_t)elapsed << 16) / ticks;
+	clk->rate += ((int32_t)(measured - clk->rate)) / 16;
+	clk->rate = CLAMP(clk->rate,
+			  clk->nominal_rate - clk->nominal_rate / 8,
+			  clk->nominal_rate + clk->nominal_rate / 8);
+
+	/*
+	 * Move the anchor to this observation. Interrupt latency only ever
+	 * makes observations late, so follow early ones closely and late
+	 * ones barely.
+	 */
+	clk->anchor_raw = raw;
+	clk->anchor_ec = predicted + (error < 0 ? error / 2 : error / 16);
+}
+
+uint32_t sensor_clock_to_ec(const struct sensor_clock *clk, uint32_t raw)
+{
+	const uint32_t mask = BIT(clk->bits) - 1;
+	int32_t ticks = (raw - clk->anchor_raw) & mask;
+
+	/* Sign extend, the sample can be before or after the anchor. */
+	if (ticks & BIT(clk->bits - 1))
+		ticks -= BIT(clk->bits);
+
+	return clk->anchor_ec + (int32_t)(((int64_t)ticks * clk->rate) / 65536);
+}
@@ -8,7 +8,9 @@
 #include <stdint.h>
 
 #include "common.h"
+#include "console.h"
 #include "hooks.h"
+#include "host_command.h"
 #include "link_defs.h"
 #include "shared_mem.h"
 #include "system.h"
@@ -37,6 +39,138 @@ TEST_GLOBAL struct shm_buffer *allocced_buf_chain;
 /* The size of the biggest ever allocated buffer. */
 static int max_allocated_size;
 
+/*
+ * Size class slabs.  Each class is a contiguous array of equally sized slots
+ * carved from the top of the pool, with a bit per free slot in free_mask.
+ */
+struct shm_slab {
+	uint8_t slot_shift;
+	uint8_t slots;
+	uint8_t high_water;
+	uint32_t free_mask;
+	uint32_t misses;
+	char *base;
+};
+
+#ifdef CONFIG_MALLOC_SLAB
+BUILD_ASSERT(CONFIG_MALLOC_SLAB_64_COUNT <= 32);
+BUILD_ASSERT(CONFIG_MALLOC_SLAB_256_COUNT <= 32);
+BUILD_ASSERT(CONFIG_MALLOC_SLAB_1K_COUNT <= 32);
+BUILD_ASSERT(CONFIG_MALLOC_SLAB_4K_COUNT <= 32);
+
+/* Ordered from the smallest to the largest slot. */
+static struct shm_slab slabs[EC_SHMEM_SLAB_CLASSES] = {
+	{ .slot_shift = 6, .slots = CONFIG_MALLOC_SLAB_64_COUNT },
+	{ .slot_shift = 8, .slots = CONFIG_MALLOC_SLAB_256_COUNT },
+	{ .slot_shift = 10, .slots = CONFIG_MALLOC_SLAB_1K_COUNT },
+	{ .slot_shift = 12, .slots = CONFIG_MALLOC_SLAB_4K_COUNT },
+};
+
+static void slab_init(void)
+{
+	char *top = (char *)free_buf_chain + free_buf_chain->buffer_size;
+	int i;
+
+	/* Carve the largest slots first, dropping classes which don't fit. */
+	for (i = EC_SHMEM_SLAB_CLASSES - 1; i >= 0; i--) {
+		struct shm_slab *s = slabs + i;
+		size_t size = s->slots << s->slot_shift;
+
+		if (size + sizeof(struct shm_buffer) >
+		    free_buf_chain->buffer_size) {
+			s->slots = 0;
+			continue;
+		}
+
+		free_buf_chain->buffer_size -= size;
+		top -= size;
+		s->base = top;
+		s->free_mask = (s->slots == 32) ? ~0 : BIT(s->slots) - 1;
+	}
+}
+
+/* Called with the mutex lock acquired. */
+static int slab_acquire(int size, char **dest_ptr)
+{
+	int i;
+
+	for (i = 0; i < EC_SHMEM_SLAB_CLASSES; i++) {
+		struct shm_slab *s = slabs + i;
+		int slot;
+		int in_use;
+
+		if (size > (1 << s->slot_shift) || !s->slots)
+			continue;
+
+		if (!s->free_mask) {
+			s->misses++;
+			continue;
+		}
+
+		slot = __fls(s->free_mask);
+		s->free_mask &= ~BIT(slot);
+
+		in_use = s->slots - __builtin_popcount(s->free_mask);
+		if (in_use > s->high_water)
+			s->high_water = in_use;
+
+		*dest_ptr = s->base + (slot << s->slot_shift);
+		return EC_SUCCESS;
+	}
+
+	return EC_ERROR_BUSY;
+}
+
+/*
+ * Called with the mutex lock acquired.  Return 1 if ptr was a slot and has
+ * been released, 0 if it belongs to the first-fit list.
+ */
+static int slab_release(char *ptr)
+{
+	int i;
+
+	for (i = 0; i < EC_SHMEM_SLAB_CLASSES; i++) {
+		struct shm_slab *s = slabs + i;
+		size_t size = s->slots << s->slot_shift;
+
+		if (ptr >= s->base && ptr < s->base + size) {
+			s->free_mask |= BIT((ptr - s->base) >> s->slot_shift);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Called with the mutex lock acquired. */
+static size_t slab_max_free(void)
+{
+	int i;
+
+	for (i = EC_SHMEM_SLAB_CLASSES - 1; i >= 0; i--)
+		if (slabs[i].free_mask)
+			return 1 << slabs[i].slot_shift;
+
+	return 0;
+}
+#else
+static struct shm_slab slabs[0];
+
+static void slab_init(void) {}
+static int slab_acquire(int size, char **dest_ptr)
+{
+	return EC_ERROR_BUSY;
+}
+static int slab_release(char *ptr)
+{
+	return 0;
+}
+static size_t slab_max_free(void)
+{
+	return 0;
+}
+#endif
+
 static void shared_mem_init(void)
 {
 	/*
@@ -49,6 +183,8 @@ static void shared_mem_init(void)
 	free_buf_chain->prev_buffer = NULL;
 	free_buf_chain->buffer_size = system_usable_ram_end() -
 		(uintptr_t)__shared_mem_buf;
+
+	slab_init();
 }
 DECLARE_HOOK(HOOK_INIT, shared_mem_init, HOOK_PRIO_FIRST);
 
@@ -301,9 +437,12 @@ int shared_mem_size(void)
 		pfb = pfb->next_buffer;
 	}
 
-	mutex_unlock(&shmem_lock);
 	/* Leave room for shmem header */
 	max_available -= sizeof(struct shm_buffer);
+
+	max_available = MAX(max_available, slab_max_free());
+
+	mutex_unlock(&shmem_lock);
 	return max_available;
 }
 
@@ -317,10 +456,18 @@ int shared_mem_acquire(int size, char **dest_ptr)
 	if (in_interrupt_context())
 		return EC_ERROR_INVAL;
 
-	if (!free_buf_chain)
+	if (!IS_ENABLED(CONFIG_MALLOC_SLAB) && !free_buf_chain)
 		return EC_ERROR_BUSY;
 
 	mutex_lock(&shmem_lock);
+	rv = slab_acquire(size, dest_ptr);
+	if (rv == EC_SUCCESS) {
+		if (size > max_allocated_size)
+			max_allocated_size = size;
+		mutex_unlock(&shmem_lock);
+		return rv;
+	}
+
 	rv = do_acquire(size, &new_buf);
 	if (rv == EC_SUCCESS) {
 		new_buf->next_buffer = allocced_buf_chain;
@@ -346,44 +493,88 @@ void shared_mem_release(void *ptr)
 		return;
 
 	mutex_lock(&shmem_lock);
-	do_release((struct shm_buffer *)ptr - 1);
+	if (!slab_release(ptr))
+		do_release((struct shm_buffer *)ptr - 1);
 	mutex_unlock(&shmem_lock);
 }
 
-#ifdef CONFIG_CMD_SHMEM
-
-static int command_shmem(int argc, char **argv)
+static void shared_mem_get_stats(struct ec_response_shmem_stats *r)
 {
-	size_t allocated_size;
-	size_t free_size;
-	size_t max_free;
 	struct shm_buffer *buf;
+	int i;
 
-	allocated_size = free_size = max_free = 0;
+	memset(r, 0, sizeof(*r));
 
 	mutex_lock(&shmem_lock);
 
 	for (buf = free_buf_chain; buf; buf = buf->next_buffer) {
-		size_t buf_room;
-
-		buf_room = buf->buffer_size;
-
-		free_size += buf_room;
-		if (buf_room > max_free)
-			max_free = buf_room;
+		r->free += buf->buffer_size;
+		if (buf->buffer_size > r->max_free)
+			r->max_free = buf->buffer_size;
+		r->free_chunks++;
 	}
 
 	for (buf = allocced_buf_chain; buf;
 	     buf = buf->next_buffer)
-		allocated_size += buf->buffer_size;
+		r->allocated += buf->buffer_size;
+
+	for (i = 0; i < ARRAY_SIZE(slabs); i++) {
+		struct ec_shmem_slab_stats *st = r->slab + i;
+
+		st->slot_size = 1 << slabs[i].slot_shift;
+		st->slots = slabs[i].slots;
+		st->in_use = slabs[i].slots -
+			__builtin_popcount(slabs[i].free_mask);
+		st->high_water = slabs[i].high_water;
+		st->misses = slabs[i].misses;
+	}
 
 	mutex_unlock(&shmem_lock);
 
-	ccprintf("Total:         %6zd\n", allocated_size + free_size);
-	ccprintf("Allocated:     %6zd\n", allocated_size);
-	ccprintf("Free:          %6zd\n", free_size);
-	ccprintf("Max free buf:  %6zd\n", max_free);
-	ccprintf("Max allocated: %6d\n", max_allocated_size);
+	r->total = r->allocated + r->free;
+	r->max_allocated = max_allocated_size;
+}
+
+static enum ec_status
+host_command_shmem_stats(struct host_cmd_handler_args *args)
+{
+	shared_mem_get_stats(args->response);
+
+	args->response_size = sizeof(struct ec_response_shmem_stats);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_SHMEM_STATS,
+		     host_command_shmem_stats,
+		     EC_VER_MASK(0));
+
+#ifdef CONFIG_CMD_SHMEM
+
+static int command_shmem(int argc, char **argv)
+{
+	struct ec_response_shmem_stats r;
+	int i;
+
+	shared_mem_get_stats(&r);
+
+	ccprintf("Total:         %6d\n", r.total);
+	ccprintf("Allocated:     %6d\n", r.allocated);
+	ccprintf("Free:          %6d\n", r.free);
+	ccprintf("Max free buf:  %6d\n", r.max_free);
+	ccprintf("Free bufs:     %6d\n", r.free_chunks);
+	/* Share of the free space not usable by the largest request */
+	ccprintf("Fragmentation: %6d%%\n",
+		 r.free ? 100 - r.max_free * 100 / r.free : 0);
+	ccprintf("Max allocated: %6d\n", r.max_allocated);
+
+	for (i = 0; i < EC_SHMEM_SLAB_CLASSES; i++) {
+		if (!r.slab[i].slots)
+			continue;
+		ccprintf("Slab %4d: %2d/%2d used, high %2d, misses %d\n",
+			 r.slab[i].slot_size, r.slab[i].in_use,
+			 r.slab[i].slots, r.slab[i].high_water,
+			 r.slab[i].misses);
+	}
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem,
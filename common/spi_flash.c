@@ -13,6 +13,7 @@
 #include "spi.h"
 #include "spi_flash.h"
 #include "spi_flash_reg.h"
+#include "task.h"
 #include "timer.h"
 #include "util.h"
 #include "watchdog.h"
@@ -24,6 +25,12 @@
  */
 #define SPI_FLASH_SLEEP_USEC	100
 
+/*
+ * Time to sleep when chip is busy erasing, which takes tens of ms: polling at
+ * the program rate would only keep the SPI bus and the CPU busy.
+ */
+#define SPI_FLASH_ERASE_SLEEP_USEC	MSEC
+
 /*
  * This is the max time for 32kb flash erase
  */
@@ -32,20 +39,52 @@
 /* Internal buffer used by SPI flash driver */
 static uint8_t buf[SPI_FLASH_MAX_MESSAGE_SIZE];
 
-/**
- * Waits for chip to finish current operation. Must be called after
- * erase/write operations to ensure successive commands are executed.
- *
- * @return EC_SUCCESS or error on timeout
+/*
+ * Serializes transactions, so that one started by spi_flash_read_start()
+ * owns the flash until spi_flash_read_finish().
  */
-int spi_flash_wait(void)
+static struct mutex spi_flash_mutex;
+
+/* Read instruction, address and, for a fast read, the dummy byte */
+#ifdef CONFIG_SPI_FLASH_FAST_READ
+#define SPI_FLASH_READ_CMD_SIZE 5
+#else
+#define SPI_FLASH_READ_CMD_SIZE 4
+#endif
+
+/* Command of the read started by spi_flash_read_start() */
+static uint8_t read_cmd[SPI_FLASH_READ_CMD_SIZE];
+
+static int spi_flash_transaction(const uint8_t *txdata, int txlen,
+				 uint8_t *rxdata, int rxlen)
+{
+	int rv;
+
+	mutex_lock(&spi_flash_mutex);
+	rv = spi_transaction(SPI_FLASH_DEVICE, txdata, txlen, rxdata, rxlen);
+	mutex_unlock(&spi_flash_mutex);
+
+	return rv;
+}
+
+static void spi_flash_compose_read(uint8_t *cmd, unsigned int offset)
+{
+	cmd[0] = IS_ENABLED(CONFIG_SPI_FLASH_FAST_READ) ?
+		 SPI_FLASH_FAST_READ : SPI_FLASH_READ;
+	cmd[1] = (offset >> 16) & 0xFF;
+	cmd[2] = (offset >> 8) & 0xFF;
+	cmd[3] = offset & 0xFF;
+	/* The dummy byte of a fast read, if any, is don't care */
+}
+
+static int spi_flash_wait_poll(int sleep_us)
 {
 	timestamp_t timeout;
 
 	timeout.val = get_time().val + SPI_FLASH_TIMEOUT_USEC;
 	/* Wait until chip is not busy */
 	while (spi_flash_get_status1() & SPI_FLASH_SR1_BUSY) {
-		usleep(SPI_FLASH_SLEEP_USEC);
+		usleep(sleep_us);
 
 		if (get_time().val > timeout.val)
 			return EC_ERROR_TIMEOUT;
@@ -54,13 +93,24 @@ int spi_flash_wait(void)
 	return EC_SUCCESS;
 }
 
+/**
+ * Waits for chip to finish current operation. Must be called after
+ * erase/write operations to ensure successive commands are executed.
+ *
+ * @return EC_SUCCESS or error on timeout
+ */
+int spi_flash_wait(void)
+{
+	return spi_flash_wait_poll(SPI_FLASH_SLEEP_USEC);
+}
+
 /**
  * Set the write enable latch
  */
 static int spi_flash_write_enable(void)
 {
 	uint8_t cmd = SPI_FLASH_WRITE_ENABLE;
-	return spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, NULL, 0);
+	return spi_flash_transaction(&cmd, 1, NULL, 0);
 }
 
 /**
@@ -72,7 +122,7 @@ uint8_t spi_flash_get_status1(void)
 	uint8_t cmd = SPI_FLASH_READ_SR1;
 	uint8_t resp;
 
-	if (spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, &resp, 1) != EC_SUCCESS)
+	if (spi_flash_transaction(&cmd, 1, &resp, 1) != EC_SUCCESS)
 		return 0xff;
 
 	return resp;
@@ -92,7 +142,7 @@ uint8_t spi_flash_get_status2(void)
 	return 0;
 #endif
 
-	if (spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, &resp, 1) != EC_SUCCESS)
+	if (spi_flash_transaction(&cmd, 1, &resp, 1) != EC_SUCCESS)
 		return 0xff;
 
 	return resp;
@@ -128,9 +178,9 @@ int spi_flash_set_status(int reg1, int reg2)
 #endif
 
 	if (reg2 == -1)
-		rv = spi_transaction(SPI_FLASH_DEVICE, cmd, 2, NULL, 0);
+		rv = spi_flash_transaction(cmd, 2, NULL, 0);
 	else
-		rv = spi_transaction(SPI_FLASH_DEVICE, cmd, 3, NULL, 0);
+		rv = spi_flash_transaction(cmd, 3, NULL, 0);
 	if (rv)
 		return rv;
 
@@ -151,29 +201,49 @@ int spi_flash_set_status(int reg1, int reg2)
  */
 int spi_flash_read(uint8_t *buf_usr, unsigned int offset, unsigned int bytes)
 {
-	int i, read_size, ret, spi_addr;
-	uint8_t cmd[4];
+	int i, read_size, ret = EC_SUCCESS;
+	uint8_t cmd[SPI_FLASH_READ_CMD_SIZE] = {0};
+
 	if (offset + bytes > CONFIG_FLASH_SIZE)
 		return EC_ERROR_INVAL;
-	cmd[0] = SPI_FLASH_READ;
 	for (i = 0; i < bytes; i += read_size) {
-		spi_addr = offset + i;
-		cmd[1] = (spi_addr >> 16) & 0xFF;
-		cmd[2] = (spi_addr >> 8) & 0xFF;
-		cmd[3] = spi_addr & 0xFF;
+		spi_flash_compose_read(cmd, offset + i);
 		read_size = MIN((bytes - i), SPI_FLASH_MAX_READ_SIZE);
-		ret = spi_transaction(SPI_FLASH_DEVICE,
-			cmd,
-			4,
-			buf_usr + i,
-			read_size);
+		ret = spi_flash_transaction(cmd, sizeof(cmd), buf_usr + i,
+					    read_size);
 		if (ret != EC_SUCCESS)
 			break;
-		msleep(1);
 	}
 	return ret;
 }
 
+int spi_flash_read_start(uint8_t *buf_usr, unsigned int offset,
+			 unsigned int bytes)
+{
+	int ret;
+
+	if (offset + bytes > CONFIG_FLASH_SIZE ||
+	    bytes > SPI_FLASH_MAX_READ_SIZE)
+		return EC_ERROR_INVAL;
+
+	mutex_lock(&spi_flash_mutex);
+	spi_flash_compose_read(read_cmd, offset);
+	ret = spi_transaction_async(SPI_FLASH_DEVICE, read_cmd,
+				    sizeof(read_cmd), buf_usr, bytes);
+	if (ret != EC_SUCCESS)
+		mutex_unlock(&spi_flash_mutex);
+
+	return ret;
+}
+
+int spi_flash_read_finish(void)
+{
+	int ret = spi_transaction_flush(SPI_FLASH_DEVICE);
+
+	mutex_unlock(&spi_flash_mutex);
+	return ret;
+}
+
 /**
  * Erase a block of SPI flash.
  *
@@ -206,12 +276,12 @@ static int spi_flash_erase_block(unsigned int offset, unsigned int block)
 	cmd[2] = (offset >> 8) & 0xFF;
 	cmd[3] = offset & 0xFF;
 
-	rv = spi_transaction(SPI_FLASH_DEVICE, cmd, 4, NULL, 0);
+	rv = spi_flash_transaction(cmd, 4, NULL, 0);
 	if (rv)
 		return rv;
 
 	/* Wait for previous operation to complete */
-	return spi_flash_wait();
+	return spi_flash_wait_poll(SPI_FLASH_ERASE_SLEEP_USEC);
 }
 
 /**
@@ -309,8 +379,7 @@ int spi_flash_write(unsigned int offset, unsigned int bytes,
 		buf[2] = (offset) >> 8;
 		buf[3] = offset;
 
-		rv = spi_transaction(SPI_FLASH_DEVICE,
-				     buf, 4 + write_size, NULL, 0);
+		rv = spi_flash_transaction(buf, 4 + write_size, NULL, 0);
 		if (rv)
 			return rv;
 
@@ -333,7 +402,7 @@ int spi_flash_get_jedec_id(uint8_t *dest)
 {
 	uint8_t cmd = SPI_FLASH_JEDEC_ID;
 
-	return spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, dest, 3);
+	return spi_flash_transaction(&cmd, 1, dest, 3);
 }
 
 /**
@@ -346,7 +415,7 @@ int spi_flash_get_mfr_dev_id(uint8_t *dest)
 {
 	uint8_t cmd[4] = {SPI_FLASH_MFR_DEV_ID, 0, 0, 0};
 
-	return spi_transaction(SPI_FLASH_DEVICE, cmd, sizeof(cmd), dest, 2);
+	return spi_flash_transaction(cmd, sizeof(cmd), dest, 2);
 }
 
 /**
@@ -359,7 +428,7 @@ int spi_flash_get_unique_id(uint8_t *dest)
 {
 	uint8_t cmd[5] = {SPI_FLASH_UNIQUE_ID, 0, 0, 0, 0};
 
-	return spi_transaction(SPI_FLASH_DEVICE, cmd, sizeof(cmd), dest, 8);
+	return spi_flash_transaction(cmd, sizeof(cmd), dest, 8);
 }
 
 /**
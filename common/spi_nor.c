@@ -25,6 +25,8 @@
 
 /* Time to sleep while serial NOR flash write is in progress. */
 #define SPI_NOR_WIP_SLEEP_USEC 10
+/* Sector/block erases take tens to hundreds of ms, poll them less often. */
+#define SPI_NOR_ERASE_SLEEP_USEC 1000
 
 /* This driver only supports v1.* SFDP. */
 #define SPI_NOR_SUPPORTED_SFDP_MAJOR_VERSION 1
@@ -49,9 +51,35 @@ static struct mutex driver_mutex;
  * public APIs (read, write, erase). */
 static uint8_t buf[CONFIG_SPI_NOR_MAX_MESSAGE_SIZE];
 
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+/* Serializes the erases, and the operations which must not run during one,
+ * since erases release the driver mutex while each sector/block is erased.
+ * Always claimed before the driver mutex. */
+static struct mutex erase_mutex;
+
+/* The sector/block being erased, while the driver mutex is released. */
+static struct {
+	const struct spi_nor_device_t *device;
+	uint32_t offset;
+	size_t size;
+	/* An erase must not be suspended again before this time. */
+	timestamp_t next_suspend;
+} erase;
+#endif
+
 /******************************************************************************/
 /* Internal driver functions. */
 
+static void spi_nor_erase_lock(int lock)
+{
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+	if (lock)
+		mutex_lock(&erase_mutex);
+	else
+		mutex_unlock(&erase_mutex);
+#endif
+}
+
 /**
  * Blocking read of the Serial Flash's first status register.
  */
@@ -111,6 +139,7 @@ int spi_nor_write_ear(const struct spi_nor_device_t *spi_nor_device,
 	int rv;
 	uint8_t ear;
 
+	spi_nor_erase_lock(1);
 	mutex_lock(&driver_mutex);
 
 	rv = spi_nor_write_enable(spi_nor_device);
@@ -142,6 +171,7 @@ int spi_nor_write_ear(const struct spi_nor_device_t *spi_nor_device,
 
 err_free:
 	mutex_unlock(&driver_mutex);
+	spi_nor_erase_lock(0);
 	return rv;
 }
 
@@ -447,6 +477,55 @@ static int spi_nor_device_discover_sfdp_capacity(
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+/**
+ * Helper function to lookup the part's erase suspend and resume support in the
+ * SFDP Basic SPI Flash NOR Parameter Table.
+ */
+static int spi_nor_device_discover_sfdp_suspend(
+		struct spi_nor_device_t *spi_nor_device,
+		uint8_t basic_parameter_table_major_version,
+		uint8_t basic_parameter_table_minor_version,
+		uint32_t basic_parameter_table_offset,
+		size_t basic_parameter_table_size)
+{
+	/* Suspend latency units, in ns. */
+	static const uint32_t latency_units[] = { 128, 1000, 8000, 64000 };
+	int rv = EC_SUCCESS;
+	uint32_t dw12, dw13;
+
+	/* Suspend and resume are only reported from v1.5. */
+	if (basic_parameter_table_major_version != 1 ||
+	    basic_parameter_table_minor_version < 5 ||
+	    basic_parameter_table_size < 13 * 4)
+		return EC_SUCCESS;
+
+	rv = spi_nor_read_sfdp_dword(spi_nor_device,
+				     basic_parameter_table_offset, 12, &dw12);
+	rv |= spi_nor_read_sfdp_dword(spi_nor_device,
+				      basic_parameter_table_offset, 13, &dw13);
+	if (rv)
+		return rv;
+
+	if (SFDP_GET_BITFIELD(BFPT_1_5_DW12_SUSPEND_UNSUPPORTED, dw12))
+		return EC_SUCCESS;
+
+	spi_nor_device->erase_suspend_opcode =
+		SFDP_GET_BITFIELD(BFPT_1_5_DW13_SUSPEND_OPCODE, dw13);
+	spi_nor_device->erase_resume_opcode =
+		SFDP_GET_BITFIELD(BFPT_1_5_DW13_RESUME_OPCODE, dw13);
+	spi_nor_device->erase_suspend_usec = DIV_ROUND_UP(
+		(SFDP_GET_BITFIELD(BFPT_1_5_DW12_SUSP_RM_MAX_LAT_CNT, dw12) + 1) *
+		latency_units[SFDP_GET_BITFIELD(
+			BFPT_1_5_DW12_SUSP_RM_MAX_LAT_UNIT, dw12)], 1000);
+	spi_nor_device->erase_resume_usec =
+		(SFDP_GET_BITFIELD(BFPT_1_5_DW12_RM_RES_TO_SUSP_LAT_CNT, dw12) +
+		 1) * 64;
+
+	return EC_SUCCESS;
+}
+#endif
+
 static int spi_nor_read_internal(const struct spi_nor_device_t *spi_nor_device,
 				 uint32_t offset, size_t size, uint8_t *data)
 {
@@ -487,6 +566,106 @@ static int spi_nor_read_internal(const struct spi_nor_device_t *spi_nor_device,
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+/**
+ * Read from a device which may be erasing: suspend the erase around the read
+ * if the part supports it and the read is outside of the sector/block being
+ * erased, else wait for the erase to complete. Driver mutex must be held!
+ */
+static int spi_nor_read_erasing(const struct spi_nor_device_t *spi_nor_device,
+				uint32_t offset, size_t size, uint8_t *data)
+{
+	const struct spi_device_t *spi =
+		&spi_devices[spi_nor_device->spi_master];
+	uint8_t status_register_value;
+	uint8_t cmd;
+	int rv, resume_rv;
+	int busy;
+	timestamp_t now;
+
+	rv = spi_nor_read_status(spi_nor_device, &status_register_value);
+	if (rv)
+		return rv;
+	busy = status_register_value & SPI_NOR_STATUS_REGISTER_WIP;
+
+	if (busy && (!spi_nor_device->erase_suspend_opcode ||
+		     (offset < erase.offset + erase.size &&
+		      offset + size > erase.offset))) {
+		rv = spi_nor_wait(spi_nor_device);
+		if (rv)
+			return rv;
+		busy = 0;
+	}
+	if (!busy)
+		return spi_nor_read_internal(spi_nor_device, offset, size,
+					     data);
+
+	/* Let the erase make progress since it was last resumed. */
+	now = get_time();
+	if (now.val < erase.next_suspend.val)
+		usleep(erase.next_suspend.val - now.val);
+
+	cmd = spi_nor_device->erase_suspend_opcode;
+	rv = spi_transaction(spi, &cmd, 1, NULL, 0);
+	if (rv)
+		return rv;
+	usleep(spi_nor_device->erase_suspend_usec);
+
+	/* WIP clears once the erase is suspended (or completed meanwhile). */
+	rv = spi_nor_wait(spi_nor_device);
+	if (rv == EC_SUCCESS)
+		rv = spi_nor_read_internal(spi_nor_device, offset, size, data);
+
+	/* Resuming an erase which already completed is ignored by the part. */
+	cmd = spi_nor_device->erase_resume_opcode;
+	resume_rv = spi_transaction(spi, &cmd, 1, NULL, 0);
+	erase.next_suspend.val =
+		get_time().val + spi_nor_device->erase_resume_usec;
+
+	return rv ? rv : resume_rv;
+}
+
+/**
+ * Wait for the sector/block erase just issued to complete, with the driver
+ * mutex released so that other operations can run meanwhile. Driver mutex
+ * must be held, and is held again on return.
+ */
+static int spi_nor_erase_wait(const struct spi_nor_device_t *spi_nor_device,
+			      uint32_t offset, size_t size)
+{
+	uint8_t status_register_value;
+	timestamp_t timeout;
+	int rv;
+
+	erase.device = spi_nor_device;
+	erase.offset = offset;
+	erase.size = size;
+	erase.next_suspend.val =
+		get_time().val + spi_nor_device->erase_resume_usec;
+	timeout.val = get_time().val + spi_nor_device->timeout_usec;
+
+	do {
+		mutex_unlock(&driver_mutex);
+		watchdog_reload();
+		usleep(SPI_NOR_ERASE_SLEEP_USEC);
+		mutex_lock(&driver_mutex);
+
+		rv = spi_nor_read_status(spi_nor_device,
+					 &status_register_value);
+	} while (rv == EC_SUCCESS &&
+		 (status_register_value & SPI_NOR_STATUS_REGISTER_WIP) &&
+		 get_time().val <= timeout.val);
+
+	erase.device = NULL;
+
+	if (rv)
+		return rv;
+	if (status_register_value & SPI_NOR_STATUS_REGISTER_WIP)
+		return EC_ERROR_TIMEOUT;
+	return EC_SUCCESS;
+}
+#endif
+
 /******************************************************************************/
 /* External Serial NOR Flash API available to other modules. */
 
@@ -548,6 +727,17 @@ int spi_nor_init(void)
 					spi_nor_device->page_size);
 				mutex_unlock(&driver_mutex);
 			}
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+			if (spi_nor_device_discover_sfdp_suspend(
+				    spi_nor_device, table_major_rev,
+				    table_minor_rev, table_offset,
+				    table_size) == EC_SUCCESS &&
+			    spi_nor_device->erase_suspend_opcode)
+				CPRINTS(spi_nor_device,
+					"Erase suspend 0x%x in %dus",
+					spi_nor_device->erase_suspend_opcode,
+					spi_nor_device->erase_suspend_usec);
+#endif
 		}
 
 		/* Ensure the device is in a determined addressing state by
@@ -582,9 +772,12 @@ int spi_nor_set_4b_mode(struct spi_nor_device_t *spi_nor_device,
 	uint8_t cmd;
 	int rv;
 
+	spi_nor_erase_lock(1);
 	rv = spi_nor_write_enable(spi_nor_device);
-	if (rv)
+	if (rv) {
+		spi_nor_erase_lock(0);
 		return rv;
+	}
 
 	if (enter_4b_addressing_mode)
 		cmd = SPI_NOR_DRIVER_SPECIFIED_OPCODE_ENTER_4B;
@@ -606,6 +799,7 @@ int spi_nor_set_4b_mode(struct spi_nor_device_t *spi_nor_device,
 
 	/* Release the driver mutex. */
 	mutex_unlock(&driver_mutex);
+	spi_nor_erase_lock(0);
 	return rv;
 }
 
@@ -625,12 +819,14 @@ int spi_nor_read_jedec_id(const struct spi_nor_device_t *spi_nor_device,
 	if (size > CONFIG_SPI_NOR_MAX_READ_SIZE)
 		return EC_ERROR_INVAL;
 	/* Claim the driver mutex. */
+	spi_nor_erase_lock(1);
 	mutex_lock(&driver_mutex);
 	/* Read the JEDEC ID. */
 	rv = spi_transaction(&spi_devices[spi_nor_device->spi_master],
 			     &cmd, 1, data, size);
 	/* Release the driver mutex. */
 	mutex_unlock(&driver_mutex);
+	spi_nor_erase_lock(0);
 
 	return rv;
 }
@@ -651,7 +847,12 @@ int spi_nor_read(const struct spi_nor_device_t *spi_nor_device,
 
 	/* Claim the driver mutex. */
 	mutex_lock(&driver_mutex);
-	rv = spi_nor_read_internal(spi_nor_device, offset, size, data);
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+	if (erase.device == spi_nor_device)
+		rv = spi_nor_read_erasing(spi_nor_device, offset, size, data);
+	else
+#endif
+		rv = spi_nor_read_internal(spi_nor_device, offset, size, data);
 	/* Release the driver mutex. */
 	mutex_unlock(&driver_mutex);
 
@@ -685,6 +886,7 @@ int spi_nor_erase(const struct spi_nor_device_t *spi_nor_device,
 		return EC_ERROR_INVAL;
 
 	/* Claim the driver mutex. */
+	spi_nor_erase_lock(1);
 	mutex_lock(&driver_mutex);
 
 	while (size > 0) {
@@ -779,6 +981,13 @@ int spi_nor_erase(const struct spi_nor_device_t *spi_nor_device,
 		if (rv)
 			goto err_free;
 
+#ifdef CONFIG_SPI_NOR_ERASE_SUSPEND
+		/* Serve other operations while this sector/block erases. */
+		rv = spi_nor_erase_wait(spi_nor_device, offset, erase_size);
+		if (rv)
+			goto err_free;
+#endif
+
 		offset += erase_size;
 		size -= erase_size;
 	}
@@ -789,6 +998,7 @@ int spi_nor_erase(const struct spi_nor_device_t *spi_nor_device,
 err_free:
 	/* Release the driver mutex. */
 	mutex_unlock(&driver_mutex);
+	spi_nor_erase_lock(0);
 
 	return rv;
 }
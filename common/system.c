@@ -11,6 +11,7 @@
 #include "common.h"
 #include "console.h"
 #include "cpu.h"
+#include "crc8.h"
 #include "cros_board_info.h"
 #include "dma.h"
 #include "flash.h"
@@ -293,25 +294,38 @@ int system_jumped_late(void)
 	return !(reset_flags & EC_RESET_FLAG_EFS) && jumped_to_image;
 }
 
-int system_add_jump_tag(uint16_t tag, int version, int size, const void *data)
+/* Make room for a new tag, returning where its data goes or NULL. */
+static uint8_t *jump_tag_alloc(uint16_t tag, int version, int size)
 {
 	struct jump_tag *t;
 
 	/* Only allowed during a sysjump */
-	if (!jdata || jdata->magic != JUMP_DATA_MAGIC)
-		return EC_ERROR_UNKNOWN;
+	if (!jdata || jdata->magic != JUMP_DATA_MAGIC || size > 255)
+		return NULL;
 
-	/* Make room for the new tag */
-	if (size > 255)
-		return EC_ERROR_INVAL;
 	jdata->jump_tag_total += ROUNDUP4(size) + sizeof(struct jump_tag);
 
 	t = (struct jump_tag *)system_usable_ram_end();
 	t->tag = tag;
 	t->data_size = size;
 	t->data_version = version;
+
+	return (uint8_t *)(t + 1);
+}
+
+int system_add_jump_tag(uint16_t tag, int version, int size, const void *data)
+{
+	uint8_t *p;
+
+	/* Only allowed during a sysjump */
+	if (!jdata || jdata->magic != JUMP_DATA_MAGIC)
+		return EC_ERROR_UNKNOWN;
+
+	p = jump_tag_alloc(tag, version, size);
+	if (!p)
+		return EC_ERROR_INVAL;
 	if (size)
-		memcpy(t + 1, data, size);
+		memcpy(p, data, size);
 
 	return EC_SUCCESS;
 }
@@ -345,6 +359,46 @@ const uint8_t *system_get_jump_tag(uint16_t tag, int *version, int *size)
 	return NULL;
 }
 
+#ifdef CONFIG_SYSJUMP_STATE
+int system_add_jump_state(uint16_t tag, int version, int size,
+			  const void *data)
+{
+	uint8_t *p;
+
+	/* Only allowed during a sysjump */
+	if (!jdata || jdata->magic != JUMP_DATA_MAGIC)
+		return EC_ERROR_UNKNOWN;
+
+	/* The CRC-8 is stored after the state */
+	p = jump_tag_alloc(tag, version, size + 1);
+	if (!p)
+		return EC_ERROR_INVAL;
+	memcpy(p, data, size);
+	p[size] = crc8(p, size);
+
+	return EC_SUCCESS;
+}
+
+int system_get_jump_state(uint16_t tag, int version, int size, void *data)
+{
+	const uint8_t *p;
+	int saved_version, saved_size;
+
+	p = system_get_jump_tag(tag, &saved_version, &saved_size);
+	if (!p)
+		return EC_ERROR_UNKNOWN;
+
+	if (saved_version != version || saved_size != size + 1 ||
+	    crc8(p, size) != p[size]) {
+		CPRINTS("Jump state %04x stale, ignored", tag);
+		return EC_ERROR_INVAL;
+	}
+
+	memcpy(data, p, size);
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_SYSJUMP_STATE */
+
 void system_disable_jump(void)
 {
 	disable_jump = 1;
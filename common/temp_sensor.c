@@ -26,10 +26,39 @@ int temp_sensor_read(enum temp_sensor_id id, int *temp_ptr)
 	return sensor->read(sensor->idx, temp_ptr);
 }
 
+/*
+ * The HOOK_SECOND consumers share one reading of each sensor per pass, so the
+ * sensors behind an ADC or a bus are not read once per consumer.
+ */
+#define TEMP_SENSOR_SAMPLE_AGE (SECOND / 2)
+
+static struct {
+	timestamp_t expires;
+	int rv;
+	int temp;
+} samples[TEMP_SENSOR_COUNT];
+
+int temp_sensor_read_sample(enum temp_sensor_id id, int *temp_ptr)
+{
+	if (id < 0 || id >= TEMP_SENSOR_COUNT)
+		return EC_ERROR_INVAL;
+
+	if (timestamp_expired(samples[id].expires, NULL)) {
+		samples[id].rv = temp_sensor_read(id, &samples[id].temp);
+		samples[id].expires.val = get_time().val +
+					  TEMP_SENSOR_SAMPLE_AGE;
+	}
+
+	if (samples[id].rv == EC_SUCCESS)
+		*temp_ptr = samples[id].temp;
+	return samples[id].rv;
+}
+
 static void update_mapped_memory(void)
 {
 	int i, t;
 	uint8_t *mptr = host_get_memmap(EC_MEMMAP_TEMP_SENSOR);
+	uint8_t old;
 
 	for (i = 0; i < TEMP_SENSOR_COUNT; i++, mptr++) {
 		/*
@@ -42,7 +71,8 @@ static void update_mapped_memory(void)
 			 EC_TEMP_SENSOR_B_ENTRIES)
 			break;
 
-		switch (temp_sensor_read(i, &t)) {
+		old = *mptr;
+		switch (temp_sensor_read_sample(i, &t)) {
 		case EC_ERROR_NOT_POWERED:
 			*mptr = EC_TEMP_SENSOR_NOT_POWERED;
 			break;
@@ -55,6 +85,8 @@ static void update_mapped_memory(void)
 		default:
 			*mptr = EC_TEMP_SENSOR_ERROR;
 		}
+		if (*mptr != old)
+			host_memmap_changed(mptr - host_get_memmap(0), 1);
 	}
 }
 /* Run after other TEMP tasks, so sensors will have updated first. */
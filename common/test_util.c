@@ -11,12 +11,19 @@
 #include <stdlib.h>
 #endif
 
+#ifdef EMU_BUILD
+#include <time.h>
+#endif
+
+#include "clock.h"
 #include "console.h"
+#include "cpu.h"
 #include "hooks.h"
 #include "host_command.h"
 #include "system.h"
 #include "task.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 struct test_util_tag {
@@ -161,6 +168,79 @@ int test_send_host_command(int command, int version, const void *params,
 }
 #endif  /* TASK_HAS_HOSTCMD */
 
+#if defined(CORE_CORTEX_M) || defined(CORE_RISCV_RV32I)
+#define HAS_BENCH_CYCLE_COUNTER
+
+/* Returns the low word of the core cycle counter, enabling it if needed. */
+static uint32_t bench_read_cycles(void)
+{
+#ifdef CORE_CORTEX_M
+	if (!(CPU_DWT_CTRL & CPU_DWT_CTRL_CYCCNTENA)) {
+		CPU_SCB_DEMCR |= CPU_SCB_DEMCR_TRCENA;
+		CPU_DWT_CTRL |= CPU_DWT_CTRL_CYCCNTENA;
+	}
+	return CPU_DWT_CYCCNT;
+#else
+	return get_mcycle();
+#endif
+}
+#endif
+
+uint64_t test_bench_now_ns(void)
+{
+#ifdef EMU_BUILD
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#elif defined(HAS_BENCH_CYCLE_COUNTER)
+	/*
+	 * Extend the 32-bit counter in software: benchmarks read it far more
+	 * often than it wraps (tens of seconds at EC clock rates).
+	 */
+	static uint32_t last;
+	static uint64_t high;
+	uint32_t now = bench_read_cycles();
+	uint64_t ns;
+
+	if (now < last)
+		high += 1ULL << 32;
+	last = now;
+
+	ns = (high + now) * 1000;
+	uint64divmod(&ns, clock_get_freq() / 1000000);
+	return ns;
+#else
+	return get_time().val * 1000;
+#endif
+}
+
+void test_bench_report(const char *name, int ops, uint64_t ns)
+{
+#ifdef EMU_BUILD
+	ccprintf("BENCH {\"name\": \"%s\", \"ops\": %d, \"ns\": %lld, "
+		 "\"ns_per_op\": %lld}\n",
+		 name, ops, (long long)ns, (long long)(ns / MAX(ops, 1)));
+#else
+	/* On device, also report core cycles for comparing chips. */
+	uint64_t cycles = ns * (clock_get_freq() / 1000000);
+	uint64_t ns_per_op = ns;
+	uint64_t cycles_per_op;
+
+	uint64divmod(&cycles, 1000);
+	cycles_per_op = cycles;
+	uint64divmod(&ns_per_op, MAX(ops, 1));
+	uint64divmod(&cycles_per_op, MAX(ops, 1));
+
+	ccprintf("BENCH {\"name\": \"%s\", \"ops\": %d, \"ns\": %lld, "
+		 "\"ns_per_op\": %lld, \"cycles\": %lld, "
+		 "\"cycles_per_op\": %lld}\n",
+		 name, ops, (long long)ns, (long long)ns_per_op,
+		 (long long)cycles, (long long)cycles_per_op);
+#endif
+	cflush();
+}
+
 /* Linear congruential pseudo random number generator */
 uint32_t prng(uint32_t seed)
 {
@@ -5,12 +5,14 @@
 
 /* Common chipset throttling code for Chrome EC */
 
+#include "atomic.h"
 #include "chipset.h"
 #include "common.h"
 #include "console.h"
 #include "dptf.h"
 #include "hooks.h"
 #include "host_command.h"
+#include "hwtimer.h"
 #include "task.h"
 #include "throttle_ap.h"
 #include "timer.h"
@@ -39,12 +41,13 @@ void throttle_ap(enum throttle_level level,
 
 	bitmask = BIT(source);
 
+	/* Atomic, the fast input sets its bit from its interrupt */
 	switch (level) {
 	case THROTTLE_ON:
-		throttle_request[type] |= bitmask;
+		deprecated_atomic_or(&throttle_request[type], bitmask);
 		break;
 	case THROTTLE_OFF:
-		throttle_request[type] &= ~bitmask;
+		deprecated_atomic_clear_bits(&throttle_request[type], bitmask);
 		break;
 	}
 
@@ -59,6 +62,12 @@ void throttle_ap(enum throttle_level level,
 	case THROTTLE_HARD:
 #ifdef CONFIG_CHIPSET_CAN_THROTTLE
 		chipset_throttle_cpu(tmpval);
+		/* Don't undo a fast throttle that came in meanwhile */
+		while (IS_ENABLED(CONFIG_THROTTLE_AP_FAST_INPUT) &&
+		       tmpval != throttle_request[type]) {
+			tmpval = throttle_request[type];
+			chipset_throttle_cpu(tmpval);
+		}
 #endif
 		break;
 
@@ -129,6 +138,76 @@ void throttle_ap_prochot_input_interrupt(enum gpio_signal signal)
 		PROCHOT_IN_DEBOUNCE_US);
 }
 
+#ifdef CONFIG_THROTTLE_AP_FAST_INPUT
+static enum gpio_signal gpio_fast_in = GPIO_COUNT;
+/* Fast throttles, and when the last one, not logged yet if set, came in */
+static uint32_t fast_count;
+static uint32_t fast_start;
+static int fast_start_pending;
+/* Time (us) from the interrupt to the throttle asserted, last and max */
+static uint32_t fast_latency;
+static uint32_t fast_latency_max;
+/* Time (us) from the interrupt to the bookkeeping, the old path */
+static uint32_t fast_deferred_latency;
+
+static int fast_input_asserted(void)
+{
+	int level = gpio_get_level(gpio_fast_in);
+
+	return IS_ENABLED(CONFIG_THROTTLE_AP_FAST_INPUT_ACTIVE_LOW) ?
+		!level : level;
+}
+
+static void fast_input_deferred(void)
+{
+	if (fast_input_asserted()) {
+		/* Already throttled, this keeps the books */
+		throttle_ap(THROTTLE_ON, THROTTLE_HARD,
+			    THROTTLE_SRC_FAST_INPUT);
+		if (fast_start_pending) {
+			fast_start_pending = 0;
+			fast_deferred_latency =
+				__hw_clock_source_read() - fast_start;
+			CPRINTS("Fast throttle in %d us, deferred path %d us",
+				fast_latency, fast_deferred_latency);
+		}
+	} else {
+		throttle_ap(THROTTLE_OFF, THROTTLE_HARD,
+			    THROTTLE_SRC_FAST_INPUT);
+	}
+}
+DECLARE_DEFERRED(fast_input_deferred);
+
+void throttle_ap_fast_input_interrupt(enum gpio_signal signal)
+{
+	uint32_t start = __hw_clock_source_read();
+
+	if (gpio_fast_in == GPIO_COUNT)
+		gpio_fast_in = signal;
+
+	if (!fast_input_asserted()) {
+		/* Debounce the release, but not the assertion */
+		hook_call_deferred(&fast_input_deferred_data,
+				   PROCHOT_IN_DEBOUNCE_US);
+		return;
+	}
+
+	if (!(throttle_request[THROTTLE_HARD] &
+	      BIT(THROTTLE_SRC_FAST_INPUT))) {
+		deprecated_atomic_or(&throttle_request[THROTTLE_HARD],
+				     BIT(THROTTLE_SRC_FAST_INPUT));
+		chipset_throttle_cpu(1);
+
+		fast_start = start;
+		fast_start_pending = 1;
+		fast_latency = __hw_clock_source_read() - start;
+		fast_latency_max = MAX(fast_latency_max, fast_latency);
+		fast_count++;
+	}
+	hook_call_deferred(&fast_input_deferred_data, 0);
+}
+#endif /* CONFIG_THROTTLE_AP_FAST_INPUT */
+
 /*****************************************************************************/
 /* Console commands */
 #ifdef CONFIG_CMD_APTHROTTLE
@@ -145,6 +224,11 @@ static int command_apthrottle(int argc, char **argv)
 		ccprintf("AP throttling type %d is %s (0x%08x)\n", i,
 			 tmpval ? "on" : "off", tmpval);
 	}
+#ifdef CONFIG_THROTTLE_AP_FAST_INPUT
+	ccprintf("Fast throttles: %d, in %d us (max %d us), deferred path "
+		 "%d us\n", fast_count, fast_latency, fast_latency_max,
+		 fast_deferred_latency);
+#endif
 
 	return EC_SUCCESS;
 }
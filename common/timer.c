@@ -13,6 +13,7 @@
 #include "system.h"
 #include "util.h"
 #include "task.h"
+#include "task_bitmap.h"
 #include "timer.h"
 #include "watchdog.h"
 
@@ -29,19 +30,125 @@ int32_t k_usleep(int32_t);
 STATIC_IF_NOT(CONFIG_HWTIMER_64BIT) uint32_t clksrc_high;
 
 /* Bitmap of currently running timers */
-static uint32_t timer_running;
+static uint32_t timer_running[TASK_BITMAP_WORDS];
 
 /* Deadlines of all timers */
 static timestamp_t timer_deadline[TASK_ID_COUNT];
 static uint32_t next_deadline = 0xffffffff;
 
+/*
+ * Running timers, as a binary min-heap of task IDs ordered by deadline, so the
+ * nearest deadline is always timer_heap[0].  timer_heap_pos[] holds the heap
+ * index of each running timer, so that it can be cancelled in O(log n).
+ *
+ * The heap is only modified from the timer interrupt, or from task context
+ * with interrupts disabled.
+ */
+static uint8_t timer_heap[TASK_ID_COUNT];
+static uint8_t timer_heap_pos[TASK_ID_COUNT];
+static int timer_heap_size;
+
 /* Hardware timer routine IRQ number */
 static int timer_irq;
 
+static inline int timer_before(int a, int b)
+{
+	return timer_deadline[timer_heap[a]].val <
+		timer_deadline[timer_heap[b]].val;
+}
+
+static void timer_heap_swap(int a, int b)
+{
+	uint8_t tskid = timer_heap[a];
+
+	timer_heap[a] = timer_heap[b];
+	timer_heap[b] = tskid;
+	timer_heap_pos[timer_heap[a]] = a;
+	timer_heap_pos[timer_heap[b]] = b;
+}
+
+static void timer_heap_sift_up(int i)
+{
+	while (i > 0 && timer_before(i, (i - 1) / 2)) {
+		timer_heap_swap(i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void timer_heap_sift_down(int i)
+{
+	for (;;) {
+		int child = 2 * i + 1;
+
+		if (child >= timer_heap_size)
+			return;
+		if (child + 1 < timer_heap_size && timer_before(child + 1, child))
+			child++;
+		if (!timer_before(child, i))
+			return;
+		timer_heap_swap(i, child);
+		i = child;
+	}
+}
+
+static void timer_heap_insert(task_id_t tskid)
+{
+	int i = timer_heap_size++;
+
+	timer_heap[i] = tskid;
+	timer_heap_pos[tskid] = i;
+	timer_heap_sift_up(i);
+}
+
+static void timer_heap_remove(task_id_t tskid)
+{
+	int i = timer_heap_pos[tskid];
+	uint8_t moved;
+
+	if (i == --timer_heap_size)
+		return;
+
+	/* Fill the hole with the last timer, then restore heap order */
+	moved = timer_heap[timer_heap_size];
+	timer_heap[i] = moved;
+	timer_heap_pos[moved] = i;
+	timer_heap_sift_up(i);
+	timer_heap_sift_down(timer_heap_pos[moved]);
+}
+
+/*
+ * Return the deadline to program into the hardware timer for the nearest
+ * timer: the latest deadline which is no more than CONFIG_TIMER_SLACK_US
+ * after it, so that timers close together expire in a single interrupt.
+ */
+static timestamp_t timer_coalesced_deadline(void)
+{
+	timestamp_t next = timer_deadline[timer_heap[0]];
+	uint64_t limit = next.val + CONFIG_TIMER_SLACK_US;
+	int i;
+
+	if (!CONFIG_TIMER_SLACK_US)
+		return next;
+
+	/* Stay within the current epoch of the 32-bit hardware event. */
+	if ((limit >> 32) != next.le.hi)
+		limit = ((uint64_t)next.le.hi << 32) | 0xffffffff;
+
+	for (i = 1; i < timer_heap_size; i++) {
+		uint64_t deadline = timer_deadline[timer_heap[i]].val;
+
+		if (deadline <= limit && deadline > next.val)
+			next.val = deadline;
+	}
+
+	return next;
+}
+
 static void expire_timer(task_id_t tskid)
 {
 	/* we are done with this timer */
-	deprecated_atomic_clear_bits(&timer_running, 1 << tskid);
+	timer_heap_remove(tskid);
+	task_bitmap_clear(timer_running, tskid);
 	/* wake up the taks waiting for this timer */
 	task_set_event(tskid, TASK_EVENT_TIMER, 0);
 }
@@ -58,9 +165,8 @@ int timestamp_expired(timestamp_t deadline, const timestamp_t *now)
 	return ((int64_t)(now->val - deadline.val) >= 0);
 }
 
-void process_timers(int overflow)
+void __hot_code process_timers(int overflow)
 {
-	uint32_t check_timer, running_t0;
 	timestamp_t next;
 	timestamp_t now;
 
@@ -68,35 +174,22 @@ void process_timers(int overflow)
 		clksrc_high++;
 
 	do {
-		next.val = -1ull;
 		now = get_time();
-		do {
-			/* read atomically the current state of timer running */
-			check_timer = running_t0 = timer_running;
-			while (check_timer) {
-
-				int tskid = __fls(check_timer);
-				/* timer has expired ? */
-				if (timer_deadline[tskid].val <= now.val)
-					expire_timer(tskid);
-				else if ((timer_deadline[tskid].le.hi ==
-					  now.le.hi) &&
-					 (timer_deadline[tskid].le.lo <
-					  next.le.lo))
-					next.val = timer_deadline[tskid].val;
-
-				check_timer &= ~BIT(tskid);
-			}
-		/* if there is a new timer, let's retry */
-		} while (timer_running & ~running_t0);
-
-		if (next.le.hi == 0xffffffff) {
+
+		/* Expire every timer whose deadline has passed */
+		while (timer_heap_size &&
+		       timer_deadline[timer_heap[0]].val <= now.val)
+			expire_timer(timer_heap[0]);
+
+		if (!timer_heap_size ||
+		    timer_deadline[timer_heap[0]].le.hi != now.le.hi) {
 			/* no deadline to set */
 			__hw_clock_event_clear();
 			next_deadline = 0xffffffff;
 			return;
 		}
 
+		next = timer_coalesced_deadline();
 		__hw_clock_event_set(next.le.lo);
 		next_deadline = next.le.lo;
 	} while (next.val <= get_time().val);
@@ -128,11 +221,14 @@ int timer_arm(timestamp_t event, task_id_t tskid)
 
 	ASSERT(tskid < TASK_ID_COUNT);
 
-	if (timer_running & BIT(tskid))
+	if (task_bitmap_test(timer_running, tskid))
 		return EC_ERROR_BUSY;
 
+	interrupt_disable();
 	timer_deadline[tskid] = event;
-	deprecated_atomic_or(&timer_running, BIT(tskid));
+	timer_heap_insert(tskid);
+	task_bitmap_set(timer_running, tskid);
+	interrupt_enable();
 
 	/* Modify the next event if needed */
 	if ((event.le.hi < now.le.hi) ||
@@ -146,7 +242,12 @@ void timer_cancel(task_id_t tskid)
 {
 	ASSERT(tskid < TASK_ID_COUNT);
 
-	deprecated_atomic_clear_bits(&timer_running, BIT(tskid));
+	interrupt_disable();
+	if (task_bitmap_test(timer_running, tskid)) {
+		timer_heap_remove(tskid);
+		task_bitmap_clear(timer_running, tskid);
+	}
+	interrupt_enable();
 	/*
 	 * Don't need to cancel the hardware timer interrupt, instead do
 	 * timer-related housekeeping when the next timer interrupt fires.
@@ -211,7 +312,7 @@ timestamp_t get_time(void)
 clock_t clock(void)
 {
 	/* __hw_clock_source_read() returns a microsecond resolution timer.*/
-	return (clock_t) __hw_clock_source_read() / 1000;
+	return (clock_t)udiv1000(__hw_clock_source_read());
 }
 
 void force_time(timestamp_t ts)
@@ -259,7 +360,7 @@ void timer_print_info(void)
 	cflush();
 
 	for (tskid = 0; tskid < TASK_ID_COUNT; tskid++) {
-		if (timer_running & BIT(tskid)) {
+		if (task_bitmap_test(timer_running, tskid)) {
 			ccprintf("  Tsk %2d  0x%016llx -> %11.6lld\n", tskid,
 				 timer_deadline[tskid].val,
 				 timer_deadline[tskid].val - t.val);
@@ -273,8 +374,6 @@ void timer_init(void)
 	const timestamp_t *ts;
 	int size, version;
 
-	BUILD_ASSERT(TASK_ID_COUNT < sizeof(timer_running) * 8);
-
 	/* Restore time from before sysjump */
 	ts = (const timestamp_t *)system_get_jump_tag(TIMER_SYSJUMP_TAG,
 						      &version, &size);
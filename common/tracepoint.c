@@ -0,0 +1,111 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Tracepoints of the EC subsystems, read with EC_CMD_TRACEPOINTS */
+
+#include "common.h"
+#include "console.h"
+#include "host_command.h"
+#include "task.h"
+#include "timer.h"
+#include "tracepoint.h"
+#include "util.h"
+
+BUILD_ASSERT(POWER_OF_TWO(CONFIG_TRACEPOINT_ENTRIES));
+BUILD_ASSERT(EC_TRACEPOINT_CAT_COUNT <= 32);
+
+#define BUILT_MASK (CONFIG_TRACEPOINT_CATEGORIES & \
+		    (BIT(EC_TRACEPOINT_CAT_COUNT) - 1))
+
+uint32_t tracepoint_mask = BUILT_MASK;
+
+static struct ec_tracepoint_entry __bss_slow
+	ring[CONFIG_TRACEPOINT_ENTRIES];
+/* Number of entries recorded since boot */
+static uint32_t ring_seq;
+
+#define RING_MASK (ARRAY_SIZE(ring) - 1)
+
+void tracepoint_record(enum ec_tracepoint_id id, uint32_t arg0,
+		       uint32_t arg1)
+{
+	struct ec_tracepoint_entry *e;
+	uint32_t now = get_time().le.lo;
+	uint8_t task = in_interrupt_context() ? EC_TRACEPOINT_TASK_IRQ :
+						task_get_current();
+
+	/*
+	 * Every task and interrupt records here; only the slot is claimed
+	 * and filled with interrupts off, so that the host command never
+	 * sees half an entry.
+	 */
+	interrupt_disable();
+	e = ring + (ring_seq++ & RING_MASK);
+	e->timestamp = now;
+	e->id = id;
+	e->task = task;
+	e->reserved = 0;
+	e->arg[0] = arg0;
+	e->arg[1] = arg1;
+	interrupt_enable();
+}
+
+static enum ec_status hc_tracepoints(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_tracepoints *p = args->params;
+	struct ec_response_tracepoints *r = args->response;
+	size_t max;
+	uint32_t seq;
+	int i;
+
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	if (p->flags & EC_TRACEPOINTS_SET_MASK)
+		tracepoint_mask = p->mask & BUILT_MASK;
+
+	max = (args->response_max - sizeof(*r)) / sizeof(r->entry[0]);
+
+	interrupt_disable();
+	seq = MAX(p->seq, ring_seq > ARRAY_SIZE(ring) ?
+			  ring_seq - ARRAY_SIZE(ring) : 0);
+	r->seq = seq;
+	r->count = 0;
+	for (i = 0; i < max && seq + i < ring_seq; i++) {
+		r->entry[i] = ring[(seq + i) & RING_MASK];
+		r->count++;
+	}
+	r->next_seq = ring_seq;
+	interrupt_enable();
+
+	r->mask = tracepoint_mask;
+	r->built_mask = BUILT_MASK;
+	memset(r->reserved, 0, sizeof(r->reserved));
+
+	args->response_size = sizeof(*r) + r->count * sizeof(r->entry[0]);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_TRACEPOINTS, hc_tracepoints, EC_VER_MASK(0));
+
+static int command_tracepoints(int argc, char **argv)
+{
+	char *e;
+	uint32_t mask;
+
+	if (argc > 1) {
+		mask = strtoi(argv[1], &e, 0);
+		if (*e)
+			return EC_ERROR_PARAM1;
+		tracepoint_mask = mask & BUILT_MASK;
+	}
+
+	ccprintf("Recording 0x%08x (built 0x%08x), %d events\n",
+		 tracepoint_mask, BUILT_MASK, ring_seq);
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(tracepoints, command_tracepoints,
+			"[mask]",
+			"Show or set the tracepoint categories recorded");
@@ -12,7 +12,9 @@
 #include "hooks.h"
 #include "host_command.h"
 #include "link_defs.h"
+#include "lz4.h"
 #include "printf.h"
+#include "shared_mem.h"
 #include "system.h"
 #include "task.h"
 #include "timer.h"
@@ -53,6 +55,13 @@ static int tx_snapshot_tail;
 static int tx_last_snapshot_head;
 static int tx_next_snapshot_head;
 static int tx_checksum __preserved_logs(tx_checksum);
+#ifdef CONFIG_CONSOLE_ENABLE_READ_V2
+/*
+ * Number of bytes ever added to tx_buf, the cursor of EC_CMD_CONSOLE_READ
+ * v2.  Its low bits always match tx_buf_head.
+ */
+static volatile uint32_t tx_buf_count;
+#endif
 
 static int uart_buffer_calc_checksum(void)
 {
@@ -69,6 +78,9 @@ void uart_init_buffer(void)
 		tx_buf_tail = 0;
 		tx_checksum = 0;
 	}
+#ifdef CONFIG_CONSOLE_ENABLE_READ_V2
+	tx_buf_count = tx_buf_head;
+#endif
 }
 
 /**
@@ -111,6 +123,9 @@ static int __tx_char_raw(void *context, int c)
 
 	tx_buf[tx_buf_head] = c;
 	tx_buf_head = tx_buf_next;
+#ifdef CONFIG_CONSOLE_ENABLE_READ_V2
+	tx_buf_count++;
+#endif
 
 	if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
 		tx_checksum = uart_buffer_calc_checksum();
@@ -176,10 +191,22 @@ void uart_process_output(void)
 
 void uart_process_output(void)
 {
+	/*
+	 * Snapshot the head and work on a local tail, so the fifo is filled
+	 * in one burst without re-reading the volatile pointers per
+	 * character.  The shared tail is only moved once the burst is done.
+	 */
+	int head = tx_buf_head;
+	int tail = tx_buf_tail;
+
 	/* Copy output from buffer until TX fifo full or output buffer empty */
-	while (uart_tx_ready() && (tx_buf_head != tx_buf_tail)) {
-		uart_write_char(tx_buf[tx_buf_tail]);
-		tx_buf_tail = TX_BUF_NEXT(tx_buf_tail);
+	while (tail != head && uart_tx_ready()) {
+		uart_write_char(tx_buf[tail]);
+		tail = TX_BUF_NEXT(tail);
+	}
+
+	if (tail != tx_buf_tail) {
+		tx_buf_tail = tail;
 
 		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
 			tx_checksum = uart_buffer_calc_checksum();
@@ -325,6 +352,37 @@ int uart_vprintf(const char *format, va_list args)
 	return rv;
 }
 
+#ifdef CONFIG_CONSOLE_TOKENIZED
+static int __tx_token_char(void *context, int c)
+{
+	c &= 0xff;
+	if (c >= UART_TOKEN_ESC && c <= UART_TOKEN_END) {
+		if (__tx_char_raw(context, UART_TOKEN_ESC))
+			return 1;
+		c ^= 0x20;
+	}
+	return __tx_char_raw(context, c);
+}
+
+int uart_vtokenize(int flags, const char *format, va_list args)
+{
+	int rv;
+
+	if (__tx_char_raw(NULL, UART_TOKEN_START))
+		return EC_ERROR_OVERFLOW;
+
+	rv = vfntokenize(__tx_token_char, NULL, flags, format, args);
+
+	/* Close truncated records too, so the host can resync */
+	if (__tx_char_raw(NULL, UART_TOKEN_END))
+		rv = EC_ERROR_OVERFLOW;
+
+	uart_tx_start();
+
+	return rv;
+}
+#endif /* CONFIG_CONSOLE_TOKENIZED */
+
 int uart_printf(const char *format, ...)
 {
 	int rv;
@@ -393,6 +451,23 @@ int uart_buffer_full(void)
 	return TX_BUF_NEXT(tx_buf_head) == tx_buf_tail;
 }
 
+int uart_buffer_copy_tail(char *dest, int size)
+{
+	int head = tx_buf_head;
+	int i = head - MIN(size, CONFIG_UART_TX_BUF_SIZE - 1);
+	int count = 0;
+
+	/* Bytes of a buffer which hasn't rolled over yet are still 0 */
+	for (; i != head; i++) {
+		char c = tx_buf[i & (CONFIG_UART_TX_BUF_SIZE - 1)];
+
+		if (c)
+			dest[count++] = c;
+	}
+
+	return count;
+}
+
 #ifdef CONFIG_UART_RX_DMA
 static void uart_rx_dma_init(void)
 {
@@ -414,6 +489,85 @@ DECLARE_HOST_COMMAND(EC_CMD_CONSOLE_SNAPSHOT,
 		     host_command_console_snapshot,
 		     EC_VER_MASK(0));
 
+#ifdef CONFIG_CONSOLE_ENABLE_READ_V2
+/*
+ * Copy output from cursor up to end, skipping the unused bytes of a buffer
+ * which hasn't rolled over yet.  Returns the cursor of the first byte not
+ * copied and sets *size to the number of bytes copied.
+ */
+static uint32_t console_copy(uint8_t *dest, uint16_t *size, uint32_t cursor,
+			     uint32_t end)
+{
+	uint16_t count = 0;
+
+	while (cursor != end && count < *size) {
+		char c = tx_buf[cursor & (CONFIG_UART_TX_BUF_SIZE - 1)];
+
+		if (c)
+			dest[count++] = c;
+		cursor++;
+	}
+
+	*size = count;
+	return cursor;
+}
+
+static enum ec_status console_read_v2(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_console_read_v2 *p = args->params;
+	struct ec_response_console_read_v2 *r = args->response;
+	uint32_t end = tx_buf_count;
+	uint32_t cursor;
+	uint16_t size;
+
+	if (args->params_size < sizeof(*p) || args->response_max < sizeof(*r))
+		return EC_RES_INVALID_PARAM;
+	size = args->response_max - sizeof(*r);
+
+	/*
+	 * Start at the oldest byte still buffered if the one at the cursor
+	 * has been overwritten.  The head position itself is never valid.
+	 */
+	cursor = p->cursor;
+	if (end - cursor > CONFIG_UART_TX_BUF_SIZE - 1)
+		cursor = end - MIN(end, CONFIG_UART_TX_BUF_SIZE - 1);
+
+	r->cursor = cursor;
+	r->flags = 0;
+	r->reserved = 0;
+
+#ifdef CONFIG_CONSOLE_READ_LZ4
+	if (p->flags & EC_CONSOLE_READ_LZ4) {
+		uint8_t *raw;
+		int rv;
+
+		/* Read as much as fits in the response, then compress it */
+		if (shared_mem_acquire(size, (char **)&raw) == EC_SUCCESS) {
+			r->next_cursor = console_copy(raw, &size, cursor, end);
+			rv = lz4_compress(raw, size, r->data, size);
+			if (rv > 0 && rv < size) {
+				r->flags = EC_CONSOLE_READ_LZ4;
+				args->response_size = sizeof(*r) + rv;
+			} else {
+				/* Incompressible; send it as is */
+				memcpy(r->data, raw, size);
+				args->response_size = sizeof(*r) + size;
+			}
+			shared_mem_release(raw);
+			r->size = size;
+			return EC_RES_SUCCESS;
+		}
+	}
+#endif
+
+	r->next_cursor = console_copy(r->data, &size, cursor, end);
+	r->size = size;
+	args->response_size = sizeof(*r) + size;
+
+	return EC_RES_SUCCESS;
+}
+#endif /* CONFIG_CONSOLE_ENABLE_READ_V2 */
+
 static enum ec_status
 host_command_console_read(struct host_cmd_handler_args *args)
 {
@@ -439,6 +593,10 @@ host_command_console_read(struct host_cmd_handler_args *args)
 				(char *)args->response,
 				args->response_max,
 				&args->response_size);
+#endif
+#ifdef CONFIG_CONSOLE_ENABLE_READ_V2
+	} else if (args->version == 2) {
+		return console_read_v2(args);
 #endif
 	}
 	return EC_RES_INVALID_PARAM;
@@ -448,6 +606,9 @@ DECLARE_HOST_COMMAND(EC_CMD_CONSOLE_READ,
 		     EC_VER_MASK(0)
 #ifdef CONFIG_CONSOLE_ENABLE_READ_V1
 		     | EC_VER_MASK(1)
+#endif
+#ifdef CONFIG_CONSOLE_ENABLE_READ_V2
+		     | EC_VER_MASK(2)
 #endif
 		     );
 
@@ -39,6 +39,12 @@ struct {
 	uint32_t top_offset;
 } update_section;
 
+#ifdef CONFIG_USB_UPDATE_PARTIAL
+/* The next session, and the current one, only erase the blocks written. */
+static int partial_pending;
+static int partial;
+#endif
+
 #ifdef CONFIG_TOUCHPAD_VIRTUAL_OFF
 /*
  * Check if a block is within touchpad FW virtual address region, and
@@ -75,6 +81,30 @@ static uint8_t check_update_chunk(uint32_t block_offset, size_t body_size)
 		base = update_section.base_offset;
 		size = update_section.top_offset -
 			 update_section.base_offset;
+#ifdef CONFIG_USB_UPDATE_PARTIAL
+		/*
+		 * Erase the blocks starting in this chunk.  The host sends
+		 * whole erase blocks, so a block this chunk ends in without
+		 * starting it was erased by an earlier chunk.
+		 */
+		if (partial) {
+			base = DIV_ROUND_UP(block_offset,
+					    CONFIG_FLASH_ERASE_SIZE) *
+				CONFIG_FLASH_ERASE_SIZE;
+			size = DIV_ROUND_UP(block_offset + body_size,
+					    CONFIG_FLASH_ERASE_SIZE) *
+				CONFIG_FLASH_ERASE_SIZE;
+			size = MIN(size, update_section.top_offset) - base;
+			if (block_offset + body_size > base &&
+			    flash_physical_erase(base, size) != EC_SUCCESS) {
+				CPRINTF("%s:%d erase failure of 0x%x..+0x%x\n",
+					__func__, __LINE__, base, size);
+				return UPDATE_ERASE_FAILURE;
+			}
+			return UPDATE_SUCCESS;
+		}
+#endif
+
 		/*
 		 * If this is the first chunk for this section, it needs to
 		 * be erased.
@@ -168,6 +198,11 @@ void fw_update_start(struct first_response_pdu *rpdu)
 
 	rpdu->header_type = htobe16(UPDATE_HEADER_TYPE_COMMON);
 
+#ifdef CONFIG_USB_UPDATE_PARTIAL
+	partial = partial_pending;
+	partial_pending = 0;
+#endif
+
 	/* Determine the valid update section. */
 	switch (system_get_image_copy()) {
 	case EC_IMAGE_RO:
@@ -325,3 +360,28 @@ void fw_update_command_handler(void *body,
 void fw_update_complete(void)
 {
 }
+
+#ifdef CONFIG_USB_UPDATE_PARTIAL
+int fw_update_hash_region(uint32_t offset, uint32_t size, uint8_t *digest)
+{
+	struct sha256_ctx ctx;
+
+	if (update_section.base_offset == update_section.top_offset ||
+	    offset < update_section.base_offset ||
+	    offset > update_section.top_offset ||
+	    size > update_section.top_offset - offset)
+		return UPDATE_BAD_ADDR;
+
+	SHA256_init(&ctx);
+	SHA256_update(&ctx, (const uint8_t *)
+		      (offset + CONFIG_PROGRAM_MEMORY_BASE), size);
+	memcpy(digest, SHA256_final(&ctx), SHA256_DIGEST_SIZE);
+
+	return UPDATE_SUCCESS;
+}
+
+void fw_update_partial(void)
+{
+	partial_pending = 1;
+}
+#endif
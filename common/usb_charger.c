@@ -12,6 +12,7 @@
  * is necessary to update charge_manager with detected charger attributes.
  */
 
+#include "atomic.h"
 #include "charge_manager.h"
 #include "charger.h"
 #include "common.h"
@@ -70,9 +71,9 @@ void usb_charger_vbus_change(int port, int vbus_level)
 	/* Update VBUS supplier and signal VBUS change to USB_CHG task */
 	update_vbus_supplier(port, vbus_level);
 
-#ifdef HAS_TASK_USB_CHG_P0
+#if defined(HAS_TASK_USB_CHG_P0) || defined(CONFIG_USB_CHARGER_SINGLE_TASK)
 	/* USB Charger task(s) */
-	task_set_event(USB_CHG_PORT_TO_TASK_ID(port), USB_CHG_EVENT_VBUS, 0);
+	usb_charger_task_set_event(port, USB_CHG_EVENT_VBUS);
 #endif
 
 #if (defined(CONFIG_USB_PD_VBUS_DETECT_CHARGER) \
@@ -120,6 +121,48 @@ static void usb_charger_init(void)
 }
 DECLARE_HOOK(HOOK_INIT, usb_charger_init, HOOK_PRIO_CHARGE_MANAGER_INIT + 1);
 
+#ifdef CONFIG_USB_CHARGER_SINGLE_TASK
+/* Pending USB_CHG_EVENT_* events, 8 bits per port */
+static uint32_t usb_charger_port_events;
+BUILD_ASSERT(CONFIG_USB_PD_PORT_MAX_COUNT <= 4);
+
+void usb_charger_task_set_event(int port, uint8_t event)
+{
+	deprecated_atomic_or(&usb_charger_port_events, event << (8 * port));
+	task_wake(TASK_ID_USB_CHG);
+}
+
+void usb_charger_task(void *u)
+{
+	uint32_t evt;
+	int port;
+
+	for (port = 0; port < board_get_usb_pd_port_count(); port++) {
+		ASSERT(bc12_ports[port].drv->usb_charger_task_event);
+		if (bc12_ports[port].drv->usb_charger_task_init)
+			bc12_ports[port].drv->usb_charger_task_init(port);
+	}
+
+	while (1) {
+		task_wait_event(-1);
+		evt = deprecated_atomic_read_clear(&usb_charger_port_events);
+
+		/*
+		 * Handle all the ports before the charge manager refresh,
+		 * deferred, runs once for all their updates.
+		 */
+		for (port = 0; evt; port++, evt >>= 8)
+			if (evt & 0xff)
+				bc12_ports[port].drv->usb_charger_task_event(
+					port, evt & 0xff);
+	}
+}
+#else
+void usb_charger_task_set_event(int port, uint8_t event)
+{
+	task_set_event(USB_CHG_PORT_TO_TASK_ID(port), event, 0);
+}
+
 void usb_charger_task(void *u)
 {
 	int port = TASK_ID_TO_USB_CHG_PORT(task_get_current());
@@ -127,3 +170,4 @@ void usb_charger_task(void *u)
 	ASSERT(bc12_ports[port].drv->usb_charger_task);
 	bc12_ports[port].drv->usb_charger_task(port);
 }
+#endif /* CONFIG_USB_CHARGER_SINGLE_TASK */
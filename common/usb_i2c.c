@@ -64,8 +64,10 @@ static void usb_i2c_write_packet(struct usb_i2c_config const *config,
 static uint8_t usb_i2c_executable(struct usb_i2c_config const *config)
 {
 	static size_t expected_size;
+	/* Set once expected_size covers the last command of a batch. */
+	static int last_command;
 
-	if (!expected_size) {
+	while (!last_command) {
 		uint8_t peek[4];
 
 		/*
@@ -73,34 +75,110 @@ static uint8_t usb_i2c_executable(struct usb_i2c_config const *config)
 		 * the queue to see if we need to wait for more data.
 		 */
 		if (queue_peek_units(config->consumer.queue,
-				     peek, 0, sizeof(peek))
+				     peek, expected_size, sizeof(peek))
 		    != sizeof(peek)) {
 			/* Not enough data to calculate expected_size. */
 			return 0;
 		}
 		/*
-		 * The first four bytes of the packet will describe its
+		 * The first four bytes of each command will describe its
 		 * expected size.
 		 */
 		/* Header bytes  and extra rc bytes, if present. */
 		if (peek[3] & 0x80)
-			expected_size = 6;
+			expected_size += 6;
 		else
-			expected_size = 4;
+			expected_size += 4;
 
 		/* write count */
 		expected_size += (((size_t)peek[0] & 0xf0) << 4) | peek[2];
+
+		last_command = !(peek[1] & USB_I2C_ADDR_FLAG_MORE);
+
+		/* A batch that can't fit is run, to respond with an error. */
+		if (expected_size > USB_I2C_WRITE_BUFFER) {
+			expected_size = USB_I2C_WRITE_BUFFER;
+			last_command = 1;
+		}
 	}
 
 
 	if (queue_count(config->consumer.queue) >= expected_size) {
 		expected_size = 0;
+		last_command = 0;
 		return 1;
 	}
 
 	return 0;
 }
 
+/*
+ * Execute the commands of a batch, adding the response of each to the USB
+ * queue once it completes.
+ */
+static void usb_i2c_execute_batch(struct usb_i2c_config const *config,
+				  size_t count)
+{
+	const uint8_t *in = (const uint8_t *)config->buffer;
+	uint8_t response[4 + USB_I2C_BATCH_MAX_READ_COUNT];
+	size_t offset = 0;
+	size_t response_size = 0;
+
+	while (offset + 4 <= count) {
+		const uint8_t *header = in + offset;
+		int portindex       = header[0] & 0xf;
+		uint16_t addr_flags = header[1] & 0x7f;
+		int write_count     = ((header[0] << 4) & 0xf00) | header[2];
+		int read_count      = header[3];
+		size_t header_size  = 4;
+		int more            = header[1] & USB_I2C_ADDR_FLAG_MORE;
+		uint16_t status;
+
+		if (read_count & 0x80) {
+			read_count = (header[4] << 7) | (read_count & 0x7f);
+			header_size = 6;
+		}
+
+		if (offset + header_size + write_count > count ||
+		    (!more && offset + header_size + write_count != count)) {
+			/* Not a well formed batch, stop with an error. */
+			status = USB_I2C_WRITE_COUNT_INVALID;
+			read_count = 0;
+			more = 0;
+		} else if (read_count > USB_I2C_BATCH_MAX_READ_COUNT ||
+			   response_size + 4 + read_count >
+			   USB_I2C_READ_BUFFER) {
+			status = USB_I2C_READ_COUNT_INVALID;
+			read_count = 0;
+			more = 0;
+		} else if (!usb_i2c_board_is_enabled()) {
+			status = USB_I2C_DISABLED;
+		} else if (portindex >= i2c_ports_used) {
+			status = USB_I2C_PORT_INVALID;
+		} else if (addr_flags == USB_I2C_CMD_ADDR_FLAGS) {
+			status = USB_I2C_UNSUPPORTED_COMMAND;
+		} else {
+			status = usb_i2c_map_error(
+				i2c_xfer(i2c_ports[portindex].port, addr_flags,
+					 header + header_size, write_count,
+					 response + 4, read_count));
+		}
+
+		if (status != USB_I2C_SUCCESS)
+			memset(response + 4, 0, read_count);
+		response[0] = status & 0xff;
+		response[1] = status >> 8;
+		response[2] = 0;
+		response[3] = 0;
+		QUEUE_ADD_UNITS(config->tx_queue, response, 4 + read_count);
+		response_size += 4 + read_count;
+
+		if (!more)
+			break;
+		offset += header_size + write_count;
+	}
+}
+
 static void usb_i2c_execute(struct usb_i2c_config const *config)
 {
 	/* Payload is ready to execute. */
@@ -112,6 +190,11 @@ static void usb_i2c_execute(struct usb_i2c_config const *config)
 	int read_count      = (config->buffer[1] >> 8) & 0xff;
 	int offset          = 0;    /* Offset for extended reading header. */
 
+	if (count && (config->buffer[0] >> 8) & USB_I2C_ADDR_FLAG_MORE) {
+		usb_i2c_execute_batch(config, count);
+		return;
+	}
+
 	config->buffer[0] = 0;
 	config->buffer[1] = 0;
 
@@ -171,12 +254,26 @@ void usb_i2c_deferred(struct usb_i2c_config const *config)
 		usb_i2c_execute(config);
 }
 
+#ifdef HAS_TASK_USB_I2C
+void usb_i2c_task(void *u)
+{
+	while (1) {
+		task_wait_event(-1);
+		usb_i2c_deferred(&i2c);
+	}
+}
+#endif
+
 static void usb_i2c_written(struct consumer const *consumer, size_t count)
 {
+#ifdef HAS_TASK_USB_I2C
+	task_wake(TASK_ID_USB_I2C);
+#else
 	struct usb_i2c_config const *config =
 		DOWNCAST(consumer, struct usb_i2c_config, consumer);
 
 	hook_call_deferred(config->deferred, 0);
+#endif
 }
 
 struct consumer_ops const usb_i2c_consumer_ops = {
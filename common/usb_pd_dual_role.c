@@ -152,6 +152,58 @@ int pd_find_pdo_index(uint32_t src_cap_cnt, const uint32_t * const src_caps,
 	return ret;
 }
 
+/*
+ * Last PDO selected on each port, with everything it was selected from. Sources
+ * re-advertise the same capabilities after every soft reset, role swap or
+ * GotoMin, and the capabilities are evaluated twice per advertisement, so
+ * most selections are found here.
+ */
+struct pdo_selection {
+	uint32_t src_caps[PDO_MAX_OBJECTS];
+	uint8_t src_cap_cnt;
+	int max_mv;
+	int desired_mw;
+	struct pd_pref_config_t pref;
+	int index;
+};
+static struct pdo_selection pdo_selection[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+/* pd_find_pdo_index() on the source caps of the port, cached */
+static int find_pdo_index_cached(int port, int max_mv, uint32_t *selected_pdo)
+{
+	struct pdo_selection *sel = &pdo_selection[port];
+	uint32_t src_cap_cnt = pd_get_src_cap_cnt(port);
+	const uint32_t * const src_caps = pd_get_src_caps(port);
+	int desired_mw = 0;
+
+	if (IS_ENABLED(CONFIG_USB_PD_PREFER_MV))
+		desired_mw = charge_get_plt_plus_bat_desired_mw();
+
+	if (src_cap_cnt == 0 || src_cap_cnt > PDO_MAX_OBJECTS)
+		return pd_find_pdo_index(src_cap_cnt, src_caps, max_mv,
+					 selected_pdo);
+
+	if (sel->src_cap_cnt != src_cap_cnt || sel->max_mv != max_mv ||
+	    sel->desired_mw != desired_mw ||
+	    memcmp(&sel->pref, &pd_pref_config, sizeof(sel->pref)) ||
+	    memcmp(sel->src_caps, src_caps,
+		   src_cap_cnt * sizeof(src_caps[0]))) {
+		sel->index = pd_find_pdo_index(src_cap_cnt, src_caps, max_mv,
+					       NULL);
+		memcpy(sel->src_caps, src_caps,
+		       src_cap_cnt * sizeof(src_caps[0]));
+		sel->src_cap_cnt = src_cap_cnt;
+		sel->max_mv = max_mv;
+		sel->desired_mw = desired_mw;
+		sel->pref = pd_pref_config;
+	}
+
+	if (selected_pdo)
+		*selected_pdo = src_caps[sel->index];
+
+	return sel->index;
+}
+
 void pd_extract_pdo_power(uint32_t pdo, uint32_t *ma, uint32_t *mv)
 {
 	int max_ma, uw;
@@ -185,7 +237,6 @@ void pd_build_request(int32_t vpd_vdo, uint32_t *rdo, uint32_t *ma,
 	int max_vbus;
 	int vpd_vbus_dcr;
 	int vpd_gnd_dcr;
-	uint32_t src_cap_cnt = pd_get_src_cap_cnt(port);
 	const uint32_t * const src_caps = pd_get_src_caps(port);
 	int charging_allowed;
 	int max_request_allowed;
@@ -219,8 +270,7 @@ void pd_build_request(int32_t vpd_vdo, uint32_t *rdo, uint32_t *ma,
 	 */
 	if (charging_allowed && max_request_allowed) {
 		/* find pdo index for max voltage we can request */
-		pdo_index = pd_find_pdo_index(src_cap_cnt, src_caps,
-						max_request_mv, &pdo);
+		pdo_index = find_pdo_index_cached(port, max_request_mv, &pdo);
 	} else {
 		/* src cap 0 should be vSafe5V */
 		pdo_index = 0;
@@ -321,9 +371,7 @@ void pd_process_source_cap(int port, int cnt, uint32_t *src_caps)
 		uint32_t ma, mv, pdo;
 
 		/* Get max power info that we could request */
-		pd_find_pdo_index(pd_get_src_cap_cnt(port),
-					pd_get_src_caps(port),
-					PD_MAX_VOLTAGE_MV, &pdo);
+		find_pdo_index_cached(port, PD_MAX_VOLTAGE_MV, &pdo);
 		pd_extract_pdo_power(pdo, &ma, &mv);
 
 		/* Set max. limit, but apply 500mA ceiling */
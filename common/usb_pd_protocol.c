@@ -462,11 +462,6 @@ static void sink_can_xmit(int port, int rp)
 
 #ifdef CONFIG_USB_PD_TCPC_LOW_POWER
 
-/* 10 ms is enough time for any TCPC transaction to complete. */
-#define PD_LPM_DEBOUNCE_US (10 * MSEC)
-/* 25 ms on LPM exit to ensure TCPC is settled */
-#define PD_LPM_EXIT_DEBOUNCE_US (25 * MSEC)
-
 /* This is only called from the PD tasks that owns the port. */
 static void handle_device_access(int port)
 {
@@ -793,8 +788,7 @@ static inline void set_state(int port, enum pd_states next_state)
 		 * detach events are used to notify BC1.2 that it can be powered
 		 * down.
 		 */
-		task_set_event(USB_CHG_PORT_TO_TASK_ID(port),
-			       USB_CHG_EVENT_CC_OPEN, 0);
+		usb_charger_task_set_event(port, USB_CHG_EVENT_CC_OPEN);
 #endif /* CONFIG_BC12_DETECT_DATA_ROLE_TRIGGER */
 #ifdef CONFIG_USBC_VCONN
 		set_vconn(port, 0);
@@ -1325,11 +1319,9 @@ static void pd_set_data_role(int port, enum pd_data_role role)
 	 * task and indicate the current data role.
 	 */
 	if (role == PD_ROLE_UFP)
-		task_set_event(USB_CHG_PORT_TO_TASK_ID(port),
-			       USB_CHG_EVENT_DR_UFP, 0);
+		usb_charger_task_set_event(port, USB_CHG_EVENT_DR_UFP);
 	else if (role == PD_ROLE_DFP)
-		task_set_event(USB_CHG_PORT_TO_TASK_ID(port),
-			       USB_CHG_EVENT_DR_DFP, 0);
+		usb_charger_task_set_event(port, USB_CHG_EVENT_DR_DFP);
 #endif /* CONFIG_BC12_DETECT_DATA_ROLE_TRIGGER */
 }
 
@@ -4615,8 +4607,13 @@ void pd_task(void *u)
 			 * TCPC otherwise we might wake it up.
 			 */
 			if (pd[port].flags & PD_FLAGS_LPM_REQUESTED &&
-			    !(evt & PD_EVENT_CC))
+			    !(evt & PD_EVENT_CC)) {
+#ifdef CONFIG_USBC_TASK_IDLE_WAIT
+				/* The TCPC alerts on any CC change */
+				timeout = -1;
+#endif
 				break;
+			}
 
 			/*
 			 * Debounce low power mode exit.  Some TCPCs need time
@@ -4627,8 +4624,13 @@ void pd_task(void *u)
 				uint64_t now;
 
 				now = get_time().val;
-				if (now < pd[port].low_power_exit_time)
+				if (now < pd[port].low_power_exit_time) {
+#ifdef CONFIG_USBC_TASK_IDLE_WAIT
+					timeout = pd[port].low_power_exit_time
+						- now;
+#endif
 					break;
+				}
 
 				CPRINTS("TCPC p%d Exit Low Power Mode done",
 					port);
@@ -4707,6 +4709,14 @@ void pd_task(void *u)
 				tcpm_enable_drp_toggle(port);
 				pd[port].flags |= PD_FLAGS_TCPC_DRP_TOGGLE;
 				set_state(port, PD_STATE_DRP_AUTO_TOGGLE);
+#ifdef CONFIG_USBC_TASK_IDLE_WAIT
+				/*
+				 * The TCPC toggles on its own and alerts on
+				 * a connection, so only the low power mode
+				 * debounce below bounds the wait.
+				 */
+				timeout = -1;
+#endif
 			}
 
 			break;
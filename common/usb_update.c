@@ -384,6 +384,34 @@ static int try_vendor_command(struct consumer const *consumer, size_t count)
 			QUEUE_ADD_UNITS(&update_to_usb, output, write_count);
 			return 1;
 		}
+#endif
+#ifdef CONFIG_USB_UPDATE_PARTIAL
+		case UPDATE_EXTRA_CMD_HASH_REGION: {
+			struct update_hash_region region;
+			struct update_hash_region_response r = { 0 };
+
+			if (data_count != sizeof(region)) {
+				response = EC_RES_INVALID_PARAM;
+				break;
+			}
+
+			memcpy(&region, buffer + header_size, sizeof(region));
+			if (fw_update_hash_region(be32toh(region.offset),
+						  be32toh(region.size),
+						  r.digest)) {
+				response = EC_RES_INVALID_PARAM;
+				break;
+			}
+
+			r.status = EC_RES_SUCCESS;
+			r.erase_size = htobe32(CONFIG_FLASH_ERASE_SIZE);
+			QUEUE_ADD_UNITS(&update_to_usb, &r, sizeof(r));
+			return 1;
+		}
+		case UPDATE_EXTRA_CMD_PARTIAL_UPDATE:
+			fw_update_partial();
+			response = EC_RES_SUCCESS;
+			break;
 #endif
 		default:
 			response = EC_RES_INVALID_COMMAND;
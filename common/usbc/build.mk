@@ -10,6 +10,7 @@ _usbc_dir:=$(dir $(lastword $(MAKEFILE_LIST)))
 ifneq ($(CONFIG_USB_PD_TCPMV2),)
 all-obj-y+=$(_usbc_dir)usb_sm.o
 all-obj-y+=$(_usbc_dir)usbc_task.o
+all-obj-$(CONFIG_USB_PD_TRACE)+=$(_usbc_dir)usb_pd_trace.o
 
 # Type-C state machines
 ifneq ($(CONFIG_USB_TYPEC_SM),)
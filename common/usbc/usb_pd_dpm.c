@@ -11,6 +11,7 @@
 #include "charge_state.h"
 #include "compile_time_macros.h"
 #include "console.h"
+#include "task.h"
 #include "usb_dp_alt_mode.h"
 #include "usb_mode.h"
 #include "usb_pd.h"
@@ -52,6 +53,135 @@ static inline void dpm_clear_mode_exit_request(int port)
 	dpm[port].mode_exit_request = false;
 }
 
+#ifdef CONFIG_USB_PD_DISCOVERY_CACHE
+/* Discovery results of a partner or cable plug, keyed by its identity */
+struct discovery_cache_entry {
+	/* Identity VDOs (VID, XID, PID and bcdDevice, product type VDOs) */
+	uint32_t identity[PDO_MAX_OBJECTS - 1];
+	/* Number of identity VDOs; 0 if the entry is free */
+	uint8_t identity_cnt;
+	/* SOP or SOP' */
+	uint8_t type;
+	uint8_t svid_cnt;
+	/* Value of discovery_cache_clock when last used */
+	uint32_t last_used;
+	struct svid_mode_data svids[CONFIG_USB_PD_DISCOVERY_CACHE_SVIDS];
+};
+
+static struct discovery_cache_entry
+	discovery_cache[CONFIG_USB_PD_DISCOVERY_CACHE_ENTRIES];
+static uint32_t discovery_cache_clock;
+/* The cache is shared by the PD tasks of all ports */
+static struct mutex discovery_cache_lock;
+
+/* Find the entry matching the port's identity.  Must hold the lock. */
+static struct discovery_cache_entry *discovery_cache_find(
+		const struct pd_discovery *disc, enum tcpm_transmit_type type)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(discovery_cache); i++) {
+		struct discovery_cache_entry *e = &discovery_cache[i];
+
+		if (e->identity_cnt == disc->identity_cnt &&
+		    e->type == type &&
+		    !memcmp(e->identity, disc->identity.raw_value,
+			    e->identity_cnt * sizeof(uint32_t)))
+			return e;
+	}
+
+	return NULL;
+}
+
+bool dpm_discovery_cache_restore(int port, enum tcpm_transmit_type type)
+{
+	struct pd_discovery *disc = pd_get_am_discovery(port, type);
+	struct discovery_cache_entry *e;
+
+	if (!disc->identity_cnt)
+		return false;
+
+	mutex_lock(&discovery_cache_lock);
+	e = discovery_cache_find(disc, type);
+	if (e) {
+		memcpy(disc->svids, e->svids,
+		       e->svid_cnt * sizeof(e->svids[0]));
+		disc->svid_cnt = e->svid_cnt;
+		disc->svids_discovery = PD_DISC_COMPLETE;
+		e->last_used = ++discovery_cache_clock;
+	}
+	mutex_unlock(&discovery_cache_lock);
+
+	if (e)
+		CPRINTS("C%d: SOP%s discovery restored from cache", port,
+			type == TCPC_TX_SOP ? "" : "'");
+
+	return e != NULL;
+}
+
+void dpm_discovery_cache_save(int port, enum tcpm_transmit_type type)
+{
+	struct pd_discovery *disc = pd_get_am_discovery(port, type);
+	struct discovery_cache_entry *e;
+	int i;
+
+	if (disc->identity_discovery != PD_DISC_COMPLETE ||
+	    disc->svids_discovery != PD_DISC_COMPLETE ||
+	    pd_get_modes_discovery(port, type) != PD_DISC_COMPLETE ||
+	    !disc->identity_cnt ||
+	    disc->svid_cnt > CONFIG_USB_PD_DISCOVERY_CACHE_SVIDS)
+		return;
+
+	mutex_lock(&discovery_cache_lock);
+	e = discovery_cache_find(disc, type);
+	if (!e) {
+		/* Take a free entry, or else the least recently used one */
+		e = &discovery_cache[0];
+		for (i = 1; i < ARRAY_SIZE(discovery_cache); i++) {
+			if (!e->identity_cnt)
+				break;
+			if (!discovery_cache[i].identity_cnt ||
+			    discovery_cache[i].last_used < e->last_used)
+				e = &discovery_cache[i];
+		}
+	}
+
+	memcpy(e->identity, disc->identity.raw_value,
+	       disc->identity_cnt * sizeof(uint32_t));
+	e->identity_cnt = disc->identity_cnt;
+	e->type = type;
+	memcpy(e->svids, disc->svids, disc->svid_cnt * sizeof(e->svids[0]));
+	e->svid_cnt = disc->svid_cnt;
+	e->last_used = ++discovery_cache_clock;
+	mutex_unlock(&discovery_cache_lock);
+}
+
+/* Forget the cached discovery results matching the port's identity */
+static void dpm_discovery_cache_drop(int port, enum tcpm_transmit_type type)
+{
+	struct discovery_cache_entry *e;
+
+	mutex_lock(&discovery_cache_lock);
+	e = discovery_cache_find(pd_get_am_discovery(port, type), type);
+	if (e)
+		e->identity_cnt = 0;
+	mutex_unlock(&discovery_cache_lock);
+}
+#else
+bool dpm_discovery_cache_restore(int port, enum tcpm_transmit_type type)
+{
+	return false;
+}
+
+void dpm_discovery_cache_save(int port, enum tcpm_transmit_type type)
+{
+}
+
+static void dpm_discovery_cache_drop(int port, enum tcpm_transmit_type type)
+{
+}
+#endif /* CONFIG_USB_PD_DISCOVERY_CACHE */
+
 void dpm_vdm_acked(int port, enum tcpm_transmit_type type, int vdo_count,
 		uint32_t *vdm)
 {
@@ -77,6 +207,13 @@ void dpm_vdm_acked(int port, enum tcpm_transmit_type type, int vdo_count,
 void dpm_vdm_naked(int port, enum tcpm_transmit_type type, uint16_t svid,
 		uint8_t vdm_cmd)
 {
+	/*
+	 * Modes the partner won't enter may have come from a stale cache
+	 * entry; rediscover on the next attach.
+	 */
+	if (vdm_cmd == CMD_ENTER_MODE)
+		dpm_discovery_cache_drop(port, type);
+
 	switch (svid) {
 	case USB_SID_DISPLAYPORT:
 		dp_vdm_naked(port, type, vdm_cmd);
@@ -218,3 +355,11 @@ void dpm_run(int port)
 	else if (!dpm[port].mode_entry_done)
 		dpm_attempt_mode_entry(port);
 }
+
+bool dpm_is_idle(int port)
+{
+	return !dpm[port].mode_exit_request &&
+	       (dpm[port].mode_entry_done ||
+		pd_get_data_role(port) != PD_ROLE_DFP ||
+		chipset_in_or_transitioning_to_state(CHIPSET_STATE_ANY_OFF));
+}
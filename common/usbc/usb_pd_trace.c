@@ -0,0 +1,98 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* USB PD message and state machine trace */
+
+#include "common.h"
+#include "host_command.h"
+#include "task.h"
+#include "timer.h"
+#include "usb_pd.h"
+#include "usb_pd_trace.h"
+#include "util.h"
+
+BUILD_ASSERT(POWER_OF_TWO(CONFIG_USB_PD_TRACE_ENTRIES));
+
+static struct ec_pd_trace_entry __bss_slow
+	pd_trace[CONFIG_USB_PD_TRACE_ENTRIES];
+/* Number of entries recorded since boot */
+static uint32_t pd_trace_seq;
+
+#define TRACE_MASK (ARRAY_SIZE(pd_trace) - 1)
+
+/*
+ * Entries are recorded by the PD task of every port, so each one is written
+ * with interrupts disabled; that is also what keeps the host command from
+ * reading half of one.
+ */
+static void pd_trace_add(const struct ec_pd_trace_entry *e)
+{
+	interrupt_disable();
+	pd_trace[pd_trace_seq & TRACE_MASK] = *e;
+	pd_trace_seq++;
+	interrupt_enable();
+}
+
+void pd_trace_msg(int port, enum ec_pd_trace_type type, int sop,
+		  uint16_t header, const uint32_t *data)
+{
+	struct ec_pd_trace_entry e;
+	int cnt = MIN(PD_HEADER_CNT(header), ARRAY_SIZE(e.data));
+
+	e.timestamp = get_time().le.lo;
+	e.port = port;
+	e.type = type;
+	e.info = sop;
+	e.value = cnt;
+	e.header = header;
+	e.reserved = 0;
+	memcpy(e.data, data, cnt * sizeof(e.data[0]));
+
+	pd_trace_add(&e);
+}
+
+void pd_trace_state(int port, enum ec_pd_trace_sm sm, int state)
+{
+	struct ec_pd_trace_entry e = {
+		.timestamp = get_time().le.lo,
+		.port = port,
+		.type = EC_PD_TRACE_STATE,
+		.info = sm,
+		.value = state,
+	};
+
+	pd_trace_add(&e);
+}
+
+static enum ec_status hc_pd_trace(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_pd_trace *p = args->params;
+	struct ec_response_pd_trace *r = args->response;
+	size_t max;
+	uint32_t seq;
+	int i;
+
+	if (args->response_max < sizeof(*r))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	max = (args->response_max - sizeof(*r)) / sizeof(r->entry[0]);
+
+	interrupt_disable();
+	seq = MAX(p->seq, pd_trace_seq > ARRAY_SIZE(pd_trace) ?
+			  pd_trace_seq - ARRAY_SIZE(pd_trace) : 0);
+	r->seq = seq;
+	r->count = 0;
+	for (i = 0; i < max && seq + i < pd_trace_seq; i++) {
+		r->entry[i] = pd_trace[(seq + i) & TRACE_MASK];
+		r->count++;
+	}
+	r->next_seq = pd_trace_seq;
+	interrupt_enable();
+
+	args->response_size = sizeof(*r) + r->count * sizeof(r->entry[0]);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_PD_TRACE, hc_pd_trace, EC_VER_MASK(0));
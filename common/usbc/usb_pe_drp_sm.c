@@ -22,6 +22,7 @@
 #include "usb_pd_dpm.h"
 #include "usb_pd.h"
 #include "usb_pd_tcpm.h"
+#include "usb_pd_trace.h"
 #include "usb_pe_sm.h"
 #include "usb_tbt_alt_mode.h"
 #include "usb_prl_sm.h"
@@ -638,6 +639,13 @@ static struct policy_engine {
 	 */
 	uint64_t discover_identity_timer;
 
+	/*
+	 * Spacing of the SOP discovery requests, after a BUSY from the port
+	 * partner.  Apart from discover_identity_timer so that partner
+	 * discovery goes ahead between the cable's retries.
+	 */
+	uint64_t sop_discovery_timer;
+
 	/*
 	 * This timer is used in a Source to ensure that the Sink has had
 	 * sufficient time to process Hard Reset Signaling before turning
@@ -1205,6 +1213,10 @@ void pe_got_soft_reset(int port)
 void pd_dpm_request(int port, enum pd_dpm_request req)
 {
 	PE_SET_DPM_REQUEST(port, req);
+
+	/* The PD task may be sleeping in a Ready state */
+	if (task_get_current() != PD_PORT_TO_TASK_ID(port))
+		task_wake(PD_PORT_TO_TASK_ID(port));
 }
 
 void pe_vconn_swap_complete(int port)
@@ -1277,6 +1289,7 @@ static void pe_set_dpm_curr_request(const int port,
 test_export_static void set_state_pe(const int port,
 				     const enum usb_pe_state new_state)
 {
+	pd_trace_state(port, EC_PD_TRACE_SM_PE, new_state);
 	set_state(port, &pe[port].ctx, &pe_states[new_state]);
 }
 
@@ -1337,6 +1350,8 @@ static bool common_src_snk_dpm_requests(int port)
 			pe[port].discover_identity_counter = 0;
 			pe[port].discover_identity_timer = get_time().val +
 						PD_T_DISCOVER_IDENTITY;
+			pe[port].sop_discovery_timer =
+					pe[port].discover_identity_timer;
 		}
 		return true;
 	} else if (PE_CHK_DPM_REQUEST(port, DPM_REQUEST_VDM)) {
@@ -1527,6 +1542,10 @@ static bool port_try_vconn_swap(int port)
  */
 static bool pe_attempt_port_discovery(int port)
 {
+	uint64_t now;
+	bool cable_ready;
+	bool partner_ready;
+
 	/*
 	 * DONE set once modal entry is successful, discovery completes, or
 	 * discovery results in a NAK
@@ -1559,54 +1578,63 @@ static bool pe_attempt_port_discovery(int port)
 		}
 	}
 
-	/* If mode entry was successful, disable the timer */
+	/* If mode entry was successful, disable the timers */
 	if (PE_CHK_FLAG(port, PE_FLAGS_VDM_SETUP_DONE)) {
 		pe[port].discover_identity_timer = TIMER_DISABLED;
+		pe[port].sop_discovery_timer = TIMER_DISABLED;
 		return false;
 	}
 
 	/*
-	 * Run discovery functions when the timer indicating either cable
-	 * discovery spacing or BUSY spacing runs out.
+	 * Run cable and partner discovery as each one's timer (cable
+	 * discovery spacing or BUSY spacing) runs out.  Only one request is
+	 * ever outstanding, but a cable that is slow to answer, or doesn't
+	 * answer at all, no longer holds up the partner's discovery: the SOP
+	 * requests go out while the SOP' ones are waiting for their timer.
 	 */
-	if (get_time().val > pe[port].discover_identity_timer) {
-		if (pd_get_identity_discovery(port, TCPC_TX_SOP_PRIME) ==
-				PD_DISC_NEEDED && pe_can_send_sop_prime(port)) {
-			pe[port].tx_type = TCPC_TX_SOP_PRIME;
-			set_state_pe(port, PE_VDM_IDENTITY_REQUEST_CBL);
-			return true;
-		} else if (pd_get_identity_discovery(port, TCPC_TX_SOP) ==
-				PD_DISC_NEEDED &&
-				pe_can_send_sop_vdm(port, CMD_DISCOVER_IDENT)) {
-			pe[port].tx_type = TCPC_TX_SOP;
-			set_state_pe(port,
-				     PE_INIT_PORT_VDM_IDENTITY_REQUEST);
-			return true;
-		} else if (pd_get_svids_discovery(port, TCPC_TX_SOP) ==
-				PD_DISC_NEEDED &&
-				pe_can_send_sop_vdm(port, CMD_DISCOVER_SVID)) {
-			pe[port].tx_type = TCPC_TX_SOP;
-			set_state_pe(port, PE_INIT_VDM_SVIDS_REQUEST);
-			return true;
-		} else if (pd_get_modes_discovery(port, TCPC_TX_SOP) ==
-				PD_DISC_NEEDED &&
-				pe_can_send_sop_vdm(port, CMD_DISCOVER_MODES)) {
-			pe[port].tx_type = TCPC_TX_SOP;
-			set_state_pe(port, PE_INIT_VDM_MODES_REQUEST);
-			return true;
-		} else if (pd_get_svids_discovery(port, TCPC_TX_SOP_PRIME)
-				== PD_DISC_NEEDED &&
-				pe_can_send_sop_prime(port)) {
-			pe[port].tx_type = TCPC_TX_SOP_PRIME;
-			set_state_pe(port, PE_INIT_VDM_SVIDS_REQUEST);
-			return true;
-		} else if (pd_get_modes_discovery(port, TCPC_TX_SOP_PRIME) ==
-				PD_DISC_NEEDED &&
-				pe_can_send_sop_prime(port)) {
-			pe[port].tx_type = TCPC_TX_SOP_PRIME;
-			set_state_pe(port, PE_INIT_VDM_MODES_REQUEST);
-			return true;
-		}
+	now = get_time().val;
+	cable_ready = now > pe[port].discover_identity_timer &&
+		      pe_can_send_sop_prime(port);
+	partner_ready = now > pe[port].sop_discovery_timer;
+
+	if (cable_ready && pd_get_identity_discovery(port, TCPC_TX_SOP_PRIME)
+			== PD_DISC_NEEDED) {
+		pe[port].tx_type = TCPC_TX_SOP_PRIME;
+		set_state_pe(port, PE_VDM_IDENTITY_REQUEST_CBL);
+		return true;
+	} else if (partner_ready &&
+			pd_get_identity_discovery(port, TCPC_TX_SOP) ==
+			PD_DISC_NEEDED &&
+			pe_can_send_sop_vdm(port, CMD_DISCOVER_IDENT)) {
+		pe[port].tx_type = TCPC_TX_SOP;
+		set_state_pe(port, PE_INIT_PORT_VDM_IDENTITY_REQUEST);
+		return true;
+	} else if (partner_ready &&
+			pd_get_svids_discovery(port, TCPC_TX_SOP) ==
+			PD_DISC_NEEDED &&
+			pe_can_send_sop_vdm(port, CMD_DISCOVER_SVID)) {
+		pe[port].tx_type = TCPC_TX_SOP;
+		set_state_pe(port, PE_INIT_VDM_SVIDS_REQUEST);
+		return true;
+	} else if (partner_ready &&
+			pd_get_modes_discovery(port, TCPC_TX_SOP) ==
+			PD_DISC_NEEDED &&
+			pe_can_send_sop_vdm(port, CMD_DISCOVER_MODES)) {
+		pe[port].tx_type = TCPC_TX_SOP;
+		set_state_pe(port, PE_INIT_VDM_MODES_REQUEST);
+		return true;
+	} else if (cable_ready &&
+			pd_get_svids_discovery(port, TCPC_TX_SOP_PRIME) ==
+			PD_DISC_NEEDED) {
+		pe[port].tx_type = TCPC_TX_SOP_PRIME;
+		set_state_pe(port, PE_INIT_VDM_SVIDS_REQUEST);
+		return true;
+	} else if (cable_ready &&
+			pd_get_modes_discovery(port, TCPC_TX_SOP_PRIME) ==
+			PD_DISC_NEEDED) {
+		pe[port].tx_type = TCPC_TX_SOP_PRIME;
+		set_state_pe(port, PE_INIT_VDM_MODES_REQUEST);
+		return true;
 	}
 
 	return false;
@@ -1800,6 +1828,7 @@ static void pe_src_startup_entry(int port)
 		 * set, vdm_identity_request_cbl will handle the timer updates.
 		 */
 		pe[port].discover_identity_timer = get_time().val;
+		pe[port].sop_discovery_timer = get_time().val;
 
 		/* Clear port discovery flags */
 		pd_dfp_discovery_init(port);
@@ -2205,6 +2234,26 @@ static void extended_message_not_supported(int port, uint32_t *payload)
 	set_state_pe(port, PE_SEND_NOT_SUPPORTED);
 }
 
+/*
+ * Tell the USB-C task when a Ready state is left with nothing to do but wait
+ * for a message, a DPM request or one of its timers.
+ */
+static void pe_ready_idle(int port, enum usb_pe_state state, uint64_t deadline)
+{
+	if (!IS_ENABLED(CONFIG_USBC_TASK_IDLE_WAIT))
+		return;
+
+	if (get_state_pe(port) != state || pe[port].dpm_request ||
+	    PE_CHK_FLAG(port, PE_FLAGS_MSG_RECEIVED |
+			      PE_FLAGS_VDM_REQUEST_CONTINUE) ||
+	    !PE_CHK_FLAG(port, PE_FLAGS_VDM_SETUP_DONE) ||
+	    prl_is_busy(port) || !dpm_is_idle(port))
+		return;
+
+	usbc_task_idle(port, USBC_TASK_SM_PE,
+		       MIN(deadline, pe[port].wait_and_add_jitter_timer));
+}
+
 /**
  * PE_SRC_Ready
  */
@@ -2449,6 +2498,10 @@ static void pe_src_ready_run(int port)
 		/* No DPM requests; attempt mode entry/exit if needed */
 		dpm_run(port);
 	}
+
+	pe_ready_idle(port, PE_SRC_READY,
+		      PE_CHK_FLAG(port, PE_FLAGS_WAITING_PR_SWAP) ?
+		      pe[port].pr_swap_wait_timer : TIMER_DISABLED);
 }
 
 /**
@@ -2648,6 +2701,7 @@ static void pe_snk_startup_entry(int port)
 		 * snk_ready for the first time.
 		 */
 		pe[port].discover_identity_timer = get_time().val;
+		pe[port].sop_discovery_timer = get_time().val;
 
 		/* Clear port discovery flags */
 		pd_dfp_discovery_init(port);
@@ -3237,6 +3291,8 @@ static void pe_snk_ready_run(int port)
 		dpm_run(port);
 
 	}
+
+	pe_ready_idle(port, PE_SNK_READY, pe[port].sink_request_timer);
 }
 
 /**
@@ -4611,7 +4667,11 @@ static enum vdm_response_result parse_vdm_response_common(int port)
 			 */
 			CPRINTS("C%d: Partner BUSY, request will be retried",
 					port);
-			pe[port].discover_identity_timer =
+			if (pe[port].tx_type == TCPC_TX_SOP)
+				pe[port].sop_discovery_timer =
+					get_time().val + PD_T_VDM_BUSY;
+			else
+				pe[port].discover_identity_timer =
 					get_time().val + PD_T_VDM_BUSY;
 
 			return VDM_RESULT_NO_ACTION;
@@ -4727,6 +4787,22 @@ static void pe_vdm_send_request_exit(int port)
 	pe[port].tx_type = TCPC_TX_INVALID;
 }
 
+/*
+ * After a Discover Identity ACK, take the SVIDs and modes from the DPM's
+ * discovery cache if this partner or cable was seen before.  Discovery is
+ * then done, so notify the AP as the Discover Modes exit would have.
+ */
+static void pe_discovery_cache_restore(int port, enum tcpm_transmit_type type)
+{
+	if (!IS_ENABLED(CONFIG_USB_PD_DISCOVERY_CACHE) ||
+	    !dpm_discovery_cache_restore(port, type))
+		return;
+
+	pe_notify_event(port, type == TCPC_TX_SOP ?
+			PD_STATUS_EVENT_SOP_DISC_DONE :
+			PD_STATUS_EVENT_SOP_PRIME_DISC_DONE);
+}
+
 /**
  * PE_VDM_IDENTITY_REQUEST_CBL
  * Combination of PE_INIT_PORT_VDM_Identity_Request State specific to the
@@ -4812,6 +4888,7 @@ static void pe_vdm_identity_request_cbl_run(int port)
 	case VDM_RESULT_ACK:
 		/* PE_INIT_PORT_VDM_Identity_ACKed embedded here */
 		dfp_consume_identity(port, sop, cnt, payload);
+		pe_discovery_cache_restore(port, sop);
 
 		/*
 		 * Note: If port partner runs PD 2.0, we must use PD 2.0 to
@@ -4951,6 +5028,7 @@ static void pe_init_port_vdm_identity_request_run(int port)
 
 		/* PE_INIT_PORT_VDM_Identity_ACKed embedded here */
 		dfp_consume_identity(port, sop, cnt, payload);
+		pe_discovery_cache_restore(port, sop);
 		break;
 		}
 	case VDM_RESULT_NAK:
@@ -5175,12 +5253,14 @@ static void pe_init_vdm_modes_request_run(int port)
 
 static void pe_init_vdm_modes_request_exit(int port)
 {
-	if (pd_get_modes_discovery(port, pe[port].tx_type) != PD_DISC_NEEDED)
+	if (pd_get_modes_discovery(port, pe[port].tx_type) != PD_DISC_NEEDED) {
 		/* Mode discovery done, notify the AP */
 		pe_notify_event(port, pe[port].tx_type == TCPC_TX_SOP ?
 				PD_STATUS_EVENT_SOP_DISC_DONE :
 				PD_STATUS_EVENT_SOP_PRIME_DISC_DONE);
-
+		if (IS_ENABLED(CONFIG_USB_PD_DISCOVERY_CACHE))
+			dpm_discovery_cache_save(port, pe[port].tx_type);
+	}
 }
 
 /**
@@ -24,6 +24,7 @@
 #include "usb_charge.h"
 #include "usb_mux.h"
 #include "usb_pd.h"
+#include "usb_pd_trace.h"
 #include "usb_pe_sm.h"
 #include "usb_prl_sm.h"
 #include "usb_tc_sm.h"
@@ -40,6 +41,9 @@
 #define CPRINTS(format, args...)
 #endif
 
+/* Unreachable time in future */
+#define TIMER_DISABLED 0xffffffffffffffff
+
 #define RCH_SET_FLAG(port, flag) deprecated_atomic_or(&rch[port].flags, (flag))
 #define RCH_CLR_FLAG(port, flag) \
 	deprecated_atomic_clear_bits(&rch[port].flags, (flag))
@@ -295,9 +299,15 @@ static struct pd_message {
 	uint16_t data_objs;
 	/* temp chunk buffer */
 	uint32_t tx_chk_buf[CHK_BUF_SIZE];
-	uint32_t rx_chk_buf[CHK_BUF_SIZE];
+	/* last received chunk, dequeued in place into rx_emsg */
+	uint32_t *rx_chk_buf;
 	uint32_t chunk_number_expected;
 	uint32_t num_bytes_received;
+#ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
+	/* bytes of the message being assembled overlapped by rx_chk_buf */
+	uint8_t rx_saved[4];
+	uint8_t rx_saved_len;
+#endif
 #ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
 	/* extended message */
 	uint8_t ext;
@@ -361,6 +371,7 @@ GEN_NOT_SUPPORTED(TCH_REPORT_ERROR);
 static void set_state_prl_tx(const int port,
 			     const enum usb_prl_tx_state new_state)
 {
+	pd_trace_state(port, EC_PD_TRACE_SM_PRL_TX, new_state);
 	set_state(port, &prl_tx[port].ctx, &prl_tx_states[new_state]);
 }
 
@@ -382,6 +393,7 @@ static void print_current_prl_tx_state(const int port)
 static void set_state_prl_hr(const int port,
 			     const enum usb_prl_hr_state new_state)
 {
+	pd_trace_state(port, EC_PD_TRACE_SM_PRL_HR, new_state);
 	set_state(port, &prl_hr[port].ctx, &prl_hr_states[new_state]);
 }
 
@@ -403,6 +415,7 @@ static void print_current_prl_hr_state(const int port)
 static void set_state_rch(const int port, const enum usb_rch_state new_state)
 {
 #ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
+	pd_trace_state(port, EC_PD_TRACE_SM_RCH, new_state);
 	set_state(port, &rch[port].ctx, &rch_states[new_state]);
 #endif /* CONFIG_USB_PD_REV30 */
 }
@@ -427,6 +440,7 @@ static void print_current_rch_state(const int port)
 static void set_state_tch(const int port, const enum usb_tch_state new_state)
 {
 #ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
+	pd_trace_state(port, EC_PD_TRACE_SM_TCH, new_state);
 	set_state(port, &tch[port].ctx, &tch_states[new_state]);
 #endif /* CONFIG_USB_PD_REV30 */
 }
@@ -693,6 +707,13 @@ void prl_run(int port, int evt, int en)
 
 		/* Run Protocol Layer Hard Reset state machine */
 		run_state(port, &prl_hr[port].ctx);
+
+		/* Received messages come in with a PD_EVENT_RX */
+		if (prl_tx_get_state(port) == PRL_TX_WAIT_FOR_MESSAGE_REQUEST &&
+		    prl_hr_get_state(port) == PRL_HR_WAIT_FOR_REQUEST &&
+		    !PRL_TX_CHK_FLAG(port, PRL_FLAGS_MSG_XMIT) &&
+		    !prl_is_busy(port))
+			usbc_task_idle(port, USBC_TASK_SM_PRL, TIMER_DISABLED);
 		break;
 	}
 }
@@ -1000,6 +1021,8 @@ static void prl_tx_construct_message(const int port)
 	 * should not retry those messages. We do not support that and probably
 	 * never will (since we support chunking).
 	 */
+	pd_trace_msg(port, EC_PD_TRACE_TX, pdmsg[port].xmit_type, header,
+		     pdmsg[port].tx_chk_buf);
 	tcpm_transmit(port, pdmsg[port].xmit_type, header,
 		      pdmsg[port].tx_chk_buf);
 }
@@ -1300,15 +1323,58 @@ static void prl_hr_wait_for_pe_hard_reset_complete_exit(const int port)
 	}
 }
 
+/*
+ * Messages are dequeued straight into the extended message buffer. While an
+ * extended message is being assembled, the next chunk is dequeued at the last
+ * word boundary that keeps its extended header below the data received so
+ * far: odd chunks land at their final offset, even ones are moved up two bytes
+ * in place. The bytes of the previous chunk it overlaps are saved here and put
+ * back by rx_chunk_restore().
+ */
+static void rx_chunk_prepare(int port)
+{
+	uint32_t offset = 0;
+
+#ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
+	uint32_t received = pdmsg[port].num_bytes_received;
+
+	pdmsg[port].rx_saved_len = 0;
+	if ((rch_get_state(port) == RCH_REQUESTING_CHUNK ||
+	     rch_get_state(port) == RCH_WAITING_CHUNK) && received >= 2) {
+		offset = MIN((received - 2) & ~3,
+			     EXTENDED_BUFFER_SIZE - CHK_BUF_SIZE_BYTES);
+		pdmsg[port].rx_saved_len = MIN(received - offset,
+					       sizeof(pdmsg[port].rx_saved));
+		memcpy(pdmsg[port].rx_saved, rx_emsg[port].buf + offset,
+		       pdmsg[port].rx_saved_len);
+	}
+#endif
+
+	pdmsg[port].rx_chk_buf = (uint32_t *)(rx_emsg[port].buf + offset);
+}
+
+static void rx_chunk_restore(int port)
+{
+#ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
+	memcpy(pdmsg[port].rx_chk_buf, pdmsg[port].rx_saved,
+	       pdmsg[port].rx_saved_len);
+	pdmsg[port].rx_saved_len = 0;
+#endif
+}
+
 static void copy_chunk_to_ext(int port)
 {
 	/* Calculate number of bytes */
 	pdmsg[port].num_bytes_received =
 				(PD_HEADER_CNT(rx_emsg[port].header) * 4);
 
-	/* Copy chunk into extended message */
-	memcpy((uint8_t *)rx_emsg[port].buf, (uint8_t *)pdmsg[port].rx_chk_buf,
-		pdmsg[port].num_bytes_received);
+	/*
+	 * The message is already in the extended buffer, it only has to move
+	 * if it was received in the middle of an extended message.
+	 */
+	if ((uint8_t *)pdmsg[port].rx_chk_buf != rx_emsg[port].buf)
+		memmove(rx_emsg[port].buf, pdmsg[port].rx_chk_buf,
+			pdmsg[port].num_bytes_received);
 
 	/* Set extended message length */
 	rx_emsg[port].len = pdmsg[port].num_bytes_received;
@@ -1429,6 +1495,7 @@ static void rch_processing_extended_message_run(const int port)
 	uint8_t chunk_num = PD_EXT_HEADER_CHUNK_NUM(exhdr);
 	uint32_t data_size = PD_EXT_HEADER_DATA_SIZE(exhdr);
 	uint32_t byte_num;
+	uint8_t *data;
 
 	/*
 	 * Abort Flag Set
@@ -1455,12 +1522,15 @@ static void rch_processing_extended_message_run(const int port)
 			return;
 		}
 
-		/* Append data */
-		/* Add 2 to chk_buf to skip over extended message header */
-		memcpy(((uint8_t *)rx_emsg[port].buf +
-				pdmsg[port].num_bytes_received),
-				(uint8_t *)pdmsg[port].rx_chk_buf + 2,
-				byte_num);
+		/*
+		 * Append data: the chunk was dequeued in place, skip over its
+		 * extended message header and put back the overlapped bytes.
+		 */
+		data = (uint8_t *)pdmsg[port].rx_chk_buf + 2;
+		if (data != rx_emsg[port].buf + pdmsg[port].num_bytes_received)
+			memmove(rx_emsg[port].buf +
+				pdmsg[port].num_bytes_received, data, byte_num);
+		rx_chunk_restore(port);
 		/* increment chunk number expected */
 		pdmsg[port].chunk_number_expected++;
 		/* adjust num bytes received */
@@ -1978,9 +2048,14 @@ static void prl_rx_wait_for_phy_message(const int port, int evt)
 		return;
 
 	/* If we don't have any message, just stop processing now. */
-	if (!tcpm_has_pending_message(port) ||
-	    tcpm_dequeue_message(port, pdmsg[port].rx_chk_buf, &header))
+	if (!tcpm_has_pending_message(port))
+		return;
+
+	rx_chunk_prepare(port);
+	if (tcpm_dequeue_message(port, pdmsg[port].rx_chk_buf, &header)) {
+		rx_chunk_restore(port);
 		return;
+	}
 
 	rx_emsg[port].header = header;
 	type = PD_HEADER_TYPE(header);
@@ -1988,6 +2063,9 @@ static void prl_rx_wait_for_phy_message(const int port, int evt)
 	msid = PD_HEADER_ID(header);
 	prl_rx[port].sop = PD_HEADER_GET_SOP(header);
 
+	pd_trace_msg(port, EC_PD_TRACE_RX, prl_rx[port].sop, header,
+		     pdmsg[port].rx_chk_buf);
+
 	/* Make sure an incorrect count doesn't overflow the chunk buffer */
 	if (cnt > CHK_BUF_SIZE)
 		cnt = CHK_BUF_SIZE;
@@ -2010,8 +2088,10 @@ static void prl_rx_wait_for_phy_message(const int port, int evt)
 	if (!IS_ENABLED(CONFIG_USB_CTVPD) &&
 	    !IS_ENABLED(CONFIG_USB_VPD) &&
 	    PD_HEADER_GET_SOP(header) != PD_MSG_SOP &&
-	    PD_HEADER_PROLE(header) == PD_PLUG_FROM_DFP_UFP)
+	    PD_HEADER_PROLE(header) == PD_PLUG_FROM_DFP_UFP) {
+		rx_chunk_restore(port);
 		return;
+	}
 
 	/* Handle incoming soft reset as special case */
 	if (cnt == 0 && type == PD_CTRL_SOFT_RESET) {
@@ -2047,8 +2127,10 @@ static void prl_rx_wait_for_phy_message(const int port, int evt)
 	/*
 	 * Ignore if this is a duplicate message. Stop processing.
 	 */
-	if (prl_rx[port].msg_id[prl_rx[port].sop] == msid)
+	if (prl_rx[port].msg_id[prl_rx[port].sop] == msid) {
+		rx_chunk_restore(port);
 		return;
+	}
 
 	/*
 	 * Discard any pending tx message if this is
@@ -2078,6 +2160,7 @@ static void prl_rx_wait_for_phy_message(const int port, int evt)
 		 */
 		if (cnt == 0 && type == PD_CTRL_PING) {
 			/* NOTE: RTR_PING State embedded here. */
+			rx_chunk_restore(port);
 			rx_emsg[port].len = 0;
 			pe_message_received(port);
 			return;
@@ -29,34 +29,39 @@ struct internal_ctx {
 BUILD_ASSERT(sizeof(struct internal_ctx) ==
 	     member_size(struct sm_ctx, internal));
 
-/* Gets the first shared parent state between a and b (inclusive) */
-static usb_state_ptr shared_parent_state(usb_state_ptr a, usb_state_ptr b)
+/* Gets the number of states from s up to its root state (inclusive) */
+static int state_depth(usb_state_ptr s)
 {
-	const usb_state_ptr orig_b = b;
+	int depth = 0;
 
-	/* There are no common ancestors */
-	if (b == NULL)
-		return NULL;
+	for (; s != NULL; s = s->parent)
+		depth++;
 
-	/* This assumes that both A and B are NULL terminated without cycles */
-	while (a != NULL) {
-		/* We found a match return */
-		if (a == b)
-			return a;
+	return depth;
+}
 
-		/*
-		 * Otherwise, increment b down the list for comparison until we
-		 * run out, then increment a and start over on b for comparison
-		 */
-		if (b->parent == NULL) {
-			a = a->parent;
-			b = orig_b;
-		} else {
-			b = b->parent;
-		}
+/* Gets the first shared parent state between a and b (inclusive) */
+static usb_state_ptr shared_parent_state(usb_state_ptr a, usb_state_ptr b)
+{
+	int depth_a = state_depth(a);
+	int depth_b = state_depth(b);
+
+	/*
+	 * Bring both states to the same depth, then walk them up together
+	 * until they meet. This assumes that both A and B are NULL terminated
+	 * without cycles.
+	 */
+	for (; depth_a > depth_b; depth_a--)
+		a = a->parent;
+	for (; depth_b > depth_a; depth_b--)
+		b = b->parent;
+
+	while (a != b) {
+		a = a->parent;
+		b = b->parent;
 	}
 
-	return NULL;
+	return a;
 }
 
 /*
@@ -67,24 +72,35 @@ static usb_state_ptr shared_parent_state(usb_state_ptr a, usb_state_ptr b)
 static void call_entry_functions(const int port,
 			       struct internal_ctx *const internal,
 			       const usb_state_ptr stop,
-			       const usb_state_ptr current)
+			       usb_state_ptr current)
 {
-	if (current == stop)
-		return;
+	usb_state_ptr path[USB_SM_MAX_DEPTH];
+	int i = 0;
 
-	call_entry_functions(port, internal, stop, current->parent);
+	/* Collect the states to enter, children first */
+	for (; current != stop; current = current->parent) {
+		ASSERT(i < ARRAY_SIZE(path));
+		path[i++] = current;
+	}
 
-	/*
-	 * If the previous entry function called set_state, then don't enter
-	 * remaining states.
-	 */
-	if (!internal->enter)
-		return;
+	while (i > 0) {
+		current = path[--i];
 
-	/* Track the latest state that was entered, so we can exit properly. */
-	internal->last_entered = current;
-	if (current->entry)
-		current->entry(port);
+		/*
+		 * If the previous entry function called set_state, then don't
+		 * enter remaining states.
+		 */
+		if (!internal->enter)
+			return;
+
+		/*
+		 * Track the latest state that was entered, so we can exit
+		 * properly.
+		 */
+		internal->last_entered = current;
+		if (current->entry)
+			current->entry(port);
+	}
 }
 
 /*
@@ -92,15 +108,12 @@ static void call_entry_functions(const int port,
  * during an exit function.
  */
 static void call_exit_functions(const int port, const usb_state_ptr stop,
-			      const usb_state_ptr current)
+			      usb_state_ptr current)
 {
-	if (current == stop)
-		return;
-
-	if (current->exit)
-		current->exit(port);
-
-	call_exit_functions(port, stop, current->parent);
+	for (; current != stop; current = current->parent) {
+		if (current->exit)
+			current->exit(port);
+	}
 }
 
 void set_state(const int port, struct sm_ctx *const ctx,
@@ -172,24 +185,19 @@ void set_state(const int port, struct sm_ctx *const ctx,
 
 /*
  * Call all run functions of children before parents. If set_state is called
- * during one of the entry functions, then do not call any remaining entry
+ * during one of the run functions, then do not call any remaining run
  * functions.
  */
 static void call_run_functions(const int port,
 			     const struct internal_ctx *const internal,
-			     const usb_state_ptr current)
+			     usb_state_ptr current)
 {
-	if (!current)
-		return;
-
 	/* If set_state is called during run, don't call remain functions. */
-	if (!internal->running)
-		return;
-
-	if (current->run)
-		current->run(port);
-
-	call_run_functions(port, internal, current->parent);
+	for (; current != NULL && internal->running;
+	     current = current->parent) {
+		if (current->run)
+			current->run(port);
+	}
 }
 
 void run_state(const int port, struct sm_ctx *const ctx)
@@ -15,6 +15,7 @@
 #include "usb_mux.h"
 #include "usb_pd.h"
 #include "usb_pd_dpm.h"
+#include "usb_pd_trace.h"
 #include "usb_pe_sm.h"
 #include "usb_prl_sm.h"
 #include "usb_sm.h"
@@ -129,20 +130,13 @@ void print_flag(int set_or_clear, int flag);
 #define CLR_ALL_BUT_LPM_FLAGS(port) TC_CLR_FLAG(port, \
 	~(TC_FLAGS_LPM_ENGAGED | TC_FLAGS_SUSPEND))
 
-/* 100 ms is enough time for any TCPC transaction to complete. */
-#define PD_LPM_DEBOUNCE_US (100 * MSEC)
-
 /*
- * This delay is not part of the USB Type-C specification or the USB port
- * controller specification. Some TCPCs require extra time before the CC_STATUS
- * register is updated when exiting low power mode.
- *
- * This delay can be possibly shortened or removed by checking VBUS state
- * before trying to re-enter LPM.
+ * The low power mode debounces are shared with TCPMv1, see usb_pd.h. The exit
+ * debounce can be possibly shortened or removed by checking VBUS state before
+ * trying to re-enter LPM.
  *
  * TODO(b/162347811): TCPMv2: Wait for debounce on Vbus and CC lines
  */
-#define PD_LPM_EXIT_DEBOUNCE_US CONFIG_USB_PD_TCPC_LPM_EXIT_DEBOUNCE
 
 /*
  * The TypeC state machine uses this bit to disable/enable PD
@@ -160,6 +154,12 @@ void print_flag(int set_or_clear, int flag);
 /* Unreachable time in future */
 #define TIMER_DISABLED 0xffffffffffffffff
 
+/*
+ * Detach polling period of the attached states when the USB-C task may sleep,
+ * well within tSinkDisconnect and tVBUSOFF.
+ */
+#define TC_ATTACHED_POLL_US (20 * MSEC)
+
 enum ps_reset_sequence {
 	PS_STATE0,
 	PS_STATE1,
@@ -1089,7 +1089,6 @@ bool pd_is_disconnected(int port)
 static __maybe_unused void bc12_role_change_handler(int port)
 {
 	int event;
-	int task_id = USB_CHG_PORT_TO_TASK_ID(port);
 
 	/* Get the data role of our device */
 	switch (pd_get_data_role(port)) {
@@ -1105,7 +1104,7 @@ static __maybe_unused void bc12_role_change_handler(int port)
 	default:
 		return;
 	}
-	task_set_event(task_id, event, 0);
+	usb_charger_task_set_event(port, event);
 }
 
 /*
@@ -1443,6 +1442,7 @@ static void set_state_tc(const int port, const enum usb_tc_state new_state)
 {
 	assert(port == TASK_ID_TO_PD_PORT(task_get_current()));
 
+	pd_trace_state(port, EC_PD_TRACE_SM_TC, new_state);
 	set_state(port, &tc[port].ctx, &tc_states[new_state]);
 }
 
@@ -2398,6 +2398,14 @@ static void tc_attached_snk_run(const int port)
 		}
 	}
 
+	/* Keep polling VBUS for a detach, but not on every pass */
+	if (get_state_tc(port) == TC_ATTACHED_SNK &&
+	    !TC_CHK_FLAG(port, TC_FLAGS_HARD_RESET_REQUESTED |
+			       TC_FLAGS_PR_SWAP_IN_PROGRESS |
+			       TC_FLAGS_POWER_OFF_SNK))
+		usbc_task_idle(port, USBC_TASK_SM_TC,
+			       get_time().val + TC_ATTACHED_POLL_US);
+
 #else /* CONFIG_USB_PE_SM */
 
 	/* Detach detection */
@@ -2912,6 +2920,12 @@ static void tc_attached_src_run(const int port)
 		}
 	}
 #endif
+
+	/* Keep polling the CC lines for a detach, but not on every pass */
+	if (get_state_tc(port) == TC_ATTACHED_SRC &&
+	    !TC_CHK_FLAG(port, TC_FLAGS_HARD_RESET_REQUESTED))
+		usbc_task_idle(port, USBC_TASK_SM_TC,
+			       get_time().val + TC_ATTACHED_POLL_US);
 }
 
 static void tc_attached_src_exit(const int port)
@@ -3019,6 +3033,14 @@ static void tc_drp_auto_toggle_run(const int port)
 			set_state_tc(port, TC_LOW_POWER_MODE);
 		}
 	}
+
+	/*
+	 * The TCPC reports a connection with an alert, which sets
+	 * TC_FLAGS_CHECK_CONNECTION from a PD_EVENT_CC.
+	 */
+	if (get_state_tc(port) == TC_DRP_AUTO_TOGGLE &&
+	    !TC_CHK_FLAG(port, TC_FLAGS_CHECK_CONNECTION))
+		usbc_task_idle(port, USBC_TASK_SM_TC, tc[port].timeout);
 }
 #endif /* CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE */
 
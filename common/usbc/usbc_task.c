@@ -33,12 +33,22 @@
 #include "version.h"
 
 #define USBC_EVENT_TIMEOUT (5 * MSEC)
+#define TIMER_DISABLED 0xffffffffffffffff /* Unreachable time in future */
 
 #define CPRINTF(format, args...) cprintf(CC_USBPD, format, ## args)
 #define CPRINTS(format, args...) cprints(CC_USBPD, format, ## args)
 
 static uint8_t paused[CONFIG_USB_PD_PORT_MAX_COUNT];
 
+/*
+ * Idle state machines and their earliest deadline on the current pass, and
+ * whether the previous pass was idle, see usbc_task_idle().
+ */
+static uint8_t idle_sms[CONFIG_USB_PD_PORT_MAX_COUNT];
+static uint64_t idle_deadline[CONFIG_USB_PD_PORT_MAX_COUNT];
+static bool idle_pass[CONFIG_USB_PD_PORT_MAX_COUNT];
+static int idle_timeout[CONFIG_USB_PD_PORT_MAX_COUNT];
+
 void tc_pause_event_loop(int port)
 {
 	paused[port] = 1;
@@ -61,6 +71,8 @@ static void pd_task_init(int port)
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_state_init(port);
 	paused[port] = 0;
+	idle_pass[port] = false;
+	idle_timeout[port] = USBC_EVENT_TIMEOUT;
 
 	/*
 	 * Since most boards configure the TCPC interrupt as edge
@@ -73,13 +85,64 @@ static void pd_task_init(int port)
 		schedule_deferred_pd_interrupt(port);
 }
 
+void usbc_task_idle(int port, enum usbc_task_sm sm, uint64_t deadline)
+{
+	if (!IS_ENABLED(CONFIG_USBC_TASK_IDLE_WAIT))
+		return;
+
+	idle_sms[port] |= BIT(sm);
+	idle_deadline[port] = MIN(idle_deadline[port], deadline);
+}
+
+static void idle_pass_start(int port)
+{
+	idle_sms[port] = 0;
+	idle_deadline[port] = TIMER_DISABLED;
+}
+
+/*
+ * Returns how long to wait for the next event after a pass. A state machine
+ * that hands something to another one on an idle pass still gets to run it
+ * on the next one, since only two idle passes in a row let the task sleep.
+ */
+static int idle_pass_end(int port)
+{
+	uint8_t running = 0;
+	bool was_idle = idle_pass[port];
+	uint64_t now;
+
+	if (!IS_ENABLED(CONFIG_USBC_TASK_IDLE_WAIT) ||
+	    IS_ENABLED(CONFIG_USB_PD_TCPC))
+		return USBC_EVENT_TIMEOUT;
+
+	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
+		running |= BIT(USBC_TASK_SM_TC);
+	if (IS_ENABLED(CONFIG_USB_PE_SM) && tc_get_pd_enabled(port))
+		running |= BIT(USBC_TASK_SM_PE);
+	if (IS_ENABLED(CONFIG_USB_PRL_SM) && tc_get_pd_enabled(port))
+		running |= BIT(USBC_TASK_SM_PRL);
+
+	idle_pass[port] = (idle_sms[port] & running) == running;
+	if (!idle_pass[port] || !was_idle)
+		return USBC_EVENT_TIMEOUT;
+
+	if (idle_deadline[port] == TIMER_DISABLED)
+		return -1;
+
+	/* A zero timeout would wait forever */
+	now = get_time().val;
+	if (idle_deadline[port] <= now)
+		return 1;
+	return MIN(idle_deadline[port] - now, INT32_MAX);
+}
+
 static bool pd_task_loop(int port)
 {
 	/* wait for next event/packet or timeout expiration */
 	const uint32_t evt =
 		task_wait_event(paused[port]
 					? -1
-					: USBC_EVENT_TIMEOUT);
+					: idle_timeout[port]);
 
 	/*
 	 * Re-use TASK_EVENT_RESET_DONE in tests to restart the USB task
@@ -88,6 +151,8 @@ static bool pd_task_loop(int port)
 	if (IS_ENABLED(TEST_BUILD) && (evt & TASK_EVENT_RESET_DONE))
 		return false;
 
+	idle_pass_start(port);
+
 	/* handle events that affect the state machine as a whole */
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_event_check(port, evt);
@@ -111,6 +176,8 @@ static bool pd_task_loop(int port)
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_run(port);
 
+	idle_timeout[port] = idle_pass_end(port);
+
 	return true;
 }
 
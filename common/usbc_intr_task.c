@@ -5,17 +5,22 @@
 
 /* High-priority interrupt tasks implementations */
 
+#include "atomic.h"
 #include "console.h"
 #include "task.h"
 #include "timer.h"
+#include "usb_charge.h"
 #include "usb_mux.h"
 #include "usb_pd.h"
+#include "usbc_ppc.h"
 
 #define CPRINTF(format, args...) cprintf(CC_USBPD, format, ## args)
 #define CPRINTS(format, args...) cprints(CC_USBPD, format, ## args)
 
 /* Events for pd_interrupt_handler_task */
 #define PD_PROCESS_INTERRUPT  BIT(0)
+#define PD_PROCESS_PPC_INTERRUPT  BIT(1)
+#define PD_PROCESS_BC12_INTERRUPT  BIT(2)
 
 /*
  * Theoretically, we may need to support up to 480 USB-PD packets per second for
@@ -32,6 +37,35 @@ void schedule_deferred_pd_interrupt(const int port)
 	task_set_event(pd_int_task_id[port], PD_PROCESS_INTERRUPT, 0);
 }
 
+#ifdef CONFIG_USB_PD_INT_DISPATCH
+/* Ports with a PPC interrupt not serviced yet */
+static uint32_t ppc_int_pending;
+
+void schedule_deferred_ppc_interrupt(const int port)
+{
+	deprecated_atomic_or(&ppc_int_pending, BIT(port));
+	task_set_event(pd_int_task_id[port], PD_PROCESS_PPC_INTERRUPT, 0);
+}
+
+void schedule_deferred_bc12_interrupt(const int port)
+{
+	task_set_event(pd_int_task_id[port], PD_PROCESS_BC12_INTERRUPT, 0);
+}
+
+static void service_ppc_interrupt(int port)
+{
+	if (!(ppc_int_pending & BIT(port)))
+		return;
+
+	deprecated_atomic_clear_bits(&ppc_int_pending, BIT(port));
+	ppc_handle_interrupt(port);
+}
+#else
+static void service_ppc_interrupt(int port)
+{
+}
+#endif /* CONFIG_USB_PD_INT_DISPATCH */
+
 /*
  * Main task entry point that handles PD interrupts for a single port
  *
@@ -60,6 +94,10 @@ void pd_interrupt_handler_task(void *p)
 	while (1) {
 		const int evt = task_wait_event(-1);
 
+		/* Faults first */
+		if (evt & PD_PROCESS_PPC_INTERRUPT)
+			service_ppc_interrupt(port);
+
 		if (evt & PD_PROCESS_INTERRUPT) {
 			/*
 			 * While the interrupt signal is asserted; we have more
@@ -77,6 +115,7 @@ void pd_interrupt_handler_task(void *p)
 				timestamp_t now;
 
 				tcpc_alert(port);
+				service_ppc_interrupt(port);
 
 				now = get_time();
 				if (timestamp_expired(storm_tracker[port].time,
@@ -101,5 +140,11 @@ void pd_interrupt_handler_task(void *p)
 				}
 			}
 		}
+
+#if defined(HAS_TASK_USB_CHG_P0) || defined(CONFIG_USB_CHARGER_SINGLE_TASK)
+		/* Detection last */
+		if (evt & PD_PROCESS_BC12_INTERRUPT)
+			usb_charger_task_set_event(port, USB_CHG_EVENT_BC12);
+#endif
 	}
 }
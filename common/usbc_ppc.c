@@ -303,6 +303,20 @@ int ppc_enter_low_power_mode(int port)
 	return rv;
 }
 
+void ppc_handle_interrupt(int port)
+{
+	const struct ppc_config_t *ppc;
+
+	if ((port < 0) || (port >= ppc_cnt)) {
+		CPRINTS("%s(%d) Invalid port!", __func__, port);
+		return;
+	}
+
+	ppc = &ppc_chips[port];
+	if (ppc->drv->handle_interrupt)
+		ppc->drv->handle_interrupt(port);
+}
+
 int ppc_vbus_source_enable(int port, int enable)
 {
 	int rv = EC_ERROR_UNIMPLEMENTED;
@@ -294,18 +294,12 @@ __stdlib_compat void *memcpy(void *dest, const void *src, size_t len)
 	/* Set 'body' to the last word boundary */
 	uint32_t * const body = (uint32_t *)((uintptr_t)tail & ~3);
 
-	if (((uintptr_t)dest & 3) != ((uintptr_t)src & 3)) {
-		/* Misaligned. no body, no tail. */
+	if ((uintptr_t)tail < (((uintptr_t)d + 3) & ~3))
+		/* len is shorter than the first word boundary */
 		head = tail;
-	} else {
-		/* Aligned */
-		if ((uintptr_t)tail < (((uintptr_t)d + 3) & ~3))
-			/* len is shorter than the first word boundary */
-			head = tail;
-		else
-			/* Set 'head' to the first word boundary */
-			head = (char *)(((uintptr_t)d + 3) & ~3);
-	}
+	else
+		/* Set 'head' to the first word boundary */
+		head = (char *)(((uintptr_t)d + 3) & ~3);
 
 	/* Copy head */
 	while (d < head)
@@ -313,13 +307,49 @@ __stdlib_compat void *memcpy(void *dest, const void *src, size_t len)
 
 	/* Copy body */
 	dw = (uint32_t *)d;
-	sw = (uint32_t *)s;
-	while (dw < body)
-		*(dw++) = *(sw++);
+	if (((uintptr_t)s & 3) == 0) {
+		sw = (const uint32_t *)s;
+		/*
+		 * Four words per iteration, which compilers turn into load and
+		 * store multiple instructions where the core has them.
+		 */
+		while (body - dw >= 4) {
+			uint32_t w0 = sw[0], w1 = sw[1], w2 = sw[2], w3 = sw[3];
+
+			dw[0] = w0;
+			dw[1] = w1;
+			dw[2] = w2;
+			dw[3] = w3;
+			dw += 4;
+			sw += 4;
+		}
+		while (dw < body)
+			*(dw++) = *(sw++);
+		s = (const char *)sw;
+	}
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	else if (dw < body) {
+		/*
+		 * Misaligned source: read aligned words and shift them into
+		 * place. The last word read is the one holding the last source
+		 * byte of the body, so nothing past the source is read.
+		 */
+		const int shift = ((uintptr_t)s & 3) * 8;
+		uint32_t prev, next;
+
+		sw = (const uint32_t *)((uintptr_t)s & ~3);
+		prev = *(sw++);
+		while (dw < body) {
+			next = *(sw++);
+			*(dw++) = (prev >> shift) | (next << (32 - shift));
+			prev = next;
+		}
+		s += (char *)dw - d;
+	}
+#endif
 
 	/* Copy tail */
 	d = (char *)dw;
-	s = (const char *)sw;
 	while (d < tail)
 		*(d++) = *(s++);
 
@@ -353,8 +383,15 @@ __stdlib_compat __visible void *memset(void *dest, int c, size_t len)
 	while (d < head)
 		*(d++) = c;
 
-	/* Copy body */
+	/* Copy body, four words per iteration like memcpy() */
 	dw = (uint32_t *)d;
+	while (body - dw >= 4) {
+		dw[0] = cccc;
+		dw[1] = cccc;
+		dw[2] = cccc;
+		dw[3] = cccc;
+		dw += 4;
+	}
 	while (dw < body)
 		*(dw++) = cccc;
 
@@ -404,9 +441,26 @@ __stdlib_compat void *memmove(void *dest, const void *src, size_t len)
 		while (d > head)
 			*(--d) = *(--s);
 
-		/* Copy body */
+		/*
+		 * Copy body, four words per iteration like memcpy(). All four
+		 * are read before any is written, so the overlap is safe.
+		 */
 		dw = (uint32_t *)d;
 		sw = (uint32_t *)s;
+		while (dw - body >= 4) {
+			uint32_t w0, w1, w2, w3;
+
+			dw -= 4;
+			sw -= 4;
+			w0 = sw[0];
+			w1 = sw[1];
+			w2 = sw[2];
+			w3 = sw[3];
+			dw[0] = w0;
+			dw[1] = w1;
+			dw[2] = w2;
+			dw[3] = w3;
+		}
 		while (dw > body)
 			*(--dw) = *(--sw);
 
@@ -494,10 +548,29 @@ __stdlib_compat int strncmp(const char *s1, const char *s2, size_t n)
 }
 
 
+/*
+ * 32-bit division, using the reciprocal helpers for the common constant
+ * divisors.
+ */
+static inline uint32_t udiv32(uint32_t n, uint32_t d)
+{
+	switch (d) {
+	case 10:
+		return udiv10(n);
+	case 1000:
+		return udiv1000(n);
+	case 1000000:
+		return udiv1000000(n);
+	default:
+		return n / d;
+	}
+}
+
 int uint64divmod(uint64_t *n, int d)
 {
-	uint64_t q = 0, mask;
-	int r = 0;
+	uint32_t ud = d;
+	uint32_t hi, lo, q_hi, q_lo, r;
+	int bits, shift;
 
 	/* Divide-by-zero returns zero */
 	if (!d) {
@@ -519,22 +592,46 @@ int uint64divmod(uint64_t *n, int d)
 	/* If v fits in 32-bit, we're done. */
 	if (*n <= 0xffffffff) {
 		uint32_t v32 = *n;
-		r = v32 % d;
-		*n = v32 / d;
-		return r;
+
+		q_lo = udiv32(v32, ud);
+		*n = q_lo;
+		return v32 - q_lo * ud;
 	}
 
-	/* Otherwise do integer division the slow way. */
-	for (mask = (1ULL << 63); mask; mask >>= 1) {
-		r <<= 1;
-		if (*n & mask)
-			r |= 1;
-		if (r >= d) {
-			r -= d;
-			q |= mask;
+	hi = *n >> 32;
+	lo = *n;
+
+	/* The high word divides on its own, leaving a remainder below d. */
+	q_hi = udiv32(hi, ud);
+	r = hi - q_hi * ud;
+
+	/*
+	 * Then bring down the low word as many bits at a time as fit above the
+	 * remainder, so every step is a 32-bit division. That is two or three
+	 * steps for the usual divisors, instead of one per bit.
+	 */
+	bits = MAX(__builtin_clz(ud), 1);
+	q_lo = 0;
+	for (shift = 32; shift > 0;) {
+		int b = MIN(bits, shift);
+		uint32_t x, q;
+
+		shift -= b;
+		if (ud & BIT(31)) {
+			/* No spare bit above the remainder: one bit at a time */
+			uint64_t x64 = ((uint64_t)r << 1) | ((lo >> shift) & 1);
+
+			q = x64 >= ud;
+			r = x64 - (q ? ud : 0);
+		} else {
+			x = (r << b) | ((lo >> shift) & ((1U << b) - 1));
+			q = udiv32(x, ud);
+			r = x - q * ud;
 		}
+		q_lo = (q_lo << b) | q;
 	}
-	*n = q;
+
+	*n = ((uint64_t)q_hi << 32) | q_lo;
 	return r;
 }
 
@@ -218,10 +218,10 @@ void vboot_main(void)
 		return;
 	}
 
-	clock_enable_module(MODULE_FAST_CPU, 1);
+	clock_request_fast_cpu(MODULE_VBOOT, 1);
 	/* If successful, this won't return. */
 	verify_and_jump();
-	clock_enable_module(MODULE_FAST_CPU, 0);
+	clock_request_fast_cpu(MODULE_VBOOT, 0);
 
 	/* Failed to jump. Need recovery. */
 	show_critical_error();
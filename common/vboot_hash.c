@@ -13,11 +13,13 @@
 #include "host_command.h"
 #include "sha256.h"
 #include "shared_mem.h"
+#include "spi_flash.h"
 #include "stdbool.h"
 #include "system.h"
 #include "task.h"
 #include "timer.h"
 #include "util.h"
+#include "vboot_hash.h"
 #include "watchdog.h"
 
 /* Console output macros */
@@ -50,6 +52,74 @@ static int in_progress;
 
 static struct sha256_ctx ctx;
 
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+/*
+ * SHA-256 state after each checkpoint_stride bytes of the last hash started
+ * without a nonce.  Flash writes drop the checkpoints past the first byte
+ * written, so hashing the same region again restarts from the last one left.
+ */
+static uint32_t checkpoint[CONFIG_VBOOT_HASH_CHECKPOINTS][8];
+static uint32_t checkpoint_offset;
+static uint32_t checkpoint_size;
+static uint32_t checkpoint_stride;
+static int checkpoint_count;   /* Valid entries in checkpoint[] */
+static int checkpointing;      /* Current hash saves checkpoints */
+
+/**
+ * Save a checkpoint if the hash just reached the next one.
+ */
+static void checkpoint_save(void)
+{
+	if (!checkpointing || ctx.len ||
+	    checkpoint_count == CONFIG_VBOOT_HASH_CHECKPOINTS ||
+	    curr_pos != (checkpoint_count + 1) * checkpoint_stride)
+		return;
+
+	memcpy(checkpoint[checkpoint_count++], ctx.h, sizeof(ctx.h));
+}
+
+/**
+ * Start a hash of <size> bytes at <offset>, from a checkpoint if possible.
+ *
+ * Sets curr_pos to where hashing resumes, or 0 if it starts over.
+ */
+static void checkpoint_start(uint32_t offset, uint32_t size)
+{
+	if (offset == checkpoint_offset && size == checkpoint_size &&
+	    checkpoint_count) {
+		memcpy(ctx.h, checkpoint[checkpoint_count - 1], sizeof(ctx.h));
+		curr_pos = checkpoint_count * checkpoint_stride;
+		ctx.tot_len = curr_pos;
+		CPRINTS("hash resume 0x%08x", data_offset + curr_pos);
+	} else {
+		checkpoint_offset = offset;
+		checkpoint_size = size;
+		checkpoint_stride = MAX(CONFIG_FLASH_ERASE_SIZE,
+				DIV_ROUND_UP(size, CONFIG_VBOOT_HASH_CHECKPOINTS *
+					     CONFIG_FLASH_ERASE_SIZE) *
+				CONFIG_FLASH_ERASE_SIZE);
+		checkpoint_count = 0;
+	}
+}
+
+void vboot_hash_trim_checkpoints(int offset, int size)
+{
+	uint32_t first;
+
+	if (offset < 0 || size <= 0 || offset + size < 0)
+		return;
+
+	if (!checkpoint_count || offset + size <= checkpoint_offset ||
+	    offset >= checkpoint_offset + checkpoint_size)
+		return;
+
+	first = offset > checkpoint_offset ? offset - checkpoint_offset : 0;
+	checkpoint_count = MIN(checkpoint_count,
+			       (int)(first / checkpoint_stride));
+}
+#endif
+
+
 int vboot_hash_in_progress(void)
 {
 	return in_progress;
@@ -73,7 +143,61 @@ void vboot_hash_abort(void)
 static void vboot_hash_next_chunk(void);
 DECLARE_DEFERRED(vboot_hash_next_chunk);
 
-#ifndef CONFIG_MAPPED_STORAGE
+#ifdef CONFIG_VBOOT_HASH_PIPELINED
+
+/*
+ * Read and hash a chunk in SPI_FLASH_MAX_READ_SIZE pieces, hashing each
+ * piece while DMA brings in the next one.
+ */
+static int read_and_hash_chunk(int offset, int size)
+{
+	uint8_t *buf[2];
+	char *mem;
+	int piece, next, i, rv;
+
+	if (size == 0)
+		return EC_SUCCESS;
+
+	rv = shared_mem_acquire(2 * SPI_FLASH_MAX_READ_SIZE, &mem);
+	if (rv == EC_ERROR_BUSY) {
+		/* Couldn't update hash right now; try again later */
+		hook_call_deferred(&vboot_hash_next_chunk_data,
+				   WORK_INTERVAL_US);
+		return rv;
+	} else if (rv != EC_SUCCESS) {
+		vboot_hash_abort();
+		return rv;
+	}
+	buf[0] = (uint8_t *)mem;
+	buf[1] = buf[0] + SPI_FLASH_MAX_READ_SIZE;
+
+	piece = MIN(size, SPI_FLASH_MAX_READ_SIZE);
+	rv = spi_flash_read_start(buf[0], offset, piece);
+	for (i = 0; rv == EC_SUCCESS; i ^= 1) {
+		rv = spi_flash_read_finish();
+		if (rv != EC_SUCCESS)
+			break;
+
+		offset += piece;
+		size -= piece;
+		next = MIN(size, SPI_FLASH_MAX_READ_SIZE);
+		if (next)
+			rv = spi_flash_read_start(buf[i ^ 1], offset, next);
+
+		SHA256_update(&ctx, buf[i], piece);
+		if (!next)
+			break;
+		piece = next;
+	}
+
+	if (rv != EC_SUCCESS)
+		vboot_hash_abort();
+
+	shared_mem_release(mem);
+	return rv;
+}
+
+#elif !defined(CONFIG_MAPPED_STORAGE)
 
 static int read_and_hash_chunk(int offset, int size)
 {
@@ -106,6 +230,22 @@ static int read_and_hash_chunk(int offset, int size)
 
 #endif
 
+/**
+ * Returns the size of the next chunk to hash.
+ */
+static int next_chunk_size(void)
+{
+	int size = MIN(CHUNK_SIZE, data_size - curr_pos);
+
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+	/* Don't hash across a checkpoint */
+	if (checkpointing)
+		size = MIN(size, checkpoint_stride -
+				 curr_pos % checkpoint_stride);
+#endif
+	return size;
+}
+
 #ifdef CONFIG_CONSOLE_VERBOSE
 #define SHA256_PRINT_SIZE SHA256_DIGEST_SIZE
 #else
@@ -128,15 +268,18 @@ static void hash_next_chunk(size_t size)
 static void vboot_hash_all_chunks(void)
 {
 	do {
-		size_t size = MIN(CHUNK_SIZE, data_size - curr_pos);
+		size_t size = next_chunk_size();
 		hash_next_chunk(size);
 		curr_pos += size;
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+		checkpoint_save();
+#endif
 	} while (curr_pos < data_size);
 
 	hash = SHA256_final(&ctx);
 	CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
 	in_progress = 0;
-	clock_enable_module(MODULE_FAST_CPU, 0);
+	clock_request_fast_cpu(MODULE_VBOOT_HASH, 0);
 
 	return;
 }
@@ -151,16 +294,23 @@ static void vboot_hash_next_chunk(void)
 	/* Handle abort */
 	if (want_abort) {
 		in_progress = 0;
-		clock_enable_module(MODULE_FAST_CPU, 0);
+		clock_request_fast_cpu(MODULE_VBOOT_HASH, 0);
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+		/* Flash may have been written anywhere meanwhile */
+		checkpoint_count = 0;
+#endif
 		vboot_hash_abort();
 		return;
 	}
 
 	/* Compute the next chunk of hash */
-	size = MIN(CHUNK_SIZE, data_size - curr_pos);
+	size = next_chunk_size();
 	hash_next_chunk(size);
 
 	curr_pos += size;
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+	checkpoint_save();
+#endif
 	if (curr_pos >= data_size) {
 		/* Store the final hash */
 		hash = SHA256_final(&ctx);
@@ -168,7 +318,7 @@ static void vboot_hash_next_chunk(void)
 
 		in_progress = 0;
 
-		clock_enable_module(MODULE_FAST_CPU, 0);
+		clock_request_fast_cpu(MODULE_VBOOT_HASH, 0);
 
 		/* Handle receiving abort during finalize */
 		if (want_abort)
@@ -213,7 +363,7 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 		return EC_ERROR_INVAL;
 	}
 
-	clock_enable_module(MODULE_FAST_CPU, 1);
+	clock_request_fast_cpu(MODULE_VBOOT_HASH, 1);
 	/* Save new hash request */
 	data_offset = offset;
 	data_size = size;
@@ -227,6 +377,11 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 	SHA256_init(&ctx);
 	if (nonce_size)
 		SHA256_update(&ctx, nonce, nonce_size);
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+	else
+		checkpoint_start(offset, size);
+	checkpointing = !nonce_size;
+#endif
 
 	if (deferred)
 		hook_call_deferred(&vboot_hash_next_chunk_data, 0);
@@ -242,6 +397,10 @@ int vboot_hash_invalidate(int offset, int size)
 	if (offset < 0 || size <= 0 || offset + size < 0)
 		return 0;
 
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+	vboot_hash_trim_checkpoints(offset, size);
+#endif
+
 	/* Don't invalidate if hash is already invalid */
 	if (!hash)
 		return 0;
@@ -380,6 +539,11 @@ static int command_hash(int argc, char **argv)
 			ccprintf("%ph\n", HEX_BUF(hash, SHA256_DIGEST_SIZE));
 		else
 			ccprintf("(invalid)\n");
+#ifdef CONFIG_VBOOT_HASH_CHECKPOINTS
+		ccprintf("Checkpoints: %d of 0x%x bytes at 0x%08x\n",
+			 checkpoint_count, checkpoint_stride,
+			 checkpoint_offset);
+#endif
 
 		return EC_SUCCESS;
 	}
@@ -48,7 +48,13 @@ void fpv3_add(fpv3_t out, const fpv3_t a, const fpv3_t b)
 
 fp_t fpv3_dot(const fpv3_t v, const fpv3_t w)
 {
+#ifdef CONFIG_FPU
 	return fp_mul(v[X], w[X]) + fp_mul(v[Y], w[Y]) + fp_mul(v[Z], w[Z]);
+#else
+	/* Accumulate the products at full precision and shift only once. */
+	return (fp_t)(((fp_inter_t)v[X] * w[X] + (fp_inter_t)v[Y] * w[Y] +
+		       (fp_inter_t)v[Z] * w[Z]) >> FP_BITS);
+#endif
 }
 
 fp_t fpv3_norm_squared(const fpv3_t v)
@@ -0,0 +1,67 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "window_stats.h"
+
+void window_stats_reset(struct window_stats *stats)
+{
+	window_stats_center(stats, INT_TO_FP(0), INT_TO_FP(0), INT_TO_FP(0));
+}
+
+void window_stats_center(struct window_stats *stats, fp_t x, fp_t y, fp_t z)
+{
+	stats->num_samples = 0;
+	stats->assumed_mean[X] = x;
+	stats->assumed_mean[Y] = y;
+	stats->assumed_mean[Z] = z;
+	stats->sum[X] = stats->sum[Y] = stats->sum[Z] = INT_TO_FP(0);
+	stats->sum_sq[X] = stats->sum_sq[Y] = stats->sum_sq[Z] = INT_TO_FP(0);
+}
+
+void window_stats_add(struct window_stats *stats, fp_t x, fp_t y, fp_t z)
+{
+	fp_t delta;
+
+	stats->num_samples++;
+
+	delta = x - stats->assumed_mean[X];
+	stats->sum[X] += delta;
+	stats->sum_sq[X] += fp_sq(delta);
+
+	delta = y - stats->assumed_mean[Y];
+	stats->sum[Y] += delta;
+	stats->sum_sq[Y] += fp_sq(delta);
+
+	delta = z - stats->assumed_mean[Z];
+	stats->sum[Z] += delta;
+	stats->sum_sq[Z] += fp_sq(delta);
+}
+
+bool window_stats_compute(const struct window_stats *stats, bool sample_var,
+			  fpv3_t mean, fpv3_t var)
+{
+	fp_t inv_n, inv_var;
+	fp_t mean_delta;
+	int i;
+
+	if (stats->num_samples < (sample_var ? 2 : 1))
+		return false;
+
+	inv_n = fp_div(INT_TO_FP(1), INT_TO_FP(stats->num_samples));
+	inv_var = sample_var ?
+		fp_div(INT_TO_FP(1), INT_TO_FP(stats->num_samples - 1)) :
+		inv_n;
+
+	/* var = (sum(d^2) - mean(d) * sum(d)) / (n or n - 1) */
+	for (i = X; i <= Z; i++) {
+		mean_delta = fp_mul(stats->sum[i], inv_n);
+		var[i] = fp_mul(stats->sum_sq[i] -
+				fp_mul(mean_delta, stats->sum[i]), inv_var);
+		if (mean)
+			mean[i] = mean_delta + stats->assumed_mean[i];
+	}
+
+	return true;
+}
@@ -50,6 +50,34 @@ void cpu_enable_caches(void)
 	}
 }
 
+/* Apply a D-cache maintenance operation by address to each line in a range */
+static void cpu_dcache_range_op(volatile uint32_t *reg, uintptr_t base,
+				unsigned int length)
+{
+	uintptr_t addr = base & ~(CPU_DCACHE_LINE_SIZE - 1);
+	uintptr_t end = base + length;
+
+	asm volatile("dsb");
+	for (; addr < end; addr += CPU_DCACHE_LINE_SIZE)
+		*reg = addr;
+	asm volatile("dsb; isb");
+}
+
+void cpu_invalidate_dcache_range(uintptr_t base, unsigned int length)
+{
+	cpu_dcache_range_op(&CPU_SCB_DCIMVAC, base, length);
+}
+
+void cpu_clean_dcache_range(uintptr_t base, unsigned int length)
+{
+	cpu_dcache_range_op(&CPU_SCB_DCCMVAC, base, length);
+}
+
+void cpu_clean_invalidate_dcache_range(uintptr_t base, unsigned int length)
+{
+	cpu_dcache_range_op(&CPU_SCB_DCCIMVAC, base, length);
+}
+
 static void cpu_sysjump_cache(void)
 {
 	/*
@@ -23,6 +23,7 @@
 /* Nested Vectored Interrupt Controller */
 #define CPU_NVIC_EN(x)         CPUREG(0xe000e100 + 4 * (x))
 #define CPU_NVIC_DIS(x)        CPUREG(0xe000e180 + 4 * (x))
+#define CPU_NVIC_PEND(x)       CPUREG(0xe000e200 + 4 * (x))
 #define CPU_NVIC_UNPEND(x)     CPUREG(0xe000e280 + 4 * (x))
 #define CPU_NVIC_PRI(x)        CPUREG(0xe000e400 + 4 * (x))
 /* SCB AIRCR : Application interrupt and reset control register */
@@ -67,9 +68,22 @@ enum {
 #define CPU_SCB_CCSIDR         CPUREG(0xe000ed80)
 #define CPU_SCB_CCSELR         CPUREG(0xe000ed84)
 #define CPU_SCB_ICIALLU        CPUREG(0xe000ef50)
+#define CPU_SCB_DCIMVAC        CPUREG(0xe000ef5c)
 #define CPU_SCB_DCISW          CPUREG(0xe000ef60)
+#define CPU_SCB_DCCMVAC        CPUREG(0xe000ef68)
+#define CPU_SCB_DCCIMVAC       CPUREG(0xe000ef70)
 #define CPU_SCB_DCCISW         CPUREG(0xe000ef74)
 
+/* Size of a D-cache line on the Cortex-M7 */
+#define CPU_DCACHE_LINE_SIZE   32
+
+/* Debug and trace: cycle counter */
+#define CPU_SCB_DEMCR          CPUREG(0xe000edfc)
+#define  CPU_SCB_DEMCR_TRCENA   BIT(24)
+#define CPU_DWT_CTRL           CPUREG(0xe0001000)
+#define  CPU_DWT_CTRL_CYCCNTENA BIT(0)
+#define CPU_DWT_CYCCNT         CPUREG(0xe0001004)
+
 /* Set up the cpu to detect faults */
 void cpu_init(void);
 /* Enable the CPU I-cache and D-cache if they are not already enabled */
@@ -79,8 +93,14 @@ void cpu_invalidate_dcache(void);
 /* Clean and Invalidate the D-cache to the Point of Coherency */
 void cpu_clean_invalidate_dcache(void);
 
-/* Invalidate a single range of the D-cache */
+/*
+ * Invalidate a single range of the D-cache.  Lines the range only partly
+ * covers lose whatever else was written to them, so the range should be
+ * aligned to CPU_DCACHE_LINE_SIZE.
+ */
 void cpu_invalidate_dcache_range(uintptr_t base, unsigned int length);
+/* Clean a single range of the D-cache, e.g. before a DMA reads it */
+void cpu_clean_dcache_range(uintptr_t base, unsigned int length);
 /* Clean and Invalidate a single range of the D-cache */
 void cpu_clean_invalidate_dcache_range(uintptr_t base, unsigned int length);
 
@@ -98,4 +118,21 @@ static inline void cpu_set_interrupt_priority(uint8_t irq, uint8_t priority)
 		(priority << prio_shift);
 }
 
+/*
+ * Return the lowest IRQ below irq_count which is both enabled and pending, or
+ * -1 if none.  With interrupts masked, this tells what ended a wfi.
+ */
+static inline int cpu_get_pending_irq(int irq_count)
+{
+	int i;
+
+	for (i = 0; i < irq_count; i += 32) {
+		uint32_t pending = CPU_NVIC_PEND(i / 32) & CPU_NVIC_EN(i / 32);
+
+		if (pending)
+			return i + __builtin_ctz(pending);
+	}
+	return -1;
+}
+
 #endif /* __CROS_EC_CPU_H */
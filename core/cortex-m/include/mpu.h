@@ -38,6 +38,7 @@ enum mpu_region {
 	REGION_UNCACHED_RAM = 8,        /* For uncached data RAM */
 	REGION_UNCACHED_RAM2 = 9,       /* Second region for unaligned size */
 	REGION_ROLLBACK = 10,           /* For rollback */
+	REGION_STACK_GUARD = 11,        /* For the running task's stack */
 };
 
 #define MPU_TYPE		REG32(0xe000ed90)
@@ -47,6 +48,9 @@ enum mpu_region {
 #define MPU_SIZE		REG16(0xe000eda0)
 #define MPU_ATTR		REG16(0xe000eda2)
 
+/* Use the region number in MPU_BASE rather than MPU_NUMBER */
+#define MPU_BASE_VALID		BIT(4)
+
 /*
  * See ARM v7-M Architecture Reference Manual
  * Section B3.5.5 MPU Type Register, MPU_TYPE
@@ -134,6 +138,19 @@ int mpu_lock_rw_flash(void);
  */
 int mpu_lock_rollback(int lock);
 
+/* Size of the stack guard, the smallest MPU region */
+#define MPU_STACK_GUARD_SIZE	BIT(MPU_SIZE_BITS_MIN)
+
+/**
+ * Move the stack guard to the bottom of a stack.
+ *
+ * Called on every context switch with CONFIG_MPU_STACK_GUARD.  Does nothing
+ * until mpu_pre_init() sets the MPU up.
+ *
+ * @param stack	Lowest address of the stack.
+ */
+void mpu_set_stack_guard(const uint32_t *stack);
+
 /**
  * Initialize MPU.
  * It disables all regions if MPU is implemented. Otherwise, returns
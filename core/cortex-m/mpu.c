@@ -12,6 +12,11 @@
 #include "task.h"
 #include "util.h"
 
+#ifdef CONFIG_MPU_STACK_GUARD
+/* Region of the stack guard, or -1 until the MPU is set up */
+static int stack_guard_region = -1;
+#endif
+
 /**
  * @return Number of regions supported by the MPU. 0 means the processor does
  * not implement an MPU.
@@ -205,6 +210,26 @@ uint32_t mpu_get_type(void)
 	return MPU_TYPE;
 }
 
+#ifdef CONFIG_MPU_STACK_GUARD
+void mpu_set_stack_guard(const uint32_t *stack)
+{
+	uint32_t addr = ((uint32_t)stack + MPU_STACK_GUARD_SIZE - 1) &
+			~(MPU_STACK_GUARD_SIZE - 1);
+
+	if (stack_guard_region < 0)
+		return;
+
+	/*
+	 * The region stays enabled: for the time between the two writes it
+	 * guards the new base with the same attributes.
+	 */
+	MPU_BASE = addr | MPU_BASE_VALID | stack_guard_region;
+	REG32(&MPU_SIZE) = ((uint32_t)(MPU_ATTR_XN | MPU_ATTR_NO_NO) << 16) |
+			   ((MPU_SIZE_BITS_MIN - 1) << 1) | 1;
+	asm volatile("dsb; isb;");
+}
+#endif
+
 int mpu_protect_data_ram(void)
 {
 	int ret;
@@ -411,6 +436,16 @@ int mpu_pre_init(void)
 #endif
 	}
 
+#ifdef CONFIG_MPU_STACK_GUARD
+	/*
+	 * It has to take priority over the data RAM regions.  On MPUs with 8
+	 * regions, borrow the second code RAM one, which the code RAM
+	 * protection doesn't use.
+	 */
+	stack_guard_region = num_mpu_regions > REGION_STACK_GUARD ?
+			     REGION_STACK_GUARD : REGION_CODE_RAM2;
+#endif
+
 	mpu_enable();
 
 	if (IS_ENABLED(CONFIG_ARMV7M_CACHE))
@@ -6,6 +6,7 @@
 #include "common.h"
 #include "console.h"
 #include "cpu.h"
+#include "crashdump.h"
 #include "host_command.h"
 #include "panic.h"
 #include "panic-internal.h"
@@ -335,6 +336,9 @@ void __keep report_panic(void)
 	 * TODO(crosbug.com/p/23760): Dump main stack contents as well if the
 	 * exception happened in a handler's context.
 	 */
+#endif
+#ifdef CONFIG_PANIC_CRASHDUMP
+	crashdump_capture(pdata->cm.regs[0]);
 #endif
 	panic_reboot();
 }
@@ -9,9 +9,13 @@
 #include "common.h"
 #include "console.h"
 #include "cpu.h"
+#include "hooks.h"
+#include "host_command.h"
 #include "link_defs.h"
+#include "mpu.h"
 #include "panic.h"
 #include "task.h"
+#include "task_bitmap.h"
 #include "timer.h"
 #include "util.h"
 
@@ -25,6 +29,15 @@ typedef union {
 		uint32_t events;   /* Bitmaps of received events */
 		uint64_t runtime;  /* Time spent in task */
 		uint32_t *stack;   /* Start of stack */
+#ifdef CONFIG_TASK_PROFILING
+		uint32_t switch_ins;     /* Number of times switched in */
+		uint32_t switch_in_time; /* Time of last switch in */
+		uint32_t max_slice;      /* Longest time between switches */
+		uint32_t wake_time;      /* Time an event made task ready */
+		uint32_t wake_count;     /* Number of wake latency samples */
+		uint32_t wake_max;       /* Longest wake latency */
+		uint64_t wake_total;     /* Sum of wake latencies */
+#endif
 	};
 } task_;
 
@@ -61,6 +74,11 @@ static uint64_t exc_total_time;  /* Total time in exceptions */
 static uint32_t svc_calls;       /* Number of service calls */
 static uint32_t task_switches;   /* Number of times active task changed */
 static uint32_t irq_dist[CONFIG_IRQ_COUNT];  /* Distribution of IRQ calls */
+/*
+ * Tasks that were made ready by an event and have not been switched in yet;
+ * their wake_time is valid.
+ */
+static uint32_t tasks_wake_pending[TASK_BITMAP_WORDS];
 #endif
 
 extern void __switchto(task_ *from, task_ *to);
@@ -159,12 +177,13 @@ static uint32_t task_reset_state[TASK_ID_COUNT] = {
 #endif
 };
 #undef ENABLE_RESET
+
+/* The bits below TASK_RESET_LOCK hold one waiter bit per task */
+BUILD_ASSERT(BIT(TASK_ID_COUNT) < TASK_RESET_LOCK);
 #endif /* CONFIG_TASK_RESET_LIST */
 
 /* Validity checks about static task invariants */
-BUILD_ASSERT(TASK_ID_COUNT <= sizeof(unsigned) * 8);
 BUILD_ASSERT(TASK_ID_COUNT < (1 << (sizeof(task_id_t) * 8)));
-BUILD_ASSERT(BIT(TASK_ID_COUNT) < TASK_RESET_LOCK);
 
 /* Stacks for all tasks */
 #define TASK(n, r, d, s)  + s
@@ -179,6 +198,7 @@ uint8_t task_stacks[0
 
 /* Reserve space to discard context on first context switch. */
 uint32_t scratchpad[17];
+BUILD_ASSERT(sizeof(task_) <= sizeof(scratchpad));
 
 static task_ *current_task = (task_ *)scratchpad;
 
@@ -198,20 +218,36 @@ static int need_resched_or_profiling;
 /*
  * Bitmap of all tasks ready to be run.
  *
- * Start off with only the hooks task marked as ready such that all the modules
- * can do their init within a task switching context.  The hooks task will then
- * make a call to enable all tasks.
+ * task_pre_init() starts off with only the hooks task marked as ready such
+ * that all the modules can do their init within a task switching context.
+ * The hooks task will then make a call to enable all tasks.
  */
-static uint32_t tasks_ready = BIT(TASK_ID_HOOKS);
+static struct task_queue tasks_ready;
 /*
  * Initially allow only the HOOKS and IDLE task to run, regardless of ready
  * status, in order for HOOK_INIT to complete before other tasks.
  * task_enable_all_tasks() will open the flood gates.
  */
-static uint32_t tasks_enabled = BIT(TASK_ID_HOOKS) | BIT(TASK_ID_IDLE);
+static uint32_t tasks_enabled[TASK_BITMAP_WORDS];
 
 static int start_called;  /* Has task swapping started */
 
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+/*
+ * Tasks blocked on a priority inheritance mutex, and the task holding the
+ * mutex each of them is blocked on.  The scheduler runs the holder in place of
+ * any such task.
+ */
+static uint32_t tasks_donating[TASK_BITMAP_WORDS];
+static task_id_t donate_to[TASK_ID_COUNT];
+
+/* Lock value of a mutex held by a task; keeps the holder ID in bits 8+. */
+#define MUTEX_LOCKED(id) (2 | ((id) << 8))
+#define MUTEX_OWNER(lock) ((lock) >> 8)
+#else
+#define MUTEX_LOCKED(id) 2
+#endif
+
 static inline task_ *__task_id_to_ptr(task_id_t id)
 {
 	return tasks + id;
@@ -242,6 +278,43 @@ static inline int get_interrupt_context(void)
 	asm("mrs %0, ipsr \n":"=r"(ret)); /* read exception number */
 	return ret & 0x1ff;               /* exception bits are the 9 LSB */
 }
+
+/*
+ * Note the time at which an event makes a task ready to run, so the latency
+ * until it is actually switched in can be measured.
+ */
+static inline void profile_task_wake(task_id_t id, uint32_t t)
+{
+	if (id == TASK_ID_IDLE || task_bitmap_test(tasks_ready.map, id) ||
+	    task_bitmap_test(tasks_wake_pending, id))
+		return;
+
+	tasks[id].wake_time = t;
+	task_bitmap_set(tasks_wake_pending, id);
+}
+
+/* Account for the switch from task |from| to task |to| at time t. */
+static inline void profile_task_switch(task_ *from, task_ *to, uint32_t t)
+{
+	task_id_t id = to - tasks;
+	uint32_t slice = t - from->switch_in_time;
+
+	if (slice > from->max_slice)
+		from->max_slice = slice;
+
+	to->switch_in_time = t;
+	to->switch_ins++;
+
+	if (task_bitmap_test(tasks_wake_pending, id)) {
+		uint32_t latency = t - to->wake_time;
+
+		task_bitmap_clear(tasks_wake_pending, id);
+		to->wake_count++;
+		to->wake_total += latency;
+		if (latency > to->wake_max)
+			to->wake_max = latency;
+	}
+}
 #endif
 
 task_id_t task_get_current(void)
@@ -253,6 +326,20 @@ task_id_t task_get_current(void)
 	return current_task - tasks;
 }
 
+#ifdef CONFIG_TASK_PROFILING
+uint64_t task_get_runtime(task_id_t tskid)
+{
+	return __task_id_to_ptr(tskid)->runtime;
+}
+#endif
+
+int task_get_stack(task_id_t tskid, uint32_t **stack, uint32_t *sp)
+{
+	*stack = tasks[tskid].stack;
+	*sp = tasks[tskid].sp;
+	return tasks_init[tskid].stack_size;
+}
+
 uint32_t *task_get_event_bitmap(task_id_t tskid)
 {
 	task_ *tsk = __task_id_to_ptr(tskid);
@@ -264,12 +351,53 @@ int task_start_called(void)
 	return start_called;
 }
 
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+/*
+ * Pick the next task to run.  If the highest priority candidate is blocked on
+ * a priority inheritance mutex, run the task holding the mutex instead,
+ * following chains of blocked holders.  If the holder cannot run either, fall
+ * back to the next candidate.  Returns -1 if nothing can run.
+ */
+static int select_next_task(void)
+{
+	uint32_t runnable[TASK_BITMAP_WORDS];
+	uint32_t candidates[TASK_BITMAP_WORDS];
+	int w;
+
+	for (w = 0; w < TASK_BITMAP_WORDS; w++) {
+		runnable[w] = tasks_ready.map[w] & tasks_enabled[w];
+		candidates[w] = runnable[w] |
+				(tasks_donating[w] & tasks_enabled[w]);
+	}
+
+	while (1) {
+		int id = task_bitmap_fls(candidates);
+		task_id_t t = id;
+		int depth;
+
+		if (id < 0)
+			return -1;
+
+		for (depth = 0; depth < TASK_ID_COUNT &&
+		     !task_bitmap_test(runnable, t) &&
+		     task_bitmap_test(tasks_donating, t); depth++)
+			t = donate_to[t];
+
+		if (task_bitmap_test(runnable, t))
+			return t;
+
+		candidates[TASK_BITMAP_WORD(id)] &= ~TASK_BITMAP_BIT(id);
+	}
+}
+#endif
+
 /**
  * Scheduling system call
  */
-void svc_handler(int desched, task_id_t resched)
+void __hot_code svc_handler(int desched, task_id_t resched)
 {
 	task_ *current, *next;
+	int next_id;
 #ifdef CONFIG_TASK_PROFILING
 	int exc = get_interrupt_context();
 	uint32_t t;
@@ -295,7 +423,7 @@ void svc_handler(int desched, task_id_t resched)
 
 	current = current_task;
 
-#ifdef CONFIG_DEBUG_STACK_OVERFLOW
+#if defined(CONFIG_DEBUG_STACK_OVERFLOW) && !defined(CONFIG_MPU_STACK_GUARD)
 	if (*current->stack != STACK_UNUSED_VALUE) {
 		panic_printf("\n\nStack overflow in %s task!\n",
 			     task_names[current - tasks]);
@@ -310,13 +438,22 @@ void svc_handler(int desched, task_id_t resched)
 		 * Remove our own ready bit (current - tasks is same as
 		 * task_get_current())
 		 */
-		tasks_ready &= ~(1 << (current - tasks));
+		task_queue_clear(&tasks_ready, current - tasks);
 	}
 	ASSERT(resched <= TASK_ID_COUNT);
-	tasks_ready |= 1 << resched;
+#ifdef CONFIG_TASK_PROFILING
+	profile_task_wake(resched, exc_start_time);
+#endif
+	if (resched < TASK_ID_COUNT)
+		task_queue_set(&tasks_ready, resched);
 
-	ASSERT(tasks_ready & tasks_enabled);
-	next = __task_id_to_ptr(__fls(tasks_ready & tasks_enabled));
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+	next_id = select_next_task();
+#else
+	next_id = task_queue_fls(&tasks_ready, tasks_enabled);
+#endif
+	ASSERT(next_id >= 0);
+	next = __task_id_to_ptr(next_id);
 
 #ifdef CONFIG_TASK_PROFILING
 	/* Track time in interrupts */
@@ -344,8 +481,12 @@ void svc_handler(int desched, task_id_t resched)
 	/* Switch to new task */
 #ifdef CONFIG_TASK_PROFILING
 	task_switches++;
+	profile_task_switch(current, next, t);
 #endif
 	current_task = next;
+#ifdef CONFIG_MPU_STACK_GUARD
+	mpu_set_stack_guard(next->stack);
+#endif
 	__switchto(current, next);
 }
 
@@ -436,8 +577,11 @@ uint32_t task_set_event(task_id_t tskid, uint32_t event, int wait)
 
 	/* Re-schedule if priorities have changed */
 	if (in_interrupt_context()) {
+#ifdef CONFIG_TASK_PROFILING
+		profile_task_wake(tskid, get_time().le.lo);
+#endif
 		/* The receiver might run again */
-		deprecated_atomic_or(&tasks_ready, 1 << tskid);
+		task_queue_set(&tasks_ready, tskid);
 #ifndef CONFIG_TASK_PROFILING
 		if (start_called)
 			need_resched_or_profiling = 1;
@@ -488,20 +632,25 @@ uint32_t task_wait_event_mask(uint32_t event_mask, int timeout_us)
 
 void task_enable_all_tasks(void)
 {
+	int id;
+
 	/* Mark all tasks as ready and able to run. */
-	tasks_ready = tasks_enabled = BIT(TASK_ID_COUNT) - 1;
+	for (id = 0; id < TASK_ID_COUNT; id++) {
+		task_queue_set(&tasks_ready, id);
+		task_bitmap_set(tasks_enabled, id);
+	}
 	/* Reschedule the highest priority task. */
 	__schedule(0, 0);
 }
 
 void task_enable_task(task_id_t tskid)
 {
-	deprecated_atomic_or(&tasks_enabled, BIT(tskid));
+	task_bitmap_set(tasks_enabled, tskid);
 }
 
 void task_disable_task(task_id_t tskid)
 {
-	deprecated_atomic_clear_bits(&tasks_enabled, BIT(tskid));
+	task_bitmap_clear(tasks_enabled, tskid);
 
 	if (!in_interrupt_context() && tskid == task_get_current())
 		__schedule(0, 0);
@@ -564,7 +713,10 @@ static void do_task_reset(task_id_t id)
 {
 	interrupt_disable();
 	init_task_context(id);
-	tasks_ready |= 1 << id;
+	task_queue_set(&tasks_ready, id);
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+	task_bitmap_clear(tasks_donating, id);
+#endif
 	/* TODO: Clear all pending events? */
 	interrupt_enable();
 }
@@ -860,7 +1012,11 @@ static void __nvic_init_irqs(void)
 void mutex_lock(struct mutex *mtx)
 {
 	uint32_t value;
-	uint32_t id;
+	task_id_t me;
+#ifdef CONFIG_MUTEX_STATS
+	uint32_t block_start = 0;
+	int blocked = 0;
+#endif
 
 	/*
 	 * mutex_lock() must not be used in interrupt context (because we wait
@@ -876,56 +1032,170 @@ void mutex_lock(struct mutex *mtx)
 	if (!task_start_called())
 		return;
 
-	id = 1 << task_get_current();
+	me = task_get_current();
 
-	deprecated_atomic_or(&mtx->waiters, id);
+	task_bitmap_set(mtx->waiters, me);
 
 	do {
-		/* Try to get the lock (set 1 into the lock field) */
+		/* Try to get the lock (set MUTEX_LOCKED into the lock field) */
 		__asm__ __volatile__("   ldrex   %0, [%1]\n"
 				     "   teq     %0, #0\n"
 				     "   it eq\n"
 				     "   strexeq %0, %2, [%1]\n"
 				     : "=&r" (value)
-				     : "r" (&mtx->lock), "r" (2) : "cc");
+				     : "r" (&mtx->lock), "r" (MUTEX_LOCKED(me))
+				     : "cc");
 		/*
 		 * "value" is equals to 1 if the store conditional failed,
-		 * 2 if somebody else owns the mutex, 0 else.
+		 * the current lock value if somebody else owns the mutex,
+		 * 0 else.
 		 */
-		if (value == 2)
+		if (value > 1) {
 			/* Contention on the mutex */
+#ifdef CONFIG_MUTEX_STATS
+			if (!blocked) {
+				blocked = 1;
+				block_start = get_time().le.lo;
+				deprecated_atomic_add(&mtx->contended, 1);
+			}
+#endif
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+			if (mtx->flags & MUTEX_FLAG_PRIORITY_INHERIT) {
+				donate_to[me] = MUTEX_OWNER(value);
+				task_bitmap_set(tasks_donating, me);
+			}
+#endif
 			task_wait_event_mask(TASK_EVENT_MUTEX, 0);
+		}
 	} while (value);
 
-	deprecated_atomic_clear_bits(&mtx->waiters, id);
+	task_bitmap_clear(mtx->waiters, me);
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+	task_bitmap_clear(tasks_donating, me);
+#endif
+#ifdef CONFIG_MUTEX_STATS
+	if (blocked) {
+		uint32_t block_us = get_time().le.lo - block_start;
+
+		if (block_us > mtx->max_block_us)
+			mtx->max_block_us = block_us;
+	}
+#endif
 }
 
 void mutex_unlock(struct mutex *mtx)
 {
-	uint32_t waiters;
+	uint32_t waiters[TASK_BITMAP_WORDS];
 	task_ *tsk = current_task;
+	int id;
 
 	/*
 	 * Add a critical section to keep the unlock and the snapshotting of
 	 * waiters atomic in case a task switching occurs between them.
 	 */
 	interrupt_disable();
-	waiters = mtx->waiters;
+	memcpy(waiters, mtx->waiters, sizeof(waiters));
 	mtx->lock = 0;
 	interrupt_enable();
 
-	while (waiters) {
-		task_id_t id = __fls(waiters);
-		waiters &= ~BIT(id);
+	while ((id = task_bitmap_fls(waiters)) >= 0) {
+		waiters[TASK_BITMAP_WORD(id)] &= ~TASK_BITMAP_BIT(id);
 
 		/* Somebody is waiting on the mutex */
 		task_set_event(id, TASK_EVENT_MUTEX, 0);
+		if (IS_ENABLED(CONFIG_MUTEX_WAKE_ONE))
+			break;
 	}
 
 	/* Ensure no event is remaining from mutex wake-up */
 	deprecated_atomic_clear_bits(&tsk->events, TASK_EVENT_MUTEX);
 }
 
+/*
+ * Return the bytes of the stack of task |id| used since it last started,
+ * counting from the bottom up words which still hold STACK_UNUSED_VALUE.
+ * The scan gives up at |limit| bytes of unused stack.
+ */
+static int task_stack_used(int id, int limit)
+{
+	uint32_t *sp = tasks[id].stack;
+	uint32_t *end = sp + limit / sizeof(uint32_t);
+
+#ifdef CONFIG_MPU_STACK_GUARD
+	/* Reading the guard of the running task would fault */
+	sp = (uint32_t *)((((uintptr_t)sp + MPU_STACK_GUARD_SIZE - 1) &
+			   ~(MPU_STACK_GUARD_SIZE - 1)) + MPU_STACK_GUARD_SIZE);
+#endif
+
+	if (end > (uint32_t *)tasks[id].sp)
+		end = (uint32_t *)tasks[id].sp;
+
+	while (sp < end && *sp == STACK_UNUSED_VALUE)
+		sp++;
+
+	return tasks_init[id].stack_size -
+	       ((uintptr_t)sp - (uintptr_t)tasks[id].stack);
+}
+
+#ifdef CONFIG_TASK_STACK_WATERMARK
+/* Deepest stack usage of each task since boot, in bytes */
+static uint16_t stack_peak[TASK_ID_COUNT];
+
+/*
+ * Only the stack below the known peak can hold a new one, so the scan of
+ * each task stops there and doesn't cover the part which is in use.
+ */
+static void task_stack_sample(void)
+{
+	int i;
+
+	for (i = 0; i < TASK_ID_COUNT; i++) {
+		int used = task_stack_used(
+			i, tasks_init[i].stack_size - stack_peak[i]);
+
+		if (used > stack_peak[i])
+			stack_peak[i] = used;
+	}
+}
+DECLARE_HOOK(HOOK_SECOND, task_stack_sample, HOOK_PRIO_DEFAULT);
+
+static enum ec_status
+host_command_task_stack_info(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_task_stack_info *p = args->params;
+	struct ec_response_task_stack_info *r = args->response;
+	int num, i;
+
+	if (p->offset > TASK_ID_COUNT)
+		return EC_RES_INVALID_PARAM;
+
+	num = (args->response_max - sizeof(*r)) / sizeof(r->task[0]);
+	num = MIN(num, TASK_ID_COUNT - p->offset);
+
+	task_stack_sample();
+
+	r->task_count = TASK_ID_COUNT;
+	r->offset = p->offset;
+	r->num = num;
+	r->reserved = 0;
+	for (i = 0; i < num; i++) {
+		struct ec_task_stack_info *t = &r->task[i];
+		int id = p->offset + i;
+
+		t->size = tasks_init[id].stack_size;
+		t->used = task_stack_used(id, tasks_init[id].stack_size);
+		t->peak = stack_peak[id];
+		t->reserved = 0;
+		strzcpy(t->name, task_names[id], sizeof(t->name));
+	}
+
+	args->response_size = sizeof(*r) + num * sizeof(r->task[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_TASK_STACK_INFO, host_command_task_stack_info,
+		     EC_VER_MASK(0));
+#endif
+
 void task_print_list(void)
 {
 	int i;
@@ -933,19 +1203,12 @@ void task_print_list(void)
 	ccputs("Task Ready Name         Events      Time (s)  StkUsed\n");
 
 	for (i = 0; i < TASK_ID_COUNT; i++) {
-		char is_ready = (tasks_ready & (1<<i)) ? 'R' : ' ';
-		uint32_t *sp;
-
-		int stackused = tasks_init[i].stack_size;
-
-		for (sp = tasks[i].stack;
-		     sp < (uint32_t *)tasks[i].sp && *sp == STACK_UNUSED_VALUE;
-		     sp++)
-			stackused -= sizeof(uint32_t);
+		char is_ready = task_bitmap_test(tasks_ready.map, i) ? 'R' : ' ';
 
 		ccprintf("%4d %c %-16s %08x %11.6lld  %3d/%3d\n", i, is_ready,
 			 task_names[i], tasks[i].events, tasks[i].runtime,
-			 stackused, tasks_init[i].stack_size);
+			 task_stack_used(i, tasks_init[i].stack_size),
+			 tasks_init[i].stack_size);
 		cflush();
 	}
 }
@@ -975,6 +1238,20 @@ int command_task_info(int argc, char **argv)
 	ccprintf("Time in tasks:          %11.6lld s\n",
 		 get_time().val - task_start_time);
 	ccprintf("Time in exceptions:     %11.6lld s\n", exc_total_time);
+	cflush();
+
+	ccputs("Task Switches  MaxSlice(us) Wakeups  AvgWake(us) MaxWake(us)\n");
+	for (i = 0; i < TASK_ID_COUNT; i++) {
+		const task_ *tsk = tasks + i;
+
+		ccprintf("%4d %8d %13d %8d %12d %11d\n", i, tsk->switch_ins,
+			 tsk->max_slice, tsk->wake_count,
+			 tsk->wake_count ?
+				(uint32_t)(tsk->wake_total / tsk->wake_count) :
+				0,
+			 tsk->wake_max);
+		cflush();
+	}
 #endif
 
 	return EC_SUCCESS;
@@ -983,14 +1260,53 @@ DECLARE_SAFE_CONSOLE_COMMAND(taskinfo, command_task_info,
 			     NULL,
 			     "Print task info");
 
+#ifdef CONFIG_TASK_PROFILING
+static enum ec_status
+host_command_get_task_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_get_task_stats *p = args->params;
+	struct ec_response_get_task_stats *r = args->response;
+	const task_ *tsk;
+
+	if (p->task_id >= TASK_ID_COUNT)
+		return EC_RES_INVALID_PARAM;
+
+	tsk = tasks + p->task_id;
+
+	memset(r, 0, sizeof(*r));
+	r->task_count = TASK_ID_COUNT;
+	strzcpy(r->name, task_names[p->task_id], sizeof(r->name));
+	r->runtime_us = tsk->runtime;
+	r->switch_ins = tsk->switch_ins;
+	r->max_slice_us = tsk->max_slice;
+	r->wake_count = tsk->wake_count;
+	r->wake_latency_avg_us = tsk->wake_count ?
+		(uint32_t)(tsk->wake_total / tsk->wake_count) : 0;
+	r->wake_latency_max_us = tsk->wake_max;
+
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_GET_TASK_STATS, host_command_get_task_stats,
+		     EC_VER_MASK(0));
+#endif
+
 #ifdef CONFIG_CMD_TASKREADY
 static int command_task_ready(int argc, char **argv)
 {
+	int w;
+
 	if (argc < 2) {
-		ccprintf("tasks_ready: 0x%08x\n", tasks_ready);
+		ccprintf("tasks_ready: 0x");
+		for (w = TASK_BITMAP_WORDS - 1; w >= 0; w--)
+			ccprintf("%08x", tasks_ready.map[w]);
+		ccprintf("\n");
 	} else {
-		tasks_ready = strtoi(argv[1], NULL, 16);
-		ccprintf("Setting tasks_ready to 0x%08x\n", tasks_ready);
+		/* The mask covers the first 32 tasks */
+		tasks_ready.map[0] = strtoi(argv[1], NULL, 16);
+		tasks_ready.summary |= BIT(0);
+		ccprintf("Setting tasks_ready to 0x%08x\n", tasks_ready.map[0]);
 		__schedule(0, 0);
 	}
 
@@ -1012,6 +1328,10 @@ void task_pre_init(void)
 		stack_next += init_task_context(i);
 	}
 
+	task_queue_set(&tasks_ready, TASK_ID_HOOKS);
+	task_bitmap_set(tasks_enabled, TASK_ID_HOOKS);
+	task_bitmap_set(tasks_enabled, TASK_ID_IDLE);
+
 	/*
 	 * Fill in guard value in scratchpad to prevent stack overflow
 	 * detection failure on the first context switch.  This works because
@@ -6,6 +6,7 @@
 #include "common.h"
 #include "console.h"
 #include "cpu.h"
+#include "crashdump.h"
 #include "host_command.h"
 #include "panic.h"
 #include "panic-internal.h"
@@ -135,6 +136,9 @@ void __keep report_panic(void)
 	}
 
 	panic_data_print(pdata);
+#ifdef CONFIG_PANIC_CRASHDUMP
+	crashdump_capture(pdata->cm.regs[0]);
+#endif
 	panic_reboot();
 }
 
@@ -191,6 +191,13 @@ uint32_t *task_get_event_bitmap(task_id_t tskid)
 	return &tsk->events;
 }
 
+int task_get_stack(task_id_t tskid, uint32_t **stack, uint32_t *sp)
+{
+	*stack = tasks[tskid].stack;
+	*sp = tasks[tskid].sp;
+	return tasks_init[tskid].stack_size;
+}
+
 int task_start_called(void)
 {
 	return start_called;
@@ -199,7 +206,7 @@ int task_start_called(void)
 /**
  * Scheduling system call
  */
-task_  __attribute__((noinline)) *__svc_handler(int desched, task_id_t resched)
+task_ __hot_code __attribute__((noinline)) *__svc_handler(int desched, task_id_t resched)
 {
 	task_ *current, *next;
 #ifdef CONFIG_TASK_PROFILING
@@ -498,9 +505,10 @@ static void __nvic_init_irqs(void)
 void mutex_lock(struct mutex *mtx)
 {
 	uint32_t id = 1 << task_get_current();
+	int __maybe_unused waited = 0;
 
 	ASSERT(id != TASK_ID_INVALID);
-	deprecated_atomic_or(&mtx->waiters, id);
+	deprecated_atomic_or(&mtx->waiters[0], id);
 
 	while (1) {
 		/* Try to get the lock (set 2 into the lock field) */
@@ -509,12 +517,16 @@ void mutex_lock(struct mutex *mtx)
 			break;
 		__asm__ __volatile__("cpsie i");
 		/* Contention on the mutex */
+#ifdef CONFIG_MUTEX_STATS
+		if (!waited++)
+			deprecated_atomic_add(&mtx->contended, 1);
+#endif
 		task_wait_event_mask(TASK_EVENT_MUTEX, 0);
 	}
 	mtx->lock = 2;
 	__asm__ __volatile__("cpsie i");
 
-	deprecated_atomic_clear_bits(&mtx->waiters, id);
+	deprecated_atomic_clear_bits(&mtx->waiters[0], id);
 }
 
 void mutex_unlock(struct mutex *mtx)
@@ -527,7 +539,7 @@ void mutex_unlock(struct mutex *mtx)
 	 * waiters atomic in case a task switching occurs between them.
 	 */
 	interrupt_disable();
-	waiters = mtx->waiters;
+	waiters = mtx->waiters[0];
 	mtx->lock = 0;
 	interrupt_enable();
 
@@ -537,6 +549,8 @@ void mutex_unlock(struct mutex *mtx)
 
 		/* Somebody is waiting on the mutex */
 		task_set_event(id, TASK_EVENT_MUTEX, 0);
+		if (IS_ENABLED(CONFIG_MUTEX_WAKE_ONE))
+			break;
 	}
 
 	/* Ensure no event is remaining from mutex wake-up */
@@ -6,6 +6,7 @@
 /* Entry point of unit test executable */
 
 #include "console.h"
+#include "event_log.h"
 #include "flash.h"
 #include "hooks.h"
 #include "host_task.h"
@@ -44,6 +45,10 @@ static int test_main(void)
 	system_pre_init();
 	system_common_pre_init();
 
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+	log_init();
+#endif
+
 	test_init();
 
 	timer_init();
@@ -94,7 +99,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 		/* We can't sleep yet, busy loop waiting for tasks to start. */
 		wait_for_task_started_nosleep();
 		/* Let tasks settle. */
-		msleep(50 * MSEC);
+		msleep(50);
 	}
 
 	return test_fuzz_one_input(data, size);
@@ -142,8 +142,9 @@ static void _task_execute_isr(int sig)
 {
 	in_interrupt = 1;
 	pending_isr();
-	sem_post(&interrupt_sem);
+	/* Leave interrupt context before letting the trigger return. */
 	in_interrupt = 0;
+	sem_post(&interrupt_sem);
 }
 
 void task_register_interrupt(void)
@@ -172,8 +173,6 @@ void task_trigger_test_interrupt(void (*isr)(void))
 
 	/* Wait for ISR to complete */
 	sem_wait(&interrupt_sem);
-	while (in_interrupt)
-		_usleep(10);
 	pending_isr = NULL;
 
 	pthread_mutex_unlock(&interrupt_lock);
@@ -263,7 +262,7 @@ void mutex_lock(struct mutex *mtx)
 	int value = 0;
 	int id = 1 << task_get_current();
 
-	mtx->waiters |= id;
+	mtx->waiters[0] |= id;
 
 	do {
 		if (mtx->lock == 0) {
@@ -275,7 +274,7 @@ void mutex_lock(struct mutex *mtx)
 			task_wait_event_mask(TASK_EVENT_MUTEX, 0);
 	} while (!value);
 
-	mtx->waiters &= ~id;
+	mtx->waiters[0] &= ~id;
 }
 
 void mutex_unlock(struct mutex *mtx)
@@ -284,8 +283,8 @@ void mutex_unlock(struct mutex *mtx)
 	mtx->lock = 0;
 
 	for (v = 31; v >= 0; --v)
-		if ((1ul << v) & mtx->waiters) {
-			mtx->waiters &= ~(1ul << v);
+		if ((1ul << v) & mtx->waiters[0]) {
+			mtx->waiters[0] &= ~(1ul << v);
 			task_set_event(v, TASK_EVENT_MUTEX, 0);
 			break;
 		}
@@ -453,9 +453,10 @@ void mutex_lock(struct mutex *mtx)
 {
 	uint32_t old_val = 0, value = 1;
 	uint32_t id = 1 << task_get_current();
+	int __maybe_unused waited = 0;
 
 	ASSERT(id != TASK_ID_INVALID);
-	deprecated_atomic_or(&mtx->waiters, id);
+	deprecated_atomic_or(&mtx->waiters[0], id);
 
 	do {
 		old_val = 0;
@@ -467,11 +468,15 @@ void mutex_lock(struct mutex *mtx)
 
 		if (old_val != 0) {
 			/* Contention on the mutex */
+#ifdef CONFIG_MUTEX_STATS
+			if (!waited++)
+				deprecated_atomic_add(&mtx->contended, 1);
+#endif
 			task_wait_event_mask(TASK_EVENT_MUTEX, 0);
 		}
 	} while (old_val);
 
-	deprecated_atomic_clear_bits(&mtx->waiters, id);
+	deprecated_atomic_clear_bits(&mtx->waiters[0], id);
 }
 
 void mutex_unlock(struct mutex *mtx)
@@ -486,7 +491,7 @@ void mutex_unlock(struct mutex *mtx)
 			: "r" (val), "m" (mtx->lock), "a" (old_val)
 			: "memory");
 	if (old_val == 1)
-		waiters = mtx->waiters;
+		waiters = mtx->waiters[0];
 	/* else? Does unlock fail - what to do then ? */
 	while (waiters) {
 		task_id_t id = __fls(waiters);
@@ -495,6 +500,8 @@ void mutex_unlock(struct mutex *mtx)
 
 		/* Somebody is waiting on the mutex */
 		task_set_event(id, TASK_EVENT_MUTEX, 0);
+		if (IS_ENABLED(CONFIG_MUTEX_WAKE_ONE))
+			break;
 	}
 
 	/* Ensure no event is remaining from mutex wake-up */
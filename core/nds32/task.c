@@ -602,20 +602,26 @@ static void ivic_init_irqs(void)
 void __ram_code mutex_lock(struct mutex *mtx)
 {
 	uint32_t id = 1 << task_get_current();
+	int __maybe_unused waited = 0;
 
 	ASSERT(id != TASK_ID_INVALID);
 
 	/* critical section with interrupts off */
 	interrupt_disable();
-	mtx->waiters |= id;
+	mtx->waiters[0] |= id;
 	while (1) {
 		if (!mtx->lock) { /* we got it ! */
 			mtx->lock = 2;
-			mtx->waiters &= ~id;
+			mtx->waiters[0] &= ~id;
 			/* end of critical section : re-enable interrupts */
 			interrupt_enable();
 			return;
 		} else { /* Contention on the mutex */
+#ifdef CONFIG_MUTEX_STATS
+			/* still in the critical section */
+			if (!waited++)
+				mtx->contended++;
+#endif
 			/* end of critical section : re-enable interrupts */
 			interrupt_enable();
 			/* Sleep waiting for our turn */
@@ -631,7 +637,7 @@ void __ram_code mutex_unlock(struct mutex *mtx)
 	uint32_t waiters;
 	task_ *tsk = current_task;
 
-	waiters = mtx->waiters;
+	waiters = mtx->waiters[0];
 	/* give back the lock */
 	mtx->lock = 0;
 
@@ -641,6 +647,8 @@ void __ram_code mutex_unlock(struct mutex *mtx)
 
 		/* Somebody is waiting on the mutex */
 		task_set_event(id, TASK_EVENT_MUTEX, 0);
+		if (IS_ENABLED(CONFIG_MUTEX_WAKE_ONE))
+			break;
 	}
 
 	/* Ensure no event is remaining from mutex wake-up */
@@ -46,6 +46,15 @@ static inline uint32_t get_mcause(void)
 	return ret;
 }
 
+/* read low word of the cycle counter */
+static inline uint32_t get_mcycle(void)
+{
+	uint32_t ret;
+
+	asm volatile ("csrr %0, mcycle" : "=r"(ret));
+	return ret;
+}
+
 /* Generic CPU core initialization */
 void cpu_init(void);
 extern uint32_t ec_reset_lp;
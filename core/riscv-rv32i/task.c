@@ -556,9 +556,10 @@ void __ram_code mutex_lock(struct mutex *mtx)
 {
 	uint32_t locked;
 	uint32_t id = 1 << task_get_current();
+	int __maybe_unused waited = 0;
 
 	ASSERT(id != TASK_ID_INVALID);
-	deprecated_atomic_or(&mtx->waiters, id);
+	deprecated_atomic_or(&mtx->waiters[0], id);
 
 	while (1) {
 		asm volatile (
@@ -571,11 +572,15 @@ void __ram_code mutex_lock(struct mutex *mtx)
 		if (!locked)
 			break;
 		/* Contention on the mutex */
+#ifdef CONFIG_MUTEX_STATS
+		if (!waited++)
+			deprecated_atomic_add(&mtx->contended, 1);
+#endif
 		/* Sleep waiting for our turn */
 		task_wait_event_mask(TASK_EVENT_MUTEX, 0);
 	}
 
-	deprecated_atomic_clear_bits(&mtx->waiters, id);
+	deprecated_atomic_clear_bits(&mtx->waiters[0], id);
 }
 
 void __ram_code mutex_unlock(struct mutex *mtx)
@@ -587,7 +592,7 @@ void __ram_code mutex_unlock(struct mutex *mtx)
 	asm volatile (
 		"amoswap.w.aqrl zero, zero, %0\n\t"
 		: "+A" (mtx->lock));
-	waiters = mtx->waiters;
+	waiters = mtx->waiters[0];
 
 	while (waiters) {
 		task_id_t id = __fls(waiters);
@@ -596,6 +601,8 @@ void __ram_code mutex_unlock(struct mutex *mtx)
 
 		/* Somebody is waiting on the mutex */
 		task_set_event(id, TASK_EVENT_MUTEX, 0);
+		if (IS_ENABLED(CONFIG_MUTEX_WAKE_ONE))
+			break;
 	}
 
 	/* Ensure no event is remaining from mutex wake-up */
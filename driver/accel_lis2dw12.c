@@ -26,6 +26,12 @@
  */
 #ifdef CONFIG_ACCEL_LIS2DW_AS_BASE
 
+#ifdef CONFIG_GESTURE_HOST_DETECTION
+/* Activities of the base sensor, as reported by list_activities(). */
+static uint32_t enabled_activities;
+static uint32_t disabled_activities;
+#endif
+
 #ifdef CONFIG_ACCEL_FIFO
 static volatile uint32_t last_interrupt_timestamp;
 
@@ -187,10 +193,63 @@ static int lis2dw12_config_interrupt(const struct motion_sensor_t *s)
 	ret = st_write_data_with_mask(s, LIS2DW12_INT1_TAP_ADDR,
 				      LIS2DW12_INT1_DTAP_MASK,
 				      LIS2DW12_EN_BIT);
+#ifdef CONFIG_GESTURE_HOST_DETECTION
+	if (ret == EC_SUCCESS)
+		enabled_activities = BIT(MOTIONSENSE_ACTIVITY_DOUBLE_TAP);
+#endif
 #endif /* CONFIG_GESTURE_SENSOR_DOUBLE_TAP */
 	return ret;
 }
 
+#ifdef CONFIG_GESTURE_HOST_DETECTION
+/*
+ * Double tap is detected by the sensor's own tap engine, so the EC only
+ * gets an interrupt per double tap instead of reading samples.
+ */
+static int manage_activity(const struct motion_sensor_t *s,
+			   enum motionsensor_activity activity,
+			   int enable,
+			   const struct ec_motion_sense_activity *param)
+{
+	int ret;
+
+	switch (activity) {
+#ifdef CONFIG_GESTURE_SENSOR_DOUBLE_TAP
+	case MOTIONSENSE_ACTIVITY_DOUBLE_TAP:
+		mutex_lock(s->mutex);
+		ret = st_write_data_with_mask(s, LIS2DW12_INT1_TAP_ADDR,
+					      LIS2DW12_INT1_DTAP_MASK,
+					      enable ? LIS2DW12_EN_BIT :
+					      LIS2DW12_DIS_BIT);
+		mutex_unlock(s->mutex);
+		if (ret)
+			return EC_RES_UNAVAILABLE;
+		break;
+#endif
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+
+	if (enable) {
+		enabled_activities |= BIT(activity);
+		disabled_activities &= ~BIT(activity);
+	} else {
+		enabled_activities &= ~BIT(activity);
+		disabled_activities |= BIT(activity);
+	}
+	return EC_RES_SUCCESS;
+}
+
+static int list_activities(const struct motion_sensor_t *s,
+			   uint32_t *enabled,
+			   uint32_t *disabled)
+{
+	*enabled = enabled_activities;
+	*disabled = disabled_activities;
+	return EC_RES_SUCCESS;
+}
+#endif /* CONFIG_GESTURE_HOST_DETECTION */
+
 static void lis2dw12_handle_interrupt_for_fifo(uint32_t ts)
 {
 #ifdef CONFIG_ACCEL_FIFO
@@ -230,7 +289,8 @@ static int lis2dw12_irq_handler(struct motion_sensor_t *s, uint32_t *event)
 		st_raw_read8(s->port, s->i2c_spi_addr_flags,
 			     LIS2DW12_STATUS_TAP, &status);
 		if (status & LIS2DW12_DOUBLE_TAP)
-			*event |= CONFIG_GESTURE_TAP_EVENT;
+			*event |= TASK_EVENT_MOTION_ACTIVITY_INTERRUPT(
+					MOTIONSENSE_ACTIVITY_DOUBLE_TAP);
 	}
 #endif /* CONFIG_GESTURE_SENSOR_DOUBLE_TAP */
 
@@ -600,4 +660,9 @@ const struct accelgyro_drv lis2dw12_drv = {
 #if defined(CONFIG_ACCEL_INTERRUPTS) && defined(CONFIG_ACCEL_LIS2DW_AS_BASE)
 	.irq_handler = lis2dw12_irq_handler,
 #endif /* CONFIG_ACCEL_INTERRUPTS && CONFIG_ACCEL_LIS2DW_AS_BASE */
+#if defined(CONFIG_GESTURE_HOST_DETECTION) && \
+	defined(CONFIG_ACCEL_LIS2DW_AS_BASE)
+	.manage_activity = manage_activity,
+	.list_activities = list_activities,
+#endif
 };
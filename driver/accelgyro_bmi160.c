@@ -142,6 +142,8 @@ static int set_data_rate(const struct motion_sensor_t *s,
 	if (ret != EC_SUCCESS)
 		goto accel_cleanup;
 
+	bmi_defer_odr_event(s);
+
 	/* Now that we have set the odr, update the driver's value. */
 	data->odr = normalized_rate;
 
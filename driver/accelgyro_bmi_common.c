@@ -436,8 +436,13 @@ enum fifo_state {
 	FIFO_DATA_CONFIG,
 };
 
+#ifdef CONFIG_ACCEL_FIFO_BURST_SIZE
+/* Drain the whole FIFO in one transaction. */
+#define BMI_FIFO_BUFFER CONFIG_ACCEL_FIFO_BURST_SIZE
+#else
 #define BMI_FIFO_BUFFER 64
-static uint8_t bmi_buffer[BMI_FIFO_BUFFER];
+#endif
+static uint8_t bmi_buffer[BMI_FIFO_BUFFER] __aligned(4);
 
 int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 {
@@ -551,15 +556,22 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 			bp++;
 			state = FIFO_HEADER;
 			break;
-		case FIFO_DATA_CONFIG:
-			CPRINTS("@ %zd - %d, config change: 0x%02x",
-					bp - bmi_buffer, length, *bp);
+		case FIFO_DATA_CONFIG: {
+			int i;
+
+			/* The new rates start here. */
+			for (i = MOTIONSENSE_TYPE_ACCEL;
+			     i <= MOTIONSENSE_TYPE_GYRO; i++)
+				if (data->flags & BIT(i + BMI_FIFO_FLAG_OFFSET))
+					motion_sense_fifo_stage_odr_event(
+						s + i, last_ts);
 			bp++;
 			if (V(s))
 				state = FIFO_DATA_TIME;
 			else
 				state = FIFO_HEADER;
 			break;
+		}
 		case FIFO_DATA_TIME:
 			if (bp + 3 > ep) {
 				bp = ep;
@@ -728,14 +740,31 @@ int bmi_enable_fifo(const struct motion_sensor_t *s, int enable)
 	if (ret)
 		return ret;
 
-	if (enable)
+	if (enable) {
 		data->flags |= 1 << (s->type + BMI_FIFO_FLAG_OFFSET);
-	else
+	} else {
 		data->flags &= ~(1 << (s->type + BMI_FIFO_FLAG_OFFSET));
+		/* No config frame will time a pending ODR event */
+		if (IS_ENABLED(CONFIG_ACCEL_FIFO))
+			motion_sense_fifo_defer_odr_event(s, false);
+	}
 
 	return ret;
 }
 
+bool bmi_defer_odr_event(const struct motion_sensor_t *s)
+{
+	struct bmi_drv_data_t *data = BMI_GET_DATA(s);
+	bool defer = IS_ENABLED(CONFIG_ACCEL_FIFO) &&
+		     s->type != MOTIONSENSE_TYPE_MAG &&
+		     BMI_GET_SAVED_DATA(s)->odr != 0 &&
+		     (data->flags & BIT(s->type + BMI_FIFO_FLAG_OFFSET));
+
+	if (IS_ENABLED(CONFIG_ACCEL_FIFO))
+		motion_sense_fifo_defer_odr_event(s, defer);
+	return defer;
+}
+
 int bmi_read(const struct motion_sensor_t *s, intv3_t v)
 {
 	uint8_t data[6];
@@ -279,8 +279,8 @@ int bmi_decode_header(struct motion_sensor_t *accel,
  * @s: Pointer to sensor data.
  * @last_ts: The last timestamp of fifo interrupt.
  *
- * Read only up to  bmi_buffer. If more reads are needed, we will be called
- * again by the interrupt routine.
+ * Read only up to  bmi_buffer, CONFIG_ACCEL_FIFO_BURST_SIZE bytes if defined.
+ * If more reads are needed, we will be called again by the interrupt routine.
  *
  * NOTE: If a new driver supports this function, be sure to add a check
  * for spoof_mode in order to load the sensor stack with the spoofed
@@ -313,6 +313,13 @@ int bmi_get_scale(const struct motion_sensor_t *s,
 /* Start/Stop the FIFO collecting events */
 int bmi_enable_fifo(const struct motion_sensor_t *s, int enable);
 
+/*
+ * Called after writing a new data rate: when the sensor is running with its
+ * FIFO on, the new rate starts at a FIFO config frame, which the ODR event is
+ * staged with. Returns true in that case, the change needs no wait.
+ */
+bool bmi_defer_odr_event(const struct motion_sensor_t *s);
+
 /* Read the xyz data of accel/gyro */
 int bmi_read(const struct motion_sensor_t *s, intv3_t v);
 
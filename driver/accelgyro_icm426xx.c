@@ -130,6 +130,9 @@ static int __maybe_unused icm426xx_config_fifo(const struct motion_sensor_t *s,
 	}
 	/* temperature data has to be always present in the FIFO */
 	mask |= ICM426XX_FIFO_TEMP_EN;
+	/* and timestamps in accel + gyro packets, if used */
+	if (IS_ENABLED(CONFIG_ACCEL_FIFO_HW_TIMESTAMPS) && enable)
+		mask |= ICM426XX_FIFO_TMST_FSYNC_EN;
 
 	val = enable ? mask : 0;
 
@@ -146,6 +149,10 @@ static int __maybe_unused icm426xx_config_fifo(const struct motion_sensor_t *s,
 		st->fifo_en &= ~BIT(s->type);
 
 	if (!old_fifo_en && st->fifo_en) {
+#ifdef CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
+		sensor_clock_init(&st->clock, ICM426XX_TMST_RATE_16US,
+				  ICM426XX_TMST_BITS);
+#endif
 		/* 1st sensor enabled => turn FIFO on */
 		ret = icm426xx_enable_fifo(s, 1);
 		if (ret != EC_SUCCESS)
@@ -162,32 +169,88 @@ out_unlock:
 	return ret;
 }
 
-static void __maybe_unused icm426xx_push_fifo_data(struct motion_sensor_t *s,
-						const uint8_t *raw, uint32_t ts)
+/* Number of samples decoded before staging them to the motion sense fifo. */
+#define ICM426XX_FIFO_BATCH	8
+
+/**
+ * Decode a FIFO sample into vect.
+ *
+ * @return 1 if vect holds a sample to stage, 0 otherwise.
+ */
+static int __maybe_unused icm426xx_decode_fifo_data(struct motion_sensor_t *s,
+		const uint8_t *raw, struct ec_response_motion_sensor_data *vect)
 {
 	intv3_t v;
+
+	if (s == NULL || icm426xx_normalize(s, v, raw) != EC_SUCCESS)
+		return 0;
+
+	vect->data[X] = v[X];
+	vect->data[Y] = v[Y];
+	vect->data[Z] = v[Z];
+	vect->flags = 0;
+	vect->sensor_num = s - motion_sensors;
+	return 1;
+}
+
+#ifdef CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
+/**
+ * Stage the samples read from the FIFO with the times the sensor took them
+ * at. The last packet was written right before the interrupt at ts, which
+ * syncs the sensor clock model.
+ *
+ * @return false, with nothing staged, if a packet has no timestamp.
+ */
+static bool icm426xx_stage_timed(struct motion_sensor_t *s, int count,
+				 uint32_t ts)
+{
+	struct icm_drv_data_t *st = ICM_GET_DATA(s);
 	struct ec_response_motion_sensor_data vect;
-	int ret;
+	const uint8_t *accel, *gyro;
+	uint16_t tmst;
+	uint32_t time;
+	int i, size;
 
-	if (s == NULL)
-		return;
+	for (i = 0; i < count; i += size) {
+		size = icm_fifo_decode_packet(&st->fifo_buffer[i], NULL, NULL);
+		if (size < 0 ||
+		    (size > 0 &&
+		     !icm_fifo_packet_timestamp(&st->fifo_buffer[i], &tmst)))
+			return false;
+		if (size == 0)
+			break;
+	}
+	if (i == 0)
+		return false;
+	sensor_clock_sync(&st->clock, tmst, ts);
 
-	ret = icm426xx_normalize(s, v, raw);
-	if (ret == EC_SUCCESS) {
-		vect.data[X] = v[X];
-		vect.data[Y] = v[Y];
-		vect.data[Z] = v[Z];
-		vect.flags = 0;
-		vect.sensor_num = s - motion_sensors;
-		motion_sense_fifo_stage_data(&vect, s, 3, ts);
+	for (i = 0; i < count; i += size) {
+		size = icm_fifo_decode_packet(&st->fifo_buffer[i],
+				&accel, &gyro);
+		if (size <= 0)
+			break;
+		icm_fifo_packet_timestamp(&st->fifo_buffer[i], &tmst);
+		time = sensor_clock_to_ec(&st->clock, tmst);
+		if (accel != NULL &&
+		    icm426xx_decode_fifo_data(st->accel, accel, &vect))
+			motion_sense_fifo_stage_timed_data(&vect, st->accel,
+							   time);
+		if (gyro != NULL &&
+		    icm426xx_decode_fifo_data(st->gyro, gyro, &vect))
+			motion_sense_fifo_stage_timed_data(&vect, st->gyro,
+							   time);
 	}
+	return true;
 }
+#endif
 
 static int __maybe_unused icm426xx_load_fifo(struct motion_sensor_t *s,
 					     uint32_t ts)
 {
+	/* Decoded samples, static to store off stack. */
+	static struct ec_response_motion_sensor_data batch[ICM426XX_FIFO_BATCH];
 	struct icm_drv_data_t *st = ICM_GET_DATA(s);
-	int count, i, size;
+	int count, i, size, n = 0;
 	const uint8_t *accel, *gyro;
 	int ret;
 
@@ -212,19 +275,34 @@ static int __maybe_unused icm426xx_load_fifo(struct motion_sensor_t *s,
 	if (ret != EC_SUCCESS)
 		return ret;
 
+#ifdef CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
+	if (icm426xx_stage_timed(s, count, ts))
+		return EC_SUCCESS;
+#endif
+
 	for (i = 0; i < count; i += size) {
 		size = icm_fifo_decode_packet(&st->fifo_buffer[i],
 				&accel, &gyro);
 		/* exit if error or FIFO is empty */
-		if (size <= 0)
-			return -size;
+		if (size <= 0) {
+			ret = -size;
+			break;
+		}
 		if (accel != NULL)
-			icm426xx_push_fifo_data(st->accel, accel, ts);
+			n += icm426xx_decode_fifo_data(st->accel, accel,
+						       &batch[n]);
 		if (gyro != NULL)
-			icm426xx_push_fifo_data(st->gyro, gyro, ts);
+			n += icm426xx_decode_fifo_data(st->gyro, gyro,
+						       &batch[n]);
+		/* a packet holds up to 2 samples, stage before overflowing */
+		if (n > ICM426XX_FIFO_BATCH - 2) {
+			motion_sense_fifo_stage_batch(batch, n, ts);
+			n = 0;
+		}
 	}
+	motion_sense_fifo_stage_batch(batch, n, ts);
 
-	return EC_SUCCESS;
+	return ret;
 }
 
 #ifdef CONFIG_ACCEL_INTERRUPTS
@@ -858,7 +936,14 @@ static int icm426xx_init_config(const struct motion_sensor_t *s)
 #endif
 	}
 
-	return icm_field_update8(s, ICM426XX_REG_INTF_CONFIG0, mask, val);
+	ret = icm_field_update8(s, ICM426XX_REG_INTF_CONFIG0, mask, val);
+	if (ret != EC_SUCCESS || !IS_ENABLED(CONFIG_ACCEL_FIFO_HW_TIMESTAMPS))
+		return ret;
+
+	/* FIFO timestamps in 16us ticks, the 16 bits wrap after about 1s */
+	return icm_field_update8(s, ICM426XX_REG_TMST_CONFIG,
+				 ICM426XX_TMST_RES | ICM426XX_TMST_EN,
+				 ICM426XX_TMST_RES | ICM426XX_TMST_EN);
 }
 
 static int icm426xx_init(const struct motion_sensor_t *s)
@@ -173,6 +173,14 @@ enum icm426xx_filter_bw {
 #define ICM426XX_GYRO_UI_FILT_MASK	GENMASK(3, 0)
 #define ICM426XX_GYRO_UI_FILT_BW(_f)	((_f) & 0x0F)
 
+#define ICM426XX_REG_TMST_CONFIG	0x0054
+#define ICM426XX_TMST_RES		BIT(3)
+#define ICM426XX_TMST_EN		BIT(0)
+
+/* 16us per FIFO timestamp tick with TMST_RES, in 16.16 fixed point */
+#define ICM426XX_TMST_RATE_16US		(16 << 16)
+#define ICM426XX_TMST_BITS		16
+
 #define ICM426XX_REG_FIFO_CONFIG1	0x005F
 #define ICM426XX_FIFO_PARTIAL_READ	BIT(6)
 #define ICM426XX_FIFO_WM_GT_TH		BIT(5)
@@ -324,6 +324,7 @@ int icm_get_scale(const struct motion_sensor_t *s, uint16_t *scale,
 #define ICM_FIFO_HEADER_ACCEL		BIT(6)
 #define ICM_FIFO_HEADER_GYRO		BIT(5)
 #define ICM_FIFO_HEADER_TMST_FSYNC	GENMASK(3, 2)
+#define ICM_FIFO_HEADER_TMST_ODR	(2 << 2)
 #define ICM_FIFO_HEADER_ODR_ACCEL	BIT(1)
 #define ICM_FIFO_HEADER_ODR_GYRO	BIT(0)
 
@@ -397,3 +398,18 @@ ssize_t icm_fifo_decode_packet(const void *packet, const uint8_t **accel,
 	/* invalid packet if here */
 	return -EC_ERROR_INVAL;
 }
+
+bool icm_fifo_packet_timestamp(const void *packet, uint16_t *tmst)
+{
+	const struct icm_fifo_2sensors_packet *pack2 = packet;
+	uint8_t header = pack2->header;
+
+	if ((header & ICM_FIFO_HEADER_MSG) ||
+	    !(header & ICM_FIFO_HEADER_ACCEL) ||
+	    !(header & ICM_FIFO_HEADER_GYRO) ||
+	    (header & ICM_FIFO_HEADER_TMST_FSYNC) != ICM_FIFO_HEADER_TMST_ODR)
+		return false;
+
+	*tmst = pack2->timestamp;
+	return true;
+}
@@ -9,8 +9,11 @@
 #define __CROS_EC_ACCELGYRO_ICM_COMMON_H
 
 #include "accelgyro.h"
+#include "sensor_clock.h"
 
-#ifdef CONFIG_ACCEL_FIFO
+#if defined(CONFIG_ACCEL_FIFO_BURST_SIZE)
+#define ICM_FIFO_BUFFER	CONFIG_ACCEL_FIFO_BURST_SIZE
+#elif defined(CONFIG_ACCEL_FIFO)
 /* reserve maximum 4 samples of 16 bytes */
 #define ICM_FIFO_BUFFER	64
 #else
@@ -24,6 +27,10 @@ struct icm_drv_data_t {
 	uint8_t bank;
 	uint8_t fifo_en;
 	uint8_t fifo_buffer[ICM_FIFO_BUFFER] __aligned(sizeof(long));
+#ifdef CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
+	/* Model of the FIFO timestamp clock */
+	struct sensor_clock clock;
+#endif
 };
 
 #define ICM_GET_DATA(_s) \
@@ -98,4 +105,14 @@ int icm_get_scale(const struct motion_sensor_t *s, uint16_t *scale,
 ssize_t icm_fifo_decode_packet(const void *packet, const uint8_t **accel,
 		const uint8_t **gyro);
 
+/**
+ * Get the time the sensor sampled a FIFO packet at. Only packets holding both
+ * accel and gyro data carry a timestamp.
+ *
+ * @param packet FIFO packet, decoded by icm_fifo_decode_packet()
+ * @param tmst sensor timestamp of the packet
+ * @return true if the packet has the timestamp of its ODR sample
+ */
+bool icm_fifo_packet_timestamp(const void *packet, uint16_t *tmst);
+
 #endif	/* __CROS_EC_ACCELGYRO_ICM_COMMON_H */
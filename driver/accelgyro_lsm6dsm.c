@@ -15,6 +15,7 @@
 #include "hwtimer.h"
 #include "mag_cal.h"
 #include "math_util.h"
+#include "motion_lid.h"
 #include "motion_sense_fifo.h"
 #include "queue.h"
 #include "task.h"
@@ -30,6 +31,16 @@
 #define FIFO_READ_LEN 0
 #endif
 
+#ifdef CONFIG_ACCEL_FIFO_BURST_SIZE
+/* Drain the whole FIFO in one transaction, into a static buffer. */
+#define LSM6DSM_FIFO_READ_LEN \
+	(CONFIG_ACCEL_FIFO_BURST_SIZE / OUT_XYZ_SIZE * OUT_XYZ_SIZE)
+#define LSM6DSM_FIFO_STORAGE static
+#else
+#define LSM6DSM_FIFO_READ_LEN FIFO_READ_LEN
+#define LSM6DSM_FIFO_STORAGE
+#endif
+
 #ifndef CONFIG_ACCEL_LSM6DSM_INT_EVENT
 #define CONFIG_ACCEL_LSM6DSM_INT_EVENT 0
 #endif
@@ -101,6 +112,23 @@ static inline int get_xyz_reg(enum motionsensor_type type)
 		(LSM6DSM_ACCEL_OUT_X_L_ADDR - LSM6DSM_GYRO_OUT_X_L_ADDR) * type;
 }
 
+/**
+ * accel_odr_reg - ODR register value of the accelerometer
+ * @accel: Motion sensor pointer to accelerometer.
+ * @odr: Data rate (mHz) the accelerometer is configured at, 0 when idle.
+ *
+ * While the tilt engine is armed, an idle accelerometer keeps running at
+ * LSM6DSM_TILT_ODR, behind the back of set/get_data_rate.
+ */
+static uint8_t accel_odr_reg(const struct motion_sensor_t *accel, int odr)
+{
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	if (odr == 0 && LSM6DSM_GET_DATA(accel)->tilt_enabled)
+		odr = LSM6DSM_TILT_ODR;
+#endif
+	return odr > 0 ? LSM6DSM_ODR_TO_REG(odr) : 0;
+}
+
 /**
  * Configure interrupt int 1 to fire handler for:
  *
@@ -256,7 +284,7 @@ static int fifo_enable(const struct motion_sensor_t *accel)
 	} else {
 		st_write_data_with_mask(accel, LSM6DSM_ODR_REG(accel->type),
 				LSM6DSM_ODR_MASK,
-				LSM6DSM_ODR_TO_REG(odrs[FIFO_DEV_ACCEL]));
+				accel_odr_reg(accel, odrs[FIFO_DEV_ACCEL]));
 	}
 #endif /* CONFIG_MAG_LSM6DSM_LIS2MDL */
 	/*
@@ -377,7 +405,7 @@ static int load_fifo(struct motion_sensor_t *s, const struct fstatus *fsts,
 {
 	uint32_t interrupt_timestamp = last_interrupt_timestamp;
 	int err, left, length;
-	uint8_t fifo[FIFO_READ_LEN];
+	LSM6DSM_FIFO_STORAGE uint8_t fifo[LSM6DSM_FIFO_READ_LEN];
 
 	/* Reset the load_fifo_sensor_state so we can start a new read. */
 	reset_load_fifo_sensor_state(s, interrupt_timestamp);
@@ -399,8 +427,8 @@ static int load_fifo(struct motion_sensor_t *s, const struct fstatus *fsts,
 	/* Push all data on upper side. */
 	do {
 		/* Fit len to pre-allocated static buffer. */
-		if (left > FIFO_READ_LEN)
-			length = FIFO_READ_LEN;
+		if (left > LSM6DSM_FIFO_READ_LEN)
+			length = LSM6DSM_FIFO_READ_LEN;
 		else
 			length = left;
 
@@ -474,6 +502,20 @@ __maybe_unused static int irq_handler(
 	    (!(*event & CONFIG_ACCEL_LSM6DSM_INT_EVENT)))
 		return EC_ERROR_NOT_HANDLED;
 
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	if (LSM6DSM_GET_DATA(s)->tilt_enabled) {
+		int func_src;
+
+		/* Reading the source register acknowledges the event. */
+		ret = st_raw_read8(s->port, s->i2c_spi_addr_flags,
+				   LSM6DSM_FUNC_SRC1_ADDR, &func_src);
+		if (ret != EC_SUCCESS)
+			return ret;
+		if (func_src & LSM6DSM_TILT_IA)
+			motion_lid_wake();
+	}
+#endif
+
 	if (IS_ENABLED(CONFIG_ACCEL_FIFO)) {
 		struct fstatus fsts;
 		uint32_t last_fifo_read_ts;
@@ -636,6 +678,8 @@ int lsm6dsm_set_data_rate(const struct motion_sensor_t *s, int rate, int rnd)
 	{
 		mutex_lock(s->mutex);
 		ctrl_reg = LSM6DSM_ODR_REG(s->type);
+		if (s->type == MOTIONSENSE_TYPE_ACCEL && rate == 0)
+			reg_val = accel_odr_reg(s, 0);
 		ret = st_write_data_with_mask(s, ctrl_reg, LSM6DSM_ODR_MASK,
 					      reg_val);
 	}
@@ -660,6 +704,46 @@ int lsm6dsm_set_data_rate(const struct motion_sensor_t *s, int rate, int rnd)
 	return ret;
 }
 
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+/**
+ * set_tilt_detection - arm the embedded tilt engine on interrupt 1
+ * @s: Motion sensor pointer: must be MOTIONSENSE_TYPE_ACCEL.
+ * @enable: 1 to arm the engine, 0 to disarm it.
+ */
+static int set_tilt_detection(const struct motion_sensor_t *s, int enable)
+{
+	struct stprivate_data *data = s->drv_data;
+	struct lsm6dsm_data *private = LSM6DSM_GET_DATA(s);
+	/* The sensor hub needs the embedded functions enabled as well. */
+	uint8_t func_mask = IS_ENABLED(CONFIG_LSM6DSM_SEC_I2C) ?
+		LSM6DSM_TILT_EN : LSM6DSM_EMBED_FUNC_EN | LSM6DSM_TILT_EN;
+	int ret;
+
+	if (s->type != MOTIONSENSE_TYPE_ACCEL)
+		return EC_RES_INVALID_PARAM;
+
+	mutex_lock(s->mutex);
+	private->tilt_enabled = enable;
+	ret = st_write_data_with_mask(s, LSM6DSM_ODR_REG(s->type),
+				      LSM6DSM_ODR_MASK,
+				      accel_odr_reg(s, data->base.odr));
+	if (ret != EC_SUCCESS)
+		goto err_unlock;
+
+	ret = st_write_data_with_mask(s, LSM6DSM_CTRL10_ADDR, func_mask,
+				      enable ? 0xff : 0);
+	if (ret != EC_SUCCESS)
+		goto err_unlock;
+
+	ret = st_write_data_with_mask(s, LSM6DSM_MD1_CFG_ADDR,
+				      LSM6DSM_INT1_TILT, enable);
+
+err_unlock:
+	mutex_unlock(s->mutex);
+	return ret;
+}
+#endif /* CONFIG_LID_ANGLE_OFFLOAD */
+
 static int is_data_ready(const struct motion_sensor_t *s, int *ready)
 {
 	int ret, tmp;
@@ -865,4 +949,7 @@ const struct accelgyro_drv lsm6dsm_drv = {
 #ifdef CONFIG_ACCEL_INTERRUPTS
 	.irq_handler = irq_handler,
 #endif /* CONFIG_ACCEL_INTERRUPTS */
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	.set_tilt_detection = set_tilt_detection,
+#endif
 };
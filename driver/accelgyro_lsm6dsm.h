@@ -94,6 +94,7 @@
 #define LSM6DSM_SIG_MOT_MASK			0x01
 #define LSM6DSM_EMBED_FUNC_EN			0x04
 #define LSM6DSM_SIG_MOT_EN			0x01
+#define LSM6DSM_TILT_EN				0x08
 
 /* Master mode configuration register */
 #define LSM6DSM_MASTER_CFG_ADDR		0x1a
@@ -134,6 +135,7 @@
 
 #define LSM6DSM_FUNC_SRC1_ADDR		0x53
 #define LSM6DSM_SENSORHUB_END_OP		0x01
+#define LSM6DSM_TILT_IA				0x20
 #define LSM6DSM_SIGN_MOTION_IA			0x40
 
 #define LSM6DSM_LIR_ADDR		0x58
@@ -156,6 +158,7 @@
 #define LSM6DSM_DTAP_EN				1
 
 #define LSM6DSM_MD1_CFG_ADDR		0x5e
+#define LSM6DSM_INT1_TILT			0x02
 #define LSM6DSM_INT1_STAP			0x40
 #define LSM6DSM_INT1_DTAP			0x08
 
@@ -200,6 +203,9 @@ struct fstatus {
 #define LSM6DSM_ODR_MAX_VAL \
 	MOTION_MAX_SENSOR_FREQUENCY(416000, LSM6DSM_ODR_MIN_VAL)
 
+/* The tilt engine needs the accelerometer running at 26Hz at least. */
+#define LSM6DSM_TILT_ODR		26000
+
 /* ODR reg value from selected data rate in mHz */
 #define LSM6DSM_ODR_TO_REG(_odr) (__fls(_odr / LSM6DSM_ODR_MIN_VAL) + 1)
 
@@ -353,6 +359,10 @@ struct lsm6dsm_data {
 	struct stprivate_data st_data[2];
 #endif
 	struct lsm6dsm_accel_fifo_state *accel_fifo_state;
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	/* Accelerometer kept at LSM6DSM_TILT_ODR while it is idle. */
+	int tilt_enabled;
+#endif
 #if defined(CONFIG_LSM6DSM_SEC_I2C) && defined(CONFIG_MAG_CALIBRATE)
 	union {
 #ifdef CONFIG_MAG_LSM6DSM_BMM150
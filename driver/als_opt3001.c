@@ -8,6 +8,7 @@
 #include "common.h"
 #include "driver/als_opt3001.h"
 #include "i2c.h"
+#include "util.h"
 
 #ifdef HAS_TASK_ALS
 /**
@@ -92,6 +93,43 @@ int opt3001_read_lux(int *lux, int af)
 	return EC_SUCCESS;
 }
 
+/**
+ * Encode a limit in the format of the result register: 2EXP[3:0] x R[11:0],
+ * in 0.01 lux.
+ */
+static int opt3001_limit(int value, int round_up)
+{
+	int exp = 0;
+
+	while (value > OPT3001_RANGE_MASK && exp < 11) {
+		value = (value + (round_up ? 1 : 0)) >> 1;
+		exp++;
+	}
+	return (exp << OPT3001_RANGE_OFFSET) | MIN(value, OPT3001_RANGE_MASK);
+}
+
+/**
+ * Interrupt when the OPT3001 light sensor leaves [low, high] lux.
+ */
+int opt3001_set_threshold(int low, int high, int af)
+{
+	int data;
+	int ret;
+
+	/* Reading the configuration clears the latched interrupt. */
+	ret = opt3001_i2c_read(OPT3001_REG_CONFIGURE, &data);
+	if (ret)
+		return ret;
+
+	ret = opt3001_i2c_write(OPT3001_REG_INT_LIMIT_LSB,
+				opt3001_limit(low * 100 / af, 0));
+	if (ret)
+		return ret;
+
+	return opt3001_i2c_write(OPT3001_REG_INT_LIMIT_MSB,
+				 opt3001_limit(DIV_ROUND_UP(high * 100, af), 1));
+}
+
 #ifdef CONFIG_CMD_I2C_STRESS_TEST_ALS
 struct i2c_stress_test_dev opt3001_i2c_stress_test_dev = {
 	.reg_info = {
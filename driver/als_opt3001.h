@@ -49,6 +49,7 @@ enum opt3001_mode {
 #ifdef HAS_TASK_ALS
 int opt3001_init(void);
 int opt3001_read_lux(int *lux, int af);
+int opt3001_set_threshold(int low, int high, int af);
 #else
 #define OPT3001_GET_DATA(_s)	((struct opt3001_drv_data_t *)(_s)->drv_data)
 
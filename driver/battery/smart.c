@@ -360,19 +360,94 @@ static void apply_fake_state_of_charge(struct batt_params *batt)
 	batt->flags &= ~BATT_FLAG_BAD_REMAINING_CAPACITY;
 }
 
+#ifdef CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL
+/* BATT_FLAG_BAD_* of the parameters served from slow_params */
+#define SLOW_PARAMS_FLAGS (BATT_FLAG_BAD_TEMPERATURE |		\
+			   BATT_FLAG_BAD_DESIRED_VOLTAGE |	\
+			   BATT_FLAG_BAD_DESIRED_CURRENT |	\
+			   BATT_FLAG_BAD_FULL_CAPACITY)
+
+/* Status bits whose change refreshes the slow parameters */
+#define SLOW_PARAMS_STATUS (STATUS_FULLY_DISCHARGED |		\
+			    STATUS_FULLY_CHARGED |		\
+			    STATUS_DISCHARGING |		\
+			    STATUS_INITIALIZED)
+
+/* Status bits refreshing the slow parameters for as long as they are set */
+#define SLOW_PARAMS_ALARMS (STATUS_OVERCHARGED_ALARM |		\
+			    STATUS_TERMINATE_CHARGE_ALARM |	\
+			    STATUS_OVERTEMP_ALARM |		\
+			    STATUS_TERMINATE_DISCHARGE_ALARM)
+
+/* Last reads of the parameters which only change over seconds */
+static struct {
+	uint64_t next_refresh;
+	int status;
+	int flags;
+	int temperature;
+	int desired_voltage;
+	int desired_current;
+	int full_capacity;
+} slow_params;
+
+/*
+ * The temperature, the charging voltage and current requested by the battery
+ * and its full charge capacity are read again every
+ * CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL, when the status changes or
+ * raises an alarm, and after any failed read.
+ */
+static int slow_params_stale(const struct batt_params *batt)
+{
+	return slow_params.flags & SLOW_PARAMS_FLAGS ||
+	       batt->flags & BATT_FLAG_BAD_ANY ||
+	       (batt->status ^ slow_params.status) & SLOW_PARAMS_STATUS ||
+	       batt->status & SLOW_PARAMS_ALARMS ||
+	       get_time().val >= slow_params.next_refresh;
+}
+#endif
+
+static void read_slow_params(struct batt_params *batt)
+{
+#ifdef CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL
+	if (!slow_params_stale(batt)) {
+		batt->temperature = slow_params.temperature;
+		batt->desired_voltage = slow_params.desired_voltage;
+		batt->desired_current = slow_params.desired_current;
+		batt->full_capacity = slow_params.full_capacity;
+		batt->flags |= slow_params.flags;
+		return;
+	}
+#endif
+
+	if (sb_read(SB_TEMPERATURE, &batt->temperature))
+		batt->flags |= BATT_FLAG_BAD_TEMPERATURE;
+
+	if (sb_read(SB_CHARGING_VOLTAGE, &batt->desired_voltage))
+		batt->flags |= BATT_FLAG_BAD_DESIRED_VOLTAGE;
+
+	if (sb_read(SB_CHARGING_CURRENT, &batt->desired_current))
+		batt->flags |= BATT_FLAG_BAD_DESIRED_CURRENT;
+
+	if (battery_full_charge_capacity(&batt->full_capacity))
+		batt->flags |= BATT_FLAG_BAD_FULL_CAPACITY;
+
+#ifdef CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL
+	slow_params.next_refresh = get_time().val +
+				   CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL;
+	slow_params.status = batt->status;
+	slow_params.flags = batt->flags & SLOW_PARAMS_FLAGS;
+	slow_params.temperature = batt->temperature;
+	slow_params.desired_voltage = batt->desired_voltage;
+	slow_params.desired_current = batt->desired_current;
+	slow_params.full_capacity = batt->full_capacity;
+#endif
+}
+
 void battery_get_params(struct batt_params *batt)
 {
 	struct batt_params batt_new = {0};
 	int v;
 
-	if (sb_read(SB_TEMPERATURE, &batt_new.temperature)
-			&& fake_temperature < 0)
-		batt_new.flags |= BATT_FLAG_BAD_TEMPERATURE;
-
-	/* If temperature is faked, override with faked data */
-	if (fake_temperature >= 0)
-		batt_new.temperature = fake_temperature;
-
 	if (sb_read(SB_RELATIVE_STATE_OF_CHARGE, &batt_new.state_of_charge)
 	    && fake_state_of_charge < 0)
 		batt_new.flags |= BATT_FLAG_BAD_STATE_OF_CHARGE;
@@ -386,21 +461,20 @@ void battery_get_params(struct batt_params *batt)
 	else
 		batt_new.current = (int16_t)v;
 
-	if (sb_read(SB_CHARGING_VOLTAGE, &batt_new.desired_voltage))
-		batt_new.flags |= BATT_FLAG_BAD_DESIRED_VOLTAGE;
-
-	if (sb_read(SB_CHARGING_CURRENT, &batt_new.desired_current))
-		batt_new.flags |= BATT_FLAG_BAD_DESIRED_CURRENT;
-
 	if (battery_remaining_capacity(&batt_new.remaining_capacity))
 		batt_new.flags |= BATT_FLAG_BAD_REMAINING_CAPACITY;
 
-	if (battery_full_charge_capacity(&batt_new.full_capacity))
-		batt_new.flags |= BATT_FLAG_BAD_FULL_CAPACITY;
-
 	if (battery_status(&batt_new.status))
 		batt_new.flags |= BATT_FLAG_BAD_STATUS;
 
+	read_slow_params(&batt_new);
+
+	/* If temperature is faked, override with faked data */
+	if (fake_temperature >= 0) {
+		batt_new.temperature = fake_temperature;
+		batt_new.flags &= ~BATT_FLAG_BAD_TEMPERATURE;
+	}
+
 	/* If any of those reads worked, the battery is responsive */
 	if ((batt_new.flags & BATT_FLAG_BAD_ANY) != BATT_FLAG_BAD_ANY)
 		batt_new.flags |= BATT_FLAG_RESPONSIVE;
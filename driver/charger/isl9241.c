@@ -60,9 +60,32 @@ static const struct charger_info isl9241_charger_info = {
 
 static enum ec_error_list isl9241_discharge_on_ac(int chgnum, int enable);
 
+/*
+ * Registers the charge loop sets over and over, and which only change when
+ * written; these go through the charger register cache.
+ */
+static inline int isl9241_reg_is_cached(int offset)
+{
+	switch (offset) {
+	case ISL9241_REG_CHG_CURRENT_LIMIT:
+	case ISL9241_REG_MAX_SYSTEM_VOLTAGE:
+	case ISL9241_REG_MIN_SYSTEM_VOLTAGE:
+	case ISL9241_REG_ADAPTER_CUR_LIMIT1:
+	case ISL9241_REG_ADAPTER_CUR_LIMIT2:
+	case ISL9241_REG_CONTROL0:
+	case ISL9241_REG_CONTROL1:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
 static inline enum ec_error_list isl9241_read(int chgnum, int offset,
 					      int *value)
 {
+	if (isl9241_reg_is_cached(offset))
+		return charger_cached_read16(chgnum, offset, value);
+
 	return i2c_read16(chg_chips[chgnum].i2c_port,
 			  chg_chips[chgnum].i2c_addr_flags,
 			  offset, value);
@@ -71,6 +94,9 @@ static inline enum ec_error_list isl9241_read(int chgnum, int offset,
 static inline enum ec_error_list isl9241_write(int chgnum, int offset,
 					       int value)
 {
+	if (isl9241_reg_is_cached(offset))
+		return charger_cached_write16(chgnum, offset, value);
+
 	return i2c_write16(chg_chips[chgnum].i2c_port,
 			   chg_chips[chgnum].i2c_addr_flags,
 			   offset, value);
@@ -80,6 +106,9 @@ static inline enum ec_error_list isl9241_update(int chgnum, int offset,
 						uint16_t mask,
 						enum mask_update_action action)
 {
+	if (isl9241_reg_is_cached(offset))
+		return charger_cached_update16(chgnum, offset, mask, action);
+
 	return i2c_update16(chg_chips[chgnum].i2c_port,
 			    chg_chips[chgnum].i2c_addr_flags,
 			    offset, mask, action);
@@ -218,6 +247,7 @@ static enum ec_error_list isl9241_set_mode(int chgnum, int mode)
 	if (mode & CHARGE_FLAG_POR_RESET) {
 		rv = isl9241_write(chgnum, ISL9241_REG_CONTROL3,
 			ISL9241_CONTROL3_DIGITAL_RESET);
+		charger_cache_invalidate(chgnum);
 	}
 
 	return rv;
@@ -154,6 +154,11 @@ DECLARE_DEFERRED(aoz1380_irq_deferred);
 
 void aoz1380_interrupt(int port)
 {
+	if (IS_ENABLED(CONFIG_USB_PD_INT_DISPATCH)) {
+		schedule_deferred_ppc_interrupt(port);
+		return;
+	}
+
 	deprecated_atomic_or(&irq_pending, BIT(port));
 	hook_call_deferred(&aoz1380_irq_deferred_data, 0);
 }
@@ -165,4 +170,5 @@ const struct ppc_drv aoz1380_drv = {
 	.vbus_source_enable = &aoz1380_vbus_source_enable,
 	.set_vbus_source_current_limit =
 		&aoz1380_set_vbus_source_current_limit,
+	.handle_interrupt = &aoz1380_handle_interrupt,
 };
@@ -394,6 +394,11 @@ DECLARE_DEFERRED(nx20p348x_irq_deferred);
 
 void nx20p348x_interrupt(int port)
 {
+	if (IS_ENABLED(CONFIG_USB_PD_INT_DISPATCH)) {
+		schedule_deferred_ppc_interrupt(port);
+		return;
+	}
+
 	deprecated_atomic_or(&irq_pending, BIT(port));
 	hook_call_deferred(&nx20p348x_irq_deferred_data, 0);
 }
@@ -472,4 +477,5 @@ const struct ppc_drv nx20p348x_drv = {
 #ifdef CONFIG_USBC_PPC_VCONN
 	.set_vconn = &nx20p348x_set_vconn,
 #endif /* defined(CONFIG_USBC_PPC_VCONN) */
+	.handle_interrupt = &nx20p348x_handle_interrupt,
 };
@@ -722,6 +722,11 @@ DECLARE_DEFERRED(sn5s330_irq_deferred);
 
 void sn5s330_interrupt(int port)
 {
+	if (IS_ENABLED(CONFIG_USB_PD_INT_DISPATCH)) {
+		schedule_deferred_ppc_interrupt(port);
+		return;
+	}
+
 	deprecated_atomic_or(&irq_pending, BIT(port));
 	hook_call_deferred(&sn5s330_irq_deferred_data, 0);
 }
@@ -749,4 +754,5 @@ const struct ppc_drv sn5s330_drv = {
 #ifdef CONFIG_USBC_PPC_VCONN
 	.set_vconn = &sn5s330_set_vconn,
 #endif
+	.handle_interrupt = &sn5s330_handle_interrupt,
 };
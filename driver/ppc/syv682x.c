@@ -506,7 +506,10 @@ static void syv682x_interrupt_delayed(int port, int delay)
 void syv682x_interrupt(int port)
 {
 	/* FRS timings require <15ms response to an FRS event */
-	syv682x_interrupt_delayed(port, 0);
+	if (IS_ENABLED(CONFIG_USB_PD_INT_DISPATCH))
+		schedule_deferred_ppc_interrupt(port);
+	else
+		syv682x_interrupt_delayed(port, 0);
 }
 
 /*
@@ -703,4 +706,5 @@ const struct ppc_drv syv682x_drv = {
 #ifdef CONFIG_USBC_PPC_VCONN
 	.set_vconn = &syv682x_set_vconn,
 #endif
+	.handle_interrupt = &syv682x_handle_interrupt,
 };
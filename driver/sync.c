@@ -74,7 +74,7 @@ void sync_interrupt(enum gpio_signal signal)
 		return;
 
 	next_event.counter++;
-	queue_add_unit(&sync_event_queue, &next_event);
+	QUEUE_ADD_UNIT_SPSC(&sync_event_queue, &next_event);
 
 	task_set_event(TASK_ID_MOTIONSENSE, CONFIG_SYNC_INT_EVENT, 0);
 }
@@ -87,7 +87,7 @@ static int motion_irq_handler(struct motion_sensor_t *s, uint32_t *event)
 	if (!(*event & CONFIG_SYNC_INT_EVENT))
 		return EC_ERROR_NOT_HANDLED;
 
-	while (queue_remove_unit(&sync_event_queue, &sync_event)) {
+	while (QUEUE_REMOVE_UNIT_SPSC(&sync_event_queue, &sync_event)) {
 		vector.data[X] = sync_event.counter;
 		motion_sense_fifo_stage_data(
 			&vector, s, 1, sync_event.timestamp);
@@ -350,6 +350,7 @@ static int anx7447_init(int port)
 	 */
 	rv = tcpc_update16(port, TCPC_REG_POWER_CTRL,
 			   TCPC_REG_POWER_CTRL_VBUS_VOL_MONITOR_DIS, MASK_SET);
+	tcpci_shadow_invalidate(port);
 	if (rv)
 		return rv;
 
@@ -689,19 +690,19 @@ static int anx7447_set_cc(int port, int pull)
 	rp = tcpci_get_cached_rp(port);
 
 	/* Set manual control, and set both CC lines to the same pull */
-	return tcpc_write(port, TCPC_REG_ROLE_CTRL,
-			  TCPC_REG_ROLE_CTRL_SET(0, rp, pull, pull));
+	return tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL,
+				  TCPC_REG_ROLE_CTRL_SET(0, rp, pull, pull));
 }
 
 /* Override for tcpci_tcpm_set_polarity */
 static int anx7447_set_polarity(int port,
 				enum tcpc_cc_polarity polarity)
 {
-	return tcpc_update8(port,
-			    TCPC_REG_TCPC_CTRL,
-			    TCPC_REG_TCPC_CTRL_SET(1),
-			    polarity_rm_dts(polarity)
-					? MASK_SET : MASK_CLR);
+	return tcpci_shadow_update8(port,
+				    TCPC_REG_TCPC_CTRL,
+				    TCPC_REG_TCPC_CTRL_SET(1),
+				    polarity_rm_dts(polarity)
+						? MASK_SET : MASK_CLR);
 }
 
 #ifdef CONFIG_CMD_TCPC_DUMP
@@ -47,24 +47,24 @@ int fusb307_tcpm_set_polarity(int port, enum tcpc_cc_polarity polarity)
 			int role = TCPC_REG_ROLE_CTRL_SET(0,
 			tcpci_get_cached_rp(port), TYPEC_CC_RD, TYPEC_CC_OPEN);
 
-			tcpc_write(port, TCPC_REG_ROLE_CTRL, role);
+			tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL, role);
 		} else {
 			int role = TCPC_REG_ROLE_CTRL_SET(0,
 			tcpci_get_cached_rp(port), TYPEC_CC_RP, TYPEC_CC_OPEN);
 
-			tcpc_write(port, TCPC_REG_ROLE_CTRL, role);
+			tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL, role);
 		}
 	} else if (cc2) {
 		if (pd_get_power_role(port) == PD_ROLE_SINK) {
 			int role = TCPC_REG_ROLE_CTRL_SET(0,
 			tcpci_get_cached_rp(port), TYPEC_CC_OPEN, TYPEC_CC_RD);
 
-			tcpc_write(port, TCPC_REG_ROLE_CTRL, role);
+			tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL, role);
 		} else {
 			int role = TCPC_REG_ROLE_CTRL_SET(0,
 			tcpci_get_cached_rp(port), TYPEC_CC_OPEN, TYPEC_CC_RP);
 
-			tcpc_write(port, TCPC_REG_ROLE_CTRL, role);
+			tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL, role);
 		}
 	} else {
 		if (pd_get_power_role(port) == PD_ROLE_SINK)
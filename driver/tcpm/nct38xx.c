@@ -50,11 +50,11 @@ static int nct38xx_init(int port)
 		return rv;
 
 	/* Enable VBus monitor and Disable FRS */
-	rv = tcpc_update8(port,
-			  TCPC_REG_POWER_CTRL,
-			  (TCPC_REG_POWER_CTRL_VBUS_VOL_MONITOR_DIS |
-			   TCPC_REG_POWER_CTRL_FRS_ENABLE),
-			  MASK_CLR);
+	rv = tcpci_shadow_update8(port,
+				  TCPC_REG_POWER_CTRL,
+				  (TCPC_REG_POWER_CTRL_VBUS_VOL_MONITOR_DIS |
+				   TCPC_REG_POWER_CTRL_FRS_ENABLE),
+				  MASK_CLR);
 	if (rv)
 		return rv;
 
@@ -133,9 +133,9 @@ int raa489000_init(int port)
 	 * Disable VBUS auto discharge, we'll turn it on later as its needed to
 	 * goodcrc.
 	 */
-	rv = tcpc_read(port, TCPC_REG_POWER_CTRL, &regval);
-	regval &= ~TCPC_REG_POWER_CTRL_AUTO_DISCHARGE_DISCONNECT;
-	rv |= tcpc_write(port, TCPC_REG_POWER_CTRL, regval);
+	rv = tcpci_shadow_update8(port, TCPC_REG_POWER_CTRL,
+				  TCPC_REG_POWER_CTRL_AUTO_DISCHARGE_DISCONNECT,
+				  MASK_CLR);
 	if (rv)
 		CPRINTS("c%d: failed to set auto discharge", port);
 
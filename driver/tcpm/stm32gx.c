@@ -25,6 +25,11 @@
 #error "Unsupported config options of Stm32gx PD driver"
 #endif
 
+/* Received messages are handed to the protocol layer by the TCPCI RX cache */
+#ifndef CONFIG_USB_PD_TCPM_TCPCI
+#error "Stm32gx PD driver requires CONFIG_USB_PD_TCPM_TCPCI"
+#endif
+
 /* Wait time for vconn power switch to turn off. */
 #ifndef PD_STM32GX_VCONN_TURN_OFF_DELAY_US
 #define PD_STM32GX_VCONN_TURN_OFF_DELAY_US 500
@@ -35,8 +40,7 @@ static int cached_rp[CONFIG_USB_PD_PORT_MAX_COUNT];
 
 static int stm32gx_tcpm_get_message_raw(int port, uint32_t *buf, int *head)
 {
-	/* TODO(b/167601672): Need to implement this for USB-PD support */
-	return EC_SUCCESS;
+	return stm32gx_ucpd_get_message_raw(port, buf, head);
 }
 
 static int stm32gx_tcpm_init(int port)
@@ -82,19 +86,22 @@ static int stm32gx_tcpm_set_vconn(int port, int enable)
 	 * only action required here will be to remove Rp from the CC line that
 	 * is supplying VCONN.
 	 */
+
+	/* Only the VCONN Source is allowed to talk to the Cable Plugs */
+	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP))
+		stm32gx_ucpd_sop_prime_enable(port, enable);
+
 	return EC_SUCCESS;
 }
 
 static int stm32gx_tcpm_set_msg_header(int port, int power_role, int data_role)
 {
-	/* TODO(b/167601672): Need to implement this for USB-PD support */
-	return EC_SUCCESS;
+	return stm32gx_ucpd_set_msg_header(port, power_role, data_role);
 }
 
 static int stm32gx_tcpm_set_rx_enable(int port, int enable)
 {
-	/* TODO(b/167601672): Need to implement this for USB-PD support */
-	return EC_SUCCESS;
+	return stm32gx_ucpd_set_rx_enable(port, enable);
 }
 
 static int stm32gx_tcpm_transmit(int port,
@@ -102,14 +109,12 @@ static int stm32gx_tcpm_transmit(int port,
 			uint16_t header,
 			const uint32_t *data)
 {
-	/* TODO(b/167601672): Need to implement this for USB-PD support */
-	return EC_SUCCESS;
+	return stm32gx_ucpd_transmit(port, type, header, data);
 }
 
 static int stm32gx_tcpm_sop_prime_disable(int port)
 {
-	/* TODO(b/167601672): Need to implement this for USB-PD support */
-	return EC_SUCCESS;
+	return stm32gx_ucpd_sop_prime_enable(port, false);
 }
 
 
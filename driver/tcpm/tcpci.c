@@ -10,7 +10,9 @@
 #include "compile_time_macros.h"
 #include "console.h"
 #include "ec_commands.h"
+#include "hooks.h"
 #include "ps8xxx.h"
+#include "system.h"
 #include "task.h"
 #include "tcpci.h"
 #include "tcpm.h"
@@ -301,6 +303,110 @@ int tcpci_get_cached_rp(int port)
 	return cached_rp[port];
 }
 
+/*
+ * Write-through shadow of the TCPC control registers only the TCPM writes, so
+ * reading or updating them does not cost an I2C read.
+ */
+enum tcpci_shadow_reg {
+	SHADOW_ROLE_CTRL,
+	SHADOW_POWER_CTRL,
+	SHADOW_TCPC_CTRL,
+	SHADOW_COUNT,
+};
+
+struct tcpci_shadow {
+	/* Bitmask of the valid enum tcpci_shadow_reg values */
+	uint8_t valid;
+	uint8_t val[SHADOW_COUNT];
+};
+STATIC_IF(CONFIG_USB_PD_TCPCI_SHADOW_REGS)
+	struct tcpci_shadow shadow[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+static int shadow_index(int reg)
+{
+	switch (reg) {
+	case TCPC_REG_ROLE_CTRL:
+		return SHADOW_ROLE_CTRL;
+	case TCPC_REG_POWER_CTRL:
+		return SHADOW_POWER_CTRL;
+	case TCPC_REG_TCPC_CTRL:
+		return SHADOW_TCPC_CTRL;
+	default:
+		return -1;
+	}
+}
+
+void tcpci_shadow_invalidate(int port)
+{
+	if (IS_ENABLED(CONFIG_USB_PD_TCPCI_SHADOW_REGS))
+		shadow[port].valid = 0;
+}
+
+int tcpci_shadow_read(int port, int reg, int *val)
+{
+	const int i = shadow_index(reg);
+	int rv;
+
+	if (!IS_ENABLED(CONFIG_USB_PD_TCPCI_SHADOW_REGS) || i < 0)
+		return tcpc_read(port, reg, val);
+
+	if (shadow[port].valid & BIT(i)) {
+		*val = shadow[port].val[i];
+		return EC_SUCCESS;
+	}
+
+	rv = tcpc_read(port, reg, val);
+	if (rv == EC_SUCCESS) {
+		shadow[port].val[i] = *val;
+		shadow[port].valid |= BIT(i);
+	}
+
+	return rv;
+}
+
+int tcpci_shadow_write(int port, int reg, int val)
+{
+	const int i = shadow_index(reg);
+	int rv;
+
+	rv = tcpc_write(port, reg, val);
+
+	if (!IS_ENABLED(CONFIG_USB_PD_TCPCI_SHADOW_REGS) || i < 0)
+		return rv;
+
+	/* A failed write leaves the register in an unknown state */
+	if (rv == EC_SUCCESS) {
+		shadow[port].val[i] = val;
+		shadow[port].valid |= BIT(i);
+	} else {
+		shadow[port].valid &= ~BIT(i);
+	}
+
+	return rv;
+}
+
+int tcpci_shadow_update8(int port, int reg, uint8_t mask,
+			 enum mask_update_action action)
+{
+	int val;
+	int rv;
+
+	if (!IS_ENABLED(CONFIG_USB_PD_TCPCI_SHADOW_REGS) ||
+	    shadow_index(reg) < 0)
+		return tcpc_update8(port, reg, mask, action);
+
+	rv = tcpci_shadow_read(port, reg, &val);
+	if (rv)
+		return rv;
+
+	if (action == MASK_SET)
+		val |= mask;
+	else
+		val &= ~mask;
+
+	return tcpci_shadow_write(port, reg, val);
+}
+
 static int init_alert_mask(int port)
 {
 	int rv;
@@ -383,10 +489,10 @@ void tcpci_tcpc_discharge_vbus(int port, int enable)
 		CPRINTS("C%d: ForceDischarge %sABLED",
 			port, enable ? "EN" : "DIS");
 
-	tcpc_update8(port,
-		     TCPC_REG_POWER_CTRL,
-		     TCPC_REG_POWER_CTRL_FORCE_DISCHARGE,
-		     (enable) ? MASK_SET : MASK_CLR);
+	tcpci_shadow_update8(port,
+			     TCPC_REG_POWER_CTRL,
+			     TCPC_REG_POWER_CTRL_FORCE_DISCHARGE,
+			     (enable) ? MASK_SET : MASK_CLR);
 }
 
 /*
@@ -400,10 +506,10 @@ void tcpci_tcpc_enable_auto_discharge_disconnect(int port, int enable)
 		CPRINTS("C%d: AutoDischargeDisconnect %sABLED",
 			port, enable ? "EN" : "DIS");
 
-	tcpc_update8(port,
-		     TCPC_REG_POWER_CTRL,
-		     TCPC_REG_POWER_CTRL_AUTO_DISCHARGE_DISCONNECT,
-		     (enable) ? MASK_SET : MASK_CLR);
+	tcpci_shadow_update8(port,
+			     TCPC_REG_POWER_CTRL,
+			     TCPC_REG_POWER_CTRL_AUTO_DISCHARGE_DISCONNECT,
+			     (enable) ? MASK_SET : MASK_CLR);
 }
 
 int tcpci_tcpc_debug_accessory(int port, bool enable)
@@ -426,7 +532,7 @@ int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
 	*cc2 = TYPEC_CC_VOLT_OPEN;
 
 	/* Get the ROLE CONTROL and CC STATUS values */
-	rv = tcpc_read(port, TCPC_REG_ROLE_CTRL, &role);
+	rv = tcpci_shadow_read(port, TCPC_REG_ROLE_CTRL, &role);
 	if (rv)
 		return rv;
 
@@ -499,7 +605,7 @@ int tcpci_tcpm_set_cc(int port, int pull)
 	if (IS_ENABLED(DEBUG_ROLE_CTRL_UPDATES))
 		CPRINTS("C%d: SET_CC pull=%d role=0x%X", port, pull, role);
 
-	return tcpc_write(port, TCPC_REG_ROLE_CTRL, role);
+	return tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL, role);
 }
 
 #ifdef CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE
@@ -511,7 +617,7 @@ int tcpci_set_role_ctrl(int port, int toggle, int rp, int pull)
 		CPRINTS("C%d: SET_ROLE_CTRL toggle=%d rp=%d pull=%d role=0x%X",
 			port, toggle, rp, pull, role);
 
-	return tcpc_write(port, TCPC_REG_ROLE_CTRL, role);
+	return tcpci_shadow_write(port, TCPC_REG_ROLE_CTRL, role);
 }
 
 int tcpci_tcpc_drp_toggle(int port)
@@ -540,10 +646,10 @@ int tcpci_tcpc_drp_toggle(int port)
 		return rv;
 
 	/* Set up to catch LOOK4CONNECTION alerts */
-	rv = tcpc_update8(port,
-			  TCPC_REG_TCPC_CTRL,
-			  TCPC_REG_TCPC_CTRL_EN_LOOK4CONNECTION_ALERT,
-			  MASK_SET);
+	rv = tcpci_shadow_update8(port,
+				  TCPC_REG_TCPC_CTRL,
+				  TCPC_REG_TCPC_CTRL_EN_LOOK4CONNECTION_ALERT,
+				  MASK_SET);
 	if (rv)
 		return rv;
 
@@ -564,11 +670,11 @@ int tcpci_enter_low_power_mode(int port)
 
 int tcpci_tcpm_set_polarity(int port, enum tcpc_cc_polarity polarity)
 {
-	return tcpc_update8(port,
-			    TCPC_REG_TCPC_CTRL,
-			    TCPC_REG_TCPC_CTRL_SET(1),
-			    polarity_rm_dts(polarity)
-					? MASK_SET : MASK_CLR);
+	return tcpci_shadow_update8(port,
+				    TCPC_REG_TCPC_CTRL,
+				    TCPC_REG_TCPC_CTRL_SET(1),
+				    polarity_rm_dts(polarity)
+						? MASK_SET : MASK_CLR);
 }
 
 #ifdef CONFIG_USBC_PPC
@@ -643,7 +749,7 @@ int tcpci_tcpm_set_vconn(int port, int enable)
 {
 	int reg, rv;
 
-	rv = tcpc_read(port, TCPC_REG_POWER_CTRL, &reg);
+	rv = tcpci_shadow_read(port, TCPC_REG_POWER_CTRL, &reg);
 	if (rv)
 		return rv;
 
@@ -655,7 +761,7 @@ int tcpci_tcpm_set_vconn(int port, int enable)
 
 	reg &= ~TCPC_REG_POWER_CTRL_VCONN(1);
 	reg |= TCPC_REG_POWER_CTRL_VCONN(enable);
-	return tcpc_write(port, TCPC_REG_POWER_CTRL, reg);
+	return tcpci_shadow_write(port, TCPC_REG_POWER_CTRL, reg);
 }
 
 int tcpci_tcpm_set_msg_header(int port, int power_role, int data_role)
@@ -713,10 +819,10 @@ int tcpci_tcpm_set_rx_enable(int port, int enable)
 #ifdef CONFIG_USB_PD_FRS_TCPC
 int tcpci_tcpc_fast_role_swap_enable(int port, int enable)
 {
-	return tcpc_update8(port,
-		     TCPC_REG_POWER_CTRL,
-		     TCPC_REG_POWER_CTRL_FRS_ENABLE,
-		     (enable) ? MASK_SET : MASK_CLR);
+	return tcpci_shadow_update8(port,
+				    TCPC_REG_POWER_CTRL,
+				    TCPC_REG_POWER_CTRL_FRS_ENABLE,
+				    (enable) ? MASK_SET : MASK_CLR);
 }
 #endif
 
@@ -737,8 +843,14 @@ struct cached_tcpm_message {
 	uint32_t payload[7];
 };
 
-static int tcpci_rev2_0_tcpm_get_message_raw(int port, uint32_t *payload,
-					     int *head)
+/*
+ * Reads the whole message in one I2C transaction. TCPCI Rev 2.0 requires it,
+ * and on TCPCI Rev 1.0 parts that auto-increment the register address the
+ * RX_BYTE_CNT, RX_BUF_FRAME_TYPE, RX_HDR and RX_DATA registers have the same
+ * layout starting at 0x30.
+ */
+static int tcpci_burst_tcpm_get_message_raw(int port, uint32_t *payload,
+					    int *head)
 {
 	int rv = 0, cnt, reg = TCPC_REG_RX_BUFFER;
 	int frm;
@@ -842,16 +954,18 @@ clear:
 
 int tcpci_tcpm_get_message_raw(int port, uint32_t *payload, int *head)
 {
-	if (tcpc_config[port].flags & TCPC_FLAGS_TCPCI_REV2_0)
-		return tcpci_rev2_0_tcpm_get_message_raw(port, payload, head);
+	if (tcpc_config[port].flags &
+	    (TCPC_FLAGS_TCPCI_REV2_0 | TCPC_FLAGS_TCPCI_RX_BURST))
+		return tcpci_burst_tcpm_get_message_raw(port, payload, head);
 
 	return tcpci_rev1_0_tcpm_get_message_raw(port, payload, head);
 }
 
 /* Cache depth needs to be power of 2 */
 /* TODO: Keep track of the high water mark */
-#define CACHE_DEPTH BIT(3)
+#define CACHE_DEPTH CONFIG_USB_PD_TCPC_RX_CACHE_DEPTH
 #define CACHE_DEPTH_MASK (CACHE_DEPTH - 1)
+BUILD_ASSERT(POWER_OF_TWO(CACHE_DEPTH));
 
 struct queue {
 	/*
@@ -864,6 +978,8 @@ struct queue {
 	 * consume. Must be masked before used in lookup.
 	 */
 	uint32_t tail;
+	/* Number of RX messages dropped because the cache was full */
+	uint32_t dropped;
 	struct cached_tcpm_message buffer[CACHE_DEPTH];
 };
 static struct queue cached_messages[CONFIG_USB_PD_PORT_MAX_COUNT];
@@ -877,7 +993,17 @@ int tcpm_enqueue_message(const int port)
 		&q->buffer[q->head & CACHE_DEPTH_MASK];
 
 	if (q->head - q->tail == CACHE_DEPTH) {
-		CPRINTS("C%d RX EC Buffer full!", port);
+		struct cached_tcpm_message discard;
+
+		/*
+		 * Still read the message out, so the TCPC clears its RX alert
+		 * and can receive the next one.
+		 */
+		tcpc_config[port].drv->get_message_raw(port, discard.payload,
+						       &discard.header);
+		q->dropped++;
+		CPRINTS("C%d RX EC Buffer full! (%d dropped)", port,
+			q->dropped);
 		return EC_ERROR_OVERFLOW;
 	}
 
@@ -1156,6 +1282,9 @@ void tcpci_tcpc_alert(int port)
 	if (alert & TCPC_REG_ALERT_FAULT) {
 		int fault;
 
+		/* The fault may have come with a reset of the TCPC registers */
+		tcpci_shadow_invalidate(port);
+
 		if (tcpci_get_fault(port, &fault) == EC_SUCCESS &&
 		    fault != 0 &&
 		    tcpci_handle_fault(port, fault) == EC_SUCCESS &&
@@ -1176,7 +1305,10 @@ void tcpci_tcpc_alert(int port)
 	/* Pull all RX messages from TCPC into EC memory */
 	failed_attempts = 0;
 	while (alert & TCPC_REG_ALERT_RX_STATUS) {
-		if (tcpm_enqueue_message(port))
+		int rv = tcpm_enqueue_message(port);
+
+		/* A full cache drops the message but still clears the alert */
+		if (rv && rv != EC_ERROR_OVERFLOW)
 			++failed_attempts;
 		if (tcpm_alert_status(port, &alert))
 			++failed_attempts;
@@ -1276,11 +1408,12 @@ void tcpci_tcpc_alert(int port)
  * Once it's called, the chip info will be stored in cache, which can be
  * accessed by tcpm_get_chip_info without worrying about chip states.
  */
+static struct ec_response_pd_chip_info_v1
+	cached_info[CONFIG_USB_PD_PORT_MAX_COUNT];
+
 int tcpci_get_chip_info(int port, int live,
 			struct ec_response_pd_chip_info_v1 *chip_info)
 {
-	static struct ec_response_pd_chip_info_v1
-		cached_info[CONFIG_USB_PD_PORT_MAX_COUNT];
 	struct ec_response_pd_chip_info_v1 *i;
 	int error;
 	int val;
@@ -1353,6 +1486,59 @@ int tcpci_tcpm_release(int port)
 	return EC_SUCCESS;
 }
 
+/*
+ * Chip info and shadowed registers of the previous image, so that the TCPCs
+ * initialized before a sysjump are not probed again.
+ */
+#define TCPCI_SYSJUMP_TAG 0x5443 /* "TC" */
+#define TCPCI_JUMP_STATE_VERSION 1
+
+/* Ports whose chip info and shadows come from the previous image */
+static uint32_t jump_state_ports;
+
+#ifdef CONFIG_SYSJUMP_STATE
+struct tcpci_jump_state {
+	struct ec_response_pd_chip_info_v1 info[CONFIG_USB_PD_PORT_MAX_COUNT];
+	struct tcpci_shadow shadow[CONFIG_USB_PD_PORT_MAX_COUNT];
+};
+BUILD_ASSERT(sizeof(struct tcpci_jump_state) < 255);
+
+static void tcpci_save_jump_state(void)
+{
+	struct tcpci_jump_state state;
+
+	memcpy(state.info, cached_info, sizeof(state.info));
+	if (IS_ENABLED(CONFIG_USB_PD_TCPCI_SHADOW_REGS))
+		memcpy(state.shadow, shadow, sizeof(state.shadow));
+	else
+		memset(state.shadow, 0, sizeof(state.shadow));
+
+	system_add_jump_state(TCPCI_SYSJUMP_TAG, TCPCI_JUMP_STATE_VERSION,
+			      sizeof(state), &state);
+}
+DECLARE_HOOK(HOOK_SYSJUMP, tcpci_save_jump_state, HOOK_PRIO_DEFAULT);
+
+static void tcpci_restore_jump_state(void)
+{
+	struct tcpci_jump_state state;
+	int port;
+
+	if (system_get_jump_state(TCPCI_SYSJUMP_TAG, TCPCI_JUMP_STATE_VERSION,
+				  sizeof(state), &state))
+		return;
+
+	memcpy(cached_info, state.info, sizeof(cached_info));
+	if (IS_ENABLED(CONFIG_USB_PD_TCPCI_SHADOW_REGS))
+		memcpy(shadow, state.shadow, sizeof(shadow));
+
+	/* Only the TCPCs the previous image did initialize */
+	for (port = 0; port < board_get_usb_pd_port_count(); port++)
+		if (cached_info[port].vendor_id)
+			jump_state_ports |= BIT(port);
+}
+DECLARE_HOOK(HOOK_INIT, tcpci_restore_jump_state, HOOK_PRIO_FIRST);
+#endif /* CONFIG_SYSJUMP_STATE */
+
 /*
  * On TCPC i2c failure, make 30 tries (at least 300ms) before giving up
  * in order to allow the TCPC time to boot / reset.
@@ -1365,10 +1551,15 @@ int tcpci_tcpm_init(int port)
 	int power_status;
 	int tries = TCPM_INIT_TRIES;
 	int tcpc_ctrl;
+	/* Chip info and shadows were preserved across a sysjump */
+	int preserved;
 
 	if (port >= board_get_usb_pd_port_count())
 		return EC_ERROR_INVAL;
 
+	preserved = jump_state_ports & BIT(port);
+	jump_state_ports &= ~BIT(port);
+
 	while (1) {
 		error = tcpci_tcpm_get_power_status(port, &power_status);
 		/*
@@ -1378,11 +1569,17 @@ int tcpci_tcpm_init(int port)
 		 */
 		if (!error && !(power_status & TCPC_REG_POWER_STATUS_UNINIT))
 			break;
+		/* Not the TCPC the previous image left behind */
+		preserved = 0;
 		if (--tries <= 0)
 			return error ? error : EC_ERROR_TIMEOUT;
 		msleep(10);
 	}
 
+	/* The TCPC may have been reset since the registers were shadowed */
+	if (!preserved)
+		tcpci_shadow_invalidate(port);
+
 	/*
 	 * Set TCPC_CONTROL.DebugAccessoryControl = 1 to control by TCPM,
 	 * not TCPC.
@@ -1398,7 +1595,8 @@ int tcpci_tcpm_init(int port)
 		tcpc_ctrl |= TCPC_REG_TCPC_CTRL_EN_LOOK4CONNECTION_ALERT;
 	}
 
-	error = tcpc_update8(port, TCPC_REG_TCPC_CTRL, tcpc_ctrl, MASK_SET);
+	error = tcpci_shadow_update8(port, TCPC_REG_TCPC_CTRL, tcpc_ctrl,
+				     MASK_SET);
 	if (error)
 		CPRINTS("C%d: Failed to init TCPC_CTRL!", port);
 
@@ -1443,7 +1641,8 @@ int tcpci_tcpm_init(int port)
 		return error;
 
 	/* Read chip info here when we know the chip is awake. */
-	tcpm_get_chip_info(port, 1, NULL);
+	if (!preserved)
+		tcpm_get_chip_info(port, 1, NULL);
 
 	return EC_SUCCESS;
 }
@@ -213,6 +213,18 @@ int tcpci_get_cached_rp(int port);
 void tcpci_set_cached_pull(int port, enum tcpc_cc_pull pull);
 enum tcpc_cc_pull tcpci_get_cached_pull(int port);
 
+/*
+ * Access TCPC_CONTROL, ROLE_CONTROL and POWER_CONTROL through the TCPM shadow
+ * when CONFIG_USB_PD_TCPCI_SHADOW_REGS is enabled; other registers, or all of
+ * them when it is disabled, go straight to the TCPC. TCPC drivers writing
+ * these registers must use these functions, or invalidate the shadow.
+ */
+int tcpci_shadow_read(int port, int reg, int *val);
+int tcpci_shadow_write(int port, int reg, int val);
+int tcpci_shadow_update8(int port, int reg, uint8_t mask,
+			 enum mask_update_action action);
+void tcpci_shadow_invalidate(int port);
+
 void tcpci_tcpc_alert(int port);
 int tcpci_tcpm_init(int port);
 int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
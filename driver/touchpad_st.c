@@ -1658,6 +1658,7 @@ USB_ISOCHRONOUS_CONFIG_FULL(usb_st_tp_heatmap_config,
 			    USB_EP_ST_TOUCHPAD,
 			    USB_ISO_PACKET_SIZE,
 			    st_tp_usb_tx_callback,
+			    NULL,
 			    st_tp_usb_set_interface,
 			    1 /* 1 extra EP for interrupts */)
 
@@ -30,6 +30,12 @@ static int enable_debug_prints;
 static uint8_t flags[CONFIG_USB_PD_PORT_MAX_COUNT];
 
 #define USB_MUX_FLAG_IN_LPM BIT(0) /* Device is in low power mode. */
+#define USB_MUX_FLAG_STATE_VALID BIT(1) /* mux_state_cache is up to date. */
+
+/* Last state successfully set on the whole chain of each port */
+static mux_state_t mux_state_cache[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+#define USB_MUX_HPD_STATE (USB_PD_MUX_HPD_LVL | USB_PD_MUX_HPD_IRQ)
 
 enum mux_config_type {
 	USB_MUX_INIT,
@@ -128,6 +134,17 @@ static int configure_mux(int port,
 		}
 	}
 
+	/*
+	 * Only a successful set leaves the chain in a known state; init, low
+	 * power and chipset reset may all reset the devices.
+	 */
+	if (config == USB_MUX_SET_MODE && rv == EC_SUCCESS) {
+		mux_state_cache[port] = *mux_state;
+		flags[port] |= USB_MUX_FLAG_STATE_VALID;
+	} else if (config != USB_MUX_GET_MODE) {
+		flags[port] &= ~USB_MUX_FLAG_STATE_VALID;
+	}
+
 	if (rv)
 		CPRINTS("mux config:%d, port:%d, rv:%d",
 			config, port, rv);
@@ -265,7 +282,9 @@ void usb_mux_flip(int port)
 
 	exit_low_power_mode(port);
 
-	if (configure_mux(port, USB_MUX_GET_MODE, &mux_state))
+	if (flags[port] & USB_MUX_FLAG_STATE_VALID)
+		mux_state = mux_state_cache[port];
+	else if (configure_mux(port, USB_MUX_GET_MODE, &mux_state))
 		return;
 
 	if (mux_state & USB_PD_MUX_POLARITY_INVERTED)
@@ -289,6 +308,20 @@ void usb_mux_hpd_update(int port, int hpd_lvl, int hpd_irq)
 		if (mux_ptr->hpd_update)
 			mux_ptr->hpd_update(mux_ptr, hpd_lvl, hpd_irq);
 
+	/*
+	 * Fast path: build the new state from the one last set instead of
+	 * reading it back from every mux, and leave the chain alone if only
+	 * the hpd_update() callbacks above needed the change.
+	 */
+	if (flags[port] & USB_MUX_FLAG_STATE_VALID) {
+		mux_state = (mux_state_cache[port] & ~USB_MUX_HPD_STATE) |
+			    (hpd_lvl ? USB_PD_MUX_HPD_LVL : 0) |
+			    (hpd_irq ? USB_PD_MUX_HPD_IRQ : 0);
+		if (mux_state != mux_state_cache[port])
+			configure_mux(port, USB_MUX_SET_MODE, &mux_state);
+		return;
+	}
+
 	if (!configure_mux(port, USB_MUX_GET_MODE, &mux_state)) {
 		mux_state |= (hpd_lvl ? USB_PD_MUX_HPD_LVL : 0) |
 			     (hpd_irq ? USB_PD_MUX_HPD_IRQ : 0);
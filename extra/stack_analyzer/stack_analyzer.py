@@ -18,8 +18,11 @@ from __future__ import print_function
 import argparse
 import collections
 import ctypes
+import hashlib
+import json
 import os
 import re
+import struct
 import subprocess
 import yaml
 
@@ -29,6 +32,11 @@ SECTION_RW = 'RW'
 # Default size of extra stack frame needed by exception context switch.
 # This value is for cortex-m with FPU enabled.
 DEFAULT_EXCEPTION_FRAME_SIZE = 224
+# Format version of the function cache file.
+FUNCTION_CACHE_VERSION = 1
+# Above this many changed ranges, one full disassembly is faster than running
+# objdump on each range.
+MAX_DISASSEMBLY_RANGES = 16
 
 
 class StackAnalyzerError(Exception):
@@ -551,6 +559,98 @@ class ArmAnalyzer(object):
     return (stack_frame, callsites)
 
 
+class ElfImage(object):
+  """Minimal ELF reader for the contents of the loadable sections.
+
+  Public Methods:
+    FunctionKey: Get the cache key of a function.
+  """
+
+  ELF_MAGIC = b'\x7fELF'
+  ELFCLASS64 = 2
+  ELFDATA2MSB = 2
+  SHT_NOBITS = 8
+  SHF_ALLOC = 0x2
+
+  def __init__(self, elf_path):
+    """Constructor.
+
+    Args:
+      elf_path: Path of the ELF file.
+
+    Raises:
+      StackAnalyzerError: If the ELF can't be read.
+    """
+    try:
+      with open(elf_path, 'rb') as elf_file:
+        self.data = elf_file.read()
+    except IOError:
+      raise StackAnalyzerError('Failed to read {}.'.format(elf_path))
+
+    if self.data[:4] != self.ELF_MAGIC:
+      raise StackAnalyzerError('{} is not an ELF file.'.format(elf_path))
+
+    endian = '>' if self.data[5] == self.ELFDATA2MSB else '<'
+    if self.data[4] == self.ELFCLASS64:
+      (shoff,) = struct.unpack_from(endian + 'Q', self.data, 0x28)
+      (shentsize, shnum) = struct.unpack_from(endian + 'HH', self.data, 0x3a)
+      section_format = endian + 'IIQQQQ'
+    else:
+      (shoff,) = struct.unpack_from(endian + 'I', self.data, 0x20)
+      (shentsize, shnum) = struct.unpack_from(endian + 'HH', self.data, 0x2e)
+      section_format = endian + 'IIIIII'
+
+    # List of (address, size, file offset) of the sections with contents.
+    self.sections = []
+    for index in range(shnum):
+      (_, shtype, flags, address, offset, size) = struct.unpack_from(
+          section_format, self.data, shoff + index * shentsize)
+      if shtype != self.SHT_NOBITS and flags & self.SHF_ALLOC and size > 0:
+        self.sections.append((address, size, offset))
+
+  def Read(self, address, size):
+    """Read the contents at the address range.
+
+    Args:
+      address: Start address.
+      size: Number of bytes.
+
+    Returns:
+      contents: Bytes. None if the range isn't in one section.
+    """
+    for section_address, section_size, offset in self.sections:
+      if (section_address <= address and
+          address + size <= section_address + section_size):
+        start = offset + address - section_address
+        return self.data[start:start + size]
+
+    return None
+
+  def FunctionKey(self, symbol):
+    """Get the cache key of a function.
+
+    The key changes whenever the name, the address, or the code of the
+    function change, so a cached analysis result is never stale.
+
+    Args:
+      symbol: Function symbol.
+
+    Returns:
+      key: Hex digest. None if the function can't be cached.
+    """
+    if symbol.size == 0:
+      return None
+
+    code = self.Read(symbol.address, symbol.size)
+    if code is None:
+      return None
+
+    digest = hashlib.sha1('{}:{:x}:{:x}:'.format(
+        symbol.name, symbol.address, symbol.size).encode('utf-8'))
+    digest.update(code)
+    return digest.hexdigest()
+
+
 class StackAnalyzer(object):
   """Class to analyze stack usage.
 
@@ -564,6 +664,8 @@ class StackAnalyzer(object):
   # Example: "driver/accel_kionix.c:321 (discriminator 3)"
   ADDRTOLINE_RE = re.compile(
       r'^(?P<path>[^:]+):(?P<linenum>\d+)(\s+\(discriminator\s+\d+\))?$')
+  # Example: "0x1008a6e8"
+  ADDRTOLINE_ADDRESS_RE = re.compile(r'^0x[0-9A-Fa-f]+$')
   # To eliminate the suffix appended by compilers, try to extract the
   # C function name from the prefix of symbol name.
   # Example: "SHA256_transform.constprop.28"
@@ -626,6 +728,19 @@ class StackAnalyzer(object):
       raise StackAnalyzerError('Failed to run addr2line.')
 
     lines = [line.strip() for line in line_text.splitlines()]
+    line_infos = self.ParseLineInfos(lines)
+    self.address_to_line_cache[cache_key] = line_infos
+    return line_infos
+
+  def ParseLineInfos(self, lines):
+    """Parse the lines of addr2line output for one address.
+
+    Args:
+      lines: Stripped lines of "function\nlocation\n" pairs.
+
+    Returns:
+      line_infos: List of the corresponding lines.
+    """
     # Assume the output has at least one pair like "function\nlocation\n", and
     # they always show up in pairs.
     # Example: "handle_request\n
@@ -645,9 +760,60 @@ class StackAnalyzer(object):
                            os.path.realpath(result.group('path').strip()),
                            int(result.group('linenum'))))
 
-    self.address_to_line_cache[cache_key] = line_infos
     return line_infos
 
+  def PreloadAddressToLine(self, addresses, resolve_inline=False):
+    """Convert many addresses to lines with a single addr2line run.
+
+    The results are stored in the cache used by AddressToLine, so the
+    later lookups of these addresses don't spawn addr2line again.
+
+    Args:
+      addresses: Iterable of target addresses.
+      resolve_inline: Output the stack of inlining.
+
+    Raises:
+      StackAnalyzerError: If addr2line is failed.
+    """
+    addresses = sorted(set(address for address in addresses
+                           if (address, resolve_inline)
+                           not in self.address_to_line_cache))
+    if len(addresses) == 0:
+      return
+
+    try:
+      # With "-a", each group of lines is headed by the queried address.
+      args = [self.options.addr2line,
+              '-a',
+              '-f',
+              '-e',
+              self.options.elf_path]
+      if resolve_inline:
+        args.append('-i')
+
+      line_text = subprocess.check_output(
+          args,
+          input=''.join('{:x}\n'.format(address) for address in addresses),
+          encoding='utf-8')
+    except subprocess.CalledProcessError:
+      raise StackAnalyzerError('addr2line failed to resolve lines.')
+    except OSError:
+      raise StackAnalyzerError('Failed to run addr2line.')
+
+    groups = []
+    for line in line_text.splitlines():
+      line = line.strip()
+      if self.ADDRTOLINE_ADDRESS_RE.match(line) is not None:
+        groups.append([])
+      elif len(groups) > 0:
+        groups[-1].append(line)
+
+    # Assume the output is always well-formed.
+    assert len(groups) == len(addresses)
+    for address, lines in zip(addresses, groups):
+      self.address_to_line_cache[(address, resolve_inline)] = (
+          self.ParseLineInfos(lines))
+
   def AnalyzeDisassembly(self, disasm_text):
     """Parse the disassembly text, analyze, and build a map of all functions.
 
@@ -692,12 +858,7 @@ class StackAnalyzer(object):
 
       return symbol
 
-    # Build symbol map, indexed by symbol address.
-    symbol_map = {}
-    for symbol in self.symbols:
-      # If there are multiple symbols with same address, keeping any of them is
-      # good enough.
-      symbol_map[symbol.address] = symbol
+    symbol_map = self.BuildSymbolMap()
 
     # Parse the disassembly text. We update the variable "line" to next line
     # when needed. There are two steps of parser:
@@ -775,13 +936,181 @@ class StackAnalyzer(object):
       # Move to the next line.
       line_index += 1
 
-    # Resolve callees of functions.
+    self.ResolveCallees(function_map)
+    return function_map
+
+  def BuildSymbolMap(self):
+    """Build symbol map, indexed by symbol address.
+
+    Returns:
+      symbol_map: Dict of symbols.
+    """
+    symbol_map = {}
+    for symbol in self.symbols:
+      # If there are multiple symbols with same address, keeping any of them is
+      # good enough.
+      symbol_map[symbol.address] = symbol
+
+    return symbol_map
+
+  def ResolveCallees(self, function_map):
+    """Resolve callees of functions.
+
+    Args:
+      function_map: Function map.
+    """
     for function in function_map.values():
       for callsite in function.callsites:
         if callsite.target is not None:
           # Remain the callee as None if we can't resolve it.
           callsite.callee = function_map.get(callsite.target)
 
+  def Disassemble(self, start=None, stop=None):
+    """Disassemble the ELF, or only the address range [start, stop).
+
+    Args:
+      start: Start address of the range.
+      stop: End address of the range.
+
+    Returns:
+      disasm_text: Disassembly text.
+
+    Raises:
+      StackAnalyzerError: If disassembly fails.
+    """
+    args = [self.options.objdump, '-d']
+    if start is not None:
+      args.extend(['--start-address=0x{:x}'.format(start),
+                   '--stop-address=0x{:x}'.format(stop)])
+    args.append(self.options.elf_path)
+
+    try:
+      return subprocess.check_output(args, encoding='utf-8')
+    except subprocess.CalledProcessError:
+      raise StackAnalyzerError('objdump failed to disassemble.')
+    except OSError:
+      raise StackAnalyzerError('Failed to run objdump.')
+
+  def LoadFunctionCache(self):
+    """Load the analyzed functions cached by the previous run.
+
+    Returns:
+      cache: Dict of cache entries, indexed by function key.
+    """
+    try:
+      with open(self.options.cache, 'r') as cache_file:
+        cache = json.load(cache_file)
+    except (IOError, ValueError):
+      return {}
+
+    if (not isinstance(cache, dict) or
+        cache.get('version') != FUNCTION_CACHE_VERSION):
+      return {}
+
+    return cache.get('functions', {})
+
+  def SaveFunctionCache(self, function_map, function_keys):
+    """Save the analyzed functions for the next run.
+
+    Only the results of the disassembly analysis are saved. Annotations are
+    applied again on every run.
+
+    Args:
+      function_map: Function map.
+      function_keys: Dict of function keys, indexed by function address.
+    """
+    functions = {}
+    for address, key in function_keys.items():
+      function = function_map.get(address)
+      if function is None:
+        continue
+
+      functions[key] = {
+          'stack_frame': function.stack_frame,
+          'callsites': [[callsite.address, callsite.target, callsite.is_tail]
+                        for callsite in function.callsites],
+      }
+
+    try:
+      with open(self.options.cache, 'w') as cache_file:
+        json.dump({'version': FUNCTION_CACHE_VERSION, 'functions': functions},
+                  cache_file)
+    except IOError:
+      print('Warning: Failed to write cache file {}.'
+            .format(self.options.cache))
+
+  def DisassembleFunctions(self):
+    """Disassemble and analyze all functions of the ELF.
+
+    With a cache file, only the functions whose code changed since the last
+    run are disassembled; the others are restored from the cache.
+
+    Returns:
+      function_map: Dict of functions.
+
+    Raises:
+      StackAnalyzerError: If disassembly fails.
+    """
+    if self.options.cache is None:
+      return self.AnalyzeDisassembly(self.Disassemble())
+
+    image = ElfImage(self.options.elf_path)
+    cache = self.LoadFunctionCache()
+
+    # Only the function symbols which are function heads in the disassembly
+    # and have a known size can be cached.
+    symbol_map = self.BuildSymbolMap()
+    function_symbols = sorted(
+        (symbol for symbol in symbol_map.values()
+         if symbol.symtype == 'F'),
+        key=lambda symbol: symbol.address)
+    function_keys = {}
+    for symbol in function_symbols:
+      key = image.FunctionKey(symbol)
+      if key is not None:
+        function_keys[symbol.address] = key
+
+    # Group the functions to disassemble into runs without cached functions
+    # in between, so each run is covered by one objdump call.
+    ranges = []
+    in_run = False
+    for symbol in function_symbols:
+      key = function_keys.get(symbol.address)
+      if key is not None and key in cache:
+        in_run = False
+        continue
+
+      end = symbol.address + max(symbol.size, 1)
+      if in_run:
+        ranges[-1][1] = max(ranges[-1][1], end)
+      else:
+        ranges.append([symbol.address, end])
+        in_run = True
+
+    function_map = {}
+    if len(ranges) > MAX_DISASSEMBLY_RANGES:
+      function_map = self.AnalyzeDisassembly(self.Disassemble())
+    else:
+      for start, stop in ranges:
+        function_map.update(self.AnalyzeDisassembly(
+            self.Disassemble(start, stop)))
+
+    for address, key in function_keys.items():
+      if address in function_map or key not in cache:
+        continue
+
+      entry = cache[key]
+      callsites = [Callsite(callsite_address, target, is_tail)
+                   for callsite_address, target, is_tail in entry['callsites']]
+      function_map[address] = Function(address,
+                                       symbol_map[address].name,
+                                       entry['stack_frame'],
+                                       callsites)
+
+    # Callees of the restored and the newly analyzed functions may be in the
+    # other group.
+    self.ResolveCallees(function_map)
+    self.SaveFunctionCache(function_map, function_keys)
     return function_map
 
   def MapAnnotation(self, function_map, signature_set):
@@ -1460,17 +1789,7 @@ class StackAnalyzer(object):
       return (order_key, output.rstrip('\n'))
 
     # Analyze disassembly.
-    try:
-      disasm_text = subprocess.check_output([self.options.objdump,
-                                             '-d',
-                                             self.options.elf_path],
-                                            encoding='utf-8')
-    except subprocess.CalledProcessError:
-      raise StackAnalyzerError('objdump failed to disassemble.')
-    except OSError:
-      raise StackAnalyzerError('Failed to run objdump.')
-
-    function_map = self.AnalyzeDisassembly(disasm_text)
+    function_map = self.DisassembleFunctions()
     result = self.ResolveAnnotation(function_map)
     (add_set, remove_list, eliminated_addrs, failed_sigtxts) = result
     remove_list = self.PreprocessAnnotation(function_map,
@@ -1479,6 +1798,34 @@ class StackAnalyzer(object):
                                             eliminated_addrs)
     cycle_functions = self.AnalyzeCallGraph(function_map, remove_list)
 
+    # Resolve all the addresses to output with two addr2line runs, instead of
+    # running addr2line for each address.
+    function_addrs = set()
+    callsite_addrs = set()
+    for task in self.tasklist:
+      max_stack_path = function_map[task.routine_address].stack_max_path
+      for depth, curr_func in enumerate(max_stack_path or []):
+        function_addrs.add(curr_func.address)
+        if depth + 1 < len(max_stack_path):
+          callsite_addrs.update(
+              callsite.address for callsite in curr_func.callsites
+              if callsite.callee is max_stack_path[depth + 1] and
+              callsite.address is not None)
+
+    for function in function_map.values():
+      callsite_addrs.update(callsite.address for callsite in function.callsites
+                            if callsite.target is None)
+
+    self.PreloadAddressToLine(function_addrs)
+    self.PreloadAddressToLine(callsite_addrs, True)
+
+    report = {
+        'tasks': [],
+        'unresolved_indirect_callsites': [],
+        'unresolved_annotations': [],
+        'cycles': [],
+    }
+
     # Print the results of task-aware stack analysis.
     extra_stack_frame = self.annotation.get('exception_frame_size',
                                             DEFAULT_EXCEPTION_FRAME_SIZE)
@@ -1491,6 +1838,18 @@ class StackAnalyzer(object):
           extra_stack_frame,
           task.stack_max_size))
 
+      call_trace = []
+      report['tasks'].append({
+          'name': task.name,
+          'max_size': routine_func.stack_max_usage + extra_stack_frame,
+          'max_usage': routine_func.stack_max_usage,
+          'exception_frame_size': extra_stack_frame,
+          'allocated_size': task.stack_max_size,
+          'overflow': (routine_func.stack_max_usage + extra_stack_frame >
+                       task.stack_max_size),
+          'call_trace': call_trace,
+      })
+
       print('Call Trace:')
       max_stack_path = routine_func.stack_max_path
       # Assume the routine function is resolved.
@@ -1502,6 +1861,13 @@ class StackAnalyzer(object):
         else:
           (_, path, linenum) = line_info
 
+        call_trace.append({
+            'function': curr_func.name,
+            'stack_frame': curr_func.stack_frame,
+            'address': curr_func.address,
+            'path': os.path.relpath(path),
+            'line': linenum,
+        })
         print('    {} ({}) [{}:{}] {:x}'.format(curr_func.name,
                                                 curr_func.stack_frame,
                                                 os.path.relpath(path),
@@ -1532,6 +1898,10 @@ class StackAnalyzer(object):
           indirect_callsites.append(callsite.address)
 
       if len(indirect_callsites) > 0:
+        report['unresolved_indirect_callsites'].append({
+            'function': function.name,
+            'addresses': sorted(indirect_callsites),
+        })
         print('    In function {}:'.format(function.name))
         text_list = []
         for address in indirect_callsites:
@@ -1542,13 +1912,26 @@ class StackAnalyzer(object):
 
     print('Unresolved annotation signatures:')
     for sigtxt, error in failed_sigtxts:
+      report['unresolved_annotations'].append({
+          'signature': sigtxt,
+          'error': error,
+      })
       print('    {}: {}'.format(sigtxt, error))
 
     if len(cycle_functions) > 0:
       print('There are cycles in the following function sets:')
       for functions in cycle_functions:
+        report['cycles'].append(sorted(function.name for function in functions))
         print('[{}]'.format(', '.join(function.name for function in functions)))
 
+    if self.options.report is not None:
+      try:
+        with open(self.options.report, 'w') as report_file:
+          json.dump(report, report_file, indent=2, sort_keys=True)
+      except IOError:
+        raise StackAnalyzerError('Failed to write report file {}.'
+                                 .format(self.options.report))
+
 
 def ParseArgs():
   """Parse commandline arguments.
@@ -1568,6 +1951,11 @@ def ParseArgs():
                       help='the path of addr2line')
   parser.add_argument('--annotation', default=None,
                       help='the path of annotation file')
+  parser.add_argument('--cache', default=None,
+                      help='the path of cache file of analyzed functions, '
+                           'only the changed functions are disassembled')
+  parser.add_argument('--report', default=None,
+                      help='the path to write a JSON report of the results')
 
   # TODO(cheyuw): Add an option for dumping stack usage of all functions.
 
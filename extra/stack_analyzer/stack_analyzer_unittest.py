@@ -7,9 +7,13 @@
 
 from __future__ import print_function
 
+import json
 import mock
 import os
+import shutil
+import struct
 import subprocess
+import tempfile
 import unittest
 
 import stack_analyzer as sa
@@ -163,7 +167,9 @@ class StackAnalyzerTest(unittest.TestCase):
                              section='RW',
                              objdump='objdump',
                              addr2line='addr2line',
-                             annotation=None)
+                             annotation=None,
+                             cache=None,
+                             report=None)
     self.analyzer = sa.StackAnalyzer(options, symbols, rodata, tasklist, {})
 
   def testParseSymbolText(self):
@@ -634,8 +640,180 @@ class StackAnalyzerTest(unittest.TestCase):
       self.analyzer.AddressToLine(0x9012)
 
   @mock.patch('subprocess.check_output')
+  def testPreloadAddressToLine(self, checkoutput_mock):
+    checkoutput_mock.return_value = ('0x00001234\nfake_func\n/a.c:1\n'
+                                     '0x00005678\n??\n??:0\n')
+    self.analyzer.PreloadAddressToLine([0x5678, 0x1234, 0x5678])
+    checkoutput_mock.assert_called_once_with(
+        ['addr2line', '-a', '-f', '-e', './ec.RW.elf'],
+        input='1234\n5678\n', encoding='utf-8')
+    checkoutput_mock.reset_mock()
+
+    self.assertEqual(self.analyzer.AddressToLine(0x1234),
+                     [('fake_func', '/a.c', 1)])
+    self.assertEqual(self.analyzer.AddressToLine(0x5678), [None])
+    checkoutput_mock.assert_not_called()
+
+    checkoutput_mock.return_value = ('0x00009abc\nfake_func\n/a.c:1\n'
+                                     'bake_func\n/b.c:2\n')
+    self.analyzer.PreloadAddressToLine([0x9abc], True)
+    checkoutput_mock.assert_called_once_with(
+        ['addr2line', '-a', '-f', '-e', './ec.RW.elf', '-i'],
+        input='9abc\n', encoding='utf-8')
+    self.assertEqual(self.analyzer.AddressToLine(0x9abc, True),
+                     [('fake_func', '/a.c', 1), ('bake_func', '/b.c', 2)])
+    checkoutput_mock.reset_mock()
+
+    # The addresses which are already cached aren't resolved again.
+    self.analyzer.PreloadAddressToLine([0x1234, 0x5678])
+    checkoutput_mock.assert_not_called()
+
+    with self.assertRaisesRegexp(sa.StackAnalyzerError,
+                                 'Failed to run addr2line.'):
+      checkoutput_mock.side_effect = OSError()
+      self.analyzer.PreloadAddressToLine([0x4321])
+
+  def testElfImage(self):
+    # 32-bit little-endian ELF with a null section, a .text section at 0x1000
+    # and a .bss section.
+    code = b'\x08\xb5\x70\x47\x08\xb5\x70\x47'
+    shoff = 0x34 + len(code)
+    header = (b'\x7fELF\x01\x01\x01' + b'\x00' * 9 +
+              struct.pack('<HHIIIIIHHHHHH', 2, 40, 1, 0, 0, shoff, 0,
+                          0x34, 0, 0, 40, 3, 0))
+    sections = (struct.pack('<10I', *([0] * 10)) +
+                struct.pack('<10I', 0, 1, 0x6, 0x1000, 0x34, len(code),
+                            0, 0, 2, 0) +
+                struct.pack('<10I', 0, 8, 0x3, 0x2000, shoff, 0x100,
+                            0, 0, 4, 0))
+    temp_dir = tempfile.mkdtemp()
+    try:
+      elf_path = os.path.join(temp_dir, 'ec.RW.elf')
+      with open(elf_path, 'wb') as elf_file:
+        elf_file.write(header + code + sections)
+
+      image = sa.ElfImage(elf_path)
+      self.assertEqual(image.Read(0x1002, 4), code[2:6])
+      self.assertIsNone(image.Read(0x1004, 8))
+      self.assertIsNone(image.Read(0x2000, 4))
+
+      key = image.FunctionKey(sa.Symbol(0x1000, 'F', 4, 'hook_task'))
+      self.assertEqual(image.FunctionKey(sa.Symbol(0x1000, 'F', 4,
+                                                   'hook_task')), key)
+      # Same code at another address or with another name gets another key.
+      self.assertNotEqual(image.FunctionKey(sa.Symbol(0x1004, 'F', 4,
+                                                      'hook_task')), key)
+      self.assertNotEqual(image.FunctionKey(sa.Symbol(0x1000, 'F', 4,
+                                                      'look_task')), key)
+      self.assertIsNone(image.FunctionKey(sa.Symbol(0x1000, 'F', 0,
+                                                    'hook_task')))
+      self.assertIsNone(image.FunctionKey(sa.Symbol(0x2000, 'F', 4,
+                                                    'bss_func')))
+
+      with open(elf_path, 'wb') as elf_file:
+        elf_file.write(b'not an elf')
+      with self.assertRaisesRegexp(sa.StackAnalyzerError,
+                                   'is not an ELF file.'):
+        sa.ElfImage(elf_path)
+    finally:
+      shutil.rmtree(temp_dir)
+
+  @mock.patch('subprocess.check_output')
+  @mock.patch('stack_analyzer.ElfImage')
+  def testDisassembleFunctionsCache(self, elfimage_mock, checkoutput_mock):
+    disasm_text = (
+        '\n'
+        'build/{BOARD}/RW/ec.RW.elf:     file format elf32-littlearm'
+        '\n'
+        'Disassembly of section .text:\n'
+        '\n'
+        '00001000 <hook_task>:\n'
+        '   1000:	b508\t\tpush	{r3, lr}\n'
+        '   1002:	f00e fcc5\tbl	4000 <touchpad_calc>\n'
+        '00002000 <console_task>:\n'
+        '   2000:	b508\t\tpush	{r3, lr}\n'
+        '   2002:	f00e fcc5\tbl	1000 <hook_task>\n'
+        '   2006:	1234 5678\tb.w  sl\n'
+        '00004000 <touchpad_calc>:\n'
+        '   4000:	4770\t\tbx	lr\n'
+    )
+    hook_text = (
+        '\n'
+        'build/{BOARD}/RW/ec.RW.elf:     file format elf32-littlearm'
+        '\n'
+        'Disassembly of section .text:\n'
+        '\n'
+        '00001000 <hook_task>:\n'
+        '   1000:	b500\t\tpush	{lr}\n'
+        '   1002:	f00e fcc5\tbl	4000 <touchpad_calc>\n'
+    )
+    keys = {}
+    elfimage_mock.return_value.FunctionKey.side_effect = (
+        lambda symbol: keys.get(symbol.address))
+    keys.update({0x1000: 'hook', 0x2000: 'console', 0x4000: 'touchpad'})
+
+    temp_dir = tempfile.mkdtemp()
+    try:
+      self.analyzer.options.cache = os.path.join(temp_dir, 'cache')
+
+      # Without a valid cache, all the functions are disassembled in one run.
+      checkoutput_mock.return_value = disasm_text
+      function_map = self.analyzer.DisassembleFunctions()
+      checkoutput_mock.assert_called_once_with(
+          ['objdump', '-d', '--start-address=0x1000',
+           '--stop-address=0x13300', './ec.RW.elf'], encoding='utf-8')
+      checkoutput_mock.reset_mock()
+
+      func_touchpad = sa.Function(0x4000, 'touchpad_calc', 0, [])
+      func_hook = sa.Function(0x1000, 'hook_task', 8, [
+          sa.Callsite(0x1002, 0x4000, False, func_touchpad)])
+      expect_funcmap = {
+          0x1000: func_hook,
+          0x2000: sa.Function(0x2000, 'console_task', 8, [
+              sa.Callsite(0x2002, 0x1000, False, func_hook),
+              sa.Callsite(0x2006, None, True, None)]),
+          0x4000: func_touchpad,
+      }
+      self.assertEqual(function_map, expect_funcmap)
+
+      # Only the functions without cache keys are disassembled again.
+      empty_text = disasm_text[:disasm_text.index('00001000')]
+      checkoutput_mock.return_value = empty_text
+      function_map = self.analyzer.DisassembleFunctions()
+      checkoutput_mock.assert_called_once_with(
+          ['objdump', '-d', '--start-address=0x5000',
+           '--stop-address=0x13300', './ec.RW.elf'], encoding='utf-8')
+      checkoutput_mock.reset_mock()
+      self.assertEqual(function_map, expect_funcmap)
+
+      # The changed function is analyzed again, and the callees of the
+      # restored functions are resolved to it.
+      keys[0x1000] = 'new_hook'
+      checkoutput_mock.side_effect = [hook_text, empty_text]
+      function_map = self.analyzer.DisassembleFunctions()
+      checkoutput_mock.assert_has_calls([
+          mock.call(['objdump', '-d', '--start-address=0x1000',
+                     '--stop-address=0x115c', './ec.RW.elf'],
+                    encoding='utf-8'),
+          mock.call(['objdump', '-d', '--start-address=0x5000',
+                     '--stop-address=0x13300', './ec.RW.elf'],
+                    encoding='utf-8'),
+      ])
+      self.assertEqual(function_map[0x1000].stack_frame, 4)
+      self.assertIs(function_map[0x2000].callsites[0].callee,
+                    function_map[0x1000])
+
+      with open(self.analyzer.options.cache, 'r') as cache_file:
+        cache = json.load(cache_file)
+      self.assertEqual(sorted(cache['functions']),
+                       ['console', 'new_hook', 'touchpad'])
+    finally:
+      shutil.rmtree(temp_dir)
+
+  @mock.patch('subprocess.check_output')
+  @mock.patch('stack_analyzer.StackAnalyzer.PreloadAddressToLine')
   @mock.patch('stack_analyzer.StackAnalyzer.AddressToLine')
-  def testAndesAnalyze(self, addrtoline_mock, checkoutput_mock):
+  def testAndesAnalyze(self, addrtoline_mock, preload_mock, checkoutput_mock):
     disasm_text = (
         '\n'
         'build/{BOARD}/RW/ec.RW.elf:     file format elf32-nds32le'
@@ -693,8 +871,9 @@ class StackAnalyzerTest(unittest.TestCase):
       self.analyzer.Analyze()
 
   @mock.patch('subprocess.check_output')
+  @mock.patch('stack_analyzer.StackAnalyzer.PreloadAddressToLine')
   @mock.patch('stack_analyzer.StackAnalyzer.AddressToLine')
-  def testArmAnalyze(self, addrtoline_mock, checkoutput_mock):
+  def testArmAnalyze(self, addrtoline_mock, preload_mock, checkoutput_mock):
     disasm_text = (
         '\n'
         'build/{BOARD}/RW/ec.RW.elf:     file format elf32-littlearm'
@@ -96,6 +96,7 @@ class Spower(object):
   CMD_START   = 0x0003
   CMD_NEXT    = 0x0004
   CMD_SETTIME = 0x0005
+  CMD_DECIMATE = 0x0006
 
   # Map between header channel number (0-47)
   # and INA I2C bus/addr on sweetberry.
@@ -224,6 +225,7 @@ class Spower(object):
     self._logger.debug("Writer endpoint: 0x%x", write_ep.bEndpointAddress)
 
     self.clear_ina_struct()
+    self._record_structs = {}
 
     self._logger.debug("Found power logging USB endpoint.")
 
@@ -257,6 +259,13 @@ class Spower(object):
     ina['uWscale'] = 25. * ina['uAscale'];
     ina['mVscale'] = 1.25
     ina['uVscale'] = 2.5
+    # Scale of the raw readings for this INA function.
+    ina['scale'] = {
+        Spower.INA_POWER: ina['uWscale'],
+        Spower.INA_BUSV: ina['mVscale'],
+        Spower.INA_CURRENT: ina['uAscale'],
+        Spower.INA_SHUNTV: ina['uVscale'],
+    }[ina_type]
     ina['data'] = data
     self._inas.append(ina)
 
@@ -422,6 +431,19 @@ class Spower(object):
     self._logger.debug("Command SETTIME: %s",
                        "success" if ret == 0 else "failure")
 
+  def set_decimate(self, factor):
+    """Average samples on the sweetberry before reporting them.
+
+    Args:
+      factor: int, samples averaged into each record, 1 for no averaging.
+    """
+    # 0x0006 , 2 byte factor
+    cmd = struct.pack("<HH", self.CMD_DECIMATE, factor)
+    ret = self.wr_command(cmd)
+
+    self._logger.debug("Command DECIMATE: %s",
+                       "success" if ret == 0 else "failure")
+
   def add_ina(self, bus, ina_type, addr, extra, resistance, data=None):
     """Add an INA to the data acquisition list.
 
@@ -462,6 +484,20 @@ class Spower(object):
 
     return datasize
 
+  def record_struct(self, ina_count):
+    """Helper function returning a struct.Struct to decode a full record.
+
+    The record is the status, size and timestamp header, one reading per INA
+    and the padding, so a whole record is decoded in a single call.
+    """
+    record = self._record_structs.get(ina_count)
+    if not record:
+      padding = (self.report_size(ina_count) - self.report_header_size() -
+                 2 * ina_count)
+      record = struct.Struct("<BBQ%dh%dx" % (ina_count, padding))
+      self._record_structs[ina_count] = record
+    return record
+
   def read_line(self):
     """Read a line of data from the setup INAs
 
@@ -488,6 +524,7 @@ class Spower(object):
           expected_bytes, len(bytesread))
 
     packet_count = len(bytesread) // expected_bytes
+    bytesread = bytes(bytearray(bytesread))
 
     values = []
     for i in range(0, packet_count):
@@ -510,39 +547,31 @@ class Spower(object):
     Returns:
       dict containing name, value of recorded data.
     """
-    status, size = struct.unpack("<BB", data[0:2])
+    status, size = struct.unpack_from("<BB", data)
     if len(data) != self.report_size(size):
       self._logger.error("READ LINE FAILED st:%d size:%d expected:%d len:%d",
                          status, size, self.report_size(size), len(data))
     else:
       pass
 
-    timestamp = struct.unpack("<Q", data[2:10])[0]
-    self._logger.debug("READ LINE: st:%d size:%d time:%dus", status, size,
-                       timestamp)
+    fields = self.record_struct(size).unpack_from(data)
+    timestamp = fields[2]
+    debug = self._logger.isEnabledFor(logging.DEBUG)
+    if debug:
+      self._logger.debug("READ LINE: st:%d size:%d time:%dus", status, size,
+                         timestamp)
     ftimestamp = float(timestamp) / 1000000.
 
     record = {"ts": ftimestamp, "status": status, "berry":self._board}
 
-    for i in range(0, size):
-      idx = self.report_header_size() + 2*i
-      name = self._inas[i]['name']
-      name_tuple = (self._inas[i]['name'], self._inas[i]['type'])
-
-      raw_val = struct.unpack("<h", data[idx:idx+2])[0]
+    for i, raw_val in enumerate(fields[3:]):
+      ina = self._inas[i]
+      val = raw_val * ina['scale']
 
-      if self._inas[i]['type'] == Spower.INA_POWER:
-        val = raw_val * self._inas[i]['uWscale']
-      elif self._inas[i]['type'] == Spower.INA_BUSV:
-        val = raw_val * self._inas[i]['mVscale']
-      elif self._inas[i]['type'] == Spower.INA_CURRENT:
-        val = raw_val * self._inas[i]['uAscale']
-      elif self._inas[i]['type'] == Spower.INA_SHUNTV:
-        val = raw_val * self._inas[i]['uVscale']
-
-      self._logger.debug("READ %d %s: %fs: 0x%04x %f", i, name, ftimestamp,
-                         raw_val, val)
-      record[name_tuple] = val
+      if debug:
+        self._logger.debug("READ %d %s: %fs: 0x%04x %f", i, ina['name'],
+                           ftimestamp, raw_val, val)
+      record[(ina['name'], ina['type'])] = val
 
     return record
 
@@ -569,13 +598,15 @@ class powerlog(object):
   Instance Variables:
     _data: a StatsManager object that records sweetberry readings and calculates
            statistics.
+    _window: a StatsManager object keeping running statistics of the readings
+             since the last periodic report, or None.
     _pwr[]: Spower objects for individual sweetberries.
   """
 
   def __init__(self, brdfile, cfgfile, serial_a=None, serial_b=None,
                sync_date=False, use_ms=False, use_mW=False, print_stats=False,
                stats_dir=None, stats_json_dir=None, print_raw_data=True,
-               raw_data_dir=None):
+               raw_data_dir=None, stream=False, stats_interval=0):
     """Init the powerlog class and set the variables.
 
     Args:
@@ -595,9 +626,22 @@ class powerlog(object):
                       is to print.
       raw_data_dir: directory to save sweetberry readings raw data; if None then
                     do not save the raw data.
+      stream: only keep running statistics of sweetberry readings rather than
+              every reading, so memory use stays flat on long captures;
+              incompatible with raw_data_dir.
+      stats_interval: print statistics for the sweetberry readings of the last
+                      |stats_interval| seconds every |stats_interval| seconds;
+                      if 0 then only print them at the end.
     """
     self._logger = logging.getLogger(__name__)
-    self._data = StatsManager()
+    if stream and raw_data_dir:
+      raise Exception("Power", "Raw data cannot be saved in stream mode")
+    self._data = StatsManager(keep_samples=not stream)
+    self._window = None
+    self._stats_interval = stats_interval
+    if stats_interval:
+      self._window = StatsManager(title='last %gs' % stats_interval,
+                                  keep_samples=False)
     self._pwr = {}
     self._use_ms = use_ms
     self._use_mW = use_mW
@@ -677,18 +721,21 @@ class powerlog(object):
       names.append((name, type))
     return names
 
-  def start(self, integration_us_request, seconds, sync_speed=.8):
+  def start(self, integration_us_request, seconds, sync_speed=.8, decimate=1):
     """Starts sampling.
 
     Args:
       integration_us_request: requested interval between sample values.
       seconds: time until exit, or None to run until cancel.
       sync_speed: A usb request is sent every [.8] * integration_us.
+      decimate: samples averaged by the sweetberry into each reported value.
     """
     # We will get back the actual integration us.
     # It should be the same for all devices.
     integration_us = None
     for key in self._pwr:
+      if decimate > 1:
+        self._pwr[key].set_decimate(decimate)
       integration_us_new = self._pwr[key].start(integration_us_request)
       if integration_us:
         if integration_us != integration_us_new:
@@ -697,6 +744,9 @@ class powerlog(object):
               integration_us, integration_us_new))
       integration_us = integration_us_new
 
+    # Each record covers [decimate] samples.
+    integration_us *= decimate
+
     # CSV header
     title = "ts:%dus" % integration_us
     for name_tuple in self._names:
@@ -714,6 +764,8 @@ class powerlog(object):
       title += ", %s %s" % (name, unit)
       name_type = name + Spower.INA_SUFFIX[ina_type]
       self._data.SetUnit(name_type, unit)
+      if self._window:
+        self._window.SetUnit(name_type, unit)
     title += ", status"
     if self._print_raw_data:
       logoutput(title)
@@ -722,6 +774,7 @@ class powerlog(object):
     if not seconds:
       forever = True
     end_time = time.time() + seconds
+    next_stats_time = time.time() + self._stats_interval
     try:
       pending_records = []
       while forever or end_time > time.time():
@@ -758,6 +811,8 @@ class powerlog(object):
                 csv += ", %.2f" % value
                 name_type = name[0] + Spower.INA_SUFFIX[name[1]]
                 self._data.AddSample(name_type, value)
+                if self._window:
+                  self._window.AddSample(name_type, value)
               else:
                 csv += ", "
             csv += ", %d" % aggregate_record["status"]
@@ -768,6 +823,12 @@ class powerlog(object):
             for r in range(0, len(self._pwr)):
               pending_records.pop(0)
 
+        if self._window and time.time() >= next_stats_time:
+          self._window.CalculateStats()
+          logoutput(self._window.SummaryToString())
+          self._window.ClearSamples()
+          next_stats_time += self._stats_interval
+
     except KeyboardInterrupt:
       self._logger.info('\nCTRL+C caught.')
 
@@ -805,6 +866,9 @@ def main(argv=None):
       help="Serial number of sweetberry B", default="")
   parser.add_argument('-t', '--integration_us', type=int,
       help="Target integration time for samples", default=100000)
+  parser.add_argument('--decimate', type=int, default=1,
+      help="Average this many samples on the sweetberry per reported value, "
+           "for long captures at short integration times")
   parser.add_argument('-s', '--seconds', type=float,
       help="Seconds to run capture", default=0.)
   parser.add_argument('--date', default=False,
@@ -846,10 +910,20 @@ def main(argv=None):
            "not exist; if %(metavar)s is not specified but the flag is set, "
            "raw data will be saved to where %(prog)s is located; if this flag "
            "is not set, then do not save raw data")
+  parser.add_argument('--stream', default=False, action="store_true",
+      help="Only keep running statistics rather than every reading, so long "
+           "captures run in constant memory; incompatible with "
+           "--save_raw_data")
+  parser.add_argument('--stats_interval', type=float, default=0.,
+      metavar='SECONDS',
+      help="Print statistics of the readings of the last %(metavar)s seconds "
+           "every %(metavar)s seconds")
   parser.add_argument('-v', '--verbose', default=False,
       help="Very chatty printout", action="store_true")
 
   args = parser.parse_args(argv)
+  if args.stream and args.raw_data_dir:
+    parser.error("--stream and --save_raw_data are incompatible")
 
   root_logger = logging.getLogger(__name__)
   if args.verbose:
@@ -894,10 +968,12 @@ def main(argv=None):
       sync_date=sync_date, use_ms=use_ms, use_mW=use_mW,
       print_stats=print_stats, stats_dir=stats_dir,
       stats_json_dir=stats_json_dir,
-      print_raw_data=print_raw_data,raw_data_dir=raw_data_dir)
+      print_raw_data=print_raw_data,raw_data_dir=raw_data_dir,
+      stream=args.stream, stats_interval=args.stats_interval)
 
   # Start logging.
-  powerlogger.start(integration_us_request, seconds, sync_speed=sync_speed)
+  powerlogger.start(integration_us_request, seconds, sync_speed=sync_speed,
+                    decimate=args.decimate)
 
 
 if __name__ == "__main__":
@@ -35,6 +35,59 @@ class StatsManagerError(Exception):
   pass
 
 
+class RunningStats(object):
+  """Online count, mean, min, max and stddev of a stream of samples.
+
+  Uses Welford's algorithm, so the statistics match the numpy ones computed
+  over all the samples: NaN samples are counted but otherwise ignored, and
+  the stddev is the population one.
+
+  Attributes:
+    count: number of samples, including NaN ones
+    n: number of samples that are not NaN
+    mean: mean of the samples that are not NaN
+    m2: sum of the squared differences from the mean
+    min: smallest sample
+    max: largest sample
+  """
+
+  def __init__(self):
+    self.count = 0
+    self.n = 0
+    self.mean = 0.0
+    self.m2 = 0.0
+    self.min = float('NaN')
+    self.max = float('NaN')
+
+  def Add(self, sample):
+    """Add one sample, expect type float."""
+    self.count += 1
+    if math.isnan(sample):
+      return
+    self.n += 1
+    delta = sample - self.mean
+    self.mean += delta / self.n
+    self.m2 += delta * (sample - self.mean)
+    if self.n == 1 or sample < self.min:
+      self.min = sample
+    if self.n == 1 or sample > self.max:
+      self.max = sample
+
+  def Summary(self):
+    """Return the stats in the StatsManager summary format."""
+    if not self.n:
+      nan = float('NaN')
+      return {'mean': nan, 'min': nan, 'max': nan, 'stddev': nan,
+              'count': self.count}
+    return {
+        'mean': self.mean,
+        'min': self.min,
+        'max': self.max,
+        'stddev': math.sqrt(self.m2 / self.n),
+        'count': self.count,
+    }
+
+
 class StatsManager(object):
   """Calculates statistics for several lists of data(float).
 
@@ -74,6 +127,11 @@ class StatsManager(object):
     _hide_domains: collection of domains to hide when formatting summary string
     _accept_nan: flag to indicate if NaN samples are acceptable
     _nan_domains: set to keep track of which domains contain NaN samples
+    _keep_samples: flag to indicate if raw samples are kept; if not, only
+                   running statistics are kept for each domain, so memory use
+                   does not grow with the number of samples
+    _running: dict of RunningStats for each domain(key), used when
+              |_keep_samples| is false
     _summary: dict of stats per domain (key): min, max, count, mean, stddev
     _logger = StatsManager logger
 
@@ -84,10 +142,12 @@ class StatsManager(object):
 
   # pylint: disable=W0102
   def __init__(self, smid='', title='', order=[], hide_domains=[],
-               accept_nan=True):
+               accept_nan=True, keep_samples=True):
     """Initialize infrastructure for data and their statistics."""
     self._title = title
     self._data = collections.defaultdict(list)
+    self._keep_samples = keep_samples
+    self._running = collections.defaultdict(RunningStats)
     self._unit = collections.defaultdict(str)
     self._smid = smid
     self._order = order
@@ -116,7 +176,10 @@ class StatsManager(object):
       sample = float('NaN')
     if not self._accept_nan and math.isnan(sample):
       raise StatsManagerError('accept_nan is false. Cannot add NaN sample.')
-    self._data[domain].append(sample)
+    if self._keep_samples:
+      self._data[domain].append(sample)
+    else:
+      self._running[domain].Add(sample)
     if math.isnan(sample):
       self._nan_domains.add(domain)
 
@@ -141,6 +204,10 @@ class StatsManager(object):
     First erases all previous stats, then calculate stats for all data.
     """
     self._summary = {}
+    if not self._keep_samples:
+      for domain, running in self._running.items():
+        self._summary[domain] = running.Summary()
+      return
     for domain, data in self._data.items():
       data_np = numpy.array(data)
       self._summary[domain] = {
@@ -151,6 +218,15 @@ class StatsManager(object):
           'count': data_np.size,
       }
 
+  def ClearSamples(self):
+    """Drop all samples and running statistics, keeping the units.
+
+    This lets one StatsManager report consecutive windows of a capture.
+    """
+    self._data.clear()
+    self._running.clear()
+    self._nan_domains.clear()
+
   def SummaryToString(self, prefix=STATS_PREFIX):
     """Format summary into a string, ready for pretty print.
 
@@ -297,7 +373,13 @@ class StatsManager(object):
     return fname
 
   def GetRawData(self):
-    """Getter for all raw_data."""
+    """Getter for all raw_data.
+
+    Raises:
+      StatsManagerError: if raw samples are not kept
+    """
+    if not self._keep_samples:
+      raise StatsManagerError('keep_samples is false. No raw data kept.')
     return self._data
 
   def SaveRawData(self, directory, dirname='raw_data'):
@@ -309,7 +391,12 @@ class StatsManager(object):
 
     Returns:
       list of full path of each domain's raw data save location
+
+    Raises:
+      StatsManagerError: if raw samples are not kept
     """
+    if not self._keep_samples:
+      raise StatsManagerError('keep_samples is false. No raw data kept.')
     if not os.path.exists(directory):
       os.makedirs(directory)
     dirname = os.path.join(directory, dirname)
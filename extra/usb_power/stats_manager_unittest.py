@@ -307,5 +307,42 @@ class TestStatsManager(unittest.TestCase):
       # if no unit is specified, JSON should save 'N/A' as the unit.
       self.assertEqual('N/A', summary['B']['unit'])
 
+  def test_StreamingSummaryMatchesRawData(self):
+    """Running stats without raw samples match the stats of the raw data."""
+    streaming = stats_manager.StatsManager(keep_samples=False)
+    for sample in (99999.5, 100000.5, 'fiesta', 100003.0):
+      self.data.AddSample('A', sample)
+      streaming.AddSample('A', sample)
+    self.data.CalculateStats()
+    streaming.CalculateStats()
+    expected = self.data.GetSummary()['A']
+    summary = streaming.GetSummary()['A']
+    self.assertEqual(expected['count'], summary['count'])
+    for stat in ('mean', 'min', 'max', 'stddev'):
+      self.assertAlmostEqual(expected[stat], summary[stat])
+
+  def test_StreamingNoRawData(self):
+    """Raw data cannot be retrieved or saved without raw samples."""
+    self.data = stats_manager.StatsManager(keep_samples=False)
+    self._populate_mock_stats()
+    self.assertAlmostEqual(2.5, self.data.GetSummary()['B']['mean'])
+    with self.assertRaises(stats_manager.StatsManagerError):
+      self.data.GetRawData()
+    with self.assertRaises(stats_manager.StatsManagerError):
+      self.data.SaveRawData(self.tempdir)
+
+  def test_ClearSamples(self):
+    """ClearSamples starts a new window, keeping the units."""
+    self.data = stats_manager.StatsManager(keep_samples=False)
+    self._populate_mock_stats()
+    self.data.ClearSamples()
+    self.data.AddSample('B', 10.0)
+    self.data.CalculateStats()
+    summary = self.data.GetSummary()
+    self.assertNotIn('A', summary)
+    self.assertEqual(1, summary['B']['count'])
+    self.assertAlmostEqual(10.0, summary['B']['mean'])
+    self.assertIn('B_mV', self.data.SummaryToString())
+
 if __name__ == '__main__':
   unittest.main()
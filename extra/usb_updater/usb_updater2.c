@@ -9,6 +9,7 @@
 #include <fcntl.h>
 #include <getopt.h>
 #include <libusb.h>
+#include <openssl/sha.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -72,8 +73,9 @@ static struct first_response_pdu targ;
 
 static uint16_t protocol_version;
 static uint16_t header_type;
+static int partial_update;
 static char *progname;
-static char *short_opts = "bd:efg:hjlnp:rsS:tuw";
+static char *short_opts = "bd:efg:hjlnp:PrsS:tuw";
 static const struct option long_opts[] = {
 	/* name    hasarg *flag val */
 	{"binvers",	1,   NULL, 'b'},
@@ -86,6 +88,7 @@ static const struct option long_opts[] = {
 	{"follow_log",	0,   NULL, 'l'},
 	{"no_reset",	0,   NULL, 'n'},
 	{"tp_update",	1,   NULL, 'p'},
+	{"partial",	0,   NULL, 'P'},
 	{"reboot",	0,   NULL, 'r'},
 	{"stay_in_ro",	0,   NULL, 's'},
 	{"serial",	1,   NULL, 'S'},
@@ -122,6 +125,10 @@ static void usage(int errs)
 	       "  -j,--jump_to_rw          Tell EC to jump to RW\n"
 	       "  -l,--follow_log          Get console log\n"
 	       "  -p,--tp_update file      Update touchpad FW\n"
+	       "  -P,--partial             Only send the flash blocks that "
+				"changed, or\n"
+	       "                           with -p, skip an up to date "
+				"touchpad\n"
 	       "  -r,--reboot              Tell EC to reboot\n"
 	       "  -s,--stay_in_ro          Tell EC to stay in RO\n"
 	       "  -S,--serial              Device serial number\n"
@@ -591,6 +598,136 @@ static void transfer_section(struct transfer_descriptor *td,
 	}
 }
 
+/* Blocks transfer_section_pipelined() sends ahead of their replies. */
+#define PIPELINE_DEPTH 4
+
+struct pipelined_block {
+	struct update_frame_header ufh;
+	struct libusb_transfer *xfer[2];  /* Header and payload */
+	int completed;
+	int failed;
+};
+
+static void LIBUSB_CALL pipelined_block_done(struct libusb_transfer *xfer)
+{
+	struct pipelined_block *block = xfer->user_data;
+
+	block->completed++;
+	if (xfer->status != LIBUSB_TRANSFER_COMPLETED ||
+	    xfer->actual_length != xfer->length)
+		block->failed = 1;
+}
+
+static void submit_or_die(struct usb_endpoint *uep,
+			  struct pipelined_block *block, int i,
+			  void *data, int len)
+{
+	int r;
+
+	block->xfer[i] = libusb_alloc_transfer(0);
+	if (!block->xfer[i]) {
+		fprintf(stderr, "Failed to allocate transfer\n");
+		shut_down(uep);
+	}
+
+	libusb_fill_bulk_transfer(block->xfer[i], uep->devh, uep->ep_num,
+				  data, len, pipelined_block_done, block,
+				  5000);
+	r = libusb_submit_transfer(block->xfer[i]);
+	if (r) {
+		USB_ERROR("libusb_submit_transfer", r);
+		shut_down(uep);
+	}
+}
+
+/**
+ * Transfer an image section, keeping up to PIPELINE_DEPTH blocks queued.
+ *
+ * The target processes one block at a time, and NAKs the next one until it
+ * is done.  Queueing the next blocks lets them follow without waiting for
+ * the host to see each reply.  Replies come back in order, possibly several
+ * in one packet.
+ *
+ * td           - transfer descriptor to use to communicate with the target
+ * data_ptr     - pointer at the section base in the image
+ * section_addr - address of the section in the target memory space
+ * data_len     - section size
+ */
+static void transfer_section_pipelined(struct transfer_descriptor *td,
+				       uint8_t *data_ptr,
+				       uint32_t section_addr,
+				       size_t data_len)
+{
+	struct pipelined_block blocks[PIPELINE_DEPTH];
+	struct pipelined_block *block;
+	uint8_t replies[td->uep.chunk_len];
+	int replies_len = 0, replies_pos = 0;
+	int submitted = 0, acked = 0;
+	size_t sent = 0;
+	int actual;
+	int r;
+
+	memset(blocks, 0, sizeof(blocks));
+
+	printf("sending 0x%zx bytes to %#x\n", data_len, section_addr);
+	while (acked < submitted || sent < data_len) {
+		if (sent < data_len && submitted - acked < PIPELINE_DEPTH) {
+			size_t payload_size = MIN(data_len - sent,
+					targ.common.maximum_pdu_size);
+
+			block = &blocks[submitted % PIPELINE_DEPTH];
+			block->ufh.block_size = htobe32(payload_size +
+					sizeof(struct update_frame_header));
+			block->ufh.cmd.block_base = htobe32(section_addr + sent);
+			block->ufh.cmd.block_digest = 0;
+			submit_or_die(&td->uep, block, 0, &block->ufh,
+				      sizeof(block->ufh));
+			submit_or_die(&td->uep, block, 1, data_ptr + sent,
+				      payload_size);
+
+			sent += payload_size;
+			submitted++;
+			continue;
+		}
+
+		/* Wait for the reply to the oldest block. */
+		if (replies_pos == replies_len) {
+			r = libusb_bulk_transfer(td->uep.devh,
+						 td->uep.ep_num | 0x80,
+						 replies, sizeof(replies),
+						 &actual, 5000);
+			if (r) {
+				USB_ERROR("libusb_bulk_transfer", r);
+				shut_down(&td->uep);
+			}
+			replies_len = actual;
+			replies_pos = 0;
+			continue;
+		}
+
+		if (replies[replies_pos]) {
+			fprintf(stderr, "Error: status %#x\n",
+				replies[replies_pos]);
+			exit(update_error);
+		}
+		replies_pos++;
+
+		/* A reply means the whole block went out. */
+		block = &blocks[acked % PIPELINE_DEPTH];
+		while (block->completed < 2)
+			libusb_handle_events(NULL);
+		if (block->failed) {
+			fprintf(stderr, "Failed to transfer block at %#x\n",
+				be32toh(block->ufh.cmd.block_base));
+			exit(update_error);
+		}
+		libusb_free_transfer(block->xfer[0]);
+		libusb_free_transfer(block->xfer[1]);
+		memset(block, 0, sizeof(*block));
+		acked++;
+	}
+}
+
 /*
  * Each RO or RW section of the new image can be in one of the following
  * states.
@@ -906,19 +1043,228 @@ static void send_subcommand(struct transfer_descriptor *td, uint16_t subcommand,
 	printf("sent command %x, resp %x\n", subcommand, response[0]);
 }
 
+/*
+ * Get the SHA-256 of a region of the section being updated. The target must
+ * be between update sessions.
+ *
+ * Returns the flash erase block size of the target, or 0 if it could not
+ * hash the region.
+ */
+static uint32_t get_region_hash(struct transfer_descriptor *td,
+				uint32_t offset, uint32_t size,
+				uint8_t *digest)
+{
+	struct update_hash_region region;
+	struct update_hash_region_response r;
+	size_t response_size = sizeof(r);
+
+	region.offset = htobe32(offset);
+	region.size = htobe32(size);
+	memset(&r, 0, sizeof(r));
+	ext_cmd_over_usb(&td->uep, UPDATE_EXTRA_CMD_HASH_REGION,
+			 &region, sizeof(region),
+			 &r, &response_size, 1);
+
+	/* Targets without partial update support reply with one byte. */
+	if (r.status)
+		return 0;
+
+	memcpy(digest, r.digest, sizeof(r.digest));
+	return be32toh(r.erase_size);
+}
+
+/*
+ * Transfer only the erase blocks of an image section that differ from what
+ * the target holds, then check the whole section.
+ *
+ * Returns 0 with the target between update sessions, or -1 with a new
+ * update session started if the target doesn't support partial updates.
+ */
+static int transfer_section_partial(struct transfer_descriptor *td,
+				    uint8_t *data_ptr,
+				    uint32_t section_addr,
+				    size_t data_len)
+{
+	uint8_t digest[SHA256_DIGEST_LENGTH];
+	uint8_t expected[SHA256_DIGEST_LENGTH];
+	uint32_t erase_size;
+	uint8_t *dirty;
+	uint8_t response;
+	size_t response_size = 1;
+	size_t blocks, sent = 0;
+	size_t i, j;
+
+	/* The target only takes extra commands between sessions. */
+	send_done(&td->uep);
+
+	erase_size = get_region_hash(td, section_addr, 0, digest);
+	if (!erase_size || data_len % erase_size) {
+		printf("partial update not supported, sending all\n");
+		setup_connection(td);
+		return -1;
+	}
+
+	blocks = data_len / erase_size;
+	dirty = malloc(blocks);
+	if (!dirty) {
+		perror("malloc");
+		exit(update_error);
+	}
+
+	for (i = 0; i < blocks; i++) {
+		if (!get_region_hash(td, section_addr + i * erase_size,
+				     erase_size, digest)) {
+			fprintf(stderr, "Failed to hash block at %#zx\n",
+				section_addr + i * erase_size);
+			exit(update_error);
+		}
+		SHA256(data_ptr + i * erase_size, erase_size, expected);
+		dirty[i] = memcmp(digest, expected, sizeof(digest)) != 0;
+	}
+
+	ext_cmd_over_usb(&td->uep, UPDATE_EXTRA_CMD_PARTIAL_UPDATE,
+			 NULL, 0, &response, &response_size, 0);
+	if (response) {
+		fprintf(stderr, "Partial update refused: %#x\n", response);
+		exit(update_error);
+	}
+
+	/* Send each run of changed blocks. */
+	setup_connection(td);
+	for (i = 0; i < blocks; i = j) {
+		for (j = i; j < blocks && dirty[j]; j++)
+			;
+		if (j == i) {
+			j++;
+			continue;
+		}
+		transfer_section_pipelined(td, data_ptr + i * erase_size,
+					   section_addr + i * erase_size,
+					   (j - i) * erase_size);
+		sent += (j - i) * erase_size;
+	}
+	free(dirty);
+	send_done(&td->uep);
+
+	printf("sent 0x%zx of 0x%zx bytes\n", sent, data_len);
+
+	if (!get_region_hash(td, section_addr, data_len, digest)) {
+		fprintf(stderr, "Failed to hash section at %#x\n",
+			section_addr);
+		exit(update_error);
+	}
+	SHA256(data_ptr, data_len, expected);
+	if (memcmp(digest, expected, sizeof(digest))) {
+		fprintf(stderr, "Section at %#x doesn't match the image\n",
+			section_addr);
+		exit(update_error);
+	}
+
+	return 0;
+}
+
+/* Elan touchpad FW word holding the start of its payload, in words. */
+#define ELAN_IAP_START_ADDR 0x0083
+
+/*
+ * Return the checksum an Elan touchpad reports for a FW image: the sum of
+ * the 16-bit words of its payload.
+ */
+static uint16_t elan_fw_checksum(const uint8_t *data, size_t data_len)
+{
+	uint16_t checksum = 0;
+	size_t i;
+
+	if (data_len < ELAN_IAP_START_ADDR * 2 + 2)
+		return 0;
+
+	i = ((data[ELAN_IAP_START_ADDR * 2 + 1] << 8) |
+	     data[ELAN_IAP_START_ADDR * 2]) * 2;
+	for (; i + 1 < data_len; i += 2)
+		checksum += (data[i + 1] << 8) | data[i];
+
+	return checksum;
+}
+
+/*
+ * Update the touchpad FW only if it isn't already running this image, with
+ * the blocks after the first one pipelined.
+ *
+ * The image is first checked against the hash the EC accepts, since the EC
+ * refuses every block of any other image.
+ *
+ * Returns 0 with the target between update sessions, or -1 with a new
+ * update session started if the target doesn't report touchpad information.
+ */
+static int transfer_touchpad_partial(struct transfer_descriptor *td,
+				     uint8_t *data, size_t data_len)
+{
+	struct touchpad_info info;
+	uint8_t digest[SHA256_DIGEST_LENGTH];
+	size_t response_size = sizeof(info);
+	size_t first;
+
+	/* The target only takes extra commands between sessions. */
+	send_done(&td->uep);
+
+	memset(&info, 0, sizeof(info));
+	ext_cmd_over_usb(&td->uep, UPDATE_EXTRA_CMD_TOUCHPAD_INFO, NULL, 0,
+			 &info, &response_size, 1);
+	if (response_size != sizeof(info) || info.status || !info.fw_size) {
+		printf("touchpad information not available, sending all\n");
+		setup_connection(td);
+		return -1;
+	}
+
+	SHA256(data, data_len, digest);
+	if (data_len != info.fw_size ||
+	    memcmp(digest, info.allowed_fw_hash, sizeof(digest))) {
+		fprintf(stderr, "Touchpad FW is not the one this EC accepts\n");
+		exit(update_error);
+	}
+
+	if (info.vendor == 0x04f3 && /* ELAN */
+	    info.elan.fw_checksum == elan_fw_checksum(data, data_len)) {
+		printf("touchpad FW is up to date\n");
+		return 0;
+	}
+
+	/*
+	 * The first block makes the touchpad enter its update mode, which
+	 * takes too long to have other blocks queued behind it.
+	 */
+	setup_connection(td);
+	first = MIN(data_len, targ.common.maximum_pdu_size);
+	transfer_section(td, data, info.fw_address, first, 0);
+	transfer_section_pipelined(td, data + first, info.fw_address + first,
+				   data_len - first);
+	send_done(&td->uep);
+
+	return 0;
+}
+
 /* Returns number of successfully transmitted image sections. */
 static int transfer_image(struct transfer_descriptor *td,
 			       uint8_t *data, size_t data_len)
 {
 	size_t i;
 	int num_txed_sections = 0;
+	int idle = 0;
 
 	for (i = 0; i < ARRAY_SIZE(sections); i++)
 		if (sections[i].ustatus == needed) {
-			transfer_section(td,
-					 data + sections[i].offset,
-					 sections[i].offset,
-					 sections[i].size, 1);
+			idle = 0;
+			if (partial_update &&
+			    !transfer_section_partial(td,
+						      data + sections[i].offset,
+						      sections[i].offset,
+						      sections[i].size))
+				idle = 1;
+			else
+				transfer_section(td,
+						 data + sections[i].offset,
+						 sections[i].offset,
+						 sections[i].size, 1);
 			num_txed_sections++;
 		}
 
@@ -926,7 +1272,8 @@ static int transfer_image(struct transfer_descriptor *td,
 	 * Move USB receiver sate machine to idle state so that vendor
 	 * commands can be processed later, if any.
 	 */
-	send_done(&td->uep);
+	if (!idle)
+		send_done(&td->uep);
 
 	if (!num_txed_sections)
 		printf("nothing to do\n");
@@ -1115,6 +1462,9 @@ int main(int argc, char *argv[])
 			printf("read %zd(%#zx) bytes from %s\n",
 				data_len, data_len, argv[optind]);
 
+			break;
+		case 'P':
+			partial_update = 1;
 			break;
 		case 'r':
 			extra_command = UPDATE_EXTRA_CMD_IMMEDIATE_RESET;
@@ -1190,13 +1540,15 @@ int main(int argc, char *argv[])
 
 	if (data) {
 		if (touchpad_update) {
-			transfer_section(&td,
-					data,
-					0x80000000,
-					data_len, 0);
+			if (!partial_update ||
+			    transfer_touchpad_partial(&td, data, data_len)) {
+				transfer_section(&td,
+						data,
+						0x80000000,
+						data_len, 0);
+				send_done(&td.uep);
+			}
 			free(data);
-
-			send_done(&td.uep);
 		} else {
 			transferred_sections = transfer_image(&td,
 							data, data_len);
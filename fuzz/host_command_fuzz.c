@@ -128,8 +128,15 @@ static int hostcmd_fill(const uint8_t *data, size_t size)
 	return 0;
 }
 
-static pthread_cond_t done_cond;
-static pthread_mutex_t lock;
+/*
+ * Handshake between the fuzzer thread and the test runner task: the fuzzer
+ * thread clears done and wakes up the runner, which sets it back once the
+ * input has been processed. The flag makes sure a completion signalled
+ * before the fuzzer thread starts waiting is not lost.
+ */
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int done;
 
 void run_test(int argc, char **argv)
 {
@@ -141,7 +148,10 @@ void run_test(int argc, char **argv)
 		/* Send the host command (pkt prepared by main thread). */
 		host_packet_receive(&pkt);
 		task_wait_event_mask(TASK_EVENT_HOSTCMD_DONE, -1);
+		pthread_mutex_lock(&lock);
+		done = 1;
 		pthread_cond_signal(&done_cond);
+		pthread_mutex_unlock(&lock);
 	}
 }
 
@@ -151,8 +161,12 @@ int test_fuzz_one_input(const uint8_t *data, unsigned int size)
 	if (hostcmd_fill(data, size) < 0)
 		return 0;
 
+	pthread_mutex_lock(&lock);
+	done = 0;
 	task_set_event(TASK_ID_TEST_RUNNER, TASK_EVENT_FUZZ, 0);
-	pthread_cond_wait(&done_cond, &lock);
+	while (!done)
+		pthread_cond_wait(&done_cond, &lock);
+	pthread_mutex_unlock(&lock);
 
 #ifdef VALID_REQUEST_ONLY
 	/*
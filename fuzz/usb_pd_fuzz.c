@@ -154,8 +154,10 @@ const struct tcpc_config_t tcpc_config[CONFIG_USB_PD_PORT_MAX_COUNT] = {
 	}
 };
 
-static pthread_cond_t done_cond;
-static pthread_mutex_t lock;
+/* Set by the runner, under lock, once an input has been processed. */
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int done;
 
 enum tcpc_cc_voltage_status next_cc1, next_cc2;
 const int MAX_MESSAGES = 8;
@@ -194,7 +196,10 @@ void run_test(int argc, char **argv)
 			task_wait_event(50 * MSEC);
 		}
 
+		pthread_mutex_lock(&lock);
+		done = 1;
 		pthread_cond_signal(&done_cond);
+		pthread_mutex_unlock(&lock);
 	}
 }
 
@@ -234,8 +239,12 @@ int test_fuzz_one_input(const uint8_t *data, unsigned int size)
 		return 0;
 	}
 
+	pthread_mutex_lock(&lock);
+	done = 0;
 	task_set_event(TASK_ID_TEST_RUNNER, TASK_EVENT_FUZZ, 0);
-	pthread_cond_wait(&done_cond, &lock);
+	while (!done)
+		pthread_cond_wait(&done_cond, &lock);
+	pthread_mutex_unlock(&lock);
 
 	return 0;
 }
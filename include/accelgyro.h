@@ -165,6 +165,16 @@ struct accelgyro_drv {
 	 */
 	int (*get_rms_noise)(const struct motion_sensor_t *s);
 #endif
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+	/**
+	 * Arm or disarm the tilt detection engine of the sensor.
+	 * While armed, the sensor keeps sampling even when its data rate is 0
+	 * and irq_handler calls motion_lid_wake() when a tilt is detected.
+	 * @s Pointer to sensor data.
+	 * @enable 1 to arm, 0 to disarm.
+	 */
+	int (*set_tilt_detection)(const struct motion_sensor_t *s, int enable);
+#endif
 };
 
 /* Index values for rgb_calibration_t.coeff array */
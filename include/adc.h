@@ -27,6 +27,27 @@
  */
 int adc_read_channel(enum adc_channel ch);
 
+/**
+ * Read an ADC channel, unless its last value is recent enough.
+ *
+ * Without CONFIG_ADC_CACHE this is adc_read_channel().  Calibration and other
+ * code needing a fresh conversion should keep calling adc_read_channel().
+ *
+ * @param ch		Channel to read
+ * @param max_age_us	Age in us of the oldest value acceptable
+ *
+ * @return The scaled ADC value, or ADC_READ_ERROR if error.
+ */
+#ifdef CONFIG_ADC_CACHE
+int adc_read_channel_cached(enum adc_channel ch, uint32_t max_age_us);
+#else
+static inline int adc_read_channel_cached(enum adc_channel ch,
+					  uint32_t max_age_us)
+{
+	return adc_read_channel(ch);
+}
+#endif
+
 /**
  * Enable ADC watchdog. Note that interrupts might come in repeatedly very
  * quickly when ADC output goes out of the accepted range.
@@ -7,6 +7,7 @@
 #define __CROS_EC_ALS_H
 
 #include "common.h"
+#include "gpio.h"
 
 /* Priority for ALS HOOK int */
 #define HOOK_PRIO_ALS_INIT (HOOK_PRIO_DEFAULT + 1)
@@ -20,6 +21,11 @@ struct als_t {
 	int (*init)(void);
 	int (*read)(int *lux, int af);
 	int attenuation_factor;
+	/*
+	 * Optional: interrupt when the light level falls below low or rises
+	 * above high, in lux. Used with CONFIG_ALS_INTERRUPT.
+	 */
+	int (*set_threshold)(int low, int high, int af);
 };
 
 extern struct als_t als[];
@@ -34,4 +40,11 @@ extern struct als_t als[];
  */
 int als_read(enum als_id id, int *lux);
 
+/**
+ * Interrupt handler for the ALS threshold interrupts.
+ *
+ * @param signal	GPIO signal of the interrupt.
+ */
+void als_interrupt(enum gpio_signal signal);
+
 #endif  /* __CROS_EC_ALS_H */
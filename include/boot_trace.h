@@ -0,0 +1,48 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Boot time trace for Chrome EC */
+
+#ifndef __CROS_EC_BOOT_TRACE_H
+#define __CROS_EC_BOOT_TRACE_H
+
+#include "common.h"
+#include "ec_commands.h"
+
+/*
+ * The trace has a single writer at a time: main() until task_start(), then
+ * the HOOK task running HOOK_INIT, then the chipset task.  Entries are only
+ * recorded once the timer is initialized, and until the first S0.
+ */
+#ifdef CONFIG_BOOT_TRACE
+/**
+ * Record a boot phase.
+ *
+ * @param event		enum ec_boot_trace_event
+ * @param data		Event specific data
+ */
+void boot_trace(enum ec_boot_trace_event event, uint32_t data);
+
+/**
+ * Call a HOOK_INIT routine, recording its run time.
+ *
+ * Routines taking longer than CONFIG_BOOT_TRACE_HOOK_BUDGET_US are flagged
+ * in the trace and printed on the console.
+ *
+ * @param routine	HOOK_INIT routine
+ */
+void boot_trace_call_hook(void (*routine)(void));
+#else
+static inline void boot_trace(enum ec_boot_trace_event event, uint32_t data)
+{
+}
+
+static inline void boot_trace_call_hook(void (*routine)(void))
+{
+	routine();
+}
+#endif
+
+#endif /* __CROS_EC_BOOT_TRACE_H */
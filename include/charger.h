@@ -9,6 +9,7 @@
 #define __CROS_EC_CHARGER_H
 
 #include "common.h"
+#include "i2c.h"
 #include "ocpc.h"
 
 /* Charger information
@@ -295,5 +296,54 @@ enum ec_error_list charger_set_vsys_compensation(int chgnum,
  */
 void print_charger_debug(int chgnum);
 
+/*
+ * Register shadow for charger drivers.  A driver routes the accesses to its
+ * plain control registers (charge current, voltage, input current limit,
+ * options...) through these, for the 16-bit register at offset on the I2C
+ * address of chip chgnum.  Reads are answered from the cache, and writes of
+ * the value the register already holds are skipped.
+ *
+ * Registers the charger changes by itself (status, ADC results, self-clearing
+ * bits) must not go through the cache.
+ */
+#ifdef CONFIG_CHARGER_REG_CACHE
+enum ec_error_list charger_cached_read16(int chgnum, int offset, int *value);
+enum ec_error_list charger_cached_write16(int chgnum, int offset, int value);
+enum ec_error_list charger_cached_update16(int chgnum, int offset,
+					   uint16_t mask,
+					   enum mask_update_action action);
+
+/**
+ * Forget the cached registers of a charger, e.g. after resetting it.
+ *
+ * @param chgnum: charger IC index.
+ */
+void charger_cache_invalidate(int chgnum);
+#else
+static inline enum ec_error_list charger_cached_read16(int chgnum, int offset,
+						       int *value)
+{
+	return i2c_read16(chg_chips[chgnum].i2c_port,
+			  chg_chips[chgnum].i2c_addr_flags, offset, value);
+}
+
+static inline enum ec_error_list charger_cached_write16(int chgnum,
+							int offset, int value)
+{
+	return i2c_write16(chg_chips[chgnum].i2c_port,
+			   chg_chips[chgnum].i2c_addr_flags, offset, value);
+}
+
+static inline enum ec_error_list charger_cached_update16(
+	int chgnum, int offset, uint16_t mask, enum mask_update_action action)
+{
+	return i2c_update16(chg_chips[chgnum].i2c_port,
+			    chg_chips[chgnum].i2c_addr_flags,
+			    offset, mask, action);
+}
+
+static inline void charger_cache_invalidate(int chgnum) {}
+#endif
+
 #endif /* __CROS_EC_CHARGER_H */
 
@@ -36,6 +36,25 @@ int clock_get_freq(void);
  */
 void clock_enable_module(enum module_id module, int enable);
 
+/**
+ * Ask for the fast CPU clock on behalf of a module, or release it.
+ *
+ * With CONFIG_CPU_GOVERNOR, the fast clock is kept while any module asks for
+ * it or while the CPU is busy, and dropped by the governor once neither
+ * holds.  Otherwise this switches MODULE_FAST_CPU right away.
+ *
+ * @param module	The module asking for the fast clock.
+ * @param enable	Ask for the fast clock if non-zero; release if zero.
+ */
+#ifdef CONFIG_CPU_GOVERNOR
+void clock_request_fast_cpu(enum module_id module, int enable);
+#else
+static inline void clock_request_fast_cpu(enum module_id module, int enable)
+{
+	clock_enable_module(MODULE_FAST_CPU, enable);
+}
+#endif
+
 /**
  * Enable or disable the PLL.
  *
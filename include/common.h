@@ -217,6 +217,16 @@
 /* Include top-level configuration file */
 #include "config.h"
 
+/*
+ * Place a function in RAM when CONFIG_HOT_CODE_IN_RAM is defined, so it runs
+ * without flash wait states. Only for hot paths: RAM is scarce.
+ */
+#ifdef CONFIG_HOT_CODE_IN_RAM
+#define __hot_code __attribute__((section(".iram.text.hot")))
+#else
+#define __hot_code
+#endif
+
 /* Canonical list of module IDs */
 #include "module_id.h"
 
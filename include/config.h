@@ -53,6 +53,27 @@
 /* The amount of free entries that trigger an interrupt to the AP. */
 #undef CONFIG_ACCEL_FIFO_THRES
 
+/*
+ * Size in bytes of the buffer sensor drivers (BMI160/BMI260, LSM6DSM and
+ * ICM426xx) drain their hardware FIFO into. When defined, the whole FIFO is
+ * read in a single bus transaction, up to that size, and parsed afterwards,
+ * instead of in small chunks with one transaction each. Each driver gets its
+ * own static buffer of that size. On I2C, sizes above
+ * CONFIG_I2C_CHIP_MAX_READ_SIZE need CONFIG_I2C_XFER_LARGE_READ.
+ * Useful at high ODR with several sensors, when bus time is the bottleneck.
+ */
+#undef CONFIG_ACCEL_FIFO_BURST_SIZE
+
+/*
+ * Timestamp FIFO samples with the time the sensor recorded in its hardware
+ * FIFO, mapped to the EC clock with a model that tracks the drift of the
+ * sensor oscillator (see include/sensor_clock.h), instead of spreading them
+ * between interrupts. Only used by drivers that support it (ICM426xx, when
+ * the accelerometer and gyroscope run together). Requires
+ * CONFIG_SENSOR_TIGHT_TIMESTAMPS.
+ */
+#undef CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
+
 /*
  * Sensors in this mask are in forced mode: they needed to be polled
  * at their data rate frequency.
@@ -200,6 +221,19 @@
 /* The threshold duration to change to off_body */
 #undef CONFIG_BODY_DETECTION_STATIONARY_DURATION
 
+/*
+ * Estimate the acceleration variance with exponentially weighted moving
+ * averages instead of a window of CONFIG_BODY_DETECTION_MAX_WINDOW_SIZE
+ * samples: no history is kept and each sample only costs shifts.
+ */
+#undef CONFIG_BODY_DETECTION_EW_VARIANCE
+
+/*
+ * Run body detection in the hook task: the motion sense task only queues the
+ * samples of the body detection sensor.
+ */
+#undef CONFIG_BODY_DETECTION_DEFERRED
+
 /*
  * Use the old standard reference frame for accelerometers. The old
  * reference frame is:
@@ -284,6 +318,12 @@
 /* Include the ADC analog watchdog feature in the ADC code */
 #define CONFIG_ADC_WATCHDOG
 
+/*
+ * Keep the last value of each ADC channel, refreshed every HOOK_TICK, so that
+ * adc_read_channel_cached() callers don't wait for a conversion.
+ */
+#undef CONFIG_ADC_CACHE
+
 /*
  * Chip-dependent ADC configuration - select one.
  * SINGLE - Sample all inputs once when requested.
@@ -364,6 +404,16 @@
  */
 #undef CONFIG_ALS_TCS3400_EMULATED_IRQ_EVENT
 
+/*
+ * Let the ALS task sleep until a light level changes: after each read, the
+ * sensors supporting it are armed to interrupt when the light level leaves a
+ * band of +/- CONFIG_ALS_HYSTERESIS percent around the value read.  The board
+ * must route the sensor interrupts to als_interrupt().  Sensors without
+ * threshold support are still polled.
+ */
+#undef CONFIG_ALS_INTERRUPT
+#define CONFIG_ALS_HYSTERESIS 10
+
 /* Define which ALS sensor is used for dimming the lightbar when dark */
 #undef CONFIG_ALS_LIGHTBAR_DIMMING
 
@@ -513,6 +563,15 @@
  */
 #undef CONFIG_BATTERY_SMART
 
+/*
+ * If defined, the smart battery battery_get_params() reads the temperature,
+ * the desired charging voltage and current and the full charge capacity only
+ * every CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL microseconds, or when the
+ * battery status changes, raises an alarm or a read fails. The other
+ * parameters are read on every call.
+ */
+#undef CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL
+
 /* Chemistry of the battery device */
 #undef CONFIG_BATTERY_DEVICE_CHEMISTRY
 
@@ -640,6 +699,14 @@
  */
 #undef CONFIG_CHARGE_STATE_DEBUG
 
+/*
+ * If defined, the charger task doubles its default poll period, up to this
+ * many microseconds, on each pass where the AC, the charge state, the charge
+ * request and the input current limit are all unchanged. Any change polls at
+ * the default period again.
+ */
+#undef CONFIG_CHARGE_STATE_ADAPTIVE_POLL_MAX
+
 /* Include support for Bluetooth LE */
 #undef CONFIG_BLUETOOTH_LE
 
@@ -661,6 +728,18 @@
 /* Size of boot header in storage. */
 #undef CONFIG_BOOT_HEADER_STORAGE_SIZE
 
+/*
+ * Record the time of the init phases, of each HOOK_INIT callback and of the
+ * chipset transitions up to the first S0, for EC_CMD_BOOT_TRACE.
+ */
+#undef CONFIG_BOOT_TRACE
+
+/* Boot trace entries, 16 bytes each */
+#define CONFIG_BOOT_TRACE_ENTRIES 96
+
+/* HOOK_INIT callbacks taking longer than this are flagged in the trace */
+#define CONFIG_BOOT_TRACE_HOOK_BUDGET_US 2000
+
 /*****************************************************************************/
 /* Bootblock config */
 
@@ -816,6 +895,12 @@
 /* Allow charge manager to default to charging from dual-role partners */
 #undef CONFIG_CHARGE_MANAGER_DRP_CHARGING
 
+/*
+ * Debounce the charge manager refresh after charge and dual-role changes by
+ * this many ms, so that a burst of supplier updates results in one refresh.
+ */
+#undef CONFIG_CHARGE_MANAGER_DEBOUNCE_MS
+
 /* Handle the external power limit host command in charge manager */
 #undef CONFIG_CHARGE_MANAGER_EXTERNAL_POWER_LIMIT
 
@@ -831,6 +916,15 @@
 /* Compile input current ramping support using software control */
 #undef CONFIG_CHARGE_RAMP_SW
 
+/*
+ * If defined, the software ramp doubles its step, up to this many mA, for as
+ * long as VBUS holds instead of always stepping by 64 mA. Once VBUS dips, it
+ * bisects between the last good and the first low limit. Steps wider than
+ * the window between the VBUS dip and the overcurrent protection of a
+ * supplier may brown it out, which the overcurrent detection then handles.
+ */
+#undef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+
 /*****************************************************************************/
 /* Charger config */
 
@@ -1048,6 +1142,15 @@
  */
 #define CONFIG_CHARGER_PROFILE_VOLTAGE_RANGES 2
 
+/*
+ * Shadow the charger control registers which the driver accesses through
+ * charger_cached_read16() and friends, so the charge loop setting the same
+ * current, voltage and options every iteration costs no I2C traffic.  Up to
+ * CONFIG_CHARGER_REG_CACHE_SIZE registers are cached, over all the chargers.
+ */
+#undef CONFIG_CHARGER_REG_CACHE
+#define CONFIG_CHARGER_REG_CACHE_SIZE 8
+
 /* Value of the charge sense resistor, in mOhms */
 #undef CONFIG_CHARGER_SENSE_RESISTOR
 
@@ -1083,6 +1186,13 @@
  */
 #undef CONFIG_OCPC_DEF_RBATT_MOHMS
 
+/*
+ * If defined, the OCPC loop leaves VSYS alone while in constant current and
+ * the battery current is within this many mA of its target, and does not
+ * rewrite an unchanged VSYS target to the secondary charger.
+ */
+#undef CONFIG_OCPC_DEADBAND_MA
+
 /* Enable trickle charging */
 #undef CONFIG_TRICKLE_CHARGING
 
@@ -1151,6 +1261,15 @@
  */
 #undef CONFIG_CHIP_DATA_IN_INIT_ROM
 
+/*
+ * Run the functions marked __hot_code (context switch, timer processing,
+ * queue copies, CRC32) from RAM, so they don't stall on flash wait states.
+ * They are copied to RAM along with .data and take up that much of it.
+ *
+ * Only useful on Cortex-M chips which execute in place from internal flash.
+ */
+#undef CONFIG_HOT_CODE_IN_RAM
+
 /*****************************************************************************/
 /* Chipset config */
 
@@ -1448,6 +1567,12 @@
  */
 #undef CONFIG_GPIO_POWER_DOWN
 
+/*
+ * Count the interrupts of each GPIO_INT, to find interrupt storms with the
+ * gpioints console command.  Costs 4 bytes of RAM per interrupt GPIO.
+ */
+#undef CONFIG_GPIO_IRQ_COUNTERS
+
 /*
  * Provide common runtime layer code (tasks, hooks ...)
  * You want this unless you are doing a really tiny firmware.
@@ -1457,6 +1582,14 @@
 /* Provide common core code to handle the operating system timers. */
 #define CONFIG_COMMON_TIMER
 
+/*
+ * Maximum time, in microseconds, that the common timer code may postpone a
+ * timer expiry so that it is serviced by the same hardware timer interrupt as
+ * a later deadline. Larger values mean fewer wakeups from low-power idle at the
+ * cost of timer precision. 0 fires every timer at its exact deadline.
+ */
+#define CONFIG_TIMER_SLACK_US 0
+
 /*****************************************************************************/
 
 /*
@@ -1501,6 +1634,15 @@
  */
 #define CONFIG_CONSOLE_ENABLE_READ_V1
 
+/*
+ * Enable EC_CMD_CONSOLE_READ V2, which reads the console output from a
+ * cursor kept by the host, so several readers can each stream it.
+ */
+#undef CONFIG_CONSOLE_ENABLE_READ_V2
+
+/* Support LZ4 compressed EC_CMD_CONSOLE_READ V2 responses. */
+#undef CONFIG_CONSOLE_READ_LZ4
+
 /*
  * Number of entries in console history buffer.
  *
@@ -1511,6 +1653,14 @@
 /* Max length of a single line of input */
 #define CONFIG_CONSOLE_INPUT_LINE_SIZE 80
 
+/*
+ * Send cprints() and cprintf() output on the UART as token records (see
+ * vfntokenize()) instead of formatting it on the EC.  The host console
+ * (util/ec3po, with --elf) decodes them with the format strings from the EC
+ * image.  Output to the console command channel stays plain text.
+ */
+#undef CONFIG_CONSOLE_TOKENIZED
+
 /* Enable verbose output to UART console and extra timestamp print precision. */
 #define CONFIG_CONSOLE_VERBOSE
 
@@ -1537,6 +1687,20 @@
  */
 #undef CONFIG_EXPERIMENTAL_CONSOLE
 
+/*
+ * Let a governor own the fast CPU clock (clock_enable_module(MODULE_FAST_CPU)).
+ * It switches up as soon as a module asks for it with
+ * clock_request_fast_cpu(), e.g. the host command task for each command, or
+ * when the CPU was busy for more than CONFIG_CPU_GOVERNOR_UP_PCT of the last
+ * HOOK_TICK.  It switches back down in the first tick with no request and a
+ * utilization below CONFIG_CPU_GOVERNOR_DOWN_PCT.  The utilization needs
+ * CONFIG_TASK_PROFILING; drivers follow the chip's HOOK_PRE_FREQ_CHANGE and
+ * HOOK_FREQ_CHANGE notifications.
+ */
+#undef CONFIG_CPU_GOVERNOR
+#define CONFIG_CPU_GOVERNOR_UP_PCT 70
+#define CONFIG_CPU_GOVERNOR_DOWN_PCT 30
+
 /* Include CRC-8 utility function */
 #undef CONFIG_CRC8
 
@@ -1710,6 +1874,22 @@
  */
 #undef CONFIG_FAN_UPDATE_PERIOD
 
+/*
+ * Don't apply the fan speeds requested by the thermal task at once.  Instead,
+ * a HOOK_TICK loop moves each RPM target towards the request, at most
+ * CONFIG_FAN_SLEW_RISE_RPM faster or CONFIG_FAN_SLEW_FALL_RPM slower per
+ * second, and leaves it alone when within CONFIG_FAN_SLEW_DEADBAND_RPM.  A
+ * rising request is extrapolated by CONFIG_FAN_SLEW_LEAD_PCT percent of its
+ * last step, so the fan gets ahead of a heating load.  Starting and stopping
+ * the fan are not limited.  The host can retune each fan with
+ * EC_CMD_FAN_TUNING.
+ */
+#undef CONFIG_FAN_SLEW_CONTROL
+#define CONFIG_FAN_SLEW_RISE_RPM 1500
+#define CONFIG_FAN_SLEW_FALL_RPM 300
+#define CONFIG_FAN_SLEW_DEADBAND_RPM 100
+#define CONFIG_FAN_SLEW_LEAD_PCT 50
+
 /*****************************************************************************/
 /* Flash configuration */
 
@@ -1780,6 +1960,13 @@
  */
 #define CONFIG_FLASH_PSTATE_BANK
 
+/*
+ * Append each update of the pstate bank as a new record, instead of erasing
+ * the bank and rewriting it, and only erase the bank once it is full.  RO
+ * and RW read the same bank, so both must be built with this.
+ */
+#undef CONFIG_FLASH_PSTATE_LOG
+
 /*
  * Lock the PSTATE by default (currently only supported when
  * CONFIG_FLASH_PSTATE_BANK is not defined).
@@ -1838,6 +2025,13 @@
 #undef CONFIG_FP_SENSOR_FPC1035
 #undef CONFIG_FP_SENSOR_FPC1145
 
+/*
+ * Shorten the capture-to-match latency: switch to MODULE_FAST_CPU before the
+ * capture instead of after it. Only for chips whose SPI kernel clock does not
+ * follow the CPU clock.
+ */
+#undef CONFIG_FP_PIPELINED_MATCH
+
 /*****************************************************************************/
 
 /* Include a flashmap in the compiled firmware image */
@@ -1983,7 +2177,12 @@
 /* Sensor sampling interval for gesture recognition */
 #undef CONFIG_GESTURE_SAMPLING_INTERVAL_MS
 
-/* Which sensor to look for double tap recognition */
+/*
+ * Which sensor to look for double tap recognition.
+ * Without CONFIG_GESTURE_SW_DETECTION, the sensor's own tap engine does the
+ * recognition (bmi160, lis2dw12 as base) and the EC only handles its
+ * interrupt, so the sensor needs no EC sampling rate.
+ */
 #undef CONFIG_GESTURE_SENSOR_DOUBLE_TAP
 
 /* Use for waking up host */
@@ -2030,6 +2229,13 @@
 #undef CONFIG_LID_ANGLE_SENSOR_BASE
 /* Which sensor is located on the lid? */
 #undef CONFIG_LID_ANGLE_SENSOR_LID
+/*
+ * Once the lid angle is steady and the AP does not use the lid angle
+ * sensors, stop sampling them from the EC and let their tilt engines
+ * (see set_tilt_detection in accelgyro.h) wake up the motion sense task
+ * when the device moves. Needs CONFIG_ACCEL_INTERRUPTS.
+ */
+#undef CONFIG_LID_ANGLE_OFFLOAD
 /*
  * Allows using the lid angle measurement to determine if peripheral devices
  * should be enabled or disabled, like key scanning, trackpad interrupt.
@@ -2071,6 +2277,23 @@
  */
 #define CONFIG_MOTION_MIN_SENSE_WAIT_TIME 3
 
+/*
+ * Start the collections of forced mode sensors whose rates are multiples of
+ * each other on the same schedule, so one motion sense task wakeup reads all
+ * of them.
+ */
+#undef CONFIG_MOTION_SENSE_ALIGN_COLLECTION
+
+/*
+ * Defer sensor interrupt processing for up to this many microseconds, until
+ * data is due to the AP (ap_event_interval), a forced mode sensor must be read
+ * or the motion sense task has other work. Interrupts arriving in the meantime
+ * are then served by a single task wakeup and FIFO drain, as with a deeper
+ * hardware FIFO watermark: sensor hardware FIFOs must be able to hold that
+ * much data.
+ */
+#undef CONFIG_MOTION_SENSE_INTERRUPT_BATCH_US
+
 /*****************************************************************************/
 /*
  * Support the host asking the EC about the status of the most recent host
@@ -2086,6 +2309,32 @@
  */
 #undef CONFIG_HOST_COMMAND_STATUS
 
+/*
+ * With CONFIG_HOST_COMMAND_STATUS, run the handlers declared with
+ * DECLARE_HOST_COMMAND_ASYNC on the hook task.  The host command task replies
+ * EC_RES_IN_PROGRESS at once and stays free for other commands; the host
+ * polls EC_CMD_GET_COMMS_STATUS until the command is done and then fetches
+ * its result and response with EC_CMD_RESEND_RESPONSE.  Commands with params
+ * larger than CONFIG_HOST_COMMAND_ASYNC_SIZE run synchronously, and responses
+ * are limited to the same size.
+ */
+#undef CONFIG_HOST_COMMAND_ASYNC
+#define CONFIG_HOST_COMMAND_ASYNC_SIZE 256
+
+/*
+ * Number of host command request slots.  Each transport (LPC/eSPI, SPI, I2C,
+ * USB, ...) takes a slot the first time it sends a command, so a request
+ * from one host is queued rather than overwriting one still pending from
+ * another; the host command task serves the slots round robin.  Transports
+ * beyond the last slot get EC_RES_BUSY.  If undefined, all transports share
+ * one slot.
+ *
+ * Boards can also add a HOSTCMD_WORKER task running host_command_worker_task()
+ * to handle commands declared with DECLARE_HOST_COMMAND_PARALLEL while the
+ * host command task is busy with another one.
+ */
+#undef CONFIG_HOST_COMMAND_CHANNELS
+
 /* clear bit(s) to mask reporting of an EC_HOST_EVENT_XXX event(s) */
 #define CONFIG_HOST_EVENT_REPORT_MASK 0xffffffff
 #define CONFIG_HOST_EVENT64_REPORT_MASK 0xffffffffffffffffULL
@@ -2093,12 +2342,37 @@
 /* Config option to support 64-bit hostevents and wake-masks. */
 #define CONFIG_HOST_EVENT64
 
+/*
+ * Hold the events of CONFIG_HOST_EVENT_COALESCE_MASK back for up to this many
+ * milliseconds before raising them, so that a burst of battery, AC or charger
+ * events costs the AP one SCI/SMI (or MKBP interrupt) instead of one each.
+ * Any other event, the power button or lid for instance, is raised at once,
+ * along with those held back.
+ */
+#undef CONFIG_HOST_EVENT_COALESCE_MS
+
+/*
+ * Host events which CONFIG_HOST_EVENT_COALESCE_MS holds back, as
+ * EC_HOST_EVENT_MASK(EC_HOST_EVENT_*) bits.  When left undefined, the AC,
+ * battery, battery status, USB charger and PD MCU events.
+ */
+#undef CONFIG_HOST_EVENT_COALESCE_MASK
+
 /*
  * The host commands are sorted in the .rodata.hcmds section so use the binary
  * search algorithm to match a command to its handler
  */
 #undef CONFIG_HOSTCMD_SECTION_SORTED
 
+/*
+ * Match host commands below CONFIG_HOSTCMD_LOOKUP_TABLE_SIZE to their handler
+ * through a table indexed by command number, filled in from .rodata.hcmds the
+ * first time a command is looked up.  Costs one byte of RAM per entry; higher
+ * command numbers still use the search.
+ */
+#undef CONFIG_HOSTCMD_LOOKUP_TABLE
+#define CONFIG_HOSTCMD_LOOKUP_TABLE_SIZE 0x140
+
 /*
  * Host command parameters and response are 32-bit aligned.  This generates
  * much more efficient code on ARM.
@@ -2115,6 +2389,24 @@
 /* Default hcdebug mode, e.g. HCDEBUG_OFF or HCDEBUG_NORMAL */
 #define CONFIG_HOSTCMD_DEBUG_MODE HCDEBUG_NORMAL
 
+/*
+ * Record the arrival, start and completion time of the last
+ * CONFIG_HOSTCMD_TRACE_ENTRIES host commands handled by the host command
+ * task, for EC_CMD_GET_HOSTCMD_TRACE.  Must be a power of two.
+ */
+#undef CONFIG_HOSTCMD_TRACE
+
+/* Support EC_CMD_BATCH, to run several host commands per request. */
+#undef CONFIG_HOSTCMD_BATCH
+
+/*
+ * Send EC_MKBP_EVENT_MEMMAP_CHANGE when blocks of the memory map the AP
+ * subscribed to with EC_CMD_MEMMAP_NOTIFY change, so it doesn't need to poll
+ * them.  Requires CONFIG_MKBP_EVENT.
+ */
+#undef CONFIG_HOST_MEMMAP_NOTIFY
+#define CONFIG_HOSTCMD_TRACE_ENTRIES 32
+
 /* If we have host command task, assume we also are using host events. */
 #ifdef HAS_TASK_HOSTCMD
 #define CONFIG_HOSTCMD_EVENTS
@@ -2140,6 +2432,13 @@
  */
 #undef CONFIG_HOSTCMD_SPS
 
+/*
+ * Keep per-transaction timing statistics of the SPI slave host interface
+ * (receive, processing and send phases) and report them with the 'spsstats'
+ * console command.
+ */
+#undef CONFIG_HOSTCMD_SPS_STATS
+
 /*
  * Host command rate limiting assures EC will have time to process lower
  * priority tasks even if the AP is hammering the EC with host commands.
@@ -2223,6 +2522,13 @@
 /* Enable the software routine for CRC computation */
 #undef CONFIG_SW_CRC
 
+/*
+ * Number of 1KB lookup tables used by the software CRC: 1 processes a byte
+ * at a time, 4 or 8 process that many bytes per step (slicing-by-4/8), for
+ * about 2x and 3x the throughput on buffers.
+ */
+#define CONFIG_SW_CRC_SLICES 1
+
 /*****************************************************************************/
 
 /* Enable system hibernate */
@@ -2294,6 +2600,13 @@
 #undef CONFIG_I2C_PASSTHRU_RESTRICTED
 #undef CONFIG_I2C_VIRTUAL_BATTERY
 
+/*
+ * Support EC_CMD_I2C_PASSTHRU_SESSION, letting the host stream large writes
+ * and reads to one I2C device with a single access check, instead of a full
+ * EC_CMD_I2C_PASSTHRU message list per chunk.
+ */
+#undef CONFIG_I2C_PASSTHRU_SESSION
+
 /*
  * Define this option if an i2c bus may be unpowered at a certain point during
  * runtime.  An example could be, a sensor bus which is not needed in lower
@@ -2323,6 +2636,32 @@
  */
 #undef CONFIG_I2C_XFER_BOARD_CALLBACK
 
+/*
+ * Track, for each task, how often it locks an I2C port and how long it waits
+ * for and holds the lock, and for each port its longest hold and which task
+ * held it.  Printed by the i2clockstats console command, to find the clients
+ * that delay others (e.g. long battery reads stalling a PD task).
+ */
+#undef CONFIG_I2C_LOCK_STATS
+
+/*
+ * Count, for each I2C controller, its locking (waits and holds), and for each
+ * device, its transfers, bytes, NACK retries, errors and transfer time.  Cheap
+ * enough to leave on; read with EC_CMD_I2C_STATS.  CONFIG_I2C_STATS_DEVICES
+ * is the number of (port, address) pairs tracked; transfers to devices seen
+ * once the table is full are not counted.
+ */
+#undef CONFIG_I2C_STATS
+#define CONFIG_I2C_STATS_DEVICES 16
+
+/*
+ * Receive I2C master reads of at least this many bytes by DMA, with the calling
+ * task sleeping until the transfer is complete instead of polling the
+ * controller for each byte.  Only supported on the STM32F0 I2C2 port (the
+ * other ports keep polling), and needs CONFIG_DMA.
+ */
+#undef CONFIG_I2C_DMA_RX_THRESHOLD
+
 /*
  * EC uses an I2C master interface.
  * Note: if this is defined, i2c_init() will be called
@@ -2422,6 +2761,14 @@
 /* "buffer" size of ipc_shared_obj. */
 #undef CONFIG_IPC_SHARED_OBJ_BUF_SIZE
 
+/*
+ * Number of SCP to AP messages queued in SCP RAM while the AP has not
+ * consumed the send object yet. ipi_send() then accepts messages without
+ * waiting, and the queue is drained in order as the AP consumes them. Leave
+ * undefined to fail with EC_ERROR_BUSY instead.
+ */
+#undef CONFIG_IPI_SEND_QUEUE_SIZE
+
 /* EC support rpmsg name service over IPI. */
 #undef CONFIG_RPMSG_NAME_SERVICE
 
@@ -2592,6 +2939,12 @@
 /*  Print keyboard scan time intervals. */
 #undef CONFIG_KEYBOARD_PRINT_SCAN_TIMES
 
+/*
+ * Trace keystrokes from the scan to the host read and keep latency
+ * histograms of each stage, read with EC_CMD_KEYBOARD_LATENCY_STATS.
+ */
+#undef CONFIG_KEYBOARD_LATENCY_STATS
+
 /*
  * Support for extra runtime key combinations (e.g. alt+volup+h/r for hibernate
  * and warm reboot, respectively).
@@ -2664,6 +3017,19 @@
  */
 #undef CONFIG_8042_AUX
 
+/*
+ * Number of bytes queued for the host by the 8042 protocol, keyboard and AUX
+ * together.  Must be a power of two.  Raise it if typematic bursts or PS/2
+ * mouse packets overflow the queue while the host is slow to read.
+ */
+#define CONFIG_8042_TO_HOST_SIZE 16
+
+/*
+ * Refill the 8042 output buffer from the interrupt signalling that the host
+ * read it, rather than waking the keyboard protocol task for every byte.
+ */
+#undef CONFIG_8042_REFILL_FROM_ISR
+
 /*
  * Support simulate scan code function
  */
@@ -2827,6 +3193,16 @@
 /* Allows us to enable/disable low power idle mode in runtime. */
 #undef CONFIG_LOW_POWER_IDLE_LIMITED
 
+/*
+ * Low power idle governor: only let the idle task deep sleep when the recent
+ * idle periods, and not just the next timer event, predict at least
+ * CONFIG_IDLE_GOVERNOR_DEEP_MIN_US of idle.  Also keeps the residency of each
+ * idle state and a histogram of the wake-up interrupts for EC_CMD_IDLE_STATS.
+ * Requires chip support (npcx).
+ */
+#undef CONFIG_IDLE_GOVERNOR
+#define CONFIG_IDLE_GOVERNOR_DEEP_MIN_US 1000
+
 /*
  * Enable deep sleep during S0 (ignores SLEEP_MASK_AP_RUN).
  */
@@ -2862,6 +3238,13 @@
 #undef CONFIG_HOSTCMD_ESPI_VW_SLP_S3
 #undef CONFIG_HOSTCMD_ESPI_VW_SLP_S4
 
+/*
+ * Keep a histogram of the time taken to handle the SLP_S3/S4/S5 and PLTRST
+ * virtual wire changes, from the VW interrupt entry until the handler of the
+ * wire returns. Reported by the 'vwlatency' console command.
+ */
+#undef CONFIG_HOSTCMD_ESPI_VW_LATENCY
+
 /* MCHP next two items are EC eSPI slave configuration */
 /* Maximum clock frequence eSPI EC slave advertises
  * Values in MHz are 20, 25, 33, 50, and 66
@@ -2893,15 +3276,40 @@
 /* Use Link-Time Optimizations to try to reduce the firmware code size */
 #undef CONFIG_LTO
 
+/* LZ4 block compression (include/lz4.h) */
+#undef CONFIG_LZ4
+
 /* Provide rudimentary malloc/free like services for shared memory. */
 #undef CONFIG_MALLOC
 
+/*
+ * With CONFIG_MALLOC, reserve fixed size slots for the common 64, 256, 1024
+ * and 4096 byte requests at the top of the shared memory pool.  These are
+ * acquired and released in constant time and never fragment the rest of the
+ * pool.  Requests that don't fit a free slot fall back to the first-fit list.
+ */
+#undef CONFIG_MALLOC_SLAB
+
+/* Number of slots of each size class, at most 32 each. */
+#define CONFIG_MALLOC_SLAB_64_COUNT 4
+#define CONFIG_MALLOC_SLAB_256_COUNT 4
+#define CONFIG_MALLOC_SLAB_1K_COUNT 2
+#define CONFIG_MALLOC_SLAB_4K_COUNT 1
+
 /* Need for a math library */
 #undef CONFIG_MATH_UTIL
 
 /* Include sensor online calibration (requires CONFIG_FPU) */
 #undef CONFIG_ONLINE_CALIB
 
+/*
+ * Run online calibration in the hook task instead of the motion sense task.
+ * Samples wait in a queue of CONFIG_ONLINE_CALIB_QUEUE_SIZE entries (a power
+ * of 2, 16 by default) and are dropped while it is full.
+ */
+#undef CONFIG_ONLINE_CALIB_DEFERRED
+#undef CONFIG_ONLINE_CALIB_QUEUE_SIZE
+
 /*
  * Duration after which an entry in the temperature cache is considered stale.
  * Defaults to 5 minutes if not set.
@@ -3009,9 +3417,36 @@
  */
 #undef CONFIG_MKBP_EVENT_WAKEUP_MASK
 
+/*
+ * Define which MKBP events are not urgent and may be batched.  Such an event
+ * does not interrupt the AP right away: the interrupt is held for up to
+ * CONFIG_MKBP_EVENT_BATCH_MS, so that the events coming in the meantime are
+ * read by the AP after a single interrupt.  An event outside of the mask ends
+ * the window early.  Some examples are:
+ *
+ *    EC_MKBP_EVENT_SENSOR_FIFO
+ *    EC_MKBP_EVENT_SWITCH
+ *
+ * The only things that should be in this mask are EC_MKBP_EVENT_*, and never
+ * EC_MKBP_EVENT_KEY_MATRIX.
+ */
+#undef CONFIG_MKBP_EVENT_BATCH_MASK
+
+/* Length of the MKBP event batching window, in ms */
+#define CONFIG_MKBP_EVENT_BATCH_MS 5
+
 /* Support memory protection unit (MPU) */
 #undef CONFIG_MPU
 
+/*
+ * Keep a no-access MPU region over the bottom of the running task's stack,
+ * moved on every context switch, so a stack overflow faults right away.
+ * Replaces the CONFIG_DEBUG_STACK_OVERFLOW check on context switches.  The
+ * guard takes the first 32 bytes aligned to 32 of each stack.  Requires
+ * CONFIG_MPU; cortex-m only.
+ */
+#undef CONFIG_MPU_STACK_GUARD
+
 /* Do not try hold I/O pins at frozen level during deep sleep */
 #undef CONFIG_NO_PINHOLD
 
@@ -3028,6 +3463,20 @@
 #undef CONFIG_PANIC_DATA_BASE
 #undef CONFIG_PANIC_DATA_SIZE
 
+/*
+ * Extended crash dump: on a panic, also save the stack pointer and the top
+ * CONFIG_PANIC_CRASHDUMP_STACK_WORDS words of the stack of every task, the
+ * last CONFIG_PANIC_CRASHDUMP_HOST_CMDS host commands and the last
+ * CONFIG_PANIC_CRASHDUMP_CONSOLE_SIZE bytes of console output.  The dump
+ * lives in the preserved RAM of CONFIG_PRESERVE_LOGS and is read in bulk
+ * with EC_CMD_CRASHDUMP_READ ('ectool crashdump').  Only supported on
+ * cortex-m and cortex-m0.
+ */
+#undef CONFIG_PANIC_CRASHDUMP
+#define CONFIG_PANIC_CRASHDUMP_STACK_WORDS 32
+#define CONFIG_PANIC_CRASHDUMP_HOST_CMDS 8
+#define CONFIG_PANIC_CRASHDUMP_CONSOLE_SIZE 512
+
 /* Support PECI interface to x86 processor */
 #undef CONFIG_PECI
 
@@ -3067,6 +3516,13 @@
 /* Define length of history buffer for port80 messages. */
 #define CONFIG_PORT80_HISTORY_LEN 128
 
+/*
+ * Record the time between port80 writes along with the codes, for profiling
+ * the AP firmware boot stages.  Costs 2 bytes of RAM per history entry.  The
+ * host reads the codes and times with EC_PORT80_READ_TIMED.
+ */
+#undef CONFIG_PORT80_TIMESTAMPS
+
 /*
  * Enable/Disable printing of port80 messages in interrupt context. By default,
  * this is disabled.
@@ -3164,6 +3620,15 @@
  */
 #undef CONFIG_POWER_TRACK_HOST_SLEEP_STATE
 
+/*
+ * Log the time spent in each chipset power state and in each power signal
+ * wait which blocked the chipset task, with its timeout outcome, for
+ * EC_CMD_POWER_TRANSITION_LOG. The log is a ring of
+ * CONFIG_POWER_TRANSITION_LOG_ENTRIES 16-byte entries.
+ */
+#undef CONFIG_POWER_TRANSITION_LOG
+#define CONFIG_POWER_TRANSITION_LOG_ENTRIES 64
+
 /*
  * Implement the '%li' printf format as a *32-bit* integer format,
  * as it might be expected by non-EC code.
@@ -3274,6 +3739,16 @@
 /* Enable hardware Random Number generator support */
 #undef CONFIG_RNG
 
+/*
+ * Serve drbg_rand_bytes() from an HMAC-SHA256 DRBG seeded from the TRNG,
+ * with CONFIG_RNG_DRBG_POOL_SIZE bytes of its output generated ahead in the
+ * background.  The TRNG is only powered on to (re)seed the DRBG, which
+ * happens every CONFIG_RNG_DRBG_RESEED_INTERVAL requests.
+ */
+#undef CONFIG_RNG_DRBG
+#define CONFIG_RNG_DRBG_POOL_SIZE 64
+#define CONFIG_RNG_DRBG_RESEED_INTERVAL 1024
+
 /* Support verifying 2048-bit RSA signature */
 #undef CONFIG_RSA
 
@@ -3365,6 +3840,13 @@
 /* Unroll some loops in SHA256_transform for better performance. */
 #undef CONFIG_SHA256_UNROLLED
 
+/*
+ * The chip or core provides SHA256_transform_blocks(), the block function
+ * behind SHA256_update(), replacing the C version in common/sha256.c.  Used
+ * for hash engines and hand-written assembly versions.
+ */
+#undef CONFIG_SHA256_CUSTOM_TRANSFORM
+
 /* Emulate the CLZ (Count Leading Zeros) in software for CPU lacking support */
 #undef CONFIG_SOFTWARE_CLZ
 
@@ -3395,6 +3877,14 @@
 /* Support deprecated SPI protocol version 2. */
 #undef CONFIG_SPI_PROTOCOL_V2
 
+/*
+ * Size in bytes of the largest version 3 response packet sent by the STM32
+ * SPI host interface (default 0x220). A larger size lets the AP read bulk
+ * data such as EC_CMD_FP_FRAME images in fewer commands, and costs as much
+ * uncached RAM.
+ */
+#undef CONFIG_SPI_MAX_RESPONSE_SIZE
+
 /* Define the SPI port to use to access SPI accelerometer */
 #undef CONFIG_SPI_ACCEL_PORT
 
@@ -3419,6 +3909,13 @@
 /* SPI flash part supports SR2 register */
 #undef CONFIG_SPI_FLASH_HAS_SR2
 
+/*
+ * Read the SPI flash with the Fast Read (0x0B) instruction, which all the
+ * supported parts accept at their highest SPI clock, where the plain Read
+ * (0x03) is limited to a lower one.  Lets boards raise the flash SPI clock.
+ */
+#undef CONFIG_SPI_FLASH_FAST_READ
+
 /* Define the SPI port to use to access the fingerprint sensor */
 #undef CONFIG_SPI_FP_PORT
 
@@ -3451,6 +3948,14 @@
  */
 #undef CONFIG_SPI_NOR_SMART_ERASE
 
+/* If defined, erases only hold the driver while issuing each sector/block
+ * erase, so reads and writes are served between them instead of waiting for
+ * the whole range.  A read during an erase suspends it, if the part advertises
+ * erase suspend/resume in its SFDP Basic Flash Parameter Table, rather than
+ * waiting for the sector/block erase to complete.
+ */
+#undef CONFIG_SPI_NOR_ERASE_SUSPEND
+
 /* SPI master feature */
 #undef CONFIG_SPI_MASTER
 
@@ -3508,6 +4013,14 @@
  */
 #undef CONFIG_SYSTEM_UNLOCKED
 
+/*
+ * Let drivers preserve their view of the hardware across a sysjump with
+ * system_add_jump_state(), so that the next image can skip probing again.
+ * The state carries a CRC-8 and is only restored if its version and size
+ * match.
+ */
+#undef CONFIG_SYSJUMP_STATE
+
 /*
  * Device can be a tablet as well as a clamshell.
  */
@@ -3617,6 +4130,37 @@
  */
 #define CONFIG_TASK_PROFILING
 
+/*
+ * Sample the stack usage of every task once a second and keep the deepest
+ * usage seen since boot, so peaks survive task resets and don't need a scan
+ * at the time they are read. The results are reported through
+ * EC_CMD_TASK_STACK_INFO ('ectool taskstack'). Only supported on cortex-m.
+ */
+#undef CONFIG_TASK_STACK_WATERMARK
+
+/*
+ * Support priority inheritance for mutexes flagged with
+ * MUTEX_FLAG_PRIORITY_INHERIT: while a task is blocked on such a mutex, the
+ * task holding it is scheduled whenever the blocked task would have been.
+ * Only supported on cortex-m.
+ */
+#undef CONFIG_MUTEX_PRIORITY_INHERIT
+
+/*
+ * Count the mutex_lock() calls which had to wait for each mutex, in struct
+ * mutex's contended, and record the longest wait in max_block_us.  The wait
+ * time is only recorded on cortex-m.
+ */
+#undef CONFIG_MUTEX_STATS
+
+/*
+ * mutex_unlock() only wakes the highest priority task waiting for the mutex,
+ * instead of all of them.  The others would only find the mutex locked again
+ * and go back to sleep; they keep their place in the waiters until they get
+ * the lock, so each unlock wakes the next one.
+ */
+#undef CONFIG_MUTEX_WAKE_ONE
+
 /*****************************************************************************/
 /* Mock config */
 
@@ -3694,6 +4238,19 @@
  */
 #undef CONFIG_THROTTLE_AP_ON_BAT_VOLTAGE
 
+/*
+ * Hard throttle the CPU straight from the interrupt of a GPIO wired to a
+ * comparator or charger IC output (e.g. a battery current PROCHOT# output),
+ * with throttle_ap_fast_input_interrupt() as its handler. The throttle
+ * bookkeeping and the release are done afterwards in a deferred handler.
+ * Requires CONFIG_CHIPSET_CAN_THROTTLE, with an ISR-safe
+ * chipset_throttle_cpu().
+ */
+#undef CONFIG_THROTTLE_AP_FAST_INPUT
+
+/* Define if the fast throttle input is active low */
+#undef CONFIG_THROTTLE_AP_FAST_INPUT_ACTIVE_LOW
+
 /*
  * If defined, dptf is enabled to manage thermals.
  *
@@ -3720,6 +4277,20 @@
  */
 #undef CONFIG_DPTF_MULTI_PROFILE
 
+/*
+ * Record the TRACEPOINT() events of the EC subsystems, with timestamps, in one
+ * ring read with EC_CMD_TRACEPOINTS.  Tracepoints of the categories left out
+ * of CONFIG_TRACEPOINT_CATEGORIES are not built at all; the others can be
+ * turned off at runtime, at the cost of a test each.
+ */
+#undef CONFIG_TRACEPOINTS
+
+/* Tracepoint ring entries, 16 bytes each.  Must be a power of two. */
+#define CONFIG_TRACEPOINT_ENTRIES 128
+
+/* Tracepoint categories built in, BIT(enum ec_tracepoint_category) */
+#define CONFIG_TRACEPOINT_CATEGORIES 0xffffffff
+
 /*****************************************************************************/
 /* Touchpad config */
 
@@ -3769,12 +4340,27 @@
 /* USB stream config */
 #undef CONFIG_STREAM_USB
 
+/*
+ * Refill and drain the stream endpoints from their interrupts instead of a
+ * deferred call per packet, so that a fast bridge (e.g. a 3 Mbaud UART) is not
+ * throttled by the HOOK task latency.  Only for chips with a USB packet memory
+ * (not USB_DWC).
+ */
+#undef CONFIG_STREAM_USB_ISR_REFILL
+
 /*****************************************************************************/
 /* UART HOST COMMAND config */
 
 /* Includes USART as host command interface */
 #undef CONFIG_USART_HOST_COMMAND
 
+/*
+ * Send host command responses with one TX DMA transfer instead of a TXE
+ * interrupt per byte.  The USART interrupt then only fires once the whole
+ * response is out.  USART1 only, like the request RX DMA.
+ */
+#undef CONFIG_USART_HOST_COMMAND_TX_DMA
+
 /* Pointer to USART HW config of physical instance */
 #undef CONFIG_UART_HOST_COMMAND_HW
 
@@ -3863,6 +4449,18 @@
 /* Config is enabled, if PD interrupt tasks are used. */
 #undef CONFIG_HAS_TASK_PD_INT
 
+/*
+ * Service the PPC and BC1.2 interrupts of a port from its PD interrupt task
+ * too, instead of a deferred call of each PPC driver and the USB charger task
+ * event raised by the board.  Each pass of the task handles the PPC first
+ * (overcurrent and other faults), then the TCPC alerts, then hands BC1.2
+ * detection to the charger task.  PPC interrupts raised while TCPC alerts are
+ * being processed are serviced in between them.  Needs the PD interrupt
+ * tasks; boards route BC1.2 interrupts with
+ * schedule_deferred_bc12_interrupt().
+ */
+#undef CONFIG_USB_PD_INT_DISPATCH
+
 /*
  * Enables USB Power Delivery
  *
@@ -3932,6 +4530,22 @@
 /* Support for USB PD alternate mode of Downward Facing Port */
 #undef CONFIG_USB_PD_ALT_MODE_DFP
 
+/*
+ * Remember the SVIDs and modes discovered for recently seen port partners
+ * and cable plugs (TCPMv2 only).  When a Discover Identity response matches
+ * a cached one, SVID and mode discovery are skipped and the DPM can go
+ * straight to mode entry.  The cache is in RAM, with this many entries
+ * shared between the ports, and dropped least recently used first.
+ */
+#undef CONFIG_USB_PD_DISCOVERY_CACHE
+#define CONFIG_USB_PD_DISCOVERY_CACHE_ENTRIES 4
+
+/*
+ * Partners and cables with more SVIDs than this aren't cached, to keep the
+ * cache entries small.
+ */
+#define CONFIG_USB_PD_DISCOVERY_CACHE_SVIDS 4
+
 /* HPD is sent to the GPU from the EC via a GPIO */
 #undef CONFIG_USB_PD_DP_HPD_GPIO
 
@@ -4004,6 +4618,15 @@
 /* Define if this board can used TCPC-controlled DRP toggle */
 #undef CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE
 
+/*
+ * Let the TCPMv2 USB-C task sleep until the earliest timer of its state
+ * machines once they are all idle, instead of waking every 5 ms. Needs a TCPC
+ * that raises alerts for connections and received messages, see
+ * usbc_task_idle(). With TCPMv1, an unattached port left toggling by the TCPC
+ * sleeps until a CC alert instead of polling every 500 ms.
+ */
+#undef CONFIG_USBC_TASK_IDLE_WAIT
+
 /* Define to reduces VBUS droop caused by inrush current during charging */
 #undef CONFIG_BD9995X_DELAY_INPUT_PORT_SELECT
 
@@ -4071,9 +4694,32 @@
 /* Record main PD events in a circular buffer */
 #undef CONFIG_USB_PD_LOGGING
 
+/*
+ * Record the last CONFIG_USB_PD_TRACE_ENTRIES PD messages sent and received
+ * and TCPMv2 state machine transitions, for EC_CMD_PD_TRACE.  Must be a power
+ * of two.
+ */
+#undef CONFIG_USB_PD_TRACE
+#define CONFIG_USB_PD_TRACE_ENTRIES 64
+
 /* The size in bytes of the FIFO used for event logging */
 #define CONFIG_EVENT_LOG_SIZE 512
 
+/*
+ * Keep the event log in the preserved RAM of CONFIG_PRESERVE_LOGS, so it
+ * survives panics, resets and sysjumps.  Entries get CRCs so that damaged
+ * ones are dropped at boot.  Without CONFIG_PRESERVE_LOGS the log starts
+ * empty on every boot.
+ */
+#undef CONFIG_EVENT_LOG_PRESERVED
+
+/*
+ * Send EC_MKBP_EVENT_EVENT_LOG when entries are added to the event log, so
+ * the AP can read them in bulk with EC_CMD_EVENT_LOG_READ instead of polling
+ * EC_CMD_PD_GET_LOG_ENTRY.  Requires CONFIG_MKBP_EVENT.
+ */
+#undef CONFIG_EVENT_LOG_NOTIFY
+
 /* Save power by waking up on VBUS rather than polling CC */
 #define CONFIG_USB_PD_LOW_POWER
 
@@ -4194,6 +4840,20 @@
 /* Enable runtime config the TCPC */
 #undef CONFIG_USB_PD_TCPC_RUNTIME_CONFIG
 
+/*
+ * Number of RX messages per port the TCPM caches between the TCPC alert and
+ * the PD task. Must be a power of 2.
+ */
+#define CONFIG_USB_PD_TCPC_RX_CACHE_DEPTH 8
+
+/*
+ * Shadow the TCPCI control registers only the TCPM writes (TCPC_CONTROL,
+ * ROLE_CONTROL and POWER_CONTROL), so that reading and updating them does not
+ * need an I2C read. Only enable this for TCPCs that never change these
+ * registers on their own.
+ */
+#undef CONFIG_USB_PD_TCPCI_SHADOW_REGS
+
 /*
  * Choose one of the following TCPMs (type-C port manager) to manage TCPC. The
  * TCPM stub is used to make direct function calls to TCPC when TCPC is on
@@ -4241,6 +4901,13 @@
 #undef CONFIG_USB_PD_TCPM_DRIVER_IT83XX
 #undef CONFIG_USB_PD_TCPM_DRIVER_IT8XXX2
 
+/*
+ * DMA channels the STM32Gx UCPD receives and transmits PD messages with. If
+ * not defined, default to STM32_DMAC_UCPD1_RX and STM32_DMAC_UCPD1_TX.
+ */
+#undef CONFIG_USB_PD_TCPM_STM32GX_RX_DMA_CH
+#undef CONFIG_USB_PD_TCPM_STM32GX_TX_DMA_CH
+
 /*
  * Type-C retimer drivers to be used.
  */
@@ -4449,6 +5116,16 @@
  */
 #define CONFIG_BC12_SINGLE_DRIVER
 
+/*
+ * Run BC1.2 detection for all the ports in a single USB_CHG task, instead of
+ * one USB_CHG_Pn task per port: the board declares a USB_CHG task running
+ * usb_charger_task() and sends events with usb_charger_task_set_event(). It
+ * saves a task stack per port, and the charge manager refreshes once for
+ * updates from several ports. Every bc12 driver used must implement
+ * usb_charger_task_event (pi3usb9201 does).
+ */
+#undef CONFIG_USB_CHARGER_SINGLE_TASK
+
 /* External BC1.2 charger detection devices. */
 #undef CONFIG_BC12_DETECT_MAX14637
 #undef CONFIG_BC12_DETECT_MT6360
@@ -4643,6 +5320,14 @@
 /* USB SPI config */
 #undef CONFIG_USB_SPI
 
+/*
+ * Process the USB SPI packets in the endpoint interrupts, with only the SPI
+ * transfers themselves left to the deferred function.  Saves a HOOK task
+ * round trip for each 64 byte packet of a transfer, which bounds the
+ * throughput of flashing through the bridge.
+ */
+#undef CONFIG_USB_SPI_ISR_PACKETS
+
 /*****************************************************************************/
 /* USB I2C config */
 #undef CONFIG_USB_I2C
@@ -4690,6 +5375,22 @@
 /* Support computing hash of code for verified boot */
 #undef CONFIG_VBOOT_HASH
 
+/*
+ * Read the image to hash from SPI flash with DMA, hashing each piece while
+ * the next one is read.  For chips without mapped storage whose flash is
+ * the CONFIG_SPI_FLASH part and whose spi_transaction_async() uses DMA.
+ */
+#undef CONFIG_VBOOT_HASH_PIPELINED
+
+/*
+ * Number of SHA-256 states to keep at erase block aligned points of the
+ * last region hashed without a nonce.  Flash writes only drop the states
+ * past the first byte written, so hashing the region again after a partial
+ * update restarts from the last state left instead of the start.  Costs
+ * 32 bytes of RAM per state.
+ */
+#undef CONFIG_VBOOT_HASH_CHECKPOINTS
+
 /* Support for secure temporary storage for verified boot */
 #undef CONFIG_VSTORE
 
@@ -4787,6 +5488,13 @@
 /* Add support for reading UART buffer from USB update interface. */
 #undef CONFIG_USB_CONSOLE_READ
 
+/*
+ * Add support for partial updates over the USB update interface.  The host
+ * reads back the hash of each erase block, and only sends the blocks that
+ * changed.
+ */
+#undef CONFIG_USB_UPDATE_PARTIAL
+
 /* PDU size for fw update over USB (or TPM). */
 #define CONFIG_UPDATE_PDU_SIZE 1024
 
@@ -4808,6 +5516,14 @@
  */
 #undef CONFIG_CROS_BOARD_INFO
 
+/*
+ * Read CBI tags from the EEPROM as they are asked for, instead of reading the
+ * whole image on the first access. Tags returned before the scan reaches the
+ * end of the image have not been checked against the CRC yet; the CRC is
+ * checked, and the image rejected if it is bad, once every tag has been read.
+ */
+#undef CONFIG_CBI_LAZY_READ
+
 /*****************************************************************************/
 /*
  * ISH config defaults
@@ -4949,6 +5665,9 @@
 #if defined(CONFIG_USB_PD_TCPMV2) && !defined(CONFIG_USB_PD_DECODE_SOP)
 #error CONFIG_USB_PD_DECODE_SOP must be enabled with the TCPMV2 PD state machine
 #endif
+#if defined(CONFIG_USB_PD_DISCOVERY_CACHE) && !defined(CONFIG_USB_PD_TCPMV2)
+#error CONFIG_USB_PD_DISCOVERY_CACHE is only supported by TCPMV2
+#endif
 #endif
 
 /******************************************************************************/
@@ -5108,6 +5827,11 @@
 #define CONFIG_CRC8
 #endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
+/* The preserved sysjump state is checked with a CRC-8. */
+#ifdef CONFIG_SYSJUMP_STATE
+#define CONFIG_CRC8
+#endif
+
 
 /******************************************************************************/
 /*
@@ -5130,6 +5854,11 @@
 #define CONFIG_TEMP_SENSOR
 #endif
 
+#if defined(CONFIG_THROTTLE_AP_FAST_INPUT) && \
+	!defined(CONFIG_CHIPSET_CAN_THROTTLE)
+#error "CONFIG_THROTTLE_AP_FAST_INPUT requires CONFIG_CHIPSET_CAN_THROTTLE"
+#endif
+
 /******************************************************************************/
 /*
  * DPTF must have temperature sensor enabled to get the readings for
@@ -5140,6 +5869,47 @@
 #endif
 
 
+/******************************************************************************/
+/* Pipelined hashing reads SPI flash directly, without mapped storage. */
+#ifdef CONFIG_VBOOT_HASH_PIPELINED
+#if !defined(CONFIG_SPI_FLASH) || defined(CONFIG_MAPPED_STORAGE)
+#error "CONFIG_VBOOT_HASH_PIPELINED needs CONFIG_SPI_FLASH without mapped storage"
+#endif
+#endif
+
+/******************************************************************************/
+/* The stack guard is an MPU region. */
+#if defined(CONFIG_MPU_STACK_GUARD) && !defined(CONFIG_MPU)
+#error "CONFIG_MPU_STACK_GUARD requires CONFIG_MPU"
+#endif
+
+/******************************************************************************/
+/* The crash dump only survives the reboot in preserved RAM. */
+#if defined(CONFIG_PANIC_CRASHDUMP) && !defined(CONFIG_PRESERVE_LOGS)
+#error "CONFIG_PANIC_CRASHDUMP requires CONFIG_PRESERVE_LOGS"
+#endif
+
+/******************************************************************************/
+/* The DRBG is built on HMAC-SHA256. */
+#ifdef CONFIG_RNG_DRBG
+#define CONFIG_SHA256
+#endif
+
+/******************************************************************************/
+/* The preserved event log checks its entries with CRC-8. */
+#ifdef CONFIG_EVENT_LOG_PRESERVED
+#define CONFIG_CRC8
+#endif
+
+/******************************************************************************/
+/* Compressed console reads use LZ4 on top of EC_CMD_CONSOLE_READ V2. */
+#ifdef CONFIG_CONSOLE_READ_LZ4
+#define CONFIG_LZ4
+#ifndef CONFIG_CONSOLE_ENABLE_READ_V2
+#error "CONFIG_CONSOLE_READ_LZ4 needs CONFIG_CONSOLE_ENABLE_READ_V2"
+#endif
+#endif
+
 /******************************************************************************/
 /* The Matrix Keyboard Protocol depends on MKBP events. */
 #ifdef CONFIG_KEYBOARD_PROTOCOL_MKBP
@@ -5440,6 +6210,10 @@
 #error Should not use PDCMD task with PD INT tasks
 #endif
 
+#if defined(CONFIG_USB_PD_INT_DISPATCH) && !defined(CONFIG_HAS_TASK_PD_INT)
+#error CONFIG_USB_PD_INT_DISPATCH needs the PD INT tasks
+#endif
+
 /* Certain console cmds are irrelevant without parent modules. */
 #ifndef CONFIG_BATTERY
 #undef CONFIG_CMD_PWR_AVG
@@ -5543,6 +6317,12 @@
 #define CONFIG_USB_PD_TBT_GEN3_CAPABLE
 #endif /* CONFIG_USB_PD_TBT_COMPAT_MODE */
 
+#if defined(CONFIG_HOT_CODE_IN_RAM) && \
+	(defined(CONFIG_EXTERNAL_STORAGE) || \
+	 !(defined(CORE_CORTEX_M) || defined(CORE_CORTEX_M0)))
+#error "CONFIG_HOT_CODE_IN_RAM needs a Cortex-M running from internal flash"
+#endif
+
 /*
  * CONFIG_CHIP_INIT_ROM_REGION requires that the chip has defined a
  * ROM resident region to store the .init_rom section.
@@ -5731,6 +6511,16 @@
 
 #endif /* CONFIG_ACCEL_FIFO */
 
+#if defined(CONFIG_ACCEL_FIFO_BURST_SIZE) && !defined(CONFIG_ACCEL_FIFO)
+#error "CONFIG_ACCEL_FIFO_BURST_SIZE requires CONFIG_ACCEL_FIFO"
+#endif
+
+#if defined(CONFIG_ACCEL_FIFO_HW_TIMESTAMPS) && \
+	(!defined(CONFIG_ACCEL_FIFO) || !defined(CONFIG_SENSOR_TIGHT_TIMESTAMPS))
+#error "CONFIG_ACCEL_FIFO_HW_TIMESTAMPS requires CONFIG_ACCEL_FIFO and " \
+	"CONFIG_SENSOR_TIGHT_TIMESTAMPS"
+#endif
+
 
 /*
  * If USB PD Discharge is enabled, verify that CONFIG_USB_PD_DISCHARGE_GPIO
@@ -5755,6 +6545,10 @@
 #define CONFIG_SHA256
 #endif
 
+#ifdef CONFIG_USB_UPDATE_PARTIAL
+#define CONFIG_SHA256
+#endif
+
 #ifdef CONFIG_SMBUS_PEC
 #define CONFIG_CRC8
 #endif
@@ -5780,6 +6574,11 @@
 #ifndef CONFIG_ACCEL_CAL_NEWTON_RADIUS_THRES
 #define CONFIG_ACCEL_CAL_NEWTON_RADIUS_THRES 0.001f
 #endif
+
+#if defined(CONFIG_ONLINE_CALIB_DEFERRED) && \
+	!defined(CONFIG_ONLINE_CALIB_QUEUE_SIZE)
+#define CONFIG_ONLINE_CALIB_QUEUE_SIZE 16
+#endif
 #endif /* CONFIG_ONLINE_CALIB */
 
 /*
@@ -5831,4 +6630,10 @@
 #endif /* ifndef(CONFIG_BODY_DETECTION_CUSTOM) */
 #endif /* CONFIG_BODY_DETECTION */
 
+/******************************************************************************/
+/* Check lid angle offload setup */
+#if defined(CONFIG_LID_ANGLE_OFFLOAD) && !defined(CONFIG_ACCEL_INTERRUPTS)
+#error "CONFIG_LID_ANGLE_OFFLOAD needs CONFIG_ACCEL_INTERRUPTS"
+#endif
+
 #endif  /* __CROS_EC_CONFIG_H */
@@ -0,0 +1,56 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Extended crash dump saved on panics */
+
+#ifndef __CROS_EC_CRASHDUMP_H
+#define __CROS_EC_CRASHDUMP_H
+
+#include "common.h"
+
+#ifdef CONFIG_PANIC_CRASHDUMP
+
+/**
+ * Save the crash dump.
+ *
+ * Called from the panic handler, after the panic data is saved and before
+ * the EC reboots.  Doesn't take locks or print anything.
+ *
+ * @param sp	Stack pointer of the task running or interrupted at the panic.
+ */
+void crashdump_capture(uint32_t sp);
+
+/**
+ * Record the start of a host command.
+ *
+ * @param command	Command number.
+ * @param version	Command version.
+ * @return the slot to pass to crashdump_host_command_end().
+ */
+int crashdump_host_command_begin(uint16_t command, uint8_t version);
+
+/**
+ * Record the result of a host command.
+ *
+ * @param slot		Return value of crashdump_host_command_begin().
+ * @param result	EC_RES_* result of the command.
+ */
+void crashdump_host_command_end(int slot, int result);
+
+#else
+
+static inline int crashdump_host_command_begin(uint16_t command,
+					       uint8_t version)
+{
+	return 0;
+}
+
+static inline void crashdump_host_command_end(int slot, int result)
+{
+}
+
+#endif
+
+#endif /* __CROS_EC_CRASHDUMP_H */
@@ -51,6 +51,9 @@ void dma_prepare_tx(const struct dma_option *option, unsigned count,
 /**
  * Start a DMA transfer to receive data to memory from a peripheral
  *
+ * With CONFIG_ARMV7M_CACHE, a buffer which isn't __uncached must be
+ * invalidated with cpu_invalidate_dcache_range() once the transfer is done.
+ *
  * @param option	DMA channel options
  * @param count		Number of bytes to transfer
  * @param memory	Pointer to memory address
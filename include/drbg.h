@@ -0,0 +1,82 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* HMAC-SHA256 DRBG (NIST SP 800-90A) and the random pool built on it */
+
+#ifndef __CROS_EC_DRBG_H
+#define __CROS_EC_DRBG_H
+
+#include <stddef.h>
+
+#include "common.h"
+#include "sha256.h"
+#include "trng.h"
+
+/* Largest seed accepted by hmac_drbg_init() and hmac_drbg_reseed() */
+#define HMAC_DRBG_MAX_SEED_SIZE 64
+
+struct hmac_drbg_ctx {
+	uint8_t k[SHA256_DIGEST_SIZE];
+	uint8_t v[SHA256_DIGEST_SIZE];
+	/* Number of hmac_drbg_generate() calls since the last (re)seed */
+	uint32_t reseed_counter;
+};
+
+/**
+ * Instantiate the DRBG.
+ *
+ * @param ctx		DRBG state.
+ * @param seed		Entropy input, nonce and personalization string, one
+ *			after the other.
+ * @param seed_len	Length of seed, up to HMAC_DRBG_MAX_SEED_SIZE.
+ */
+void hmac_drbg_init(struct hmac_drbg_ctx *ctx, const void *seed,
+		    size_t seed_len);
+
+/**
+ * Reseed the DRBG.
+ *
+ * @param ctx		DRBG state.
+ * @param seed		Entropy input, then additional input.
+ * @param seed_len	Length of seed, up to HMAC_DRBG_MAX_SEED_SIZE.
+ */
+void hmac_drbg_reseed(struct hmac_drbg_ctx *ctx, const void *seed,
+		      size_t seed_len);
+
+/**
+ * Generate random bytes.
+ *
+ * @param ctx		DRBG state.
+ * @param out		Output buffer.
+ * @param out_len	Number of bytes to generate.
+ */
+void hmac_drbg_generate(struct hmac_drbg_ctx *ctx, void *out, size_t out_len);
+
+#ifdef CONFIG_RNG_DRBG
+
+/**
+ * Output random bytes from the pool.
+ *
+ * They come from a DRBG seeded from the TRNG, refilled in the background,
+ * so the call doesn't wait for the TRNG unless the DRBG is due a reseed.
+ * Powers the TRNG on by itself.
+ *
+ * @param buffer	Output buffer.
+ * @param len		Number of bytes.
+ */
+void drbg_rand_bytes(void *buffer, size_t len);
+
+#else
+
+static inline void drbg_rand_bytes(void *buffer, size_t len)
+{
+	init_trng();
+	rand_bytes(buffer, len);
+	exit_trng();
+}
+
+#endif
+
+#endif /* __CROS_EC_DRBG_H */
@@ -2487,6 +2487,8 @@ enum motionsense_command {
 
 	/*
 	 * Return a portion of the fifo.
+	 * From version 5, the entries are delta encoded, see
+	 * ec_response_motion_sense_fifo_compact.
 	 */
 	MOTIONSENSE_CMD_FIFO_READ = 9,
 
@@ -2669,6 +2671,30 @@ struct ec_response_motion_sense_fifo_data {
 	struct ec_response_motion_sensor_data data[0];
 } __ec_todo_packed;
 
+/*
+ * Response to MOTIONSENSE_CMD_FIFO_READ version 5: number_data entries are
+ * encoded in data, each as:
+ * - One byte with the entry flags in bits 4:0 and the sensor number in bits
+ *   7:5. If the sensor number does not fit, bits 7:5 are
+ *   MOTIONSENSE_FIFO_COMPACT_SENSOR_ESC and the sensor number follows in the
+ *   next byte.
+ * - For entries with MOTIONSENSE_SENSOR_FLAG_TIMESTAMP, the timestamp minus the
+ *   previous timestamp of the response (0 for the first one), modulo 2^32.
+ * - For other entries, each of data[0..2] minus the same value of the previous
+ *   such entry of the same sensor in the response (0 for the first one).
+ * Differences are zigzag encoded (0, -1, 1, -2, ... become 0, 1, 2, 3, ...),
+ * then stored 7 bits per byte, least significant first, with BIT(7) set on
+ * every byte but the last.
+ */
+#define MOTIONSENSE_FIFO_COMPACT_FLAGS_MASK 0x1f
+#define MOTIONSENSE_FIFO_COMPACT_SENSOR_SHIFT 5
+#define MOTIONSENSE_FIFO_COMPACT_SENSOR_ESC 7
+
+struct ec_response_motion_sense_fifo_compact {
+	uint32_t number_data;
+	uint8_t data[0];
+} __ec_todo_packed;
+
 /* List supported activity recognition */
 enum motionsensor_activity {
 	MOTIONSENSE_ACTIVITY_RESERVED = 0,
@@ -3042,6 +3068,8 @@ struct ec_response_motion_sense {
 
 		struct ec_response_motion_sense_fifo_data fifo_read;
 
+		struct ec_response_motion_sense_fifo_compact fifo_read_compact;
+
 		struct ec_response_online_calibration_data online_calib_read;
 
 		struct __ec_todo_packed {
@@ -3213,6 +3241,12 @@ struct ec_response_rtc {
 enum ec_port80_subcmd {
 	EC_PORT80_GET_INFO = 0,
 	EC_PORT80_READ_BUFFER,
+	/*
+	 * Read the codes with the time between them, from write number start
+	 * on.  Only supported by ECs built with CONFIG_PORT80_TIMESTAMPS, and
+	 * answered with struct ec_response_port80_read_timed.
+	 */
+	EC_PORT80_READ_TIMED,
 };
 
 struct ec_params_port80_read {
@@ -3222,6 +3256,9 @@ struct ec_params_port80_read {
 			uint32_t offset;
 			uint32_t num_entries;
 		} read_buffer;
+		struct __ec_todo_unpacked {
+			uint32_t start;
+		} read_timed;
 	};
 } __ec_todo_packed;
 
@@ -3242,6 +3279,35 @@ struct ec_response_port80_last_boot {
 	uint16_t code;
 } __ec_align2;
 
+/*
+ * Time since the previous write, in microseconds up to 32767 us, then in
+ * units of 1024 us with EC_PORT80_DELTA_LONG set.
+ */
+#define EC_PORT80_DELTA_LONG BIT(15)
+#define EC_PORT80_DELTA_US(delta) (((delta) & EC_PORT80_DELTA_LONG) ? \
+				   ((uint32_t)((delta) & 0x7fff) << 10) : \
+				   (delta))
+
+struct ec_port80_timed_entry {
+	uint16_t code;
+	uint16_t delta;
+} __ec_align2;
+
+struct ec_response_port80_read_timed {
+	/*
+	 * Write number of the first entry.  Greater than the start asked for
+	 * if the writes in between were overwritten.
+	 */
+	uint32_t start;
+	/* Write number to read from next */
+	uint32_t next;
+	/* Microseconds since the last write, saturated */
+	uint32_t last_age_us;
+	uint16_t count;
+	uint16_t reserved;
+	struct ec_port80_timed_entry entries[];
+} __ec_align4;
+
 /*****************************************************************************/
 /* Temporary secure storage for host verified boot use */
 
@@ -3708,6 +3774,12 @@ enum ec_mkbp_event {
 	/* New online calibration values are available. */
 	EC_MKBP_EVENT_ONLINE_CALIBRATION = 11,
 
+	/* Subscribed regions of the memory map have changed. */
+	EC_MKBP_EVENT_MEMMAP_CHANGE = 12,
+
+	/* New entries were added to the event log (PD log). */
+	EC_MKBP_EVENT_EVENT_LOG = 13,
+
 	/* Number of MKBP events */
 	EC_MKBP_EVENT_COUNT,
 };
@@ -3736,6 +3808,12 @@ union __ec_align_offset1 ec_response_get_next_data {
 
 	/* CEC events from enum mkbp_cec_event */
 	uint32_t cec_events;
+
+	/* Dirty memmap blocks, see EC_CMD_MEMMAP_NOTIFY */
+	uint32_t memmap_dirty;
+
+	/* Sequence number of the next event log entry to be added */
+	uint32_t event_log_next_seq;
 };
 
 union __ec_align_offset1 ec_response_get_next_data_v1 {
@@ -3762,6 +3840,12 @@ union __ec_align_offset1 ec_response_get_next_data_v1 {
 	/* CEC events from enum mkbp_cec_event */
 	uint32_t cec_events;
 
+	/* Dirty memmap blocks, see EC_CMD_MEMMAP_NOTIFY */
+	uint32_t memmap_dirty;
+
+	/* Sequence number of the next event log entry to be added */
+	uint32_t event_log_next_seq;
+
 	uint8_t cec_message[16];
 };
 BUILD_ASSERT(sizeof(union ec_response_get_next_data_v1) == 16);
@@ -4203,6 +4287,33 @@ struct ec_params_console_read_v1 {
 	uint8_t subcmd; /* enum ec_console_read_subcmd */
 } __ec_align1;
 
+/*
+ * Version 2 reads the console output without snapshots, so several readers
+ * can stream it at once.  Each byte ever written to the console has a
+ * cursor, counting up from boot.  A reader passes the cursor of the next
+ * byte it wants (0 at first) and the response holds output from there up to
+ * the current end, along with the cursor to pass next time.  If the output
+ * at the cursor has already been overwritten, the response starts at the
+ * oldest output still buffered, and response cursor is larger than the one
+ * passed.  An empty response means the reader is up to date.
+ */
+#define EC_CONSOLE_READ_LZ4 BIT(0)	/* Data is compressed with LZ4 */
+
+struct ec_params_console_read_v2 {
+	uint32_t cursor;
+	uint8_t flags;		/* EC_CONSOLE_READ_* the host accepts */
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_response_console_read_v2 {
+	uint32_t cursor;	/* Cursor of the first byte of data */
+	uint32_t next_cursor;	/* Cursor to pass to the next read */
+	uint16_t size;		/* Size of the data once decompressed */
+	uint8_t flags;		/* EC_CONSOLE_READ_* used for data */
+	uint8_t reserved;
+	uint8_t data[];		/* Output; not null-terminated */
+} __ec_align4;
+
 /*****************************************************************************/
 
 /*
@@ -6519,6 +6630,732 @@ struct ec_response_typec_status {
 	/* TODO(b/167700356): Add revisions and source cap PDOs */
 } __ec_align1;
 
+/*
+ * Get scheduler statistics for a task.  Only available when the EC is built
+ * with CONFIG_TASK_PROFILING.  Task IDs run from 0 to task_count - 1.
+ */
+#define EC_CMD_GET_TASK_STATS 0x0134
+
+struct ec_params_get_task_stats {
+	uint8_t task_id;
+} __ec_align1;
+
+struct ec_response_get_task_stats {
+	uint8_t task_count;	/* Number of tasks on the EC */
+	uint8_t reserved[3];
+	char name[16];		/* Task name, NUL-terminated */
+	uint64_t runtime_us;	/* Time spent running, excluding interrupts */
+	uint32_t switch_ins;	/* Number of times the task was switched in */
+	uint32_t max_slice_us;	/* Longest time from switch in to switch out */
+	uint32_t wake_count;	/* Number of wake latency samples */
+	/* Time from an event making the task ready until it is switched in */
+	uint32_t wake_latency_avg_us;
+	uint32_t wake_latency_max_us;
+} __ec_align4;
+
+/*
+ * Get the latency histogram of a deferred function: how late it ran compared
+ * to the time it was requested for.  Only available when the EC is built with
+ * CONFIG_HOOK_DEBUG.  Indices run from 0 to deferred_count - 1.
+ */
+#define EC_CMD_GET_DEFERRED_STATS 0x0135
+
+#define EC_DEFERRED_HIST_BUCKETS 8
+
+struct ec_params_get_deferred_stats {
+	uint16_t index;
+} __ec_align2;
+
+struct ec_response_get_deferred_stats {
+	uint16_t deferred_count;	/* Number of deferred functions */
+	/*
+	 * Bucket n of hist counts latencies below hist_base_us * 4^n; the last
+	 * bucket counts all the rest.
+	 */
+	uint16_t hist_base_us;
+	uint32_t routine;		/* Address of the deferred function */
+	uint16_t hist[EC_DEFERRED_HIST_BUCKETS];
+} __ec_align4;
+
+/*
+ * Get shared memory allocator statistics.  Only available when the EC is
+ * built with CONFIG_MALLOC.
+ */
+#define EC_CMD_SHMEM_STATS 0x0136
+
+#define EC_SHMEM_SLAB_CLASSES 4
+
+struct ec_shmem_slab_stats {
+	uint16_t slot_size;	/* Bytes per slot */
+	uint8_t slots;		/* Number of slots, 0 if the class is unused */
+	uint8_t in_use;		/* Slots currently allocated */
+	uint8_t high_water;	/* Most slots ever allocated at once */
+	uint8_t reserved[3];
+	uint32_t misses;	/* Requests that found the class full */
+} __ec_align4;
+
+struct ec_response_shmem_stats {
+	/* First-fit pool, excluding the slabs */
+	uint32_t total;
+	uint32_t allocated;
+	uint32_t free;
+	uint32_t max_free;	/* Largest free buffer */
+	uint32_t max_allocated;	/* Largest request ever granted */
+	uint16_t free_chunks;	/* Number of free buffers */
+	uint16_t reserved;
+	struct ec_shmem_slab_stats slab[EC_SHMEM_SLAB_CLASSES];
+} __ec_align4;
+
+/*
+ * Read the host command trace ring.  Only available when the EC is built with
+ * CONFIG_HOSTCMD_TRACE.  Every command handled by the host command task gets
+ * the next sequence number; the response holds as many entries as fit,
+ * starting at the oldest one still recorded with a sequence number of at
+ * least seq.  Reading stops when count is 0.
+ */
+#define EC_CMD_GET_HOSTCMD_TRACE 0x0137
+
+struct ec_params_get_hostcmd_trace {
+	uint32_t seq;
+} __ec_align4;
+
+struct ec_hostcmd_trace_entry {
+	uint16_t command;
+	uint8_t version;
+	uint8_t result;
+	uint16_t response_size;
+	uint16_t reserved;
+	/* Low 32 bits of the EC clock, in us */
+	uint32_t arrival_us;	/* Command received from the transport */
+	uint32_t start_us;	/* Handler started */
+	uint32_t end_us;	/* Response handed back to the transport */
+} __ec_align4;
+
+struct ec_response_get_hostcmd_trace {
+	uint32_t seq;		/* Sequence number of entry[0] */
+	uint32_t next_seq;	/* Sequence number of the next command */
+	uint8_t count;		/* Number of entries */
+	uint8_t reserved[3];
+	struct ec_hostcmd_trace_entry entry[0];
+} __ec_align4;
+
+/*
+ * Run several commands in one request.  Only available when the EC is built
+ * with CONFIG_HOSTCMD_BATCH.
+ *
+ * The params are an ec_params_batch header followed by count sub-requests,
+ * each an ec_params_batch_cmd header and data_len bytes of params.  The
+ * response is an ec_response_batch header followed by one sub-response per
+ * command run, each an ec_response_batch_cmd header and data_len bytes of
+ * response.  Every sub-request and sub-response is padded to a multiple of 4
+ * bytes.
+ *
+ * Commands run in order.  If the response of a command would not fit in the
+ * remaining response space, that command and the ones after it are not run,
+ * and count in the response is less than count in the params.  Sub-requests
+ * can't themselves be EC_CMD_BATCH.
+ */
+#define EC_CMD_BATCH 0x0138
+
+struct ec_params_batch {
+	uint8_t count;
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_params_batch_cmd {
+	uint16_t command;
+	uint8_t version;
+	uint8_t data_len;
+} __ec_align4;
+
+struct ec_response_batch {
+	uint8_t count;		/* Number of commands run */
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_response_batch_cmd {
+	uint16_t result;	/* enum ec_status of the command */
+	uint16_t data_len;
+} __ec_align4;
+
+/*
+ * Subscribe to memory map change notifications.  Only available when the EC
+ * is built with CONFIG_HOST_MEMMAP_NOTIFY.
+ *
+ * The memory map is split into blocks of EC_MEMMAP_NOTIFY_BLOCK_SIZE bytes;
+ * bit n of a mask covers bytes [n * EC_MEMMAP_NOTIFY_BLOCK_SIZE,
+ * (n + 1) * EC_MEMMAP_NOTIFY_BLOCK_SIZE).  When the EC updates a subscribed
+ * block, it sends EC_MKBP_EVENT_MEMMAP_CHANGE with the mask of blocks changed
+ * since the last event, so the AP only needs to re-read those instead of
+ * polling the whole map.
+ *
+ * The response holds the blocks still pending notification, which are
+ * cleared.  A subscribe_mask of 0 disables notifications.
+ */
+#define EC_CMD_MEMMAP_NOTIFY 0x0139
+
+#define EC_MEMMAP_NOTIFY_BLOCK_SIZE 8
+
+struct ec_params_memmap_notify {
+	uint32_t subscribe_mask;
+} __ec_align4;
+
+struct ec_response_memmap_notify {
+	uint32_t dirty_mask;
+} __ec_align4;
+
+/*
+ * Read the event log (the PD log of EC_CMD_PD_GET_LOG_ENTRY) without
+ * consuming it.  ECs built with CONFIG_EVENT_LOG_PRESERVED keep the log
+ * across EC resets, and those built with CONFIG_EVENT_LOG_NOTIFY send
+ * EC_MKBP_EVENT_EVENT_LOG when entries are added, so hosts needn't poll.
+ *
+ * Each entry has a sequence number, one more than the entry before it.  The
+ * response holds the oldest entries with a sequence number of at least seq,
+ * as many as fit.  Pass next_seq back to read the following ones; if seq in
+ * the response is greater than the one asked for, the entries in between
+ * were overwritten before they were read.
+ *
+ * Entries are struct ec_response_pd_log followed by the payload, padded to
+ * a multiple of sizeof(struct ec_response_pd_log).  Entries older than
+ * boot_seq were logged before the EC last booted, and their timestamps are
+ * from that boot's clock.
+ */
+#define EC_CMD_EVENT_LOG_READ 0x013A
+
+struct ec_params_event_log_read {
+	uint32_t seq;
+} __ec_align4;
+
+struct ec_response_event_log_read {
+	uint32_t seq;		/* Sequence number of the first entry */
+	uint32_t next_seq;	/* Sequence number to read next */
+	uint32_t boot_seq;	/* First entry logged since the EC booted */
+	uint32_t timestamp;	/* Current time, in entry timestamp units */
+	uint8_t count;		/* Number of entries in data */
+	uint8_t reserved[3];
+	uint8_t data[];
+} __ec_align4;
+
+/*
+ * Get the latency histogram of a stage of the keystrokes' way to the host.
+ * Only available when the EC is built with CONFIG_KEYBOARD_LATENCY_STATS.
+ * Stages run from 0 to stage_count - 1, see enum ec_keyboard_latency_stage.
+ */
+#define EC_CMD_KEYBOARD_LATENCY_STATS 0x013B
+
+enum ec_keyboard_latency_stage {
+	/* Key change seen by the scan to the change reported */
+	EC_KB_LATENCY_SCAN = 0,
+	/* Change reported to keystroke queued for the host */
+	EC_KB_LATENCY_QUEUE = 1,
+	/* Keystroke queued to host interrupt asserted */
+	EC_KB_LATENCY_NOTIFY = 2,
+	/* Host interrupt asserted to keystroke read by the host */
+	EC_KB_LATENCY_READ = 3,
+	/* Key change seen by the scan to keystroke read by the host */
+	EC_KB_LATENCY_TOTAL = 4,
+	/*
+	 * Key change reported to a change of the same key suppressed during
+	 * its debounce window
+	 */
+	EC_KB_LATENCY_BOUNCE = 5,
+	EC_KB_LATENCY_STAGE_COUNT,
+};
+
+#define EC_KB_LATENCY_HIST_BUCKETS 16
+
+/* Clear the histograms of all the stages after reading this one */
+#define EC_KB_LATENCY_RESET BIT(0)
+
+struct ec_params_keyboard_latency_stats {
+	uint8_t stage;
+	uint8_t flags;		/* EC_KB_LATENCY_* */
+} __ec_align1;
+
+struct ec_response_keyboard_latency_stats {
+	uint8_t stage_count;	/* Number of stages */
+	uint8_t reserved;
+	/*
+	 * Bucket n of hist counts latencies below hist_base_us * 2^n; the last
+	 * bucket counts all the rest.
+	 */
+	uint16_t hist_base_us;
+	uint32_t count;		/* Number of samples */
+	uint32_t max_us;	/* Longest latency */
+	uint32_t hist[EC_KB_LATENCY_HIST_BUCKETS];
+} __ec_align4;
+
+/*
+ * Read the USB PD trace ring.  Only available when the EC is built with
+ * CONFIG_USB_PD_TRACE.  Every PD message sent or received and every state
+ * machine transition gets the next sequence number; the response holds as
+ * many entries as fit, starting at the oldest one still recorded with a
+ * sequence number of at least seq.  Reading stops when count is 0.
+ */
+#define EC_CMD_PD_TRACE 0x013C
+
+struct ec_params_pd_trace {
+	uint32_t seq;
+} __ec_align4;
+
+enum ec_pd_trace_type {
+	EC_PD_TRACE_RX,		/* Message received */
+	EC_PD_TRACE_TX,		/* Message handed to the TCPC */
+	EC_PD_TRACE_STATE,	/* State machine transition */
+};
+
+/* State machines of EC_PD_TRACE_STATE entries */
+enum ec_pd_trace_sm {
+	EC_PD_TRACE_SM_TC,
+	EC_PD_TRACE_SM_PE,
+	EC_PD_TRACE_SM_PRL_TX,
+	EC_PD_TRACE_SM_PRL_HR,
+	EC_PD_TRACE_SM_RCH,
+	EC_PD_TRACE_SM_TCH,
+};
+
+struct ec_pd_trace_entry {
+	uint32_t timestamp;	/* Low 32 bits of the EC clock, in us */
+	uint8_t port;
+	uint8_t type;		/* enum ec_pd_trace_type */
+	/*
+	 * RX and TX: SOP* type of the message, as in TCPCI (0 is SOP).
+	 * STATE: enum ec_pd_trace_sm.
+	 */
+	uint8_t info;
+	/*
+	 * RX and TX: number of data objects recorded.
+	 * STATE: the new state, as numbered in that state machine.
+	 */
+	uint8_t value;
+	uint16_t header;	/* RX and TX: message header */
+	uint16_t reserved;
+	uint32_t data[7];	/* RX and TX: data objects */
+} __ec_align4;
+
+struct ec_response_pd_trace {
+	uint32_t seq;		/* Sequence number of entry[0] */
+	uint32_t next_seq;	/* Sequence number of the next entry recorded */
+	uint8_t count;		/* Number of entries */
+	uint8_t reserved[3];
+	struct ec_pd_trace_entry entry[0];
+} __ec_align4;
+
+/*
+ * Get or set how the fan speeds requested by the thermal engine are applied.
+ * Only available when the EC is built with CONFIG_FAN_SLEW_CONTROL.  The
+ * response always holds the tuning in effect after the command.
+ */
+#define EC_CMD_FAN_TUNING 0x013D
+
+struct ec_fan_tuning {
+	uint16_t rise_rpm;	/* Fastest speed up, in RPM/s; 0: unlimited */
+	uint16_t fall_rpm;	/* Fastest slow down, in RPM/s; 0: unlimited */
+	uint16_t deadband_rpm;	/* Smallest target change applied */
+	uint16_t lead_pct;	/* Share of a rising request step added ahead */
+} __ec_align2;
+
+enum ec_fan_tuning_action {
+	EC_FAN_TUNING_GET = 0,
+	EC_FAN_TUNING_SET = 1,
+};
+
+struct ec_params_fan_tuning {
+	uint8_t fan_idx;
+	uint8_t action;		/* enum ec_fan_tuning_action */
+	struct ec_fan_tuning tuning;	/* Only used by EC_FAN_TUNING_SET */
+} __ec_align2;
+
+struct ec_response_fan_tuning {
+	struct ec_fan_tuning tuning;
+} __ec_align2;
+
+/*
+ * Read the I2C bus statistics.  Only available when the EC is built with
+ * CONFIG_I2C_STATS.  Port entries cover the locking of each I2C controller,
+ * device entries the transfers to each (port, address) pair seen, in the order
+ * they were first seen.  The response holds as many entries as fit, starting
+ * at index.  Times are in us.
+ */
+#define EC_CMD_I2C_STATS 0x013E
+
+enum ec_i2c_stats_type {
+	EC_I2C_STATS_PORTS = 0,
+	EC_I2C_STATS_DEVICES = 1,
+};
+
+/* Clear all the statistics after reading */
+#define EC_I2C_STATS_FLAG_CLEAR BIT(0)
+
+struct ec_params_i2c_stats {
+	uint8_t type;		/* enum ec_i2c_stats_type */
+	uint8_t index;		/* First entry to read */
+	uint8_t flags;		/* EC_I2C_STATS_FLAG_* */
+	uint8_t reserved;
+} __ec_align1;
+
+struct ec_i2c_stats_port {
+	uint32_t lock_count;	/* Number of times the port was locked */
+	uint32_t wait_us;	/* Total time waiting for the lock */
+	uint32_t max_wait_us;
+	uint32_t hold_us;	/* Total time holding the lock */
+	uint32_t max_hold_us;
+} __ec_align4;
+
+struct ec_i2c_stats_dev {
+	uint8_t port;
+	uint8_t reserved;
+	uint16_t addr_flags;
+	uint32_t count;		/* Transfers */
+	uint32_t bytes;		/* Bytes written and read */
+	uint32_t retries;	/* Transfers retried after a NACK */
+	uint32_t errors;	/* Failed transfers */
+	uint32_t xfer_us;	/* Total time in transfers */
+	uint32_t max_xfer_us;
+} __ec_align4;
+
+struct ec_response_i2c_stats {
+	uint8_t count;		/* Number of entries in this response */
+	uint8_t total;		/* Number of entries of this type */
+	uint8_t reserved[2];
+	/* struct ec_i2c_stats_port or struct ec_i2c_stats_dev, per type */
+	uint32_t entries[0];
+} __ec_align4;
+
+/*
+ * I2C passthru session, for streaming firmware images to a device behind the
+ * EC.  OPEN does the access checks of EC_CMD_I2C_PASSTHRU once for a (port,
+ * address) pair; each XFER then writes the bytes following the params and
+ * reads read_len bytes into the response, as one transaction ending with a
+ * stop, with no per-message headers.  The bus is only held during each XFER.
+ * Only one session may be open; it is closed by CLOSE, by opening another one
+ * or after EC_I2C_SESSION_TIMEOUT_MS without any XFER.
+ */
+#define EC_CMD_I2C_PASSTHRU_SESSION 0x013F
+
+#define EC_I2C_SESSION_TIMEOUT_MS 1000
+
+enum ec_i2c_session_subcmd {
+	EC_I2C_SESSION_OPEN = 0,
+	EC_I2C_SESSION_XFER = 1,
+	EC_I2C_SESSION_CLOSE = 2,
+};
+
+struct ec_params_i2c_session {
+	uint8_t subcmd;		/* enum ec_i2c_session_subcmd */
+	uint8_t port;		/* OPEN: I2C port number */
+	uint16_t addr_flags;	/* OPEN: 7-bit address */
+	uint16_t read_len;	/* XFER: bytes to read after the write */
+	uint16_t reserved;
+	uint8_t data[0];	/* XFER: bytes to write */
+} __ec_align2;
+
+/*
+ * The response to XFER holds the bytes read.  A NACK from the device fails
+ * the command with EC_RES_ERROR, a bus timeout with EC_RES_TIMEOUT.
+ */
+
+/*****************************************************************************/
+/*
+ * Boot trace: timestamps of the init phases of the running image, of each
+ * HOOK_INIT callback and of the chipset transitions up to the first S0.
+ */
+#define EC_CMD_BOOT_TRACE 0x0140
+
+enum ec_boot_trace_event {
+	EC_BOOT_TRACE_TIMER_INIT = 0,	/* First timestamp after reset/jump */
+	EC_BOOT_TRACE_UART_INIT = 1,
+	EC_BOOT_TRACE_VERIFY_START = 2,	/* vboot_main() or RW signature check */
+	EC_BOOT_TRACE_VERIFY_DONE = 3,
+	EC_BOOT_TRACE_TASK_START = 4,
+	EC_BOOT_TRACE_HOOK_INIT = 5,	/* data: hook routine address */
+	EC_BOOT_TRACE_HOOK_INIT_DONE = 6,
+	EC_BOOT_TRACE_POWER_STATE = 7,	/* data: enum power_state */
+	EC_BOOT_TRACE_AP_ON = 8,	/* Chipset reached S0, trace ends */
+	EC_BOOT_TRACE_COUNT
+};
+
+/* HOOK_INIT callback ran longer than the board budget */
+#define EC_BOOT_TRACE_FLAG_OVER_BUDGET BIT(0)
+
+struct ec_boot_trace_entry {
+	uint32_t time_us;	/* Low word of the EC timestamp */
+	uint32_t duration_us;	/* HOOK_INIT run time, 0 for the others */
+	uint32_t data;
+	uint8_t event;		/* enum ec_boot_trace_event */
+	uint8_t flags;		/* EC_BOOT_TRACE_FLAG_* */
+	uint16_t reserved;
+} __ec_align4;
+
+struct ec_params_boot_trace {
+	uint16_t offset;	/* First entry to return */
+} __ec_align2;
+
+struct ec_response_boot_trace {
+	uint16_t count;		/* Entries recorded */
+	uint16_t num;		/* Entries in this response */
+	uint32_t hook_budget_us;
+	struct ec_boot_trace_entry entries[0];
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Power transition log: time spent in each chipset power state and in each
+ * wait for power signals which blocked the chipset task, since EC boot.
+ */
+#define EC_CMD_POWER_TRANSITION_LOG 0x0141
+
+/*
+ * Chipset power states as reported in the log. The numbering is fixed,
+ * unlike the EC internal one which depends on the board S0ix support.
+ */
+enum ec_power_transition_state {
+	EC_POWER_TRANS_G3 = 0,
+	EC_POWER_TRANS_S5 = 1,
+	EC_POWER_TRANS_S3 = 2,
+	EC_POWER_TRANS_S0 = 3,
+	EC_POWER_TRANS_S0IX = 4,
+	EC_POWER_TRANS_G3S5 = 5,
+	EC_POWER_TRANS_S5S3 = 6,
+	EC_POWER_TRANS_S3S0 = 7,
+	EC_POWER_TRANS_S0S3 = 8,
+	EC_POWER_TRANS_S3S5 = 9,
+	EC_POWER_TRANS_S5G3 = 10,
+	EC_POWER_TRANS_S0IXS0 = 11,
+	EC_POWER_TRANS_S0S0IX = 12,
+	EC_POWER_TRANS_STATE_COUNT
+};
+
+enum ec_power_transition_type {
+	/* The chipset left |state| after |duration_us| in it */
+	EC_POWER_TRANS_TYPE_STATE = 0,
+	/* Blocking wait in |state| for the signals in |data| */
+	EC_POWER_TRANS_TYPE_WAIT = 1,
+};
+
+/* The wait ended on its timeout instead of the wanted signals */
+#define EC_POWER_TRANS_FLAG_TIMEOUT BIT(0)
+
+struct ec_power_transition_entry {
+	uint32_t time_us;	/* Low word of the EC timestamp at the end */
+	uint32_t duration_us;
+	uint32_t data;		/* Signals waited on (IN_* mask) for waits */
+	uint8_t type;		/* enum ec_power_transition_type */
+	uint8_t state;		/* enum ec_power_transition_state */
+	uint8_t flags;		/* EC_POWER_TRANS_FLAG_* */
+	uint8_t reserved;
+} __ec_align4;
+
+struct ec_params_power_transition_log {
+	uint32_t seq;		/* First entry to return */
+} __ec_align4;
+
+struct ec_response_power_transition_log {
+	/*
+	 * Sequence number of the first entry returned. Greater than the
+	 * requested one when older entries have been overwritten.
+	 */
+	uint32_t seq;
+	uint32_t next_seq;	/* Sequence number to read next */
+	uint32_t timestamp;	/* Current time, low word of the EC timestamp */
+	uint16_t num;		/* Entries in this response */
+	uint16_t reserved;
+	struct ec_power_transition_entry entries[0];
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Low power idle statistics: residency in each idle state, idle governor
+ * decisions and the interrupts which woke the EC up.
+ */
+#define EC_CMD_IDLE_STATS 0x0142
+
+enum ec_idle_state {
+	EC_IDLE_STATE_SLEEP = 0,	/* wfi, clocks running */
+	EC_IDLE_STATE_DEEP_SLEEP = 1,	/* Chip deep sleep */
+	EC_IDLE_STATE_COUNT
+};
+
+/* Reset the statistics after reading them */
+#define EC_IDLE_STATS_CLEAR BIT(0)
+
+struct ec_params_idle_stats {
+	uint8_t flags;		/* EC_IDLE_STATS_* */
+	uint8_t irq_offset;	/* First wake IRQ counter to return */
+	uint16_t reserved;
+} __ec_align4;
+
+struct ec_response_idle_stats {
+	uint64_t time_us;	/* Time since the statistics were reset */
+	uint64_t residency_us[EC_IDLE_STATE_COUNT];
+	uint32_t count[EC_IDLE_STATE_COUNT];
+	/* Deep sleeps the timer allowed but the governor predicted short */
+	uint32_t predicted_short;
+	/* Deep sleeps which ended before the minimum residency */
+	uint32_t deep_too_short;
+	uint32_t deep_min_us;	/* Minimum residency of a deep sleep */
+	uint16_t irq_count;	/* Wake IRQ counters on the EC */
+	uint8_t irq_offset;	/* IRQ of wake_irq[0] */
+	uint8_t num;		/* Counters in wake_irq[] */
+	uint16_t wake_irq[0];	/* Wake-ups per IRQ, saturated */
+} __ec_align4;
+
+/*
+ * Task stack usage: size of each task stack, the bytes used by its deepest
+ * call chain since the task last started, and the deepest seen since boot.
+ */
+#define EC_CMD_TASK_STACK_INFO 0x0143
+
+struct ec_params_task_stack_info {
+	uint8_t offset;		/* First task to return */
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_task_stack_info {
+	uint16_t size;		/* Stack size in bytes */
+	uint16_t used;		/* Bytes used since the task last started */
+	uint16_t peak;		/* Bytes used since boot */
+	uint16_t reserved;
+	char name[16];		/* Task name, NUL-terminated */
+} __ec_align4;
+
+struct ec_response_task_stack_info {
+	uint8_t task_count;	/* Tasks on the EC, including idle */
+	uint8_t offset;		/* Task ID of task[0] */
+	uint8_t num;		/* Entries in task[] */
+	uint8_t reserved;
+	struct ec_task_stack_info task[0];
+} __ec_align4;
+
+/*
+ * Read the crash dump saved by the last panic.  The dump is a header
+ * followed by task_count task records, each of them followed by stack_words
+ * words of stack, then host_cmd_count host command records, oldest first,
+ * and console_size bytes of console output.
+ */
+#define EC_CMD_CRASHDUMP_READ 0x0144
+
+#define EC_CRASHDUMP_MAGIC 0x504d4443	/* "CDMP" */
+#define EC_CRASHDUMP_VERSION 1
+
+struct ec_crashdump_header {
+	uint32_t magic;		/* EC_CRASHDUMP_MAGIC */
+	uint16_t version;	/* EC_CRASHDUMP_VERSION */
+	uint16_t reserved;
+	uint32_t size;		/* Size of the dump in bytes */
+	uint32_t time_us;	/* Low 32 bits of the EC time of the panic */
+	uint8_t task_count;	/* Task records, one per task ID */
+	uint8_t current_task;	/* Task running or interrupted at the panic */
+	uint8_t stack_words;	/* Words of stack saved per task */
+	uint8_t host_cmd_count;	/* Host command records */
+	uint16_t console_size;	/* Bytes of console output */
+	uint16_t reserved2;
+} __ec_align4;
+
+struct ec_crashdump_task {
+	uint32_t sp;		/* Stack pointer of the task */
+	uint16_t stack_size;	/* Stack size in bytes */
+	uint8_t num_words;	/* Valid words of stack, from sp up */
+	uint8_t reserved;
+	uint32_t stack[0];	/* stack_words words */
+} __ec_align4;
+
+/* Result of a host command which had not completed at the panic */
+#define EC_CRASHDUMP_HOST_CMD_RUNNING 0xff
+
+struct ec_crashdump_host_cmd {
+	uint32_t time_us;	/* Low 32 bits of the EC time it started at */
+	uint16_t command;
+	uint8_t version;
+	uint8_t result;		/* EC_RES_* or EC_CRASHDUMP_HOST_CMD_RUNNING */
+} __ec_align4;
+
+/* Discard the crash dump once read */
+#define EC_CRASHDUMP_READ_CLEAR BIT(0)
+
+struct ec_params_crashdump_read {
+	uint32_t offset;	/* Offset in the dump to read at */
+	uint32_t flags;		/* EC_CRASHDUMP_READ_* */
+} __ec_align4;
+
+struct ec_response_crashdump_read {
+	uint32_t size;		/* Size of the dump, 0 if there is none */
+	uint8_t data[0];	/* Dump from the requested offset */
+} __ec_align4;
+
+/*
+ * Read the tracepoint ring, and optionally choose which categories are
+ * recorded.  Only available when the EC is built with CONFIG_TRACEPOINTS.
+ * Every event recorded gets the next sequence number; the response holds as
+ * many entries as fit, starting at the oldest one still recorded with a
+ * sequence number of at least seq.  Reading stops when count is 0.
+ */
+#define EC_CMD_TRACEPOINTS 0x0145
+
+enum ec_tracepoint_category {
+	EC_TRACEPOINT_CAT_HOOK,
+	EC_TRACEPOINT_CAT_HOSTCMD,
+	EC_TRACEPOINT_CAT_I2C,
+	EC_TRACEPOINT_CAT_CHIPSET,
+	EC_TRACEPOINT_CAT_KEYBOARD,
+	EC_TRACEPOINT_CAT_COUNT,
+};
+
+/* The category of a tracepoint is the high byte of its ID */
+#define EC_TRACEPOINT_ID(cat, n) (((cat) << 8) | (n))
+#define EC_TRACEPOINT_CAT(id) ((id) >> 8)
+
+enum ec_tracepoint_id {
+	/* Deferred call run. arg[0]: routine */
+	EC_TRACEPOINT_HOOK_DEFERRED = EC_TRACEPOINT_ID(EC_TRACEPOINT_CAT_HOOK,
+						       0),
+	/* Host command handled. arg[0]: command, arg[1]: result */
+	EC_TRACEPOINT_HOSTCMD_DONE =
+		EC_TRACEPOINT_ID(EC_TRACEPOINT_CAT_HOSTCMD, 0),
+	/*
+	 * I2C transfer done. arg[0]: port << 16 | address and flags,
+	 * arg[1]: EC_SUCCESS or EC_ERROR_*
+	 */
+	EC_TRACEPOINT_I2C_XFER = EC_TRACEPOINT_ID(EC_TRACEPOINT_CAT_I2C, 0),
+	/* Power state entered. arg[0]: state, arg[1]: power signals */
+	EC_TRACEPOINT_CHIPSET_STATE =
+		EC_TRACEPOINT_ID(EC_TRACEPOINT_CAT_CHIPSET, 0),
+	/* Byte queued for the 8042 host. arg[0]: byte, arg[1]: 1 for aux */
+	EC_TRACEPOINT_8042_TO_HOST =
+		EC_TRACEPOINT_ID(EC_TRACEPOINT_CAT_KEYBOARD, 0),
+};
+
+/* Set the categories recorded to mask */
+#define EC_TRACEPOINTS_SET_MASK BIT(0)
+
+struct ec_params_tracepoints {
+	uint32_t seq;
+	uint32_t flags;		/* EC_TRACEPOINTS_* */
+	uint32_t mask;		/* BIT(enum ec_tracepoint_category) */
+} __ec_align4;
+
+/* Value of task for events recorded in interrupt context */
+#define EC_TRACEPOINT_TASK_IRQ 0xff
+
+struct ec_tracepoint_entry {
+	uint32_t timestamp;	/* Low 32 bits of the EC clock, in us */
+	uint16_t id;		/* enum ec_tracepoint_id */
+	uint8_t task;		/* Task ID or EC_TRACEPOINT_TASK_IRQ */
+	uint8_t reserved;
+	uint32_t arg[2];
+} __ec_align4;
+
+struct ec_response_tracepoints {
+	uint32_t seq;		/* Sequence number of entry[0] */
+	uint32_t next_seq;	/* Sequence number of the next entry recorded */
+	uint32_t mask;		/* Categories being recorded */
+	uint32_t built_mask;	/* Categories built into the EC */
+	uint8_t count;		/* Number of entries */
+	uint8_t reserved[3];
+	struct ec_tracepoint_entry entry[0];
+} __ec_align4;
+
 /*****************************************************************************/
 /* The command range 0x200-0x2FF is reserved for Rotor. */
 
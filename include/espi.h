@@ -93,5 +93,29 @@ const char *espi_vw_get_wire_name(enum espi_vw_signal signal);
  */
 int espi_signal_is_vw(int signal);
 
+#ifdef CONFIG_HOSTCMD_ESPI_VW_LATENCY
+/**
+ * Get the start time of a virtual wire interrupt, to be passed to
+ * espi_vw_latency_record().
+ *
+ * @return current time in us, truncated to 32 bits
+ */
+uint32_t espi_vw_latency_start(void);
+
+/**
+ * Record the handling latency of a virtual wire change
+ *
+ * Only SLP_S3/S4/S5 and PLTRST are tracked, other signals are ignored.
+ *
+ * @param signal virtual wire which was handled
+ * @param start  value of espi_vw_latency_start() at interrupt entry
+ */
+void espi_vw_latency_record(enum espi_vw_signal signal, uint32_t start);
+#else
+static inline uint32_t espi_vw_latency_start(void) { return 0; }
+static inline void espi_vw_latency_record(enum espi_vw_signal signal,
+					  uint32_t start) {}
+#endif
+
 
 #endif  /* __CROS_EC_ESPI_H */
@@ -22,6 +22,13 @@ struct event_log_entry {
 /* Returned in the "type" field, when there is no entry available */
 #define EVENT_LOG_NO_ENTRY 0xff
 
+/*
+ * Check the event log preserved across the last reset, keeping the entries
+ * which are intact.  Must be called before any other event log function.
+ * Only used with CONFIG_EVENT_LOG_PRESERVED.
+ */
+void log_init(void);
+
 /* Add an entry to the event log. */
 void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 		   void *payload, uint32_t timestamp);
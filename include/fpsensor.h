@@ -122,6 +122,19 @@ int fp_sensor_acquire_image_with_mode(uint8_t *image_data, int mode);
 int fp_finger_match(void *templ, uint32_t templ_count, uint8_t *image,
 		    int32_t *match_index, uint32_t *update_bitmap);
 
+/*
+ * Cheaply check whether a finger image may match a template.
+ *
+ * Optional: it runs before fp_finger_match() on each template, using global
+ * features only, so that templates which cannot match are skipped.
+ * The default implementation keeps every template.
+ *
+ * @param templ the template buffer.
+ * @param image the buffer containing the finger image.
+ * @return 0 if the image cannot match |templ|, non-zero otherwise.
+ */
+int fp_finger_prefilter(void *templ, uint8_t *image);
+
 /*
  * Start a finger enrollment session.
  *
@@ -10,6 +10,8 @@
 
 #include <stddef.h>
 
+#include "aes.h"
+#include "aes-gcm.h"
 #include "sha256.h"
 
 #define HKDF_MAX_INFO_SIZE 128
@@ -40,6 +42,15 @@ int hkdf_expand(uint8_t *out_key, size_t out_key_size, const uint8_t *prk,
  */
 int derive_encryption_key(uint8_t *out_key, const uint8_t *salt);
 
+/**
+ * Forget the encryption keys and positive match secrets derived so far.
+ *
+ * derive_encryption_key() and derive_positive_match_secret() keep their
+ * results for the session to avoid repeating the HKDF. This must be called
+ * whenever the context is cleared.
+ */
+void fp_clear_key_cache(void);
+
 /**
  * Derive positive match secret from |input_positive_match_salt| and
  * SBP_Src_Key.
@@ -53,6 +64,70 @@ int derive_encryption_key(uint8_t *out_key, const uint8_t *salt);
 int derive_positive_match_secret(uint8_t *output,
 				 const uint8_t *input_positive_match_salt);
 
+/* Incremental AES-GCM128 operation, see aes_gcm_stream_init(). */
+struct aes_gcm_stream {
+	AES_KEY aes_key;
+	GCM128_CONTEXT ctx;
+};
+
+/**
+ * Start an AES-GCM128 operation that is fed in chunks.
+ *
+ * The chunks passed to aes_gcm_stream_encrypt() or aes_gcm_stream_decrypt()
+ * may have any size; together they form one message. The stream holds the
+ * key schedule: callers must end it with aes_gcm_stream_tag(),
+ * aes_gcm_stream_finish() or aes_gcm_stream_clear().
+ *
+ * @param stream the stream to initialize.
+ * @param key the key to use in AES.
+ * @param key_size the size of |key| in bytes.
+ * @param nonce the nonce value to use in GCM128.
+ * @param nonce_size the size of |nonce| in bytes.
+ * @return EC_SUCCESS on success and error code otherwise.
+ */
+int aes_gcm_stream_init(struct aes_gcm_stream *stream,
+			const uint8_t *key, int key_size,
+			const uint8_t *nonce, int nonce_size);
+
+/**
+ * Encrypt the next |text_size| bytes of the message.
+ *
+ * @return EC_SUCCESS on success and error code otherwise.
+ */
+int aes_gcm_stream_encrypt(struct aes_gcm_stream *stream,
+			   const uint8_t *plaintext, uint8_t *ciphertext,
+			   int text_size);
+
+/**
+ * Decrypt the next |text_size| bytes of the message.
+ *
+ * The plaintext is not authenticated until aes_gcm_stream_finish() succeeds.
+ *
+ * @return EC_SUCCESS on success and error code otherwise.
+ */
+int aes_gcm_stream_decrypt(struct aes_gcm_stream *stream,
+			   const uint8_t *ciphertext, uint8_t *plaintext,
+			   int text_size);
+
+/**
+ * End an encryption: write the tag of the message and clear |stream|.
+ */
+void aes_gcm_stream_tag(struct aes_gcm_stream *stream, uint8_t *tag,
+			int tag_size);
+
+/**
+ * End a decryption: check the tag of the message and clear |stream|.
+ *
+ * @return EC_SUCCESS if |tag| matches and error code otherwise.
+ */
+int aes_gcm_stream_finish(struct aes_gcm_stream *stream, const uint8_t *tag,
+			  int tag_size);
+
+/**
+ * Abort an operation and clear the key schedule held by |stream|.
+ */
+void aes_gcm_stream_clear(struct aes_gcm_stream *stream);
+
 /**
  * Encrypt |plaintext| using AES-GCM128.
  *
@@ -89,6 +89,23 @@ void fp_task_simulate(void);
  */
 void fp_clear_finger_context(int idx);
 
+/*
+ * Record that a template has just matched, making it the first one tried on
+ * the next match.
+ *
+ * @param idx the index of the matched template.
+ */
+void fp_template_matched(int idx);
+
+/*
+ * Get the indices of the valid templates, most recently matched first.
+ * Templates which never matched follow in index order.
+ *
+ * @param order array of FP_MAX_FINGER_COUNT entries receiving the indices.
+ * @return the number of indices, i.e. templ_valid.
+ */
+int fp_get_template_order(uint8_t *order);
+
 /**
  * Clear all fingerprint templates associated with the current user id and
  * reset the sensor.
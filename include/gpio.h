@@ -128,6 +128,24 @@ extern void (* const gpio_irq_handlers[])(enum gpio_signal signal);
 extern const int gpio_ih_count;
 #define GPIO_IH_COUNT gpio_ih_count
 
+#ifdef CONFIG_GPIO_IRQ_COUNTERS
+/* Interrupts seen by each GPIO_INT, indexed like gpio_irq_handlers. */
+extern uint32_t gpio_irq_counts[];
+#endif
+
+/**
+ * Call the interrupt handler of a GPIO, from the chip's interrupt handler.
+ *
+ * @param signal	Signal with a handler (< GPIO_IH_COUNT)
+ */
+static inline void gpio_irq_dispatch(enum gpio_signal signal)
+{
+#ifdef CONFIG_GPIO_IRQ_COUNTERS
+	gpio_irq_counts[signal]++;
+#endif
+	gpio_irq_handlers[signal](signal);
+}
+
 /**
  * Pre-initialize GPIOs.
  *
@@ -40,6 +40,10 @@ void (* const gpio_irq_handlers[])(enum gpio_signal signal) = {
 };
 const int gpio_ih_count = ARRAY_SIZE(gpio_irq_handlers);
 
+#ifdef CONFIG_GPIO_IRQ_COUNTERS
+uint32_t gpio_irq_counts[ARRAY_SIZE(gpio_irq_handlers)];
+#endif
+
 /*
  * ALL GPIO_INTs must appear before GPIOs (from gpio.wrap).
  * This is because the enum gpio_signal names are used to index into
@@ -10,6 +10,7 @@
 #include "math_util.h"
 #include "stdbool.h"
 #include "vec3.h"
+#include "window_stats.h"
 
 struct gyro_still_det {
 	/**
@@ -47,20 +48,17 @@ struct gyro_still_det {
 	fpv3_t mean;
 
 	/**
-	 * Accumulator variables for computing the window sample mean and
-	 * variance for the current window (used for stillness detection).
+	 * Accumulators for the sample mean and variance of the current window
+	 * (used for stillness detection).
 	 */
-	uint32_t num_acc_win_samples;
+	struct window_stats win;
+
+	/** Latest computed window mean. */
 	fpv3_t win_mean;
-	fpv3_t assumed_mean;
-	fpv3_t acc_var;
 
 	/** Stillness period mean (used for look-ahead). */
 	fpv3_t prev_mean;
 
-	/** Latest computed variance. */
-	fpv3_t win_var;
-
 	/**
 	 * Stillness confidence score for current and previous sample
 	 * windows [0,1] (used for look-ahead).
@@ -10,6 +10,10 @@
 
 #include "common.h"
 
+#ifdef CONFIG_ZEPHYR
+#include "zephyr_hooks_shim.h"
+#endif
+
 enum hook_priority {
 	/* Generic values across all hooks */
 	HOOK_PRIO_FIRST = 1,       /* Highest priority */
@@ -235,6 +239,38 @@ enum hook_type {
 	 * USB PD cc connection event.
 	 */
 	HOOK_USB_PD_CONNECT,
+
+	/*
+	 * Initialization no other task depends on, like probing a keyboard
+	 * backlight or an ALS over I2C.
+	 *
+	 * Hook routines are called once from the HOOK task, after all HOOK_INIT
+	 * routines and while the other tasks (e.g. the chipset power sequence)
+	 * already run.  A routine may rely on anything HOOK_INIT set up; between
+	 * HOOK_INIT_LATE routines, order is set by priority as usual.  Code
+	 * running in other tasks must cope with the routine not having run yet.
+	 */
+	HOOK_INIT_LATE,
+
+	/*
+	 * System is entering S0ix.  Notified right after HOOK_CHIPSET_SUSPEND
+	 * on the S0ix path only.  The AP rails stay on and the host may come
+	 * back within milliseconds, so a module which needs less than its full
+	 * suspend for S0ix does that here, and skips its HOOK_CHIPSET_SUSPEND
+	 * work when power_in_s0ix_transition() is true.
+	 *
+	 * Hook routines are called from the chipset task.
+	 */
+	HOOK_CHIPSET_SUSPEND_S0IX,
+
+	/*
+	 * System is resuming from S0ix.  Notified right before
+	 * HOOK_CHIPSET_RESUME on the S0ix path only, see
+	 * HOOK_CHIPSET_SUSPEND_S0IX.
+	 *
+	 * Hook routines are called from the chipset task.
+	 */
+	HOOK_CHIPSET_RESUME_S0IX,
 };
 
 struct hook_data {
@@ -258,16 +294,36 @@ struct hook_data {
  */
 void hook_notify(enum hook_type type);
 
+#ifndef CONFIG_ZEPHYR
 struct deferred_data {
 	/* Deferred function pointer */
 	void (*routine)(void);
 };
+#endif
+
+/*
+ * Links of a pending deferred function in the deadline-ordered list kept by
+ * the hook task.  Each is 1 + the index of the neighbouring function in
+ * __deferred_funcs, or 0 at either end of the list.
+ */
+struct deferred_link {
+	uint16_t next;
+	uint16_t prev;
+};
+
+/*
+ * Number of buckets in the histogram of deferred call latency (time actually
+ * called minus time requested). Bucket n counts latencies below
+ * DEFERRED_HIST_BASE_US * 4^n; the last bucket counts all the rest.
+ */
+#define DEFERRED_HIST_BUCKETS 8
+#define DEFERRED_HIST_BASE_US 64
 
 /**
  * Start a timer to call a deferred routine.
  *
  * The routine will be called after at least the specified delay, in the
- * context of the hook task.
+ * context of the hook task (the system work queue under Zephyr).
  *
  * @param data	The deferred_data struct created by invoking DECLARE_DEFERRED().
  * @param us	Delay in microseconds until routine will be called.  If the
@@ -280,7 +336,8 @@ struct deferred_data {
 int hook_call_deferred(const struct deferred_data *data, int us);
 
 /*
- * Hooks are not currently supported by the Zephyr shim.
+ * Hooks are not currently supported by the Zephyr shim, deferred functions
+ * are declared by zephyr_hooks_shim.h.
  * TODO(b/168799177): Implement compatible DECLARE_HOOK macro for
  * Zephyr OS.
  */
@@ -344,8 +401,10 @@ int hook_call_deferred(const struct deferred_data *data, int us);
 #else  /* !defined(CONFIG_COMMON_RUNTIME) || defined(CONFIG_ZEPHYR) */
 #define DECLARE_HOOK(t, func, p)				\
 	void CONCAT2(unused_hook_, func)(void) { func(); }
+#ifndef CONFIG_ZEPHYR
 #define DECLARE_DEFERRED(func)					\
 	void CONCAT2(unused_deferred_, func)(void) { func(); }
 #endif
+#endif
 
 #endif  /* __CROS_EC_HOOKS_H */
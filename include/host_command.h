@@ -126,8 +126,15 @@ struct host_command {
 	int command;
 	/* Mask of supported versions */
 	int version_mask;
+#ifdef HAS_TASK_HOSTCMD_WORKER
+	/* HOST_COMMAND_FLAG_* */
+	int flags;
+#endif
 };
 
+/* Handler may run on the worker task, alongside any other command */
+#define HOST_COMMAND_FLAG_PARALLEL BIT(0)
+
 #ifdef CONFIG_HOST_EVENT64
 typedef uint64_t host_event_t;
 #define HOST_EVENT_CPRINTS(str, e)	CPRINTS("%s 0x%016" PRIx64, str, e)
@@ -151,6 +158,21 @@ typedef uint32_t host_event_t;
  */
 uint8_t *host_get_memmap(int offset);
 
+#ifdef CONFIG_HOST_MEMMAP_NOTIFY
+/**
+ * Tell the host a range of the memory map has been updated.
+ *
+ * Sends EC_MKBP_EVENT_MEMMAP_CHANGE if the range covers blocks the host
+ * subscribed to and which aren't already pending notification.
+ *
+ * @param offset        Offset of the first byte changed
+ * @param size          Number of bytes changed
+ */
+void host_memmap_changed(int offset, int size);
+#else
+static inline void host_memmap_changed(int offset, int size) {}
+#endif
+
 #ifdef CONFIG_EMI_REGION1
 uint8_t *host_get_customer_memmap(int offset);
 #endif
@@ -283,6 +305,67 @@ void host_packet_receive(struct host_packet *pkt);
 	DECLARE_HOST_COMMAND(command, routine, version_mask)
 #endif
 
+#ifdef HAS_TASK_HOSTCMD_WORKER
+/*
+ * Register a host command handler which has been checked to be safe to run
+ * at the same time as any other handler, on the HOSTCMD_WORKER task.  It must
+ * not use unlocked static state shared with other commands, nor return
+ * EC_RES_IN_PROGRESS.
+ */
+#define DECLARE_HOST_COMMAND_PARALLEL(command, routine, version_mask)	\
+	const struct host_command __keep __no_sanitize_address		\
+	EXPAND(0x0000, command)						\
+	__attribute__((section(".rodata.hcmds."EXPANDSTR(0x0000, command)))) \
+		= {routine, command, version_mask, HOST_COMMAND_FLAG_PARALLEL}
+
+/**
+ * Return true if command was declared with DECLARE_HOST_COMMAND_PARALLEL.
+ */
+int host_command_is_parallel(int command);
+
+/**
+ * Task handling the commands declared with DECLARE_HOST_COMMAND_PARALLEL
+ * when the host command task is busy with another one.
+ */
+void host_command_worker_task(void *u);
+#else
+#define DECLARE_HOST_COMMAND_PARALLEL(command, routine, version_mask)	\
+	DECLARE_HOST_COMMAND(command, routine, version_mask)
+#endif
+
+#if defined(HAS_TASK_HOSTCMD) && defined(CONFIG_HOST_COMMAND_ASYNC)
+/**
+ * Run a host command handler on the hook task.
+ *
+ * Copies the params of args and schedules routine, which must not rely on
+ * anything else about the context it was called in.
+ *
+ * @param args		Command to run
+ * @param routine	Handler for the command
+ * @return EC_RES_IN_PROGRESS if routine will be run later, EC_RES_BUSY if
+ * another command is already running in the background, or the result of
+ * routine if the params were too large to copy and it was run right away.
+ */
+enum ec_status host_command_async(struct host_cmd_handler_args *args,
+				  enum ec_status (*routine)(
+					  struct host_cmd_handler_args *args));
+
+/*
+ * Register a host command handler which may take long, to be run with
+ * host_command_async().
+ */
+#define DECLARE_HOST_COMMAND_ASYNC(command, routine, version_mask)	\
+	static enum ec_status						\
+	routine##_async(struct host_cmd_handler_args *args)		\
+	{								\
+		return host_command_async(args, routine);		\
+	}								\
+	DECLARE_HOST_COMMAND(command, routine##_async, version_mask)
+#else
+#define DECLARE_HOST_COMMAND_ASYNC(command, routine, version_mask)	\
+	DECLARE_HOST_COMMAND(command, routine, version_mask)
+#endif
+
 /**
  * Politely ask the CPU to enable/disable its own throttling.
  *
@@ -72,10 +72,19 @@ int i2c_hid_touchpad_process(unsigned int len, uint8_t *buffer,
 /**
  * Compile an (outgoing) HID input report for an (incoming) touchpad event
  *
- * The compiled report would be sent next time when the host requests one.
+ * Compiled reports are queued and sent in order as the host requests them.
  *
  * @param touchpad_event	Touchpad event data
  */
 void i2c_hid_compile_report(struct touchpad_event *event);
 
+/**
+ * Check for compiled reports the host has not read yet
+ *
+ * Boards keep the HID interrupt asserted while this is true.
+ *
+ * @return true if there are reports waiting for the host.
+ */
+bool i2c_hid_touchpad_report_pending(void);
+
 #endif /* __CROS_EC_I2C_HID_TOUCHPAD_H */
@@ -0,0 +1,54 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Low power idle governor and statistics */
+
+#ifndef __CROS_EC_IDLE_GOVERNOR_H
+#define __CROS_EC_IDLE_GOVERNOR_H
+
+#include "common.h"
+#include "ec_commands.h"
+
+#ifdef CONFIG_IDLE_GOVERNOR
+
+/**
+ * Check if a deep sleep is worth entering.
+ *
+ * Called from the idle task with interrupts disabled, once everything else
+ * allows a deep sleep.
+ *
+ * @param timer_us	Time until the next timer event.
+ * @return 1 if both the next timer event and the length of the recent idle
+ *	   periods leave at least CONFIG_IDLE_GOVERNOR_DEEP_MIN_US, else 0.
+ */
+int idle_governor_allow_deep(uint32_t timer_us);
+
+/**
+ * Record an idle period.
+ *
+ * Called from the idle task with interrupts disabled, right after waking up.
+ *
+ * @param state		Idle state the EC was in.
+ * @param slept_us	Time spent in it.
+ * @param wake_irq	IRQ which woke the EC up, or -1 if unknown.
+ */
+void idle_governor_record(enum ec_idle_state state, uint32_t slept_us,
+			  int wake_irq);
+
+#else
+
+static inline int idle_governor_allow_deep(uint32_t timer_us)
+{
+	return 1;
+}
+
+static inline void idle_governor_record(enum ec_idle_state state,
+					uint32_t slept_us, int wake_irq)
+{
+}
+
+#endif
+
+#endif /* __CROS_EC_IDLE_GOVERNOR_H */
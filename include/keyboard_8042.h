@@ -27,6 +27,13 @@ void button_state_changed(enum keyboard_button_type button, int is_pressed);
  */
 void keyboard_host_write(int data, int is_cmd);
 
+/**
+ * Notify the keyboard module when the host read the output buffer.
+ *
+ * Note: This is called in interrupt context by the LPC interrupt handler.
+ */
+void keyboard_host_read(void);
+
 /**
  * Get the amount of free 8042 buffer slots
  * this is used to put backpressure on the host
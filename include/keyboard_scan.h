@@ -135,4 +135,32 @@ void set_vol_up_key(uint8_t row, uint8_t col);
 static inline void set_vol_up_key(uint8_t row, uint8_t col) {}
 #endif
 
+/* Points a traced keystroke goes through on its way to the host */
+enum keyboard_latency_point {
+	KB_LATENCY_REPORTED,	/* Reported to the keyboard protocol */
+	KB_LATENCY_QUEUED,	/* Queued for the host */
+	KB_LATENCY_NOTIFIED,	/* Host interrupt asserted */
+	KB_LATENCY_READ,	/* Read by the host */
+};
+
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+/**
+ * Record that the traced keystroke reached a point.
+ *
+ * Only the last keystroke reported by the scan is traced. It goes through
+ * the points in order; marking a point is ignored unless the keystroke is at
+ * the previous one.
+ *
+ * @param point		Point the keystroke reached.
+ *
+ * @return 1 if the mark was recorded, else 0.
+ */
+int keyboard_latency_mark(enum keyboard_latency_point point);
+#else
+static inline int keyboard_latency_mark(enum keyboard_latency_point point)
+{
+	return 0;
+}
+#endif
+
 #endif  /* __CROS_EC_KEYBOARD_SCAN_H */
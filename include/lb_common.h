@@ -14,8 +14,13 @@
 /* How many (logical) LEDs do we have? */
 #define NUM_LEDS 4
 
-/* Set the color of one LED (or all if the LED number is too large) */
+/*
+ * Set the color of one LED (or all if the LED number is too large). In the
+ * lightbar task, the change is only sent by the next lb_flush().
+ */
 void lb_set_rgb(unsigned int led, int red, int green, int blue);
+/* Send the LED changes buffered by lb_set_rgb(). */
+void lb_flush(void);
 /* Get the current color of one LED. Fails if the LED number is too large. */
 int lb_get_rgb(unsigned int led, uint8_t *red, uint8_t *green, uint8_t *blue);
 /* Set the overall brightness level. */
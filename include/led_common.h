@@ -8,6 +8,7 @@
 #ifndef __CROS_EC_LED_COMMON_H
 #define __CROS_EC_LED_COMMON_H
 
+#include "common.h"
 #include "ec_commands.h"
 
 /* Defined in led_<board>.c */
@@ -25,6 +26,14 @@ extern const int supported_led_ids_count;
  */
 void led_auto_control(enum ec_led_id led_id, int enable);
 
+/**
+ * Called after automatic control of an LED is enabled or disabled, so LED
+ * code that doesn't poll can bring the LED up to date.
+ *
+ * @param led_id	ID of LED whose automatic control changed.
+ */
+__override_proto void led_auto_control_changed(enum ec_led_id led_id);
+
 /**
  * Whether an LED is under automatic control.
  *
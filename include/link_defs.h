@@ -76,12 +76,24 @@ extern const struct hook_data __hooks_usb_pd_disconnect[];
 extern const struct hook_data __hooks_usb_pd_disconnect_end[];
 extern const struct hook_data __hooks_usb_pd_connect[];
 extern const struct hook_data __hooks_usb_pd_connect_end[];
+extern const struct hook_data __hooks_init_late[];
+extern const struct hook_data __hooks_init_late_end[];
+extern const struct hook_data __hooks_chipset_suspend_s0ix[];
+extern const struct hook_data __hooks_chipset_suspend_s0ix_end[];
+extern const struct hook_data __hooks_chipset_resume_s0ix[];
+extern const struct hook_data __hooks_chipset_resume_s0ix_end[];
 
 /* Deferrable functions and firing times*/
 extern const struct deferred_data __deferred_funcs[];
 extern const struct deferred_data __deferred_funcs_end[];
 extern uint64_t __deferred_until[];
 extern uint64_t __deferred_until_end[];
+extern struct deferred_link __deferred_link[];
+extern struct deferred_link __deferred_link_end[];
+#ifdef CONFIG_HOOK_DEBUG
+extern uint16_t __deferred_hist[][DEFERRED_HIST_BUCKETS];
+extern uint16_t __deferred_hist_end[][DEFERRED_HIST_BUCKETS];
+#endif
 
 /* I2C fake devices for unit testing */
 extern const struct test_i2c_xfer __test_i2c_xfer[];
@@ -0,0 +1,47 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* LZ4 block compression, for data sent to the host. */
+
+#ifndef __CROS_EC_LZ4_H
+#define __CROS_EC_LZ4_H
+
+#include "common.h"
+
+/* Largest input of lz4_compress(); match offsets are 16 bits. */
+#define LZ4_MAX_INPUT_SIZE 0xffff
+
+/* Worst-case size of lz4_compress() output for n bytes of input */
+#define LZ4_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+
+/**
+ * Compress data to the LZ4 block format.
+ *
+ * This uses a small, greedy match finder, trading ratio for code size,
+ * stack and speed.  The output can be decoded by any LZ4 block decoder.
+ *
+ * @param src		Data to compress
+ * @param src_size	Size of src; at most LZ4_MAX_INPUT_SIZE
+ * @param dst		Destination buffer
+ * @param dst_size	Size of dst
+ * @return Size of the compressed data, or -EC_ERROR_OVERFLOW if it doesn't
+ *	   fit in dst, or -EC_ERROR_INVAL if src is too large.
+ */
+int lz4_compress(const uint8_t *src, int src_size, uint8_t *dst, int dst_size);
+
+/**
+ * Decompress data in the LZ4 block format.
+ *
+ * @param src		Compressed data
+ * @param src_size	Size of src
+ * @param dst		Destination buffer
+ * @param dst_size	Size of dst
+ * @return Size of the decompressed data, or -EC_ERROR_OVERFLOW if it doesn't
+ *	   fit in dst, or -EC_ERROR_INVAL if src is malformed.
+ */
+int lz4_decompress(const uint8_t *src, int src_size, uint8_t *dst,
+		   int dst_size);
+
+#endif  /* __CROS_EC_LZ4_H */
@@ -11,6 +11,8 @@
 #include <stdint.h>
 
 #ifdef CONFIG_FPU
+#include "math.h"
+
 typedef float fp_t;
 typedef float fp_inter_t;
 
@@ -138,7 +140,18 @@ static inline int ceil_for(int n, int m)
 /**
  * Square root
  */
+#ifdef CONFIG_FPU
+/*
+ * Inlined so that the calibration kernels calling it for every sample get a
+ * single square root instruction instead of a function call.
+ */
+static inline fp_t fp_sqrtf(fp_t a)
+{
+	return sqrtf(a);
+}
+#else
 fp_t fp_sqrtf(fp_t a);
+#endif
 
 /*
  * Fixed point matrix
@@ -171,6 +184,18 @@ enum {
  */
 fp_t arc_cos(fp_t x);
 
+/**
+ * Find the angle of a vector, with a CORDIC using only shifts and adds.
+ *
+ * The components can be any int but INT_MIN.
+ *
+ * @param y
+ * @param x
+ *
+ * @return atan2(y, x) in degrees, between -180 and 180.
+ */
+fp_t arc_tan2(int y, int x);
+
 /**
  * Calculate the dot product of 2 vectors.
  */
@@ -20,6 +20,7 @@ enum module_id {
 	MODULE_DMA,
 	MODULE_EXTPOWER,
 	MODULE_FAST_CPU,
+	MODULE_FINGERPRINT,
 	MODULE_GPIO,
 	MODULE_HOOK,
 	MODULE_HOST_COMMAND,
@@ -55,6 +56,7 @@ enum module_id {
 	MODULE_USB_PORT_POWER,
 	MODULE_USB_SWITCH,
 	MODULE_VBOOT,
+	MODULE_VBOOT_HASH,
 	MODULE_WOV,
 
 	/* Module count; not an actual module */
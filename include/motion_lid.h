@@ -34,6 +34,25 @@ enum ec_status host_cmd_motion_lid(struct host_cmd_handler_args *args);
 
 void motion_lid_calc(void);
 
+#ifdef CONFIG_LID_ANGLE_OFFLOAD
+struct motion_sensor_t;
+
+/**
+ * Check if the EC stopped sampling a sensor, leaving its tilt engine watch
+ * for the lid to move.
+ *
+ * @param s sensor to check
+ * @return 1 if s is a lid angle sensor and it is offloaded.
+ */
+int motion_lid_offloaded(const struct motion_sensor_t *s);
+
+/**
+ * Sample the lid angle sensors from the EC again. Called by the sensor
+ * drivers when their tilt engine fires.
+ */
+void motion_lid_wake(void);
+#endif
+
 #endif  /* __CROS_EC_MOTION_LID_H */
 
 
@@ -292,6 +292,14 @@ extern unsigned int motion_min_interval;
  */
 int sensor_init_done(const struct motion_sensor_t *sensor);
 
+/**
+ * Ask the motion sense task to set the data rate of sensors again, for
+ * instance when the rate the EC needs them at has changed.
+ *
+ * @param sensors bit mask of the sensors to update
+ */
+void motion_sense_request_data_rate(uint32_t sensors);
+
 /**
  * Board specific function that is called when a double_tap event is detected.
  *
@@ -43,6 +43,30 @@ void motion_sense_fifo_insert_async_event(
 	struct motion_sensor_t *sensor,
 	enum motion_sense_async_event event);
 
+/**
+ * Tell the fifo whether the data rate just written to a sensor takes effect at
+ * a mark in its hardware FIFO, like the BMI FIFO config frames. If so, the ODR
+ * event motion sense inserts after the change is dropped, and the driver
+ * stages it with motion_sense_fifo_stage_odr_event() when it reads the mark:
+ * the AP gets it between the last sample at the old rate and the first at the
+ * new one, and the rate change needs no wait.
+ *
+ * @param sensor The sensor whose rate changed.
+ * @param defer Whether the driver stages the ODR event.
+ */
+void motion_sense_fifo_defer_odr_event(const struct motion_sensor_t *sensor,
+				       bool defer);
+
+/**
+ * Stage the deferred ODR event of a sensor, if any. Note that for the AP to
+ * see it, it must be committed.
+ *
+ * @param sensor The sensor whose new rate starts now in its hardware FIFO.
+ * @param time accurate time of the mark in the hardware FIFO
+ */
+void motion_sense_fifo_stage_odr_event(struct motion_sensor_t *sensor,
+				       uint32_t time);
+
 /**
  * Insert a timestamp into the fifo.
  *
@@ -66,6 +90,39 @@ void motion_sense_fifo_stage_data(
 	int valid_data,
 	uint32_t time);
 
+/**
+ * Stage a batch of samples, decoded from a sensor hardware FIFO read in one go,
+ * to the fifo. This is equivalent to calling motion_sense_fifo_stage_data()
+ * for each sample with valid_data set to 3, but the fifo is locked and room is
+ * made for the whole batch once. The samples are timestamped when the fifo is
+ * committed, spread between time and the time they are staged.
+ *
+ * @param data samples to insert in the FIFO, oldest first. Each comes from
+ *             motion_sensors[data[i].sensor_num].
+ * @param count number of samples in data
+ * @param time accurate time (ideally measured in an interrupt) the batch was
+ *             taken at
+ */
+void motion_sense_fifo_stage_batch(
+	struct ec_response_motion_sensor_data *data,
+	int count,
+	uint32_t time);
+
+/**
+ * Stage a sample the sensor timestamped itself, e.g. from timestamps in its
+ * hardware FIFO mapped to the EC clock with sensor_clock. The sample keeps that
+ * time when the fifo is committed instead of being spread, as long as it is
+ * after the previous sample of the sensor.
+ *
+ * @param data data to insert in the FIFO, all axes valid
+ * @param sensor sensor the data comes from
+ * @param time EC time the sensor sampled the data at
+ */
+void motion_sense_fifo_stage_timed_data(
+	struct ec_response_motion_sensor_data *data,
+	struct motion_sensor_t *sensor,
+	uint32_t time);
+
 /**
  * Commit all the currently staged data to the fifo. Doing so makes it readable
  * to the AP.
@@ -102,6 +159,19 @@ int motion_sense_fifo_over_thres(void);
 int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 			   uint16_t *out_size);
 
+/**
+ * Read available committed entries from the fifo, delta encoded as described
+ * for ec_response_motion_sense_fifo_compact.
+ *
+ * @param capacity_bytes The number of bytes available to be written to `out`.
+ * @param max_count The maximum number of entries to be encoded in `out`.
+ * @param out The target to encode the data into.
+ * @param out_size The number of bytes written to `out`.
+ * @return The number of entries encoded in `out`.
+ */
+int motion_sense_fifo_read_compact(int capacity_bytes, int max_count,
+				   void *out, uint16_t *out_size);
+
 /**
  * Reset the internal data structures of the motion sense fifo.
  */
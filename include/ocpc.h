@@ -41,6 +41,9 @@ struct ocpc_data {
 #define OCPC_NO_ISYS_MEAS_CAP	BIT(0)
 
 /** Set the VSYS target for the secondary charger IC.
+ *
+ * This works from the battery parameters and the ADC values the charger loop
+ * read in its current pass.
  *
  * @param curr: Pointer to desired_input_current
  * @param ocpc: Pointer to OCPC data
@@ -17,10 +17,14 @@ void online_calibration_init(void);
 /**
  * Process a new data measurement from a given sensor.
  *
+ * With CONFIG_ONLINE_CALIB_DEFERRED, the sample is only queued here, and
+ * processed later in the hook task.
+ *
  * @param data Pointer to the data that should be processed.
  * @param sensor Pointer to the sensor that generated the data.
  * @param timestamp The time associated with the sample
- * @return EC_SUCCESS when successful.
+ * @return EC_SUCCESS when successful, EC_ERROR_OVERFLOW if the sample was
+ *         dropped because the queue is full.
  */
 int online_calibration_process_data(
 	struct ec_response_motion_sensor_data *data,
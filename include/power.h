@@ -302,6 +302,27 @@ void sleep_set_notify(enum sleep_notify_type notify);
  */
 void sleep_notify_transition(int check_state, int hook_id);
 
+/**
+ * Notify the S0ix transition hooks if the sleep notify is matched.
+ *
+ * On suspend, HOOK_CHIPSET_SUSPEND then HOOK_CHIPSET_SUSPEND_S0IX are
+ * notified; on resume, HOOK_CHIPSET_RESUME_S0IX then HOOK_CHIPSET_RESUME.
+ *
+ * @param check_state: The sleep notify to check.
+ */
+void sleep_notify_s0ix_transition(int check_state);
+
+/**
+ * Check if the chipset suspend/resume hooks run for an S0ix transition.
+ *
+ * @return 1 while sleep_notify_s0ix_transition() notifies its hooks, else 0.
+ */
+#ifdef CONFIG_POWER_SLEEP_FAILURE_DETECTION
+int power_in_s0ix_transition(void);
+#else
+static inline int power_in_s0ix_transition(void) { return 0; }
+#endif
+
 /**
  * Called during the suspend transition, to increase the transition counter.
  */
@@ -76,6 +76,30 @@
 __stdlib_compat int vfnprintf(int (*addchar)(void *context, int c),
 			      void *context, const char *format, va_list args);
 
+/* Start the record with the current time, like cprints() */
+#define PRINTF_TOKEN_TIMESTAMP BIT(0)
+
+/**
+ * Encode formatted output as a token record for CONFIG_CONSOLE_TOKENIZED.
+ *
+ * Instead of formatting, this adds the address of the format string,
+ * shifted left by one with PRINTF_TOKEN_TIMESTAMP in bit 0, and then the
+ * raw arguments.  The host looks the format string up in the EC image and
+ * formats the output itself.  Integers, %pT, %pP and the width and
+ * precision given with '*' are added as unsigned LEB128 values, strings
+ * (cut to their precision) with a terminating null, and %ph as its size
+ * followed by the bytes.  %pb is its count followed by its value.
+ *
+ * @param addchar	Function to be called for each byte added
+ * @param context	Context pointer to pass to addchar()
+ * @param flags		PRINTF_TOKEN_* flags
+ * @param format	Format string (see above for acceptable formats)
+ * @param args		Parameters
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the output was truncated.
+ */
+int vfntokenize(int (*addchar)(void *context, int c), void *context,
+		int flags, const char *format, va_list args);
+
 /**
  * Print formatted outut to a string.
  *
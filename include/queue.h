@@ -184,6 +184,20 @@ struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset);
  */
 struct queue_chunk queue_get_read_chunk(struct queue const *q);
 
+/*
+ * Scatter-gather versions of the above.  Fill chunks[0] and chunks[1] with the
+ * free space (or the used units) of the queue, in order, and return the total
+ * number of units they cover.  chunks[1] is only non-empty when the region
+ * wraps around the end of the buffer.  This lets a producer such as a DMA
+ * engine or USB endpoint fill all of the free space in place and then publish
+ * it with a single call to queue_advance_tail, so the policy is only notified
+ * once.  The same rules as for single chunks apply.
+ */
+size_t queue_get_write_chunks(struct queue const *q,
+			      struct queue_chunk chunks[2]);
+size_t queue_get_read_chunks(struct queue const *q,
+			     struct queue_chunk chunks[2]);
+
 /*
  * Move the queue head pointer forward count units.  This discards count
  * elements from the head of the queue.  It will only discard up to the total
@@ -242,6 +256,73 @@ size_t queue_peek_memcpy(struct queue const *q,
 				const void *src,
 				size_t n));
 
+/*
+ * Single producer/single consumer fast path.
+ *
+ * queue_add_unit_spsc() and queue_remove_unit_spsc() are inline versions of
+ * queue_add_unit() and queue_remove_unit() for queues with exactly one
+ * producer context and one consumer context, for example an interrupt handler
+ * feeding a task.  unit_bytes must be the unit size of the queue and a
+ * compile-time constant, so the copy reduces to a few loads and stores; the
+ * QUEUE_ADD_UNIT_SPSC and QUEUE_REMOVE_UNIT_SPSC macros take it from the type
+ * of src/dest.
+ *
+ * The policy is only notified when the queue goes from empty to non-empty (on
+ * add) or from full to not full (on remove).  Otherwise the other side was
+ * already notified and hasn't caught up yet, so only use these when the
+ * consumer always drains the queue until it is empty, and the producer (if it
+ * waits for space) always refills it until it is full.
+ */
+static inline size_t queue_add_unit_spsc(struct queue const *q,
+					 const void *src, size_t unit_bytes)
+{
+	size_t head = q->state->head;
+	size_t tail = q->state->tail;
+
+	if (tail - head == q->buffer_units)
+		return 0;
+
+	memcpy(q->buffer + (tail & q->buffer_units_mask) * unit_bytes, src,
+	       unit_bytes);
+
+	/* The unit must be in the buffer before the consumer can see it. */
+	__asm__ __volatile__("" : : : "memory");
+	q->state->tail = tail + 1;
+
+	if (tail == head)
+		q->policy->add(q->policy, 1);
+
+	return 1;
+}
+
+static inline size_t queue_remove_unit_spsc(struct queue const *q,
+					    void *dest, size_t unit_bytes)
+{
+	size_t head = q->state->head;
+	size_t tail = q->state->tail;
+
+	if (tail == head)
+		return 0;
+
+	memcpy(dest, q->buffer + (head & q->buffer_units_mask) * unit_bytes,
+	       unit_bytes);
+
+	/* The unit must be read before the producer can overwrite it. */
+	__asm__ __volatile__("" : : : "memory");
+	q->state->head = head + 1;
+
+	if (tail - head == q->buffer_units)
+		q->policy->remove(q->policy, 1);
+
+	return 1;
+}
+
+#define QUEUE_ADD_UNIT_SPSC(q, src)					\
+	queue_add_unit_spsc(q, src, sizeof(*(src)))
+
+#define QUEUE_REMOVE_UNIT_SPSC(q, dest)					\
+	queue_remove_unit_spsc(q, dest, sizeof(*(dest)))
+
 /*
  * These macros will statically select the queue functions based on the number
  * of units that are to be added or removed if they can.  The single unit add
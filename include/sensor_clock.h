@@ -0,0 +1,74 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Mapping of a sensor's own timestamps to the EC clock */
+
+#ifndef __CROS_EC_SENSOR_CLOCK_H
+#define __CROS_EC_SENSOR_CLOCK_H
+
+#include "common.h"
+
+/*
+ * Largest difference, in us, between the model and an observation before the
+ * model is thrown away and restarted from that observation.
+ */
+#define SENSOR_CLOCK_MAX_ERROR_US 20000
+
+/**
+ * Linear model of a sensor timestamp counter: a sensor time and the EC time
+ * it was at, and the EC time per counter tick. The tick length is measured,
+ * since the sensor oscillator can be off its nominal frequency by a few
+ * percent and drifts with temperature.
+ */
+struct sensor_clock {
+	/* Sensor counter value and EC time, in us, of the anchor point */
+	uint32_t anchor_raw;
+	uint32_t anchor_ec;
+	/* EC us per counter tick, in 16.16 fixed point */
+	uint32_t rate;
+	uint32_t nominal_rate;
+	/* Width of the sensor counter, in bits, less than 32 */
+	uint8_t bits;
+	uint8_t synced;
+};
+
+/**
+ * Reset the model of a sensor clock.
+ *
+ * @param clk the model
+ * @param nominal_rate EC us per counter tick the datasheet gives, in 16.16
+ *                     fixed point
+ * @param bits width of the counter, it wraps at BIT(bits)
+ */
+void sensor_clock_init(struct sensor_clock *clk, uint32_t nominal_rate,
+		       int bits);
+
+/**
+ * Update the model with the sensor time of an event and the EC time it was
+ * observed at, e.g. the timestamp of the last FIFO sample and the interrupt
+ * time. Observations are late by the interrupt latency, so the model leans
+ * towards the earliest ones.
+ *
+ * Observations must be less than BIT(bits) ticks apart, or the wraps of the
+ * counter in between are miscounted and the model restarts.
+ *
+ * @param clk the model
+ * @param raw sensor counter value
+ * @param ec_time EC time, in us, the event was observed at
+ */
+void sensor_clock_sync(struct sensor_clock *clk, uint32_t raw,
+		       uint32_t ec_time);
+
+/**
+ * Convert a sensor counter value, within half a wrap of the last
+ * sensor_clock_sync() call, to EC time.
+ *
+ * @param clk the model, synced at least once
+ * @param raw sensor counter value
+ * @return EC time, in us
+ */
+uint32_t sensor_clock_to_ec(const struct sensor_clock *clk, uint32_t raw);
+
+#endif /* __CROS_EC_SENSOR_CLOCK_H */
@@ -29,4 +29,18 @@ uint8_t *SHA256_final(struct sha256_ctx *ctx);
 void hmac_SHA256(uint8_t *output, const uint8_t *key, const int key_len,
 		 const uint8_t *message, const int message_len);
 
+/**
+ * Hash blocks of data into a SHA-256 state.
+ *
+ * This does all the work of the functions above.  common/sha256.c has a C
+ * version; with CONFIG_SHA256_CUSTOM_TRANSFORM the chip or core provides it
+ * instead.
+ *
+ * @param h		Hash state, in host order
+ * @param data		Data, not necessarily aligned
+ * @param block_nb	Number of SHA256_BLOCK_SIZE blocks in data
+ */
+void SHA256_transform_blocks(uint32_t *h, const uint8_t *data,
+			     unsigned int block_nb);
+
 #endif  /* __CROS_EC_SHA256_H */
@@ -22,6 +22,7 @@
 #define SPI_FLASH_ERASE_64KB		0xD8
 #define SPI_FLASH_ERASE_CHIP		0xC7
 #define SPI_FLASH_READ			0x03
+#define SPI_FLASH_FAST_READ		0x0B
 #define SPI_FLASH_PAGE_PRGRM		0x02
 #define SPI_FLASH_REL_PWRDWN		0xAB
 #define SPI_FLASH_MFR_DEV_ID		0x90
@@ -99,6 +100,27 @@ int spi_flash_set_status(int reg1, int reg2);
  */
 int spi_flash_read(uint8_t *buf, unsigned int offset, unsigned int bytes);
 
+/**
+ * Start reading SPI flash, returning while the data is still arriving by
+ * DMA.  The flash is held until spi_flash_read_finish(), which must be
+ * called next, from the same task.
+ *
+ * @param buf Buffer to write flash contents
+ * @param offset Flash offset to start reading from
+ * @param bytes Number of bytes to read, up to SPI_FLASH_MAX_READ_SIZE
+ *
+ * @return EC_SUCCESS, or non-zero if the read couldn't be started.
+ */
+int spi_flash_read_start(uint8_t *buf, unsigned int offset,
+			 unsigned int bytes);
+
+/**
+ * Wait for the read started by spi_flash_read_start() to complete.
+ *
+ * @return EC_SUCCESS, or non-zero if any error.
+ */
+int spi_flash_read_finish(void);
+
 /**
  * Erase SPI flash.
  *
@@ -54,6 +54,15 @@ struct spi_nor_device_t {
 	uint32_t capacity;
 	size_t page_size;
 	int in_4b_addressing_mode;
+
+	/* Erase suspend and resume, discovered through SFDP v1.5+. The
+	 * opcodes are 0 if the part does not support suspending an erase. */
+	uint8_t erase_suspend_opcode;
+	uint8_t erase_resume_opcode;
+	/* Time for an erase to suspend, and the time an erase must be left
+	 * to run after a resume before being suspended again. */
+	uint32_t erase_suspend_usec;
+	uint32_t erase_resume_usec;
 };
 
 extern struct spi_nor_device_t spi_nor_devices[];
@@ -9,6 +9,7 @@
 #include "common.h"
 #include "math_util.h"
 #include "stdbool.h"
+#include "window_stats.h"
 #include <stdint.h>
 
 struct still_det {
@@ -29,12 +30,11 @@ struct still_det {
 	/** The timestamp of the first sample in the current batch. */
 	uint32_t window_start_time;
 
-	/** The number of samples in the current batch. */
-	uint16_t num_samples;
+	/** Mean and variance accumulators of the current batch. */
+	struct window_stats win;
 
-	/** Accumulators used for calculating stillness. */
-	fp_t acc_x, acc_y, acc_z, acc_xx, acc_yy, acc_zz, mean_x, mean_y,
-		mean_z;
+	/** Mean of the last still batch. */
+	fp_t mean_x, mean_y, mean_z;
 };
 
 #define STILL_DET(VAR_THRES, MIN_BATCH_WIN, MAX_BATCH_WIN, MIN_BATCH_SIZE) \
@@ -44,15 +44,6 @@ struct still_det {
 		.max_batch_window = MAX_BATCH_WIN,                         \
 		.min_batch_size = MIN_BATCH_SIZE,                          \
 		.window_start_time = 0,                                    \
-		.acc_x = 0.0f,                                             \
-		.acc_y = 0.0f,                                             \
-		.acc_z = 0.0f,                                             \
-		.acc_xx = 0.0f,                                            \
-		.acc_yy = 0.0f,                                            \
-		.acc_zz = 0.0f,                                            \
-		.mean_x = 0.0f,                                            \
-		.mean_y = 0.0f,                                            \
-		.mean_z = 0.0f,                                            \
 	})
 
 /**
@@ -172,6 +172,48 @@ int system_add_jump_tag(uint16_t tag, int version, int size, const void *data);
  */
 const uint8_t *system_get_jump_tag(uint16_t tag, int *version, int *size);
 
+#ifdef CONFIG_SYSJUMP_STATE
+/**
+ * Preserve a driver's state across a jump between images, with a CRC.
+ *
+ * This may ONLY be called from within a HOOK_SYSJUMP handler.
+ *
+ * @param tag		Data type
+ * @param version	State layout version
+ * @param size		Size of the state; must be less than 255 bytes.
+ * @param data		State to save
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+int system_add_jump_state(uint16_t tag, int version, int size,
+			  const void *data);
+
+/**
+ * Restore a state saved by the previous image's system_add_jump_state().
+ *
+ * Nothing is copied unless the state exists and its version, size and CRC
+ * all match: the caller must then probe the hardware as after a reset.
+ *
+ * @param tag		Data type
+ * @param version	Expected layout version
+ * @param size		Size of the state
+ * @param data		Buffer receiving the state
+ * @return EC_SUCCESS if restored, or non-zero if error.
+ */
+int system_get_jump_state(uint16_t tag, int version, int size, void *data);
+#else
+static inline int system_add_jump_state(uint16_t tag, int version, int size,
+					const void *data)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+
+static inline int system_get_jump_state(uint16_t tag, int version, int size,
+					void *data)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+#endif
+
 /**
  * Return the address just past the last usable byte in RAM.
  */
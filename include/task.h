@@ -133,6 +133,14 @@ static inline void task_wake(task_id_t tskid)
  */
 task_id_t task_get_current(void);
 
+/**
+ * Return the time spent running a task, in us.
+ *
+ * The running task is billed at its next switch or interrupt, so the value
+ * may lag behind by the current time slice.  Only with CONFIG_TASK_PROFILING.
+ */
+uint64_t task_get_runtime(task_id_t tskid);
+
 /**
  * Return a pointer to the bitmap of events of the task.
  */
@@ -183,6 +191,20 @@ void task_print_list(void);
  */
 const char *task_get_name(task_id_t tskid);
 
+/**
+ * Get the stack of a task.
+ *
+ * Only implemented on cortex-m and cortex-m0.  May be called from the panic
+ * handler.
+ *
+ * @param tskid		Task ID.
+ * @param stack		Set to the lowest address of the stack.
+ * @param sp		Set to the stack pointer saved when the task was last
+ *			switched out.
+ * @return the size of the stack in bytes.
+ */
+int task_get_stack(task_id_t tskid, uint32_t **stack, uint32_t *sp);
+
 #ifdef CONFIG_TASK_PROFILING
 /**
  * Start tracking an interrupt.
@@ -325,11 +347,27 @@ int task_reset(task_id_t id, int wait);
  */
 void task_clear_pending_irq(int irq);
 
+/* Number of 32-bit words in a bitmap with one bit per task */
+#define TASK_BITMAP_WORDS (((int)TASK_ID_COUNT + 31) / 32)
+
 struct mutex {
 	uint32_t lock;
-	uint32_t waiters;
+	uint32_t waiters[TASK_BITMAP_WORDS];
+#ifdef CONFIG_MUTEX_PRIORITY_INHERIT
+	uint32_t flags;		/* MUTEX_FLAG_* */
+#endif
+#ifdef CONFIG_MUTEX_STATS
+	uint32_t contended;	/* Number of mutex_lock() calls which waited */
+	uint32_t max_block_us;	/* Longest time a task waited for the lock */
+#endif
 };
 
+/*
+ * The task holding the mutex is scheduled in place of higher priority tasks
+ * which are blocked on it.
+ */
+#define MUTEX_FLAG_PRIORITY_INHERIT BIT(0)
+
 /**
  * Lock a mutex.
  *
@@ -0,0 +1,105 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Bitmaps with one bit per task, for any number of tasks */
+
+#ifndef __CROS_EC_TASK_BITMAP_H
+#define __CROS_EC_TASK_BITMAP_H
+
+#include "atomic.h"
+#include "common.h"
+#include "task.h"
+
+#define TASK_BITMAP_WORD(id)	((id) / 32)
+#define TASK_BITMAP_BIT(id)	BIT((id) % 32)
+
+static inline int task_bitmap_test(const uint32_t *map, task_id_t id)
+{
+	return !!(map[TASK_BITMAP_WORD(id)] & TASK_BITMAP_BIT(id));
+}
+
+/* Set the bit of task |id|.  Safe against interrupts. */
+static inline void task_bitmap_set(uint32_t *map, task_id_t id)
+{
+	deprecated_atomic_or(&map[TASK_BITMAP_WORD(id)], TASK_BITMAP_BIT(id));
+}
+
+/* Clear the bit of task |id|.  Safe against interrupts. */
+static inline void task_bitmap_clear(uint32_t *map, task_id_t id)
+{
+	deprecated_atomic_clear_bits(&map[TASK_BITMAP_WORD(id)],
+				     TASK_BITMAP_BIT(id));
+}
+
+/* Return the highest task ID set in |map|, or -1 if it is empty. */
+static inline int task_bitmap_fls(const uint32_t *map)
+{
+	int w;
+
+	for (w = TASK_BITMAP_WORDS - 1; w >= 0; w--)
+		if (map[w])
+			return w * 32 + __fls(map[w]);
+
+	return -1;
+}
+
+/*
+ * Ready queue: a task bitmap plus a summary word, where bit w of the summary
+ * is set whenever word w of the bitmap may be non-zero.  Finding the highest
+ * priority ready task then takes two __fls() rather than a scan of all the
+ * words, however many tasks there are.
+ *
+ * Bits are set in the word first and then in the summary, so a summary bit
+ * is never missing for a non-empty word.  Clearing a task leaves the summary
+ * bit behind; task_queue_fls() drops stale ones, so it must not be preempted
+ * by anything which clears bits.  The scheduler only calls it with
+ * interrupts masked.
+ */
+struct task_queue {
+	uint32_t summary;
+	uint32_t map[TASK_BITMAP_WORDS];
+};
+
+BUILD_ASSERT(TASK_BITMAP_WORDS <= 32);
+
+static inline void task_queue_set(struct task_queue *q, task_id_t id)
+{
+	task_bitmap_set(q->map, id);
+	if (TASK_BITMAP_WORDS > 1)
+		deprecated_atomic_or(&q->summary, BIT(TASK_BITMAP_WORD(id)));
+}
+
+static inline void task_queue_clear(struct task_queue *q, task_id_t id)
+{
+	task_bitmap_clear(q->map, id);
+}
+
+/*
+ * Return the highest task ID set in both |q| and |mask|, or -1 if there is
+ * none.  Called with interrupts masked.
+ */
+static inline int task_queue_fls(struct task_queue *q, const uint32_t *mask)
+{
+	uint32_t summary;
+
+	if (TASK_BITMAP_WORDS == 1)
+		return q->map[0] & mask[0] ? __fls(q->map[0] & mask[0]) : -1;
+
+	summary = q->summary;
+	while (summary) {
+		int w = __fls(summary);
+		uint32_t bits = q->map[w] & mask[w];
+
+		if (bits)
+			return w * 32 + __fls(bits);
+		if (!q->map[w])
+			q->summary &= ~BIT(w);
+		summary &= ~BIT(w);
+	}
+
+	return -1;
+}
+
+#endif  /* __CROS_EC_TASK_BITMAP_H */
@@ -57,4 +57,18 @@ extern const struct temp_sensor_t temp_sensors[];
  */
 int temp_sensor_read(enum temp_sensor_id id, int *temp_ptr);
 
+/**
+ * Get the temperature (in degrees K) sampled for the current HOOK_SECOND pass.
+ *
+ * The first call in a pass reads the sensor with temp_sensor_read(), later
+ * calls return the same result, so periodic consumers don't read each sensor
+ * again.
+ *
+ * @param id		Sensor ID
+ * @param temp_ptr	Destination for temperature
+ *
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+int temp_sensor_read_sample(enum temp_sensor_id id, int *temp_ptr);
+
 #endif  /* __CROS_EC_TEMP_SENSOR_H */
@@ -163,6 +163,22 @@ int test_get_error_count(void);
 int test_send_host_command(int command, int version, const void *params,
 			   int params_size, void *resp, int resp_size);
 
+/*
+ * Returns a timestamp in ns for benchmarks. On the emulator this is the host
+ * clock, since get_time() there only ticks when it is read. On cortex-m and
+ * riscv-rv32i devices it is derived from the core cycle counter (DWT CYCCNT,
+ * mcycle), for sub-microsecond resolution.
+ */
+uint64_t test_bench_now_ns(void);
+
+/*
+ * Reports the time taken by |ops| runs of the benchmark |name|, as a line
+ * "BENCH {json}" that util/run_host_test --bench and
+ * test/run_device_tests.py --bench collect. Device builds also report the
+ * equivalent number of core cycles.
+ */
+void test_bench_report(const char *name, int ops, uint64_t ns);
+
 /* Optionally defined interrupt generator entry point */
 void interrupt_generator(void);
 
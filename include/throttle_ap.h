@@ -32,6 +32,7 @@ enum throttle_sources {
 	THROTTLE_SRC_THERMAL = 0,
 	THROTTLE_SRC_BAT_DISCHG_CURRENT,
 	THROTTLE_SRC_BAT_VOLTAGE,
+	THROTTLE_SRC_FAST_INPUT,
 };
 
 /**
@@ -46,7 +47,8 @@ enum throttle_sources {
  */
 #if defined(CONFIG_THROTTLE_AP) || \
 	defined(CONFIG_THROTTLE_AP_ON_BAT_DISCHG_CURRENT) || \
-	defined(CONFIG_THROTTLE_AP_ON_BAT_VOLTAGE)
+	defined(CONFIG_THROTTLE_AP_ON_BAT_VOLTAGE) || \
+	defined(CONFIG_THROTTLE_AP_FAST_INPUT)
 
 void throttle_ap(enum throttle_level level,
 		 enum throttle_type type,
@@ -65,6 +67,18 @@ void throttle_ap(enum throttle_level level,
  */
 void throttle_ap_prochot_input_interrupt(enum gpio_signal signal);
 
+/**
+ * Interrupt handler for a fast throttle input, see
+ * CONFIG_THROTTLE_AP_FAST_INPUT. Asserting the input hard throttles the CPU
+ * before the handler returns. It is released once the input is deasserted and
+ * no other source wants hard throttling.
+ *
+ * @param signal    GPIO signal connected to the fast throttle input. Active
+ *                  high unless CONFIG_THROTTLE_AP_FAST_INPUT_ACTIVE_LOW is
+ *                  defined.
+ */
+void throttle_ap_fast_input_interrupt(enum gpio_signal signal);
+
 #else
 static inline void throttle_ap(enum throttle_level level,
 			       enum throttle_type type,
@@ -0,0 +1,42 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Tracepoints of the EC subsystems, read with EC_CMD_TRACEPOINTS */
+
+#ifndef __CROS_EC_TRACEPOINT_H
+#define __CROS_EC_TRACEPOINT_H
+
+#include "common.h"
+#include "ec_commands.h"
+
+/* Categories recorded, BIT(enum ec_tracepoint_category) */
+extern uint32_t tracepoint_mask;
+
+/**
+ * Record an event in the tracepoint ring.  Use TRACEPOINT() instead.
+ *
+ * @param id		enum ec_tracepoint_id
+ * @param arg0		First tracepoint specific value
+ * @param arg1		Second tracepoint specific value
+ */
+void tracepoint_record(enum ec_tracepoint_id id, uint32_t arg0,
+		       uint32_t arg1);
+
+/*
+ * Record a tracepoint.  The test on the ID is resolved at build time, so a
+ * tracepoint is only left in the code when CONFIG_TRACEPOINTS is set and its
+ * category is in CONFIG_TRACEPOINT_CATEGORIES.  The arguments are only
+ * evaluated when the category is being recorded.  Safe in interrupt context.
+ */
+#define TRACEPOINT(id, arg0, arg1)					\
+	do {								\
+		if (IS_ENABLED(CONFIG_TRACEPOINTS) &&			\
+		    (CONFIG_TRACEPOINT_CATEGORIES &			\
+		     BIT(EC_TRACEPOINT_CAT(id))) &&			\
+		    (tracepoint_mask & BIT(EC_TRACEPOINT_CAT(id))))	\
+			tracepoint_record(id, arg0, arg1);		\
+	} while (0)
+
+#endif /* __CROS_EC_TRACEPOINT_H */
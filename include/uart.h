@@ -84,6 +84,22 @@ int uart_printf(const char *format, ...);
  */
 int uart_vprintf(const char *format, va_list args);
 
+/**
+ * Send a token record for formatted output to the UART.
+ *
+ * The record is the output of vfntokenize(), framed by UART_TOKEN_START and
+ * UART_TOKEN_END.  Bytes of the record which collide with the framing are
+ * sent as UART_TOKEN_ESC followed by the byte XOR 0x20.
+ *
+ * @param flags		PRINTF_TOKEN_* flags
+ * @return EC_SUCCESS, or non-zero if output was truncated.
+ */
+int uart_vtokenize(int flags, const char *format, va_list args);
+
+#define UART_TOKEN_ESC 0x1d
+#define UART_TOKEN_START 0x1e
+#define UART_TOKEN_END 0x1f
+
 /**
  * Flush output.  Blocks until UART has transmitted all output.
  */
@@ -223,6 +239,17 @@ int uart_buffer_empty(void);
  */
 int uart_buffer_full(void);
 
+/**
+ * Copy the most recent output in the UART transmit buffer.
+ *
+ * Doesn't take locks, so it may be called from the panic handler.
+ *
+ * @param dest	Destination buffer.
+ * @param size	Size of the destination buffer.
+ * @return the number of bytes copied.
+ */
+int uart_buffer_copy_tail(char *dest, int size);
+
 /**
  * Disable the EC console UART and convert the UART RX pin to a generic GPIO
  * with an edge detect interrupt.
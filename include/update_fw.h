@@ -169,6 +169,8 @@ enum update_extra_command {
 	UPDATE_EXTRA_CMD_TOUCHPAD_DEBUG = 8,
 	UPDATE_EXTRA_CMD_CONSOLE_READ_INIT = 9,
 	UPDATE_EXTRA_CMD_CONSOLE_READ_NEXT = 10,
+	UPDATE_EXTRA_CMD_HASH_REGION = 11,
+	UPDATE_EXTRA_CMD_PARTIAL_UPDATE = 12,
 };
 
 /*
@@ -193,6 +195,25 @@ struct pair_challenge_response {
 	uint8_t authenticator[16];
 } __packed;
 
+/*
+ * Hash region request (from host): SHA-256 of <size> bytes of the section
+ * to be updated, starting at flash offset <offset>.  Both are big endian.
+ */
+struct update_hash_region {
+	uint32_t offset;
+	uint32_t size;
+} __packed;
+
+/*
+ * Hash region response (from device).
+ */
+struct update_hash_region_response {
+	uint8_t status; /* = EC_RES_SUCCESS */
+	uint8_t reserved[3];
+	uint32_t erase_size; /* Flash erase block size, big endian */
+	uint8_t digest[32]; /* SHA-256 of the region */
+} __packed;
+
 struct touchpad_info {
 	uint8_t status; /* = EC_RES_SUCCESS */
 	uint8_t reserved; /* padding */
@@ -242,6 +263,25 @@ void fw_update_command_handler(void *body,
 /* Used to tell fw update the update ran successfully and is finished */
 void fw_update_complete(void);
 
+/**
+ * Hash a region of the section to be updated.
+ *
+ * @param offset	Flash offset of the region
+ * @param size		Size of the region in bytes
+ * @param digest	Filled in with the SHA-256 of the region
+ *
+ * @return UPDATE_SUCCESS, or UPDATE_BAD_ADDR if the region is not inside the
+ * section to be updated.
+ */
+int fw_update_hash_region(uint32_t offset, uint32_t size, uint8_t *digest);
+
+/*
+ * Make the next update session erase each flash erase block when its first
+ * PDU arrives, instead of erasing the whole section at the first PDU.  Blocks
+ * the host doesn't send keep their contents.
+ */
+void fw_update_partial(void);
+
 /* Verify integrity of the PDU received. */
 int update_pdu_valid(struct update_command *cmd_body, size_t cmd_size);
 
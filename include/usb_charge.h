@@ -86,6 +86,15 @@ int usb_charge_set_mode(int usb_port_id, enum usb_charge_mode mode,
 #define TASK_ID_TO_USB_CHG_PORT(id) 0
 #endif  /* HAS_TASK_USB_CHG_P0 */
 
+/**
+ * Send USB_CHG_EVENT_* events to the USB charger task of a port, or to the
+ * single USB_CHG task with CONFIG_USB_CHARGER_SINGLE_TASK.
+ *
+ * @param port  Port number.
+ * @param event Events to send.
+ */
+void usb_charger_task_set_event(int port, uint8_t event);
+
 /**
  * Returns true if the passed port is a power source.
  *
@@ -105,6 +114,13 @@ struct bc12_drv {
 
 	/* BC1.2 detection task for this chip */
 	void (*usb_charger_task)(int port);
+	/*
+	 * The same task split for CONFIG_USB_CHARGER_SINGLE_TASK: set up the
+	 * port, then handle USB_CHG_EVENT_* events for it, without blocking
+	 * the other ports for long.
+	 */
+	void (*usb_charger_task_init)(int port);
+	void (*usb_charger_task_event)(int port, uint32_t evt);
 	/* Configure USB data switches on type-C port */
 	void (*set_switches)(int port, enum usb_switch setting);
 	/* Check if ramping is allowed for given supplier */
@@ -96,6 +96,19 @@
  *
  *     read payload: Depends on the buffer size and implementation. Length will
  *             match requested read count
+ *
+ * Batches:
+ *   If the most significant bit of addr is set (USB_I2C_ADDR_FLAG_MORE),
+ *   another command follows the write payload, in the same form, and is
+ *   executed after this one. The last command of the batch has the bit
+ *   clear. The response is the concatenation of the commands' responses,
+ *   each with its own status and read payload of the requested read count
+ *   (zeros if the command failed). Reads in a batch are limited to
+ *   USB_I2C_BATCH_MAX_READ_COUNT bytes per command, the batch itself to
+ *   CONFIG_USB_I2C_MAX_WRITE_COUNT + 4 bytes and its response to
+ *   CONFIG_USB_I2C_MAX_READ_COUNT + 4 bytes. Firmware without batches
+ *   ignores the bit and fails the whole batch with a write count error,
+ *   which lets the host detect batch support.
  */
 
 enum usb_i2c_error {
@@ -111,6 +124,10 @@ enum usb_i2c_error {
 	USB_I2C_UNKNOWN_ERROR       = 0x8000,
 };
 
+/* In the addr byte: another command follows in the same batch. */
+#define USB_I2C_ADDR_FLAG_MORE 0x80
+#define USB_I2C_BATCH_MAX_READ_COUNT 32
+
 
 #define USB_I2C_WRITE_BUFFER (CONFIG_USB_I2C_MAX_WRITE_COUNT + 4)
 /* If read payload is larger or equal to 128 bytes, header contains rc1 */
@@ -201,6 +218,13 @@ extern struct consumer_ops const usb_i2c_consumer_ops;
  */
 void usb_i2c_deferred(struct usb_i2c_config const *config);
 
+/*
+ * Task handling the I2C requests instead of the deferred callback, when the
+ * board declares a USB_I2C task, so that they don't wait behind the other
+ * deferred functions.
+ */
+void usb_i2c_task(void *u);
+
 /*
  * These functions should be implemented by the board to provide any board
  * specific operations required to enable or disable access to the I2C device,
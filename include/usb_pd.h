@@ -231,6 +231,16 @@ enum pd_rx_errors {
 #define PD_T_SYSJUMP              (1000*MSEC) /* 1s */
 #define PD_T_PR_SWAP_WAIT          (100*MSEC) /* tPRSwapWait 100ms */
 
+/*
+ * TCPC low power mode entry and exit policy, shared by TCPMv1 and TCPMv2.
+ *
+ * 100 ms is enough time for any TCPC transaction to complete. Some TCPCs
+ * require extra time before the CC_STATUS register is updated when exiting
+ * low power mode.
+ */
+#define PD_LPM_DEBOUNCE_US (100 * MSEC)
+#define PD_LPM_EXIT_DEBOUNCE_US CONFIG_USB_PD_TCPC_LPM_EXIT_DEBOUNCE
+
 /* number of edges and time window to detect CC line is not idle */
 #define PD_RX_TRANSITION_COUNT  3
 #define PD_RX_TRANSITION_WINDOW 20 /* between 12us and 20us */
@@ -1288,6 +1298,19 @@ enum pd_msg_type {
 /** Schedules the interrupt handler for the TCPC on a high priority task. */
 void schedule_deferred_pd_interrupt(int port);
 
+/**
+ * Schedules the interrupt handler for the PPC on the same task as the TCPC
+ * one, ahead of it.  Only with CONFIG_USB_PD_INT_DISPATCH.
+ */
+void schedule_deferred_ppc_interrupt(int port);
+
+/**
+ * Schedules BC1.2 detection on the USB charger task of the port once the
+ * pending PPC and TCPC interrupts are handled.  Only with
+ * CONFIG_USB_PD_INT_DISPATCH.
+ */
+void schedule_deferred_bc12_interrupt(int port);
+
 /**
  * Get current PD Revision
  *
@@ -63,4 +63,32 @@ void dpm_vdm_naked(int port, enum tcpm_transmit_type type, uint16_t svid,
  */
 void dpm_run(int port);
 
+/*
+ * Returns true if dpm_run() has nothing to do until the data role, the chipset
+ * state or the mode requests change.
+ *
+ * @param port USB-C port number
+ */
+bool dpm_is_idle(int port);
+
+/*
+ * Looks up the just-received Discover Identity response in the discovery
+ * cache. On a hit, the cached SVIDs and modes are copied into the port's
+ * discovery data and SVID discovery is marked complete.
+ *
+ * @param port USB-C port number
+ * @param type Transmit type (SOP, SOP') of the identity
+ * @return true if discovery was restored from the cache
+ */
+bool dpm_discovery_cache_restore(int port, enum tcpm_transmit_type type);
+
+/*
+ * Saves the port's discovery results in the discovery cache, if identity,
+ * SVID and mode discovery have all completed.
+ *
+ * @param port USB-C port number
+ * @param type Transmit type (SOP, SOP') of the discovery results
+ */
+void dpm_discovery_cache_save(int port, enum tcpm_transmit_type type);
+
 #endif  /* __CROS_EC_USB_DPM_H */
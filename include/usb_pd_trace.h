@@ -0,0 +1,42 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* USB PD message and state machine trace, read with EC_CMD_PD_TRACE */
+
+#ifndef __CROS_EC_USB_PD_TRACE_H
+#define __CROS_EC_USB_PD_TRACE_H
+
+#include "common.h"
+#include "ec_commands.h"
+
+#ifdef CONFIG_USB_PD_TRACE
+/**
+ * Record a PD message sent or received.
+ *
+ * @param port USB-C port number
+ * @param type EC_PD_TRACE_RX or EC_PD_TRACE_TX
+ * @param sop SOP* type of the message
+ * @param header Message header
+ * @param data Data objects, PD_HEADER_CNT(header) of them
+ */
+void pd_trace_msg(int port, enum ec_pd_trace_type type, int sop,
+		  uint16_t header, const uint32_t *data);
+
+/**
+ * Record a state machine transition.
+ *
+ * @param port USB-C port number
+ * @param sm State machine
+ * @param state New state, as numbered in that state machine
+ */
+void pd_trace_state(int port, enum ec_pd_trace_sm sm, int state);
+#else
+static inline void pd_trace_msg(int port, enum ec_pd_trace_type type, int sop,
+				uint16_t header, const uint32_t *data) { }
+static inline void pd_trace_state(int port, enum ec_pd_trace_sm sm,
+				  int state) { }
+#endif
+
+#endif /* __CROS_EC_USB_PD_TRACE_H */
@@ -35,6 +35,9 @@ struct usb_state {
 
 typedef const struct usb_state *usb_state_ptr;
 
+/* Max number of levels in a state hierarchy, including the root state */
+#define USB_SM_MAX_DEPTH 8
+
 /* Defines the current context of the usb statemachine. */
 struct sm_ctx {
 	usb_state_ptr current;
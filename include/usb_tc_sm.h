@@ -331,6 +331,27 @@ void tc_start_event_loop(int port);
  */
 void tc_pause_event_loop(int port);
 
+/* State machines run by the USB-C task, see usbc_task_idle() */
+enum usbc_task_sm {
+	USBC_TASK_SM_TC,
+	USBC_TASK_SM_PE,
+	USBC_TASK_SM_PRL,
+};
+
+/**
+ * Tell the USB-C task that a state machine has nothing to do on this pass
+ * until its next event or the given deadline. With CONFIG_USBC_TASK_IDLE_WAIT,
+ * the task sleeps until the earliest deadline once all the running state
+ * machines told so for two passes in a row.
+ *
+ * This should only be called from the PD task.
+ *
+ * @param port USB-C port number
+ * @param sm State machine
+ * @param deadline Time (us) to run again at, or all ones for no deadline
+ */
+void usbc_task_idle(int port, enum usbc_task_sm sm, uint64_t deadline);
+
 /**
  * Allow system to override the control of TrySrc
  *
@@ -152,6 +152,14 @@ struct ppc_drv {
 	 * @return EC_SUCCESS on success, error otherwise.
 	 */
 	int (*enter_low_power_mode)(int port);
+
+	/**
+	 * Optional method to service the interrupt the PPC signaled, called
+	 * from the PD interrupt task with CONFIG_USB_PD_INT_DISPATCH.
+	 *
+	 * @param port: The Type-C port number.
+	 */
+	void (*handle_interrupt)(int port);
 };
 
 struct ppc_config_t {
@@ -321,6 +329,14 @@ void board_overcurrent_event(int port, int is_overcurrented);
  */
 int ppc_enter_low_power_mode(int port);
 
+/**
+ * Service the interrupt the PPC of a port signaled.  Called from the PD
+ * interrupt task with CONFIG_USB_PD_INT_DISPATCH.
+ *
+ * @param port: The Type-C port number.
+ */
+void ppc_handle_interrupt(int port);
+
 /**
  * Board specific callback to check if the PPC interrupt is still asserted
  *
@@ -164,6 +164,27 @@ int safe_memcmp(const void *s1, const void *s2, size_t len);
  */
 int uint64divmod(uint64_t *v, int by);
 
+/**
+ * Unsigned 32-bit division by the constants that dominate time and number
+ * formatting, done as a multiply by the reciprocal. The results are exact for
+ * every 32-bit n; cores without a divide instruction (cortex-m0) would
+ * otherwise call into the software division routines.
+ */
+static inline uint32_t udiv10(uint32_t n)
+{
+	return ((uint64_t)n * 0xcccccccd) >> 35;
+}
+
+static inline uint32_t udiv1000(uint32_t n)
+{
+	return ((uint64_t)n * 0x10624dd3) >> 38;
+}
+
+static inline uint32_t udiv1000000(uint32_t n)
+{
+	return ((uint64_t)n * 0x431bde83) >> 50;
+}
+
 /**
  * Get-and-clear next bit from mask.
  *
@@ -287,6 +308,15 @@ static inline uint64_t mula32(uint32_t a, uint32_t b, uint32_t c)
 	return ret;
 }
 
+#if defined(__arm__) && defined(__ARM_FEATURE_DSP)
+/* ARMv7E-M does this in one instruction, which GCC doesn't use. */
+static inline uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	__asm__("umaal %0, %1, %2, %3" : "+r"(c), "+r"(d) : "r"(a), "r"(b));
+
+	return ((uint64_t)d << 32) | c;
+}
+#else
 static inline uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 {
 	uint64_t ret = a;
@@ -298,6 +328,7 @@ static inline uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 	return ret;
 }
 #endif
+#endif
 
 /**
  * Set enable bit(s) in register and wait for ready bit(s)
@@ -37,6 +37,15 @@ int vboot_get_rw_hash(const uint8_t **dst);
  */
 int vboot_hash_invalidate(int offset, int size);
 
+/**
+ * Drop the saved hash checkpoints past the start of a region written to
+ * flash, without invalidating the hash.
+ *
+ * @param offset	Region start offset in flash
+ * @param size		Size of region in bytes
+ */
+void vboot_hash_trim_checkpoints(int offset, int size);
+
 /**
  * Get vboot progress status.
  *
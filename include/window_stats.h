@@ -0,0 +1,59 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Mean and variance of a window of 3 axis samples */
+
+#ifndef __CROS_EC_WINDOW_STATS_H
+#define __CROS_EC_WINDOW_STATS_H
+
+#include "common.h"
+#include "math_util.h"
+#include "stdbool.h"
+#include "vec3.h"
+
+/*
+ * One-pass accumulators for the mean and variance of a window.  The sums are
+ * taken about an assumed mean (en.wikipedia.org/wiki/assumed_mean), which
+ * keeps them small without the per-sample division of Welford's method.
+ * window_stats_reset() assumes a mean of zero, i.e. plain sums.
+ */
+struct window_stats {
+	/** Number of samples in the window. */
+	uint32_t num_samples;
+
+	/** Value subtracted from every sample before it is accumulated. */
+	fpv3_t assumed_mean;
+
+	/** Sums of (x - assumed_mean) and of (x - assumed_mean)^2. */
+	fpv3_t sum;
+	fpv3_t sum_sq;
+};
+
+/** Empty the window and accumulate plain sums. */
+void window_stats_reset(struct window_stats *stats);
+
+/**
+ * Empty the window and accumulate about an assumed mean of (x, y, z),
+ * typically the first sample of the window.
+ */
+void window_stats_center(struct window_stats *stats, fp_t x, fp_t y, fp_t z);
+
+/** Add a sample to the window. */
+void window_stats_add(struct window_stats *stats, fp_t x, fp_t y, fp_t z);
+
+/**
+ * Compute the mean and variance of the window.
+ *
+ * @param sample_var True for the sample variance (divided by n - 1), false
+ *                   for the population variance (divided by n).
+ * @param mean Mean of the window, or NULL if not needed.
+ * @param var Variance of the window.
+ * @return False, leaving mean and var alone, if the window has too few
+ *         samples.
+ */
+bool window_stats_compute(const struct window_stats *stats, bool sample_var,
+			  fpv3_t mean, fpv3_t var);
+
+#endif /* __CROS_EC_WINDOW_STATS_H */
@@ -6,6 +6,7 @@
 /* Common functionality across all chipsets */
 
 #include "battery.h"
+#include "boot_trace.h"
 #include "charge_state.h"
 #include "chipset.h"
 #include "common.h"
@@ -22,6 +23,7 @@
 #include "system.h"
 #include "task.h"
 #include "timer.h"
+#include "tracepoint.h"
 #include "util.h"
 
 /* Console output macros */
@@ -178,6 +180,105 @@ int power_has_signals(uint32_t want)
 	return 0;
 }
 
+#ifdef CONFIG_POWER_TRANSITION_LOG
+/* Host visible id of each enum power_state, see state_names[] */
+static const uint8_t state_log_ids[] = {
+	EC_POWER_TRANS_G3,
+	EC_POWER_TRANS_S5,
+	EC_POWER_TRANS_S3,
+	EC_POWER_TRANS_S0,
+#ifdef CONFIG_POWER_S0IX
+	EC_POWER_TRANS_S0IX,
+#endif
+	EC_POWER_TRANS_G3S5,
+	EC_POWER_TRANS_S5S3,
+	EC_POWER_TRANS_S3S0,
+	EC_POWER_TRANS_S0S3,
+	EC_POWER_TRANS_S3S5,
+	EC_POWER_TRANS_S5G3,
+#ifdef CONFIG_POWER_S0IX
+	EC_POWER_TRANS_S0IXS0,
+	EC_POWER_TRANS_S0S0IX,
+#endif
+};
+BUILD_ASSERT(ARRAY_SIZE(state_log_ids) == ARRAY_SIZE(state_names));
+
+static struct ec_power_transition_entry
+	trans_log[CONFIG_POWER_TRANSITION_LOG_ENTRIES];
+static uint32_t trans_log_seq;		/* Sequence number of the next entry */
+static uint32_t state_enter_time;	/* When did we enter the state? */
+static struct mutex trans_log_lock;
+
+static void trans_log_add(enum ec_power_transition_type type, uint32_t start,
+			  uint32_t data, uint8_t flags)
+{
+	struct ec_power_transition_entry *e;
+	uint32_t now = get_time().le.lo;
+
+	mutex_lock(&trans_log_lock);
+	e = trans_log + trans_log_seq % ARRAY_SIZE(trans_log);
+	e->time_us = now;
+	e->duration_us = now - start;
+	e->data = data;
+	e->type = type;
+	e->state = state_log_ids[state];
+	e->flags = flags;
+	e->reserved = 0;
+	trans_log_seq++;
+	mutex_unlock(&trans_log_lock);
+}
+
+static void trans_log_state(void)
+{
+	trans_log_add(EC_POWER_TRANS_TYPE_STATE, state_enter_time, 0, 0);
+	state_enter_time = get_time().le.lo;
+}
+
+static void trans_log_wait(uint32_t start, uint32_t mask, int rv)
+{
+	trans_log_add(EC_POWER_TRANS_TYPE_WAIT, start, mask,
+		      rv == EC_ERROR_TIMEOUT ? EC_POWER_TRANS_FLAG_TIMEOUT : 0);
+}
+
+static enum ec_status
+host_command_power_transition_log(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_power_transition_log *p = args->params;
+	struct ec_response_power_transition_log *r = args->response;
+	uint32_t seq = p->seq;
+	uint32_t first;
+	int num, i;
+
+	mutex_lock(&trans_log_lock);
+	first = trans_log_seq > ARRAY_SIZE(trans_log) ?
+		trans_log_seq - ARRAY_SIZE(trans_log) : 0;
+	/* A sequence number from before the last EC reboot restarts. */
+	if (seq < first || seq > trans_log_seq)
+		seq = first;
+
+	num = (args->response_max - sizeof(*r)) / sizeof(r->entries[0]);
+	num = MIN(num, trans_log_seq - seq);
+	for (i = 0; i < num; i++)
+		r->entries[i] = trans_log[(seq + i) % ARRAY_SIZE(trans_log)];
+	mutex_unlock(&trans_log_lock);
+
+	r->seq = seq;
+	r->next_seq = seq + num;
+	r->timestamp = get_time().le.lo;
+	r->num = num;
+	r->reserved = 0;
+
+	args->response_size = sizeof(*r) + num * sizeof(r->entries[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_POWER_TRANSITION_LOG,
+		     host_command_power_transition_log,
+		     EC_VER_MASK(0));
+#else
+static inline void trans_log_state(void) {}
+static inline void trans_log_wait(uint32_t start, uint32_t mask, int rv) {}
+#endif
+
 int power_wait_signals(uint32_t want)
 {
 	int ret = power_wait_signals_timeout(want, DEFAULT_TIMEOUT);
@@ -195,14 +296,20 @@ int power_wait_signals_timeout(uint32_t want, int timeout)
 
 int power_wait_mask_signals_timeout(uint32_t want, uint32_t mask, int timeout)
 {
+	uint32_t start;
+	int rv = EC_SUCCESS;
+
 	in_want = want;
-	if (!mask)
+	if (!mask || (in_signals & mask) == in_want)
 		return EC_SUCCESS;
 
+	/* Only the waits which block are logged. */
+	start = get_time().le.lo;
 	while ((in_signals & mask) != in_want) {
 		if (task_wait_event(timeout) == TASK_EVENT_TIMER) {
 			power_update_signals();
-			return EC_ERROR_TIMEOUT;
+			rv = EC_ERROR_TIMEOUT;
+			break;
 		}
 		/*
 		 * TODO(crosbug.com/p/23772): should really shrink the
@@ -211,7 +318,8 @@ int power_wait_mask_signals_timeout(uint32_t want, uint32_t mask, int timeout)
 		 * longer in the same state we were when we started waiting.
 		 */
 	}
-	return EC_SUCCESS;
+	trans_log_wait(start, mask, rv);
+	return rv;
 }
 
 void power_set_state(enum power_state new_state)
@@ -223,8 +331,12 @@ void power_set_state(enum power_state new_state)
 	/* Print out the RTC value to help correlate EC and kernel logs. */
 	print_system_rtc(CC_CHIPSET);
 
+	trans_log_state();
 	state = new_state;
 
+	boot_trace(state == POWER_S0 ? EC_BOOT_TRACE_AP_ON :
+		   EC_BOOT_TRACE_POWER_STATE, state);
+
 	/*
 	 * Reset want_g3_exit flag here to prevent the situation that if the
 	 * error handler in POWER_S5S3 decides to force shutdown the system and
@@ -651,6 +763,8 @@ void chipset_task(void *u)
 		if (this_in_signals != last_in_signals || state != last_state) {
 			CPRINTS("power state %d = %s, in 0x%04x",
 				state, state_names[state], this_in_signals);
+			TRACEPOINT(EC_TRACEPOINT_CHIPSET_STATE, state,
+				   this_in_signals);
 			if (IS_ENABLED(CONFIG_SEVEN_SEG_DISPLAY))
 				display_7seg_write(SEVEN_SEG_EC_DISPLAY, state);
 			last_in_signals = this_in_signals;
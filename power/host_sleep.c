@@ -105,6 +105,31 @@ void sleep_notify_transition(int check_state, int hook_id)
 	sleep_set_notify(SLEEP_NOTIFY_NONE);
 }
 
+/* Set while the S0ix suspend/resume hooks are notified. */
+static int s0ix_transition;
+
+void sleep_notify_s0ix_transition(int check_state)
+{
+	if (sleep_notify != check_state)
+		return;
+
+	s0ix_transition = 1;
+	if (check_state == SLEEP_NOTIFY_SUSPEND) {
+		hook_notify(HOOK_CHIPSET_SUSPEND);
+		hook_notify(HOOK_CHIPSET_SUSPEND_S0IX);
+	} else {
+		hook_notify(HOOK_CHIPSET_RESUME_S0IX);
+		hook_notify(HOOK_CHIPSET_RESUME);
+	}
+	s0ix_transition = 0;
+	sleep_set_notify(SLEEP_NOTIFY_NONE);
+}
+
+int power_in_s0ix_transition(void)
+{
+	return s0ix_transition;
+}
+
 static uint16_t sleep_signal_timeout;
 static uint32_t sleep_signal_transitions;
 static void (*sleep_timeout_callback)(void);
@@ -198,6 +223,10 @@ void sleep_notify_transition(int check_state, int hook_id)
 {
 }
 
+void sleep_notify_s0ix_transition(int check_state)
+{
+}
+
 void sleep_suspend_transition(void)
 {
 }
@@ -317,8 +317,7 @@ enum power_state common_intel_x86_power_handle_state(enum power_state state)
 				chipset_get_sleep_signal(SYS_SLEEP_S0IX) == 0) {
 			return POWER_S0S0ix;
 		} else {
-			sleep_notify_transition(SLEEP_NOTIFY_RESUME,
-						HOOK_CHIPSET_RESUME);
+			sleep_notify_s0ix_transition(SLEEP_NOTIFY_RESUME);
 #endif
 		}
 
@@ -436,8 +435,7 @@ enum power_state common_intel_x86_power_handle_state(enum power_state state)
 		 * Call hooks only if we haven't notified listeners of S0ix
 		 * suspend.
 		 */
-		sleep_notify_transition(SLEEP_NOTIFY_SUSPEND,
-					HOOK_CHIPSET_SUSPEND);
+		sleep_notify_s0ix_transition(SLEEP_NOTIFY_SUSPEND);
 		sleep_suspend_transition();
 
 		/*
@@ -16,8 +16,10 @@
 
 #include "aes.h"
 #include "aes-gcm.h"
+#include "clock.h"
 #include "console.h"
 #include "common.h"
+#include "printf.h"
 #include "test_util.h"
 #include "timer.h"
 #include "util.h"
@@ -26,6 +28,20 @@
 /* Temporary buffer, to avoid using too much stack space. */
 static uint8_t tmp[512];
 
+/* Size of the messages in the chunked AES-GCM benchmark, about a template */
+#define BENCH_MESSAGE_SIZE 4096
+static uint8_t bench_buf[BENCH_MESSAGE_SIZE];
+
+static void print_speed(const char *name, uint64_t us, uint32_t bytes)
+{
+	/* Hundredths of a cycle per byte */
+	uint32_t cpb = us * (clock_get_freq() / 10000) / bytes;
+
+	ccprintf("%-22s %8lld us %5d.%02d cycles/byte\n", name, (long long)us,
+		 cpb / 100, cpb % 100);
+	cflush();
+}
+
 /*
  * Do encryption, put result in |result|, and compare with |ciphertext|.
  */
@@ -529,7 +545,48 @@ static void test_aes_gcm_speed(void)
 		CRYPTO_gcm128_tag(&ctx, tag, tag_size);
 	}
 	t1 = get_time();
-	ccprintf("AES-GCM duration %lld us\n", (long long)(t1.val - t0.val));
+	print_speed("AES-GCM", t1.val - t0.val, 1000 * plaintext_size);
+}
+
+/*
+ * Encrypt a template-sized message fed in chunks, as when it streams over
+ * the host interface.
+ */
+static void test_aes_gcm_chunked_speed(void)
+{
+	static const int chunk_sizes[] = { 16, 60, 256, BENCH_MESSAGE_SIZE };
+	static const uint8_t key[16] = { 0 };
+	static const uint8_t nonce[12] = { 0 };
+	static AES_KEY aes_key;
+	static GCM128_CONTEXT ctx;
+	uint8_t tag[16];
+	char name[24];
+	timestamp_t t0, t1;
+	int i, j, off;
+
+	for (i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		t0 = get_time();
+		for (j = 0; j < 20; j++) {
+			AES_set_encrypt_key(key, 8 * sizeof(key), &aes_key);
+			CRYPTO_gcm128_init(&ctx, &aes_key,
+					   (block128_f)AES_encrypt, 0);
+			CRYPTO_gcm128_setiv(&ctx, &aes_key, nonce,
+					    sizeof(nonce));
+			for (off = 0; off < BENCH_MESSAGE_SIZE;
+			     off += chunk_sizes[i])
+				CRYPTO_gcm128_encrypt(
+					&ctx, &aes_key, bench_buf + off,
+					bench_buf + off,
+					MIN(chunk_sizes[i],
+					    BENCH_MESSAGE_SIZE - off));
+			CRYPTO_gcm128_tag(&ctx, tag, sizeof(tag));
+		}
+		t1 = get_time();
+		snprintf(name, sizeof(name), "AES-GCM %d B chunks",
+			 chunk_sizes[i]);
+		print_speed(name, t1.val - t0.val, 20 * BENCH_MESSAGE_SIZE);
+		watchdog_reload();
+	}
 }
 
 static int test_aes_raw(const uint8_t *key, int key_size,
@@ -641,7 +698,7 @@ static void test_aes_speed(void)
 	for (i = 0; i < 1000; i++)
 		AES_encrypt(block, block, &aes_key);
 	t1 = get_time();
-	ccprintf("AES duration %lld us\n", (long long)(t1.val - t0.val));
+	print_speed("AES", t1.val - t0.val, 1000 * AES_BLOCK_SIZE);
 }
 
 void run_test(int argc, char **argv)
@@ -656,6 +713,7 @@ void run_test(int argc, char **argv)
 
 	/* do not check result, just as a benchmark */
 	test_aes_gcm_speed();
+	test_aes_gcm_chunked_speed();
 
 	watchdog_reload();
 	RUN_TEST(test_aes_gcm);
@@ -12,6 +12,7 @@
 #include "console.h"
 #include "i2c.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 /* Test state */
@@ -28,8 +29,19 @@ void board_battery_compensate_params(struct batt_params *batt)
 {
 }
 
+/* Let the next battery_get_params() read all the parameters again */
+static void expire_slow_params(void)
+{
+	timestamp_t t = get_time();
+
+	t.val += CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL;
+	force_time(t);
+}
+
 static void reset_and_fail_on(int first, int last)
 {
+	expire_slow_params();
+
 	/* We're not initializing the fake battery, so everything reads zero */
 	memset(&batt, 0, sizeof(typeof(batt)));
 	read_count = write_count = 0;
@@ -90,9 +102,56 @@ static int test_param_failures(void)
 	return EC_SUCCESS;
 }
 
+static int test_slow_params(void)
+{
+	int num_reads;
+
+	/* GIVEN all the parameters just read */
+	reset_and_fail_on(0, 0);
+	sb_write(SB_TEMPERATURE, 2981);
+	battery_get_params(&batt);
+	num_reads = read_count;
+	TEST_EQ(batt.temperature, 2981, "%d");
+
+	/* THEN the slow ones are not read again right away */
+	read_count = 0;
+	sb_write(SB_TEMPERATURE, 3031);
+	battery_get_params(&batt);
+	TEST_LT(read_count, num_reads, "%d");
+	TEST_EQ(batt.temperature, 2981, "%d");
+	TEST_ASSERT(!(batt.flags & BATT_FLAG_BAD_ANY));
+
+	/* THEN an alarm reads them again */
+	read_count = 0;
+	sb_write(SB_BATTERY_STATUS, STATUS_OVERTEMP_ALARM);
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+	TEST_EQ(batt.temperature, 3031, "%d");
+	sb_write(SB_BATTERY_STATUS, 0);
+
+	/* THEN so does a failed read of a fast parameter */
+	battery_get_params(&batt);
+	read_count = 0;
+	fail_on_first = fail_on_last = 1;
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+
+	/* THEN so does the end of the interval */
+	read_count = 0;
+	fail_on_first = fail_on_last = 0;
+	sb_write(SB_TEMPERATURE, 2931);
+	expire_slow_params();
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+	TEST_EQ(batt.temperature, 2931, "%d");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	RUN_TEST(test_param_failures);
+	RUN_TEST(test_slow_params);
 
 	test_print_result();
 }
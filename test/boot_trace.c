@@ -0,0 +1,86 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the boot trace of HOOK_INIT callbacks.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "hooks.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+static void fast_init(void)
+{
+}
+DECLARE_HOOK(HOOK_INIT, fast_init, HOOK_PRIO_DEFAULT);
+
+static void slow_init(void)
+{
+	udelay(CONFIG_BOOT_TRACE_HOOK_BUDGET_US * 2);
+}
+DECLARE_HOOK(HOOK_INIT, slow_init, HOOK_PRIO_DEFAULT + 1);
+
+static uint8_t buf[sizeof(struct ec_response_boot_trace) +
+		   CONFIG_BOOT_TRACE_ENTRIES *
+		   sizeof(struct ec_boot_trace_entry)] __aligned(4);
+
+static const struct ec_boot_trace_entry *
+find_entry(const struct ec_response_boot_trace *r, uint8_t event,
+	   uint32_t data)
+{
+	int i;
+
+	for (i = 0; i < r->num; i++)
+		if (r->entries[i].event == event && r->entries[i].data == data)
+			return r->entries + i;
+	return NULL;
+}
+
+test_static int test_hook_init_trace(void)
+{
+	struct ec_params_boot_trace p = { .offset = 0 };
+	struct ec_response_boot_trace *r = (void *)buf;
+	const struct ec_boot_trace_entry *fast, *slow, *done;
+
+	TEST_EQ(test_send_host_command(EC_CMD_BOOT_TRACE, 0, &p, sizeof(p),
+				       buf, sizeof(buf)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num, r->count, "%d");
+	TEST_EQ(r->hook_budget_us, CONFIG_BOOT_TRACE_HOOK_BUDGET_US, "%d");
+
+	fast = find_entry(r, EC_BOOT_TRACE_HOOK_INIT,
+			  (uint32_t)(uintptr_t)fast_init);
+	slow = find_entry(r, EC_BOOT_TRACE_HOOK_INIT,
+			  (uint32_t)(uintptr_t)slow_init);
+	done = find_entry(r, EC_BOOT_TRACE_HOOK_INIT_DONE, 0);
+	TEST_ASSERT(fast && slow && done);
+
+	/* Only the slow hook is over budget, and hooks run in order. */
+	TEST_EQ(fast->flags, 0, "%d");
+	TEST_EQ(slow->flags, EC_BOOT_TRACE_FLAG_OVER_BUDGET, "%d");
+	TEST_GE(slow->duration_us, CONFIG_BOOT_TRACE_HOOK_BUDGET_US * 2, "%d");
+	TEST_ASSERT(fast < slow && slow < done);
+	TEST_GE(done->time_us - slow->time_us, slow->duration_us, "%d");
+
+	/* Offsets page through the entries. */
+	p.offset = r->count;
+	TEST_EQ(test_send_host_command(EC_CMD_BOOT_TRACE, 0, &p, sizeof(p),
+				       buf, sizeof(buf)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num, 0, "%d");
+	p.offset++;
+	TEST_EQ(test_send_host_command(EC_CMD_BOOT_TRACE, 0, &p, sizeof(p),
+				       buf, sizeof(buf)),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	RUN_TEST(test_hook_init_trace);
+	test_print_result();
+}
@@ -18,22 +18,31 @@ test-list-host += battery_get_params_smart
 test-list-host += bklight_lid
 test-list-host += bklight_passthru
 test-list-host += body_detection
+test-list-host += body_detection_ew
+test-list-host += boot_trace
 test-list-host += button
+test-list-host += calibration_bench
 test-list-host += cbi
 test-list-host += cec
 test-list-host += charge_manager
 test-list-host += charge_manager_drp_charging
 test-list-host += charge_ramp
+test-list-host += charge_ramp_max_step
 test-list-host += compile_time_macros
 test-list-host += console_edit
+test-list-host += core_bench
 test-list-host += crc32
+test-list-host += drbg
 test-list-host += entropy
+test-list-host += event_log
 test-list-host += extpwr_gpio
 test-list-host += fan
 test-list-host += flash
+test-list-host += flash_pstate_log
 test-list-host += float
 test-list-host += fp
 test-list-host += fpsensor
+test-list-host += fpsensor_bench
 test-list-host += fpsensor_crypto
 test-list-host += fpsensor_state
 test-list-host += gyro_cal
@@ -50,18 +59,22 @@ test-list-host += kb_mkbp
 #test-list-host += kb_scan	# crbug.com/976974
 test-list-host += lid_sw
 test-list-host += lightbar
+test-list-host += lz4
 test-list-host += mag_cal
 test-list-host += math_util
 test-list-host += motion_angle
 test-list-host += motion_angle_tablet
 test-list-host += motion_lid
 test-list-host += motion_sense_fifo
+test-list-host += motion_sense_fifo_bench
 test-list-host += mutex
 test-list-host += newton_fit
 test-list-host += online_calibration
+test-list-host += online_calibration_deferred
 test-list-host += pingpong
 test-list-host += power_button
 test-list-host += printf
+test-list-host += printf_bench
 test-list-host += queue
 test-list-host += rsa
 test-list-host += rsa3
@@ -70,11 +83,13 @@ test-list-host += sbs_charging_v2
 test-list-host += sha256
 test-list-host += sha256_unrolled
 test-list-host += shmalloc
+test-list-host += shmalloc_slab
 test-list-host += static_if
 test-list-host += static_if_error
 test-list-host += system
 test-list-host += thermal
 test-list-host += timer_dos
+test-list-host += tracepoint
 test-list-host += uptime
 test-list-host += usb_common
 test-list-host += usb_pd_int
@@ -92,6 +107,7 @@ test-list-host += usb_typec_drp_acc_trysrc
 test-list-host += usb_prl_old
 test-list-host += usb_tcpmv2_tcpci
 test-list-host += usb_prl
+test-list-host += usb_prl_bench
 test-list-host += usb_prl_noextended
 test-list-host += usb_pe_drp_old
 test-list-host += usb_pe_drp_old_noextended
@@ -113,12 +129,19 @@ cov-dont-test = is_enabled_error
 cov-dont-test += static_if_error
 # fpsensor: genhtml looks for build/host/fpsensor/cryptoc/util.c
 cov-dont-test += fpsensor
+# fpsensor_bench: genhtml looks for build/host/fpsensor_bench/cryptoc/util.c
+cov-dont-test += fpsensor_bench
 # fpsensor_crypto: genhtml looks for build/host/fpsensor_crypto/cryptoc/util.c
 cov-dont-test += fpsensor_crypto
 # fpsensor_state: genhtml looks for build/host/fpsensor_state/cryptoc/util.c
 cov-dont-test += fpsensor_state
 cov-test-list-host = $(filter-out $(cov-dont-test), $(test-list-host))
 
+# Emulator benchmarks run by "make benchmark-hosts". They report their results
+# with test_bench_report().
+bench-list-host = calibration_bench core_bench motion_sense_fifo_bench \
+	printf_bench usb_prl_bench utils
+
 accel_cal-y=accel_cal.o
 aes-y=aes.o
 base32-y=base32.o
@@ -126,22 +149,32 @@ battery_get_params_smart-y=battery_get_params_smart.o
 bklight_lid-y=bklight_lid.o
 bklight_passthru-y=bklight_passthru.o
 body_detection-y=body_detection.o body_detection_data_literals.o motion_common.o
+body_detection_ew-y=body_detection.o body_detection_data_literals.o \
+	motion_common.o
+boot_trace-y=boot_trace.o
 button-y=button.o
+calibration_bench-y=calibration_bench.o
 cbi-y=cbi.o
 cec-y=cec.o
 charge_manager-y=charge_manager.o
 charge_manager_drp_charging-y=charge_manager.o
 charge_ramp-y+=charge_ramp.o
+charge_ramp_max_step-y=charge_ramp.o
 compile_time_macros-y=compile_time_macros.o
 console_edit-y=console_edit.o
+core_bench-y=core_bench.o
 crc32-y=crc32.o
+drbg-y=drbg.o
 entropy-y=entropy.o
 extpwr_gpio-y=extpwr_gpio.o
+event_log-y=event_log.o
 fan-y=fan.o
 flash-y=flash.o
+flash_pstate_log-y=flash.o
 flash_physical-y=flash_physical.o
 flash_write_protect-y=flash_write_protect.o
 fpsensor-y=fpsensor.o
+fpsensor_bench-y=fpsensor_bench.o
 fpsensor_crypto-y=fpsensor_crypto.o
 fpsensor_state-y=fpsensor_state.o
 gyro_cal-y=gyro_cal.o
@@ -156,13 +189,16 @@ kb_mkbp-y=kb_mkbp.o
 kb_scan-y=kb_scan.o
 lid_sw-y=lid_sw.o
 lightbar-y=lightbar.o
+lz4-y=lz4.o
 mag_cal-y=mag_cal.o
 math_util-y=math_util.o
 motion_angle-y=motion_angle.o motion_angle_data_literals.o motion_common.o
 motion_angle_tablet-y=motion_angle_tablet.o motion_angle_data_literals_tablet.o motion_common.o
 motion_lid-y=motion_lid.o
 motion_sense_fifo-y=motion_sense_fifo.o
+motion_sense_fifo_bench-y=motion_sense_fifo_bench.o
 online_calibration-y=online_calibration.o
+online_calibration_deferred-y=online_calibration.o
 kasa-y=kasa.o
 mpu-y=mpu.o
 mutex-y=mutex.o
@@ -171,6 +207,7 @@ pingpong-y=pingpong.o
 power_button-y=power_button.o
 powerdemo-y=powerdemo.o
 printf-y=printf.o
+printf_bench-y=printf_bench.o
 queue-y=queue.o
 rollback-y=rollback.o
 rollback_entropy-y=rollback_entropy.o
@@ -183,6 +220,7 @@ sbs_charging_v2-y=sbs_charging_v2.o
 sha256-y=sha256.o
 sha256_unrolled-y=sha256.o
 shmalloc-y=shmalloc.o
+shmalloc_slab-y=shmalloc_slab.o
 static_if-y=static_if.o
 stm32f_rtc-y=stm32f_rtc.o
 stress-y=stress.o
@@ -190,6 +228,7 @@ system-y=system.o
 thermal-y=thermal.o
 timer_calib-y=timer_calib.o
 timer_dos-y=timer_dos.o
+tracepoint-y=tracepoint.o
 uptime-y=uptime.o
 usb_common-y=usb_common_test.o fake_battery.o
 usb_pd_int-y=usb_pd_int.o
@@ -207,6 +246,7 @@ usb_typec_drp_acc_trysrc-y=usb_typec_drp_acc_trysrc.o vpd_api.o \
 	usb_sm_checks.o
 usb_prl_old-y=usb_prl_old.o usb_sm_checks.o fake_usbc.o
 usb_prl-y=usb_prl.o usb_sm_checks.o
+usb_prl_bench-y=usb_prl_bench.o
 usb_prl_noextended-y=usb_prl_noextended.o usb_sm_checks.o fake_usbc.o
 usb_pe_drp_old-y=usb_pe_drp_old.o usb_sm_checks.o fake_usbc.o
 usb_pe_drp_old_noextended-y=usb_pe_drp_old.o usb_sm_checks.o fake_usbc.o
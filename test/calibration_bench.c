@@ -0,0 +1,217 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Benchmark of the online calibration kernels: feeds the stillness detector,
+ * the sphere fits and the accelerometer/magnetometer calibrations with the
+ * same synthetic samples and reports the cost of each sample.
+ */
+
+#include "accel_cal.h"
+#include "clock.h"
+#include "common.h"
+#include "console.h"
+#include "kasa.h"
+#include "mag_cal.h"
+#include "motion_sense.h"
+#include "newton_fit.h"
+#include "stillness_detector.h"
+#include "test_util.h"
+#include "timer.h"
+#include "vec3.h"
+
+struct motion_sensor_t motion_sensors[] = {};
+const unsigned int motion_sensor_count = ARRAY_SIZE(motion_sensors);
+
+#define BENCH_SAMPLES 6000
+
+/* Accelerometer samples, on a sphere of radius 1 g centered at 0.01 g. */
+static const fpv3_t accel_samples[] = {
+	{ FLOAT_TO_FP(1.01f), FLOAT_TO_FP(0.01f), FLOAT_TO_FP(0.01f) },
+	{ FLOAT_TO_FP(-0.99f), FLOAT_TO_FP(0.01f), FLOAT_TO_FP(0.01f) },
+	{ FLOAT_TO_FP(0.01f), FLOAT_TO_FP(1.01f), FLOAT_TO_FP(0.01f) },
+	{ FLOAT_TO_FP(0.01f), FLOAT_TO_FP(-0.99f), FLOAT_TO_FP(0.01f) },
+	{ FLOAT_TO_FP(0.01f), FLOAT_TO_FP(0.01f), FLOAT_TO_FP(1.01f) },
+	{ FLOAT_TO_FP(0.01f), FLOAT_TO_FP(0.01f), FLOAT_TO_FP(-0.99f) },
+	{ FLOAT_TO_FP(0.7171f), FLOAT_TO_FP(0.7171f), FLOAT_TO_FP(0.7171f) },
+	{ FLOAT_TO_FP(-0.6971f), FLOAT_TO_FP(-0.6971f), FLOAT_TO_FP(-0.6971f) },
+};
+
+/* Magnetometer samples, around +/-525 units like a lis2mdl would report. */
+static const intv3_t mag_samples[] = {
+	{ -522, 5, -5 }, { 527, 3, -2 },  { -3, -519, -2 },
+	{ -5, 528, 4 },	 { -5, 0, -524 }, { 4, -2, 524 },
+};
+
+static struct accel_cal_algo algos[] = {
+	{
+		.newton_fit = NEWTON_FIT(8, 1, FLOAT_TO_FP(0.01f),
+					 FLOAT_TO_FP(0.25f),
+					 FLOAT_TO_FP(1.0e-8f), 100),
+	},
+};
+
+static struct accel_cal cal = {
+	.algos = algos,
+	.num_temp_windows = ARRAY_SIZE(algos),
+};
+
+/* Keeps the compiler from dropping the results of pure kernels. */
+static volatile fp_t sink;
+
+/*
+ * Times are taken with test_bench_now_ns(), since the emulator's get_time()
+ * only ticks when it is read.
+ */
+static void print_cost(const char *name, uint64_t ns, int samples)
+{
+	/* Hundredths of a cycle per sample */
+	uint32_t cps = ns * (clock_get_freq() / 10000) / 1000 / samples;
+
+	ccprintf("%-24s %8lld us %7d.%02d cycles/sample\n", name,
+		 (long long)(ns / 1000), cps / 100, cps % 100);
+	cflush();
+	test_bench_report(name, samples, ns);
+}
+
+static const fp_t *accel_sample(int i)
+{
+	return accel_samples[i % ARRAY_SIZE(accel_samples)];
+}
+
+test_static int test_bench_fpv3(void)
+{
+	uint64_t t0;
+	fp_t acc = FLOAT_TO_FP(0.0f);
+	int i;
+
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++)
+		acc += fpv3_dot(accel_sample(i), accel_sample(i + 1));
+	print_cost("fpv3_dot", test_bench_now_ns() - t0, BENCH_SAMPLES);
+
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++)
+		acc += fpv3_norm(accel_sample(i));
+	print_cost("fpv3_norm", test_bench_now_ns() - t0, BENCH_SAMPLES);
+
+	sink = acc;
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_still_det(void)
+{
+	struct still_det still_det =
+		STILL_DET(FLOAT_TO_FP(0.00025f), 800 * MSEC, 1200 * MSEC, 5);
+	uint64_t t0;
+	int i;
+
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++) {
+		const fp_t *v = accel_sample(i / 8);
+
+		still_det_update(&still_det, i * 25 * MSEC, v[X], v[Y], v[Z]);
+	}
+	print_cost("still_det_update", test_bench_now_ns() - t0, BENCH_SAMPLES);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_kasa(void)
+{
+	struct kasa_fit kasa;
+	fpv3_t bias;
+	fp_t radius;
+	uint64_t t0;
+	int i;
+
+	kasa_reset(&kasa);
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++) {
+		const fp_t *v = accel_sample(i);
+
+		kasa_accumulate(&kasa, v[X], v[Y], v[Z]);
+	}
+	print_cost("kasa_accumulate", test_bench_now_ns() - t0, BENCH_SAMPLES);
+
+	kasa_compute(&kasa, bias, &radius);
+	TEST_NEAR(bias[X], FLOAT_TO_FP(0.01f), FLOAT_TO_FP(0.001f), "%f");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_newton_fit(void)
+{
+	struct newton_fit fit = NEWTON_FIT(8, 1, FLOAT_TO_FP(0.01f),
+					   FLOAT_TO_FP(0.25f),
+					   FLOAT_TO_FP(1.0e-8f), 100);
+	fpv3_t bias;
+	fp_t radius;
+	uint64_t t0;
+	int i;
+
+	newton_fit_reset(&fit);
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++) {
+		const fp_t *v = accel_sample(i);
+
+		newton_fit_accumulate(&fit, v[X], v[Y], v[Z]);
+	}
+	print_cost("newton_fit_accumulate", test_bench_now_ns() - t0,
+		   BENCH_SAMPLES);
+
+	t0 = test_bench_now_ns();
+	newton_fit_compute(&fit, bias, &radius);
+	print_cost("newton_fit_compute", test_bench_now_ns() - t0, 1);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_accel_cal(void)
+{
+	uint64_t t0;
+	int i;
+
+	cal.still_det =
+		STILL_DET(FLOAT_TO_FP(0.00025f), 800 * MSEC, 1200 * MSEC, 5);
+	accel_cal_reset(&cal);
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++) {
+		const fp_t *v = accel_sample(i / 8);
+
+		accel_cal_accumulate(&cal, i * 25 * MSEC, v[X], v[Y], v[Z],
+				     FLOAT_TO_FP(21.0f));
+	}
+	print_cost("accel_cal_accumulate", test_bench_now_ns() - t0,
+		   BENCH_SAMPLES);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_mag_cal(void)
+{
+	struct mag_cal_t moc;
+	uint64_t t0;
+	int i;
+
+	init_mag_cal(&moc);
+	t0 = test_bench_now_ns();
+	for (i = 0; i < BENCH_SAMPLES; i++)
+		mag_cal_update(&moc, mag_samples[i % ARRAY_SIZE(mag_samples)]);
+	print_cost("mag_cal_update", test_bench_now_ns() - t0, BENCH_SAMPLES);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	ccprintf("Core clock %d Hz\n", clock_get_freq());
+
+	RUN_TEST(test_bench_fpv3);
+	RUN_TEST(test_bench_still_det);
+	RUN_TEST(test_bench_kasa);
+	RUN_TEST(test_bench_newton_fit);
+	RUN_TEST(test_bench_accel_cal);
+	RUN_TEST(test_bench_mag_cal);
+	test_print_result();
+}
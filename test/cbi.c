@@ -10,6 +10,7 @@
 #include "cros_board_info.h"
 #include "ec_commands.h"
 #include "gpio.h"
+#include "host_command.h"
 #include "i2c.h"
 #include "test_util.h"
 #include "util.h"
@@ -220,6 +221,117 @@ static int test_bad_crc(void)
 	return EC_SUCCESS;
 }
 
+static int set_cbi(enum cbi_data_tag tag, uint32_t value, uint32_t flag)
+{
+	struct {
+		struct ec_params_set_cbi p;
+		uint32_t value;
+	} __packed params = {
+		.p = { .tag = tag, .flag = flag, .size = sizeof(value) },
+		.value = value,
+	};
+
+	return test_send_host_command(EC_CMD_SET_CROS_BOARD_INFO, 0, &params,
+				      sizeof(params), NULL, 0);
+}
+
+static uint8_t read_eeprom_byte(int offset)
+{
+	uint8_t val;
+
+	i2c_read_block(I2C_PORT_EEPROM, I2C_ADDR_EEPROM_FLAGS, offset, &val, 1);
+	return val;
+}
+
+static void write_eeprom_byte(int offset, uint8_t val)
+{
+	i2c_write_block(I2C_PORT_EEPROM, I2C_ADDR_EEPROM_FLAGS, offset, &val,
+			1);
+}
+
+static int test_batched_write(void)
+{
+	uint32_t d32;
+	/* The SSFC value sits at the end, one page after the header */
+	const int ssfc = sizeof(struct cbi_header) + 3 * sizeof(struct cbi_data)
+			 + 2 * sizeof(uint32_t);
+
+	gpio_set_level(GPIO_WP, 0);
+
+	/* Only the last of a batch of sets writes the EEPROM */
+	TEST_EQ(set_cbi(CBI_TAG_SKU_ID, 0x11, CBI_SET_INIT | CBI_SET_NO_SYNC),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(set_cbi(CBI_TAG_MODEL_ID, 0x22, CBI_SET_NO_SYNC),
+		EC_RES_SUCCESS, "%d");
+	cbi_invalidate_cache();
+	TEST_ASSERT(cbi_get_sku_id(&d32) == EC_ERROR_UNKNOWN);
+
+	TEST_EQ(set_cbi(CBI_TAG_SKU_ID, 0x11, CBI_SET_INIT | CBI_SET_NO_SYNC),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(set_cbi(CBI_TAG_MODEL_ID, 0x22, CBI_SET_NO_SYNC),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(set_cbi(CBI_TAG_SSFC, 0x33, 0), EC_RES_SUCCESS, "%d");
+
+	cbi_invalidate_cache();
+	TEST_ASSERT(cbi_get_sku_id(&d32) == EC_SUCCESS);
+	TEST_EQ(d32, 0x11, "0x%x");
+	TEST_ASSERT(cbi_get_model_id(&d32) == EC_SUCCESS);
+	TEST_EQ(d32, 0x22, "0x%x");
+	TEST_ASSERT(cbi_get_ssfc(&d32) == EC_SUCCESS);
+	TEST_EQ(d32, 0x33, "0x%x");
+
+	/*
+	 * Only the pages which changed are rewritten: scribble over the SSFC
+	 * value in the EEPROM, change the SKU ID in the first pages, and the
+	 * scribble survives.
+	 */
+	TEST_EQ(read_eeprom_byte(ssfc), 0x33, "0x%x");
+	write_eeprom_byte(ssfc, 0x44);
+	TEST_EQ(set_cbi(CBI_TAG_SKU_ID, 0x55, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(read_eeprom_byte(ssfc), 0x44, "0x%x");
+
+	/* Its value no longer matches the CRC */
+	cbi_invalidate_cache();
+	TEST_ASSERT(cbi_get_ssfc(&d32) == EC_ERROR_UNKNOWN);
+
+	return EC_SUCCESS;
+}
+
+static int test_lazy_read(void)
+{
+	uint32_t d32;
+	const int model = sizeof(struct cbi_header) + 2 * sizeof(struct cbi_data)
+			  + sizeof(uint32_t);
+
+	gpio_set_level(GPIO_WP, 0);
+
+	TEST_EQ(set_cbi(CBI_TAG_SKU_ID, 0x11, CBI_SET_INIT | CBI_SET_NO_SYNC),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(set_cbi(CBI_TAG_MODEL_ID, 0x22, 0), EC_RES_SUCCESS, "%d");
+
+	/* The first tag is read on its own */
+	cbi_invalidate_cache();
+	TEST_EQ(read_eeprom_byte(model), 0x22, "0x%x");
+	write_eeprom_byte(model, 0x23);
+	TEST_ASSERT(cbi_get_sku_id(&d32) == EC_SUCCESS);
+	TEST_EQ(d32, 0x11, "0x%x");
+
+	/* Reading the rest of the image checks the CRC */
+	TEST_ASSERT(cbi_get_model_id(&d32) == EC_ERROR_UNKNOWN);
+	TEST_ASSERT(cbi_get_sku_id(&d32) == EC_ERROR_UNKNOWN);
+
+	/* A good image reads the same lazily and in full */
+	write_eeprom_byte(model, 0x22);
+	cbi_invalidate_cache();
+	TEST_ASSERT(cbi_get_model_id(&d32) == EC_SUCCESS);
+	TEST_EQ(d32, 0x22, "0x%x");
+	TEST_ASSERT(cbi_get_oem_id(&d32) == EC_ERROR_UNKNOWN);
+	TEST_ASSERT(cbi_get_sku_id(&d32) == EC_SUCCESS);
+	TEST_EQ(d32, 0x11, "0x%x");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	RUN_TEST(test_uint8);
@@ -227,6 +339,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_string);
 	RUN_TEST(test_not_found);
 	RUN_TEST(test_too_large);
+	RUN_TEST(test_batched_write);
+	RUN_TEST(test_lazy_read);
 	RUN_TEST(test_all_tags);
 	RUN_TEST(test_bad_crc);
 
@@ -35,6 +35,7 @@ BUILD_ASSERT(ARRAY_SIZE(supplier_priority) == CHARGE_SUPPLIER_COUNT);
 static unsigned int active_charge_limit = CHARGE_SUPPLIER_NONE;
 static unsigned int active_charge_port = CHARGE_PORT_NONE;
 static unsigned int charge_port_to_reject = CHARGE_PORT_NONE;
+static int charge_limit_updates;
 static int new_power_request[CONFIG_USB_PD_PORT_MAX_COUNT];
 static enum pd_power_role power_role[CONFIG_USB_PD_PORT_MAX_COUNT];
 
@@ -43,6 +44,7 @@ void board_set_charge_limit(int port, int supplier, int charge_ma,
 			    int max_ma, int charge_mv)
 {
 	active_charge_limit = charge_ma;
+	charge_limit_updates++;
 }
 
 __override uint8_t board_get_usb_pd_port_count(void)
@@ -787,6 +789,41 @@ static int test_unknown_dualrole_capability(void)
 	return EC_SUCCESS;
 }
 
+static int test_update_burst(void)
+{
+	struct charge_port_info charge;
+	int i;
+
+	/* Initialize table to no charge. */
+	initialize_charge_table(0, 5000, 5000);
+	TEST_ASSERT(active_charge_port == CHARGE_PORT_NONE);
+
+	/*
+	 * Report a burst of charges on both ports, as BC1.2 detection and PD
+	 * negotiation do, and verify the limit is only set once, with the
+	 * best supplier.
+	 */
+	charge_limit_updates = 0;
+	charge.voltage = 5000;
+	for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i) {
+		charge.current = 500 + 100 * i;
+		charge_manager_update_charge(i, i % 2, &charge);
+	}
+	wait_for_charge_manager_refresh();
+	TEST_ASSERT(active_charge_port == 0);
+	TEST_ASSERT(active_charge_limit == 500);
+	TEST_EQ(charge_limit_updates, 1, "%d");
+
+	/* Changes on the inactive port don't touch the limit. */
+	charge.current = 3000;
+	charge_manager_update_charge(CHARGE_SUPPLIER_TEST10, 1, &charge);
+	wait_for_charge_manager_refresh();
+	TEST_ASSERT(active_charge_port == 0);
+	TEST_EQ(charge_limit_updates, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -800,6 +837,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_dual_role);
 	RUN_TEST(test_rejected_port);
 	RUN_TEST(test_unknown_dualrole_capability);
+	RUN_TEST(test_update_burst);
 
 	test_print_result();
 }
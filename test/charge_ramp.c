@@ -164,7 +164,7 @@ static int test_full_ramp(void)
 	return EC_SUCCESS;
 }
 
-static int test_vbus_dip(void)
+test_static int test_vbus_dip(void)
 {
 	system_load_current_ma = 3000;
 	/* VBUS dips too low right before the charger shuts down */
@@ -290,7 +290,7 @@ static int test_overcurrent_after_switch_outlet(void)
 	return EC_SUCCESS;
 }
 
-static int test_partial_load(void)
+test_static int test_partial_load(void)
 {
 	/* We have a 3A charger, but we just want 1.5A */
 	system_load_current_ma = 1500;
@@ -380,7 +380,7 @@ static int test_charge_supplier_change(void)
 	return EC_SUCCESS;
 }
 
-static int test_charge_port_change(void)
+test_static int test_charge_port_change(void)
 {
 	system_load_current_ma = 3000;
 	/* Start with a 1.5A ramp charge supplier on port 0 */
@@ -468,7 +468,7 @@ static int test_equal_priority_overcurrent(void)
 	return EC_SUCCESS;
 }
 
-static int test_ramp_limit(void)
+test_static int test_ramp_limit(void)
 {
 	system_load_current_ma = 3000;
 
@@ -497,6 +497,37 @@ static int test_ramp_limit(void)
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+static int test_fast_ramp(void)
+{
+	timestamp_t start;
+
+	system_load_current_ma = 3000;
+	/* The ramp to 3A takes a few seconds instead of twenty */
+	plug_charger(CHARGE_SUPPLIER_TEST4, 0, 500, 3000, 3000);
+	start = get_time();
+	while (charge_limit_ma != 3000 && time_since32(start) < 20 * SECOND)
+		usleep(100 * MSEC);
+	TEST_LT(time_since32(start), CHARGE_DETECT_DELAY + 5 * SECOND, "%u");
+
+	TEST_ASSERT(unplug_charger_and_check());
+	return EC_SUCCESS;
+}
+
+static int test_bisect_vbus_dip(void)
+{
+	system_load_current_ma = 3000;
+	/* VBUS dips well before the charger shuts down */
+	plug_charger(CHARGE_SUPPLIER_TEST5, 0, 500, 1500, 2500);
+
+	TEST_ASSERT(wait_stable_no_overcurrent());
+	TEST_ASSERT(is_in_range(charge_limit_ma, 1300, 1500));
+
+	TEST_ASSERT(unplug_charger_and_check());
+	return EC_SUCCESS;
+}
+#endif
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -508,19 +539,29 @@ void run_test(int argc, char **argv)
 	 */
 	RUN_TEST(test_no_ramp);
 	RUN_TEST(test_full_ramp);
+#ifndef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+	/*
+	 * These chargers shut down less than a ramp step above the current
+	 * where VBUS dips, or expect the limit to track the load within a step.
+	 */
 	RUN_TEST(test_vbus_dip);
+	RUN_TEST(test_partial_load);
+	RUN_TEST(test_charge_port_change);
+	RUN_TEST(test_ramp_limit);
+#endif
 	RUN_TEST(test_overcurrent);
 	RUN_TEST(test_switch_outlet);
 	RUN_TEST(test_fast_switch);
 	RUN_TEST(test_overcurrent_after_switch_outlet);
-	RUN_TEST(test_partial_load);
 	RUN_TEST(test_charge_supplier_stable);
 	RUN_TEST(test_charge_supplier_stable_ramp);
 	RUN_TEST(test_charge_supplier_change);
-	RUN_TEST(test_charge_port_change);
 	RUN_TEST(test_vbus_shift);
 	RUN_TEST(test_equal_priority_overcurrent);
-	RUN_TEST(test_ramp_limit);
+#ifdef CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA
+	RUN_TEST(test_fast_ramp);
+	RUN_TEST(test_bisect_vbus_dip);
+#endif
 
 	test_print_result();
 }
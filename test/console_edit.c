@@ -7,6 +7,7 @@
 
 #include "common.h"
 #include "console.h"
+#include "link_defs.h"
 #include "test_util.h"
 #include "timer.h"
 #include "util.h"
@@ -28,6 +29,23 @@ static int command_test_2(int argc, char **argv)
 }
 DECLARE_CONSOLE_COMMAND(test2, command_test_2, NULL, NULL);
 
+static int cmd_3_call_cnt;
+static int cmd_4_call_cnt;
+
+static int command_test_3(int argc, char **argv)
+{
+	cmd_3_call_cnt++;
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(test3, command_test_3, NULL, NULL);
+
+static int command_test_4(int argc, char **argv)
+{
+	cmd_4_call_cnt++;
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(test3x, command_test_4, NULL, NULL);
+
 /*****************************************************************************/
 /* Test utilities */
 
@@ -273,6 +291,37 @@ static int test_output_channel(void)
 	return EC_SUCCESS;
 }
 
+static int test_find_command(void)
+{
+	const struct console_command *cmd;
+
+	/* The lookup relies on the linker sorting commands by name */
+	for (cmd = __cmds; cmd + 1 < __cmds_end; cmd++)
+		TEST_ASSERT(strcasecmp(cmd[0].name, cmd[1].name) < 0);
+
+	cmd_1_call_cnt = cmd_2_call_cnt = 0;
+	cmd_3_call_cnt = cmd_4_call_cnt = 0;
+
+	/* Full match, even though it is also a prefix of test3x */
+	UART_INJECT("TEST3\n");
+	msleep(30);
+	TEST_CHECK(cmd_3_call_cnt == 1);
+	cmd_3_call_cnt = 0;
+
+	/* Unique prefix */
+	UART_INJECT("test3X\n");
+	msleep(30);
+	UART_INJECT("test3x\n");
+	msleep(30);
+	TEST_CHECK(cmd_4_call_cnt == 2);
+
+	/* Ambiguous prefix */
+	UART_INJECT("test\n");
+	msleep(30);
+	TEST_CHECK(cmd_1_call_cnt == 0 && cmd_2_call_cnt == 0 &&
+		   cmd_3_call_cnt == 0 && cmd_4_call_cnt == 2);
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -290,6 +339,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_history_stash);
 	RUN_TEST(test_history_list);
 	RUN_TEST(test_output_channel);
+	RUN_TEST(test_find_command);
 
 	test_print_result();
 }
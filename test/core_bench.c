@@ -0,0 +1,216 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Benchmark of core EC subsystems: queues, memcpy, CRC32, SHA256, AES-GCM,
+ * RSA verification, printf and host command dispatch. Runs on the emulator
+ * and on devices (see test/run_device_tests.py).
+ */
+
+#include "aes.h"
+#include "aes-gcm.h"
+#include "common.h"
+#include "console.h"
+#include "crc.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "printf.h"
+#include "queue.h"
+#include "rsa.h"
+#include "sha256.h"
+#include "test_util.h"
+#include "util.h"
+
+#include "rsa2048-F4.h"
+
+#define BENCH_ROUNDS 10000
+
+static struct queue const test_queue = QUEUE_NULL(64, uint8_t);
+
+static uint8_t data[1024];
+static uint8_t out[1024];
+static uint32_t rsa_workbuf[3 * RSANUMBYTES / 4];
+
+/* Keeps the compiler from dropping the results. */
+static volatile uint32_t sink;
+
+test_static int test_bench_queue(void)
+{
+	uint8_t units[16];
+	uint64_t start;
+	int i;
+
+	queue_init(&test_queue);
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		queue_add_unit(&test_queue, data + (i & 0xff));
+		queue_remove_unit(&test_queue, units);
+	}
+	test_bench_report("queue_unit", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		queue_add_units(&test_queue, data, sizeof(units));
+		queue_remove_units(&test_queue, units, sizeof(units));
+	}
+	test_bench_report("queue_units_16", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	TEST_ASSERT(queue_is_empty(&test_queue));
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_memcpy(void)
+{
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS / 10; i++)
+		memcpy(out, data, sizeof(data));
+	test_bench_report("memcpy_1k", BENCH_ROUNDS / 10,
+			  test_bench_now_ns() - start);
+
+	/* Misaligned source and destination */
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS / 10; i++)
+		memcpy(out + 1, data + 3, sizeof(data) - 4);
+	test_bench_report("memcpy_1k_unaligned", BENCH_ROUNDS / 10,
+			  test_bench_now_ns() - start);
+
+	TEST_ASSERT_ARRAY_EQ(out + 1, data + 3, sizeof(data) - 4);
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_crc32(void)
+{
+	uint64_t start;
+	uint32_t crc;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS / 10; i++) {
+		crc32_ctx_init(&crc);
+		crc32_ctx_hash(&crc, data, sizeof(data));
+	}
+	test_bench_report("crc32_1k", BENCH_ROUNDS / 10,
+			  test_bench_now_ns() - start);
+
+	sink = crc32_ctx_result(&crc);
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_sha256(void)
+{
+	struct sha256_ctx ctx;
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS / 10; i++) {
+		SHA256_init(&ctx);
+		SHA256_update(&ctx, data, sizeof(data));
+		SHA256_final(&ctx);
+	}
+	test_bench_report("sha256_1k", BENCH_ROUNDS / 10,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_aes_gcm(void)
+{
+	static const uint8_t key[16] = { 0x2b, 0x7e, 0x15, 0x16 };
+	static const uint8_t nonce[12] = { 1, 2, 3 };
+	static GCM128_CONTEXT ctx;
+	AES_KEY aes_key;
+	uint8_t tag[16];
+	uint64_t start;
+	int i;
+
+	TEST_ASSERT(AES_set_encrypt_key(key, 8 * sizeof(key), &aes_key) == 0);
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS / 100; i++) {
+		CRYPTO_gcm128_init(&ctx, &aes_key, (block128_f)AES_encrypt, 0);
+		CRYPTO_gcm128_setiv(&ctx, &aes_key, nonce, sizeof(nonce));
+		TEST_ASSERT(CRYPTO_gcm128_encrypt(&ctx, &aes_key, data, out,
+						  sizeof(data)));
+		CRYPTO_gcm128_tag(&ctx, tag, sizeof(tag));
+	}
+	test_bench_report("aes128_gcm_encrypt_1k", BENCH_ROUNDS / 100,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_rsa(void)
+{
+	const int rounds = 20;
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < rounds; i++)
+		TEST_ASSERT(rsa_verify(rsa_key, sig, hash, rsa_workbuf));
+	test_bench_report("rsa2048_verify", rounds,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_printf(void)
+{
+	char output[64];
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++)
+		snprintf(output, sizeof(output), "%d %08x %s", i, i, "text");
+	test_bench_report("snprintf", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_host_command(void)
+{
+	struct ec_params_hello params = { .in_data = 0x11223344 };
+	struct ec_response_hello resp;
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++)
+		TEST_EQ(test_send_host_command(EC_CMD_HELLO, 0, &params,
+					       sizeof(params), &resp,
+					       sizeof(resp)),
+			EC_RES_SUCCESS, "%d");
+	test_bench_report("host_command_hello", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	TEST_EQ(resp.out_data, 0x11223344 + 0x01020304, "0x%x");
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	int i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 7;
+
+	RUN_TEST(test_bench_queue);
+	RUN_TEST(test_bench_memcpy);
+	RUN_TEST(test_bench_crc32);
+	RUN_TEST(test_bench_sha256);
+	RUN_TEST(test_bench_aes_gcm);
+	RUN_TEST(test_bench_rsa);
+	RUN_TEST(test_bench_printf);
+	RUN_TEST(test_bench_host_command);
+
+	test_print_result();
+}
@@ -0,0 +1,146 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests the HMAC-SHA256 DRBG and the random pool.
+ */
+
+#include "common.h"
+#include "drbg.h"
+#include "test_util.h"
+#include "timer.h"
+#include "trng.h"
+#include "util.h"
+
+static int trng_inits;
+static int trng_on;
+static int trng_off_reads;
+static uint8_t trng_next;
+
+void init_trng(void)
+{
+	trng_inits++;
+	trng_on = 1;
+}
+
+void exit_trng(void)
+{
+	trng_on = 0;
+}
+
+void rand_bytes(void *buffer, size_t len)
+{
+	uint8_t *b = buffer;
+
+	if (!trng_on)
+		trng_off_reads++;
+	while (len--)
+		*b++ = trng_next++;
+}
+
+/*
+ * Expected output of the second 40 byte request after seeding with the
+ * bytes 0..47, then of a 32 byte request after reseeding with 48..95;
+ * computed with Python's hmac module following SP 800-90A.
+ */
+static const uint8_t kat_generate[] = {
+	0xca, 0xc8, 0x49, 0x0b, 0xa9, 0xb2, 0x3f, 0xfc,
+	0x16, 0xf1, 0x4f, 0x9b, 0x05, 0xd4, 0x2a, 0xdb,
+	0xab, 0xc2, 0xf9, 0xb9, 0x6b, 0x2a, 0xbe, 0x25,
+	0x61, 0x24, 0x04, 0x50, 0xcd, 0xd3, 0x8b, 0x52,
+	0xb9, 0x9c, 0x23, 0x20, 0x18, 0x19, 0x6a, 0x00,
+};
+
+static const uint8_t kat_reseed[] = {
+	0x0b, 0x72, 0x4c, 0x76, 0x94, 0x36, 0x49, 0xee,
+	0x72, 0x36, 0xef, 0x85, 0x99, 0x8e, 0x07, 0x94,
+	0x50, 0x46, 0xac, 0xd0, 0xe5, 0xe3, 0x0f, 0x15,
+	0x7f, 0x7a, 0xc7, 0x0b, 0x9d, 0xda, 0x1f, 0xd4,
+};
+
+test_static int test_hmac_drbg_kat(void)
+{
+	struct hmac_drbg_ctx ctx;
+	uint8_t seed[48];
+	uint8_t out[40];
+	int i;
+
+	for (i = 0; i < sizeof(seed); i++)
+		seed[i] = i;
+	hmac_drbg_init(&ctx, seed, sizeof(seed));
+	hmac_drbg_generate(&ctx, out, sizeof(out));
+	hmac_drbg_generate(&ctx, out, sizeof(out));
+	TEST_ASSERT_ARRAY_EQ(out, kat_generate, sizeof(kat_generate));
+	TEST_EQ(ctx.reseed_counter, 3, "%d");
+
+	for (i = 0; i < sizeof(seed); i++)
+		seed[i] = sizeof(seed) + i;
+	hmac_drbg_reseed(&ctx, seed, sizeof(seed));
+	hmac_drbg_generate(&ctx, out, sizeof(kat_reseed));
+	TEST_ASSERT_ARRAY_EQ(out, kat_reseed, sizeof(kat_reseed));
+	TEST_EQ(ctx.reseed_counter, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_pool(void)
+{
+	uint8_t a[16], b[16];
+	int inits;
+
+	/* The pool is filled at init */
+	msleep(10);
+	TEST_EQ(trng_inits, 1, "%d");
+	inits = trng_inits;
+
+	drbg_rand_bytes(a, sizeof(a));
+	msleep(10);
+	drbg_rand_bytes(b, sizeof(b));
+	TEST_EQ(trng_inits, inits, "%d");
+	TEST_ASSERT(memcmp(a, b, sizeof(a)));
+	TEST_ASSERT(!bytes_are_trivial(a, sizeof(a)));
+	TEST_ASSERT(!trng_on);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bulk(void)
+{
+	uint8_t buf[3 * CONFIG_RNG_DRBG_POOL_SIZE];
+	int i;
+
+	/* More than the pool holds, served partly straight from the DRBG */
+	drbg_rand_bytes(buf, sizeof(buf));
+	for (i = 0; i + 16 <= sizeof(buf); i += 16)
+		TEST_ASSERT(!bytes_are_trivial(buf + i, 16));
+	TEST_ASSERT(memcmp(buf, buf + CONFIG_RNG_DRBG_POOL_SIZE,
+			   CONFIG_RNG_DRBG_POOL_SIZE));
+
+	return EC_SUCCESS;
+}
+
+test_static int test_reseed(void)
+{
+	uint8_t buf[4];
+	int inits = trng_inits;
+	int i;
+
+	for (i = 0; i <= CONFIG_RNG_DRBG_RESEED_INTERVAL; i++) {
+		drbg_rand_bytes(buf, sizeof(buf));
+		msleep(1);
+	}
+	TEST_ASSERT(trng_inits > inits);
+	TEST_ASSERT(!trng_on);
+	TEST_EQ(trng_off_reads, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	RUN_TEST(test_hmac_drbg_kat);
+	RUN_TEST(test_pool);
+	RUN_TEST(test_bulk);
+	RUN_TEST(test_reseed);
+	test_print_result();
+}
@@ -0,0 +1,213 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests the event log.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "event_log.h"
+#include "host_command.h"
+#include "mkbp_event.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define UNIT_SIZE sizeof(struct event_log_entry)
+
+static uint8_t buf[256];
+static struct ec_response_event_log_read *resp = (void *)buf;
+
+static int log_read(uint32_t seq)
+{
+	struct ec_params_event_log_read p = { .seq = seq };
+	struct host_cmd_handler_args args = {
+		.send_response = NULL,
+		.command = EC_CMD_EVENT_LOG_READ,
+		.version = 0,
+		.params = &p,
+		.params_size = sizeof(p),
+		.response = buf,
+		.response_max = sizeof(buf),
+		.response_size = 0,
+	};
+
+	if (host_command_process(&args) != EC_RES_SUCCESS)
+		return -1;
+
+	return args.response_size;
+}
+
+/* Return the n-th entry of the last read */
+static struct event_log_entry *log_entry(int n)
+{
+	uint8_t *data = resp->data;
+
+	while (n--) {
+		struct event_log_entry *e = (void *)data;
+
+		data += (1 + DIV_ROUND_UP(EVENT_LOG_SIZE(e->size), UNIT_SIZE)) *
+			UNIT_SIZE;
+	}
+	return (void *)data;
+}
+
+static int notify_count;
+
+int mkbp_send_event(uint8_t event_type)
+{
+	if (event_type == EC_MKBP_EVENT_EVENT_LOG)
+		notify_count++;
+	return 1;
+}
+
+static void log_clear(void)
+{
+	struct event_log_entry r[5];
+
+	do {
+		log_dequeue_event(r);
+	} while (r->type != EVENT_LOG_NO_ENTRY);
+}
+
+static int test_read(void)
+{
+	uint32_t payload = 0x12345678;
+	uint32_t seq;
+	int rv;
+
+	log_clear();
+	TEST_ASSERT(log_read(0) == sizeof(*resp));
+	TEST_ASSERT(resp->count == 0);
+	seq = resp->next_seq;
+
+	log_add_event(1, 0, 0x1111, NULL, 10);
+	log_add_event(2, sizeof(payload), 0x2222, &payload, 20);
+
+	rv = log_read(seq);
+	TEST_ASSERT(rv == sizeof(*resp) + 3 * UNIT_SIZE);
+	TEST_ASSERT(resp->count == 2);
+	TEST_ASSERT(resp->seq == seq);
+	TEST_ASSERT(resp->next_seq == seq + 2);
+	TEST_ASSERT(log_entry(0)->type == 1);
+	TEST_ASSERT(log_entry(0)->data == 0x1111);
+	TEST_ASSERT(log_entry(0)->timestamp == 10);
+	TEST_ASSERT(log_entry(1)->type == 2);
+	TEST_ASSERT(EVENT_LOG_SIZE(log_entry(1)->size) == sizeof(payload));
+	TEST_ASSERT(!memcmp(log_entry(1)->payload, &payload, sizeof(payload)));
+
+	/* Reading doesn't consume the entries */
+	TEST_ASSERT(log_read(seq + 1) > 0);
+	TEST_ASSERT(resp->count == 1);
+	TEST_ASSERT(log_entry(0)->type == 2);
+
+	/* Dequeuing does */
+	log_clear();
+	TEST_ASSERT(log_read(seq) == sizeof(*resp));
+	TEST_ASSERT(resp->seq == seq + 2);
+
+	return EC_SUCCESS;
+}
+
+static int test_overflow(void)
+{
+	uint32_t seq, expected;
+	int i, seen;
+
+	log_clear();
+	log_read(0);
+	seq = resp->next_seq;
+
+	/* Overflow the log; old entries are dropped */
+	for (i = 0; i < 2 * CONFIG_EVENT_LOG_SIZE / UNIT_SIZE; i++)
+		log_add_event(3, 0, i, NULL, i);
+
+	/* Read it all back in several commands */
+	TEST_ASSERT(log_read(seq) > 0);
+	TEST_ASSERT(resp->seq > seq);
+	expected = resp->seq;
+	seen = 0;
+	while (resp->count) {
+		TEST_ASSERT(resp->seq == expected);
+		for (i = 0; i < resp->count; i++)
+			TEST_ASSERT(log_entry(i)->data ==
+				    (uint16_t)(resp->seq + i - seq));
+		seen += resp->count;
+		expected += resp->count;
+		TEST_ASSERT(log_read(resp->next_seq) > 0);
+	}
+	TEST_ASSERT(seen == CONFIG_EVENT_LOG_SIZE / UNIT_SIZE);
+	TEST_ASSERT(expected == seq + 2 * CONFIG_EVENT_LOG_SIZE / UNIT_SIZE);
+
+	return EC_SUCCESS;
+}
+
+static int test_preserved(void)
+{
+	uint32_t seq;
+
+	log_clear();
+	log_add_event(4, 0, 0x4444, NULL, 40);
+	log_read(0);
+	seq = resp->seq;
+	TEST_ASSERT(resp->count == 1);
+	TEST_ASSERT(resp->boot_seq <= seq);
+
+	/* The entries are kept with their numbers across a reset */
+	log_init();
+	TEST_ASSERT(log_read(0) > 0);
+	TEST_ASSERT(resp->count == 1);
+	TEST_ASSERT(resp->seq == seq);
+	TEST_ASSERT(resp->boot_seq == seq + 1);
+	TEST_ASSERT(log_entry(0)->data == 0x4444);
+
+	/* And new ones carry on from them */
+	log_add_event(5, 0, 0x5555, NULL, 50);
+	TEST_ASSERT(log_read(seq + 1) > 0);
+	TEST_ASSERT(resp->count == 1);
+	TEST_ASSERT(resp->seq == seq + 1);
+	TEST_ASSERT(log_entry(0)->type == 5);
+
+	return EC_SUCCESS;
+}
+
+static int test_notify(void)
+{
+	int i;
+
+	log_clear();
+	msleep(10);
+	notify_count = 0;
+
+	log_add_event(6, 0, 0x6666, NULL, 60);
+	msleep(10);
+	TEST_ASSERT(notify_count == 1);
+
+	/* A burst of entries is sent as one event */
+	for (i = 0; i < 4; i++)
+		log_add_event(7, 0, i, NULL, 70);
+	msleep(10);
+	TEST_ASSERT(notify_count == 2);
+
+	/* Reading and dequeuing don't send events */
+	log_read(0);
+	log_clear();
+	msleep(10);
+	TEST_ASSERT(notify_count == 2);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_read);
+	RUN_TEST(test_overflow);
+	RUN_TEST(test_preserved);
+	RUN_TEST(test_notify);
+
+	test_print_result();
+}
@@ -378,6 +378,34 @@ static int test_region_info(void)
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_FLASH_PSTATE_LOG
+static int test_pstate_log(void)
+{
+	int i;
+
+	TEST_ASSERT(flash_physical_erase(CONFIG_FW_PSTATE_OFF,
+					 CONFIG_FW_PSTATE_SIZE) == EC_SUCCESS);
+
+	/* Updates are appended; the first record stays */
+	SET_WP_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT, 1);
+	SET_WP_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT, 0);
+	TEST_ASSERT(verify_erase(CONFIG_FW_PSTATE_OFF, 4) != EC_SUCCESS);
+	ASSERT_WP_NO_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT);
+
+	/* Fill the bank until it has to be erased; the last update wins */
+	for (i = 0; i < CONFIG_FW_PSTATE_SIZE / 4 + 3; i++) {
+		SET_WP_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT, i & 1);
+		if (i & 1)
+			ASSERT_WP_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT);
+		else
+			ASSERT_WP_NO_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT);
+	}
+
+	SET_WP_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT, 0);
+	return EC_SUCCESS;
+}
+#endif
+
 static int test_write_protect(void)
 {
 	/* Test we can control write protect GPIO */
@@ -456,6 +484,9 @@ static void run_test_step1(void)
 	RUN_TEST(test_op_failure);
 	RUN_TEST(test_flash_info);
 	RUN_TEST(test_region_info);
+#ifdef CONFIG_FLASH_PSTATE_LOG
+	RUN_TEST(test_pstate_log);
+#endif
 	RUN_TEST(test_write_protect);
 
 	if (test_get_error_count())
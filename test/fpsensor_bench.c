@@ -0,0 +1,174 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Benchmark of the fingerprint template transfers: downloads a template
+ * through EC_CMD_FP_FRAME (encryption) and uploads it back through
+ * EC_CMD_FP_TEMPLATE (decryption) with various chunk sizes and orders.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "fpsensor_crypto.h"
+#include "fpsensor_state.h"
+#include "mock/fpsensor_state_mock.h"
+#include "printf.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define BENCH_ROUNDS 20
+
+/* The encrypted template as downloaded from the FPMCU */
+static uint8_t blob[FP_ALGORITHM_ENCRYPTED_TEMPLATE_SIZE];
+
+static uint8_t cmd_buf[sizeof(struct ec_params_fp_template) +
+		       FP_ALGORITHM_ENCRYPTED_TEMPLATE_SIZE] __aligned(4);
+
+static void print_time(const char *name, uint64_t us, int rounds)
+{
+	ccprintf("%-24s %8d us/op\n", name, (int)(us / rounds));
+	cflush();
+}
+
+static int upload_chunk(uint32_t offset, uint32_t size, int commit)
+{
+	struct ec_params_fp_template *params = (void *)cmd_buf;
+
+	params->offset = offset;
+	params->size = size | (commit ? FP_TEMPLATE_COMMIT : 0);
+	memcpy(params->data, blob + offset, size);
+	return test_send_host_command(EC_CMD_FP_TEMPLATE, 0, params,
+				      sizeof(*params) + size, NULL, 0);
+}
+
+/* Upload |blob| in chunks of |chunk| bytes, last chunk first if |reverse|. */
+static int upload_template(int chunk, int reverse)
+{
+	int count = DIV_ROUND_UP(sizeof(blob), chunk);
+	int i, rv = EC_RES_SUCCESS;
+
+	for (i = 0; i < count && rv == EC_RES_SUCCESS; i++) {
+		int n = reverse ? count - 1 - i : i;
+		uint32_t offset = n * chunk;
+
+		rv = upload_chunk(offset, MIN(chunk, sizeof(blob) - offset),
+				  i == count - 1);
+	}
+	return rv;
+}
+
+static int check_uploaded_template(void)
+{
+	TEST_EQ(templ_valid, 2, "%d");
+	TEST_ASSERT_ARRAY_EQ(fp_template[1], fp_template[0],
+			     sizeof(fp_template[0]));
+	TEST_ASSERT_ARRAY_EQ(fp_positive_match_salt[1],
+			     fp_positive_match_salt[0],
+			     sizeof(fp_positive_match_salt[0]));
+	return EC_SUCCESS;
+}
+
+test_static int test_download_template(void)
+{
+	struct ec_params_fp_frame params;
+	timestamp_t t0;
+	uint32_t offset;
+	int i;
+
+	/* GIVEN one template with a non-trivial positive match salt */
+	for (i = 0; i < sizeof(fp_template[0]); i++)
+		fp_template[0][i] = i;
+	for (i = 0; i < sizeof(fp_positive_match_salt[0]); i++)
+		fp_positive_match_salt[0][i] = 0x40 + i;
+	templ_valid = 1;
+
+	/* THEN it can be downloaded in host command sized slices */
+	t0 = get_time();
+	for (offset = 0; offset < sizeof(blob); offset += 64) {
+		uint32_t size = MIN(64, sizeof(blob) - offset);
+
+		params.offset = offset | (FP_FRAME_INDEX_TEMPLATE
+					  << FP_FRAME_INDEX_SHIFT);
+		params.size = size;
+		TEST_EQ(test_send_host_command(EC_CMD_FP_FRAME, 0, &params,
+					       sizeof(params), blob + offset,
+					       size),
+			EC_RES_SUCCESS, "%d");
+	}
+	print_time("download (encrypt)", time_since32(t0), 1);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_upload_template(void)
+{
+	static const int chunk_sizes[] = {
+		8, 20, 64, FP_ALGORITHM_ENCRYPTED_TEMPLATE_SIZE
+	};
+	char name[32];
+	timestamp_t t0;
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		t0 = get_time();
+		for (j = 0; j < BENCH_ROUNDS; j++) {
+			templ_valid = 1;
+			TEST_EQ(upload_template(chunk_sizes[i], 0),
+				EC_RES_SUCCESS, "%d");
+		}
+		snprintf(name, sizeof(name), "upload %d B chunks",
+			 chunk_sizes[i]);
+		print_time(name, time_since32(t0), BENCH_ROUNDS);
+		TEST_ASSERT(check_uploaded_template() == EC_SUCCESS);
+	}
+
+	return EC_SUCCESS;
+}
+
+test_static int test_upload_template_out_of_order(void)
+{
+	/* GIVEN chunks sent last first, THEN they are decrypted at commit */
+	templ_valid = 1;
+	TEST_EQ(upload_template(20, 1), EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(check_uploaded_template() == EC_SUCCESS);
+
+	/*
+	 * GIVEN a chunk rewritten after its decryption, THEN the upload is
+	 * rejected.
+	 */
+	templ_valid = 1;
+	TEST_EQ(upload_chunk(0, sizeof(blob) - 8, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(upload_chunk(sizeof(blob) - 8, 8, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(upload_chunk(sizeof(blob) - 16, 8, 1), EC_RES_INVALID_PARAM,
+		"%d");
+	TEST_EQ(templ_valid, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_upload_template_bad_tag(void)
+{
+	/* GIVEN a corrupted template, THEN the upload is rejected */
+	templ_valid = 1;
+	blob[sizeof(blob) - 1] ^= 1;
+	TEST_EQ(upload_template(20, 0), EC_RES_UNAVAILABLE, "%d");
+	TEST_EQ(templ_valid, 1, "%d");
+	blob[sizeof(blob) - 1] ^= 1;
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	/* The TPM seed can only be set once. */
+	ASSERT(fpsensor_state_mock_set_tpm_seed(default_fake_tpm_seed) ==
+	       EC_SUCCESS);
+
+	RUN_TEST(test_download_template);
+	RUN_TEST(test_upload_template);
+	RUN_TEST(test_upload_template_out_of_order);
+	RUN_TEST(test_upload_template_bad_tag);
+	test_print_result();
+}
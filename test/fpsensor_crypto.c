@@ -429,6 +429,56 @@ test_static int test_derive_positive_match_secret_fail_salt_trivial(void)
 	return EC_SUCCESS;
 }
 
+test_static int test_derive_cached_secrets(void)
+{
+	static uint8_t output[FP_POSITIVE_MATCH_SECRET_BYTES];
+	static uint8_t key[SBP_ENC_KEY_LEN];
+	static uint8_t cached_key[SBP_ENC_KEY_LEN];
+
+	memcpy(user_id, fake_user_id, sizeof(fake_user_id));
+	TEST_ASSERT(derive_positive_match_secret(output,
+						 fake_positive_match_salt)
+		== EC_SUCCESS);
+	TEST_ASSERT(derive_encryption_key(key, fake_positive_match_salt) ==
+		    EC_SUCCESS);
+
+	/* GIVEN that reading the rollback secret will fail. */
+	mock_ctrl_rollback.get_secret_fail = true;
+
+	/* THEN the secrets derived in this session are still available. */
+	memset(output, 0, sizeof(output));
+	TEST_ASSERT(derive_positive_match_secret(output,
+						 fake_positive_match_salt)
+		== EC_SUCCESS);
+	TEST_ASSERT_ARRAY_EQ(
+		output,
+		expected_positive_match_secret_for_fake_user_id,
+		sizeof(expected_positive_match_secret_for_fake_user_id));
+	TEST_ASSERT(derive_encryption_key(cached_key,
+					  fake_positive_match_salt) ==
+		    EC_SUCCESS);
+	TEST_ASSERT_ARRAY_EQ(cached_key, key, sizeof(key));
+
+	/* THEN a different user does not see them. */
+	memset(user_id, 0, sizeof(user_id));
+	TEST_ASSERT(derive_positive_match_secret(output,
+						 fake_positive_match_salt)
+		== EC_ERROR_HW_INTERNAL);
+
+	/* THEN they are gone once the cache is cleared. */
+	memcpy(user_id, fake_user_id, sizeof(fake_user_id));
+	fp_clear_key_cache();
+	TEST_ASSERT(derive_encryption_key(cached_key,
+					  fake_positive_match_salt) ==
+		    EC_ERROR_HW_INTERNAL);
+
+	mock_ctrl_rollback.get_secret_fail = false;
+	memset(user_id, 0, sizeof(user_id));
+	fp_clear_key_cache();
+
+	return EC_SUCCESS;
+}
+
 static int test_enable_positive_match_secret_once(
 	struct positive_match_secret_state *dumb_state)
 {
@@ -633,6 +683,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_derive_new_pos_match_secret);
 	RUN_TEST(test_derive_positive_match_secret_fail_rollback_fail);
 	RUN_TEST(test_derive_positive_match_secret_fail_salt_trivial);
+	RUN_TEST(test_derive_cached_secrets);
 	RUN_TEST(test_enable_positive_match_secret);
 	RUN_TEST(test_disable_positive_match_secret);
 	RUN_TEST(test_command_read_match_secret);
@@ -186,6 +186,41 @@ test_static int test_fp_set_maintenance_mode(void)
 	return EC_SUCCESS;
 }
 
+test_static int test_fp_template_order(void)
+{
+	uint8_t order[FP_MAX_FINGER_COUNT];
+	static const uint8_t initial[] = { 0, 1, 2, 3 };
+	static const uint8_t after_2[] = { 2, 0, 1, 3 };
+	static const uint8_t after_3_2[] = { 2, 3, 0, 1 };
+	static const uint8_t after_clear[] = { 2, 0, 1, 3 };
+	int count;
+
+	/* GIVEN 4 templates which never matched */
+	templ_valid = 4;
+	/* THEN they are in index order */
+	count = fp_get_template_order(order);
+	TEST_EQ(count, 4, "%d");
+	TEST_ASSERT_ARRAY_EQ(order, initial, sizeof(initial));
+
+	/* WHEN matching templates, THEN the latest match comes first */
+	fp_template_matched(2);
+	fp_get_template_order(order);
+	TEST_ASSERT_ARRAY_EQ(order, after_2, sizeof(after_2));
+	fp_template_matched(3);
+	fp_template_matched(2);
+	fp_get_template_order(order);
+	TEST_ASSERT_ARRAY_EQ(order, after_3_2, sizeof(after_3_2));
+
+	/* WHEN a template is cleared, THEN it loses its rank */
+	fp_clear_finger_context(3);
+	fp_get_template_order(order);
+	TEST_ASSERT_ARRAY_EQ(order, after_clear, sizeof(after_clear));
+
+	fp_clear_finger_context(2);
+	templ_valid = 0;
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	RUN_TEST(test_fp_enc_status_valid_flags);
@@ -194,5 +229,6 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_set_fp_tpm_seed_again);
 	RUN_TEST(test_fp_set_sensor_mode);
 	RUN_TEST(test_fp_set_maintenance_mode);
+	RUN_TEST(test_fp_template_order);
 	test_print_result();
 }
@@ -13,6 +13,8 @@
 #include "util.h"
 
 static int init_hook_count;
+static int init_late_hook_count;
+static int init_count_seen_by_late;
 static int tick_hook_count;
 static int tick2_hook_count;
 static int tick_count_seen_by_tick2;
@@ -27,6 +29,14 @@ static void init_hook(void)
 }
 DECLARE_HOOK(HOOK_INIT, init_hook, HOOK_PRIO_DEFAULT);
 
+static void init_late_hook(void)
+{
+	init_late_hook_count++;
+	init_count_seen_by_late = init_hook_count;
+}
+/* Highest priority, still after all HOOK_INIT routines */
+DECLARE_HOOK(HOOK_INIT_LATE, init_late_hook, HOOK_PRIO_FIRST);
+
 static void tick_hook(void)
 {
 	tick_hook_count++;
@@ -69,6 +79,11 @@ static const struct deferred_data non_deferred_func_data = {
 static int test_init_hook(void)
 {
 	TEST_ASSERT(init_hook_count == 1);
+
+	/* Let the HOOK task finish the late inits */
+	msleep(10);
+	TEST_ASSERT(init_late_hook_count == 1);
+	TEST_ASSERT(init_count_seen_by_late == 1);
 	return EC_SUCCESS;
 }
 
@@ -134,6 +149,62 @@ static int test_deferred(void)
 	return EC_SUCCESS;
 }
 
+static int deferred_order[3];
+static int deferred_order_count;
+
+static void deferred_order_record(int id)
+{
+	if (deferred_order_count < ARRAY_SIZE(deferred_order))
+		deferred_order[deferred_order_count] = id;
+	deferred_order_count++;
+}
+
+static void deferred_a(void)
+{
+	deferred_order_record(0);
+}
+DECLARE_DEFERRED(deferred_a);
+
+static void deferred_b(void)
+{
+	deferred_order_record(1);
+}
+DECLARE_DEFERRED(deferred_b);
+
+static void deferred_c(void)
+{
+	deferred_order_record(2);
+}
+DECLARE_DEFERRED(deferred_c);
+
+static int test_deferred_order(void)
+{
+	/* Deferred functions run in deadline order, not declaration order */
+	deferred_order_count = 0;
+	hook_call_deferred(&deferred_a_data, 30 * MSEC);
+	hook_call_deferred(&deferred_b_data, 10 * MSEC);
+	hook_call_deferred(&deferred_c_data, 20 * MSEC);
+	usleep(60 * MSEC);
+	TEST_EQ(deferred_order_count, 3, "%d");
+	TEST_EQ(deferred_order[0], 1, "%d");
+	TEST_EQ(deferred_order[1], 2, "%d");
+	TEST_EQ(deferred_order[2], 0, "%d");
+
+	/* Rescheduling or cancelling a pending call moves it in the queue */
+	deferred_order_count = 0;
+	hook_call_deferred(&deferred_a_data, 10 * MSEC);
+	hook_call_deferred(&deferred_b_data, 20 * MSEC);
+	hook_call_deferred(&deferred_c_data, 30 * MSEC);
+	hook_call_deferred(&deferred_a_data, 40 * MSEC);
+	hook_call_deferred(&deferred_b_data, -1);
+	usleep(70 * MSEC);
+	TEST_EQ(deferred_order_count, 2, "%d");
+	TEST_EQ(deferred_order[0], 2, "%d");
+	TEST_EQ(deferred_order[1], 0, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int repeating_deferred_count;
 static void deferred_repeating_func(void);
 DECLARE_DEFERRED(deferred_repeating_func);
@@ -167,6 +238,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_ticks);
 	RUN_TEST(test_priority);
 	RUN_TEST(test_deferred);
+	RUN_TEST(test_deferred_order);
 	RUN_TEST(test_repeating_deferred);
 
 	test_print_result();
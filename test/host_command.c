@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "host_command.h"
+#include "link_defs.h"
 #include "task.h"
 #include "test_util.h"
 #include "timer.h"
@@ -300,6 +301,263 @@ static int test_hostcmd_clears_unused_data(void)
 	return EC_SUCCESS;
 }
 
+static int test_hostcmd_find_all(void)
+{
+	const struct host_command *cmd;
+	struct ec_params_get_cmd_versions_v1 p;
+	struct ec_response_get_cmd_versions r;
+
+	/* Every registered command must be found with its own version mask */
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		p.cmd = cmd->command;
+		TEST_EQ(test_send_host_command(EC_CMD_GET_CMD_VERSIONS, 1,
+					       &p, sizeof(p), &r, sizeof(r)),
+			EC_RES_SUCCESS, "%d");
+		TEST_EQ(r.version_mask, cmd->version_mask, "0x%x");
+	}
+
+	/* And a gap in the command numbers must not be */
+	p.cmd = 0x00ff;
+	TEST_EQ(test_send_host_command(EC_CMD_GET_CMD_VERSIONS, 1,
+				       &p, sizeof(p), &r, sizeof(r)),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_trace(void)
+{
+	struct ec_params_get_hostcmd_trace tp;
+	struct {
+		struct ec_response_get_hostcmd_trace hdr;
+		struct ec_hostcmd_trace_entry entry[4];
+	} tr;
+	uint32_t seq;
+
+	/* Nothing has been recorded past the end */
+	tp.seq = UINT32_MAX;
+	TEST_EQ(test_send_host_command(EC_CMD_GET_HOSTCMD_TRACE, 0,
+				       &tp, sizeof(tp), &tr, sizeof(tr)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(tr.hdr.count, 0, "%d");
+	seq = tr.hdr.next_seq;
+
+	hostcmd_fill_in_default();
+	hostcmd_send();
+	TEST_ASSERT(resp->result == EC_RES_SUCCESS);
+	/* Let the host command task finish the entry */
+	msleep(1);
+
+	tp.seq = seq;
+	TEST_EQ(test_send_host_command(EC_CMD_GET_HOSTCMD_TRACE, 0,
+				       &tp, sizeof(tp), &tr, sizeof(tr)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(tr.hdr.seq, seq, "%d");
+	TEST_EQ(tr.hdr.next_seq, seq + 1, "%d");
+	TEST_EQ(tr.hdr.count, 1, "%d");
+	TEST_EQ(tr.entry[0].command, EC_CMD_HELLO, "0x%x");
+	TEST_EQ(tr.entry[0].result, EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(tr.entry[0].response_size ==
+		    sizeof(struct ec_response_hello));
+	TEST_ASSERT(tr.entry[0].start_us - tr.entry[0].arrival_us <=
+		    tr.entry[0].end_us - tr.entry[0].arrival_us);
+
+	return EC_SUCCESS;
+}
+
+/* Test-only command, slow enough to be run in the background */
+#define TEST_CMD_ASYNC 0x00FE
+
+static enum ec_status test_command_async(struct host_cmd_handler_args *args)
+{
+	const uint32_t *in = args->params;
+	uint32_t *out = args->response;
+
+	msleep(10);
+
+	*out = *in + 1;
+	args->response_size = sizeof(*out);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND_ASYNC(TEST_CMD_ASYNC, test_command_async, EC_VER_MASK(0));
+
+static int test_hostcmd_async(void)
+{
+	struct ec_response_get_comms_status status;
+	uint32_t out = 0;
+	int i;
+
+	hostcmd_fill_in_default();
+	req->command = TEST_CMD_ASYNC;
+	req->command_version = 0;
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_IN_PROGRESS, "%d");
+
+	/* Other commands are not held up meanwhile */
+	hostcmd_fill_in_default();
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(r->out_data == 0x12243648);
+
+	for (i = 0; i < 10; i++) {
+		TEST_EQ(test_send_host_command(EC_CMD_GET_COMMS_STATUS, 0,
+					       NULL, 0,
+					       &status, sizeof(status)),
+			EC_RES_SUCCESS, "%d");
+		if (!(status.flags & EC_COMMS_STATUS_PROCESSING))
+			break;
+		msleep(5);
+	}
+	TEST_ASSERT(!(status.flags & EC_COMMS_STATUS_PROCESSING));
+
+	/* The result and response data are kept for the host to fetch */
+	TEST_EQ(test_send_host_command(EC_CMD_RESEND_RESPONSE, 0, NULL, 0,
+				       &out, sizeof(out)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(out, 0x11223345, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_batch(void)
+{
+	struct {
+		struct ec_params_batch hdr;
+		struct ec_params_batch_cmd hello;
+		struct ec_params_hello hello_p;
+		struct ec_params_batch_cmd bad;
+		struct ec_params_batch_cmd again;
+		struct ec_params_hello again_p;
+	} bp = {
+		.hdr = { .count = 3 },
+		.hello = { .command = EC_CMD_HELLO,
+			   .data_len = sizeof(struct ec_params_hello) },
+		.hello_p = { .in_data = 0x10 },
+		.bad = { .command = 0x00ff },
+		.again = { .command = EC_CMD_HELLO,
+			   .data_len = sizeof(struct ec_params_hello) },
+		.again_p = { .in_data = 0x20 },
+	};
+	struct {
+		struct ec_response_batch hdr;
+		struct ec_response_batch_cmd hello;
+		struct ec_response_hello hello_r;
+		struct ec_response_batch_cmd bad;
+		struct ec_response_batch_cmd again;
+		struct ec_response_hello again_r;
+	} br;
+
+	TEST_EQ(test_send_host_command(EC_CMD_BATCH, 0, &bp, sizeof(bp),
+				       &br, sizeof(br)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(br.hdr.count, 3, "%d");
+	TEST_EQ(br.hello.result, EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(br.hello.data_len == sizeof(struct ec_response_hello));
+	TEST_EQ(br.hello_r.out_data, 0x10 + 0x01020304, "0x%x");
+	TEST_EQ(br.bad.result, EC_RES_INVALID_COMMAND, "%d");
+	TEST_EQ(br.bad.data_len, 0, "%d");
+	TEST_EQ(br.again.result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(br.again_r.out_data, 0x20 + 0x01020304, "0x%x");
+
+	/* Commands which don't fit in the response are not run */
+	TEST_EQ(test_send_host_command(EC_CMD_BATCH, 0, &bp, sizeof(bp),
+				       &br, offsetof(typeof(br), again_r)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(br.hdr.count, 2, "%d");
+
+	/* Nor are nested batches */
+	bp.bad.command = EC_CMD_BATCH;
+	TEST_EQ(test_send_host_command(EC_CMD_BATCH, 0, &bp, sizeof(bp),
+				       &br, sizeof(br)),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_memmap_notify(void)
+{
+	struct ec_params_memmap_notify p = {
+		.subscribe_mask = BIT(EC_MEMMAP_FAN / EC_MEMMAP_NOTIFY_BLOCK_SIZE),
+	};
+	struct ec_response_memmap_notify r;
+	struct ec_response_get_next_event e;
+
+	/* Drop events from other sources, like host events at init */
+	while (test_send_host_command(EC_CMD_GET_NEXT_EVENT, 0, NULL, 0,
+				      &e, sizeof(e)) == EC_RES_SUCCESS)
+		;
+
+	TEST_EQ(test_send_host_command(EC_CMD_MEMMAP_NOTIFY, 0, &p, sizeof(p),
+				       &r, sizeof(r)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.dirty_mask, 0, "0x%x");
+
+	/* Blocks not subscribed to don't send events */
+	host_memmap_changed(EC_MEMMAP_BATT_VOLT, 4);
+	TEST_EQ(test_send_host_command(EC_CMD_GET_NEXT_EVENT, 0, NULL, 0,
+				       &e, sizeof(e)),
+		EC_RES_UNAVAILABLE, "%d");
+
+	host_memmap_changed(EC_MEMMAP_FAN + 2, 2);
+	host_memmap_changed(EC_MEMMAP_FAN, 2);
+	TEST_EQ(test_send_host_command(EC_CMD_GET_NEXT_EVENT, 0, NULL, 0,
+				       &e, sizeof(e)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(e.event_type, EC_MKBP_EVENT_MEMMAP_CHANGE, "%d");
+	TEST_EQ(e.data.memmap_dirty, p.subscribe_mask, "0x%x");
+
+	/* Reading the event clears the dirty blocks */
+	TEST_EQ(test_send_host_command(EC_CMD_GET_NEXT_EVENT, 0, NULL, 0,
+				       &e, sizeof(e)),
+		EC_RES_UNAVAILABLE, "%d");
+
+	/* So does the host command, which also unsubscribes */
+	host_memmap_changed(EC_MEMMAP_FAN, 2);
+	p.subscribe_mask = 0;
+	TEST_EQ(test_send_host_command(EC_CMD_MEMMAP_NOTIFY, 0, &p, sizeof(p),
+				       &r, sizeof(r)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.dirty_mask,
+		BIT(EC_MEMMAP_FAN / EC_MEMMAP_NOTIFY_BLOCK_SIZE), "0x%x");
+	host_memmap_changed(EC_MEMMAP_FAN, 2);
+	TEST_EQ(test_send_host_command(EC_CMD_MEMMAP_NOTIFY, 0, &p, sizeof(p),
+				       &r, sizeof(r)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.dirty_mask, 0, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_channels(void)
+{
+	struct host_packet pkt2, pkt3;
+
+	/* pkt took the first channel, a second transport gets the other */
+	hostcmd_fill_in_default();
+	pkt2 = pkt;
+	req->checksum = calculate_checksum(req_buf, pkt.request_size);
+	host_packet_receive(&pkt2);
+	task_wait_event(-1);
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->out_data, 0x12243648, "0x%x");
+
+	/* There is no channel left for a third one */
+	hostcmd_fill_in_default();
+	pkt3 = pkt;
+	req->checksum = calculate_checksum(req_buf, pkt.request_size);
+	host_packet_receive(&pkt3);
+	task_wait_event(-1);
+	TEST_EQ(resp->result, EC_RES_BUSY, "%d");
+
+	/* The first two still work */
+	hostcmd_fill_in_default();
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	wait_for_task_started();
@@ -315,6 +573,12 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_hostcmd_invalid_checksum);
 	RUN_TEST(test_hostcmd_reuse_response_buffer);
 	RUN_TEST(test_hostcmd_clears_unused_data);
+	RUN_TEST(test_hostcmd_find_all);
+	RUN_TEST(test_hostcmd_trace);
+	RUN_TEST(test_hostcmd_async);
+	RUN_TEST(test_hostcmd_batch);
+	RUN_TEST(test_hostcmd_memmap_notify);
+	RUN_TEST(test_hostcmd_channels);
 
 	test_print_result();
 }
@@ -14,6 +14,7 @@
 #include "keyboard_protocol.h"
 #include "keyboard_scan.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 static uint8_t state[KEYBOARD_COLS_MAX];
@@ -286,6 +287,100 @@ int fifo_underrun(void)
 	return EC_SUCCESS;
 }
 
+static int latency_count(enum ec_keyboard_latency_stage stage, int reset)
+{
+	struct ec_params_keyboard_latency_stats p = {
+		.stage = stage,
+		.flags = reset ? EC_KB_LATENCY_RESET : 0,
+	};
+	struct ec_response_keyboard_latency_stats r;
+
+	if (test_send_host_command(EC_CMD_KEYBOARD_LATENCY_STATS, 0, &p,
+				   sizeof(p), &r, sizeof(r)) != EC_RES_SUCCESS)
+		return -1;
+	return r.count;
+}
+
+static int simulate_key(int c, int r, int pressed)
+{
+	struct ec_params_mkbp_simulate_key p = {
+		.col = c,
+		.row = r,
+		.pressed = pressed,
+	};
+
+	return test_send_host_command(EC_CMD_MKBP_SIMULATE_KEY, 0, &p,
+				      sizeof(p), NULL, 0);
+}
+
+/* Read a scanned key matrix, whose keys are active high. */
+static int verify_scanned_key(int c, int r, int pressed)
+{
+	struct ec_response_get_next_event event;
+
+	if (test_send_host_command(EC_CMD_GET_NEXT_EVENT, 0, NULL, 0, &event,
+				   sizeof(event)) != EC_RES_SUCCESS)
+		return 0;
+
+	return event.event_type == EC_MKBP_EVENT_KEY_MATRIX &&
+	       !!(event.data.key_matrix[c] & BIT(r)) == pressed;
+}
+
+int latency_stats(void)
+{
+	enum ec_keyboard_latency_stage stage;
+
+	/* Let the scan task read its initial state */
+	msleep(50);
+	keyboard_clear_buffer();
+	clear_mkbp_events();
+	TEST_ASSERT(latency_count(EC_KB_LATENCY_SCAN, 1) >= 0);
+
+	/* A scanned keystroke is traced until the host reads it */
+	TEST_ASSERT(simulate_key(1, 1, 1) == EC_RES_SUCCESS);
+	TEST_ASSERT(latency_count(EC_KB_LATENCY_TOTAL, 0) == 0);
+	TEST_ASSERT(verify_scanned_key(1, 1, 1));
+	for (stage = EC_KB_LATENCY_SCAN; stage <= EC_KB_LATENCY_TOTAL; stage++)
+		TEST_ASSERT(latency_count(stage, 0) == 1);
+
+	TEST_ASSERT(simulate_key(1, 1, 0) == EC_RES_SUCCESS);
+	TEST_ASSERT(verify_scanned_key(1, 1, 0));
+	TEST_ASSERT(latency_count(EC_KB_LATENCY_TOTAL, 1) == 2);
+	TEST_ASSERT(latency_count(EC_KB_LATENCY_TOTAL, 0) == 0);
+
+	return EC_SUCCESS;
+}
+
+int batched_events(void)
+{
+	keyboard_clear_buffer();
+	clear_state();
+	clear_mkbp_events();
+
+	/* A switch event waits for the batching window to close */
+	mkbp_update_switches(EC_MKBP_TABLET_MODE, 1);
+	TEST_ASSERT(FIFO_EMPTY());
+	msleep(CONFIG_MKBP_EVENT_BATCH_MS / 2);
+	mkbp_update_switches(EC_MKBP_TABLET_MODE, 0);
+	TEST_ASSERT(FIFO_EMPTY());
+	msleep(CONFIG_MKBP_EVENT_BATCH_MS);
+	TEST_ASSERT(FIFO_NOT_EMPTY());
+	clear_mkbp_events();
+	TEST_ASSERT(FIFO_EMPTY());
+
+	/* A key press ends the window and carries the held events */
+	mkbp_update_switches(EC_MKBP_TABLET_MODE, 1);
+	TEST_ASSERT(FIFO_EMPTY());
+	TEST_ASSERT(press_key(0, 0, 1) == EC_SUCCESS);
+	TEST_ASSERT(FIFO_NOT_EMPTY());
+	clear_mkbp_events();
+	mkbp_update_switches(EC_MKBP_TABLET_MODE, 0);
+	msleep(CONFIG_MKBP_EVENT_BATCH_MS * 2);
+	clear_mkbp_events();
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	ec_int_level = 1;
@@ -298,6 +393,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_fifo_size);
 	RUN_TEST(test_enable);
 	RUN_TEST(fifo_underrun);
+	RUN_TEST(latency_stats);
+	RUN_TEST(batched_events);
 
 	test_print_result();
 }
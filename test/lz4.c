@@ -0,0 +1,192 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests LZ4 compression and cursor-based console reads.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "lz4.h"
+#include "test_util.h"
+#include "util.h"
+
+static uint8_t input[1024];
+static uint8_t packed[LZ4_COMPRESS_BOUND(sizeof(input))];
+static uint8_t output[sizeof(input)];
+
+static int round_trip(int size)
+{
+	int packed_size, rv;
+
+	packed_size = lz4_compress(input, size, packed, sizeof(packed));
+	TEST_ASSERT(packed_size > 0 || size == 0);
+	TEST_ASSERT(packed_size <= LZ4_COMPRESS_BOUND(size));
+
+	memset(output, 0xaa, sizeof(output));
+	rv = lz4_decompress(packed, packed_size, output, sizeof(output));
+	TEST_ASSERT(rv == size);
+	TEST_ASSERT_ARRAY_EQ(output, input, size);
+
+	return packed_size;
+}
+
+static int test_lz4_text(void)
+{
+	static const char line[] = "[12.345678 charge_request(8400mV, 1500mA)]\n";
+	int i, rv;
+
+	for (i = 0; i < sizeof(input); i++)
+		input[i] = line[i % (sizeof(line) - 1)];
+
+	/* Repetitive text compresses well */
+	rv = round_trip(sizeof(input));
+	TEST_ASSERT(rv > 0 && rv < sizeof(input) / 4);
+
+	/* Short inputs are all literals */
+	for (i = 0; i < 16; i++)
+		TEST_ASSERT(round_trip(i) >= 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_lz4_random(void)
+{
+	uint32_t seed = 0x12345678;
+	int i;
+
+	for (i = 0; i < sizeof(input); i++) {
+		seed = seed * 1103515245 + 12345;
+		input[i] = seed >> 16;
+	}
+
+	/* Incompressible data grows by no more than the bound */
+	TEST_ASSERT(round_trip(sizeof(input)) > 0);
+
+	/* And doesn't fit in a buffer the size of the input */
+	TEST_ASSERT(lz4_compress(input, sizeof(input), packed, sizeof(input)) ==
+		    -EC_ERROR_OVERFLOW);
+
+	return EC_SUCCESS;
+}
+
+static int test_lz4_malformed(void)
+{
+	/* Literal run longer than the input */
+	static const uint8_t bad_literal[] = { 0x50, 'a', 'b' };
+	/* Match before the start of the output */
+	static const uint8_t bad_offset[] = { 0x10, 'a', 0x02, 0x00 };
+	int rv;
+
+	TEST_ASSERT(lz4_decompress(bad_literal, sizeof(bad_literal), output,
+				   sizeof(output)) == -EC_ERROR_INVAL);
+	TEST_ASSERT(lz4_decompress(bad_offset, sizeof(bad_offset), output,
+				   sizeof(output)) == -EC_ERROR_INVAL);
+
+	/* Output buffer too small */
+	memset(input, 'x', 64);
+	rv = lz4_compress(input, 64, packed, sizeof(packed));
+	TEST_ASSERT(rv > 0);
+	TEST_ASSERT(lz4_decompress(packed, rv, output, 63) ==
+		    -EC_ERROR_OVERFLOW);
+
+	return EC_SUCCESS;
+}
+
+static int console_read(uint32_t cursor, uint8_t flags,
+			struct ec_response_console_read_v2 *r, int size,
+			char *text)
+{
+	struct ec_params_console_read_v2 p = {
+		.cursor = cursor,
+		.flags = flags,
+	};
+	struct host_cmd_handler_args args = {
+		.send_response = NULL,
+		.command = EC_CMD_CONSOLE_READ,
+		.version = 2,
+		.params = &p,
+		.params_size = sizeof(p),
+		.response = r,
+		.response_max = size,
+		.response_size = 0,
+	};
+	int rv;
+
+	if (host_command_process(&args) != EC_RES_SUCCESS)
+		return -1;
+
+	if (r->flags & EC_CONSOLE_READ_LZ4) {
+		rv = lz4_decompress(r->data, args.response_size - sizeof(*r),
+				    text, r->size);
+		if (rv != r->size)
+			return -1;
+	} else {
+		if (args.response_size != sizeof(*r) + r->size)
+			return -1;
+		memcpy(text, r->data, r->size);
+	}
+	text[r->size] = '\0';
+
+	return r->size;
+}
+
+static int test_console_read_v2(void)
+{
+	static uint8_t buf[sizeof(struct ec_response_console_read_v2) + 256];
+	struct ec_response_console_read_v2 *r = (void *)buf;
+	static char text[512];
+	uint32_t cursor;
+	int i, rv;
+
+	/* Find the end of the output so far */
+	cursor = 0;
+	do {
+		rv = console_read(cursor, 0, r, sizeof(buf), text);
+		TEST_ASSERT(rv >= 0);
+		cursor = r->next_cursor;
+	} while (rv);
+
+	/* Only new output is returned after that */
+	ccputs("console read test\n");
+	cflush();
+	TEST_ASSERT(console_read(cursor, 0, r, sizeof(buf), text) > 0);
+	TEST_ASSERT(r->cursor == cursor);
+	TEST_ASSERT(strstr(text, "console read test\n"));
+
+	/* Each reader has its own cursor, so a second read sees it too */
+	TEST_ASSERT(console_read(cursor, EC_CONSOLE_READ_LZ4, r, sizeof(buf),
+				 text) > 0);
+	TEST_ASSERT(strstr(text, "console read test\n"));
+	cursor = r->next_cursor;
+
+	/* Repetitive output is compressed */
+	for (i = 0; i < 6; i++)
+		ccputs("0123456789abcdef0123456789abcdef\n");
+	cflush();
+	rv = console_read(cursor, EC_CONSOLE_READ_LZ4, r, sizeof(buf), text);
+	TEST_ASSERT(rv >= 6 * 33);
+	TEST_ASSERT(r->flags & EC_CONSOLE_READ_LZ4);
+	TEST_ASSERT(strstr(text, "0123456789abcdef0123456789abcdef\n"));
+
+	/* A stale cursor skips to the oldest output still buffered */
+	TEST_ASSERT(console_read(cursor - CONFIG_UART_TX_BUF_SIZE, 0, r,
+				 sizeof(buf), text) > 0);
+	TEST_ASSERT(r->cursor != cursor - CONFIG_UART_TX_BUF_SIZE);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_lz4_text);
+	RUN_TEST(test_lz4_random);
+	RUN_TEST(test_lz4_malformed);
+	RUN_TEST(test_console_read_v2);
+
+	test_print_result();
+}
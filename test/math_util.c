@@ -45,6 +45,36 @@ static int test_acos(void)
 	return EC_SUCCESS;
 }
 
+#define ATAN2_TOLERANCE_DEG 0.01f
+
+static int test_atan2(void)
+{
+	static const int scales[] = { 1, 1000, 1 << 20, INT32_MAX };
+	float a, b;
+	float test;
+	int i;
+
+	/* Test around the circle, with small and large vectors. */
+	for (i = 0; i < ARRAY_SIZE(scales); i++) {
+		for (test = -179.0f; test <= 180.0f; test += 7.0f) {
+			float rad = test / RAD_TO_DEG;
+			int y = (int)(sinf(rad) * scales[i]);
+			int x = (int)(cosf(rad) * scales[i]);
+
+			if (x == 0 && y == 0)
+				continue;
+			a = FP_TO_FLOAT(arc_tan2(y, x));
+			b = atan2f(y, x) * RAD_TO_DEG;
+			TEST_ASSERT(IS_FLOAT_EQUAL(a, b, ATAN2_TOLERANCE_DEG));
+		}
+	}
+
+	/* Exact on the axes. */
+	TEST_ASSERT(arc_tan2(0, 5) == FLOAT_TO_FP(0));
+	TEST_ASSERT(arc_tan2(0, -5) == FLOAT_TO_FP(180));
+
+	return EC_SUCCESS;
+}
 
 const mat33_fp_t test_matrices[] = {
 	{{ 0, FLOAT_TO_FP(-1), 0},
@@ -83,6 +113,7 @@ void run_test(int argc, char **argv)
 	test_reset();
 
 	RUN_TEST(test_acos);
+	RUN_TEST(test_atan2);
 	RUN_TEST(test_rotate);
 
 	test_print_result();
@@ -7,6 +7,7 @@
 
 #include "stdio.h"
 #include "motion_sense_fifo.h"
+#include "sensor_clock.h"
 #include "test_util.h"
 #include "util.h"
 #include "hwtimer.h"
@@ -51,6 +52,40 @@ static int test_insert_async_event(void)
 	return EC_SUCCESS;
 }
 
+static int test_deferred_odr_event(void)
+{
+	const uint32_t now = __hw_clock_source_read();
+	int read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sense_fifo_defer_odr_event(motion_sensors, true);
+	/* Dropped, the driver stages it where the new rate starts. */
+	motion_sense_fifo_insert_async_event(motion_sensors, ASYNC_EVENT_ODR);
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 0, "%d");
+
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, now - 2000);
+	motion_sense_fifo_stage_odr_event(motion_sensors, now - 1000);
+	/* Only once. */
+	motion_sense_fifo_stage_odr_event(motion_sensors, now - 1000);
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 3, "%d");
+	TEST_BITS_CLEARED(data[1].flags, MOTIONSENSE_SENSOR_FLAG_ODR);
+	TEST_BITS_SET(data[2].flags, ASYNC_EVENT_ODR);
+	TEST_EQ(data[2].timestamp, now - 1000, "%u");
+
+	/* Back to inserting it right away. */
+	motion_sense_fifo_insert_async_event(motion_sensors, ASYNC_EVENT_ODR);
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int test_wake_up_needed(void)
 {
 	data[0].flags = MOTIONSENSE_SENSOR_FLAG_WAKEUP;
@@ -343,6 +378,186 @@ static int test_commit_non_data_or_timestamp_entries(void)
 	return EC_SUCCESS;
 }
 
+static int test_stage_batch(void)
+{
+	struct ec_response_motion_sensor_data batch[4] = {};
+	int read_count;
+
+	motion_sensors[BASE].oversampling_ratio = 1;
+	motion_sensors[LID].oversampling_ratio = 2;
+	batch[0].sensor_num = BASE;
+	batch[0].data[0] = 1;
+	batch[1].sensor_num = LID;
+	batch[1].data[0] = 2;
+	batch[2].sensor_num = BASE;
+	batch[2].data[0] = 3;
+	batch[3].sensor_num = LID;
+	batch[3].data[0] = 4;
+	motion_sense_fifo_stage_batch(batch, ARRAY_SIZE(batch), 100);
+
+	/* The last sample of each sensor is its public vector. */
+	TEST_EQ(motion_sensors[BASE].xyz[0], 3, "%d");
+	TEST_EQ(motion_sensors[LID].xyz[0], 4, "%d");
+
+	/* Every sample is timestamped, the second lid one is oversampled. */
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 7, "%d");
+	TEST_BITS_SET(data[0].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[1].sensor_num, BASE, "%d");
+	TEST_EQ(data[1].data[0], 1, "%d");
+	TEST_BITS_SET(data[2].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[3].sensor_num, LID, "%d");
+	TEST_EQ(data[3].data[0], 2, "%d");
+	TEST_BITS_SET(data[4].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[5].sensor_num, BASE, "%d");
+	TEST_EQ(data[5].data[0], 3, "%d");
+	TEST_BITS_SET(data[6].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[6].sensor_num, LID, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_stage_batch_evicts_oldest(void)
+{
+	struct ec_response_motion_sensor_data batch[3] = {};
+	int i, read_count;
+
+	/* Fill the fifo */
+	motion_sensors->oversampling_ratio = 1;
+	for (i = 0; i < CONFIG_ACCEL_FIFO_SIZE / 2; i++)
+		motion_sense_fifo_stage_data(data, motion_sensors, 3, i * 100);
+	motion_sense_fifo_commit_data();
+
+	/* Stage 3 samples, they evict the 3 oldest ones with their timestamp */
+	motion_sense_fifo_stage_batch(batch, ARRAY_SIZE(batch),
+				      CONFIG_ACCEL_FIFO_SIZE * 100);
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, CONFIG_ACCEL_FIFO_SIZE, "%d");
+	TEST_BITS_SET(data->flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data->timestamp, 300, "%u");
+	TEST_BITS_SET(data[CONFIG_ACCEL_FIFO_SIZE - 6].flags,
+		      MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+
+	return EC_SUCCESS;
+}
+
+static int test_read_compact(void)
+{
+	static const uint8_t expected[] = {
+		/* timestamp 100 */
+		0x02, 0xc8, 0x01,
+		/* sensor 0: 1, -2, 300 */
+		0x00, 0x02, 0x03, 0xd8, 0x04,
+		/* timestamp 150: +50 */
+		0x02, 0x64,
+		/* sensor 0: +1, +0, +0 */
+		0x00, 0x02, 0x00, 0x00,
+		/* timestamp 200 of sensor 0xff: +50 */
+		0xe2, 0xff, 0x64,
+	};
+	uint8_t out[64];
+	int read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	data[0].data[0] = 1;
+	data[0].data[1] = -2;
+	data[0].data[2] = 300;
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, 100);
+	motion_sense_fifo_commit_data();
+	data[0].data[0] = 2;
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, 150);
+	motion_sense_fifo_commit_data();
+	motion_sense_fifo_add_timestamp(200);
+
+	read_count = motion_sense_fifo_read_compact(
+		sizeof(out), CONFIG_ACCEL_FIFO_SIZE, out, &data_bytes_read);
+	TEST_EQ(read_count, 5, "%d");
+	TEST_EQ(data_bytes_read, (int)sizeof(expected), "%d");
+	TEST_ASSERT_ARRAY_EQ(out, expected, sizeof(expected));
+
+	return EC_SUCCESS;
+}
+
+static int test_read_compact_capacity(void)
+{
+	uint8_t out[64];
+	int read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, 100);
+	motion_sense_fifo_commit_data();
+
+	/* Only entries that surely fit are encoded */
+	read_count = motion_sense_fifo_read_compact(
+		11, CONFIG_ACCEL_FIFO_SIZE, out, &data_bytes_read);
+	TEST_EQ(read_count, 1, "%d");
+	read_count = motion_sense_fifo_read_compact(
+		sizeof(out), CONFIG_ACCEL_FIFO_SIZE, out, &data_bytes_read);
+	TEST_EQ(read_count, 1, "%d");
+	TEST_BITS_CLEARED(out[0], MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+
+	return EC_SUCCESS;
+}
+
+static int test_stage_timed_data_not_spread(void)
+{
+	const uint32_t now = __hw_clock_source_read();
+	int read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[0].collection_rate = 20000; /* ns */
+	motion_sense_fifo_stage_timed_data(data, motion_sensors, now - 15000);
+	motion_sense_fifo_stage_timed_data(data, motion_sensors, now - 5000);
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 4, "%d");
+	TEST_BITS_SET(data[0].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[0].timestamp, now - 15000, "%u");
+	TEST_BITS_SET(data[2].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[2].timestamp, now - 5000, "%u");
+
+	return EC_SUCCESS;
+}
+
+/* Sensor counter ticking every 15.68us, 2% faster than its nominal 16us. */
+static uint32_t sensor_ticks(uint32_t t)
+{
+	return ((uint64_t)t * 100 / 1568) & 0xffff;
+}
+
+static int test_sensor_clock_tracks_drift(void)
+{
+	struct sensor_clock clk;
+	uint32_t t = 12345;
+	int i;
+
+	sensor_clock_init(&clk, 16 << 16, 16);
+
+	/* 3s of interrupts every 10ms, late by up to 100us. */
+	for (i = 0; i < 300; i++) {
+		t += 10000;
+		sensor_clock_sync(&clk, sensor_ticks(t), t + (i * 37) % 100);
+	}
+
+	/* Within 0.2% */
+	TEST_NEAR((int)clk.rate, (1568 << 16) / 100, 2000, "%d");
+	TEST_NEAR(sensor_clock_to_ec(&clk, sensor_ticks(t)), t, 50, "%u");
+	TEST_NEAR(sensor_clock_to_ec(&clk, sensor_ticks(t - 8000)), t - 8000,
+		  50, "%u");
+
+	/* A gap the model can't explain restarts it. */
+	sensor_clock_sync(&clk, sensor_ticks(t), t + 500000);
+	TEST_EQ(clk.anchor_ec, t + 500000, "%u");
+	TEST_EQ(clk.rate, 16 << 16, "%u");
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	motion_sense_fifo_commit_data();
@@ -359,6 +574,7 @@ void run_test(int argc, char **argv)
 	motion_sense_fifo_init();
 
 	RUN_TEST(test_insert_async_event);
+	RUN_TEST(test_deferred_odr_event);
 	RUN_TEST(test_wake_up_needed);
 	RUN_TEST(test_wake_up_needed_overflow);
 	RUN_TEST(test_adding_timestamp);
@@ -372,6 +588,12 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_spread_data_by_collection_rate);
 	RUN_TEST(test_spread_double_commit_same_timestamp);
 	RUN_TEST(test_commit_non_data_or_timestamp_entries);
+	RUN_TEST(test_stage_batch);
+	RUN_TEST(test_stage_batch_evicts_oldest);
+	RUN_TEST(test_read_compact);
+	RUN_TEST(test_read_compact_capacity);
+	RUN_TEST(test_stage_timed_data_not_spread);
+	RUN_TEST(test_sensor_clock_tracks_drift);
 
 	test_print_result();
 }
@@ -0,0 +1,128 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Benchmark of motion_sense_fifo: staging, committing and reading samples.
+ */
+
+#include "accelgyro.h"
+#include "hwtimer.h"
+#include "motion_sense_fifo.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+struct motion_sensor_t motion_sensors[] = {
+	[BASE] = {},
+	[LID] = {},
+};
+
+const unsigned int motion_sensor_count = ARRAY_SIZE(motion_sensors);
+
+uint32_t mkbp_last_event_time;
+
+#define BENCH_ROUNDS 10000
+/* Samples staged before each commit, as after a sensor FIFO read */
+#define BENCH_BATCH 8
+
+static struct ec_response_motion_sensor_data data[CONFIG_ACCEL_FIFO_SIZE];
+static uint16_t data_bytes_read;
+
+static void drain_fifo(void)
+{
+	motion_sense_fifo_read(sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data,
+			       &data_bytes_read);
+}
+
+test_static int test_bench_stage_commit(void)
+{
+	struct ec_response_motion_sensor_data sample = {};
+	uint32_t now = __hw_clock_source_read();
+	uint64_t start;
+	int i, j;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		for (j = 0; j < BENCH_BATCH; j++) {
+			sample.data[0] = j;
+			motion_sense_fifo_stage_data(&sample, motion_sensors,
+						     3, now + i * 1000 + j);
+		}
+		motion_sense_fifo_commit_data();
+		drain_fifo();
+	}
+	test_bench_report("fifo_stage_commit_8", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_stage_batch(void)
+{
+	struct ec_response_motion_sensor_data batch[BENCH_BATCH] = {};
+	uint32_t now = __hw_clock_source_read();
+	uint64_t start;
+	int i;
+
+	for (i = 0; i < BENCH_BATCH; i++)
+		batch[i].sensor_num = i % 2 ? LID : BASE;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		motion_sense_fifo_stage_batch(batch, BENCH_BATCH,
+					      now + i * 1000);
+		motion_sense_fifo_commit_data();
+		drain_fifo();
+	}
+	test_bench_report("fifo_stage_batch_8", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_read_compact(void)
+{
+	struct ec_response_motion_sensor_data sample = {};
+	uint32_t now = __hw_clock_source_read();
+	uint8_t out[512];
+	uint16_t out_size;
+	uint64_t start;
+	int i, j;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		for (j = 0; j < BENCH_BATCH; j++)
+			motion_sense_fifo_stage_data(&sample, motion_sensors,
+						     3, now + i * 1000 + j);
+		motion_sense_fifo_commit_data();
+		motion_sense_fifo_read_compact(sizeof(out),
+					       CONFIG_ACCEL_FIFO_SIZE, out,
+					       &out_size);
+	}
+	test_bench_report("fifo_commit_read_compact_8", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+void before_test(void)
+{
+	motion_sense_fifo_commit_data();
+	drain_fifo();
+	motion_sense_fifo_reset_wake_up_needed();
+	motion_sense_fifo_reset();
+	motion_sensors[BASE].oversampling_ratio = 1;
+	motion_sensors[LID].oversampling_ratio = 1;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+	motion_sense_fifo_init();
+
+	RUN_TEST(test_bench_stage_commit);
+	RUN_TEST(test_bench_stage_batch);
+	RUN_TEST(test_bench_read_compact);
+
+	test_print_result();
+}
@@ -121,6 +121,20 @@ struct motion_sensor_t motion_sensors[] = {
 
 const unsigned int motion_sensor_count = ARRAY_SIZE(motion_sensors);
 
+/* Hand a sample to online calibration, and wait until it is processed */
+static int process_data(struct ec_response_motion_sensor_data *data,
+			struct motion_sensor_t *sensor)
+{
+	int rc = online_calibration_process_data(data, sensor,
+						 __hw_clock_source_read());
+
+	/* Let the hook task run the calibration worker */
+	if (IS_ENABLED(CONFIG_ONLINE_CALIB_DEFERRED))
+		msleep(1);
+
+	return rc;
+}
+
 static int test_read_temp_on_stage(void)
 {
 	struct mock_read_temp_result expected = { &motion_sensors[BASE], 200,
@@ -130,8 +144,7 @@ static int test_read_temp_on_stage(void)
 
 	mock_read_temp_results = &expected;
 	data.sensor_num = BASE;
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[0], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[0]);
 
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 	TEST_EQ(expected.used_count, 1, "%d");
@@ -148,12 +161,10 @@ static int test_read_temp_from_cache_on_stage(void)
 
 	mock_read_temp_results = &expected;
 	data.sensor_num = BASE;
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[0], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[0]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[0], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[0]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 
 	TEST_EQ(expected.used_count, 1, "%d");
@@ -170,13 +181,11 @@ static int test_read_temp_twice_after_cache_stale(void)
 
 	mock_read_temp_results = &expected;
 	data.sensor_num = BASE;
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[0], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[0]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 
 	sleep(2);
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[0], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[0]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 
 	TEST_EQ(expected.used_count, 2, "%d");
@@ -196,8 +205,7 @@ static int test_new_calibration_value(void)
 	next_accel_cal_accumulate_result = false;
 	data.sensor_num = BASE;
 
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[BASE], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[BASE]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 	TEST_EQ(online_calibration_has_new_values(), false, "%d");
 
@@ -205,8 +213,7 @@ static int test_new_calibration_value(void)
 	next_accel_cal_bias[X] = 0.01f;		/* expect:  81  */
 	next_accel_cal_bias[Y] = -0.02f;	/* expect: -163 */
 	next_accel_cal_bias[Z] = 0;		/* expect:    0 */
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[BASE], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[BASE]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 	TEST_EQ(online_calibration_has_new_values(), true, "%d");
 
@@ -236,8 +243,7 @@ int test_mag_reading_updated_cal(void)
 	init_mag_cal(&expected_results);
 	mag_cal_update(&expected_results, test_values);
 
-	rc = online_calibration_process_data(
-		&data, &motion_sensors[LID], __hw_clock_source_read());
+	rc = process_data(&data, &motion_sensors[LID]);
 	TEST_EQ(rc, EC_SUCCESS, "%d");
 	TEST_EQ(expected_results.kasa_fit.nsamples,
 		lid_mag_cal_data.kasa_fit.nsamples, "%d");
@@ -245,6 +251,37 @@ int test_mag_reading_updated_cal(void)
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_ONLINE_CALIB_DEFERRED
+static int test_deferred_queue_full(void)
+{
+	struct mock_read_temp_result expected = { &motion_sensors[BASE], 200,
+						  EC_SUCCESS, 0, NULL };
+	struct ec_response_motion_sensor_data data;
+	int i;
+
+	mock_read_temp_results = &expected;
+	data.sensor_num = BASE;
+
+	/* Nothing is processed until the hook task gets to run */
+	for (i = 0; i < CONFIG_ONLINE_CALIB_QUEUE_SIZE; i++)
+		TEST_EQ(online_calibration_process_data(
+				&data, &motion_sensors[BASE],
+				__hw_clock_source_read()),
+			EC_SUCCESS, "%d");
+	TEST_EQ(online_calibration_process_data(&data, &motion_sensors[BASE],
+						__hw_clock_source_read()),
+		EC_ERROR_OVERFLOW, "%d");
+	TEST_EQ(expected.used_count, 0, "%d");
+
+	/* Then the whole batch is, reading the temperature once */
+	msleep(1);
+	TEST_EQ(expected.used_count, 1, "%d");
+	TEST_EQ(process_data(&data, &motion_sensors[BASE]), EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+#endif
+
 void before_test(void)
 {
 	mock_read_temp_results = NULL;
@@ -260,6 +297,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_read_temp_twice_after_cache_stale);
 	RUN_TEST(test_new_calibration_value);
 	RUN_TEST(test_mag_reading_updated_cal);
+#ifdef CONFIG_ONLINE_CALIB_DEFERRED
+	RUN_TEST(test_deferred_queue_full);
+#endif
 
 	test_print_result();
 }
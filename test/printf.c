@@ -177,6 +177,9 @@ test_static int test_vsnprintf_int(void)
 	T(expect_success("123",        "%u",    123));
 	T(expect_success("4294967295", "%u",   -1));
 	T(expect_success("18446744073709551615", "%llu", (uint64_t)-1));
+	T(expect_success("4294967296", "%llu", (uint64_t)1 << 32));
+	T(expect_success("4294967.296", "%.3llu", (uint64_t)1 << 32));
+	T(expect_success("123456789abcdef0", "%llx", 0x123456789abcdef0ULL));
 
 	T(expect_success("0",         "%x",     0));
 	T(expect_success("0",         "%X",     0));
@@ -297,6 +300,76 @@ test_static int test_vsnprintf_combined(void)
 	return EC_SUCCESS;
 }
 
+static int token_addchar(void *context, int c)
+{
+	int *len = context;
+
+	if (*len >= sizeof(output))
+		return 1;
+	output[(*len)++] = c;
+	return 0;
+}
+
+static int tokenize(int *len, const char *format, ...)
+{
+	va_list args;
+	int rv;
+
+	*len = 0;
+	va_start(args, format);
+	rv = vfntokenize(token_addchar, len, 0, format, args);
+	va_end(args);
+
+	return rv;
+}
+
+/* Token records start with the format address as a LEB128 value */
+static int skip_token(const char *format, int *pos)
+{
+	uint64_t token = 0;
+	int shift = 0;
+	int c;
+
+	do {
+		c = output[(*pos)++];
+		token |= (uint64_t)(c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+
+	TEST_ASSERT(token == (uintptr_t)format << 1);
+	return EC_SUCCESS;
+}
+
+test_static int test_vfntokenize(void)
+{
+	static const char fmt_int[] = "%d %5x %llu %%";
+	static const char fmt_str[] = "%s:%.*s";
+	static const char fmt_ptr[] = "%ph %pb";
+	const char bytes[] = {0x00, 0x5E};
+	int len, pos;
+
+	TEST_EQ(tokenize(&len, fmt_int, 1, 0x80, 300ULL), EC_SUCCESS, "%d");
+	pos = 0;
+	TEST_EQ(skip_token(fmt_int, &pos), EC_SUCCESS, "%d");
+	TEST_EQ(len - pos, 5, "%d");
+	TEST_ASSERT_ARRAY_EQ(&output[pos], "\x01\x80\x01\xac\x02", 5);
+
+	TEST_EQ(tokenize(&len, fmt_str, "ab", 1, "cd"), EC_SUCCESS, "%d");
+	pos = 0;
+	TEST_EQ(skip_token(fmt_str, &pos), EC_SUCCESS, "%d");
+	TEST_EQ(len - pos, 6, "%d");
+	TEST_ASSERT_ARRAY_EQ(&output[pos], "ab\0\x01" "c\0", 6);
+
+	TEST_EQ(tokenize(&len, fmt_ptr, HEX_BUF(bytes, 2), BINARY_VALUE(5, 4)),
+		EC_SUCCESS, "%d");
+	pos = 0;
+	TEST_EQ(skip_token(fmt_ptr, &pos), EC_SUCCESS, "%d");
+	TEST_EQ(len - pos, 5, "%d");
+	TEST_ASSERT_ARRAY_EQ(&output[pos], "\x02\x00\x5e\x04\x05", 5);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -309,6 +382,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_vsnprintf_timestamps);
 	RUN_TEST(test_vsnprintf_hexdump);
 	RUN_TEST(test_vsnprintf_combined);
+	RUN_TEST(test_vfntokenize);
 
 	test_print_result();
 }
@@ -0,0 +1,116 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Benchmark of printf formatting.
+ */
+
+#ifdef EMU_BUILD
+#include <time.h>
+#endif
+
+#include "clock.h"
+#include "common.h"
+#include "console.h"
+#include "printf.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define BENCH_ROUNDS 1000
+
+static char output[64];
+
+struct bench_case {
+	const char *name;
+	const char *format;
+	uint64_t value;
+};
+
+static const struct bench_case cases[] = {
+	{ "small %d", "%d", 7 },
+	{ "32-bit %u", "%u", 4000000000U },
+	{ "fixed %.3d", "%.3d", 123456 },
+	{ "hex %08x", "%08x", 0xdeadbeef },
+	{ "64-bit %llu", "%llu", 0xfedcba9876543210ULL },
+	{ "64-bit %llx", "%llx", 0xfedcba9876543210ULL },
+};
+
+/*
+ * Time in ns.  The emulator's get_time() only ticks when it is read, so use
+ * the host clock there.
+ */
+static uint64_t bench_now_ns(void)
+{
+#ifdef EMU_BUILD
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+	return get_time().val * 1000;
+#endif
+}
+
+/* Time in ns of BENCH_ROUNDS calls of snprintf() formatting value */
+static uint64_t bench_format(const char *format, uint64_t value)
+{
+	uint64_t start = bench_now_ns();
+	int i;
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		if (strstr(format, "ll"))
+			snprintf(output, sizeof(output), format, value);
+		else
+			snprintf(output, sizeof(output), format,
+				 (uint32_t)value);
+	}
+
+	return bench_now_ns() - start;
+}
+
+/* Time in ns of BENCH_ROUNDS calls of snprintf() formatting a timestamp */
+static uint64_t bench_timestamp(void)
+{
+	uint64_t ts = 86400ULL * SECOND;
+	uint64_t start = bench_now_ns();
+	int i;
+
+	for (i = 0; i < BENCH_ROUNDS; i++)
+		snprintf(output, sizeof(output), "[%pT]", &ts);
+
+	return bench_now_ns() - start;
+}
+
+static void print_result(const char *name, uint64_t ns)
+{
+	uint32_t ns_per_call = ns / BENCH_ROUNDS;
+	uint32_t cycles = (uint64_t)ns_per_call * (clock_get_freq() / 1000) /
+		1000000;
+
+	ccprintf("%-14s %6d ns/call %8d cycles/call\n", name, ns_per_call,
+		 cycles);
+	cflush();
+	test_bench_report(name, BENCH_ROUNDS, ns);
+}
+
+test_static int test_printf_bench(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cases); i++)
+		print_result(cases[i].name,
+			     bench_format(cases[i].format, cases[i].value));
+	print_result("timestamp %pT", bench_timestamp());
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_printf_bench);
+
+	test_print_result();
+}
@@ -16,6 +16,26 @@
 static struct queue const test_queue8 = QUEUE_NULL(8, char);
 static struct queue const test_queue2 = QUEUE_NULL(2, int16_t);
 
+static int spsc_add_calls;
+static int spsc_remove_calls;
+
+static void spsc_add(struct queue_policy const *policy, size_t count)
+{
+	spsc_add_calls++;
+}
+
+static void spsc_remove(struct queue_policy const *policy, size_t count)
+{
+	spsc_remove_calls++;
+}
+
+static struct queue_policy const spsc_policy = {
+	.add    = spsc_add,
+	.remove = spsc_remove,
+};
+
+static struct queue const test_queue4_spsc = QUEUE(4, int32_t, spsc_policy);
+
 static int test_queue8_empty(void)
 {
 	char tmp = 1;
@@ -257,6 +277,44 @@ static int test_queue8_chunks_empty(void)
 	return EC_SUCCESS;
 }
 
+static int test_queue8_chunks_scatter(void)
+{
+	static uint8_t const data[7] = {1, 2, 3, 4, 5, 6, 7};
+	struct queue_chunk chunks[2];
+	uint8_t buf[7];
+
+	/* Move near the end of the queue */
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 6) == 6);
+	TEST_ASSERT(queue_advance_head(&test_queue8, 5) == 5);
+
+	/* Seven free units, split over the end of the buffer */
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 7);
+	TEST_ASSERT(chunks[0].count == 2);
+	TEST_ASSERT(chunks[1].count == 5);
+
+	memcpy(chunks[0].buffer, data, 2);
+	memcpy(chunks[1].buffer, data + 2, 5);
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 7) == 7);
+	TEST_ASSERT(queue_is_full(&test_queue8));
+
+	/* The used units are split in the same place, after the old unit */
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 0);
+	TEST_ASSERT(queue_advance_head(&test_queue8, 1) == 1);
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 7);
+	TEST_ASSERT(chunks[0].count == 2);
+	TEST_ASSERT(chunks[1].count == 5);
+
+	TEST_ASSERT(queue_remove_units(&test_queue8, buf, 7) == 7);
+	TEST_ASSERT_ARRAY_EQ(buf, data, 7);
+
+	/* Nothing wraps in an empty queue either */
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 0);
+	TEST_ASSERT(chunks[0].count == 0);
+	TEST_ASSERT(chunks[1].count == 0);
+
+	return EC_SUCCESS;
+}
+
 static int test_queue8_chunks_advance(void)
 {
 	/*
@@ -410,10 +468,71 @@ static int test_queue8_iterate_next_reset_on_change(void)
 	return EC_SUCCESS;
 }
 
+static int test_queue4_spsc_fifo(void)
+{
+	struct queue const *q = &test_queue4_spsc;
+	int32_t data[6] = { -1, 2, 65536, -65536, 7, 8 };
+	int32_t out;
+	int i;
+
+	/* Fill the queue past the end of the buffer, so indices wrap */
+	TEST_ASSERT(queue_add_units(q, data, 3) == 3);
+	TEST_ASSERT(queue_remove_units(q, &out, 1) == 1);
+	TEST_ASSERT(queue_remove_units(q, &out, 1) == 1);
+	TEST_ASSERT(queue_remove_units(q, &out, 1) == 1);
+
+	for (i = 0; i < 4; i++)
+		TEST_ASSERT(QUEUE_ADD_UNIT_SPSC(q, data + i) == 1);
+	TEST_ASSERT(QUEUE_ADD_UNIT_SPSC(q, data + 4) == 0);
+	TEST_ASSERT(queue_is_full(q));
+
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT(QUEUE_REMOVE_UNIT_SPSC(q, &out) == 1);
+		TEST_ASSERT(out == data[i]);
+	}
+	TEST_ASSERT(QUEUE_REMOVE_UNIT_SPSC(q, &out) == 0);
+	TEST_ASSERT(queue_is_empty(q));
+
+	return EC_SUCCESS;
+}
+
+static int test_queue4_spsc_policy(void)
+{
+	struct queue const *q = &test_queue4_spsc;
+	int32_t data = 5;
+	int32_t out;
+	int i;
+
+	spsc_add_calls = 0;
+	spsc_remove_calls = 0;
+
+	/* Only the empty to non-empty transition notifies the consumer */
+	for (i = 0; i < 4; i++)
+		QUEUE_ADD_UNIT_SPSC(q, &data);
+	TEST_ASSERT(spsc_add_calls == 1);
+
+	/* Only the full to not full transition notifies the producer */
+	QUEUE_REMOVE_UNIT_SPSC(q, &out);
+	QUEUE_REMOVE_UNIT_SPSC(q, &out);
+	TEST_ASSERT(spsc_remove_calls == 1);
+
+	QUEUE_ADD_UNIT_SPSC(q, &data);
+	TEST_ASSERT(spsc_add_calls == 1);
+
+	while (QUEUE_REMOVE_UNIT_SPSC(q, &out))
+		;
+	QUEUE_ADD_UNIT_SPSC(q, &data);
+	TEST_ASSERT(spsc_add_calls == 2);
+	TEST_ASSERT(spsc_remove_calls == 1);
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	queue_init(&test_queue2);
 	queue_init(&test_queue8);
+	queue_init(&test_queue4_spsc);
 }
 
 void run_test(int argc, char **argv)
@@ -431,12 +550,15 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_queue8_chunks_wrapped);
 	RUN_TEST(test_queue8_chunks_full);
 	RUN_TEST(test_queue8_chunks_empty);
+	RUN_TEST(test_queue8_chunks_scatter);
 	RUN_TEST(test_queue8_chunks_advance);
 	RUN_TEST(test_queue8_chunks_offset);
 	RUN_TEST(test_queue8_iterate_begin);
 	RUN_TEST(test_queue8_iterate_next);
 	RUN_TEST(test_queue2_iterate_next_full);
 	RUN_TEST(test_queue8_iterate_next_reset_on_change);
+	RUN_TEST(test_queue4_spsc_fifo);
+	RUN_TEST(test_queue4_spsc_policy);
 
 	test_print_result();
 }
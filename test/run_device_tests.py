@@ -14,6 +14,7 @@ See https://chromium.googlesource.com/chromiumos/third_party/hdctools/+/HEAD/doc
 import argparse
 import concurrent
 import io
+import json
 import logging
 import os
 import re
@@ -36,6 +37,8 @@ ALL_TESTS_FAILED_REGEX = re.compile(r'Fail! \(\d+ tests\)\r\n')
 SINGLE_CHECK_PASSED_REGEX = re.compile(r'Pass: .*')
 SINGLE_CHECK_FAILED_REGEX = re.compile(r'.*failed:.*')
 
+BENCH_RESULT_REGEX = re.compile(r'BENCH (\{.*\})')
+
 DATA_ACCESS_VIOLATION_8020000_REGEX = re.compile(
     r'Data access violation, mfar = 8020000\r\n')
 DATA_ACCESS_VIOLATION_8040000_REGEX = re.compile(
@@ -81,12 +84,15 @@ class TestConfig:
         self.passed = False
         self.num_fails = 0
         self.num_passes = 0
+        self.bench_results = []
 
 
 # All possible tests.
 ALL_TESTS = {
     'aes':
         TestConfig(name='aes'),
+    'core_bench':
+        TestConfig(name='core_bench', timeout_secs=60),
     'crc32':
         TestConfig(name='crc32'),
     'flash_physical':
@@ -283,6 +289,10 @@ def run_test(test: TestConfig, console: str, executor: ThreadPoolExecutor) ->\
                 if ALL_TESTS_FAILED_REGEX.match(line_str):
                     test.num_fails += 1
 
+                bench = BENCH_RESULT_REGEX.search(line_str)
+                if bench:
+                    test.bench_results.append(json.loads(bench.group(1)))
+
                 for r in test.finish_regexes:
                     if r.match(line_str):
                         # flush read the remaining
@@ -298,6 +308,30 @@ def run_test(test: TestConfig, console: str, executor: ThreadPoolExecutor) ->\
                 pass
 
 
+def save_bench_results(path: str, board: str,
+                       test_list: List[TestConfig]) -> None:
+    """Adds the benchmark results of the tests to the JSON at path.
+
+    The file maps each board to a map of the test names to their results,
+    in the same format as util/run_host_test --bench, so that runs on
+    different chips can be compared.
+    """
+    try:
+        with open(path) as f:
+            all_results = json.load(f)
+    except FileNotFoundError:
+        all_results = {}
+
+    board_results = all_results.setdefault(board, {})
+    for test in test_list:
+        if test.passed and test.bench_results:
+            board_results[test.name] = test.bench_results
+
+    with open(path, 'w') as f:
+        json.dump(all_results, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+
 def get_test_list(config: BoardConfig, test_args) -> List[TestConfig]:
     """Get a list of tests to run."""
     if test_args == 'all':
@@ -331,6 +365,11 @@ def main():
         help='Tests (default: ' + default_tests + ')',
         default=default_tests)
 
+    parser.add_argument(
+        '--bench',
+        metavar='FILE',
+        help='Add the benchmark results of the tests to FILE')
+
     log_level_choices = ['DEBUG', 'INFO', 'WARNING', 'ERROR', 'CRITICAL']
     parser.add_argument(
         '--log_level', '-l',
@@ -385,6 +424,9 @@ def main():
         console = get_console(args.board, board_config)
         test.passed = run_test(test, console, executor=e)
 
+    if args.bench:
+        save_bench_results(args.bench, args.board, test_list)
+
     colorama.init()
     exit_code = 0
     for test in test_list:
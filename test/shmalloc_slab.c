@@ -0,0 +1,123 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the size class slabs in front of the shared memory allocator.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "shared_mem.h"
+#include "test_util.h"
+#include "util.h"
+
+static int get_stats(struct ec_response_shmem_stats *r)
+{
+	return test_send_host_command(EC_CMD_SHMEM_STATS, 0, NULL, 0,
+				      r, sizeof(*r));
+}
+
+static int test_slab_reuse(void)
+{
+	char *bufs[CONFIG_MALLOC_SLAB_64_COUNT];
+	char *buf;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(bufs); i++) {
+		TEST_ASSERT(shared_mem_acquire(64, bufs + i) == EC_SUCCESS);
+		memset(bufs[i], i, 64);
+	}
+
+	for (i = 1; i < ARRAY_SIZE(bufs); i++)
+		TEST_ASSERT(bufs[i] + 64 == bufs[i - 1]);
+
+	/* A released slot is handed out again */
+	shared_mem_release(bufs[1]);
+	TEST_ASSERT(shared_mem_acquire(40, &buf) == EC_SUCCESS);
+	TEST_ASSERT(buf == bufs[1]);
+
+	for (i = 0; i < ARRAY_SIZE(bufs); i++)
+		shared_mem_release(bufs[i]);
+
+	return EC_SUCCESS;
+}
+
+static int test_slab_concurrent_users(void)
+{
+	struct ec_response_shmem_stats r;
+	char *small[CONFIG_MALLOC_SLAB_64_COUNT + 1];
+	char *big;
+	uint32_t free_before;
+	int i;
+
+	TEST_ASSERT(get_stats(&r) == EC_RES_SUCCESS);
+	free_before = r.free;
+
+	/* A flash chunk and host packets can be held at the same time */
+	TEST_ASSERT(shared_mem_acquire(4096, &big) == EC_SUCCESS);
+	for (i = 0; i < ARRAY_SIZE(small); i++)
+		TEST_ASSERT(shared_mem_acquire(64, small + i) == EC_SUCCESS);
+
+	TEST_ASSERT(get_stats(&r) == EC_RES_SUCCESS);
+	TEST_ASSERT(r.slab[0].slot_size == 64);
+	TEST_ASSERT(r.slab[0].in_use == CONFIG_MALLOC_SLAB_64_COUNT);
+	TEST_ASSERT(r.slab[0].high_water == CONFIG_MALLOC_SLAB_64_COUNT);
+	/* The last 64 byte request spilled into the next class */
+	TEST_ASSERT(r.slab[0].misses == 1);
+	TEST_ASSERT(r.slab[1].in_use == 1);
+	TEST_ASSERT(r.slab[3].in_use == 1);
+	TEST_ASSERT(r.free == free_before);
+
+	shared_mem_release(big);
+	for (i = 0; i < ARRAY_SIZE(small); i++)
+		shared_mem_release(small[i]);
+
+	TEST_ASSERT(get_stats(&r) == EC_RES_SUCCESS);
+	for (i = 0; i < EC_SHMEM_SLAB_CLASSES; i++)
+		TEST_ASSERT(r.slab[i].in_use == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_slab_fallback(void)
+{
+	struct ec_response_shmem_stats r;
+	char *bufs[CONFIG_MALLOC_SLAB_1K_COUNT + CONFIG_MALLOC_SLAB_4K_COUNT];
+	char *buf;
+	uint32_t free_before;
+	int i;
+
+	TEST_ASSERT(get_stats(&r) == EC_RES_SUCCESS);
+	free_before = r.free;
+
+	/* With the 1K and 4K slabs full, the first-fit list takes over */
+	for (i = 0; i < ARRAY_SIZE(bufs); i++)
+		TEST_ASSERT(shared_mem_acquire(1024, bufs + i) == EC_SUCCESS);
+	TEST_ASSERT(shared_mem_acquire(300, &buf) == EC_SUCCESS);
+
+	TEST_ASSERT(get_stats(&r) == EC_RES_SUCCESS);
+	TEST_ASSERT(r.slab[2].misses == 2);
+	TEST_ASSERT(r.slab[3].misses == 1);
+	TEST_ASSERT(r.free < free_before);
+
+	shared_mem_release(buf);
+	for (i = 0; i < ARRAY_SIZE(bufs); i++)
+		shared_mem_release(bufs[i]);
+
+	TEST_ASSERT(get_stats(&r) == EC_RES_SUCCESS);
+	TEST_ASSERT(r.free == free_before);
+	TEST_ASSERT(r.free_chunks == 1);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_slab_reuse);
+	RUN_TEST(test_slab_concurrent_users);
+	RUN_TEST(test_slab_fallback);
+
+	test_print_result();
+}
@@ -7,6 +7,7 @@
 #include "motion_sense.h"
 #include "test_util.h"
 #include "timer.h"
+#include "window_stats.h"
 #include <stdio.h>
 
 /*****************************************************************************/
@@ -123,6 +124,46 @@ static int test_resets(void)
 	return EC_SUCCESS;
 }
 
+static int test_window_stats(void)
+{
+	struct window_stats stats;
+	fpv3_t mean, var;
+	int i;
+
+	window_stats_reset(&stats);
+	window_stats_add(&stats, 1.0f, 11.0f, -1.0f);
+	TEST_ASSERT(!window_stats_compute(&stats, true, mean, var));
+	TEST_ASSERT(window_stats_compute(&stats, false, mean, var));
+	TEST_NEAR(var[X], 0.0f, 0.0001f, "%f");
+
+	for (i = 2; i <= 4; ++i)
+		window_stats_add(&stats, i, 10.0f + i, -1.0f);
+
+	TEST_ASSERT(window_stats_compute(&stats, false, mean, var));
+	TEST_NEAR(mean[X], 2.5f, 0.0001f, "%f");
+	TEST_NEAR(mean[Y], 12.5f, 0.0001f, "%f");
+	TEST_NEAR(mean[Z], -1.0f, 0.0001f, "%f");
+	TEST_NEAR(var[X], 1.25f, 0.0001f, "%f");
+	TEST_NEAR(var[Y], 1.25f, 0.0001f, "%f");
+	TEST_NEAR(var[Z], 0.0f, 0.0001f, "%f");
+
+	TEST_ASSERT(window_stats_compute(&stats, true, NULL, var));
+	TEST_NEAR(var[X], 1.6667f, 0.0001f, "%f");
+
+	/* Large offsets stay accurate about an assumed mean. */
+	window_stats_center(&stats, 1.0f, 1001.0f, -1.0f);
+	for (i = 1; i <= 4; ++i)
+		window_stats_add(&stats, i, 1000.0f + i, -1.0f);
+
+	TEST_ASSERT(window_stats_compute(&stats, false, mean, var));
+	TEST_NEAR(mean[X], 2.5f, 0.0001f, "%f");
+	TEST_NEAR(mean[Y], 1002.5f, 0.0001f, "%f");
+	TEST_NEAR(var[X], 1.25f, 0.0001f, "%f");
+	TEST_NEAR(var[Y], 1.25f, 0.0001f, "%f");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -134,6 +175,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_is_still_all_axes);
 	RUN_TEST(test_not_still_one_axis);
 	RUN_TEST(test_resets);
+	RUN_TEST(test_window_stats);
 
 	test_print_result();
 }
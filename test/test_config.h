@@ -17,6 +17,7 @@
 
 /* Host commands are sorted. */
 #define CONFIG_HOSTCMD_SECTION_SORTED
+#define CONFIG_HOSTCMD_LOOKUP_TABLE
 
 /* Don't compile features unless specifically testing for them */
 #undef CONFIG_VBOOT_HASH
@@ -31,6 +32,10 @@
 #define CONFIG_BASE32
 #endif
 
+#ifdef TEST_BOOT_TRACE
+#define CONFIG_BOOT_TRACE
+#endif
+
 #ifdef TEST_BKLIGHT_LID
 #define CONFIG_BACKLIGHT_LID
 #endif
@@ -40,6 +45,10 @@
 #define CONFIG_BACKLIGHT_REQ_GPIO GPIO_PCH_BKLTEN
 #endif
 
+#ifdef TEST_CBI
+#define CONFIG_CBI_LAZY_READ
+#endif
+
 #ifdef TEST_FLASH_LOG
 #define CONFIG_CRC8
 #define CONFIG_FLASH_ERASED_VALUE32 (-1U)
@@ -49,13 +58,19 @@
 #define CONFIG_MALLOC
 #endif
 
+#ifdef TEST_FLASH_PSTATE_LOG
+#define CONFIG_FLASH_PSTATE_LOG
+#endif
+
 #ifdef TEST_KB_8042
 #define CONFIG_KEYBOARD_PROTOCOL_8042
 #endif
 
 #ifdef TEST_KB_MKBP
+#define CONFIG_KEYBOARD_LATENCY_STATS
 #define CONFIG_KEYBOARD_PROTOCOL_MKBP
 #define CONFIG_MKBP_EVENT
+#define CONFIG_MKBP_EVENT_BATCH_MASK BIT(EC_MKBP_EVENT_SWITCH)
 #define CONFIG_MKBP_USE_GPIO
 #endif
 
@@ -92,17 +107,18 @@
 #endif
 
 #if defined(TEST_FPSENSOR) || defined(TEST_FPSENSOR_STATE) || \
-	defined(TEST_FPSENSOR_CRYPTO)
+	defined(TEST_FPSENSOR_CRYPTO) || defined(TEST_FPSENSOR_BENCH)
 #define CONFIG_AES
 #define CONFIG_AES_GCM
 #define CONFIG_ROLLBACK_SECRET_SIZE 32
 #define CONFIG_SHA256
 #endif
 
-#ifdef TEST_MOTION_SENSE_FIFO
+#if defined(TEST_MOTION_SENSE_FIFO) || defined(TEST_MOTION_SENSE_FIFO_BENCH)
 #define CONFIG_ACCEL_FIFO
 #define CONFIG_ACCEL_FIFO_SIZE 256
 #define CONFIG_ACCEL_FIFO_THRES 10
+#define CONFIG_ACCEL_FIFO_HW_TIMESTAMPS
 #endif
 
 #ifdef TEST_KASA
@@ -142,6 +158,14 @@
 #define CONFIG_MKBP_USE_GPIO
 #endif
 
+#ifdef TEST_ONLINE_CALIBRATION_DEFERRED
+#define CONFIG_FPU
+#define CONFIG_ONLINE_CALIB
+#define CONFIG_ONLINE_CALIB_DEFERRED
+#define CONFIG_MKBP_EVENT
+#define CONFIG_MKBP_USE_GPIO
+#endif
+
 #ifdef TEST_GYRO_CAL
 #define CONFIG_FPU
 #define CONFIG_ONLINE_CALIB
@@ -149,6 +173,46 @@
 #define CONFIG_MKBP_USE_GPIO
 #endif
 
+#ifdef TEST_CALIBRATION_BENCH
+#define CONFIG_FPU
+#define CONFIG_ONLINE_CALIB
+#define CONFIG_ACCEL_CAL_MIN_TEMP 20.0f
+#define CONFIG_ACCEL_CAL_MAX_TEMP 40.0f
+#define CONFIG_ACCEL_CAL_KASA_RADIUS_THRES 0.1f
+#define CONFIG_ACCEL_CAL_NEWTON_RADIUS_THRES 0.1f
+#define CONFIG_MKBP_EVENT
+#define CONFIG_MKBP_USE_GPIO
+#endif
+
+#ifdef TEST_EVENT_LOG
+#define CONFIG_CRC8
+#define CONFIG_EVENT_LOG_PRESERVED
+#define CONFIG_EVENT_LOG_NOTIFY
+#define CONFIG_MKBP_EVENT
+#define CONFIG_MKBP_USE_GPIO
+#endif
+
+#ifdef TEST_LZ4
+#define CONFIG_CONSOLE_ENABLE_READ_V2
+#define CONFIG_CONSOLE_READ_LZ4
+#define CONFIG_LZ4
+#endif
+
+#ifdef TEST_PRINTF
+#define CONFIG_CONSOLE_TOKENIZED
+#endif
+
+#ifdef TEST_HOST_COMMAND
+#define CONFIG_HOSTCMD_BATCH
+#define CONFIG_HOSTCMD_TRACE
+#define CONFIG_HOST_COMMAND_STATUS
+#define CONFIG_HOST_COMMAND_ASYNC
+#define CONFIG_HOST_COMMAND_CHANNELS 2
+#define CONFIG_HOST_MEMMAP_NOTIFY
+#define CONFIG_MKBP_EVENT
+#define CONFIG_MKBP_USE_GPIO
+#endif
+
 #if defined(CONFIG_ONLINE_CALIB) && \
 	!defined(CONFIG_TEMP_CACHE_STALE_THRES)
 #define CONFIG_TEMP_CACHE_STALE_THRES (1 * SECOND)
@@ -156,10 +220,12 @@
 
 #if defined(CONFIG_ONLINE_CALIB) || \
 	defined(TEST_BODY_DETECTION) || \
+	defined(TEST_BODY_DETECTION_EW) || \
 	defined(TEST_MOTION_ANGLE) || \
 	defined(TEST_MOTION_ANGLE_TABLET) || \
 	defined(TEST_MOTION_LID) || \
-	defined(TEST_MOTION_SENSE_FIFO)
+	defined(TEST_MOTION_SENSE_FIFO) || \
+	defined(TEST_MOTION_SENSE_FIFO_BENCH)
 enum sensor_id {
 	BASE,
 	LID,
@@ -185,13 +251,18 @@ enum sensor_id {
 #define CONFIG_ACCEL_FORCE_MODE_MASK \
 	((1 << CONFIG_LID_ANGLE_SENSOR_BASE) | \
 	 (1 << CONFIG_LID_ANGLE_SENSOR_LID))
+#define CONFIG_MOTION_SENSE_ALIGN_COLLECTION
 #endif
 
-#if defined(TEST_BODY_DETECTION)
+#if defined(TEST_BODY_DETECTION) || defined(TEST_BODY_DETECTION_EW)
 #define CONFIG_BODY_DETECTION
 #define CONFIG_BODY_DETECTION_SENSOR BASE
 #endif
 
+#ifdef TEST_BODY_DETECTION_EW
+#define CONFIG_BODY_DETECTION_EW_VARIANCE
+#endif
+
 #ifdef TEST_RMA_AUTH
 
 /* Test server public and private keys */
@@ -219,8 +290,29 @@ enum sensor_id {
 
 #endif
 
+#ifdef TEST_CORE_BENCH
+#define CONFIG_AES
+#define CONFIG_AES_GCM
+#define CONFIG_SW_CRC
+#define CONFIG_SHA256
+#define CONFIG_RSA
+#undef CONFIG_RSA_KEY_SIZE
+#define CONFIG_RSA_KEY_SIZE 2048
+#undef CONFIG_RSA_EXPONENT_3
+#define CONFIG_RWSIG_TYPE_RWSIG
+#endif
+
 #ifdef TEST_CRC32
 #define CONFIG_SW_CRC
+#undef CONFIG_SW_CRC_SLICES
+#define CONFIG_SW_CRC_SLICES 8
+#endif
+
+#ifdef TEST_DRBG
+#define CONFIG_RNG_DRBG
+#define CONFIG_SHA256
+#undef CONFIG_RNG_DRBG_RESEED_INTERVAL
+#define CONFIG_RNG_DRBG_RESEED_INTERVAL 8
 #endif
 
 #ifdef TEST_RSA
@@ -252,6 +344,11 @@ enum sensor_id {
 #define CONFIG_MALLOC
 #endif
 
+#ifdef TEST_SHMALLOC_SLAB
+#define CONFIG_MALLOC
+#define CONFIG_MALLOC_SLAB
+#endif
+
 #ifdef TEST_SBS_CHARGING_V2
 #define CONFIG_BATTERY
 #define CONFIG_BATTERY_MOCK
@@ -269,6 +366,14 @@ int board_discharge_on_ac(int enabled);
 #define I2C_PORT_CHARGER 0
 #endif
 
+#ifdef TEST_TRACEPOINT
+#define CONFIG_TRACEPOINTS
+#undef CONFIG_TRACEPOINT_ENTRIES
+#define CONFIG_TRACEPOINT_ENTRIES 16
+#undef CONFIG_TRACEPOINT_CATEGORIES
+#define CONFIG_TRACEPOINT_CATEGORIES (~BIT(EC_TRACEPOINT_CAT_KEYBOARD))
+#endif
+
 #ifdef TEST_THERMAL
 #define CONFIG_CHIPSET_CAN_THROTTLE
 #define CONFIG_FANS 1
@@ -296,6 +401,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #ifdef TEST_BATTERY_GET_PARAMS_SMART
 #define CONFIG_BATTERY_MOCK
 #define CONFIG_BATTERY_SMART
+#define CONFIG_BATTERY_SMART_SLOW_PARAMS_INTERVAL (5 * SECOND)
 #define CONFIG_CHARGER_INPUT_CURRENT 4032
 #define CONFIG_I2C
 #define CONFIG_I2C_MASTER
@@ -352,7 +458,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_SW_CRC
 #endif
 
-#if defined(TEST_USB_PRL)
+#if defined(TEST_USB_PRL) || defined(TEST_USB_PRL_BENCH)
 #define CONFIG_USB_PD_PORT_MAX_COUNT 1
 #define CONFIG_USB_PD_REV30
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
@@ -362,6 +468,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #undef CONFIG_USB_PD_HOST_CMD
 #define CONFIG_USB_PRL_SM
 #define CONFIG_USB_POWER_DELIVERY
+#define CONFIG_USB_PD_TRACE
 #endif
 
 #if defined(TEST_USB_PE_DRP_OLD) || defined(TEST_USB_PE_DRP_OLD_NOEXTENDED)
@@ -459,6 +566,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE
 #define CONFIG_USB_PD_VBUS_DETECT_TCPC
 #define CONFIG_USB_POWER_DELIVERY
+#define CONFIG_USBC_TASK_IDLE_WAIT
 #undef CONFIG_USB_PRL_SM
 #undef CONFIG_USB_PE_SM
 #undef CONFIG_USB_PD_HOST_CMD
@@ -470,6 +578,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE
 #define CONFIG_USB_PD_REV30
 #define CONFIG_USB_PD_TCPC_LOW_POWER
+#define CONFIG_USB_PD_TCPCI_SHADOW_REGS
 #define CONFIG_USB_PD_TRY_SRC
 #define CONFIG_USB_PD_TCPMV2
 #define CONFIG_USB_PD_PORT_MAX_COUNT 1
@@ -489,6 +598,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_PD_DEBUG_LEVEL 3
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
 #define CONFIG_USB_PD_DECODE_SOP
+#define CONFIG_USBC_TASK_IDLE_WAIT
 #endif
 
 #ifdef TEST_USB_PD_INT
@@ -533,6 +643,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 
 #if defined(TEST_CHARGE_MANAGER) || defined(TEST_CHARGE_MANAGER_DRP_CHARGING)
 #define CONFIG_CHARGE_MANAGER
+#define CONFIG_CHARGE_MANAGER_DEBOUNCE_MS 10
 #define CONFIG_USB_PD_DUAL_ROLE
 #define CONFIG_USB_PD_PORT_MAX_COUNT 2
 #define CONFIG_BATTERY
@@ -548,11 +659,15 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #undef CONFIG_CHARGE_MANAGER_DRP_CHARGING
 #endif /* TEST_CHARGE_MANAGER_DRP_CHARGING */
 
-#ifdef TEST_CHARGE_RAMP
+#if defined(TEST_CHARGE_RAMP) || defined(TEST_CHARGE_RAMP_MAX_STEP)
 #define CONFIG_CHARGE_RAMP_SW
 #define CONFIG_USB_PD_PORT_MAX_COUNT 2
 #endif
 
+#ifdef TEST_CHARGE_RAMP_MAX_STEP
+#define CONFIG_CHARGE_RAMP_SW_MAX_STEP_MA 512
+#endif
+
 #ifdef TEST_RTC
 #define CONFIG_HOSTCMD_RTC
 #endif
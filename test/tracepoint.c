@@ -0,0 +1,106 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the tracepoint ring.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "test_util.h"
+#include "tracepoint.h"
+#include "util.h"
+
+static uint8_t buf[sizeof(struct ec_response_tracepoints) +
+		   CONFIG_TRACEPOINT_ENTRIES *
+		   sizeof(struct ec_tracepoint_entry)] __aligned(4);
+static struct ec_response_tracepoints *r = (void *)buf;
+
+static int read_ring(uint32_t seq, uint32_t flags, uint32_t mask)
+{
+	struct ec_params_tracepoints p = {
+		.seq = seq,
+		.flags = flags,
+		.mask = mask,
+	};
+
+	return test_send_host_command(EC_CMD_TRACEPOINTS, 0, &p, sizeof(p),
+				      buf, sizeof(buf));
+}
+
+#define BUILT (BIT(EC_TRACEPOINT_CAT_COUNT) - 1 - \
+	       BIT(EC_TRACEPOINT_CAT_KEYBOARD))
+
+test_static int test_masks(void)
+{
+	uint32_t seq;
+
+	TEST_EQ(read_ring(0, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->built_mask, BUILT, "0x%x");
+	seq = r->next_seq;
+
+	/* Only the categories both built and set are recorded. */
+	TEST_EQ(read_ring(seq, EC_TRACEPOINTS_SET_MASK, 0xffffffff),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->mask, BUILT, "0x%x");
+	TEST_EQ(read_ring(seq, EC_TRACEPOINTS_SET_MASK,
+			  BIT(EC_TRACEPOINT_CAT_I2C)), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->mask, BIT(EC_TRACEPOINT_CAT_I2C), "0x%x");
+
+	TRACEPOINT(EC_TRACEPOINT_I2C_XFER, 1 << 16 | 0x50, EC_SUCCESS);
+	TRACEPOINT(EC_TRACEPOINT_HOSTCMD_DONE, EC_CMD_HELLO, EC_RES_SUCCESS);
+	TRACEPOINT(EC_TRACEPOINT_I2C_XFER, 2 << 16 | 0x51, EC_ERROR_TIMEOUT);
+
+	TEST_EQ(read_ring(seq, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->seq, seq, "%d");
+	TEST_EQ(r->count, 2, "%d");
+	TEST_EQ(r->next_seq, seq + 2, "%d");
+	TEST_EQ(r->entry[0].id, EC_TRACEPOINT_I2C_XFER, "%d");
+	TEST_EQ(r->entry[0].arg[0], 1 << 16 | 0x50, "0x%x");
+	TEST_EQ(r->entry[1].arg[1], EC_ERROR_TIMEOUT, "%d");
+	TEST_GE(r->entry[1].timestamp, r->entry[0].timestamp, "%d");
+
+	/* A category left out of the build isn't recorded at all. */
+	TEST_EQ(read_ring(0, EC_TRACEPOINTS_SET_MASK, 0xffffffff),
+		EC_RES_SUCCESS, "%d");
+	seq = r->next_seq;
+	TRACEPOINT(EC_TRACEPOINT_8042_TO_HOST, 0xfa, 0);
+	TEST_EQ(read_ring(seq, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_wrap(void)
+{
+	uint32_t seq;
+	int i;
+
+	TEST_EQ(read_ring(0, EC_TRACEPOINTS_SET_MASK,
+			  BIT(EC_TRACEPOINT_CAT_HOOK)), EC_RES_SUCCESS, "%d");
+	seq = r->next_seq;
+
+	for (i = 0; i < CONFIG_TRACEPOINT_ENTRIES + 3; i++)
+		TRACEPOINT(EC_TRACEPOINT_HOOK_DEFERRED, i, 0);
+
+	/* Reading starts at the oldest entry still in the ring. */
+	TEST_EQ(read_ring(seq, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->count, CONFIG_TRACEPOINT_ENTRIES, "%d");
+	TEST_EQ(r->seq, seq + 3, "%d");
+	TEST_EQ(r->entry[0].arg[0], 3, "%d");
+	TEST_EQ(r->entry[CONFIG_TRACEPOINT_ENTRIES - 1].arg[0],
+		CONFIG_TRACEPOINT_ENTRIES + 2, "%d");
+
+	/* And ends once caught up. */
+	TEST_EQ(read_ring(r->next_seq, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	RUN_TEST(test_masks);
+	RUN_TEST(test_wrap);
+	test_print_result();
+}
@@ -5,6 +5,7 @@
  * Test USB Protocol Layer module.
  */
 #include "common.h"
+#include "host_command.h"
 #include "mock/tcpc_mock.h"
 #include "mock/tcpm_mock.h"
 #include "mock/usb_pd_mock.h"
@@ -136,6 +137,63 @@ static int test_discard_queued_tx_when_rx_happens(void)
 	return EC_SUCCESS;
 }
 
+/* Find the last trace entry of a type on the port, or NULL */
+static const struct ec_pd_trace_entry *find_trace(
+	const struct ec_response_pd_trace *r, enum ec_pd_trace_type type)
+{
+	int i;
+
+	for (i = r->count - 1; i >= 0; i--)
+		if (r->entry[i].port == PORT0 && r->entry[i].type == type)
+			return &r->entry[i];
+	return NULL;
+}
+
+static int test_trace_messages(void)
+{
+	int port = PORT0;
+	uint16_t header = PD_HEADER(PD_CTRL_DR_SWAP,
+		pd_get_power_role(port),
+		pd_get_data_role(port),
+		mock_tc_port[port].msg_rx_id,
+		0, mock_tc_port[port].rev, 0);
+	struct ec_params_pd_trace p = { .seq = 0 };
+	struct {
+		struct ec_response_pd_trace r;
+		struct ec_pd_trace_entry entry[CONFIG_USB_PD_TRACE_ENTRIES];
+	} resp;
+	const struct ec_pd_trace_entry *e;
+
+	/* GIVEN a control message sent and one received */
+	prl_send_ctrl_msg(port, TCPC_TX_SOP, PD_CTRL_ACCEPT);
+	task_wait_event(MSEC);
+	pd_transmit_complete(port, TCPC_TX_COMPLETE_SUCCESS);
+	task_wait_event(10*MSEC);
+	mock_tcpm_rx_msg(port, header, 0, NULL);
+	task_wait_event(10*MSEC);
+
+	/* THEN both are in the trace, after the transitions they caused */
+	TEST_EQ(test_send_host_command(EC_CMD_PD_TRACE, 0, &p, sizeof(p),
+				       &resp, sizeof(resp)),
+		EC_RES_SUCCESS, "%d");
+	TEST_GT(resp.r.count, 2, "%d");
+	TEST_EQ(resp.r.next_seq, resp.r.seq + resp.r.count, "%d");
+
+	e = find_trace(&resp.r, EC_PD_TRACE_TX);
+	TEST_ASSERT(e != NULL);
+	TEST_EQ(PD_HEADER_TYPE(e->header), PD_CTRL_ACCEPT, "%d");
+	TEST_EQ(e->info, TCPC_TX_SOP, "%d");
+	TEST_EQ(e->value, 0, "%d");
+
+	e = find_trace(&resp.r, EC_PD_TRACE_RX);
+	TEST_ASSERT(e != NULL);
+	TEST_EQ(e->header, header, "0x%x");
+
+	TEST_ASSERT(find_trace(&resp.r, EC_PD_TRACE_STATE) != NULL);
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	mock_tc_port_reset();
@@ -160,6 +218,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_receive_control_msg);
 	RUN_TEST(test_send_control_msg);
 	RUN_TEST(test_discard_queued_tx_when_rx_happens);
+	RUN_TEST(test_trace_messages);
 	/* TODO add tests here */
 
 
@@ -0,0 +1,147 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Benchmark of PD message round trips through the USB Protocol Layer, with
+ * the TCPC, TCPM, policy engine and Type-C state machines mocked.
+ */
+#include "common.h"
+#include "mock/tcpc_mock.h"
+#include "mock/tcpm_mock.h"
+#include "mock/usb_pd_mock.h"
+#include "mock/usb_pe_sm_mock.h"
+#include "mock/usb_tc_sm_mock.h"
+#include "task.h"
+#include "tcpm.h"
+#include "test_util.h"
+#include "timer.h"
+#include "usb_pd.h"
+#include "usb_pe_sm.h"
+#include "usb_prl_sm.h"
+#include "usb_tc_sm.h"
+#include "util.h"
+
+#define PORT0 0
+
+#define BENCH_ROUNDS 1000
+
+/* Install Mock TCPC and MUX drivers */
+const struct tcpc_config_t tcpc_config[CONFIG_USB_PD_PORT_MAX_COUNT] = {
+	{
+		.drv = &mock_tcpc_driver,
+	},
+};
+
+/* Completes every transmission at once, as the PD_INT handler would */
+static int transmit_complete(int port, enum tcpm_transmit_type type,
+			     uint16_t header, const uint32_t *data)
+{
+	pd_transmit_complete(port, TCPC_TX_COMPLETE_SUCCESS);
+	return EC_SUCCESS;
+}
+
+/*
+ * Wake the PD task and wait for it to set |flag|. The emulator only runs the
+ * lower priority PD task while this one sleeps, so poll with a timeout that
+ * is long enough for a full pass of the PD task.
+ */
+static int wait_for_flag(int port, int *flag)
+{
+	int i;
+
+	task_wake(PD_PORT_TO_TASK_ID(port));
+	for (i = 0; !*flag; i++) {
+		if (i == 1000)
+			return EC_ERROR_TIMEOUT;
+		task_wait_event(100);
+	}
+	*flag = 0;
+
+	return EC_SUCCESS;
+}
+
+static void enable_prl(int port, int en)
+{
+	tcpm_set_rx_enable(port, en);
+
+	mock_tc_port[port].pd_enable = en;
+
+	task_wait_event(10*MSEC);
+
+	prl_set_rev(port, TCPC_TX_SOP, mock_tc_port[port].rev);
+}
+
+test_static int test_bench_receive_control_msg(void)
+{
+	int port = PORT0;
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		/* New message IDs, so none is dropped as a retry */
+		uint16_t header = PD_HEADER(PD_CTRL_DR_SWAP,
+			pd_get_power_role(port),
+			pd_get_data_role(port),
+			i % 8, 0, mock_tc_port[port].rev, 0);
+
+		mock_tcpm_rx_msg(port, header, 0, NULL);
+		TEST_EQ(wait_for_flag(port,
+			&mock_pe_port[port].mock_pe_message_received),
+			EC_SUCCESS, "%d");
+		mock_tcpm[port].mock_has_pending_message = 0;
+	}
+	test_bench_report("prl_rx_ctrl_msg", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_bench_send_control_msg(void)
+{
+	int port = PORT0;
+	uint64_t start;
+	int i;
+
+	start = test_bench_now_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		prl_send_ctrl_msg(port, TCPC_TX_SOP, PD_CTRL_ACCEPT);
+		TEST_EQ(wait_for_flag(port,
+			&mock_pe_port[port].mock_pe_message_sent),
+			EC_SUCCESS, "%d");
+	}
+	test_bench_report("prl_tx_ctrl_msg", BENCH_ROUNDS,
+			  test_bench_now_ns() - start);
+
+	TEST_LE(mock_pe_port[port].mock_pe_error, 0, "%d");
+	return EC_SUCCESS;
+}
+
+void before_test(void)
+{
+	mock_tc_port_reset();
+	mock_tc_port[PORT0].rev = PD_REV30;
+	mock_pd_port[PORT0].power_role = PD_ROLE_SOURCE;
+	mock_pd_port[PORT0].data_role = PD_ROLE_DFP;
+
+	mock_tcpc_reset();
+	mock_tcpc.callbacks.transmit = transmit_complete;
+	mock_tcpm_reset();
+	mock_pe_port_reset();
+
+	prl_reset(PORT0);
+	enable_prl(PORT0, 1);
+}
+
+void after_test(void)
+{
+	enable_prl(PORT0, 0);
+}
+
+void run_test(int argc, char **argv)
+{
+	RUN_TEST(test_bench_receive_control_msg);
+	RUN_TEST(test_bench_send_control_msg);
+
+	test_print_result();
+}
@@ -52,6 +52,9 @@ test_static int test_no_parent_cycles(const struct test_sm_data * const sm_data)
 
 		if (depth > sm_data->size)
 			break;
+
+		/* Transitions only track that many levels */
+		TEST_LE(depth, USB_SM_MAX_DEPTH, "%d");
 	}
 
 	/* Ensure all states end, otherwise the ith state has a cycle. */
@@ -115,7 +115,8 @@ void SHA256_init(struct sha256_ctx *ctx)
 	ctx->tot_len = 0;
 }
 
-static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
+#ifndef CONFIG_SHA256_CUSTOM_TRANSFORM
+void SHA256_transform_blocks(uint32_t *h, const uint8_t *message,
 			     unsigned int block_nb)
 {
 	/* Note: this function requires a considerable amount of stack */
@@ -148,7 +149,7 @@ static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 #endif
 
 		for (j = 0; j < 8; j++)
-			wv[j] = ctx->h[j];
+			wv[j] = h[j];
 
 #ifdef CONFIG_SHA256_UNROLLED
 		for (j = 0; j < 64; j += 8) {
@@ -178,9 +179,18 @@ static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 #endif
 
 		for (j = 0; j < 8; j++)
-			ctx->h[j] += wv[j];
+			h[j] += wv[j];
 	}
 }
+#endif /* !CONFIG_SHA256_CUSTOM_TRANSFORM */
+
+static inline void SHA256_transform(struct sha256_ctx *ctx,
+				    const uint8_t *message,
+				    unsigned int block_nb)
+{
+	if (block_nb)
+		SHA256_transform_blocks(ctx->h, message, block_nb);
+}
 
 void SHA256_update(struct sha256_ctx *ctx, const uint8_t *data, uint32_t len)
 {
@@ -188,6 +198,15 @@ void SHA256_update(struct sha256_ctx *ctx, const uint8_t *data, uint32_t len)
 	unsigned int new_len, rem_len, tmp_len;
 	const uint8_t *shifted_data;
 
+	/* Hash whole blocks straight from data when nothing is buffered */
+	if (!ctx->len && len >= SHA256_BLOCK_SIZE) {
+		block_nb = len / SHA256_BLOCK_SIZE;
+		SHA256_transform(ctx, data, block_nb);
+		ctx->tot_len += block_nb << 6;
+		data += block_nb << 6;
+		len -= block_nb << 6;
+	}
+
 	tmp_len = SHA256_BLOCK_SIZE - ctx->len;
 	rem_len = len < tmp_len ? len : tmp_len;
 
@@ -83,6 +83,86 @@ int ec_command(int command, int version,
 				indata, insize);
 }
 
+/* Sub-requests and sub-responses start on 4-byte boundaries */
+#define BATCH_ALIGN(size) (((size) + 3) & ~3)
+
+int ec_command_batch(struct ec_batch_cmd *cmds, int count)
+{
+	struct ec_params_batch *p;
+	struct ec_response_batch *r;
+	uint8_t *out, *in, *in_end;
+	int rv;
+	int i;
+
+	if (count > UINT8_MAX)
+		return -EC_RES_INVALID_PARAM;
+
+	p = malloc(ec_max_outsize);
+	r = malloc(ec_max_insize);
+	if (!p || !r) {
+		rv = -EC_RES_ERROR;
+		goto out;
+	}
+
+	p->count = count;
+	memset(p->reserved, 0, sizeof(p->reserved));
+	out = (uint8_t *)(p + 1);
+
+	for (i = 0; i < count; i++) {
+		struct ec_params_batch_cmd *c = (void *)out;
+
+		cmds[i].result = -1;
+		cmds[i].inlen = 0;
+
+		if (cmds[i].outsize > UINT8_MAX ||
+		    out + BATCH_ALIGN(sizeof(*c) + cmds[i].outsize) >
+		    (uint8_t *)p + ec_max_outsize) {
+			rv = -EC_RES_REQUEST_TRUNCATED;
+			goto out;
+		}
+
+		c->command = cmds[i].command;
+		c->version = cmds[i].version;
+		c->data_len = cmds[i].outsize;
+		memcpy(c + 1, cmds[i].outdata, cmds[i].outsize);
+		out += BATCH_ALIGN(sizeof(*c) + cmds[i].outsize);
+	}
+
+	rv = ec_command(EC_CMD_BATCH, 0, p, out - (uint8_t *)p,
+			r, ec_max_insize);
+	if (rv < 0)
+		goto out;
+	if (rv < sizeof(*r) || r->count > count) {
+		rv = -EC_RES_INVALID_RESPONSE;
+		goto out;
+	}
+
+	in = (uint8_t *)(r + 1);
+	in_end = (uint8_t *)r + rv;
+
+	for (i = 0; i < r->count; i++) {
+		struct ec_response_batch_cmd *c = (void *)in;
+
+		if (in + sizeof(*c) > in_end ||
+		    in + sizeof(*c) + c->data_len > in_end) {
+			rv = -EC_RES_INVALID_RESPONSE;
+			goto out;
+		}
+
+		cmds[i].result = c->result;
+		cmds[i].inlen = c->data_len < cmds[i].insize ?
+			c->data_len : cmds[i].insize;
+		memcpy(cmds[i].indata, c + 1, cmds[i].inlen);
+		in += BATCH_ALIGN(sizeof(*c) + c->data_len);
+	}
+
+	rv = r->count;
+out:
+	free(p);
+	free(r);
+	return rv;
+}
+
 int comm_init_alt(int interfaces, const char *device_name, int i2c_bus)
 {
 	bool dev_is_cros_ec;
@@ -66,6 +66,28 @@ int ec_command(int command, int version,
 	       const void *outdata, int outsize,   /* to the EC */
 	       void *indata, int insize);	   /* from the EC */
 
+/* One command of a batch sent with ec_command_batch() */
+struct ec_batch_cmd {
+	int command;
+	int version;
+	const void *outdata;	/* to the EC, at most 255 bytes */
+	int outsize;
+	void *indata;		/* from the EC */
+	int insize;
+	/*
+	 * Set by ec_command_batch(): the enum ec_status of the command, or -1
+	 * if the EC did not run it, and the length of data returned.
+	 */
+	int result;
+	int inlen;
+};
+
+/**
+ * Send several commands to the EC in a single EC_CMD_BATCH request.  Returns
+ * the number of commands run, or negative on error.
+ */
+int ec_command_batch(struct ec_batch_cmd *cmds, int count);
+
 /**
  * Set the offset to be applied to the command number when ec_command() calls
  * ec_command_proto().
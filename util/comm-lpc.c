@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <sys/io.h>
 #include <sys/param.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "comm-host.h"
@@ -17,31 +18,51 @@
 #define INITIAL_UDELAY 5     /* 5 us */
 #define MAXIMUM_UDELAY 10000 /* 10 ms */
 
+/*
+ * Time to poll the status port without sleeping. Most commands complete
+ * well within this, and a sleep costs far more than its nominal duration
+ * once the scheduler is involved.
+ */
+#define SPIN_USEC 200
+
+static uint64_t time_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 /*
  * Wait for the EC to be unbusy.  Returns 0 if unbusy, non-zero if
  * timeout.
  */
 static int wait_for_ec(int status_addr, int timeout_usec)
 {
-	int i;
+	uint64_t start = time_usec();
+	uint64_t now = start;
 	int delay = INITIAL_UDELAY;
 
-	for (i = 0; i < timeout_usec; i += delay) {
-		/*
-		 * Delay first, in case we just sent out a command but the EC
-		 * hasn't raised the busy flag.  However, I think this doesn't
-		 * happen since the LPC commands are executed in order and the
-		 * busy flag is set by hardware.  Minor issue in any case,
-		 * since the initial delay is very short.
-		 */
-		usleep(MIN(delay, timeout_usec - i));
+	/*
+	 * The busy flag is set by hardware as soon as the command byte is
+	 * written, so the status can be checked right away.  Each inb() is a
+	 * bus cycle, which paces this loop.
+	 */
+	while (now - start < MIN(SPIN_USEC, timeout_usec)) {
+		if (!(inb(status_addr) & EC_LPC_STATUS_BUSY_MASK))
+			return 0;
+		now = time_usec();
+	}
+
+	/* Slow command: back off to sleeping, doubling the interval */
+	while (now - start < timeout_usec) {
+		usleep(MIN(delay, timeout_usec - (now - start)));
 
 		if (!(inb(status_addr) & EC_LPC_STATUS_BUSY_MASK))
 			return 0;
 
-		/* Increase the delay interval after a few rapid checks */
-		if (i > 20)
-			delay = MIN(delay * 2, MAXIMUM_UDELAY);
+		delay = MIN(delay * 2, MAXIMUM_UDELAY);
+		now = time_usec();
 	}
 	return -1;  /* Timeout */
 }
@@ -32,6 +32,7 @@ import six
 
 import interpreter
 import threadproc_shim
+import tokens
 
 
 PROMPT = b'> '
@@ -65,6 +66,14 @@ ENHANCED_EC_INTERROGATION_TIMEOUT = 1.0  # Maximum number of seconds to wait for
 INTERROGATION_MODES = [b'never', b'always', b'auto']
 # Format for printing host timestamp
 HOST_STRFTIME="%y-%m-%d %H:%M:%S.%f"
+# Splits MCU output into runs of printable ASCII and single other bytes, for
+# the debug log of the console output.
+LOG_TOKEN_RE = re.compile(br'([ -~]+)|(.)', re.DOTALL)
+LOG_SYMBOLS = {
+    b'\n': u'\\n',
+    b'\r': u'\\r',
+    b'\t': u'\\t',
+}
 
 
 class EscState(object):
@@ -186,6 +195,8 @@ class Console(object):
     self.look_buffer = b''
     self.raw_debug = False
     self.output_line_log_buffer = []
+    # Decodes EC output when the EC image uses CONFIG_CONSOLE_TOKENIZED.
+    self.token_decoder = None
 
   def __str__(self):
     """Show internal state of Console object as a string."""
@@ -217,37 +228,31 @@ class Console(object):
     Args:
       data: binary string received from MCU
     """
-    data = list(data)
+    # Skip the line assembly entirely when it would not be logged.
+    if not self.logger.isEnabledFor(logging.DEBUG):
+      return
 
     # This is a list of already filtered characters (or placeholders).
     line = self.output_line_log_buffer
 
-    symbols = {
-            b'\n': u'\\n',
-            b'\r': u'\\r',
-            b'\t': u'\\t'
-    }
-    # self.logger.debug(u'%s + %r', u''.join(line), ''.join(data))
-    while data:
-      byte = data.pop(0)
-      if byte == '\n':
-        line.append(symbols[byte])
-        if line:
-          self.logger.debug(u'%s', ''.join(line))
+    # Runs of printable ASCII are handled in bulk, other bytes one by one.
+    for match in LOG_TOKEN_RE.finditer(data):
+      text, byte = match.groups()
+      if text:
+        line.extend(text.decode('ascii'))
+      elif byte == b'\n':
+        line.append(LOG_SYMBOLS[byte])
+        self.logger.debug(u'%s', u''.join(line))
         line = []
       elif byte == b'\b':
         # Backspace: trim the last character off the buffer
         if line:
           line.pop(-1)
-      elif byte in symbols:
-        line.append(symbols[byte])
-      elif byte < b' ' or byte > b'~':
+      elif byte in LOG_SYMBOLS:
+        line.append(LOG_SYMBOLS[byte])
+      else:
         # Turn any character that isn't printable ASCII into escaped hex.
-        # ' ' is chr(20), and 0-19 are unprintable control characters.
-        # '~' is chr(126), and 127 is DELETE.  128-255 are control and Latin-1.
         line.append(u'\\x%02x' % ord(byte))
-      else:
-        line.append(u'%s' % byte)
     self.output_line_log_buffer = line
 
   def PrintHistory(self):
@@ -503,7 +508,7 @@ class Console(object):
         interrogation correctly.
 
     Raises:
-      EOFError: Allowed to propagate through from self.dbg_pipe.recv().
+      EOFError: Allowed to propagate through from self.dbg_pipe.recv_bytes().
     """
     # Send interrogation byte and wait for the response.
     self.logger.debug('Performing interrogation.')
@@ -511,7 +516,7 @@ class Console(object):
 
     response = ''
     if self.dbg_pipe.poll(self.interrogation_timeout):
-      response = self.dbg_pipe.recv()
+      response = self.dbg_pipe.recv_bytes()
       self.logger.debug('response: \'%s\'', binascii.hexlify(response))
     else:
       self.logger.debug('Timed out waiting for EC_ACK')
@@ -540,7 +545,7 @@ class Console(object):
 
     Raises:
       EOFError: Allowed to propagate through from self.CheckForEnhancedECImage()
-          i.e. from self.dbg_pipe.recv().
+          i.e. from self.dbg_pipe.recv_bytes().
     """
     fd = self.master_pty
 
@@ -1020,11 +1025,15 @@ def StartLoop(console, command_active, shutdown_pipe=None):
 
         elif obj is console.dbg_pipe:
           try:
-            data = console.dbg_pipe.recv()
+            data = console.dbg_pipe.recv_bytes()
           except EOFError:
             console.logger.debug('ec3po console received EOF from dbg_pipe')
             continue_looping = False
           else:
+            if console.token_decoder:
+              data = console.token_decoder.Feed(data)
+              if not data:
+                continue
             if console.interrogation_mode == b'auto':
               # Search look buffer for enhanced EC image string.
               console.CheckBufferForEnhancedImage(data)
@@ -1103,6 +1112,9 @@ def main(argv):
   parser.add_argument('--log-level',
                       default='info',
                       help='info, debug, warning, error, or critical')
+  parser.add_argument('--elf', action='append', default=[],
+                      help=('EC ELF file (e.g. ec.RW.elf) to decode tokenized'
+                            ' console output with; may be repeated'))
 
   # Parse arguments.
   opts = parser.parse_args(argv)
@@ -1153,6 +1165,9 @@ def main(argv):
   # Create a console.
   console = Console(master_pty, os.ttyname(user_pty), cmd_pipe_interactive,
                     dbg_pipe_interactive)
+  if opts.elf:
+    console.token_decoder = tokens.TokenDecoder(
+        tokens.ElfStrings(opts.elf).Lookup)
   # Start serving the console.
   v = threadproc_shim.Value(ctypes.c_bool, False)
   StartLoop(console, v)
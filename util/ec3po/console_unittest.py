@@ -1255,14 +1255,14 @@ class TestConsoleCompatibility(unittest.TestCase):
     """Verify that the check returns true if the ACK is received."""
     # Make the debug pipe return EC_ACK.
     self.console.dbg_pipe.poll.return_value = True
-    self.console.dbg_pipe.recv.return_value = interpreter.EC_ACK
+    self.console.dbg_pipe.recv_bytes.return_value = interpreter.EC_ACK
     self.assertTrue(self.console.CheckForEnhancedECImage())
 
   def test_EnhancedCheckIfWrong(self):
     """Verify that the check returns false if byte received is wrong."""
     # Make the debug pipe return the wrong byte.
     self.console.dbg_pipe.poll.return_value = True
-    self.console.dbg_pipe.recv.return_value = b'\xff'
+    self.console.dbg_pipe.recv_bytes.return_value = b'\xff'
     self.assertFalse(self.console.CheckForEnhancedECImage())
 
   def test_EnhancedCheckUsingBuffer(self):
@@ -1342,6 +1342,15 @@ Console is enabled; type HELP for help.
     # Check that command was also sent to the interpreter.
     self.console.cmd_pipe.send.assert_called_once_with(b'enhanced False')
 
+  def test_LogConsoleOutputAssemblesLines(self):
+    """Verify that MCU output is logged one escaped line at a time."""
+    with mock.patch.object(self.console.logger, 'debug') as mock_debug:
+      self.console.LogConsoleOutput(b'[0.1 spin|\b/\b')
+      mock_debug.assert_not_called()
+      self.console.LogConsoleOutput(b'ok\x01]\r\nnext')
+      mock_debug.assert_called_once_with(u'%s', u'[0.1 spinok\\x01]\\r\\n')
+    self.assertEqual(u''.join(self.console.output_line_log_buffer), u'next')
+
 
 class TestOOBMConsoleCommands(unittest.TestCase):
   """Verify that OOBM console commands work correctly."""
@@ -28,7 +28,8 @@ import six
 
 
 COMMAND_RETRIES = 3  # Number of attempts to retry a command.
-EC_MAX_READ = 1024  # Max bytes to read at a time from the EC.
+EC_MAX_READ = 4096  # Max bytes to read at a time from the EC.
+EC_MAX_BURST = 16384  # Max bytes gathered from the EC before forwarding them.
 EC_SYN = b'\xec'  # Byte indicating EC interrogation.
 EC_ACK = b'\xc0'  # Byte representing correct EC response to interrogation.
 
@@ -333,7 +334,19 @@ class Interpreter(object):
     self.logger.log(1, 'EC has data')
     # Read what the EC sent us.
     data = os.read(self.ec_uart_pty.fileno(), EC_MAX_READ)
-    self.logger.log(1, 'got: \'%s\'', binascii.hexlify(data))
+    # At high log rates, gather everything already pending so that it is
+    # forwarded in one message rather than one per read.  An interrogation
+    # response is checked on its own.
+    while not self.interrogating and 0 < len(data) < EC_MAX_BURST:
+      readable, _, _ = select.select([self.ec_uart_pty], [], [], 0)
+      if not readable:
+        break
+      more = os.read(self.ec_uart_pty.fileno(), EC_MAX_READ)
+      if not more:
+        break
+      data += more
+    if self.logger.isEnabledFor(1):
+      self.logger.log(1, 'got: \'%s\'', binascii.hexlify(data))
     if b'&E' in data and self.enhanced_ec:
       # We received an error, so we should retry it if possible.
       self.logger.warning('Error string found in data.')
@@ -350,9 +363,10 @@ class Interpreter(object):
         self.logger.debug('The current EC image does NOT seem enhanced.')
       # Done interrogating.
       self.interrogating = False
-    # For now, just forward everything the EC sends us.
+    # For now, just forward everything the EC sends us.  The data is sent as
+    # a raw byte message, which spares pickling it.
     self.logger.log(1, 'Forwarding to user...')
-    self.dbg_pipe.send(data)
+    self.dbg_pipe.send_bytes(data)
 
   def HandleUserData(self):
     """Handle any incoming commands from the user.
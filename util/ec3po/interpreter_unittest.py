@@ -119,14 +119,19 @@ class TestEnhancedECBehaviour(unittest.TestCase):
     # Finally, verify that the appropriate writes were actually sent to the EC.
     self.ec_uart_pty.assert_has_calls(expected_ec_calls)
 
+  @mock.patch('interpreter.select')
   @mock.patch('interpreter.os')
-  def test_CommandRetryingOnError(self, mock_os):
+  def test_CommandRetryingOnError(self, mock_os, mock_select):
     """Verify that commands are retried if an error is encountered.
 
     Args:
       mock_os: MagicMock object replacing the 'os' module for this test
         case.
+      mock_select: MagicMock object replacing the 'select' module for this
+        test case.
     """
+    # No more EC data is pending after each read.
+    mock_select.select.return_value = ([], [], [])
     # The interpreter init should open the EC UART PTY.
     expected_ec_calls = [mock.call(self.tempfile.name, 'ab+')]
     # Have a command come in the command pipe.  The first command will be an
@@ -180,6 +185,27 @@ class TestEnhancedECBehaviour(unittest.TestCase):
     # Verify all the calls.
     self.ec_uart_pty.assert_has_calls(expected_ec_calls)
 
+  @mock.patch('interpreter.select')
+  @mock.patch('interpreter.os')
+  def test_PendingECDataIsForwardedAtOnce(self, mock_os, mock_select):
+    """Verify that EC data already pending is gathered into one message.
+
+    Args:
+      mock_os: MagicMock object replacing the 'os' module for this test
+        case.
+      mock_select: MagicMock object replacing the 'select' module for this
+        test case.
+    """
+    mock_os.read.side_effect = [b'[0.1 ', b'line]\r\n']
+    # The second chunk is pending when the first one has been read.
+    mock_select.select.side_effect = [([self.itpr.ec_uart_pty], [], []),
+                                      ([], [], [])]
+    self.itpr.HandleECData()
+
+    self.assertTrue(self.dbg_pipe_user.poll(0))
+    self.assertEqual(self.dbg_pipe_user.recv_bytes(), b'[0.1 line]\r\n')
+    self.assertFalse(self.dbg_pipe_user.poll(0))
+
   def test_PackCommandsForEnhancedEC(self):
     """Verify that the interpreter packs commands for enhanced EC images."""
     # Assume current EC image is enhanced.
@@ -0,0 +1,297 @@
+# Copyright 2020 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""EC-3PO tokenized console output decoder
+
+An EC built with CONFIG_CONSOLE_TOKENIZED sends cprints() and cprintf() output
+as token records instead of text.  A record is framed by UART_TOKEN_START and
+UART_TOKEN_END, with bytes colliding with the framing escaped by
+UART_TOKEN_ESC.  It holds the address of the format string in the EC image and
+the raw arguments, as encoded by vfntokenize() in common/printf.c.  This module
+looks the format strings up in the EC ELF files and formats the output.
+"""
+
+# Note: This is a py2/3 compatible file.
+
+from __future__ import print_function
+
+import struct
+
+
+TOKEN_ESC = 0x1d
+TOKEN_START = 0x1e
+TOKEN_END = 0x1f
+TOKEN_START_BYTE = bytearray([TOKEN_START])
+
+# Drop records longer than this; the end of the record was probably lost.
+MAX_RECORD_SIZE = 1024
+
+# Flag in bit 0 of the token: the record starts with a timestamp.
+TOKEN_TIMESTAMP = 0x1
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+class ElfStrings(object):
+  """Reads null-terminated strings at addresses of loaded ELF sections."""
+
+  def __init__(self, paths):
+    self.sections = []
+    for path in paths:
+      with open(path, 'rb') as f:
+        self._LoadSections(bytearray(f.read()))
+
+  def _LoadSections(self, elf):
+    if elf[:4] != b'\x7fELF':
+      raise ValueError('Not an ELF file')
+    is_64 = elf[4] == 2
+    endian = '<' if elf[5] == 1 else '>'
+    if is_64:
+      shoff, = struct.unpack_from(endian + 'Q', elf, 0x28)
+      shentsize, shnum = struct.unpack_from(endian + 'HH', elf, 0x3a)
+      shdr = endian + 'IIQQQQ'
+    else:
+      shoff, = struct.unpack_from(endian + 'I', elf, 0x20)
+      shentsize, shnum = struct.unpack_from(endian + 'HH', elf, 0x2e)
+      shdr = endian + 'IIIIII'
+
+    for i in range(shnum):
+      (_, sh_type, flags, addr, offset,
+       size) = struct.unpack_from(shdr, elf, shoff + i * shentsize)
+      if flags & SHF_ALLOC and sh_type != SHT_NOBITS and size:
+        self.sections.append((addr, elf[offset:offset + size]))
+
+  def Lookup(self, addr):
+    """Returns the string at addr as bytes, or None if it is not loaded."""
+    for base, data in self.sections:
+      if base <= addr < base + len(data):
+        end = data.find(b'\0', addr - base)
+        if end < 0:
+          end = len(data)
+        return bytes(data[addr - base:end])
+    return None
+
+
+class _Args(object):
+  """Reads the arguments of a token record."""
+
+  def __init__(self, data):
+    self.data = data
+    self.pos = 0
+
+  def Varint(self):
+    value = 0
+    shift = 0
+    while True:
+      if self.pos >= len(self.data):
+        raise IndexError('Truncated record')
+      c = self.data[self.pos]
+      self.pos += 1
+      value |= (c & 0x7f) << shift
+      shift += 7
+      if not c & 0x80:
+        return value
+
+  def Bytes(self, size):
+    if self.pos + size > len(self.data):
+      raise IndexError('Truncated record')
+    value = self.data[self.pos:self.pos + size]
+    self.pos += size
+    return bytes(value)
+
+  def String(self):
+    end = self.data.find(b'\0', self.pos)
+    if end < 0:
+      raise IndexError('Truncated record')
+    value = self.data[self.pos:end]
+    self.pos = end + 1
+    return bytes(value)
+
+
+def _FormatInt(value, conv, precision, sign):
+  """Formats an integer like vfnprintf(), including its '.' precision."""
+  if conv == 'x':
+    digits = '%x' % value
+  elif conv == 'X':
+    digits = '%X' % value
+  elif conv == 'b':
+    digits = bin(value)[2:]
+  else:
+    digits = '%d' % abs(value)
+    if value < 0:
+      sign = '-'
+
+  if precision > 0:
+    digits = digits.rjust(precision + 1, '0')
+    digits = digits[:-precision] + '.' + digits[-precision:]
+
+  return (sign or '') + digits
+
+
+def FormatRecord(fmt, args):
+  """Formats the arguments of a record with the EC format string fmt.
+
+  Args:
+    fmt: The format string, as bytes.
+    args: _Args reading the record arguments.
+
+  Returns:
+    The formatted output as bytes.
+  """
+  out = []
+  fmt = fmt.decode('ascii', 'replace')
+  i = 0
+  while i < len(fmt):
+    c = fmt[i]
+    i += 1
+    if c != '%':
+      out.append(c)
+      continue
+
+    left = zero = False
+    sign = None
+    width = 0
+    precision = -1
+    while i < len(fmt) and fmt[i] in '-+0':
+      left |= fmt[i] == '-'
+      zero |= fmt[i] == '0'
+      if fmt[i] == '+':
+        sign = '+'
+      i += 1
+    if i < len(fmt) and fmt[i] == '*':
+      width = struct.unpack('<i', struct.pack('<I', args.Varint()))[0]
+      i += 1
+    while i < len(fmt) and fmt[i].isdigit():
+      width = 10 * width + int(fmt[i])
+      i += 1
+    if i < len(fmt) and fmt[i] == '.':
+      precision = 0
+      i += 1
+      if i < len(fmt) and fmt[i] == '*':
+        precision = struct.unpack('<i', struct.pack('<I', args.Varint()))[0]
+        i += 1
+      while i < len(fmt) and fmt[i].isdigit():
+        precision = 10 * precision + int(fmt[i])
+        i += 1
+    bits = 32
+    while i < len(fmt) and fmt[i] in 'lz':
+      bits = 64
+      i += 1
+    if i >= len(fmt):
+      out.append('%')
+      break
+    conv = fmt[i]
+    i += 1
+
+    if conv == '%':
+      out.append('%')
+      continue
+    if conv == 's':
+      value = args.String().decode('ascii', 'replace')
+    elif conv == 'p':
+      spec = fmt[i] if i < len(fmt) else ''
+      i += 1
+      if spec == 'h':
+        value = ''.join('%02x' % b
+                        for b in bytearray(args.Bytes(args.Varint())))
+      elif spec == 'b':
+        count = args.Varint()
+        value = bin(args.Varint())[2:].rjust(count, '0')
+      elif spec == 'T':
+        us = args.Varint()
+        value = '%d.%06d' % (us // 1000000, us % 1000000)
+      else:
+        value = '%x' % args.Varint()
+    else:
+      value = args.Varint()
+      if conv in 'di' and value >> (bits - 1):
+        value -= 1 << bits
+      if conv == 'c':
+        value = chr(value & 0xff)
+      else:
+        value = _FormatInt(value, conv, precision, sign if conv in 'di'
+                           else None)
+
+    if left:
+      value = value.ljust(width)
+    elif zero and conv != 's':
+      value = value.rjust(width, '0')
+    else:
+      value = value.rjust(width)
+    out.append(value)
+
+  return ''.join(out).replace('\n', '\r\n').encode('ascii', 'replace')
+
+
+class TokenDecoder(object):
+  """Replaces token records in the EC output stream with decoded text.
+
+  Attributes:
+    lookup: Function returning the format string at an address, or None.
+  """
+
+  def __init__(self, lookup):
+    self.lookup = lookup
+    self.record = None
+    self.escape = False
+
+  def _Decode(self, record):
+    args = _Args(record)
+    try:
+      token = args.Varint()
+      fmt = self.lookup(token >> 1)
+      if fmt is None:
+        return b'[unknown token 0x%x]\r\n' % (token >> 1)
+      prefix = suffix = b''
+      if token & TOKEN_TIMESTAMP:
+        us = args.Varint()
+        prefix = b'[%d.%06d ' % (us // 1000000, us % 1000000)
+        suffix = b']\r\n'
+      return prefix + FormatRecord(fmt, args) + suffix
+    except IndexError:
+      return b'[truncated token record]\r\n'
+
+  def Feed(self, data):
+    """Decodes a chunk of EC output.
+
+    Records split across chunks are held until their end arrives.
+
+    Args:
+      data: The bytes received from the EC.
+
+    Returns:
+      The bytes to show, with records replaced by their text.
+    """
+    data = bytearray(data)
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+      if self.record is None:
+        # Plain text is copied in bulk up to the next record.
+        start = data.find(TOKEN_START_BYTE, pos)
+        if start < 0:
+          out += data[pos:]
+          break
+        out += data[pos:start]
+        pos = start
+      c = data[pos]
+      pos += 1
+      if c == TOKEN_START:
+        # A new record also ends one whose end was lost.
+        self.record = bytearray()
+        self.escape = False
+      elif c == TOKEN_END:
+        out += self._Decode(self.record)
+        self.record = None
+      elif c == TOKEN_ESC:
+        self.escape = True
+      else:
+        if self.escape:
+          c ^= 0x20
+          self.escape = False
+        self.record.append(c)
+        if len(self.record) > MAX_RECORD_SIZE:
+          self.record = None
+    return bytes(out)
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+# Copyright 2020 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Unit tests for the EC-3PO tokenized console output decoder."""
+
+# Note: This is a py2/3 compatible file.
+
+from __future__ import print_function
+
+import unittest
+
+import tokens
+
+
+def Varint(value):
+  out = bytearray()
+  while True:
+    c = value & 0x7f
+    value >>= 7
+    if value:
+      out.append(c | 0x80)
+    else:
+      out.append(c)
+      return bytes(out)
+
+
+def Record(payload):
+  out = bytearray([tokens.TOKEN_START])
+  for c in bytearray(payload):
+    if tokens.TOKEN_ESC <= c <= tokens.TOKEN_END:
+      out += bytearray([tokens.TOKEN_ESC, c ^ 0x20])
+    else:
+      out.append(c)
+  out.append(tokens.TOKEN_END)
+  return bytes(out)
+
+
+class TestTokenDecoder(unittest.TestCase):
+  """Test case to verify decoding of token records."""
+
+  def setUp(self):
+    self.strings = {
+        0x1000: b'PD %d: state %s',
+        0x1004: b'%5d|%-3x|%.3d|%llx\n',
+        0x1008: b'%ph %pb %c',
+    }
+    self.decoder = tokens.TokenDecoder(self.strings.get)
+
+  def test_Cprints(self):
+    """Verify timestamped records get brackets like cprints()."""
+    record = Record(Varint(0x1000 << 1 | tokens.TOKEN_TIMESTAMP) +
+                    Varint(1234567) + Varint(1) + b'SNK_READY\0')
+    self.assertEqual(self.decoder.Feed(b'> ' + record),
+                     b'> [1.234567 PD 1: state SNK_READY]\r\n')
+
+  def test_Numbers(self):
+    """Verify widths, precision and signed values."""
+    record = Record(Varint(0x1004 << 1) + Varint(0xffffffff) + Varint(0x1e) +
+                    Varint(1500) + Varint(0x123456789))
+    self.assertEqual(self.decoder.Feed(record),
+                     b'   -1|1e |1.500|123456789\r\n')
+
+  def test_Pointers(self):
+    """Verify hex buffers, binary values and characters."""
+    record = Record(Varint(0x1008 << 1) + Varint(2) + b'\x00\x1e' +
+                    Varint(4) + Varint(5) + Varint(ord('z')))
+    self.assertEqual(self.decoder.Feed(record), b'001e 0101 z')
+
+  def test_SplitRecord(self):
+    """Verify records split across reads are held until complete."""
+    record = Record(Varint(0x1000 << 1) + Varint(2) + b'OFF\0')
+    self.assertEqual(self.decoder.Feed(record[:3]), b'')
+    self.assertEqual(self.decoder.Feed(record[3:] + b'ok'),
+                     b'PD 2: state OFFok')
+
+  def test_LostEnd(self):
+    """Verify a new record drops one whose end got lost."""
+    record = Record(Varint(0x1000 << 1) + Varint(3) + b'ON\0')
+    self.assertEqual(self.decoder.Feed(record[:4] + record),
+                     b'PD 3: state ON')
+
+  def test_TextAroundRecords(self):
+    """Verify plain text around and between records is passed through."""
+    record = Record(Varint(0x1000 << 1) + Varint(1) + b'ON\0')
+    self.assertEqual(self.decoder.Feed(b'a\r\n' + record + b'b' + record),
+                     b'a\r\nPD 1: state ONbPD 1: state ON')
+    self.assertEqual(self.decoder.Feed(b'plain text only'), b'plain text only')
+
+  def test_UnknownToken(self):
+    """Verify records with an unknown format string are flagged."""
+    self.assertEqual(self.decoder.Feed(Record(Varint(0x2000 << 1))),
+                     b'[unknown token 0x2000]\r\n')
+
+
+if __name__ == '__main__':
+  unittest.main()
@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "comm-host.h"
+#include "ec_flash.h"
 #include "misc_util.h"
 #include "timer.h"
 
@@ -23,17 +24,16 @@ int ec_flash_read(uint8_t *buf, int offset, int size)
 	int rv;
 	int i;
 
-	/* Read data in chunks */
+	/* Read data in chunks, straight into the caller's buffer */
 	for (i = 0; i < size; i += ec_max_insize) {
 		p.offset = offset + i;
 		p.size = MIN(size - i, ec_max_insize);
 		rv = ec_command(EC_CMD_FLASH_READ, 0,
-				&p, sizeof(p), ec_inbuf, p.size);
+				&p, sizeof(p), buf + i, p.size);
 		if (rv < 0) {
 			fprintf(stderr, "Read error at offset %d\n", i);
 			return rv;
 		}
-		memcpy(buf + i, ec_inbuf, p.size);
 	}
 
 	return 0;
@@ -41,33 +41,39 @@ int ec_flash_read(uint8_t *buf, int offset, int size)
 
 int ec_flash_verify(const uint8_t *buf, int offset, int size)
 {
-	uint8_t *rbuf = malloc(size);
-	int rv;
-	int i;
+	uint8_t *rbuf = malloc(ec_max_insize);
+	int rv = 0;
+	int i, j;
 
 	if (!rbuf) {
 		fprintf(stderr, "Unable to allocate buffer.\n");
 		return -1;
 	}
 
-	rv = ec_flash_read(rbuf, offset, size);
-	if (rv < 0) {
-		free(rbuf);
-		return rv;
-	}
-
-	for (i = 0; i < size; i++) {
-		if (buf[i] != rbuf[i]) {
-			fprintf(stderr, "Mismatch at offset 0x%x: "
-				"want 0x%02x, got 0x%02x\n",
-				i, buf[i], rbuf[i]);
-			free(rbuf);
-			return -1;
+	/*
+	 * Compare each chunk as soon as it is read, so a mismatch stops the
+	 * verification without reading back the rest of the region.
+	 */
+	for (i = 0; i < size && !rv; i += ec_max_insize) {
+		int chunk = MIN(size - i, ec_max_insize);
+
+		rv = ec_flash_read(rbuf, offset + i, chunk);
+		if (rv < 0)
+			break;
+
+		for (j = 0; j < chunk; j++) {
+			if (buf[i + j] != rbuf[j]) {
+				fprintf(stderr, "Mismatch at offset 0x%x: "
+					"want 0x%02x, got 0x%02x\n",
+					i + j, buf[i + j], rbuf[j]);
+				rv = -1;
+				break;
+			}
 		}
 	}
 
 	free(rbuf);
-	return 0;
+	return rv;
 }
 
 /**
@@ -100,9 +106,10 @@ static int get_flash_info_v0(struct ec_response_flash_info *info_response)
 }
 
 /**
+ * @param erased_value  set to the value of erased flash bytes on success
  * @return Write size on success, negative on failure
  */
-static int get_flash_write_size(void)
+static int get_flash_write_size(uint8_t *erased_value)
 {
 	int rv = 0;
 	int write_size;
@@ -118,9 +125,12 @@ static int get_flash_write_size(void)
 	if (flash_info_version < 0)
 		return -1;
 
+	*erased_value = 0xff;
 	if (flash_info_version == 2) {
 		rv = get_flash_info_v2(&info_response_v2);
 		write_size = info_response_v2.write_ideal_size;
+		if (info_response_v2.flags & EC_FLASH_INFO_ERASE_TO_0)
+			*erased_value = 0;
 	} else {
 		rv = get_flash_info_v0(&info_response_v0);
 		write_size = info_response_v0.write_block_size;
@@ -132,12 +142,26 @@ static int get_flash_write_size(void)
 	return write_size;
 }
 
+/**
+ * @return Non-zero if all <size> bytes of <buf> are <value>
+ */
+static int is_filled(const uint8_t *buf, int size, uint8_t value)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		if (buf[i] != value)
+			return 0;
+	return 1;
+}
+
 int ec_flash_write(const uint8_t *buf, int offset, int size)
 {
 	struct ec_params_flash_write *p =
 		(struct ec_params_flash_write *)ec_outbuf;
 	int write_size;
 	int pdata_max_size = (int)(ec_max_outsize - sizeof(*p));
+	uint8_t erased_value;
 	int step;
 	int rv;
 	int i;
@@ -149,7 +173,7 @@ int ec_flash_write(const uint8_t *buf, int offset, int size)
 	if (!ec_cmd_version_supported(EC_CMD_FLASH_WRITE, EC_VER_FLASH_WRITE))
 		pdata_max_size = EC_FLASH_WRITE_VER0_SIZE;
 
-	write_size = get_flash_write_size();
+	write_size = get_flash_write_size(&erased_value);
 	if (write_size < 0)
 		return write_size;
 
@@ -174,6 +198,12 @@ int ec_flash_write(const uint8_t *buf, int offset, int size)
 	for (i = 0; i < size; i += step) {
 		p->offset = offset + i;
 		p->size = MIN(size - i, step);
+		/*
+		 * Writing erased bytes can't change flash, so skip chunks
+		 * holding nothing else, like the padding of RW images.
+		 */
+		if (is_filled(buf + i, p->size, erased_value))
+			continue;
 		memcpy(p + 1, buf + i, p->size);
 		rv = ec_command(EC_CMD_FLASH_WRITE, 0, p, sizeof(*p) + p->size,
 				NULL, 0);
@@ -186,6 +216,167 @@ int ec_flash_write(const uint8_t *buf, int offset, int size)
 	return 0;
 }
 
+/* Most flash banks ec_flash_update() handles */
+#define FLASH_UPDATE_MAX_BANKS 16
+
+/**
+ * Get the flash bank layout, describing the flash as a single bank if the EC
+ * doesn't support version 2 of EC_CMD_FLASH_INFO.
+ *
+ * @param info  pointer to response with room for FLASH_UPDATE_MAX_BANKS banks
+ * @return Zero or positive on success, negative on failure
+ */
+static int get_flash_banks(struct ec_response_flash_info_2 *info)
+{
+	struct ec_params_flash_info_2 info_params = {
+		.num_banks_desc = FLASH_UPDATE_MAX_BANKS
+	};
+	struct ec_response_flash_info info_v0;
+	int rv;
+
+	if (ec_cmd_version_supported(EC_CMD_FLASH_INFO, 2))
+		return ec_command(EC_CMD_FLASH_INFO, 2, &info_params,
+				  sizeof(info_params), info,
+				  sizeof(*info) + FLASH_UPDATE_MAX_BANKS *
+				  sizeof(struct ec_flash_bank));
+
+	rv = get_flash_info_v0(&info_v0);
+	if (rv < 0)
+		return rv;
+	if (!info_v0.erase_block_size ||
+	    info_v0.erase_block_size & (info_v0.erase_block_size - 1))
+		return -1;
+
+	memset(info, 0, sizeof(*info) + sizeof(struct ec_flash_bank));
+	info->flash_size = info_v0.flash_size;
+	info->num_banks_total = 1;
+	info->num_banks_desc = 1;
+	info->banks[0].count = info_v0.flash_size / info_v0.erase_block_size;
+	info->banks[0].size_exp = __builtin_ctz(info_v0.erase_block_size);
+	info->banks[0].erase_size_exp = info->banks[0].size_exp;
+	return rv;
+}
+
+/**
+ * @return Size of the erase block holding <offset>, negative on failure
+ */
+static int get_erase_block_size(const struct ec_response_flash_info_2 *info,
+				int offset)
+{
+	int bank_size;
+	int i;
+
+	for (i = 0; i < info->num_banks_desc; i++) {
+		bank_size = info->banks[i].count << info->banks[i].size_exp;
+		if (offset < bank_size)
+			return 1 << info->banks[i].erase_size_exp;
+		offset -= bank_size;
+	}
+
+	return -1;
+}
+
+int ec_flash_update(const uint8_t *buf, int offset, int size)
+{
+	struct ec_response_flash_info_2 *info;
+	uint8_t erased_value;
+	uint8_t *rbuf = NULL;
+	int erase_pos = 0, erase_size = 0;
+	int write_pos = 0, write_size = 0;
+	int unchanged = 0;
+	int block = 0;
+	int pos;
+	int rv;
+
+	info = malloc(sizeof(*info) +
+		      FLASH_UPDATE_MAX_BANKS * sizeof(struct ec_flash_bank));
+	if (!info) {
+		fprintf(stderr, "Unable to allocate buffer.\n");
+		return -1;
+	}
+
+	rv = get_flash_banks(info);
+	if (rv < 0)
+		goto out;
+	erased_value = info->flags & EC_FLASH_INFO_ERASE_TO_0 ? 0 : 0xff;
+
+	for (pos = 0; pos <= size; pos += block) {
+		int dirty = 0, erase = 0;
+
+		if (pos < size) {
+			block = get_erase_block_size(info, offset + pos);
+			if (block <= 0 || (offset + pos) % block ||
+			    block > size - pos) {
+				fprintf(stderr, "Offset 0x%x is not at the start "
+					"of a whole erase block\n",
+					offset + pos);
+				rv = -1;
+				goto out;
+			}
+
+			free(rbuf);
+			rbuf = malloc(block);
+			if (!rbuf) {
+				fprintf(stderr, "Unable to allocate buffer.\n");
+				rv = -1;
+				goto out;
+			}
+
+			rv = ec_flash_read(rbuf, offset + pos, block);
+			if (rv < 0)
+				goto out;
+
+			dirty = memcmp(rbuf, buf + pos, block) != 0;
+			erase = dirty && !is_filled(rbuf, block, erased_value);
+			if (!dirty)
+				unchanged += block;
+		}
+
+		/*
+		 * Erase, then write, each run of consecutive blocks with one
+		 * command each once the run ends.  Blocks to erase are always
+		 * blocks to write, so the erase comes first.
+		 */
+		if (erase_size && !erase) {
+			rv = ec_flash_erase(offset + erase_pos, erase_size);
+			if (rv < 0) {
+				fprintf(stderr, "Erase error at offset %d\n",
+					erase_pos);
+				goto out;
+			}
+			erase_size = 0;
+		}
+		if (write_size && !dirty) {
+			rv = ec_flash_write(buf + write_pos, offset + write_pos,
+					    write_size);
+			if (rv < 0)
+				goto out;
+			write_size = 0;
+		}
+
+		if (erase) {
+			if (!erase_size)
+				erase_pos = pos;
+			erase_size += block;
+		}
+		if (dirty) {
+			if (!write_size)
+				write_pos = pos;
+			write_size += block;
+		}
+
+		if (pos == size)
+			break;
+	}
+
+	printf("%d of %d bytes unchanged\n", unchanged, size);
+	rv = 0;
+out:
+	free(rbuf);
+	free(info);
+	return rv;
+}
+
 int ec_flash_erase(int offset, int size)
 {
 	struct ec_params_flash_erase p;
@@ -39,6 +39,21 @@ int ec_flash_verify(const uint8_t *buf, int offset, int size);
  */
 int ec_flash_write(const uint8_t *buf, int offset, int size);
 
+/**
+ * Update EC flash memory to match a buffer
+ *
+ * Reads back each erase block of the region, and only erases and writes the
+ * blocks that differ from the buffer.  Blocks that are already erased are
+ * written without erasing them first.
+ *
+ * @param buf		Source buffer
+ * @param offset	Offset in EC flash to update, at an erase block start
+ * @param size		Number of bytes to update, ending at an erase block end
+ *
+ * @return 0 if success, negative if error.
+ */
+int ec_flash_update(const uint8_t *buf, int offset, int size);
+
 /**
  * Erase EC flash memory
  *
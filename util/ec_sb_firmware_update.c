@@ -23,6 +23,7 @@ enum {
 	OP_UNKNOWN = 0,
 	OP_CHECK   = 1,
 	OP_UPDATE  = 2,
+	OP_FAST_UPDATE = 3,
 };
 
 struct delay_value {
@@ -40,6 +41,17 @@ struct delay_value {
 #define DELAY_US_BUSY  1000000
 #define DELAY_US_WRITE_END  50000
 
+/*
+ * Status polling used in place of the fixed block write delays: the first
+ * poll after a block waits half of what the previous block needed, and each
+ * busy poll doubles the wait, up to POLL_US_MAX.  A block is given up to
+ * POLL_TIMEOUT_MULT times its fixed delay before the status read is taken
+ * as is.
+ */
+#define POLL_US_MIN  1000
+#define POLL_US_MAX  500000
+#define POLL_TIMEOUT_MULT  4
+
 static struct delay_value sb_delays[] = {
 	{1,             100000},
 	{2,            9000000},
@@ -73,7 +85,8 @@ enum {
 	F_NEED_UPDATE   = 0x8,  /* need firmware update */
 	F_POWERD_DISABLED = 0x10,  /* powerd is disabled */
 	F_LFCC_ZERO =       0x20,  /* last full charge is zero */
-	F_BATT_DISCHARGE =  0x40   /* battery discharging */
+	F_BATT_DISCHARGE =  0x40,  /* battery discharging */
+	F_POLL_STATUS =     0x80   /* poll status instead of fixed delays */
 };
 
 struct fw_update_ctrl {
@@ -88,6 +101,8 @@ struct fw_update_ctrl {
 	int fec_err_retry_cnt;
 	int busy_retry_cnt;
 	int step_size;
+	uint32_t poll_us; /* first status poll delay after a block write */
+	uint8_t sum; /* checksum of the firmware bytes written so far */
 	int rv;
 	char image_name[MAX_FW_IMAGE_NAME_SIZE];
 	char msg[256];
@@ -298,6 +313,37 @@ static int get_status(struct sb_fw_update_status *status)
 	return EC_RES_SUCCESS;
 }
 
+/*
+ * Poll the status until the battery is no longer busy, backing off between
+ * reads, or until |timeout_us| has passed.
+ *
+ * @return 0 if the last status read succeeded, negative if it failed.
+ */
+static int poll_status(struct fw_update_ctrl *fw_update, uint32_t timeout_us)
+{
+	uint32_t delay_us = fw_update->poll_us;
+	uint32_t waited_us = 0;
+	int rv;
+
+	while (1) {
+		usleep(delay_us);
+		waited_us += delay_us;
+		rv = get_status(&fw_update->status);
+		if (!rv && !fw_update->status.busy)
+			break;
+		if (waited_us >= timeout_us)
+			return rv;
+		delay_us *= 2;
+		if (delay_us > POLL_US_MAX)
+			delay_us = POLL_US_MAX;
+	}
+
+	fw_update->poll_us = delay_us / 2;
+	if (fw_update->poll_us < POLL_US_MIN)
+		fw_update->poll_us = POLL_US_MIN;
+	return rv;
+}
+
 static int get_info(struct sb_fw_update_info *info)
 {
 	int rv = EC_RES_SUCCESS;
@@ -550,6 +596,8 @@ static enum fw_update_state s5_read_status(struct fw_update_ctrl *fw_update)
 	fw_update->ptr += fw_update->fw_img_hdr->fw_binary_offset;
 	fw_update->size -= fw_update->fw_img_hdr->fw_binary_offset;
 	fw_update->offset = 0;
+	fw_update->sum = 0;
+	fw_update->poll_us = POLL_US_MIN;
 
 	return S6_WRITE_BLOCK;
 }
@@ -560,8 +608,14 @@ static enum fw_update_state s6_write_block(struct fw_update_ctrl *fw_update)
 	int bsize;
 	int offset = fw_update->offset;
 
-	if (offset >= fw_update->size)
+	if (offset >= fw_update->size) {
+		if ((fw_update->flags & F_POLL_STATUS) &&
+		    (uint8_t)(fw_update->sum + fw_update->fw_img_hdr->checksum)) {
+			fw_update->rv = -1;
+			log_msg(fw_update, S6_WRITE_BLOCK, "Checksum Error");
+		}
 		return S8_WRITE_END;
+	}
 
 	bsize = fw_update->step_size;
 
@@ -582,6 +636,9 @@ static enum fw_update_state s6_write_block(struct fw_update_ctrl *fw_update)
 		return S10_TERMINAL;
 	}
 
+	if (fw_update->flags & F_POLL_STATUS)
+		return S7_READ_STATUS;
+
 	/*
 	 * Add more delays after the last few (3) block writes.
 	 * 3 is chosen based on current test results.
@@ -600,20 +657,27 @@ static enum fw_update_state s7_read_status(struct fw_update_ctrl *fw_update)
 	int offset = fw_update->offset;
 	int bsize;
 	int cnt = 0;
+	int i;
 
 	bsize = fw_update->step_size;
-	do {
-		usleep(SB_FW_UPDATE_DEFAULT_DELAY);
-		rv = get_status(&fw_update->status);
-		if (rv) {
-			dump_data(fw_update->ptr+offset, offset, bsize);
-			print_status(&fw_update->status);
-			fw_update->rv = -1;
-			log_msg(fw_update, S7_READ_STATUS, "Interface Error");
-			return S10_TERMINAL;
-		}
-	} while (fw_update->status.busy &&
-			(cnt++ < SB_FW_UPDATE_DEFAULT_RETRY_CNT));
+	if (fw_update->flags & F_POLL_STATUS) {
+		rv = poll_status(fw_update, POLL_TIMEOUT_MULT *
+				 get_delay_value(offset, bsize) +
+				 DELAY_US_WRITE_END);
+	} else {
+		do {
+			usleep(SB_FW_UPDATE_DEFAULT_DELAY);
+			rv = get_status(&fw_update->status);
+		} while (!rv && fw_update->status.busy &&
+				(cnt++ < SB_FW_UPDATE_DEFAULT_RETRY_CNT));
+	}
+	if (rv) {
+		dump_data(fw_update->ptr+offset, offset, bsize);
+		print_status(&fw_update->status);
+		fw_update->rv = -1;
+		log_msg(fw_update, S7_READ_STATUS, "Interface Error");
+		return S10_TERMINAL;
+	}
 
 	if (fw_update->status.fec_error) {
 		dump_data(fw_update->ptr+offset, offset, bsize);
@@ -643,6 +707,11 @@ static enum fw_update_state s7_read_status(struct fw_update_ctrl *fw_update)
 		return S1_READ_INFO;
 	}
 
+	/* Sum the bytes the battery has accepted, up to the binary size */
+	for (i = offset; i < offset + bsize &&
+			 i < fw_update->fw_img_hdr->fw_binary_size; i++)
+		fw_update->sum += (uint8_t)fw_update->ptr[i];
+
 	fw_update->fec_err_retry_cnt = SB_FW_UPDATE_FEC_ERROR_RETRY_CNT;
 	fw_update->offset += fw_update->step_size;
 	return S6_WRITE_BLOCK;
@@ -740,9 +809,11 @@ static int ec_sb_firmware_update(struct fw_update_ctrl *fw_update)
 #define GEC_LOCK_TIMEOUT_SECS   30  /* 30 secs */
 void usage(char *argv[])
 {
-	printf("Usage: %s [check|update]\n"
+	printf("Usage: %s [check|update|fastupdate]\n"
 		"	check: check if AC Adaptor is connected.\n"
-		"	update: trigger battery firmware update.\n",
+		"	update: trigger battery firmware update.\n"
+		"	fastupdate: update, polling the battery status\n"
+		"		instead of fixed delays between blocks.\n",
 		argv[0]);
 }
 
@@ -761,6 +832,8 @@ int main(int argc, char *argv[])
 		op = OP_CHECK;
 	else if (!strcmp(argv[1], "update"))
 		op = OP_UPDATE;
+	else if (!strcmp(argv[1], "fastupdate"))
+		op = OP_FAST_UPDATE;
 	else {
 		op = OP_UNKNOWN;
 		usage(argv);
@@ -818,8 +891,10 @@ int main(int argc, char *argv[])
 	if (val == 0)
 		fw_update.flags |= F_LFCC_ZERO;
 
-	if (op == OP_UPDATE)
+	if (op == OP_UPDATE || op == OP_FAST_UPDATE)
 		fw_update.flags |= F_UPDATE;
+	if (op == OP_FAST_UPDATE)
+		fw_update.flags |= F_POLL_STATUS;
 
 	fw_update.flags |= F_VERSION_CHECK;
 
@@ -14,6 +14,7 @@
 #include <time.h>
 #include <unistd.h>
 #include <signal.h>
+#include <stdarg.h>
 #include <stdbool.h>
 
 #include "battery.h"
@@ -47,6 +48,7 @@ enum {
 	OPT_NAME,
 	OPT_ASCII,
 	OPT_I2C_BUS,
+	OPT_DAEMON,
 };
 
 static struct option long_opts[] = {
@@ -55,6 +57,7 @@ static struct option long_opts[] = {
 	{"name", 1, 0, OPT_NAME},
 	{"ascii", 0, 0, OPT_ASCII},
 	{"i2c_bus", 1, 0, OPT_I2C_BUS},
+	{"daemon", 1, 0, OPT_DAEMON},
 	{NULL, 0, 0, 0}
 };
 
@@ -72,6 +75,8 @@ const char help_str[] =
 	"      Turn on automatic fan speed control.\n"
 	"  backlight <enabled>\n"
 	"      Enable/disable LCD backlight\n"
+	"  batch <cmd>[:<ver>][=<hex params>] [...]\n"
+	"      Sends several host commands in one request\n"
 	"  battery\n"
 	"      Prints battery info\n"
 	"  batterycutoff [at-shutdown]\n"
@@ -80,6 +85,8 @@ const char help_str[] =
 	"      Read or write board-specific battery parameter\n"
 	"  boardversion\n"
 	"      Prints the board version\n"
+	"  boottrace\n"
+	"      Prints the boot time trace of the running EC image\n"
 	"  button [vup|vdown|rec] <Delay-ms>\n"
 	"      Simulates button press.\n"
 	"  cbi\n"
@@ -96,16 +103,24 @@ const char help_str[] =
 	"      Prints chip info\n"
 	"  cmdversions <cmd>\n"
 	"      Prints supported version mask for a command number\n"
-	"  console\n"
-	"      Prints the last output to the EC debug console\n"
+	"  console [follow] [lz4]\n"
+	"      Prints the last output to the EC debug console, and with follow\n"
+	"      keeps printing new output\n"
 	"  cec\n"
 	"      Read or write CEC messages and settings\n"
+	"  crashdump [clear] [raw <file>]\n"
+	"      Prints or saves the crash dump of the last panic\n"
+	"  deferredstats\n"
+	"      Prints the latency histogram of each deferred function\n"
 	"  echash [CMDS]\n"
 	"      Various EC hash commands\n"
 	"  eventclear <mask>\n"
 	"      Clears EC host events flags where mask has bits set\n"
 	"  eventclearb <mask>\n"
 	"      Clears EC host events flags copy B where mask has bits set\n"
+	"  eventlog [seq] [follow]\n"
+	"      Prints the event log, from entry seq if given; with follow,\n"
+	"      keeps printing new entries as the EC reports them\n"
 	"  eventget\n"
 	"      Prints raw EC host event flags\n"
 	"  eventgetb\n"
@@ -126,6 +141,8 @@ const char help_str[] =
 	"      Set the maximum external power limit\n"
 	"  fanduty <percent>\n"
 	"      Forces the fan PWM to a constant duty cycle\n"
+	"  fantuning <idx> [<rise> <fall> <deadband> <lead>]\n"
+	"      Get or set how thermal fan speed requests are applied\n"
 	"  flasherase <offset> <size>\n"
 	"      Erases EC flash\n"
 	"  flasheraseasync <offset> <size>\n"
@@ -140,6 +157,8 @@ const char help_str[] =
 	"      Prints or sets EC flash protection state\n"
 	"  flashread <offset> <size> <outfile>\n"
 	"      Reads from EC flash to a file\n"
+	"  flashupdate <offset> <infile>\n"
+	"      Erases and writes only the flash blocks that differ from a file\n"
 	"  flashwrite <offset> <infile>\n"
 	"      Writes to EC flash from a file\n"
 	"  forcelidopen <enable>\n"
@@ -170,6 +189,9 @@ const char help_str[] =
 	"      Checks for basic communication with EC\n"
 	"  hibdelay [sec]\n"
 	"      Set the delay before going into hibernation\n"
+	"  hostcmdtrace [hist]\n"
+	"      Prints the timing of recent host commands, or per-command\n"
+	"      histograms of their latency\n"
 	"  hostsleepstate\n"
 	"      Report host sleep state to the EC\n"
 	"  hostevent\n"
@@ -180,8 +202,14 @@ const char help_str[] =
 	"      Read I2C bus\n"
 	"  i2cwrite\n"
 	"      Write I2C bus\n"
+	"  i2cstats [clear]\n"
+	"      Prints (and optionally clears) the I2C bus statistics\n"
+	"  i2cstream <port> <addr> write|read <file> [size]\n"
+	"      Stream a file to or from a device on EC's I2C bus\n"
 	"  i2cxfer <port> <slave_addr> <read_count> [write bytes...]\n"
 	"      Perform I2C transfer on EC's I2C bus\n"
+	"  idlestats [clear]\n"
+	"      Prints the low power idle residency and wake-up interrupts\n"
 	"  infopddev <port>\n"
 	"      Get info about USB type-C accessory attached to port\n"
 	"  inventory\n"
@@ -192,6 +220,8 @@ const char help_str[] =
 	"      Get keyboard ID of supported keyboards\n"
 	"  kbinfo\n"
 	"      Dump keyboard matrix dimensions\n"
+	"  kblatency [reset]\n"
+	"      Print keystroke latency percentiles, then optionally reset them\n"
 	"  kbpress\n"
 	"      Simulate key press\n"
 	"  keyscan <beat_us> <filename>\n"
@@ -200,6 +230,8 @@ const char help_str[] =
 	"      Set the color of an LED or query brightness range\n"
 	"  lightbar [CMDS]\n"
 	"      Various lightbar control commands\n"
+	"  memmapnotify <mask> [wait <timeout>]\n"
+	"      Subscribe to memmap change events, optionally waiting for one\n"
 	"  mkbpget <buttons|switches>\n"
 	"      Get MKBP buttons/switches supported mask and current state\n"
 	"  mkbpwakemask <get|set> <event|hostevent> [mask]\n"
@@ -216,6 +248,9 @@ const char help_str[] =
 	"      Get PD chip information\n"
 	"  pdlog\n"
 	"      Prints the PD event log entries\n"
+	"  pdtrace [pcapng <file>]\n"
+	"      Prints the PD message and state machine trace, or writes its\n"
+	"      messages to a pcapng file\n"
 	"  pdwritelog <type> <port>\n"
 	"      Writes a PD event log of the given <type>\n"
 	"  pdgetmode <port>\n"
@@ -224,10 +259,13 @@ const char help_str[] =
 	"      Set USB-PD alternate SVID and mode on <port>\n"
 	"  port80flood\n"
 	"      Rapidly write bytes to port 80\n"
-	"  port80read\n"
-	"      Print history of port 80 write\n"
+	"  port80read [timed]\n"
+	"      Print history of port 80 write; with timed, one code per line\n"
+	"      with the time since the previous one and since the first\n"
 	"  powerinfo\n"
 	"      Prints power-related information\n"
+	"  powertranslog\n"
+	"      Prints the time spent in each power state and power signal wait\n"
 	"  protoinfo\n"
 	"       Prints EC host protocol information\n"
 	"  pse\n"
@@ -285,6 +323,8 @@ const char help_str[] =
 	"      Run RW signature verification and get status.\n"
 	"  sertest\n"
 	"      Serial output test for COM2\n"
+	"  shmemstats\n"
+	"      Prints shared memory allocator statistics\n"
 	"  smartdischarge\n"
 	"      Set/Get smart discharge parameters\n"
 	"  stress [reboot] [help]\n"
@@ -293,6 +333,12 @@ const char help_str[] =
 	"      Display system info.\n"
 	"  switches\n"
 	"      Prints current EC switch positions\n"
+	"  taskstack [-d]\n"
+	"      Prints per-task stack usage and suggested stack sizes\n"
+	"  taskstats\n"
+	"      Prints per-task scheduler statistics\n"
+	"  telemetry [--csv] [battery] [temps] [fans] [charge] [pd]\n"
+	"      Print a set of metrics as JSON or CSV, with few host commands\n"
 	"  temps <sensorid>\n"
 	"      Print temperature.\n"
 	"  tempsinfo <sensorid>\n"
@@ -309,6 +355,8 @@ const char help_str[] =
 	"      Get/set TMP006 calibration\n"
 	"  tmp006raw <tmp006_index>\n"
 	"      Get raw TMP006 data\n"
+	"  tracepoints [mask <mask>]\n"
+	"      Prints the tracepoint ring, or sets the categories recorded\n"
 	"  typeccontrol <port> <command>\n"
 	"      Control USB PD policy\n"
 	"  typecdiscovery <port> <type>\n"
@@ -381,10 +429,16 @@ void print_help(const char *prog, int print_cmds)
 	printf("Usage: %s [--dev=n] [--interface=dev|i2c|lpc] [--i2c_bus=n]",
 	       prog);
 	printf("[--name=cros_ec|cros_fp|cros_pd|cros_scp|cros_ish] [--ascii] ");
-	printf("<command> [params]\n\n");
+	printf("<command> [params]\n");
+	printf("       %s [options] --daemon=<socket path>\n\n", prog);
 	printf("  --i2c_bus=n  Specifies the number of an I2C bus to use. For\n"
 	       "               example, to use /dev/i2c-7, pass --i2c_bus=7.\n"
 	       "               Implies --interface=i2c.\n\n");
+	printf("  --daemon=<socket path>\n"
+	       "               Keep the EC interface open and run one command\n"
+	       "               per connection on a UNIX socket. A client sends\n"
+	       "               '<command> [params]' on a line and reads back\n"
+	       "               the output and a 'status: <n>' line.\n\n");
 	if (print_cmds)
 		puts(help_str);
 	else
@@ -507,6 +561,66 @@ out:
 	return rv;
 }
 
+int cmd_batch(int argc, char *argv[])
+{
+	struct ec_batch_cmd cmds[16];
+	uint8_t out[ARRAY_SIZE(cmds)][64];
+	uint8_t in[ARRAY_SIZE(cmds)][256];
+	int count = argc - 1;
+	int rv;
+	int i, j;
+
+	if (count < 1 || count > ARRAY_SIZE(cmds)) {
+		fprintf(stderr, "Usage: %s <cmd>[:<ver>][=<hex params>] "
+			"[...]\n", argv[0]);
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		char *e;
+
+		memset(cmds + i, 0, sizeof(cmds[i]));
+		cmds[i].command = strtol(argv[i + 1], &e, 0);
+		if (*e == ':')
+			cmds[i].version = strtol(e + 1, &e, 0);
+		if (*e == '=') {
+			for (e++; e[0] && e[1]; e += 2) {
+				if (cmds[i].outsize == sizeof(out[i]) ||
+				    sscanf(e, "%2hhx",
+					   &out[i][cmds[i].outsize]) != 1)
+					break;
+				cmds[i].outsize++;
+			}
+		}
+		if (*e) {
+			fprintf(stderr, "Bad command: %s\n", argv[i + 1]);
+			return -1;
+		}
+		cmds[i].outdata = out[i];
+		cmds[i].indata = in[i];
+		cmds[i].insize = sizeof(in[i]);
+	}
+
+	rv = ec_command_batch(cmds, count);
+	if (rv < 0) {
+		fprintf(stderr, "ERROR: EC_CMD_BATCH failed; %d\n", rv);
+		return rv;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (cmds[i].result < 0) {
+			printf("0x%04x: not run\n", cmds[i].command);
+			continue;
+		}
+		printf("0x%04x: result %d", cmds[i].command, cmds[i].result);
+		for (j = 0; j < cmds[i].inlen; j++)
+			printf("%s%02x", j % 16 ? " " : "\n  ", in[i][j]);
+		printf("\n");
+	}
+
+	return 0;
+}
+
 int cmd_hello(int argc, char *argv[])
 {
 	struct ec_params_hello p;
@@ -529,6 +643,112 @@ int cmd_hello(int argc, char *argv[])
 	return 0;
 }
 
+/* Latency buckets of hostcmdtrace hist, each 4x the previous one */
+#define HCTRACE_HIST_BUCKETS 6
+#define HCTRACE_HIST_BASE_US 64
+
+struct hctrace_hist {
+	uint16_t command;
+	int count;
+	uint32_t queue_max_us;
+	uint32_t handler_max_us;
+	int buckets[HCTRACE_HIST_BUCKETS];
+};
+
+int cmd_hostcmd_trace(int argc, char *argv[])
+{
+	struct ec_params_get_hostcmd_trace p;
+	struct ec_response_get_hostcmd_trace *r = ec_inbuf;
+	struct hctrace_hist hist[64];
+	int hist_count = 0;
+	uint32_t end_seq = 0;
+	int show_hist;
+	int rv;
+	int i, j;
+
+	show_hist = (argc == 2 && !strcmp(argv[1], "hist"));
+	if (argc > 2 || (argc == 2 && !show_hist)) {
+		fprintf(stderr, "Usage: %s [hist]\n", argv[0]);
+		return -1;
+	}
+
+	if (!show_hist)
+		printf("     seq    cmd ver res  size   arrival  queue_us "
+		       "handler_us\n");
+
+	p.seq = 0;
+	do {
+		rv = ec_command(EC_CMD_GET_HOSTCMD_TRACE, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0) {
+			fprintf(stderr, "ERROR: EC_CMD_GET_HOSTCMD_TRACE "
+				"failed; %d\n", rv);
+			return rv;
+		}
+
+		/* Don't chase the entries of our own requests. */
+		if (!p.seq)
+			end_seq = r->next_seq;
+
+		for (i = 0; i < r->count && r->seq + i < end_seq; i++) {
+			struct ec_hostcmd_trace_entry *e = r->entry + i;
+			uint32_t queue_us = e->start_us - e->arrival_us;
+			uint32_t handler_us = e->end_us - e->start_us;
+			uint32_t total_us = e->end_us - e->arrival_us;
+			struct hctrace_hist *h;
+
+			if (!show_hist) {
+				printf("%8u 0x%04x %3d %3d %5d %9u %9u %10u\n",
+				       r->seq + i, e->command, e->version,
+				       e->result, e->response_size,
+				       e->arrival_us, queue_us, handler_us);
+				continue;
+			}
+
+			for (j = 0; j < hist_count; j++)
+				if (hist[j].command == e->command)
+					break;
+			if (j == hist_count) {
+				if (hist_count == ARRAY_SIZE(hist))
+					continue;
+				memset(hist + j, 0, sizeof(hist[j]));
+				hist[j].command = e->command;
+				hist_count++;
+			}
+			h = hist + j;
+
+			h->count++;
+			h->queue_max_us = MAX(h->queue_max_us, queue_us);
+			h->handler_max_us = MAX(h->handler_max_us, handler_us);
+			for (j = 0; j < HCTRACE_HIST_BUCKETS - 1; j++)
+				if (total_us < (HCTRACE_HIST_BASE_US << (2 * j)))
+					break;
+			h->buckets[j]++;
+		}
+
+		p.seq = r->seq + r->count;
+	} while (r->count && p.seq < end_seq);
+
+	if (!show_hist)
+		return 0;
+
+	printf("Total latency buckets, from <%d us by 4x\n",
+	       HCTRACE_HIST_BASE_US);
+	printf("   cmd count queue_max handler_max");
+	for (i = 0; i < HCTRACE_HIST_BUCKETS; i++)
+		printf(" %5d", i);
+	printf("\n");
+	for (i = 0; i < hist_count; i++) {
+		printf("0x%04x %5d %9u %11u", hist[i].command, hist[i].count,
+		       hist[i].queue_max_us, hist[i].handler_max_us);
+		for (j = 0; j < HCTRACE_HIST_BUCKETS; j++)
+			printf(" %5d", hist[i].buckets[j]);
+		printf("\n");
+	}
+
+	return 0;
+}
+
 int cmd_hibdelay(int argc, char *argv[])
 {
 	struct ec_params_hibernation_delay p;
@@ -967,6 +1187,164 @@ static const char *reset_cause_to_str(uint16_t cause)
 	return "(shutdown unknown)";
 }
 
+int cmd_deferred_stats(int argc, char *argv[])
+{
+	struct ec_params_get_deferred_stats p;
+	struct ec_response_get_deferred_stats r;
+	int rv;
+	int i;
+
+	if (argc != 1) {
+		fprintf(stderr, "Usage: %s\n", argv[0]);
+		return -1;
+	}
+
+	p.index = 0;
+	do {
+		rv = ec_command(EC_CMD_GET_DEFERRED_STATS, 0, &p, sizeof(p),
+				&r, sizeof(r));
+		if (rv < 0) {
+			fprintf(stderr, "ERROR: EC_CMD_GET_DEFERRED_STATS "
+				"failed; %d\n", rv);
+			return rv;
+		}
+
+		if (p.index == 0) {
+			printf("Latency buckets, from <%d us by 4x\n",
+			       r.hist_base_us);
+			printf("Routine   ");
+			for (i = 0; i < EC_DEFERRED_HIST_BUCKETS; i++)
+				printf(" %6d", i);
+			printf("\n");
+		}
+
+		printf("0x%08x", r.routine);
+		for (i = 0; i < EC_DEFERRED_HIST_BUCKETS; i++)
+			printf(" %6d", r.hist[i]);
+		printf("\n");
+	} while (++p.index < r.deferred_count);
+
+	return 0;
+}
+
+int cmd_task_stats(int argc, char *argv[])
+{
+	struct ec_params_get_task_stats p;
+	struct ec_response_get_task_stats r;
+	int rv;
+
+	if (argc != 1) {
+		fprintf(stderr, "Usage: %s\n", argv[0]);
+		return -1;
+	}
+
+	printf("Task Name             Runtime(s) Switches MaxSlice(us) "
+	       "Wakeups AvgWake(us) MaxWake(us)\n");
+
+	p.task_id = 0;
+	do {
+		rv = ec_command(EC_CMD_GET_TASK_STATS, 0, &p, sizeof(p),
+				&r, sizeof(r));
+		if (rv < 0) {
+			fprintf(stderr, "ERROR: EC_CMD_GET_TASK_STATS failed; "
+				"%d\n", rv);
+			return rv;
+		}
+
+		r.name[sizeof(r.name) - 1] = '\0';
+		printf("%4d %-16s %6" PRIu64 ".%06" PRIu64 " %8u %12u %7u "
+		       "%11u %11u\n", p.task_id, r.name,
+		       r.runtime_us / 1000000, r.runtime_us % 1000000,
+		       r.switch_ins, r.max_slice_us, r.wake_count,
+		       r.wake_latency_avg_us, r.wake_latency_max_us);
+	} while (++p.task_id < r.task_count);
+
+	return 0;
+}
+
+/*
+ * Headroom left above the deepest stack usage seen by the EC when suggesting
+ * a stack size: an eighth of the peak, and at least one exception frame with
+ * the FPU state.
+ */
+#define TASK_STACK_MIN_MARGIN 112
+
+static int task_stack_suggest(int peak)
+{
+	int margin = MAX(peak / 8, TASK_STACK_MIN_MARGIN);
+
+	/* Stacks are allocated in multiples of 8 bytes */
+	return (peak + margin + 7) & ~7;
+}
+
+int cmd_task_stack(int argc, char *argv[])
+{
+	struct ec_params_task_stack_info p;
+	struct ec_response_task_stack_info *r = ec_inbuf;
+	int defines = 0;
+	int saved = 0;
+	int i, rv;
+
+	if (argc > 1 && !strcmp(argv[1], "-d")) {
+		defines = 1;
+		argc--;
+	}
+	if (argc != 1) {
+		fprintf(stderr, "Usage: %s [-d]\n", argv[0]);
+		return -1;
+	}
+
+	if (defines)
+		printf("/* Stack sizes suggested from the peak usage of each "
+		       "task */\n");
+	else
+		printf("Task Name              Size  Used  Peak Suggested\n");
+
+	memset(&p, 0, sizeof(p));
+	do {
+		rv = ec_command(EC_CMD_TASK_STACK_INFO, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0) {
+			fprintf(stderr, "ERROR: EC_CMD_TASK_STACK_INFO failed; "
+				"%d\n", rv);
+			return rv;
+		}
+
+		for (i = 0; i < r->num; i++) {
+			struct ec_task_stack_info *t = &r->task[i];
+			int suggested = task_stack_suggest(t->peak);
+			char *c;
+
+			t->name[sizeof(t->name) - 1] = '\0';
+			if (suggested < t->size)
+				saved += t->size - suggested;
+
+			if (!defines) {
+				printf("%4d %-16s %5u %5u %5u %9d\n",
+				       r->offset + i, t->name, t->size,
+				       t->used, t->peak, suggested);
+				continue;
+			}
+
+			/* Task 0 is the idle task, which ec.tasklist lacks */
+			if (r->offset + i == 0)
+				continue;
+			for (c = t->name; *c; c++)
+				*c = isalnum(*c) ? toupper(*c) : '_';
+			printf("#define TASK_STACK_SIZE_%s %d\n", t->name,
+			       suggested);
+		}
+		p.offset += r->num;
+	} while (r->num && p.offset < r->task_count);
+
+	if (defines)
+		printf("/* Reclaims %d bytes */\n", saved);
+	else
+		printf("Suggested sizes reclaim %d bytes of RAM\n", saved);
+
+	return 0;
+}
+
 int cmd_uptimeinfo(int argc, char *argv[])
 {
 	struct ec_response_uptime_info r;
@@ -1427,7 +1805,10 @@ int cmd_flash_write(int argc, char *argv[])
 	printf("Writing to offset %d...\n", offset);
 
 	/* Write data in chunks */
-	rv = ec_flash_write(buf, offset, size);
+	if (strcmp(argv[0], "flashupdate") == 0)
+		rv = ec_flash_update(buf, offset, size);
+	else
+		rv = ec_flash_write(buf, offset, size);
 
 	free(buf);
 
@@ -2676,6 +3057,41 @@ int cmd_port_80_flood(int argc, char *argv[])
 }
 #endif
 
+int cmd_shmem_stats(int argc, char *argv[])
+{
+	struct ec_response_shmem_stats r;
+	int rv;
+	int i;
+
+	if (argc != 1) {
+		fprintf(stderr, "Usage: %s\n", argv[0]);
+		return -1;
+	}
+
+	rv = ec_command(EC_CMD_SHMEM_STATS, 0, NULL, 0, &r, sizeof(r));
+	if (rv < 0) {
+		fprintf(stderr, "ERROR: EC_CMD_SHMEM_STATS failed; %d\n", rv);
+		return rv;
+	}
+
+	printf("Total:         %6d\n", r.total);
+	printf("Allocated:     %6d\n", r.allocated);
+	printf("Free:          %6d\n", r.free);
+	printf("Max free buf:  %6d\n", r.max_free);
+	printf("Free bufs:     %6d\n", r.free_chunks);
+	printf("Max allocated: %6d\n", r.max_allocated);
+
+	for (i = 0; i < EC_SHMEM_SLAB_CLASSES; i++) {
+		if (!r.slab[i].slots)
+			continue;
+		printf("Slab %4d: %2d/%2d used, high %2d, misses %d\n",
+		       r.slab[i].slot_size, r.slab[i].in_use, r.slab[i].slots,
+		       r.slab[i].high_water, r.slab[i].misses);
+	}
+
+	return 0;
+}
+
 static void cmd_smart_discharge_usage(const char *command)
 {
 	printf("Usage: %s [hours_to_zero [hibern] [cutoff]]\n", command);
@@ -3647,6 +4063,59 @@ int cmd_fanduty(int argc, char *argv[])
 	return 0;
 }
 
+int cmd_fan_tuning(int argc, char *argv[])
+{
+	struct ec_params_fan_tuning p;
+	struct ec_response_fan_tuning r;
+	uint16_t *fields[] = {
+		&p.tuning.rise_rpm, &p.tuning.fall_rpm,
+		&p.tuning.deadband_rpm, &p.tuning.lead_pct,
+	};
+	char *e;
+	int i, rv;
+
+	if (argc != 2 && argc != 2 + ARRAY_SIZE(fields)) {
+		fprintf(stderr,
+			"Usage: %s <idx> [<rise> <fall> <deadband> <lead>]\n"
+			"  rise, fall: fastest speed change, in RPM/s "
+			"(0: unlimited)\n"
+			"  deadband: smallest target change applied, in RPM\n"
+			"  lead: percent of a rising request step added "
+			"ahead\n", argv[0]);
+		return -1;
+	}
+
+	memset(&p, 0, sizeof(p));
+	p.fan_idx = strtol(argv[1], &e, 0);
+	if ((e && *e) || p.fan_idx >= get_num_fans()) {
+		fprintf(stderr, "Bad fan index.\n");
+		return -1;
+	}
+
+	p.action = EC_FAN_TUNING_GET;
+	if (argc > 2) {
+		p.action = EC_FAN_TUNING_SET;
+		for (i = 0; i < ARRAY_SIZE(fields); i++) {
+			*fields[i] = strtol(argv[2 + i], &e, 0);
+			if (e && *e) {
+				fprintf(stderr, "Bad value '%s'.\n",
+					argv[2 + i]);
+				return -1;
+			}
+		}
+	}
+
+	rv = ec_command(EC_CMD_FAN_TUNING, 0, &p, sizeof(p), &r, sizeof(r));
+	if (rv < 0)
+		return rv;
+
+	printf("Fan %d rise %d RPM/s, fall %d RPM/s, deadband %d RPM, "
+	       "lead %d%%\n", p.fan_idx, r.tuning.rise_rpm,
+	       r.tuning.fall_rpm, r.tuning.deadband_rpm, r.tuning.lead_pct);
+
+	return 0;
+}
+
 #define LBMSG(state) #state
 #include "lightbar_msg_list.h"
 static const char * const lightbar_cmds[] = {
@@ -4970,6 +5439,8 @@ static int ms_help(const char *cmd)
 	printf("  %s fifo_int_enable [0/1]        - enable/disable/get fifo interrupt "
 		"status\n", cmd);
 	printf("  %s fifo_read MAX_DATA           - read fifo data\n", cmd);
+	printf("  %s fifo_read MAX_DATA compact   - read delta encoded fifo data\n",
+	       cmd);
 	printf("  %s fifo_flush NUM               - trigger fifo interrupt\n", cmd);
 	printf("  %s list_activities NUM          - list supported activities\n", cmd);
 	printf("  %s set_activity NUM ACT EN      - enable/disable activity\n", cmd);
@@ -4981,6 +5452,95 @@ static int ms_help(const char *cmd)
 	return 0;
 }
 
+static void motionsense_print_fifo_vector(
+	const struct ec_response_motion_sensor_data *vector)
+{
+	if (vector->flags & (MOTIONSENSE_SENSOR_FLAG_TIMESTAMP |
+			     MOTIONSENSE_SENSOR_FLAG_FLUSH)) {
+		uint32_t timestamp = 0;
+
+		memcpy(&timestamp, vector->data, sizeof(uint32_t));
+		printf("Timestamp:%" PRIx32 "%s\n", timestamp,
+		       (vector->flags & MOTIONSENSE_SENSOR_FLAG_FLUSH ?
+			" - Flush" : ""));
+	} else {
+		printf("Sensor %d: %d\t%d\t%d (as uint16: %u\t%u\t%u)\n",
+		       vector->sensor_num,
+		       vector->data[0], vector->data[1], vector->data[2],
+		       vector->data[0], vector->data[1], vector->data[2]);
+	}
+}
+
+/* Read a varint of a compact fifo read, return NULL past the end. */
+static const uint8_t *motionsense_get_varint(const uint8_t *p,
+					     const uint8_t *end,
+					     uint32_t *value)
+{
+	int shift = 0;
+
+	*value = 0;
+	while (p < end && shift < 32) {
+		*value |= (uint32_t)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80))
+			return p;
+		shift += 7;
+	}
+	return NULL;
+}
+
+static int32_t motionsense_unzigzag(uint32_t value)
+{
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/*
+ * Decode the entries of a MOTIONSENSE_CMD_FIFO_READ version 5 response.
+ * Return the number of bytes used, or -1 if the response is malformed.
+ */
+static int motionsense_decode_fifo_compact(const uint8_t *data, int size,
+					   int count)
+{
+	static int16_t prev_data[256][3];
+	const uint8_t *p = data, *end = data + size;
+	uint32_t timestamp = 0, value;
+	int i, j;
+
+	memset(prev_data, 0, sizeof(prev_data));
+	for (i = 0; i < count; i++) {
+		struct ec_response_motion_sensor_data vector = {};
+
+		if (p >= end)
+			return -1;
+		vector.flags = *p & MOTIONSENSE_FIFO_COMPACT_FLAGS_MASK;
+		vector.sensor_num = *p++ >> MOTIONSENSE_FIFO_COMPACT_SENSOR_SHIFT;
+		if (vector.sensor_num == MOTIONSENSE_FIFO_COMPACT_SENSOR_ESC) {
+			if (p >= end)
+				return -1;
+			vector.sensor_num = *p++;
+		}
+
+		if (vector.flags & MOTIONSENSE_SENSOR_FLAG_TIMESTAMP) {
+			p = motionsense_get_varint(p, end, &value);
+			if (!p)
+				return -1;
+			timestamp += motionsense_unzigzag(value);
+			vector.timestamp = timestamp;
+		} else {
+			int16_t *prev = prev_data[vector.sensor_num];
+
+			for (j = 0; j < 3; j++) {
+				p = motionsense_get_varint(p, end, &value);
+				if (!p)
+					return -1;
+				prev[j] += motionsense_unzigzag(value);
+				vector.data[j] = prev[j];
+			}
+		}
+		motionsense_print_fifo_vector(&vector);
+	}
+	return p - data;
+}
+
 static void motionsense_display_activities(uint32_t activities)
 {
 	if (activities & BIT(MOTIONSENSE_ACTIVITY_SIG_MOTION))
@@ -5438,6 +5998,44 @@ static int cmd_motionsense(int argc, char **argv)
 		return 0;
 	}
 
+	if (argc == 4 && !strcasecmp(argv[1], "fifo_read") &&
+	    !strcasecmp(argv[3], "compact")) {
+		uint8_t fifo_read_buffer[sizeof(uint32_t) + 512 *
+			sizeof(struct ec_response_motion_sensor_data)];
+		struct ec_response_motion_sense_fifo_compact *fifo_read =
+			(struct ec_response_motion_sense_fifo_compact *)
+			fifo_read_buffer;
+		int print_data = 0, max_data = strtol(argv[2], &e, 0);
+
+		if (e && *e) {
+			fprintf(stderr, "Bad %s arg.\n", argv[2]);
+			return -1;
+		}
+		do {
+			param.cmd = MOTIONSENSE_CMD_FIFO_READ;
+			param.fifo_read.max_data_vector = max_data - print_data;
+
+			rv = ec_command(EC_CMD_MOTION_SENSE_CMD, 5,
+					&param,
+					ms_command_sizes[param.cmd].outsize,
+					fifo_read,
+					MIN(sizeof(fifo_read_buffer),
+					    ec_max_insize));
+			if (rv < 0)
+				return rv;
+			if (rv < sizeof(*fifo_read) ||
+			    motionsense_decode_fifo_compact(
+					fifo_read->data,
+					rv - sizeof(*fifo_read),
+					fifo_read->number_data) < 0) {
+				fprintf(stderr, "Malformed fifo data.\n");
+				return -1;
+			}
+			print_data += fifo_read->number_data;
+		} while (fifo_read->number_data != 0 && print_data < max_data);
+		return 0;
+	}
+
 	if (argc == 3 && !strcasecmp(argv[1], "fifo_read")) {
 		/* large number to test fragmentation */
 		struct {
@@ -5454,7 +6052,6 @@ static int cmd_motionsense(int argc, char **argv)
 		}
 		while (fifo_read_buffer.number_data != 0 &&
 		       print_data < max_data) {
-			struct ec_response_motion_sensor_data *vector;
 			param.cmd = MOTIONSENSE_CMD_FIFO_READ;
 			param.fifo_read.max_data_vector =
 				MIN(ARRAY_SIZE(fifo_read_buffer.data),
@@ -5468,32 +6065,9 @@ static int cmd_motionsense(int argc, char **argv)
 				return rv;
 
 			print_data += fifo_read_buffer.number_data;
-			for (i = 0; i < fifo_read_buffer.number_data; i++) {
-				vector = &fifo_read_buffer.data[i];
-				if (vector->flags &
-					(MOTIONSENSE_SENSOR_FLAG_TIMESTAMP |
-					 MOTIONSENSE_SENSOR_FLAG_FLUSH)) {
-					uint32_t timestamp = 0;
-
-					memcpy(&timestamp, vector->data,
-							sizeof(uint32_t));
-					printf("Timestamp:%" PRIx32 "%s\n",
-						timestamp,
-						(vector->flags &
-						 MOTIONSENSE_SENSOR_FLAG_FLUSH ?
-						 " - Flush" : ""));
-				} else {
-					printf("Sensor %d: %d\t%d\t%d "
-					       "(as uint16: %u\t%u\t%u)\n",
-						vector->sensor_num,
-						vector->data[0],
-						vector->data[1],
-						vector->data[2],
-						vector->data[0],
-						vector->data[1],
-						vector->data[2]);
-				}
-			}
+			for (i = 0; i < fifo_read_buffer.number_data; i++)
+				motionsense_print_fifo_vector(
+					&fifo_read_buffer.data[i]);
 		}
 		return 0;
 	}
@@ -7215,20 +7789,201 @@ int cmd_i2c_xfer(int argc, char *argv[])
 	return 0;
 }
 
-static void cmd_locate_chip_help(const char *const cmd)
+int cmd_i2c_stats(int argc, char *argv[])
 {
-	fprintf(stderr,
-		"Usage: %s <type> <index>\n"
-		"  <type> is one of:\n"
-		"    0: CBI_EEPROM\n"
-		"    1: TCPCs\n"
-		"  <index> instance # of <type>\n",
-		cmd);
-}
+	struct ec_params_i2c_stats p;
+	struct ec_response_i2c_stats *r = ec_inbuf;
+	int clear = 0;
+	int i, rv;
 
-static const char *bus_type[] = {
-	"I2C",
-	"EMBEDDED"
+	if (argc > 2 || (argc == 2 && strcasecmp(argv[1], "clear"))) {
+		fprintf(stderr, "Usage: %s [clear]\n", argv[0]);
+		return -1;
+	}
+	if (argc == 2)
+		clear = 1;
+
+	memset(&p, 0, sizeof(p));
+	p.type = EC_I2C_STATS_PORTS;
+	printf("Port   locks  avg wait  max wait  avg hold  max hold\n");
+	do {
+		const struct ec_i2c_stats_port *e = (void *)r->entries;
+
+		rv = ec_command(EC_CMD_I2C_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		for (i = 0; i < r->count; i++, e++) {
+			if (!e->lock_count)
+				continue;
+			printf("%4d %7u %7u us %7u us %7u us %7u us\n",
+			       p.index + i, e->lock_count,
+			       e->wait_us / e->lock_count, e->max_wait_us,
+			       e->hold_us / e->lock_count, e->max_hold_us);
+		}
+		p.index += r->count;
+	} while (r->count && p.index < r->total);
+
+	p.type = EC_I2C_STATS_DEVICES;
+	p.index = 0;
+	printf("\nPort  Addr   xfers    bytes retries errors  avg xfer  "
+	       "max xfer\n");
+	do {
+		const struct ec_i2c_stats_dev *e = (void *)r->entries;
+
+		rv = ec_command(EC_CMD_I2C_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		for (i = 0; i < r->count; i++, e++)
+			printf("%4d 0x%02x %8u %8u %7u %6u %7u us %7u us\n",
+			       e->port, e->addr_flags & EC_I2C_ADDR_MASK,
+			       e->count, e->bytes, e->retries, e->errors,
+			       e->count ? e->xfer_us / e->count : 0,
+			       e->max_xfer_us);
+		p.index += r->count;
+	} while (r->count && p.index < r->total);
+
+	if (clear) {
+		/* Past the last entry: nothing more read, only cleared */
+		p.flags = EC_I2C_STATS_FLAG_CLEAR;
+		rv = ec_command(EC_CMD_I2C_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		printf("\nCleared.\n");
+	}
+
+	return 0;
+}
+
+static int i2c_session_cmd(uint8_t subcmd, int port, int addr)
+{
+	struct ec_params_i2c_session p;
+
+	memset(&p, 0, sizeof(p));
+	p.subcmd = subcmd;
+	p.port = port;
+	p.addr_flags = addr;
+	return ec_command(EC_CMD_I2C_PASSTHRU_SESSION, 0, &p, sizeof(p),
+			  NULL, 0);
+}
+
+int cmd_i2c_stream(int argc, char *argv[])
+{
+	struct ec_params_i2c_session *p = ec_outbuf;
+	int port, addr, chunk, size = 0, offset;
+	int writing;
+	char *buf, *e;
+	int rv;
+
+	if (argc < 5 || (strcasecmp(argv[3], "write") &&
+			 strcasecmp(argv[3], "read"))) {
+		fprintf(stderr,
+			"Usage: %s <port> <addr7> write <file> [chunk]\n"
+			"       %s <port> <addr7> read <file> <size> [chunk]\n"
+			"  Each chunk is one I2C transaction, by default as "
+			"large as a host command allows.\n",
+			argv[0], argv[0]);
+		return -1;
+	}
+	writing = !strcasecmp(argv[3], "write");
+
+	port = strtol(argv[1], &e, 0);
+	if (e && *e) {
+		fprintf(stderr, "Bad port.\n");
+		return -1;
+	}
+	addr = strtol(argv[2], &e, 0);
+	if ((e && *e) || addr & ~EC_I2C_ADDR_MASK) {
+		fprintf(stderr, "Bad address.\n");
+		return -1;
+	}
+
+	if (writing) {
+		chunk = ec_max_outsize - sizeof(*p);
+		if (argc > 5)
+			chunk = MIN(chunk, strtol(argv[5], NULL, 0));
+		buf = read_file(argv[4], &size);
+		if (!buf)
+			return -1;
+	} else {
+		if (argc < 6) {
+			fprintf(stderr, "Missing size.\n");
+			return -1;
+		}
+		size = strtol(argv[5], &e, 0);
+		if ((e && *e) || size <= 0) {
+			fprintf(stderr, "Bad size.\n");
+			return -1;
+		}
+		chunk = ec_max_insize;
+		if (argc > 6)
+			chunk = MIN(chunk, strtol(argv[6], NULL, 0));
+		buf = malloc(size);
+		if (!buf)
+			return -1;
+	}
+	if (chunk <= 0) {
+		fprintf(stderr, "Bad chunk size.\n");
+		free(buf);
+		return -1;
+	}
+
+	rv = i2c_session_cmd(EC_I2C_SESSION_OPEN, port, addr);
+	if (rv < 0) {
+		fprintf(stderr, "Can't open the I2C session.\n");
+		free(buf);
+		return rv;
+	}
+
+	for (offset = 0; offset < size; offset += chunk) {
+		int len = MIN(chunk, size - offset);
+
+		memset(p, 0, sizeof(*p));
+		p->subcmd = EC_I2C_SESSION_XFER;
+		if (writing) {
+			memcpy(p->data, buf + offset, len);
+			rv = ec_command(EC_CMD_I2C_PASSTHRU_SESSION, 0, p,
+					sizeof(*p) + len, NULL, 0);
+		} else {
+			p->read_len = len;
+			rv = ec_command(EC_CMD_I2C_PASSTHRU_SESSION, 0, p,
+					sizeof(*p), buf + offset, len);
+		}
+		if (rv < 0) {
+			fprintf(stderr, "Transfer failed at offset %d.\n",
+				offset);
+			break;
+		}
+	}
+
+	i2c_session_cmd(EC_I2C_SESSION_CLOSE, 0, 0);
+
+	if (rv >= 0 && !writing)
+		rv = write_file(argv[4], buf, size);
+	free(buf);
+	if (rv < 0)
+		return rv;
+
+	printf("%s %d bytes.\n", writing ? "Wrote" : "Read", size);
+	return 0;
+}
+
+static void cmd_locate_chip_help(const char *const cmd)
+{
+	fprintf(stderr,
+		"Usage: %s <type> <index>\n"
+		"  <type> is one of:\n"
+		"    0: CBI_EEPROM\n"
+		"    1: TCPCs\n"
+		"  <index> instance # of <type>\n",
+		cmd);
+}
+
+static const char *bus_type[] = {
+	"I2C",
+	"EMBEDDED"
 };
 
 int cmd_locate_chip(int argc, char *argv[])
@@ -8006,6 +8761,411 @@ int cmd_board_version(int argc, char *argv[])
 	return rv;
 }
 
+static const char * const boot_trace_event_names[] = {
+	[EC_BOOT_TRACE_TIMER_INIT] = "timer init",
+	[EC_BOOT_TRACE_UART_INIT] = "uart init",
+	[EC_BOOT_TRACE_VERIFY_START] = "verify start",
+	[EC_BOOT_TRACE_VERIFY_DONE] = "verify done",
+	[EC_BOOT_TRACE_TASK_START] = "task start",
+	[EC_BOOT_TRACE_HOOK_INIT] = "init hook",
+	[EC_BOOT_TRACE_HOOK_INIT_DONE] = "init hooks done",
+	[EC_BOOT_TRACE_POWER_STATE] = "power state",
+	[EC_BOOT_TRACE_AP_ON] = "AP on",
+};
+BUILD_ASSERT(ARRAY_SIZE(boot_trace_event_names) == EC_BOOT_TRACE_COUNT);
+
+int cmd_boot_trace(int argc, char *argv[])
+{
+	struct ec_params_boot_trace p;
+	struct ec_response_boot_trace *r = ec_inbuf;
+	uint32_t start = 0, last = 0;
+	int i, rv;
+
+	p.offset = 0;
+	printf("  time us   delta us  event\n");
+	do {
+		rv = ec_command(EC_CMD_BOOT_TRACE, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+
+		for (i = 0; i < r->num; i++) {
+			const struct ec_boot_trace_entry *e = r->entries + i;
+			const char *name = e->event < EC_BOOT_TRACE_COUNT ?
+				boot_trace_event_names[e->event] : "?";
+
+			if (!p.offset && !i)
+				start = last = e->time_us;
+			printf("%9u  %9u  %s", e->time_us - start,
+			       e->time_us - last, name);
+			if (e->event == EC_BOOT_TRACE_HOOK_INIT)
+				printf(" 0x%08x: %u us%s", e->data,
+				       e->duration_us,
+				       e->flags & EC_BOOT_TRACE_FLAG_OVER_BUDGET ?
+				       " OVER BUDGET" : "");
+			else if (e->event == EC_BOOT_TRACE_POWER_STATE ||
+				 e->event == EC_BOOT_TRACE_AP_ON)
+				printf(" %u", e->data);
+			printf("\n");
+			last = e->time_us + e->duration_us;
+		}
+		p.offset += r->num;
+	} while (r->num && p.offset < r->count);
+
+	printf("Init hook budget: %u us\n", r->hook_budget_us);
+	return 0;
+}
+
+static const char * const power_trans_state_names[] = {
+	[EC_POWER_TRANS_G3] = "G3",
+	[EC_POWER_TRANS_S5] = "S5",
+	[EC_POWER_TRANS_S3] = "S3",
+	[EC_POWER_TRANS_S0] = "S0",
+	[EC_POWER_TRANS_S0IX] = "S0ix",
+	[EC_POWER_TRANS_G3S5] = "G3->S5",
+	[EC_POWER_TRANS_S5S3] = "S5->S3",
+	[EC_POWER_TRANS_S3S0] = "S3->S0",
+	[EC_POWER_TRANS_S0S3] = "S0->S3",
+	[EC_POWER_TRANS_S3S5] = "S3->S5",
+	[EC_POWER_TRANS_S5G3] = "S5->G3",
+	[EC_POWER_TRANS_S0IXS0] = "S0ix->S0",
+	[EC_POWER_TRANS_S0S0IX] = "S0->S0ix",
+};
+BUILD_ASSERT(ARRAY_SIZE(power_trans_state_names) ==
+	     EC_POWER_TRANS_STATE_COUNT);
+
+int cmd_power_transition_log(int argc, char *argv[])
+{
+	struct ec_params_power_transition_log p;
+	struct ec_response_power_transition_log *r = ec_inbuf;
+	int i, rv;
+
+	p.seq = 0;
+	printf("  time us  duration us  event\n");
+	do {
+		rv = ec_command(EC_CMD_POWER_TRANSITION_LOG, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+
+		if (r->seq != p.seq)
+			printf("(%u entries lost)\n", r->seq - p.seq);
+
+		for (i = 0; i < r->num; i++) {
+			const struct ec_power_transition_entry *e =
+				r->entries + i;
+			const char *name =
+				e->state < EC_POWER_TRANS_STATE_COUNT ?
+				power_trans_state_names[e->state] : "?";
+
+			printf("%9u  %11u  ", e->time_us, e->duration_us);
+			if (e->type == EC_POWER_TRANS_TYPE_WAIT)
+				printf("  wait 0x%04x in %s%s\n", e->data, name,
+				       e->flags & EC_POWER_TRANS_FLAG_TIMEOUT ?
+				       " TIMEOUT" : "");
+			else
+				printf("%s\n", name);
+		}
+		p.seq = r->next_seq;
+	} while (r->num);
+
+	printf("Now: %u us\n", r->timestamp);
+	return 0;
+}
+
+int cmd_idle_stats(int argc, char *argv[])
+{
+	static const char * const state_names[] = {
+		[EC_IDLE_STATE_SLEEP] = "sleep",
+		[EC_IDLE_STATE_DEEP_SLEEP] = "deep sleep",
+	};
+	struct ec_params_idle_stats p;
+	struct ec_response_idle_stats *r = ec_inbuf;
+	int clear = 0;
+	int i, rv;
+
+	BUILD_ASSERT(ARRAY_SIZE(state_names) == EC_IDLE_STATE_COUNT);
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear")) {
+			fprintf(stderr, "Usage: %s [clear]\n", argv[0]);
+			return -1;
+		}
+		clear = 1;
+	}
+
+	memset(&p, 0, sizeof(p));
+	do {
+		rv = ec_command(EC_CMD_IDLE_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+
+		if (!p.irq_offset) {
+			printf("Time: %" PRIu64 " us\n", r->time_us);
+			for (i = 0; i < EC_IDLE_STATE_COUNT; i++)
+				printf("%-10s %8u entries %12" PRIu64
+				       " us (%u%%)\n", state_names[i],
+				       r->count[i], r->residency_us[i],
+				       r->time_us ? (unsigned int)
+				       (r->residency_us[i] * 100 /
+					r->time_us) : 0);
+			printf("Deep sleeps predicted too short: %u\n",
+			       r->predicted_short);
+			printf("Deep sleeps under %u us: %u\n",
+			       r->deep_min_us, r->deep_too_short);
+			printf("Wake-ups per IRQ:\n");
+		}
+
+		for (i = 0; i < r->num; i++)
+			if (r->wake_irq[i])
+				printf("  IRQ %3d: %u\n", r->irq_offset + i,
+				       r->wake_irq[i]);
+		p.irq_offset += r->num;
+	} while (r->num && p.irq_offset < r->irq_count);
+
+	if (clear) {
+		p.flags = EC_IDLE_STATS_CLEAR;
+		p.irq_offset = r->irq_count;
+		rv = ec_command(EC_CMD_IDLE_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+	}
+	return 0;
+}
+
+/* Metric groups of 'ectool telemetry' */
+enum telemetry_group {
+	TELEMETRY_BATTERY = BIT(0),
+	TELEMETRY_TEMPS = BIT(1),
+	TELEMETRY_FANS = BIT(2),
+	TELEMETRY_CHARGE = BIT(3),
+	TELEMETRY_PD = BIT(4),
+};
+
+static const char * const telemetry_group_names[] = {
+	"battery", "temps", "fans", "charge", "pd",
+};
+
+/* Most PD ports queried by 'ectool telemetry' */
+#define TELEMETRY_PD_PORTS 4
+
+static int telemetry_csv;
+static int telemetry_count;
+
+/* Print one metric, as a CSV line or a member of a flat JSON object */
+__attribute__((format(printf, 2, 3)))
+static void telemetry_put(long value, const char *fmt, ...)
+{
+	char name[32];
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(name, sizeof(name), fmt, args);
+	va_end(args);
+
+	if (telemetry_csv)
+		printf("%s,%ld\n", name, value);
+	else
+		printf("%s\"%s\":%ld", telemetry_count ? "," : "{", name, value);
+	telemetry_count++;
+}
+
+static void telemetry_memmap(const uint8_t *mm, int groups)
+{
+	const uint8_t *temps_b = mm + EC_MEMMAP_TEMP_SENSOR_B;
+	int i;
+
+	if ((groups & TELEMETRY_TEMPS) && mm[EC_MEMMAP_THERMAL_VERSION]) {
+		int count = EC_TEMP_SENSOR_ENTRIES;
+
+		if (mm[EC_MEMMAP_THERMAL_VERSION] >= 2)
+			count += EC_TEMP_SENSOR_B_ENTRIES;
+		for (i = 0; i < count; i++) {
+			uint8_t t = i < EC_TEMP_SENSOR_ENTRIES ?
+				mm[EC_MEMMAP_TEMP_SENSOR + i] :
+				temps_b[i - EC_TEMP_SENSOR_ENTRIES];
+
+			if (t < EC_TEMP_SENSOR_NOT_CALIBRATED)
+				telemetry_put(t + EC_TEMP_SENSOR_OFFSET,
+					      "temp.%d_k", i);
+		}
+	}
+
+	if ((groups & TELEMETRY_FANS) && mm[EC_MEMMAP_THERMAL_VERSION]) {
+		for (i = 0; i < EC_FAN_SPEED_ENTRIES; i++) {
+			uint16_t rpm;
+
+			memcpy(&rpm, mm + EC_MEMMAP_FAN + 2 * i, sizeof(rpm));
+			if (rpm == EC_FAN_SPEED_NOT_PRESENT)
+				continue;
+			telemetry_put(rpm == EC_FAN_SPEED_STALLED ? 0 : rpm,
+				      "fan.%d_rpm", i);
+		}
+	}
+
+	if ((groups & TELEMETRY_BATTERY) && mm[EC_MEMMAP_BATTERY_VERSION]) {
+		static const struct {
+			const char *name;
+			uint8_t offset;
+		} batt[] = {
+			{ "battery.voltage_mv", EC_MEMMAP_BATT_VOLT },
+			{ "battery.rate_ma", EC_MEMMAP_BATT_RATE },
+			{ "battery.remaining_mah", EC_MEMMAP_BATT_CAP },
+			{ "battery.full_mah", EC_MEMMAP_BATT_LFCC },
+			{ "battery.design_mah", EC_MEMMAP_BATT_DCAP },
+			{ "battery.cycle_count", EC_MEMMAP_BATT_CCNT },
+		};
+		uint8_t flags = mm[EC_MEMMAP_BATT_FLAG];
+
+		telemetry_put(!!(flags & EC_BATT_FLAG_AC_PRESENT),
+			      "battery.ac_present");
+		telemetry_put(!!(flags & EC_BATT_FLAG_BATT_PRESENT),
+			      "battery.present");
+		if (!(flags & EC_BATT_FLAG_BATT_PRESENT))
+			return;
+		telemetry_put(!!(flags & EC_BATT_FLAG_CHARGING),
+			      "battery.charging");
+		telemetry_put(!!(flags & EC_BATT_FLAG_DISCHARGING),
+			      "battery.discharging");
+		for (i = 0; i < ARRAY_SIZE(batt); i++) {
+			uint32_t val;
+
+			memcpy(&val, mm + batt[i].offset, sizeof(val));
+			telemetry_put(val, "%s", batt[i].name);
+		}
+	}
+}
+
+int cmd_telemetry(int argc, char *argv[])
+{
+	uint8_t mm[EC_MEMMAP_BATT_CCNT + sizeof(uint32_t)];
+	struct ec_params_charge_state cs_params = {
+		.cmd = CHARGE_STATE_CMD_GET_STATE,
+	};
+	struct ec_response_charge_state cs;
+	struct ec_response_usb_pd_ports pd_ports;
+	struct ec_params_usb_pd_power_info pi_params[TELEMETRY_PD_PORTS];
+	struct ec_response_usb_pd_power_info pi[TELEMETRY_PD_PORTS];
+	struct ec_batch_cmd cmds[2 + TELEMETRY_PD_PORTS];
+	int groups = 0;
+	int count = 0;
+	int i, j, rv;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcasecmp(argv[i], "--csv")) {
+			telemetry_csv = 1;
+			continue;
+		}
+		for (j = 0; j < ARRAY_SIZE(telemetry_group_names); j++)
+			if (!strcasecmp(argv[i], telemetry_group_names[j]))
+				break;
+		if (j == ARRAY_SIZE(telemetry_group_names)) {
+			fprintf(stderr, "Usage: %s [--csv] [battery] [temps] "
+				"[fans] [charge] [pd]\n", argv[0]);
+			return -1;
+		}
+		groups |= BIT(j);
+	}
+	if (!groups)
+		groups = BIT(ARRAY_SIZE(telemetry_group_names)) - 1;
+
+	/* Battery, temperatures and fans all come from one memmap read */
+	if (groups & (TELEMETRY_BATTERY | TELEMETRY_TEMPS | TELEMETRY_FANS)) {
+		rv = ec_readmem(0, sizeof(mm), mm);
+		if (rv < 0) {
+			fprintf(stderr, "Failed to read memmap: %d\n", rv);
+			return rv;
+		}
+	}
+
+	/* The rest is fetched with a single EC_CMD_BATCH */
+	memset(cmds, 0, sizeof(cmds));
+	if (groups & TELEMETRY_CHARGE) {
+		cmds[count].command = EC_CMD_CHARGE_STATE;
+		cmds[count].outdata = &cs_params;
+		cmds[count].outsize = sizeof(cs_params);
+		cmds[count].indata = &cs;
+		cmds[count].insize = sizeof(cs);
+		count++;
+	}
+	if (groups & TELEMETRY_PD) {
+		cmds[count].command = EC_CMD_USB_PD_PORTS;
+		cmds[count].indata = &pd_ports;
+		cmds[count].insize = sizeof(pd_ports);
+		count++;
+		for (i = 0; i < TELEMETRY_PD_PORTS; i++) {
+			pi_params[i].port = i;
+			cmds[count].command = EC_CMD_USB_PD_POWER_INFO;
+			cmds[count].outdata = &pi_params[i];
+			cmds[count].outsize = sizeof(pi_params[i]);
+			cmds[count].indata = &pi[i];
+			cmds[count].insize = sizeof(pi[i]);
+			count++;
+		}
+	}
+
+	if (count && ec_command_batch(cmds, count) < 0) {
+		/* EC_CMD_BATCH not supported: send the commands one by one */
+		for (i = 0; i < count; i++) {
+			rv = ec_command(cmds[i].command, cmds[i].version,
+					cmds[i].outdata, cmds[i].outsize,
+					cmds[i].indata, cmds[i].insize);
+			cmds[i].result = rv < 0 ? EC_RES_ERROR : EC_RES_SUCCESS;
+			cmds[i].inlen = MAX(rv, 0);
+		}
+	}
+
+	if (groups & (TELEMETRY_BATTERY | TELEMETRY_TEMPS | TELEMETRY_FANS))
+		telemetry_memmap(mm, groups);
+
+	count = 0;
+	if (groups & TELEMETRY_CHARGE) {
+		if (cmds[count].result == EC_RES_SUCCESS &&
+		    cmds[count].inlen >= sizeof(cs.get_state)) {
+			telemetry_put(cs.get_state.ac, "charge.ac");
+			telemetry_put(cs.get_state.chg_voltage,
+				      "charge.voltage_mv");
+			telemetry_put(cs.get_state.chg_current,
+				      "charge.current_ma");
+			telemetry_put(cs.get_state.chg_input_current,
+				      "charge.input_current_ma");
+			telemetry_put(cs.get_state.batt_state_of_charge,
+				      "charge.state_of_charge");
+		}
+		count++;
+	}
+	if (groups & TELEMETRY_PD) {
+		int ports = 0;
+
+		if (cmds[count].result == EC_RES_SUCCESS &&
+		    cmds[count].inlen >= sizeof(pd_ports)) {
+			ports = MIN(pd_ports.num_ports, TELEMETRY_PD_PORTS);
+			telemetry_put(pd_ports.num_ports, "pd.ports");
+		}
+		count++;
+		for (i = 0; i < ports; i++, count++) {
+			if (cmds[count].result != EC_RES_SUCCESS ||
+			    cmds[count].inlen < sizeof(pi[i]))
+				continue;
+			telemetry_put(pi[i].role, "pd.%d.role", i);
+			telemetry_put(pi[i].type, "pd.%d.type", i);
+			telemetry_put(pi[i].meas.voltage_now,
+				      "pd.%d.voltage_mv", i);
+			telemetry_put(pi[i].meas.current_max,
+				      "pd.%d.current_max_ma", i);
+			telemetry_put(pi[i].max_power / 1000,
+				      "pd.%d.max_power_mw", i);
+		}
+	}
+
+	if (!telemetry_csv)
+		printf("%s}\n", telemetry_count ? "" : "{");
+
+	return 0;
+}
+
 static void cmd_cbi_help(char *cmd)
 {
 	fprintf(stderr,
@@ -8468,10 +9628,132 @@ int cmd_rtc_get_alarm(int argc, char *argv[])
 	return 0;
 }
 
+/* Decode an LZ4 block, as sent by EC_CMD_CONSOLE_READ v2 */
+static int lz4_decode(const uint8_t *src, int src_size, uint8_t *dst,
+		      int dst_size)
+{
+	int ip = 0, op = 0;
+
+	while (ip < src_size) {
+		int token = src[ip++];
+		int len = token >> 4;
+		int offset, b;
+
+		if (len == 15) {
+			do {
+				if (ip >= src_size)
+					return -1;
+				b = src[ip++];
+				len += b;
+			} while (b == 255);
+		}
+		if (len > src_size - ip || len > dst_size - op)
+			return -1;
+		memcpy(dst + op, src + ip, len);
+		ip += len;
+		op += len;
+		if (ip == src_size)
+			break;
+
+		if (src_size - ip < 2)
+			return -1;
+		offset = src[ip] | src[ip + 1] << 8;
+		ip += 2;
+		len = token & 0xf;
+		if (len == 15) {
+			do {
+				if (ip >= src_size)
+					return -1;
+				b = src[ip++];
+				len += b;
+			} while (b == 255);
+		}
+		len += 4;
+		if (!offset || offset > op || len > dst_size - op)
+			return -1;
+		for (; len; len--, op++)
+			dst[op] = dst[op - offset];
+	}
+
+	return op;
+}
+
+static int cmd_console_v2(int follow, int lz4)
+{
+	struct ec_params_console_read_v2 p = {
+		.flags = lz4 ? EC_CONSOLE_READ_LZ4 : 0,
+	};
+	struct ec_response_console_read_v2 *r = ec_inbuf;
+	uint8_t *data = malloc(ec_max_insize);
+	int rv, size;
+
+	if (!data)
+		return -1;
+
+	while (1) {
+		rv = ec_command(EC_CMD_CONSOLE_READ, 2, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			break;
+		if (rv < sizeof(*r)) {
+			rv = -1;
+			break;
+		}
+
+		if (r->cursor != p.cursor && p.cursor)
+			fprintf(stderr, "\n[%u bytes lost]\n",
+				r->cursor - p.cursor);
+		p.cursor = r->next_cursor;
+
+		if (r->flags & EC_CONSOLE_READ_LZ4) {
+			size = lz4_decode(r->data, rv - sizeof(*r), data,
+					  ec_max_insize);
+			if (size != r->size) {
+				fprintf(stderr, "Bad compressed data\n");
+				rv = -1;
+				break;
+			}
+			fwrite(data, 1, size, stdout);
+		} else {
+			fwrite(r->data, 1, rv - sizeof(*r), stdout);
+		}
+
+		/* Empty response means we've caught up */
+		if (!r->size) {
+			if (!follow)
+				break;
+			fflush(stdout);
+			usleep(100000);
+		}
+	}
+	free(data);
+	printf("\n");
+	return rv < 0 ? rv : 0;
+}
+
 int cmd_console(int argc, char *argv[])
 {
 	char *out = (char *)ec_inbuf;
-	int rv;
+	int follow = 0, lz4 = 0;
+	int rv, i;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcasecmp(argv[i], "follow")) {
+			follow = 1;
+		} else if (!strcasecmp(argv[i], "lz4")) {
+			lz4 = 1;
+		} else {
+			fprintf(stderr, "Usage: %s [follow] [lz4]\n", argv[0]);
+			return -1;
+		}
+	}
+
+	if (ec_cmd_version_supported(EC_CMD_CONSOLE_READ, 2))
+		return cmd_console_v2(follow, lz4);
+	else if (follow || lz4) {
+		fprintf(stderr, "EC doesn't support streaming console reads\n");
+		return -1;
+	}
 
 	/* Snapshot the EC console */
 	rv = ec_command(EC_CMD_CONSOLE_SNAPSHOT, 0, NULL, 0, NULL, 0);
@@ -8489,12 +9771,143 @@ int cmd_console(int argc, char *argv[])
 		if (!rv || !*out)
 			break;
 
-		/* Make sure output is null-terminated, then dump it */
-		out[ec_max_insize - 1] = '\0';
-		fputs(out, stdout);
+		/* Make sure output is null-terminated, then dump it */
+		out[ec_max_insize - 1] = '\0';
+		fputs(out, stdout);
+	}
+	printf("\n");
+	return 0;
+}
+
+/* Print a crash dump read with EC_CMD_CRASHDUMP_READ */
+static int print_crashdump(const uint8_t *dump, uint32_t size)
+{
+	const struct ec_crashdump_header *h = (const void *)dump;
+	const struct ec_crashdump_host_cmd *c;
+	const uint8_t *p = dump + sizeof(*h);
+	const uint8_t *end = dump + size;
+	size_t task_size;
+	int i, j;
+
+	if (size < sizeof(*h) || h->magic != EC_CRASHDUMP_MAGIC ||
+	    h->version != EC_CRASHDUMP_VERSION) {
+		fprintf(stderr, "Unknown crash dump format\n");
+		return -1;
+	}
+	task_size = sizeof(struct ec_crashdump_task) +
+		    h->stack_words * sizeof(uint32_t);
+	if (p + h->task_count * task_size +
+	    h->host_cmd_count * sizeof(*c) + h->console_size > end) {
+		fprintf(stderr, "Truncated crash dump\n");
+		return -1;
+	}
+
+	printf("Panic at %u us in task %d\n", h->time_us, h->current_task);
+
+	printf("Tasks:\n");
+	for (i = 0; i < h->task_count; i++, p += task_size) {
+		const struct ec_crashdump_task *t = (const void *)p;
+
+		printf("%4d sp 0x%08x stack %u bytes%s\n", i, t->sp,
+		       t->stack_size, i == h->current_task ? " (current)" : "");
+		for (j = 0; j < t->num_words; j++)
+			printf("%s%08x%s", j % 8 ? " " : "    ", t->stack[j],
+			       j % 8 == 7 || j == t->num_words - 1 ? "\n" : "");
+	}
+
+	printf("Host commands:\n");
+	for (i = 0; i < h->host_cmd_count; i++, p += sizeof(*c)) {
+		c = (const void *)p;
+
+		if (c->result == EC_CRASHDUMP_HOST_CMD_RUNNING)
+			printf("  %10u us 0x%04x.%d running\n", c->time_us,
+			       c->command, c->version);
+		else
+			printf("  %10u us 0x%04x.%d result %d\n", c->time_us,
+			       c->command, c->version, c->result);
+	}
+
+	printf("Console:\n");
+	fwrite(p, 1, h->console_size, stdout);
+	printf("\n");
+
+	return 0;
+}
+
+int cmd_crashdump(int argc, char *argv[])
+{
+	struct ec_params_crashdump_read p;
+	struct ec_response_crashdump_read *r = ec_inbuf;
+	const char *file = NULL;
+	uint8_t *dump = NULL;
+	uint32_t size = 0;
+	int clear = 0;
+	int i, rv;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcasecmp(argv[i], "clear")) {
+			clear = 1;
+		} else if (!strcasecmp(argv[i], "raw") && i + 1 < argc) {
+			file = argv[++i];
+		} else {
+			fprintf(stderr, "Usage: %s [clear] [raw <file>]\n",
+				argv[0]);
+			return -1;
+		}
+	}
+
+	memset(&p, 0, sizeof(p));
+	do {
+		rv = ec_command(EC_CMD_CRASHDUMP_READ, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			goto out;
+		rv -= sizeof(*r);
+		if (!dump) {
+			size = r->size;
+			dump = malloc(size + 1);
+			if (!dump) {
+				rv = -1;
+				goto out;
+			}
+		}
+		/* The dump changed if a panic happened under us */
+		if (r->size != size || rv < 0 || p.offset + rv > size) {
+			fprintf(stderr, "Crash dump changed while reading\n");
+			rv = -1;
+			goto out;
+		}
+		memcpy(dump + p.offset, r->data, rv);
+		p.offset += rv;
+	} while (rv > 0 && p.offset < size);
+
+	if (!size) {
+		printf("No crash dump\n");
+		rv = 0;
+	} else if (file) {
+		FILE *f = fopen(file, "wb");
+
+		rv = -1;
+		if (!f || fwrite(dump, 1, size, f) != size)
+			perror(file);
+		else
+			rv = 0;
+		if (f)
+			fclose(f);
+	} else {
+		rv = print_crashdump(dump, size);
+	}
+
+	if (!rv && size && clear) {
+		p.offset = 0;
+		p.flags = EC_CRASHDUMP_READ_CLEAR;
+		rv = ec_command(EC_CMD_CRASHDUMP_READ, 0, &p, sizeof(p),
+				ec_inbuf, sizeof(*r));
 	}
-	printf("\n");
-	return 0;
+
+out:
+	free(dump);
+	return rv < 0 ? rv : 0;
 }
 struct param_info {
 	const char *name;	/* name of this parameter */
@@ -8623,6 +10036,70 @@ static int cmd_kbinfo(int argc, char *argv[])
 	return 0;
 }
 
+/*
+ * Upper bound of the bucket holding the sample of rank n, capped by the
+ * longest latency.
+ */
+static uint32_t kblatency_percentile(
+	const struct ec_response_keyboard_latency_stats *r, uint32_t n)
+{
+	uint32_t seen = 0;
+	int i;
+
+	for (i = 0; i < EC_KB_LATENCY_HIST_BUCKETS - 1; i++) {
+		seen += r->hist[i];
+		if (seen > n)
+			return MIN((uint32_t)r->hist_base_us << i, r->max_us);
+	}
+	return r->max_us;
+}
+
+static int cmd_kblatency(int argc, char *argv[])
+{
+	static const char * const stage_names[] = {
+		[EC_KB_LATENCY_SCAN] = "scan",
+		[EC_KB_LATENCY_QUEUE] = "queue",
+		[EC_KB_LATENCY_NOTIFY] = "notify",
+		[EC_KB_LATENCY_READ] = "read",
+		[EC_KB_LATENCY_TOTAL] = "total",
+		[EC_KB_LATENCY_BOUNCE] = "bounce",
+	};
+	struct ec_params_keyboard_latency_stats p = { 0 };
+	struct ec_response_keyboard_latency_stats r;
+	int rv;
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		fprintf(stderr, "Usage: %s [reset]\n", argv[0]);
+		return -1;
+	}
+
+	printf("Stage       count   p50 us   p90 us   p99 us   max us\n");
+	do {
+		rv = ec_command(EC_CMD_KEYBOARD_LATENCY_STATS, 0, &p,
+				sizeof(p), &r, sizeof(r));
+		if (rv < 0)
+			return rv;
+
+		printf("%-8s %8u %8u %8u %8u %8u\n",
+		       p.stage < ARRAY_SIZE(stage_names) ?
+		       stage_names[p.stage] : "?", r.count,
+		       kblatency_percentile(&r, r.count / 2),
+		       kblatency_percentile(&r, r.count * 9 / 10),
+		       kblatency_percentile(&r, r.count * 99 / 100), r.max_us);
+	} while (++p.stage < r.stage_count);
+
+	if (argc == 2) {
+		p.stage = 0;
+		p.flags = EC_KB_LATENCY_RESET;
+		rv = ec_command(EC_CMD_KEYBOARD_LATENCY_STATS, 0, &p,
+				sizeof(p), &r, sizeof(r));
+		if (rv < 0)
+			return rv;
+	}
+
+	return 0;
+}
+
 static int cmd_kbid(int argc, char *argv[])
 {
 	struct ec_response_keyboard_id response;
@@ -9100,6 +10577,60 @@ enum port_80_event {
 	PORT_80_EVENT_RESET = 0x1002,   /* RESET transition */
 };
 
+/* Print the port 80 codes with the time between them, one per line */
+static int cmd_port80_read_timed(void)
+{
+	struct ec_params_port80_read p = { .subcmd = EC_PORT80_READ_TIMED };
+	struct ec_response_port80_read_timed *r = ec_inbuf;
+	uint64_t total = 0;
+	int first = 1;
+	int rv, i;
+
+	p.read_timed.start = 0;
+	do {
+		rv = ec_command(EC_CMD_PORT80_READ, 1, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < sizeof(*r) ||
+		    rv < sizeof(*r) + r->count * sizeof(r->entries[0]))
+			return -1;
+
+		if (r->start != p.read_timed.start)
+			printf("--- %u writes lost ---\n",
+			       r->start - p.read_timed.start);
+
+		for (i = 0; i < r->count; i++) {
+			const struct ec_port80_timed_entry *e = &r->entries[i];
+			uint32_t delta = EC_PORT80_DELTA_US(e->delta);
+
+			/* The first delta is from the write before, or boot */
+			if (first)
+				first = 0;
+			else
+				total += delta;
+
+			printf("%10.3f ms  +%10.3f ms  ", total / 1000.0,
+			       delta / 1000.0);
+			switch (e->code) {
+			case PORT_80_EVENT_RESUME:
+				printf("(S3->S0)\n");
+				break;
+			case PORT_80_EVENT_RESET:
+				printf("(RESET)\n");
+				break;
+			default:
+				printf("%02x\n", e->code);
+			}
+		}
+
+		p.read_timed.start = r->next;
+	} while (r->count);
+
+	printf("last write %.3f ms ago\n", r->last_age_us / 1000.0);
+	return 0;
+}
+
 int cmd_port80_read(int argc, char *argv[])
 {
 	struct ec_params_port80_read p;
@@ -9110,6 +10641,14 @@ int cmd_port80_read(int argc, char *argv[])
 	struct ec_response_port80_read rsp;
 	int printed = 0;
 
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "timed")) {
+			fprintf(stderr, "Usage: %s [timed]\n", argv[0]);
+			return -1;
+		}
+		return cmd_port80_read_timed();
+	}
+
 	if (!ec_cmd_version_supported(EC_CMD_PORT80_READ, cmdver)) {
 		/* fall back to last boot */
 		struct ec_response_port80_last_boot r;
@@ -9467,6 +11006,319 @@ int cmd_pd_write_log(int argc, char *argv[])
 	return ec_command(EC_CMD_PD_WRITE_LOG_ENTRY, 0, &p, sizeof(p), NULL, 0);
 }
 
+/* Link type of the pcapng files written by pdtrace: LINKTYPE_USER0 */
+#define PDTRACE_PCAP_LINKTYPE 147
+#define PDTRACE_MAX_ENTRIES 1024
+
+static void pcapng_write_block(FILE *f, uint32_t type, const void *body,
+			       uint32_t size)
+{
+	const uint32_t pad = 0;
+	uint32_t total = 12 + ((size + 3) & ~3);
+
+	fwrite(&type, sizeof(type), 1, f);
+	fwrite(&total, sizeof(total), 1, f);
+	fwrite(body, size, 1, f);
+	fwrite(&pad, (4 - (size & 3)) & 3, 1, f);
+	fwrite(&total, sizeof(total), 1, f);
+}
+
+/*
+ * Write the messages as a pcapng file, one interface per port.  Packets are
+ * the message header and data objects as on the wire, SOP' and SOP'' messages
+ * have a comment saying so, and the direction is in the packet flags.
+ */
+static int pdtrace_write_pcapng(const char *name,
+				const struct ec_pd_trace_entry *entries,
+				const uint64_t *times, int count)
+{
+	static const char * const sop_names[] = { "SOP", "SOP'", "SOP''",
+						  "SOP'_Debug",
+						  "SOP''_Debug" };
+	struct {
+		uint32_t bom;
+		uint16_t major;
+		uint16_t minor;
+		int64_t section_size;
+	} __packed shb = { 0x1a2b3c4d, 1, 0, -1 };
+	struct {
+		uint16_t linktype;
+		uint16_t reserved;
+		uint32_t snaplen;
+	} idb = { PDTRACE_PCAP_LINKTYPE, 0, 0 };
+	struct {
+		uint32_t interface;
+		uint32_t ts_high;
+		uint32_t ts_low;
+		uint32_t captured;
+		uint32_t length;
+		uint8_t data[32 + 24];
+	} epb;
+	int ports = 0;
+	FILE *f;
+	int i;
+
+	f = fopen(name, "wb");
+	if (!f) {
+		perror(name);
+		return -1;
+	}
+
+	for (i = 0; i < count; i++)
+		ports = MAX(ports, entries[i].port + 1);
+
+	pcapng_write_block(f, 0x0a0d0d0a, &shb, sizeof(shb));
+	for (i = 0; i < ports; i++)
+		pcapng_write_block(f, 1, &idb, sizeof(idb));
+
+	for (i = 0; i < count; i++) {
+		const struct ec_pd_trace_entry *e = entries + i;
+		uint8_t *opt;
+		uint16_t len;
+		uint32_t flags;
+
+		if (e->type != EC_PD_TRACE_RX && e->type != EC_PD_TRACE_TX)
+			continue;
+
+		epb.interface = e->port;
+		epb.ts_high = times[i] >> 32;
+		epb.ts_low = times[i];
+		epb.captured = epb.length = 2 + 4 * e->value;
+		memcpy(epb.data, &e->header, 2);
+		memcpy(epb.data + 2, e->data, 4 * e->value);
+
+		/* Options start on the next 32-bit boundary */
+		opt = epb.data + ((epb.captured + 3) & ~3);
+		memset(epb.data + epb.captured, 0, opt - epb.data -
+		       epb.captured);
+
+		/* epb_flags: inbound or outbound */
+		flags = e->type == EC_PD_TRACE_RX ? 1 : 2;
+		memcpy(opt, (uint16_t[]){ 2, 4 }, 4);
+		memcpy(opt + 4, &flags, 4);
+		opt += 8;
+
+		/* opt_comment with the SOP* type, if not SOP */
+		if (e->info && e->info < ARRAY_SIZE(sop_names)) {
+			len = strlen(sop_names[e->info]);
+			memcpy(opt, (uint16_t[]){ 1, len }, 4);
+			memset(opt + 4, 0, (len + 3) & ~3);
+			memcpy(opt + 4, sop_names[e->info], len);
+			opt += 4 + ((len + 3) & ~3);
+		}
+
+		/* opt_endofopt */
+		memset(opt, 0, 4);
+		opt += 4;
+
+		pcapng_write_block(f, 6, &epb, opt - (uint8_t *)&epb);
+	}
+
+	fclose(f);
+	return 0;
+}
+
+int cmd_pd_trace(int argc, char *argv[])
+{
+	static const char * const type_names[] = {
+		[EC_PD_TRACE_RX] = "RX",
+		[EC_PD_TRACE_TX] = "TX",
+		[EC_PD_TRACE_STATE] = "STATE",
+	};
+	static const char * const sm_names[] = {
+		[EC_PD_TRACE_SM_TC] = "TC",
+		[EC_PD_TRACE_SM_PE] = "PE",
+		[EC_PD_TRACE_SM_PRL_TX] = "PRL_TX",
+		[EC_PD_TRACE_SM_PRL_HR] = "PRL_HR",
+		[EC_PD_TRACE_SM_RCH] = "RCH",
+		[EC_PD_TRACE_SM_TCH] = "TCH",
+	};
+	struct ec_params_pd_trace p;
+	struct ec_response_pd_trace *r = ec_inbuf;
+	struct ec_pd_trace_entry *entries;
+	uint64_t *times;
+	uint32_t first_seq = 0;
+	uint32_t end_seq = 0;
+	int count = 0;
+	int rv = 0;
+	int i, j;
+
+	if (argc > 3 || (argc > 1 && strcmp(argv[1], "pcapng")) ||
+	    argc == 2) {
+		fprintf(stderr, "Usage: %s [pcapng <file>]\n", argv[0]);
+		return -1;
+	}
+
+	entries = malloc(PDTRACE_MAX_ENTRIES * sizeof(*entries));
+	times = malloc(PDTRACE_MAX_ENTRIES * sizeof(*times));
+	if (!entries || !times) {
+		fprintf(stderr, "Out of memory\n");
+		rv = -1;
+		goto out;
+	}
+
+	p.seq = 0;
+	do {
+		rv = ec_command(EC_CMD_PD_TRACE, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0) {
+			fprintf(stderr, "ERROR: EC_CMD_PD_TRACE failed; %d\n",
+				rv);
+			goto out;
+		}
+
+		/* Only read what was recorded when we started */
+		if (!p.seq) {
+			end_seq = r->next_seq;
+			first_seq = r->seq;
+		}
+
+		for (i = 0; i < r->count && r->seq + i < end_seq &&
+			    count < PDTRACE_MAX_ENTRIES; i++)
+			entries[count++] = r->entry[i];
+
+		p.seq = r->seq + r->count;
+	} while (r->count && p.seq < end_seq && count < PDTRACE_MAX_ENTRIES);
+	rv = 0;
+
+	/* Widen the 32-bit timestamps, they are in order */
+	for (i = 0; i < count; i++)
+		times[i] = i ? times[i - 1] + (uint32_t)(entries[i].timestamp -
+						entries[i - 1].timestamp)
+			     : entries[i].timestamp;
+
+	if (argc == 3) {
+		rv = pdtrace_write_pcapng(argv[2], entries, times, count);
+		goto out;
+	}
+
+	printf("     seq        time port type\n");
+	for (i = 0; i < count; i++) {
+		const struct ec_pd_trace_entry *e = entries + i;
+
+		printf("%8u %5" PRIu64 ".%06" PRIu64 " C%-3d %-6s",
+		       first_seq + i, times[i] / 1000000, times[i] % 1000000,
+		       e->port, e->type < ARRAY_SIZE(type_names) ?
+		       type_names[e->type] : "?");
+
+		if (e->type == EC_PD_TRACE_STATE) {
+			printf(" %s %d\n", e->info < ARRAY_SIZE(sm_names) ?
+			       sm_names[e->info] : "?", e->value);
+			continue;
+		}
+
+		printf(" SOP%d hdr %04x", e->info, e->header);
+		for (j = 0; j < e->value && j < ARRAY_SIZE(e->data); j++)
+			printf(" %08x", e->data[j]);
+		printf("\n");
+	}
+
+out:
+	free(entries);
+	free(times);
+	return rv;
+}
+
+int cmd_tracepoints(int argc, char *argv[])
+{
+	static const char * const cat_names[] = {
+		[EC_TRACEPOINT_CAT_HOOK] = "hook",
+		[EC_TRACEPOINT_CAT_HOSTCMD] = "hostcmd",
+		[EC_TRACEPOINT_CAT_I2C] = "i2c",
+		[EC_TRACEPOINT_CAT_CHIPSET] = "chipset",
+		[EC_TRACEPOINT_CAT_KEYBOARD] = "keyboard",
+	};
+	static const struct {
+		uint16_t id;
+		const char *name;
+	} ids[] = {
+		{EC_TRACEPOINT_HOOK_DEFERRED, "deferred"},
+		{EC_TRACEPOINT_HOSTCMD_DONE, "done"},
+		{EC_TRACEPOINT_I2C_XFER, "xfer"},
+		{EC_TRACEPOINT_CHIPSET_STATE, "state"},
+		{EC_TRACEPOINT_8042_TO_HOST, "to_host"},
+	};
+	struct ec_params_tracepoints p = { 0 };
+	struct ec_response_tracepoints *r = ec_inbuf;
+	uint32_t end_seq = 0;
+	uint64_t time = 0;
+	uint32_t last = 0;
+	char *e;
+	int rv;
+	int i, j;
+
+	if (argc == 3 && !strcmp(argv[1], "mask")) {
+		p.flags = EC_TRACEPOINTS_SET_MASK;
+		p.mask = strtoul(argv[2], &e, 0);
+		if (*e) {
+			fprintf(stderr, "Bad mask\n");
+			return -1;
+		}
+	} else if (argc != 1) {
+		fprintf(stderr, "Usage: %s [mask <mask>]\n", argv[0]);
+		return -1;
+	}
+
+	rv = ec_command(EC_CMD_TRACEPOINTS, 0, &p, sizeof(p),
+			ec_inbuf, ec_max_insize);
+	if (rv < 0) {
+		fprintf(stderr, "ERROR: EC_CMD_TRACEPOINTS failed; %d\n", rv);
+		return rv;
+	}
+
+	printf("Categories recorded:");
+	for (i = 0; i < ARRAY_SIZE(cat_names); i++)
+		if (r->built_mask & BIT(i))
+			printf(" %s%s", cat_names[i],
+			       r->mask & BIT(i) ? "" : "(off)");
+	printf("\n");
+	if (p.flags)
+		return 0;
+
+	/* Only read what was recorded when we started */
+	end_seq = r->next_seq;
+	printf("     seq        time task event\n");
+	while (r->count) {
+		for (i = 0; i < r->count && r->seq + i < end_seq; i++) {
+			const struct ec_tracepoint_entry *t = r->entry + i;
+			const char *name = "?";
+
+			/* Widen the 32-bit timestamps, they are in order */
+			time += (uint32_t)(t->timestamp - last);
+			last = t->timestamp;
+
+			for (j = 0; j < ARRAY_SIZE(ids); j++)
+				if (ids[j].id == t->id)
+					name = ids[j].name;
+
+			printf("%8u %5" PRIu64 ".%06" PRIu64 " ",
+			       r->seq + i, time / 1000000, time % 1000000);
+			if (t->task == EC_TRACEPOINT_TASK_IRQ)
+				printf(" irq");
+			else
+				printf("%4d", t->task);
+			printf(" %s.%s %08x %08x\n",
+			       EC_TRACEPOINT_CAT(t->id) <
+					ARRAY_SIZE(cat_names) ?
+			       cat_names[EC_TRACEPOINT_CAT(t->id)] : "?",
+			       name, t->arg[0], t->arg[1]);
+		}
+
+		p.seq = r->seq + r->count;
+		if (p.seq >= end_seq)
+			break;
+		rv = ec_command(EC_CMD_TRACEPOINTS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0) {
+			fprintf(stderr,
+				"ERROR: EC_CMD_TRACEPOINTS failed; %d\n", rv);
+			return rv;
+		}
+	}
+
+	return 0;
+}
+
 int cmd_typec_control(int argc, char *argv[])
 {
 	struct ec_params_typec_control p;
@@ -9827,6 +11679,149 @@ int cmd_wait_event(int argc, char *argv[])
 	return 0;
 }
 
+/* Print the event log from p->seq on, and update it to the next entry */
+static int event_log_print(struct ec_params_event_log_read *p)
+{
+	struct ec_response_event_log_read *r = ec_inbuf;
+	int rv, i;
+
+	do {
+		const uint8_t *data, *end;
+
+		rv = ec_command(EC_CMD_EVENT_LOG_READ, 0, p, sizeof(*p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < sizeof(*r))
+			return -1;
+
+		/* A start of 0 means from the oldest entry */
+		if (p->seq && r->seq != p->seq)
+			printf("--- %u entries lost ---\n", r->seq - p->seq);
+
+		data = r->data;
+		end = (uint8_t *)ec_inbuf + rv;
+		for (i = 0; i < r->count; i++) {
+			const struct ec_response_pd_log *l = (const void *)data;
+			int size = PD_LOG_SIZE(l->size_port);
+			int j;
+
+			if (data + sizeof(*l) + size > end)
+				return -1;
+
+			printf("%8u ", r->seq + i);
+			if (r->seq + i < r->boot_seq)
+				printf("  (before boot) ");
+			else
+				printf("%10llu ms ago ", (unsigned long long)
+				       (((uint64_t)(r->timestamp - l->timestamp)
+					 << PD_LOG_TIMESTAMP_SHIFT) / 1000));
+			printf("type %02x data %04x [", l->type, l->data);
+			for (j = 0; j < size; j++)
+				printf("%02x", l->payload[j]);
+			printf("]\n");
+
+			data += sizeof(*l) + ((size + sizeof(*l) - 1) /
+					      sizeof(*l)) * sizeof(*l);
+		}
+
+		p->seq = r->next_seq;
+	} while (r->count);
+
+	return 0;
+}
+
+int cmd_event_log(int argc, char *argv[])
+{
+	struct ec_params_event_log_read p = { .seq = 0 };
+	struct ec_response_get_next_event_v1 buffer;
+	int follow = 0;
+	char *e;
+	int rv;
+
+	if (argc > 1 && !strcasecmp(argv[argc - 1], "follow")) {
+		follow = 1;
+		argc--;
+	}
+	if (argc > 1) {
+		p.seq = strtoul(argv[1], &e, 0);
+		if (e && *e) {
+			fprintf(stderr, "Bad sequence number\n");
+			return -1;
+		}
+	}
+	if (follow && !ec_pollevent) {
+		fprintf(stderr, "Polling for MKBP event not supported\n");
+		return -EINVAL;
+	}
+
+	rv = event_log_print(&p);
+	while (!rv && follow) {
+		fflush(stdout);
+		rv = ec_pollevent(1 << EC_MKBP_EVENT_EVENT_LOG, &buffer,
+				  sizeof(buffer), -1);
+		if (rv < 0) {
+			perror("Error polling for MKBP event");
+			return -EIO;
+		}
+		rv = event_log_print(&p);
+	}
+
+	return rv;
+}
+
+int cmd_memmap_notify(int argc, char *argv[])
+{
+	struct ec_params_memmap_notify p;
+	struct ec_response_memmap_notify r;
+	struct ec_response_get_next_event_v1 buffer;
+	long timeout = 5000;
+	char *e;
+	int rv;
+
+	if (argc < 2 || (argc > 2 && strcasecmp(argv[2], "wait"))) {
+		fprintf(stderr, "Usage: %s <mask> [wait <timeout>]\n",
+			argv[0]);
+		return -1;
+	}
+
+	p.subscribe_mask = strtoul(argv[1], &e, 0);
+	if (e && *e) {
+		fprintf(stderr, "Bad mask '%s'.\n", argv[1]);
+		return -1;
+	}
+	if (argc > 3) {
+		timeout = strtol(argv[3], &e, 0);
+		if (e && *e) {
+			fprintf(stderr, "Bad timeout value '%s'.\n", argv[3]);
+			return -1;
+		}
+	}
+
+	rv = ec_command(EC_CMD_MEMMAP_NOTIFY, 0, &p, sizeof(p), &r, sizeof(r));
+	if (rv < 0)
+		return rv;
+
+	printf("Pending blocks: 0x%08x\n", r.dirty_mask);
+
+	if (argc < 3)
+		return 0;
+
+	if (!ec_pollevent) {
+		fprintf(stderr, "Polling for MKBP event not supported\n");
+		return -EINVAL;
+	}
+
+	rv = wait_event(EC_MKBP_EVENT_MEMMAP_CHANGE, &buffer, sizeof(buffer),
+			timeout);
+	if (rv < 0)
+		return rv;
+
+	printf("Changed blocks: 0x%08x\n", buffer.data.memmap_dirty);
+
+	return 0;
+}
+
 static void cmd_cec_help(const char *cmd)
 {
 	fprintf(stderr,
@@ -10028,10 +12023,12 @@ const struct command commands[] = {
 	{"apreset", cmd_apreset},
 	{"autofanctrl", cmd_thermal_auto_fan_ctrl},
 	{"backlight", cmd_lcd_backlight},
+	{"batch", cmd_batch},
 	{"battery", cmd_battery},
 	{"batterycutoff", cmd_battery_cut_off},
 	{"batteryparam", cmd_battery_vendor_param},
 	{"boardversion", cmd_board_version},
+	{"boottrace", cmd_boot_trace},
 	{"button", cmd_button},
 	{"cbi", cmd_cbi},
 	{"chargecurrentlimit", cmd_charge_current_limit},
@@ -10042,9 +12039,12 @@ const struct command commands[] = {
 	{"cmdversions", cmd_cmdversions},
 	{"console", cmd_console},
 	{"cec", cmd_cec},
+	{"crashdump", cmd_crashdump},
+	{"deferredstats", cmd_deferred_stats},
 	{"echash", cmd_ec_hash},
 	{"eventclear", cmd_host_event_clear},
 	{"eventclearb", cmd_host_event_clear_b},
+	{"eventlog", cmd_event_log},
 	{"eventget", cmd_host_event_get_raw},
 	{"eventgetb", cmd_host_event_get_b},
 	{"eventgetscimask", cmd_host_event_get_sci_mask},
@@ -10055,10 +12055,12 @@ const struct command commands[] = {
 	{"eventsetwakemask", cmd_host_event_set_wake_mask},
 	{"extpwrlimit", cmd_ext_power_limit},
 	{"fanduty", cmd_fanduty},
+	{"fantuning", cmd_fan_tuning},
 	{"flasherase", cmd_flash_erase},
 	{"flasheraseasync", cmd_flash_erase},
 	{"flashprotect", cmd_flash_protect},
 	{"flashread", cmd_flash_read},
+	{"flashupdate", cmd_flash_write},
 	{"flashwrite", cmd_flash_write},
 	{"flashinfo", cmd_flash_info},
 	{"flashspiinfo", cmd_flash_spi_info},
@@ -10077,13 +12079,17 @@ const struct command commands[] = {
 	{"hangdetect", cmd_hang_detect},
 	{"hello", cmd_hello},
 	{"hibdelay", cmd_hibdelay},
+	{"hostcmdtrace", cmd_hostcmd_trace},
 	{"hostevent", cmd_hostevent},
 	{"hostsleepstate", cmd_hostsleepstate},
 	{"locatechip", cmd_locate_chip},
 	{"i2cprotect", cmd_i2c_protect},
 	{"i2cread", cmd_i2c_read},
+	{"i2cstats", cmd_i2c_stats},
+	{"i2cstream", cmd_i2c_stream},
 	{"i2cwrite", cmd_i2c_write},
 	{"i2cxfer", cmd_i2c_xfer},
+	{"idlestats", cmd_idle_stats},
 	{"infopddev", cmd_pd_device_info},
 	{"inventory", cmd_inventory},
 	{"led", cmd_led},
@@ -10091,9 +12097,11 @@ const struct command commands[] = {
 	{"kbfactorytest", cmd_keyboard_factory_test},
 	{"kbid", cmd_kbid},
 	{"kbinfo", cmd_kbinfo},
+	{"kblatency", cmd_kblatency},
 	{"kbpress", cmd_kbpress},
 	{"keyconfig", cmd_keyconfig},
 	{"keyscan", cmd_keyscan},
+	{"memmapnotify", cmd_memmap_notify},
 	{"mkbpget", cmd_mkbp_get},
 	{"mkbpwakemask", cmd_mkbp_wake_mask},
 	{"motionsense", cmd_motionsense},
@@ -10106,8 +12114,10 @@ const struct command commands[] = {
 	{"pdlog", cmd_pd_log},
 	{"pdcontrol", cmd_pd_control},
 	{"pdchipinfo", cmd_pd_chip_info},
+	{"pdtrace", cmd_pd_trace},
 	{"pdwritelog", cmd_pd_write_log},
 	{"powerinfo", cmd_power_info},
+	{"powertranslog", cmd_power_transition_log},
 	{"protoinfo", cmd_proto_info},
 	{"pse", cmd_pse},
 	{"pstoreinfo", cmd_pstore_info},
@@ -10133,11 +12143,15 @@ const struct command commands[] = {
 	{"rwsigaction", cmd_rwsig_action_legacy},
 	{"rwsigstatus", cmd_rwsig_status},
 	{"sertest", cmd_serial_test},
+	{"shmemstats", cmd_shmem_stats},
 	{"smartdischarge", cmd_smart_discharge},
 	{"stress", cmd_stress_test},
 	{"sysinfo", cmd_sysinfo},
 	{"port80flood", cmd_port_80_flood},
 	{"switches", cmd_switches},
+	{"taskstack", cmd_task_stack},
+	{"taskstats", cmd_task_stats},
+	{"telemetry", cmd_telemetry},
 	{"temps", cmd_temperature},
 	{"tempsinfo", cmd_temp_sensor_info},
 	{"test", cmd_test},
@@ -10147,6 +12161,7 @@ const struct command commands[] = {
 	{"tpframeget", cmd_tp_frame_get},
 	{"tmp006cal", cmd_tmp006cal},
 	{"tmp006raw", cmd_tmp006raw},
+	{"tracepoints", cmd_tracepoints},
 	{"typeccontrol", cmd_typec_control},
 	{"typecdiscovery", cmd_typec_discovery},
 	{"typecstatus", cmd_typec_status},
@@ -10170,6 +12185,8 @@ int main(int argc, char *argv[])
 	int interfaces = COMM_ALL;
 	int i2c_bus = -1;
 	char device_name[41] = CROS_EC_DEV_NAME;
+	char *daemon_path = NULL;
+	int locked = 0;
 	int rv = 1;
 	int parse_error = 0;
 	char *e;
@@ -10221,6 +12238,9 @@ int main(int argc, char *argv[])
 		case OPT_ASCII:
 			ascii_mode = 1;
 			break;
+		case OPT_DAEMON:
+			daemon_path = optarg;
+			break;
 		}
 	}
 
@@ -10233,12 +12253,12 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	/* Must specify a command */
-	if (!parse_error && optind == argc)
+	/* Must specify a command, unless serving them from a socket */
+	if (!parse_error && (optind == argc) == !daemon_path)
 		parse_error = 1;
 
 	/* 'ectool help' prints help with commands */
-	if (!parse_error && !strcasecmp(argv[optind], "help")) {
+	if (!parse_error && !daemon_path && !strcasecmp(argv[optind], "help")) {
 		print_help(argv[0], 1);
 		exit(1);
 	}
@@ -10266,6 +12286,7 @@ int main(int argc, char *argv[])
 			fprintf(stderr, "Could not acquire GEC lock.\n");
 			exit(1);
 		}
+		locked = 1;
 		if (comm_init_alt(interfaces, device_name, i2c_bus)) {
 			fprintf(stderr, "Couldn't find EC\n");
 			goto out;
@@ -10277,6 +12298,11 @@ int main(int argc, char *argv[])
 		goto out;
 	}
 
+	if (daemon_path) {
+		ectool_daemon(daemon_path, commands, locked);
+		goto out;
+	}
+
 	/* Handle commands */
 	for (cmd = commands; cmd->name; cmd++) {
 		if (!strcasecmp(argv[optind], cmd->name)) {
@@ -40,3 +40,23 @@ struct command {
  * The key matrix is read from the fdt.
  */
 int cmd_keyscan(int argc, char *argv[]);
+
+/**
+ * Serve ectool commands over a UNIX socket
+ *
+ * ectool --daemon=<path>
+ *
+ * Keeps the EC interface opened by main() and the protocol info probed by
+ * comm_init_buffer(), and runs one command per connection. The client writes
+ * a single line with the command and its whitespace separated arguments, as
+ * they would be passed to ectool. The daemon replies with the output of the
+ * command followed by a "status: <n>" line, where <n> is the exit status
+ * ectool would have returned, then closes the connection.
+ *
+ * @param path     Path of the UNIX socket to create
+ * @param cmds     Command table, terminated by an entry with a NULL name
+ * @param use_lock Whether the GEC lock is held and must be taken around each
+ *                 command (interfaces other than /dev/cros_ec)
+ * @return -1 on error; does not return otherwise.
+ */
+int ectool_daemon(const char *path, const struct command *cmds, int use_lock);
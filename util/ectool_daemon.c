@@ -0,0 +1,207 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * ectool daemon mode: keeps the EC interface open and serves one command
+ * per connection on a UNIX socket.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "compile_time_macros.h"
+#include "ectool.h"
+#include "lock/gec_lock.h"
+
+/* Longest request line, and most arguments in a request */
+#define DAEMON_MAX_REQUEST 1024
+#define DAEMON_MAX_ARGS 64
+
+#define GEC_LOCK_TIMEOUT_SECS 30
+
+/*
+ * Read one request line from |fd| into |buf|. Returns the length of the
+ * request, without the newline, or -1 on error.
+ */
+static int read_request(int fd, char *buf, int size)
+{
+	int len = 0;
+
+	while (len < size - 1) {
+		int n = read(fd, buf + len, size - 1 - len);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		len += n;
+		if (memchr(buf + len - n, '\n', n))
+			break;
+	}
+	buf[len] = '\0';
+
+	if (len == size - 1 && !strchr(buf, '\n'))
+		return -1;
+	buf[strcspn(buf, "\r\n")] = '\0';
+
+	return strlen(buf);
+}
+
+/* Split |line| in place into whitespace separated arguments. */
+static int split_args(char *line, char *argv[], int max_args)
+{
+	char *saveptr;
+	char *arg;
+	int argc = 0;
+
+	for (arg = strtok_r(line, " \t", &saveptr); arg;
+	     arg = strtok_r(NULL, " \t", &saveptr)) {
+		if (argc == max_args - 1)
+			return -1;
+		argv[argc++] = arg;
+	}
+	argv[argc] = NULL;
+
+	return argc;
+}
+
+/* Run one command, with stdout and stderr sent to |fd|. */
+static int run_command(int fd, int argc, char *argv[],
+		       const struct command *cmds)
+{
+	const struct command *cmd;
+	int rv = 1;
+
+	dup2(fd, STDOUT_FILENO);
+	dup2(fd, STDERR_FILENO);
+	close(fd);
+
+	for (cmd = cmds; cmd->name; cmd++) {
+		if (!strcasecmp(argv[0], cmd->name)) {
+			/* Handlers may use getopt() on their arguments */
+			optind = 0;
+			rv = cmd->handler(argc, argv);
+			break;
+		}
+	}
+	if (!cmd->name)
+		fprintf(stderr, "Unknown command '%s'\n", argv[0]);
+
+	fflush(stdout);
+	fflush(stderr);
+	return !!rv;
+}
+
+static void handle_connection(int fd, int listen_fd,
+			      const struct command *cmds, int use_lock)
+{
+	char line[DAEMON_MAX_REQUEST];
+	char *argv[DAEMON_MAX_ARGS];
+	int argc, status;
+	pid_t pid;
+
+	if (read_request(fd, line, sizeof(line)) < 0) {
+		dprintf(fd, "Request too long\nstatus: 1\n");
+		return;
+	}
+	argc = split_args(line, argv, ARRAY_SIZE(argv));
+	if (argc < 0) {
+		dprintf(fd, "Too many arguments\nstatus: 1\n");
+		return;
+	}
+	if (!argc)
+		return;
+
+	if (use_lock && acquire_gec_lock(GEC_LOCK_TIMEOUT_SECS) < 0) {
+		dprintf(fd, "Could not acquire GEC lock.\nstatus: 1\n");
+		return;
+	}
+
+	/*
+	 * Commands run in a child process: some of them exit() on errors or
+	 * keep static state, and neither must affect the daemon. The child
+	 * inherits the open EC interface and the probed protocol info.
+	 */
+	pid = fork();
+	if (pid == 0) {
+		close(listen_fd);
+		exit(run_command(fd, argc, argv, cmds));
+	}
+
+	status = 1;
+	if (pid < 0) {
+		perror("fork");
+	} else {
+		while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+			;
+		status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+	}
+
+	if (use_lock)
+		release_gec_lock();
+
+	dprintf(fd, "status: %d\n", status);
+}
+
+int ectool_daemon(const char *path, const struct command *cmds, int use_lock)
+{
+	struct sockaddr_un addr;
+	int listen_fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path too long\n");
+		return -1;
+	}
+	strcpy(addr.sun_path, path);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0) {
+		perror("socket");
+		return -1;
+	}
+
+	unlink(path);
+	if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(listen_fd, 8) < 0) {
+		perror(path);
+		close(listen_fd);
+		return -1;
+	}
+
+	/* Don't die if a client goes away before reading its response */
+	signal(SIGPIPE, SIG_IGN);
+	/* Children must not flush our buffered output again */
+	fflush(stdout);
+	fflush(stderr);
+
+	/* Other ectool instances are locked out only while a command runs */
+	if (use_lock)
+		release_gec_lock();
+
+	while (1) {
+		int fd = accept(listen_fd, NULL, NULL);
+
+		if (fd < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("accept");
+			break;
+		}
+		handle_connection(fd, listen_fd, cmds, use_lock);
+		close(fd);
+	}
+
+	close(listen_fd);
+	unlink(path);
+	return -1;
+}
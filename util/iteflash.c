@@ -110,6 +110,7 @@ struct iteflash_config {
 	char *output_filename;
 	int send_waveform;  /* boolean */
 	int erase;  /* boolean */
+	int skip_unchanged;  /* boolean */
 	int i2c_mux; /* boolean */
 	int debug;  /* boolean */
 	int disable_watchdog;  /* boolean */
@@ -185,8 +186,12 @@ static void config_release(struct iteflash_config *conf)
 	null_and_free((void **)&conf->i2c_dev_path);
 }
 
-/* number of bytes to send consecutively before checking for ACKs */
-#define FTDI_TX_BUFFER_LIMIT	32
+/*
+ * Number of bytes to send consecutively before checking for ACKs. Each byte
+ * takes 14 bytes of MPSSE commands, so a whole page plus the address byte
+ * and the START condition still fit in FTDI_CMD_BUF_SIZE.
+ */
+#define FTDI_TX_BUFFER_LIMIT	(PAGE_SIZE + 1)
 
 static inline int i2c_byte_transfer(struct common_hnd *chnd, uint8_t addr,
 				    uint8_t *data, int write, int numbytes)
@@ -233,35 +238,81 @@ static int linux_i2c_byte_transfer(struct common_hnd *chnd, uint8_t addr,
 	return ret;
 }
 
-static int i2c_add_send_byte(struct ftdi_context *ftdi, uint8_t *buf,
-			     uint8_t *ptr, uint8_t *tbuf, int tcnt, int debug)
+/* Queue the MPSSE commands clocking out one byte and reading its ACK bit. */
+static uint8_t *i2c_queue_send_byte(uint8_t *b, uint8_t byte)
+{
+	/* WORKAROUND: force SDA before sending the next byte */
+	*b++ = SET_BITS_LOW; *b++ = SDA_BIT; *b++ = SCL_BIT | SDA_BIT;
+	/* write byte */
+	*b++ = MPSSE_DO_WRITE | MPSSE_BITMODE | MPSSE_WRITE_NEG;
+	*b++ = 0x07; *b++ = byte;
+	/* prepare for ACK */
+	*b++ = SET_BITS_LOW; *b++ = 0; *b++ = SCL_BIT;
+	/* read ACK */
+	*b++ = MPSSE_DO_READ | MPSSE_BITMODE | MPSSE_LSB;
+	*b++ = 0;
+
+	return b;
+}
+
+/*
+ * Read |count| ACK bits queued by i2c_queue_send_byte(). Returns the last
+ * failed ACK, zero if all bytes were acknowledged, or a negative error.
+ */
+static int i2c_read_acks(struct ftdi_context *ftdi, int count)
 {
-	int ret, i, j, remaining_data, ack_idx;
-	int tx_buffered = 0;
 	static uint8_t ack[FTDI_TX_BUFFER_LIMIT];
-	uint8_t *b = ptr;
+	int ret, j;
+	int remaining_data = count;
+	int ack_idx = 0;
 	uint8_t failed_ack = 0;
 
-	for (i = 0; i < tcnt; i++) {
-		/* WORKAROUND: force SDA before sending the next byte */
-		*b++ = SET_BITS_LOW; *b++ = SDA_BIT; *b++ = SCL_BIT | SDA_BIT;
-		/* write byte */
-		*b++ = MPSSE_DO_WRITE | MPSSE_BITMODE | MPSSE_WRITE_NEG;
-		*b++ = 0x07; *b++ = *tbuf++;
-		/* prepare for ACK */
-		*b++ = SET_BITS_LOW; *b++ = 0; *b++ = SCL_BIT;
-		/* read ACK */
-		*b++ = MPSSE_DO_READ | MPSSE_BITMODE | MPSSE_LSB;
-		*b++ = 0;
-		*b++ = SEND_IMMEDIATE;
+	do {
+		ret = ftdi_read_data(ftdi, &ack[ack_idx], remaining_data);
+		if (ret < 0) {
+			fprintf(stderr, "read ACK failed\n");
+			return ret;
+		}
+		remaining_data -= ret;
+		ack_idx += ret;
+	} while (remaining_data);
+
+	for (j = 0; j < count; j++) {
+		if ((ack[j] & 0x80) != 0)
+			failed_ack = ack[j];
+	}
 
-		tx_buffered++;
+	return failed_ack;
+}
+
+/*
+ * Send |tcnt| bytes. |acks| is the number of bytes already queued between
+ * |buf| and |ptr| whose ACK bits have not been read yet (e.g. the address).
+ * Everything queued is sent in as few USB transfers as possible: one per
+ * FTDI_TX_BUFFER_LIMIT bytes, with a single SEND_IMMEDIATE so the chip
+ * returns all the ACK bits of a batch in one USB packet.
+ */
+static int i2c_add_send_byte(struct ftdi_context *ftdi, uint8_t *buf,
+			     uint8_t *ptr, uint8_t *tbuf, int tcnt, int acks,
+			     int debug)
+{
+	int ret, i;
+	int tx_buffered = acks;
+	uint8_t *b = ptr;
+
+	for (i = 0; i < tcnt || tx_buffered; i++) {
+		if (i < tcnt) {
+			b = i2c_queue_send_byte(b, *tbuf++);
+			tx_buffered++;
+		}
 
 		/*
 		 * On the last byte, or every FTDI_TX_BUFFER_LIMIT bytes, read
 		 * the ACK bits.
 		 */
-		if (i == tcnt-1 || (tx_buffered == FTDI_TX_BUFFER_LIMIT)) {
+		if (i >= tcnt-1 || (tx_buffered == FTDI_TX_BUFFER_LIMIT)) {
+			*b++ = SEND_IMMEDIATE;
+
 			/* write data */
 			ret = ftdi_write_data(ftdi, buf, b - buf);
 			if (ret < 0) {
@@ -269,45 +320,32 @@ static int i2c_add_send_byte(struct ftdi_context *ftdi, uint8_t *buf,
 				return ret;
 			}
 
-			/* read ACK bits */
-			remaining_data = tx_buffered;
-			ack_idx = 0;
-			do {
-				ret = ftdi_read_data(ftdi, &ack[ack_idx],
-					remaining_data);
-				if (ret < 0) {
-					fprintf(stderr, "read ACK failed\n");
-					return ret;
-				}
-				remaining_data -= ret;
-				ack_idx += ret;
-			} while (remaining_data);
-			for (j = 0; j < tx_buffered; j++) {
-				if ((ack[j] & 0x80) != 0)
-					failed_ack = ack[j];
-			}
-
-			/* check ACK bits */
-			if (ret < 0 || failed_ack) {
+			/* read and check ACK bits */
+			ret = i2c_read_acks(ftdi, tx_buffered);
+			if (ret) {
 				if (debug)
 					fprintf(stderr,
-						"write ACK fail: %d, 0x%02x\n",
-						ret, failed_ack);
+						"write ACK fail: %d\n", ret);
 				return  -ENXIO;
 			}
 
 			/* reset for next set of transactions */
-			b = ptr;
+			b = buf;
 			tx_buffered = 0;
 		}
 	}
 	return 0;
 }
 
+/*
+ * Receive |rcnt| bytes. As for i2c_add_send_byte(), |acks| bytes queued in
+ * front of |ptr| are sent in the same USB transfer and their ACK bits are
+ * checked before the data is returned.
+ */
 static int i2c_add_recv_bytes(struct ftdi_context *ftdi, uint8_t *buf,
-			      uint8_t *ptr, uint8_t *rbuf, int rcnt)
+			      uint8_t *ptr, uint8_t *rbuf, int rcnt, int acks)
 {
-	int ret, i, rbuf_idx;
+	int ret, i, rbuf_idx, nack;
 	uint8_t *b = ptr;
 
 	for (i = 0; i < rcnt; i++) {
@@ -325,7 +363,7 @@ static int i2c_add_recv_bytes(struct ftdi_context *ftdi, uint8_t *buf,
 			/* ACK all other bytes */
 			*b++ = SET_BITS_LOW; *b++ = 0; *b++ = SCL_BIT | SDA_BIT;
 			*b++ = MPSSE_DO_WRITE | MPSSE_BITMODE | MPSSE_WRITE_NEG;
-			*b++ = 0; *b++ = 0; *b++ = SEND_IMMEDIATE;
+			*b++ = 0; *b++ = 0;
 		}
 	}
 
@@ -335,6 +373,9 @@ static int i2c_add_recv_bytes(struct ftdi_context *ftdi, uint8_t *buf,
 		return ret;
 	}
 
+	/* The data bytes are read even on a NACK, to leave the FIFO empty */
+	nack = acks ? i2c_read_acks(ftdi, acks) : 0;
+
 	rbuf_idx = 0;
 	do {
 		ret = ftdi_read_data(ftdi, &rbuf[rbuf_idx], rcnt);
@@ -346,7 +387,7 @@ static int i2c_add_recv_bytes(struct ftdi_context *ftdi, uint8_t *buf,
 		rbuf_idx += ret;
 	} while (rcnt);
 
-	return ret;
+	return nack ? -ENXIO : ret;
 }
 
 #define USB_I2C_HEADER_SIZE 4
@@ -448,24 +489,23 @@ static int ftdi_i2c_byte_transfer(struct common_hnd *chnd, uint8_t addr,
 	*b++ = SET_BITS_LOW; *b++ = 0; *b++ = SCL_BIT | SDA_BIT;
 	*b++ = SET_BITS_LOW; *b++ = 0; *b++ = SCL_BIT | SDA_BIT;
 
-	/* send address */
+	/*
+	 * Queue the address together with the data so that the whole
+	 * transaction, up to FTDI_TX_BUFFER_LIMIT bytes, takes a single USB
+	 * round trip instead of one for the address and one for the data.
+	 */
 	slave_addr = (addr << 1) | (write ? 0 : 1);
-	ret = i2c_add_send_byte(ftdi, buf, b, &slave_addr, 1, chnd->conf.debug);
-	if (ret < 0) {
-		if (chnd->conf.debug)
-			fprintf(stderr, "address %02x failed\n", addr);
-		ret = -ENXIO;
-		goto exit_xfer;
-	}
+	b = i2c_queue_send_byte(b, slave_addr);
 
-	b = buf;
 	if (write) /* write data */
-		ret = i2c_add_send_byte(ftdi, buf, b, data, numbytes,
+		ret = i2c_add_send_byte(ftdi, buf, b, data, numbytes, 1,
 			chnd->conf.debug);
 	else /* read data */
-		ret = i2c_add_recv_bytes(ftdi, buf, b, data, numbytes);
+		ret = i2c_add_recv_bytes(ftdi, buf, b, data, numbytes, 1);
+
+	if (ret == -ENXIO && chnd->conf.debug)
+		fprintf(stderr, "transfer to address %02x failed\n", addr);
 
-exit_xfer:
 	b = buf;
 	/* STOP condition */
 	/* SCL high, SDA low */
@@ -1345,6 +1385,21 @@ failed_write:
 
 
 
+/* Erases operate on whole sectors, and only the chip erase on the full chip. */
+static int check_erase_range(struct common_hnd *chnd, uint32_t len,
+			     uint32_t off)
+{
+	uint32_t sector_size = sector_erase_pages * PAGE_SIZE;
+
+	if ((off % sector_size) || (len % sector_size) ||
+	    off + len > chnd->flash_size) {
+		fprintf(stderr, "Erase range 0x%x+0x%x is not sector aligned "
+			"or exceeds the flash\n", off, len);
+		return -1;
+	}
+	return 0;
+}
+
 static int command_erase(struct common_hnd *chnd, uint32_t len, uint32_t off)
 {
 	int res = -EIO;
@@ -1353,10 +1408,9 @@ static int command_erase(struct common_hnd *chnd, uint32_t len, uint32_t off)
 
 	printf("Erasing chip...\n");
 
-	if (off != 0 || len != chnd->flash_size) {
-		fprintf(stderr, "Only full chip erase is supported\n");
+	if (check_erase_range(chnd, len, off) < 0)
 		return -EINVAL;
-	}
+	page = off / PAGE_SIZE;
 
 	if (spi_flash_follow_mode(chnd, "erase") < 0)
 		goto failed_erase;
@@ -1441,10 +1495,9 @@ static int command_erase2(struct common_hnd *chnd, uint32_t len,
 
 	printf("Erasing flash...erase size=%d\n", len);
 
-	if (off != 0 || len != chnd->flash_size) {
-		fprintf(stderr, "Only full chip erase is supported\n");
+	if (check_erase_range(chnd, len, off) < 0)
 		return -EINVAL;
-	}
+	page = off / PAGE_SIZE;
 
 	if (spi_flash_follow_mode(chnd, "erase") < 0)
 		goto failed_erase;
@@ -1562,11 +1615,14 @@ static int read_flash(struct common_hnd *chnd)
 	return (res < 0) ? res : 0;
 }
 
-/* Return zero on success, a negative error value on failures. */
-static int write_flash(struct common_hnd *chnd, const char *filename,
-		       uint32_t offset)
+/*
+ * Read the image from |filename| into a newly allocated flash sized buffer.
+ * Return the image size on success, a negative error value on failures.
+ */
+static int load_image(struct common_hnd *chnd, const char *filename,
+		      uint8_t **image)
 {
-	int res, written;
+	int res;
 	FILE *hnd;
 	int size = chnd->flash_size;
 	uint8_t *buffer = malloc(size);
@@ -1588,22 +1644,35 @@ static int write_flash(struct common_hnd *chnd, const char *filename,
 	if (res <= 0) {
 		fprintf(stderr, "%s: Failed to read %d bytes from %s with "
 			"ferror() %d\n", __func__, size, filename, ferror(hnd));
-		free(buffer);
 		fclose(hnd);
+		free(buffer);
 		return -EIO;
 	}
 	fclose(hnd);
 
-	printf("Writing %d bytes at 0x%08x\n", res, offset);
-	written = command_write_pages(chnd, offset, res, buffer);
-	if (written != res) {
+	*image = buffer;
+	return res;
+}
+
+/*
+ * The write functions below program |size| bytes of |image| at |offset|.
+ * |image| holds the whole image, indexed by flash address.
+ */
+
+/* Return zero on success, a negative error value on failures. */
+static int write_flash(struct common_hnd *chnd, uint8_t *image,
+		       uint32_t offset, int size)
+{
+	int written;
+
+	printf("Writing %d bytes at 0x%08x\n", size, offset);
+	written = command_write_pages(chnd, offset, size, &image[offset]);
+	if (written != size) {
 		fprintf(stderr, "%s: Error writing to flash\n", __func__);
-		free(buffer);
 		return -EIO;
 	}
 	printf("\n\rWriting Done.\n");
 
-	free(buffer);
 	return 0;
 }
 
@@ -1614,39 +1683,13 @@ static int write_flash(struct common_hnd *chnd, const char *filename,
  * The original flow may not work on the DX chip.
  *
  */
-static int write_flash2(struct common_hnd *chnd, const char *filename,
-			uint32_t offset)
+static int write_flash2(struct common_hnd *chnd, uint8_t *buffer,
+			uint32_t offset, int size)
 {
-	int res;
+	int res = size;
 	int block_write_size = chnd->conf.block_write_size;
-	FILE *hnd;
-	int size = chnd->flash_size;
 	int cnt, two_bytes_sent, ret;
 	uint8_t addr_h, addr_m, addr_l, data_ff = 0xff;
-	uint8_t *buffer = malloc(size);
-
-	if (!buffer) {
-		fprintf(stderr, "%s: Cannot allocate %d bytes\n", __func__,
-			size);
-		return -ENOMEM;
-	}
-
-	hnd = fopen(filename, "r");
-	if (!hnd) {
-		fprintf(stderr, "%s: Cannot open file %s for reading\n",
-			__func__, filename);
-		free(buffer);
-		return -EIO;
-	}
-	res = fread(buffer, 1, size, hnd);
-	if (res <= 0) {
-		fprintf(stderr, "%s: Failed to read %d bytes from %s with "
-			"ferror() %d\n", __func__, size, filename, ferror(hnd));
-		fclose(hnd);
-		free(buffer);
-		return -EIO;
-	}
-	fclose(hnd);
 
 	/* Enter follow mode */
 	if (spi_flash_follow_mode(chnd, "AAI write") < 0) {
@@ -1701,7 +1744,7 @@ __send_aai_cmd:
 
 		res -= cnt;
 		offset += cnt;
-		draw_spinner(res, res + offset);
+		draw_spinner(res, size);
 
 		/* We need to resend aai write command at 256KB boundary. */
 		if (!(offset % 0x40000) && res) {
@@ -1731,8 +1774,6 @@ failed_enter_mode:
 	else
 		printf("\n\rWriting Done.\n");
 
-	free(buffer);
-
 	return ret;
 }
 
@@ -1743,38 +1784,12 @@ failed_enter_mode:
  * The original flow may not work on the DX chip.
  *
  */
-static int write_flash3(struct common_hnd *chnd, const char *filename,
-			uint32_t offset)
+static int write_flash3(struct common_hnd *chnd, uint8_t *buf,
+			uint32_t offset, int size)
 {
-	int res, ret = 0;
+	int res = size, ret = 0;
 	int block_write_size = chnd->conf.block_write_size;
-	FILE *hnd;
-	int size = chnd->flash_size;
 	int cnt;
-	uint8_t *buf = malloc(size);
-
-	if (!buf) {
-		fprintf(stderr, "%s: Cannot allocate %d bytes\n", __func__,
-			size);
-		return -ENOMEM;
-	}
-
-	hnd = fopen(filename, "r");
-	if (!hnd) {
-		fprintf(stderr, "%s: Cannot open file %s for reading\n",
-			__func__, filename);
-		free(buf);
-		return -EIO;
-	}
-	res = fread(buf, 1, size, hnd);
-	if (res <= 0) {
-		fprintf(stderr, "%s: Failed to read %d bytes from %s with "
-			"ferror() %d\n", __func__, size, filename, ferror(hnd));
-		fclose(hnd);
-		free(buf);
-		return -EIO;
-	}
-	fclose(hnd);
 
 	printf("Writing %d bytes at 0x%08x.......\n", res, offset);
 
@@ -1796,11 +1811,10 @@ static int write_flash3(struct common_hnd *chnd, const char *filename,
 
 		res -= cnt;
 		offset += cnt;
-		draw_spinner(res, res + offset);
+		draw_spinner(res, size);
 	}
 
 failed_write:
-	free(buf);
 	spi_flash_command_short(chnd, SPI_CMD_WRITE_DISABLE,
 		"SPI write disable");
 	spi_flash_follow_mode_exit(chnd, "Page program");
@@ -1812,55 +1826,138 @@ failed_write:
 	return ret;
 }
 
+/* Program |size| bytes of |image| at |offset| with the flow of this chip. */
+static int write_image(struct common_hnd *chnd, uint8_t *image,
+		       uint32_t offset, int size)
+{
+	if (!chnd->flash_cmd_v2)
+		return write_flash(chnd, image, offset, size);
 
+	switch (eflash_type) {
+	case EFLASH_TYPE_8315:
+		return write_flash2(chnd, image, offset, size);
+	case EFLASH_TYPE_KGD:
+		return write_flash3(chnd, image, offset, size);
+	default:
+		printf("Invalid EFLASH TYPE!");
+		return -EINVAL;
+	}
+}
 
-/* Return zero on success, a non-zero value on failures. */
-static int verify_flash(struct common_hnd *chnd, const char *filename,
-			uint32_t offset)
+static int erase_range(struct common_hnd *chnd, uint32_t len, uint32_t off)
 {
-	int res;
-	int file_size;
-	FILE *hnd;
-	uint8_t *buffer  = malloc(chnd->flash_size);
-	uint8_t *buffer2 = malloc(chnd->flash_size);
+	if (chnd->flash_cmd_v2)
+		return command_erase2(chnd, len, off, 0);
+	else
+		return command_erase(chnd, len, off);
+}
 
-	if (!buffer || !buffer2) {
-		fprintf(stderr, "%s: Cannot allocate %d bytes\n", __func__,
-			chnd->flash_size);
-		free(buffer);
-		free(buffer2);
+/*
+ * Return the end of the run of sectors starting at |start| which all differ
+ * (|changed| set) or all match (|changed| clear) between |image| and |flash|.
+ */
+static uint32_t sector_run_end(const uint8_t *image, const uint8_t *flash,
+			       uint32_t start, uint32_t size, int changed)
+{
+	uint32_t sector_size = sector_erase_pages * PAGE_SIZE;
+	uint32_t end = start;
+	uint32_t cnt;
+
+	while (end < size) {
+		cnt = (size - end > sector_size) ? sector_size : size - end;
+		if (!!memcmp(&image[end], &flash[end], cnt) != changed)
+			break;
+		end += sector_size;
+	}
+	return end;
+}
+
+/*
+ * Read back the flash and only erase and program the sectors whose content
+ * differs from the |size| bytes of |image|: one fast read of the whole image
+ * is much cheaper than erasing and programming it.
+ *
+ * Return zero on success, a negative error value on failures.
+ */
+static int write_changed_sectors(struct common_hnd *chnd, uint8_t *image,
+				 uint32_t size)
+{
+	uint32_t sector_size = sector_erase_pages * PAGE_SIZE;
+	uint32_t start, end;
+	int changed = 0;
+	int ret = 0;
+	uint8_t *flash = malloc(size);
+
+	if (!flash) {
+		fprintf(stderr, "%s: Cannot allocate %u bytes\n", __func__,
+			size);
 		return -ENOMEM;
 	}
 
-	hnd = fopen(filename, "r");
-	if (!hnd) {
-		fprintf(stderr, "%s: Cannot open file %s for reading\n",
-			__func__, filename);
-		res = -EIO;
+	printf("Comparing %u bytes with the flash content\n", size);
+	ret = command_read_pages(chnd, 0, size, flash);
+	if (ret < 0)
 		goto exit;
-	}
+	ret = 0;
 
-	file_size = fread(buffer, 1, chnd->flash_size, hnd);
-	if (file_size <= 0) {
-		fprintf(stderr, "%s: Failed to read %d bytes from %s with "
-			"ferror() %d\n", __func__, chnd->flash_size, filename,
-			ferror(hnd));
-		fclose(hnd);
-		res = -EIO;
+	/* Erase every run of changed sectors... */
+	for (start = 0; start < size; start = end) {
+		start = sector_run_end(image, flash, start, size, 0);
+		if (start >= size)
+			break;
+		end = sector_run_end(image, flash, start, size, 1);
+		changed += (end - start) / sector_size;
+		ret = erase_range(chnd, end - start, start);
+		if (ret < 0)
+			goto exit;
+	}
+	printf("%d of %u sectors changed\n", changed,
+	       (size + sector_size - 1) / sector_size);
+	if (!changed)
 		goto exit;
+
+	/* Call DBGR Rest to clear the EC lock status after erasing */
+	dbgr_reset(chnd, RSTS_VCCDO_PW_ON|RSTS_HGRST|RSTS_GRST);
+
+	/* ...then program them. */
+	for (start = 0; start < size; start = end) {
+		start = sector_run_end(image, flash, start, size, 0);
+		if (start >= size)
+			break;
+		end = sector_run_end(image, flash, start, size, 1);
+		if (end > size)
+			end = size;
+		ret = write_image(chnd, image, start, end - start);
+		if (ret < 0)
+			goto exit;
+	}
+
+exit:
+	free(flash);
+	return ret;
+}
+
+/* Return zero on success, a non-zero value on failures. */
+static int verify_flash(struct common_hnd *chnd, uint8_t *image,
+			uint32_t offset, int size)
+{
+	int res;
+	uint8_t *buffer = malloc(size);
+
+	if (!buffer) {
+		fprintf(stderr, "%s: Cannot allocate %d bytes\n", __func__,
+			size);
+		return -ENOMEM;
 	}
-	fclose(hnd);
 
-	printf("Verify %d bytes at 0x%08x\n", file_size, offset);
-	res = command_read_pages(chnd, offset, chnd->flash_size, buffer2);
+	printf("Verify %d bytes at 0x%08x\n", size, offset);
+	res = command_read_pages(chnd, offset, size, buffer);
 	if (res > 0)
-		res = memcmp(buffer, buffer2, file_size);
+		res = memcmp(&image[offset], buffer, size);
 
 	printf("\n\rVerify %s\n", res ? "Failed!" : "Done.");
 
-exit:
 	free(buffer);
-	free(buffer2);
 	return res;
 }
 
@@ -2062,6 +2159,7 @@ static const struct option longopts[] = {
 	{"read", 1, 0, 'r'},
 	{"send-waveform", 1, 0, 'W'},
 	{"serial", 1, 0, 's'},
+	{"skip-unchanged", 0, 0, 'u'},
 	{"vendor", 1, 0, 'v'},
 	{"write", 1, 0, 'w'},
 	{NULL, 0, 0, 0}
@@ -2072,7 +2170,7 @@ static void display_usage(const char *program)
 	fprintf(stderr, "Usage: %s [-d] [-v <VID>] [-p <PID>] \\\n"
 		"\t[-c <linux|ccd|ftdi>] [-D /dev/i2c-<N>] [-i <1|2>] [-S] \\\n"
 		"\t[-s <serial>] [-e] [-r <file>] [-W <0|1|false|true>] \\\n"
-		"\t[-w <file>] [-R base[:size]] [-m] [-b <size>]\n",
+		"\t[-w <file>] [-u] [-R base[:size]] [-m] [-b <size>]\n",
 		program);
 	fprintf(stderr, "-d, --debug : Output debug traces.\n");
 	fprintf(stderr, "-e, --erase : Erase all the flash content.\n");
@@ -2097,6 +2195,9 @@ static void display_usage(const char *program)
 	fprintf(stderr, "-r, --read <file> : Read the flash content and"
 			" write it into <file>.\n");
 	fprintf(stderr, "-s, --serial <serialname> : USB serial string\n");
+	fprintf(stderr, "-u, --skip-unchanged : With --write, read the flash\n"
+		"\tback first and only erase and write the sectors which\n"
+		"\tdiffer from <file>.\n");
 	fprintf(stderr, "-v, --vendor <0x1234> : USB vendor ID\n");
 	fprintf(stderr, "-W, --send-waveform <0|1|false|true> : Send the"
 		" special waveform.\n"
@@ -2204,6 +2305,9 @@ static int parse_parameters(int argc, char **argv, struct iteflash_config *conf)
 			ret = strdup_with_errmsg(optarg, &conf->usb_serial,
 				"-s / --serial");
 			break;
+		case 'u':
+			conf->skip_unchanged = 1;
+			break;
 		case 'v':
 			conf->usb_vid = strtol(optarg, NULL, 16);
 			break;
@@ -2262,6 +2366,8 @@ static void register_sigaction(void)
 int main(int argc, char **argv)
 {
 	int ret = 1, other_ret;
+	int image_size = 0;
+	uint8_t *image = NULL;
 	struct common_hnd chnd = {
 		/* Default flag settings. */
 		.conf = {
@@ -2350,37 +2456,43 @@ int main(int argc, char **argv)
 	if (ret)
 		goto return_after_init;
 
-	if (chnd.conf.erase) {
-		if (chnd.flash_cmd_v2)
-			/* Do Normal Erase Function */
-			command_erase2(&chnd, chnd.flash_size, 0, 0);
-		else
-			command_erase(&chnd, chnd.flash_size, 0);
-		/* Call DBGR Rest to clear the EC lock status after erasing */
-		dbgr_reset(&chnd, RSTS_VCCDO_PW_ON|RSTS_HGRST|RSTS_GRST);
+	if (chnd.conf.output_filename) {
+		image_size = load_image(&chnd, chnd.conf.output_filename,
+					&image);
+		if (image_size < 0) {
+			ret = image_size;
+			goto return_after_init;
+		}
 	}
 
-	if (chnd.conf.output_filename) {
-		if (chnd.flash_cmd_v2)
-			switch (eflash_type) {
-			case EFLASH_TYPE_8315:
-				ret = write_flash2(&chnd,
-					chnd.conf.output_filename, 0);
-				break;
-			case EFLASH_TYPE_KGD:
-				ret = write_flash3(&chnd,
-					chnd.conf.output_filename, 0);
-				break;
-			default:
-				printf("Invalid EFLASH TYPE!");
-				ret = -EINVAL;
-				break;
-			}
-		else
-			ret = write_flash(&chnd, chnd.conf.output_filename, 0);
+	if (image && chnd.conf.skip_unchanged) {
+		ret = write_changed_sectors(&chnd, image, image_size);
 		if (ret)
 			goto return_after_init;
-		ret = verify_flash(&chnd, chnd.conf.output_filename, 0);
+	} else {
+		if (chnd.conf.erase) {
+			if (chnd.flash_cmd_v2)
+				/* Do Normal Erase Function */
+				command_erase2(&chnd, chnd.flash_size, 0, 0);
+			else
+				command_erase(&chnd, chnd.flash_size, 0);
+			/*
+			 * Call DBGR Rest to clear the EC lock status after
+			 * erasing
+			 */
+			dbgr_reset(&chnd,
+				   RSTS_VCCDO_PW_ON|RSTS_HGRST|RSTS_GRST);
+		}
+
+		if (image) {
+			ret = write_image(&chnd, image, 0, image_size);
+			if (ret)
+				goto return_after_init;
+		}
+	}
+
+	if (image) {
+		ret = verify_flash(&chnd, image, 0, image_size);
 		if (ret)
 			goto return_after_init;
 	}
@@ -2395,6 +2507,7 @@ int main(int argc, char **argv)
 	 * This avoids double reset after flash sequence.
 	 */
 	exit_dbgr_mode(&chnd);
+	free(image);
 
 	if (chnd.conf.i2c_mux) {
 		printf("configuring I2C MUX to none.\n");
@@ -273,6 +273,7 @@ speed_t baudrate = DEFAULT_BAUDRATE;
 int connect_retries = DEFAULT_CONNECT_RETRIES;
 int i2c_adapter = INVALID_I2C_ADAPTER;
 const char *spi_adapter;
+uint32_t spi_speed_hz;
 int i2c_slave_address = DEFAULT_I2C_SLAVE_ADDRESS;
 uint8_t boot_loader_version;
 const char *serial_port = "/dev/ttyUSB1";
@@ -510,6 +511,16 @@ int open_spi(const char *port)
 		return -1;
 	}
 
+	/* Otherwise keep the default clock of the spidev device */
+	if (spi_speed_hz) {
+		res = ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi_speed_hz);
+		if (res == -1) {
+			perror("Cannot set SPI speed");
+			close(fd);
+			return -1;
+		}
+	}
+
 	return fd;
 }
 
@@ -1416,6 +1427,7 @@ static const struct option longopts[] = {
 	{"read", 1, 0, 'r'},
 	{"retries", 1, 0, 'R'},
 	{"spi", 1, 0, 's'},
+	{"spi_speed", 1, 0, 'S'},
 	{"unprotect", 0, 0, 'u'},
 	{"version", 0, 0, 'v'},
 	{"write", 1, 0, 'w'},
@@ -1425,7 +1437,7 @@ static const struct option longopts[] = {
 void display_usage(char *program)
 {
 	fprintf(stderr,
-		"Usage: %s [-a <i2c_adapter> [-l address ]] | [-s]"
+		"Usage: %s [-a <i2c_adapter> [-l address ]] | [-s [-S <hz>]]"
 		" [-d <tty>] [-b <baudrate>]] [-u] [-e] [-U]"
 		" [-r <file>] [-w <file>] [-o offset] [-n length] [-g] [-p]"
 		" [-L <log_file>] [-c] [-v]\n",
@@ -1445,6 +1457,7 @@ void display_usage(char *program)
 	fprintf(stderr, "--r[ead] <file> : read the flash content and "
 			"write it into <file>\n");
 	fprintf(stderr, "--s[pi] </dev/spi> : use SPI adapter on </dev>.\n");
+	fprintf(stderr, "--S[pi_speed] <hz> : set the SPI clock to <hz>\n");
 	fprintf(stderr, "--w[rite] <file|-> : read <file> or\n\t"
 			"standard input and write it to flash\n");
 	fprintf(stderr, "--o[ffset] : offset to read/write/start from/to\n");
@@ -1496,7 +1509,8 @@ int parse_parameters(int argc, char **argv)
 	int flags = 0;
 	const char *log_file_name = NULL;
 
-	while ((opt = getopt_long(argc, argv, "a:l:b:cd:eghL:n:o:pr:R:s:w:uUv?",
+	while ((opt = getopt_long(argc, argv,
+				  "a:l:b:cd:eghL:n:o:pr:R:s:S:w:uUv?",
 				  longopts, &idx)) != -1) {
 		switch (opt) {
 		case 'a':
@@ -1548,6 +1562,9 @@ int parse_parameters(int argc, char **argv)
 			spi_adapter = optarg;
 			mode = MODE_SPI;
 			break;
+		case 'S':
+			spi_speed_hz = strtoul(optarg, NULL, 0);
+			break;
 		case 'w':
 			output_filename = optarg;
 			break;
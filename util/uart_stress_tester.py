@@ -10,6 +10,10 @@ This tester runs the command 'chargen' on EC and/or AP, captures the
 output, and compares it against the expected output to check any characters
 lost.
 
+With --frames, the EC sends numbered and timestamped frames instead
+('chargen frames'), and the tester reports the sustained throughput, lost,
+reordered and corrupted frames, and the jitter of the frame latency.
+
 Prerequisite:
     (1) This test needs PySerial. Please check if it is available before test.
         Can be installed by 'pip install pyserial'
@@ -38,6 +42,9 @@ CROS_PASSWORD = 'test0000'       # Password to login to ChromeOS
 CHARGEN_TXT = '0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz'
                                  # The result of 'chargen 62 62'
 CHARGEN_TXT_LEN = len(CHARGEN_TXT)
+FRAME_LEN = 64                   # Bytes per frame of 'chargen frames',
+                                 # including the line feed
+FRAME_HEADER_LEN = 19            # '#<seq> <time> ', both in 8 hex digits
 CR = '\r'                        # Carriage Return
 LF = '\n'                        # Line Feed
 CRLF = CR + LF
@@ -57,6 +64,116 @@ class ChargenTestError(Exception):
   pass
 
 
+class FrameStats(object):
+  """Statistics of a stream of 'chargen frames' frames
+
+  Attributes:
+    bytes: Number of bytes received in frames
+    corrupted: Number of lines which are not valid frames
+    duplicated: Number of frames received more than once
+    ec_summary: Fields of the '#end' line: frames sent, time to send them
+                in us, time blocked on the transmit buffer in us and
+                characters dropped, or None if it wasn't received
+    first_time: Host time the first frame arrived at
+    last_time: Host time the last frame arrived at
+    max_seq: Highest sequence number received
+    received: Set of sequence numbers received
+    reordered: Number of frames received after a later one
+    skew: List of host arrival time minus EC send time of each frame, in s
+  """
+
+  def __init__(self):
+    self.bytes = 0
+    self.corrupted = 0
+    self.duplicated = 0
+    self.ec_summary = None
+    self.first_time = None
+    self.last_time = None
+    self.max_seq = -1
+    self.received = set()
+    self.reordered = 0
+    self.skew = []
+    self._ec_time_base = 0
+    self._last_ec_time = None
+
+  @staticmethod
+  def expected_frame(seq):
+    """Return the payload of frame seq, without the line feed"""
+    return ''.join(CHARGEN_TXT[(seq + i) % CHARGEN_TXT_LEN]
+                   for i in range(FRAME_HEADER_LEN, FRAME_LEN - 1))
+
+  def add_line(self, line, host_time):
+    """Account for one line of output received at host_time"""
+    line = line.rstrip(CRLF)
+    if line.startswith('#end '):
+      try:
+        self.ec_summary = [int(x) for x in line.split()[1:5]]
+      except ValueError:
+        self.corrupted += 1
+      return
+
+    try:
+      if len(line) != FRAME_LEN - 1 or line[0] != '#':
+        raise ValueError
+      seq = int(line[1:9], 16)
+      ec_time = int(line[10:18], 16)
+      if line[FRAME_HEADER_LEN:] != self.expected_frame(seq):
+        raise ValueError
+    except ValueError:
+      self.corrupted += 1
+      return
+
+    if seq in self.received:
+      self.duplicated += 1
+      return
+    if seq < self.max_seq:
+      self.reordered += 1
+    self.max_seq = max(self.max_seq, seq)
+    self.received.add(seq)
+    self.bytes += FRAME_LEN
+
+    # The EC time is the low 32 bits of a us counter.
+    if self._last_ec_time is not None and ec_time < self._last_ec_time:
+      if self._last_ec_time - ec_time > 1 << 31:
+        self._ec_time_base += 1 << 32
+    self._last_ec_time = ec_time
+    self.skew.append(host_time - (self._ec_time_base + ec_time) / 1e6)
+
+    if self.first_time is None:
+      self.first_time = host_time
+    self.last_time = host_time
+
+  def sent(self):
+    """Return the number of frames the EC sent"""
+    if self.ec_summary:
+      return self.ec_summary[0]
+    return self.max_seq + 1
+
+  def lost(self):
+    """Return the number of frames sent but never received"""
+    return self.sent() - len(self.received)
+
+  def jitter(self):
+    """Return the 50th, 99th percentile and maximum latency jitter in s
+
+    The EC and host clocks have an unknown offset, so the latency of each
+    frame is measured relative to the fastest one.
+    """
+    if not self.skew:
+      return 0, 0, 0
+    base = min(self.skew)
+    rel = sorted(x - base for x in self.skew)
+    return (rel[len(rel) // 2], rel[min(len(rel) - 1, len(rel) * 99 // 100)],
+            rel[-1])
+
+  def throughput(self):
+    """Return the sustained throughput seen by the host in bytes/s"""
+    if not self.first_time or self.last_time <= self.first_time:
+      return 0
+    # The first frame only marks the start.
+    return (self.bytes - FRAME_LEN) / (self.last_time - self.first_time)
+
+
 class UartSerial(object):
   """Test Object for a single UART serial device
 
@@ -65,6 +182,8 @@ class UartSerial(object):
     char_loss_occurrences: Number that character loss happens
     cleanup_cli: Command list to perform before the test exits
     cr50_workload: True if cr50 should be stressed, or False otherwise
+    frames: True to measure 'chargen frames' output
+    frame_stats: FrameStats of the test with frames
     usb_output: True if output should be generated to USB channel
     dev_prof: Dictionary of device profile
     duration: Time to keep chargen running
@@ -109,7 +228,7 @@ class UartSerial(object):
 
   def __init__(self, port, duration, timeout=1,
                baudrate=BAUDRATE, cr50_workload=False,
-               usb_output=False):
+               usb_output=False, frames=False):
     """Initialize UartSerial
 
     Args:
@@ -119,6 +238,7 @@ class UartSerial(object):
       baudrate: Baud rate such as 9600 or 115200.
       cr50_workload: True if a workload should be generated on cr50
       usb_output: True if a workload should be generated to USB channel
+      frames: True to measure numbered and timestamped frames
     """
 
     # Initialize serial object
@@ -130,9 +250,12 @@ class UartSerial(object):
     self.duration = duration
     self.cr50_workload = cr50_workload
     self.usb_output = usb_output
+    self.frames = frames
+    self.frame_stats = FrameStats()
 
     self.logger = logging.getLogger(type(self).__name__ + '| ' + port)
-    self.test_thread = threading.Thread(target=self.stress_test_thread)
+    self.test_thread = threading.Thread(
+        target=self.frame_test_thread if frames else self.stress_test_thread)
 
     self.dev_prof = {}
     self.cleanup_cli = []
@@ -259,6 +382,13 @@ class UartSerial(object):
       self.num_ch_exp = int(self.serial.baudrate * self.duration / 10)
       chargen_cmd = 'chargen ' + str(CHARGEN_TXT_LEN) + ' ' + \
                     str(self.num_ch_exp)
+      if self.frames:
+        if self.dev_prof['device_type'] != 'EC':
+          raise ChargenTestError('%s: Only the EC can send frames' %
+                                 self.dev_prof['device_type'])
+        num_frames = max(1, self.num_ch_exp // FRAME_LEN)
+        self.num_ch_exp = num_frames * FRAME_LEN
+        chargen_cmd = 'chargen frames ' + str(num_frames)
       if self.usb_output:
         chargen_cmd += ' usb'
       self.test_cli = [chargen_cmd]
@@ -353,6 +483,41 @@ class UartSerial(object):
     finally:
       self.serial.close()
 
+  def frame_test_thread(self):
+    """Test thread of the test with frames"""
+    try:
+      self.serial.open()
+      self.serial.flushInput()
+      self.serial.flushOutput()
+
+      self.run_command([''])  # Give a line feed
+      self.get_output()    # Drain the output
+      self.run_command(self.test_cli)
+      self.serial.readline()    # Drain the echoed command line.
+
+      # Arrival times are those of the chunk a line is completed in, so
+      # read small chunks as soon as they arrive.
+      self.serial.timeout = 0.01
+      pending = ''
+      idle_since = time.time()
+      while self.frame_stats.ec_summary is None:
+        captured = self.serial.read(max(1, self.serial.inWaiting()))
+        now = time.time()
+        if not captured:
+          if now - idle_since > 2:
+            self.logger.debug('No more output')
+            break
+          continue
+        idle_since = now
+
+        pending += captured.decode(errors='replace')
+        lines = pending.split(LF)
+        pending = lines.pop()
+        for line in lines:
+          self.frame_stats.add_line(line, now)
+    finally:
+      self.serial.close()
+
   def start_test(self):
     """Start the test thread"""
     self.logger.info('Test thread starts')
@@ -372,6 +537,9 @@ class UartSerial(object):
     Raises:
       ChargenTestError: if the capture is corrupted.
     """
+    if self.frames:
+      return self.get_frame_result()
+
     # If more characters than expected are captured, it means some messages
     # from other than chargen are mixed. Stop processing further.
     if self.num_ch_exp < self.num_ch_cap:
@@ -388,6 +556,38 @@ class UartSerial(object):
     return char_lost, self.num_ch_exp, self.char_loss_occurrences
 
 
+  def get_frame_result(self):
+    """Display the result of the test with frames
+
+    Returns:
+      Same as get_result(), counting the characters of the lost, corrupted
+      and duplicated frames as lost.
+    """
+    stats = self.frame_stats
+    p50, p99, worst = stats.jitter()
+    bad = stats.lost() + stats.corrupted + stats.duplicated
+
+    self.logger.info('%8d frames received / %8d sent', len(stats.received),
+                     stats.sent())
+    self.logger.info('%8d lost, %d reordered, %d corrupted, %d duplicated',
+                     stats.lost(), stats.reordered, stats.corrupted,
+                     stats.duplicated)
+    self.logger.info('throughput %.0f bytes/s', stats.throughput())
+    self.logger.info('latency jitter p50 %.2f ms, p99 %.2f ms, max %.2f ms',
+                     p50 * 1000, p99 * 1000, worst * 1000)
+    if stats.ec_summary:
+      sent, time_us, blocked_us, dropped = stats.ec_summary
+      self.logger.info('EC: %d bytes in %d us (%.0f bytes/s), blocked %d us,'
+                       ' %d chars dropped', sent * FRAME_LEN, time_us,
+                       sent * FRAME_LEN * 1e6 / max(1, time_us), blocked_us,
+                       dropped)
+      bad += dropped
+    else:
+      self.logger.error('No summary line from the EC')
+
+    return bad * FRAME_LEN, self.num_ch_exp, bad
+
+
 class ChargenTest(object):
   """UART stress tester
 
@@ -398,7 +598,7 @@ class ChargenTest(object):
   """
 
   def __init__(self, ports, duration, cr50_workload=False,
-               usb_output=False):
+               usb_output=False, frames=False):
     """Initialize UART stress tester
 
     Args:
@@ -406,6 +606,7 @@ class ChargenTest(object):
       duration: Time to keep testing in seconds.
       cr50_workload: True if a workload should be generated on cr50
       usb_output: True if a workload should be generated to USB channel
+      frames: True to measure numbered and timestamped frames
 
     Raises:
       ChargenTestError: if any of ports is not a valid character device.
@@ -431,7 +632,7 @@ class ChargenTest(object):
     for port in ports:
       self.serials[port] = UartSerial(port=port, duration=duration,
                                       cr50_workload=cr50_workload,
-                                      usb_output=usb_output)
+                                      usb_output=usb_output, frames=frames)
 
   def prepare(self):
     """Prepare the test for each UART port"""
@@ -505,6 +706,7 @@ Examples:
     %(prog)s /dev/ttyUSB2 --time 3600
     %(prog)s /dev/ttyUSB1 /dev/ttyUSB2 --debug
     %(prog)s /dev/ttyUSB1 /dev/ttyUSB2 --cr50
+    %(prog)s /dev/ttyUSB2 --frames --usb
 """
 
   parser = argparse.ArgumentParser(description=description,
@@ -516,6 +718,8 @@ Examples:
                       help='generate TPM workload on cr50')
   parser.add_argument('-d', '--debug', action='store_true', default=False,
                       help='enable debug messages')
+  parser.add_argument('-f', '--frames', action='store_true', default=False,
+                      help='measure throughput, loss and jitter with frames')
   parser.add_argument('-t', '--time', type=int,
                       help='Test duration in second', default=300)
   parser.add_argument('-u', '--usb', action='store_true', default=False,
@@ -544,7 +748,7 @@ def main():
     # Create a ChargenTest object
     utest = ChargenTest(options.port, options.time,
                         cr50_workload=options.cr50,
-                        usb_output=options.usb)
+                        usb_output=options.usb, frames=options.frames)
     utest.run()    # Run
 
   except KeyboardInterrupt:
@@ -19,6 +19,12 @@
 #define CONFIG_ZEPHYR
 #define CHROMIUM_EC
 
+#ifdef CONFIG_PLATFORM_EC_I2C
+/* Also the Zephyr option, which config.h has undefined */
+#define CONFIG_I2C
+#define CONFIG_I2C_MASTER
+#endif  /* CONFIG_PLATFORM_EC_I2C */
+
 #ifdef CONFIG_PLATFORM_EC_TIMER
 #define CONFIG_HWTIMER_64BIT
 #define CONFIG_HW_SPECIFIC_UDELAY
@@ -0,0 +1,41 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef __CROS_EC_ZEPHYR_HOOKS_SHIM_H
+#define __CROS_EC_ZEPHYR_HOOKS_SHIM_H
+
+#include <kernel.h>
+#include <zephyr.h>
+
+/*
+ * Deferred functions run from Zephyr's system work queue, as delayable work
+ * items, instead of from the EC hook task.
+ */
+struct deferred_data {
+	/* Deferred function pointer */
+	void (*routine)(void);
+	/* Work item scheduled by hook_call_deferred() */
+	struct k_work_delayable work;
+};
+
+/**
+ * zshim_run_deferred() - Work handler shared by all deferred functions
+ *
+ * @work:		The work item of a struct deferred_data.
+ */
+void zshim_run_deferred(struct k_work *work);
+
+/*
+ * The work item is modified by the kernel, so unlike on the EC the
+ * deferred_data cannot be const.
+ */
+#define DECLARE_DEFERRED(routine) _DECLARE_DEFERRED(routine)
+#define _DECLARE_DEFERRED(_routine)					\
+	struct deferred_data _routine##_data = {			\
+		.routine = _routine,					\
+		.work = Z_WORK_DELAYABLE_INITIALIZER(zshim_run_deferred), \
+	}
+
+#endif /* __CROS_EC_ZEPHYR_HOOKS_SHIM_H */
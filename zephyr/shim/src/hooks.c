@@ -0,0 +1,37 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <kernel.h>
+#include <zephyr.h>
+
+#include "common.h"
+#include "hooks.h"
+
+void zshim_run_deferred(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct deferred_data *data =
+		CONTAINER_OF(dwork, struct deferred_data, work);
+
+	data->routine();
+}
+
+int hook_call_deferred(const struct deferred_data *data, int us)
+{
+	struct k_work_delayable *work = (struct k_work_delayable *)&data->work;
+	int rv;
+
+	if (us == -1) {
+		k_work_cancel_delayable(work);
+		return EC_SUCCESS;
+	}
+
+	/* Like the hook task, a new call replaces any pending deadline. */
+	rv = k_work_reschedule(work, K_USEC(us));
+	if (rv < 0)
+		return EC_ERROR_UNKNOWN;
+
+	return EC_SUCCESS;
+}
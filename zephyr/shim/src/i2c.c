@@ -0,0 +1,113 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <device.h>
+#include <drivers/i2c.h>
+#include <kernel.h>
+#include <stdio.h>
+#include <zephyr.h>
+
+#include "common.h"
+#include "i2c.h"
+#include "i2c_private.h"
+
+/* Zephyr controllers, bound on first use, indexed by EC port number */
+static const struct device *i2c_devices[CONFIG_PLATFORM_EC_I2C_PORT_COUNT];
+static enum i2c_freq i2c_freqs[CONFIG_PLATFORM_EC_I2C_PORT_COUNT];
+
+/*
+ * Returns the Zephyr controller of an EC I2C port. Ports map to the
+ * controllers labeled "I2C_<port>", which is how most Zephyr I2C drivers
+ * name their instances.
+ */
+static const struct device *i2c_get_device(int port)
+{
+	char label[8];
+
+	if (port < 0 || port >= ARRAY_SIZE(i2c_devices))
+		return NULL;
+
+	if (!i2c_devices[port]) {
+		snprintf(label, sizeof(label), "I2C_%d", port);
+		i2c_devices[port] = device_get_binding(label);
+	}
+	return i2c_devices[port];
+}
+
+int chip_i2c_xfer(const int port, const uint16_t slave_addr_flags,
+		  const uint8_t *out, int out_size,
+		  uint8_t *in, int in_size, int flags)
+{
+	const struct device *dev = i2c_get_device(port);
+	struct i2c_msg msgs[2];
+	int num_msgs = 0;
+
+	if (!dev)
+		return EC_ERROR_INVAL;
+
+	if (out_size) {
+		msgs[num_msgs].buf = (uint8_t *)out;
+		msgs[num_msgs].len = out_size;
+		msgs[num_msgs].flags = I2C_MSG_WRITE;
+		num_msgs++;
+	}
+
+	if (in_size) {
+		msgs[num_msgs].buf = in;
+		msgs[num_msgs].len = in_size;
+		msgs[num_msgs].flags = I2C_MSG_READ;
+		/* A read after a write needs a repeated start */
+		if (num_msgs)
+			msgs[num_msgs].flags |= I2C_MSG_RESTART;
+		num_msgs++;
+	}
+
+	if (!num_msgs)
+		return EC_SUCCESS;
+
+	if (flags & I2C_XFER_STOP)
+		msgs[num_msgs - 1].flags |= I2C_MSG_STOP;
+
+	/*
+	 * The whole transfer is handed to the Zephyr driver in one call, so
+	 * controllers with DMA or FIFO support use them for both messages.
+	 */
+	if (i2c_transfer(dev, msgs, num_msgs, I2C_GET_ADDR(slave_addr_flags)))
+		return EC_ERROR_UNKNOWN;
+
+	return EC_SUCCESS;
+}
+
+int chip_i2c_set_freq(int port, enum i2c_freq freq)
+{
+	static const uint32_t speeds[I2C_FREQ_COUNT] = {
+		[I2C_FREQ_1000KHZ] = I2C_SPEED_FAST_PLUS,
+		[I2C_FREQ_400KHZ] = I2C_SPEED_FAST,
+		[I2C_FREQ_100KHZ] = I2C_SPEED_STANDARD,
+	};
+	const struct device *dev = i2c_get_device(port);
+
+	if (!dev || freq >= I2C_FREQ_COUNT)
+		return EC_ERROR_INVAL;
+
+	if (i2c_configure(dev, I2C_MODE_MASTER | I2C_SPEED_SET(speeds[freq])))
+		return EC_ERROR_UNKNOWN;
+
+	i2c_freqs[port] = freq;
+	return EC_SUCCESS;
+}
+
+enum i2c_freq chip_i2c_get_freq(int port)
+{
+	if (port < 0 || port >= ARRAY_SIZE(i2c_freqs))
+		return I2C_FREQ_COUNT;
+	return i2c_freqs[port];
+}
+
+int i2c_get_line_levels(int port)
+{
+	/* Zephyr does not expose the line levels: report an idle bus. */
+	return I2C_LINE_IDLE;
+}